@@ -31,6 +31,8 @@
 #include <cogl/cogl.h>
 #include <glib-android/glib-android.h>
 
+#define CLUTTER_ENABLE_EXPERIMENTAL_API
+
 #include "clutter-main.h"
 #include "clutter-marshal.h"
 #include "clutter-private.h"
@@ -307,6 +309,46 @@ clutter_android_handle_cmd (struct android_app *app,
     }
 }
 
+/* Android timestamps are in nanoseconds, Clutter uses milliseconds */
+#define NS_TO_MS(t)     ((guint32) ((t) / 1000000))
+
+/* the maximum number of historical samples attached to an event */
+#define MAX_HISTORY_SIZE        64
+
+/* Android batches the samples of a motion event received between two
+ * frames as its history; instead of emitting a separate event for each
+ * of them, we attach them to the event as coalesced points
+ */
+static void
+set_coalesced_points_from_history (ClutterEvent *event,
+                                   AInputEvent  *a_event,
+                                   size_t        pointer_index)
+{
+  ClutterEventPoint points[MAX_HISTORY_SIZE];
+  size_t history_size, first, h;
+
+  history_size = AMotionEvent_getHistorySize (a_event);
+  if (history_size == 0)
+    return;
+
+  /* keep the most recent samples */
+  first = history_size > MAX_HISTORY_SIZE
+        ? history_size - MAX_HISTORY_SIZE
+        : 0;
+
+  for (h = first; h < history_size; h++)
+    {
+      ClutterEventPoint *point = &points[h - first];
+
+      point->time =
+        NS_TO_MS (AMotionEvent_getHistoricalEventTime (a_event, h));
+      point->x = AMotionEvent_getHistoricalX (a_event, pointer_index, h);
+      point->y = AMotionEvent_getHistoricalY (a_event, pointer_index, h);
+    }
+
+  clutter_event_set_coalesced_points (event, points, history_size - first);
+}
+
 static gboolean
 translate_motion_event_to_pointer_event (AInputEvent *a_event)
 {
@@ -331,7 +373,7 @@ translate_motion_event_to_pointer_event (AInputEvent *a_event)
       event->button.button = 1;
       event->button.click_count = 1;
       event->button.device = pointer_device;
-      event->button.time = AMotionEvent_getEventTime (a_event);
+      event->button.time = NS_TO_MS (AMotionEvent_getEventTime (a_event));
       event->button.x = AMotionEvent_getX (a_event, 0);
       event->button.y = AMotionEvent_getY (a_event, 0);
       break;
@@ -342,7 +384,7 @@ translate_motion_event_to_pointer_event (AInputEvent *a_event)
       event->button.button = 1;
       event->button.click_count = 1;
       event->button.device = pointer_device;
-      event->button.time = AMotionEvent_getEventTime (a_event);
+      event->button.time = NS_TO_MS (AMotionEvent_getEventTime (a_event));
       event->button.x = AMotionEvent_getX (a_event, 0);
       event->button.y = AMotionEvent_getY (a_event, 0);
       break;
@@ -353,9 +395,10 @@ translate_motion_event_to_pointer_event (AInputEvent *a_event)
       event->motion.device = pointer_device;
        /* TODO: Following line is a massive hack for touch screen */
       event->motion.modifier_state = CLUTTER_BUTTON1_MASK;
-      event->motion.time = AMotionEvent_getEventTime (a_event);
+      event->motion.time = NS_TO_MS (AMotionEvent_getEventTime (a_event));
       event->motion.x = AMotionEvent_getX (a_event, 0);
       event->motion.y = AMotionEvent_getY (a_event, 0);
+      set_coalesced_points_from_history (event, a_event, 0);
       break;
 
     default:
@@ -380,9 +423,10 @@ translate_motion_event_to_touch_event (ClutterAndroidApplication *application,
   int32_t pointer_index;
   int32_t i, nb_pointers;
   int32_t action;
-  int64_t current_time;
+  guint32 current_time;
   ClutterStage *stage;
   ClutterEvent *event;
+  ClutterEventSequence *sequence;
   ClutterDeviceManager *manager;
   ClutterInputDevice *pointer_device;
   ClutterBackendAndroid *backend;
@@ -404,7 +448,7 @@ translate_motion_event_to_touch_event (ClutterAndroidApplication *application,
   action &= AMOTION_EVENT_ACTION_MASK;
   nb_pointers = AMotionEvent_getPointerCount (a_event);
 
-  current_time = AMotionEvent_getEventTime (a_event);
+  current_time = NS_TO_MS (AMotionEvent_getEventTime (a_event));
 
   DEBUG_TOUCH ("TOUCH id=%i nb_pointers=%i action=%x\n",
                pointer_index, nb_pointers, action);
@@ -454,15 +498,33 @@ translate_motion_event_to_touch_event (ClutterAndroidApplication *application,
           event = clutter_event_new (CLUTTER_TOUCH_UPDATE);
         }
 
+      /* the pointer identifiers are reused by Android as soon as a
+       * touch point ends, so each touch point gets a new sequence
+       */
+      if (event->type == CLUTTER_TOUCH_BEGIN)
+        sequence = _clutter_event_sequence_begin (pointer_device, current_id);
+      else
+        sequence = _clutter_event_sequence_lookup (pointer_device, current_id);
+
+      if (sequence == NULL)
+        {
+          DEBUG_TOUCH ("\tno sequence for id=%i\n", current_id);
+          clutter_event_free (event);
+          continue;
+        }
+
+      if (event->type == CLUTTER_TOUCH_END ||
+          event->type == CLUTTER_TOUCH_CANCEL)
+        _clutter_event_sequence_end (sequence);
+
       event->touch.time = current_time;
       event->touch.x = AMotionEvent_getX (a_event, i);
       event->touch.y = AMotionEvent_getY (a_event, i);
+      if (event->type == CLUTTER_TOUCH_UPDATE)
+        set_coalesced_points_from_history (event, a_event, i);
       event->touch.device = pointer_device;
       event->touch.modifier_state = application->modifier_state;
-      /* TODO: We should be allocating proper structures for
-         sequences, but for now it's ok (that explains the ugly kludge
-         with + 1) */
-      event->touch.sequence = (gpointer) (current_id + 1);
+      event->touch.sequence = sequence;
 
       event->any.stage = stage;
 
@@ -45,6 +45,11 @@ typedef struct _ClutterEventSourceAndroid
   GPollFD pfd;
 
   int pipe[2];
+
+  /* set when a wakeup has been written to the pipe and not read
+   * yet; all the events pushed in the meantime share that wakeup
+   */
+  volatile gint wakeup_pending;
 } ClutterEventSourceAndroid;
 
 static gboolean
@@ -89,19 +94,25 @@ clutter_event_source_android_dispatch (GSource *base,
 
   _clutter_threads_acquire_lock ();
 
-  event = clutter_event_get ();
-
+  /* clear the wakeup before draining the queue, so that events
+   * pushed while we dispatch will write a new one
+   */
   if (source->pfd.revents)
     {
       read (source->pipe[0], &dummy, sizeof (dummy));
       source->pfd.revents = 0;
+
+      g_atomic_int_set (&source->wakeup_pending, 0);
     }
 
-  if (event)
+  /* the stage only processes events once per frame, so there is
+   * nothing to gain in dispatching them one main loop iteration
+   * at a time
+   */
+  while ((event = clutter_event_get ()) != NULL)
     {
       /* forward the event into clutter for emission etc. */
-      clutter_do_event (event);
-      clutter_event_free (event);
+      _clutter_do_event (event, FALSE);
     }
 
   _clutter_threads_release_lock ();
@@ -148,5 +159,9 @@ _clutter_event_source_android_push_event (GSource *source,
 
   _clutter_event_push (event, FALSE);
 
-  write (asource->pipe[1], &dummy, sizeof (dummy));
+  /* a single wakeup is enough for all the events pushed before
+   * the next dispatch
+   */
+  if (g_atomic_int_compare_and_exchange (&asource->wakeup_pending, 0, 1))
+    write (asource->pipe[1], &dummy, sizeof (dummy));
 }
@@ -23,6 +23,8 @@
 #define __CLUTTER_ACTOR_PRIVATE_H__
 
 #include <clutter/clutter-actor.h>
+#include "clutter-animation-batch.h"
+#include "clutter-pick-index.h"
 
 G_BEGIN_DECLS
 
@@ -302,6 +304,19 @@ void                            _clutter_actor_push_clone_paint
 void                            _clutter_actor_pop_clone_paint                          (void);
 
 guint32                         _clutter_actor_get_pick_id                              (ClutterActor *self);
+gboolean                        _clutter_actor_geometric_pick                           (ClutterActor     *stage,
+                                                                                         ClutterPickMode   mode,
+                                                                                         gfloat            x,
+                                                                                         gfloat            y,
+                                                                                         ClutterActor    **actor_p);
+gboolean                        _clutter_actor_build_pick_index                         (ClutterActor     *stage,
+                                                                                         ClutterPickIndex *index);
+gboolean                        _clutter_actor_update_pick_index                        (ClutterActor     *self,
+                                                                                         ClutterPickIndex *index);
+gboolean                        _clutter_actor_pick_shape_contains                      (ClutterActor     *self,
+                                                                                         gfloat            x,
+                                                                                         gfloat            y);
+gboolean                        _clutter_actor_can_geometric_pick_branch                (ClutterActor     *self);
 
 void                            _clutter_actor_shader_pre_paint                         (ClutterActor *actor,
                                                                                          gboolean      repeat);
@@ -319,6 +334,17 @@ void                            _clutter_actor_detach_clone
 void                            _clutter_actor_queue_redraw_on_clones                   (ClutterActor *actor);
 void                            _clutter_actor_queue_relayout_on_clones                 (ClutterActor *actor);
 
+void                            _clutter_actor_relayout_boundary                        (ClutterActor *self);
+
+gboolean                        _clutter_actor_get_animation_lanes                      (ClutterActor             *self,
+                                                                                         GParamSpec               *pspec,
+                                                                                         ClutterAnimationLaneType *types,
+                                                                                         gpointer                 *targets,
+                                                                                         guint                    *n_lanes);
+void                            _clutter_actor_animated_property_changed                (ClutterActor *self,
+                                                                                         GParamSpec   *pspec);
+void                            _clutter_actor_flush_animated_changes                   (ClutterActor *self);
+
 G_END_DECLS
 
 #endif /* __CLUTTER_ACTOR_PRIVATE_H__ */
@@ -614,6 +614,7 @@
 #include "clutter-paint-nodes.h"
 #include "clutter-paint-node-private.h"
 #include "clutter-paint-volume-private.h"
+#include "clutter-pick-index.h"
 #include "clutter-private.h"
 #include "clutter-profile.h"
 #include "clutter-property-transition.h"
@@ -762,10 +763,20 @@ struct _ClutterActorPrivate
    */
   ClutterPaintVolume last_paint_volume;
 
-  ClutterStageQueueRedrawEntry *queue_redraw_entry;
+  ClutterStageQueueRedrawHandle queue_redraw_entry;
 
   ClutterColor bg_color;
 
+  /* the paint nodes built during the last paint, retained until the
+   * next redraw queued on the actor; the opacity and size they were
+   * built for are stored so that changes coming from the parent can
+   * be detected
+   */
+  ClutterPaintNode *paint_nodes;
+  guint8 paint_nodes_opacity;
+  gfloat paint_nodes_width;
+  gfloat paint_nodes_height;
+
 #ifdef CLUTTER_ENABLE_DEBUG
   /* a string used for debugging messages */
   gchar *debug_name;
@@ -793,6 +804,8 @@ struct _ClutterActorPrivate
   guint needs_height_request        : 1;
   /* cached allocation is invalid (request has changed, probably) */
   guint needs_allocation            : 1;
+  /* queued on the stage to be re-allocated in place */
+  guint relayout_root_queued        : 1;
   guint show_on_set_parent          : 1;
   guint has_clip                    : 1;
   guint clip_to_allocation          : 1;
@@ -816,6 +829,12 @@ struct _ClutterActorPrivate
   guint needs_compute_expand        : 1;
   guint needs_x_expand              : 1;
   guint needs_y_expand              : 1;
+  /* set by the animation batch until the changes are flushed */
+  guint animated_transform_changed  : 1;
+  guint animated_opacity_changed    : 1;
+  guint animated_paint_changed      : 1;
+  /* the retained paint nodes can be painted again */
+  guint paint_nodes_valid           : 1;
 };
 
 enum
@@ -1041,6 +1060,11 @@ static void           clutter_anchor_coord_set_gravity (AnchorCoord       *coord
 static gboolean clutter_anchor_coord_is_zero (const AnchorCoord *coord);
 
 static void _clutter_actor_queue_only_relayout (ClutterActor *self);
+static inline gboolean clutter_actor_is_relayout_boundary (ClutterActor *self);
+static void clutter_actor_queue_boundary_relayout (ClutterActor *self);
+static void clutter_actor_allocate_internal (ClutterActor           *self,
+                                             const ClutterActorBox  *allocation,
+                                             ClutterAllocationFlags  flags);
 
 static void _clutter_actor_get_relative_transformation_matrix (ClutterActor *self,
                                                                ClutterActor *ancestor,
@@ -1069,6 +1093,8 @@ static void clutter_actor_set_child_transform_internal (ClutterActor        *sel
 
 static inline gboolean clutter_actor_has_mapped_clones (ClutterActor *self);
 
+static void clutter_actor_clear_paint_nodes (ClutterActor *self);
+
 /* Helper macro which translates by the anchor coord, applies the
    given transformation and then translates back */
 #define TRANSFORM_ABOUT_ANCHOR_COORD(a,m,c,_transform)  G_STMT_START { \
@@ -1082,6 +1108,7 @@ static GQuark quark_shader_data = 0;
 static GQuark quark_actor_layout_info = 0;
 static GQuark quark_actor_transform_info = 0;
 static GQuark quark_actor_animation_info = 0;
+static GQuark quark_actor_pick_shape = 0;
 
 G_DEFINE_TYPE_WITH_CODE (ClutterActor,
                          clutter_actor,
@@ -1471,6 +1498,44 @@ clutter_actor_update_map_state (ClutterActor  *self,
 #endif
 }
 
+/* invalidates the pick index of the stage, if any, after a change in
+ * the structure of the scene graph or in the pick shape of @self
+ */
+static void
+clutter_actor_invalidate_pick_index (ClutterActor *self)
+{
+  ClutterActor *stage;
+
+  if (!_clutter_pick_index_in_use ())
+    return;
+
+  stage = _clutter_actor_get_stage_internal (self);
+  if (stage == NULL)
+    return;
+
+  _clutter_stage_invalidate_pick_index (CLUTTER_STAGE (stage));
+}
+
+/* marks the transformation of @self as changed; this also affects the
+ * pick geometry of its children
+ */
+static void
+clutter_actor_invalidate_transform (ClutterActor *self)
+{
+  ClutterActor *stage;
+
+  self->priv->transform_valid = FALSE;
+
+  if (!_clutter_pick_index_in_use () || !CLUTTER_ACTOR_IS_MAPPED (self))
+    return;
+
+  stage = _clutter_actor_get_stage_internal (self);
+  if (stage == NULL)
+    return;
+
+  _clutter_stage_queue_pick_index_update (CLUTTER_STAGE (stage), self);
+}
+
 static void
 clutter_actor_real_map (ClutterActor *self)
 {
@@ -1486,6 +1551,7 @@ clutter_actor_real_map (ClutterActor *self)
 
   stage = _clutter_actor_get_stage_internal (self);
   priv->pick_id = _clutter_stage_acquire_pick_id (CLUTTER_STAGE (stage), self);
+  _clutter_stage_invalidate_pick_index (CLUTTER_STAGE (stage));
 
   CLUTTER_NOTE (ACTOR, "Pick id '%d' for actor '%s'",
                 priv->pick_id,
@@ -1561,6 +1627,11 @@ clutter_actor_real_unmap (ClutterActor *self)
   _clutter_paint_volume_init_static (&priv->last_paint_volume, NULL);
   priv->last_paint_volume_valid = TRUE;
 
+  /* unmapped actors are not painted, so there's no point in holding
+   * on to the resources referenced by their paint nodes
+   */
+  clutter_actor_clear_paint_nodes (self);
+
   /* notify on parent mapped after potentially unmapping
    * children, so apps see a bottom-up notification.
    */
@@ -1574,7 +1645,10 @@ clutter_actor_real_unmap (ClutterActor *self)
       stage = CLUTTER_STAGE (_clutter_actor_get_stage_internal (self));
 
       if (stage != NULL)
-        _clutter_stage_release_pick_id (stage, priv->pick_id);
+        {
+          _clutter_stage_release_pick_id (stage, priv->pick_id);
+          _clutter_stage_invalidate_pick_index (stage);
+        }
 
       priv->pick_id = -1;
 
@@ -2180,12 +2254,580 @@ clutter_actor_should_pick_paint (ClutterActor *self)
 {
   g_return_val_if_fail (CLUTTER_IS_ACTOR (self), FALSE);
 
-  if (CLUTTER_ACTOR_IS_MAPPED (self) &&
-      (_clutter_context_get_pick_mode () == CLUTTER_PICK_ALL ||
-       CLUTTER_ACTOR_IS_REACTIVE (self)))
-    return TRUE;
+  if (CLUTTER_ACTOR_IS_MAPPED (self) &&
+      (_clutter_context_get_pick_mode () == CLUTTER_PICK_ALL ||
+       CLUTTER_ACTOR_IS_REACTIVE (self)))
+    return TRUE;
+
+  return FALSE;
+}
+
+/* Geometric picking
+ *
+ * The geometric pick walks the scene graph on the CPU, projecting the
+ * allocation of each actor on the stage and checking whether the pick
+ * point falls inside the resulting quadrilateral. It mirrors what the
+ * default pick() implementation paints, so it can only be used for
+ * actors that do not override the pick process, unless they provide
+ * a shape function through clutter_actor_set_pick_shape_func().
+ */
+typedef struct _PickShapeData
+{
+  ClutterActorPickShapeFunc func;
+  gpointer data;
+  GDestroyNotify notify;
+} PickShapeData;
+
+typedef struct _GeometricPick
+{
+  CoglMatrix projection;
+  float viewport[4];
+
+  /* the pick point, in window coordinates */
+  float x;
+  float y;
+
+  ClutterPickMode mode;
+
+  /* set to FALSE if an actor that cannot be picked geometrically
+   * is found while walking the scene graph
+   */
+  gboolean is_supported;
+} GeometricPick;
+
+static void
+pick_shape_data_free (gpointer data)
+{
+  PickShapeData *shape_data = data;
+
+  if (shape_data->notify != NULL)
+    shape_data->notify (shape_data->data);
+
+  g_slice_free (PickShapeData, shape_data);
+}
+
+static void
+geometric_project_box (const CoglMatrix *modelview,
+                       const CoglMatrix *projection,
+                       const float      *viewport,
+                       float             x1,
+                       float             y1,
+                       float             x2,
+                       float             y2,
+                       ClutterVertex     verts[])
+{
+  ClutterVertex box[4];
+
+  box[0].x = x1; box[0].y = y1; box[0].z = 0.f;
+  box[1].x = x2; box[1].y = y1; box[1].z = 0.f;
+  box[2].x = x1; box[2].y = y2; box[2].z = 0.f;
+  box[3].x = x2; box[3].y = y2; box[3].z = 0.f;
+
+  _clutter_util_fully_transform_vertices (modelview,
+                                          projection,
+                                          viewport,
+                                          box,
+                                          verts,
+                                          4);
+}
+
+static gboolean
+geometric_pick_box (GeometricPick    *pick,
+                    const CoglMatrix *modelview,
+                    float             x1,
+                    float             y1,
+                    float             x2,
+                    float             y2)
+{
+  ClutterVertex verts[4];
+
+  geometric_project_box (modelview, &pick->projection, pick->viewport,
+                         x1, y1, x2, y2,
+                         verts);
+
+  return _clutter_util_quad_contains_point (verts, pick->x, pick->y);
+}
+
+static gboolean
+clutter_actor_effects_override_pick (ClutterActor *self,
+                                     gboolean      include_disabled)
+{
+  ClutterEffectClass *effect_class;
+  const GList *l;
+
+  if (self->priv->effects == NULL)
+    return FALSE;
+
+  effect_class = g_type_class_peek (CLUTTER_TYPE_EFFECT);
+
+  /* effects overriding pick() can paint anything, e.g. a shifted
+   * or deformed silhouette of the actor
+   */
+  for (l = _clutter_meta_group_peek_metas (self->priv->effects);
+       l != NULL;
+       l = l->next)
+    {
+      ClutterEffect *effect = l->data;
+
+      if (!include_disabled && !clutter_actor_meta_get_enabled (l->data))
+        continue;
+
+      if (CLUTTER_EFFECT_GET_CLASS (effect)->pick != effect_class->pick)
+        return TRUE;
+    }
+
+  return FALSE;
+}
+
+static gboolean
+clutter_actor_can_geometric_pick (ClutterActor *self,
+                                  gboolean      include_disabled)
+{
+  /* the shape function replaces whatever the actor does in pick() */
+  if (g_object_get_qdata (G_OBJECT (self), quark_actor_pick_shape) != NULL)
+    return TRUE;
+
+  if (CLUTTER_ACTOR_GET_CLASS (self)->pick != clutter_actor_real_pick)
+    return FALSE;
+
+  /* the deprecated ::pick signal can be used to paint a custom shape */
+  if (g_signal_has_handler_pending (self, actor_signals[PICK], 0, TRUE))
+    return FALSE;
+
+  return !clutter_actor_effects_override_pick (self, include_disabled);
+}
+
+static ClutterActor *
+clutter_actor_geometric_pick_children (ClutterActor     *self,
+                                       const CoglMatrix *modelview,
+                                       GeometricPick    *pick);
+
+static ClutterActor *
+clutter_actor_geometric_pick_actor (ClutterActor     *self,
+                                    const CoglMatrix *parent_modelview,
+                                    GeometricPick    *pick)
+{
+  ClutterActorPrivate *priv = self->priv;
+  ClutterActor *retval;
+  CoglMatrix modelview;
+  float width, height;
+
+  if (!CLUTTER_ACTOR_IS_MAPPED (self) || CLUTTER_ACTOR_IN_DESTRUCTION (self))
+    return NULL;
+
+  if (!clutter_actor_can_geometric_pick (self, FALSE))
+    {
+      CLUTTER_NOTE (PICK, "Actor '%s' cannot be picked geometrically",
+                    _clutter_actor_get_debug_name (self));
+
+      pick->is_supported = FALSE;
+      return NULL;
+    }
+
+  modelview = *parent_modelview;
+  if (priv->enable_model_view_transform)
+    _clutter_actor_apply_modelview_transform (self, &modelview);
+
+  width = priv->allocation.x2 - priv->allocation.x1;
+  height = priv->allocation.y2 - priv->allocation.y1;
+
+  /* the clip applies to the actor and all its children */
+  if (priv->has_clip)
+    {
+      if (!geometric_pick_box (pick, &modelview,
+                               priv->clip.origin.x,
+                               priv->clip.origin.y,
+                               priv->clip.origin.x + priv->clip.size.width,
+                               priv->clip.origin.y + priv->clip.size.height))
+        return NULL;
+    }
+  else if (priv->clip_to_allocation)
+    {
+      if (!geometric_pick_box (pick, &modelview, 0.f, 0.f, width, height))
+        return NULL;
+    }
+
+  /* children are painted on top of their parent */
+  retval = clutter_actor_geometric_pick_children (self, &modelview, pick);
+  if (retval != NULL || !pick->is_supported)
+    return retval;
+
+  if (pick->mode != CLUTTER_PICK_ALL && !CLUTTER_ACTOR_IS_REACTIVE (self))
+    return NULL;
+
+  if (!geometric_pick_box (pick, &modelview, 0.f, 0.f, width, height))
+    return NULL;
+
+  if (!_clutter_actor_pick_shape_contains (self, pick->x, pick->y))
+    return NULL;
+
+  return self;
+}
+
+static ClutterActor *
+clutter_actor_geometric_pick_children (ClutterActor     *self,
+                                       const CoglMatrix *modelview,
+                                       GeometricPick    *pick)
+{
+  ClutterActor *iter;
+
+  /* walk the children in reverse paint order, so that the first
+   * actor hit is the one painted last
+   */
+  for (iter = self->priv->last_child;
+       iter != NULL;
+       iter = iter->priv->prev_sibling)
+    {
+      ClutterActor *retval;
+
+      retval = clutter_actor_geometric_pick_actor (iter, modelview, pick);
+      if (retval != NULL || !pick->is_supported)
+        return retval;
+    }
+
+  return NULL;
+}
+
+/*< private >
+ * _clutter_actor_geometric_pick:
+ * @stage: a #ClutterStage
+ * @mode: the #ClutterPickMode
+ * @x: X coordinate of the pick point, in window coordinates
+ * @y: Y coordinate of the pick point, in window coordinates
+ * @actor_p: (out): return location for the picked actor
+ *
+ * Picks the actor at the given coordinates by walking the scene graph
+ * and hit testing the transformed allocation of each actor, without
+ * rendering anything.
+ *
+ * Return value: %TRUE if the pick was performed, and %FALSE if the
+ *   scene graph contains actors that need to be picked by painting
+ */
+gboolean
+_clutter_actor_geometric_pick (ClutterActor     *stage,
+                               ClutterPickMode   mode,
+                               gfloat            x,
+                               gfloat            y,
+                               ClutterActor    **actor_p)
+{
+  GeometricPick pick;
+  CoglMatrix modelview;
+  ClutterActor *retval;
+
+  g_assert (CLUTTER_IS_STAGE (stage));
+
+  _clutter_stage_get_projection_matrix (CLUTTER_STAGE (stage),
+                                        &pick.projection);
+  _clutter_stage_get_viewport (CLUTTER_STAGE (stage),
+                               &pick.viewport[0],
+                               &pick.viewport[1],
+                               &pick.viewport[2],
+                               &pick.viewport[3]);
+
+  /* we test the center of the pixel, like the rasterizer does */
+  pick.x = x + 0.5f;
+  pick.y = y + 0.5f;
+  pick.mode = mode;
+  pick.is_supported = TRUE;
+
+  /* the stage paints its children with the default order, but
+   * effects applied to it might still change the pick shape
+   */
+  if (clutter_actor_effects_override_pick (stage, FALSE))
+    return FALSE;
+
+  cogl_matrix_init_identity (&modelview);
+  _clutter_actor_apply_modelview_transform (stage, &modelview);
+
+  retval = clutter_actor_geometric_pick_children (stage, &modelview, &pick);
+  if (!pick.is_supported)
+    return FALSE;
+
+  if (actor_p != NULL)
+    *actor_p = retval != NULL ? retval : stage;
+
+  return TRUE;
+}
+
+/* the pick index is not invalidated when an effect is enabled or
+ * disabled, so it has to account for disabled effects as well
+ */
+static gboolean
+clutter_actor_build_pick_index_actor (ClutterActor     *self,
+                                      ClutterPickIndex *index,
+                                      const CoglMatrix *projection,
+                                      const float      *viewport,
+                                      const CoglMatrix *parent_modelview,
+                                      gint              parent_clip)
+{
+  ClutterActorPrivate *priv = self->priv;
+  ClutterVertex verts[4], clip_verts[4];
+  gboolean has_clip, is_reactive;
+  CoglMatrix modelview;
+  ClutterActor *iter;
+  float width, height;
+
+  if (!CLUTTER_ACTOR_IS_MAPPED (self) || CLUTTER_ACTOR_IN_DESTRUCTION (self))
+    return TRUE;
+
+  if (!clutter_actor_can_geometric_pick (self, TRUE))
+    {
+      CLUTTER_NOTE (PICK, "Actor '%s' cannot be added to the pick index",
+                    _clutter_actor_get_debug_name (self));
+      return FALSE;
+    }
+
+  modelview = *parent_modelview;
+  if (priv->enable_model_view_transform)
+    _clutter_actor_apply_modelview_transform (self, &modelview);
+
+  width = priv->allocation.x2 - priv->allocation.x1;
+  height = priv->allocation.y2 - priv->allocation.y1;
+
+  has_clip = priv->has_clip || priv->clip_to_allocation;
+  is_reactive = CLUTTER_ACTOR_IS_REACTIVE (self);
+
+  if (priv->has_clip)
+    geometric_project_box (&modelview, projection, viewport,
+                           priv->clip.origin.x,
+                           priv->clip.origin.y,
+                           priv->clip.origin.x + priv->clip.size.width,
+                           priv->clip.origin.y + priv->clip.size.height,
+                           clip_verts);
+  else if (priv->clip_to_allocation)
+    geometric_project_box (&modelview, projection, viewport,
+                           0.f, 0.f, width, height,
+                           clip_verts);
+
+  /* actors that are neither reactive nor clipping their children
+   * do not affect the pick
+   */
+  if (is_reactive || has_clip)
+    {
+      geometric_project_box (&modelview, projection, viewport,
+                             0.f, 0.f, width, height,
+                             verts);
+
+      _clutter_pick_index_set_entry (index, self,
+                                     verts,
+                                     has_clip ? clip_verts : NULL,
+                                     parent_clip,
+                                     is_reactive);
+    }
+
+  if (has_clip)
+    parent_clip = priv->pick_id;
+
+  /* children are added in paint order */
+  for (iter = priv->first_child;
+       iter != NULL;
+       iter = iter->priv->next_sibling)
+    {
+      if (!clutter_actor_build_pick_index_actor (iter, index,
+                                                 projection,
+                                                 viewport,
+                                                 &modelview,
+                                                 parent_clip))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+/*< private >
+ * _clutter_actor_build_pick_index:
+ * @stage: a #ClutterStage
+ * @index: the #ClutterPickIndex of @stage
+ *
+ * Adds the pick geometry of all the mapped actors of @stage to @index,
+ * in paint order.
+ *
+ * Return value: %FALSE if the scene graph contains actors that need
+ *   to be picked by painting
+ */
+gboolean
+_clutter_actor_build_pick_index (ClutterActor     *stage,
+                                 ClutterPickIndex *index)
+{
+  CoglMatrix projection, modelview;
+  float viewport[4];
+  ClutterActor *iter;
+
+  g_assert (CLUTTER_IS_STAGE (stage));
+
+  if (clutter_actor_effects_override_pick (stage, TRUE))
+    return FALSE;
+
+  _clutter_pick_index_get_projection (index, &projection, viewport);
+
+  cogl_matrix_init_identity (&modelview);
+  _clutter_actor_apply_modelview_transform (stage, &modelview);
+
+  for (iter = stage->priv->first_child;
+       iter != NULL;
+       iter = iter->priv->next_sibling)
+    {
+      if (!clutter_actor_build_pick_index_actor (iter, index,
+                                                 &projection,
+                                                 viewport,
+                                                 &modelview,
+                                                 -1))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+/*< private >
+ * _clutter_actor_update_pick_index:
+ * @self: a mapped #ClutterActor
+ * @index: the #ClutterPickIndex of the stage of @self
+ *
+ * Updates the pick geometry of @self and its descendants after a
+ * change in their transformation, without changing their paint order.
+ *
+ * Return value: %FALSE if the scene graph contains actors that need
+ *   to be picked by painting
+ */
+gboolean
+_clutter_actor_update_pick_index (ClutterActor     *self,
+                                  ClutterPickIndex *index)
+{
+  CoglMatrix projection, modelview;
+  float viewport[4];
+  ClutterActor *iter;
+  gint parent_clip = -1;
+
+  /* unmapping invalidates the whole index */
+  if (!CLUTTER_ACTOR_IS_MAPPED (self) || self->priv->parent == NULL)
+    return TRUE;
+
+  _clutter_pick_index_get_projection (index, &projection, viewport);
+
+  cogl_matrix_init_identity (&modelview);
+  _clutter_actor_apply_relative_transformation_matrix (self->priv->parent,
+                                                       NULL,
+                                                       &modelview);
+
+  for (iter = self->priv->parent;
+       iter != NULL && !CLUTTER_ACTOR_IS_TOPLEVEL (iter);
+       iter = iter->priv->parent)
+    {
+      if (iter->priv->has_clip || iter->priv->clip_to_allocation)
+        {
+          parent_clip = iter->priv->pick_id;
+          break;
+        }
+    }
+
+  return clutter_actor_build_pick_index_actor (self, index,
+                                               &projection,
+                                               viewport,
+                                               &modelview,
+                                               parent_clip);
+}
+
+/*< private >
+ * _clutter_actor_pick_shape_contains:
+ * @self: a #ClutterActor
+ * @x: X coordinate of a point inside the allocation of @self, in
+ *   window coordinates
+ * @y: Y coordinate of a point inside the allocation of @self, in
+ *   window coordinates
+ *
+ * Checks the point against the pick shape function of @self, if any.
+ *
+ * Return value: %TRUE if the point belongs to the pick shape of @self
+ */
+gboolean
+_clutter_actor_pick_shape_contains (ClutterActor *self,
+                                    gfloat        x,
+                                    gfloat        y)
+{
+  PickShapeData *shape_data;
+  gfloat actor_x, actor_y;
+
+  shape_data = g_object_get_qdata (G_OBJECT (self), quark_actor_pick_shape);
+  if (shape_data == NULL)
+    return TRUE;
+
+  if (!clutter_actor_transform_stage_point (self, x, y, &actor_x, &actor_y))
+    return FALSE;
+
+  return shape_data->func (self, actor_x, actor_y, shape_data->data);
+}
+
+/*< private >
+ * _clutter_actor_can_geometric_pick_branch:
+ * @self: a #ClutterActor
+ *
+ * Checks whether @self and its ancestors, up to the stage, can still
+ * be picked geometrically; handlers of the #ClutterActor::pick signal
+ * and effects can be added after the pick index has been built.
+ *
+ * Return value: %TRUE if the branch can be picked geometrically
+ */
+gboolean
+_clutter_actor_can_geometric_pick_branch (ClutterActor *self)
+{
+  ClutterActor *iter;
+
+  for (iter = self;
+       iter != NULL && !CLUTTER_ACTOR_IS_TOPLEVEL (iter);
+       iter = iter->priv->parent)
+    {
+      if (!clutter_actor_can_geometric_pick (iter, FALSE))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+/**
+ * clutter_actor_set_pick_shape_func:
+ * @self: a #ClutterActor
+ * @func: (allow-none): a #ClutterActorPickShapeFunc, or %NULL to unset it
+ * @user_data: data to pass to @func
+ * @notify: function called when @func is unset or @self is destroyed
+ *
+ * Sets the function used to test whether a point belongs to the pick
+ * shape of @self when the #ClutterStage uses geometric picking; see
+ * clutter_stage_set_geometric_picking().
+ *
+ * Actors overriding the #ClutterActorClass.pick virtual function, or
+ * using effects that override the #ClutterEffectClass.pick virtual
+ * function, cannot be picked geometrically and will force the stage
+ * to paint the scene in pick mode, unless they provide a shape function.
+ *
+ * The @func is only called for points inside the transformed allocation
+ * of @self; the children of @self are always picked as usual.
+ *
+ * Since: 1.14
+ * Stability: unstable
+ */
+void
+clutter_actor_set_pick_shape_func (ClutterActor              *self,
+                                   ClutterActorPickShapeFunc  func,
+                                   gpointer                   user_data,
+                                   GDestroyNotify             notify)
+{
+  PickShapeData *shape_data = NULL;
+
+  g_return_if_fail (CLUTTER_IS_ACTOR (self));
+
+  if (func != NULL)
+    {
+      shape_data = g_slice_new (PickShapeData);
+      shape_data->func = func;
+      shape_data->data = user_data;
+      shape_data->notify = notify;
+    }
+
+  g_object_set_qdata_full (G_OBJECT (self), quark_actor_pick_shape,
+                           shape_data,
+                           pick_shape_data_free);
 
-  return FALSE;
+  clutter_actor_invalidate_pick_index (self);
 }
 
 static void
@@ -2401,7 +3043,7 @@ clutter_actor_set_allocation_internal (ClutterActor           *self,
       CLUTTER_NOTE (LAYOUT, "Allocation for '%s' changed",
                     _clutter_actor_get_debug_name (self));
 
-      priv->transform_valid = FALSE;
+      clutter_actor_invalidate_transform (self);
 
       g_object_notify_by_pspec (obj, obj_props[PROP_ALLOCATION]);
 
@@ -2641,9 +3283,21 @@ clutter_actor_real_queue_relayout (ClutterActor *self)
   memset (priv->height_requests, 0,
           N_CACHED_SIZE_REQUESTS * sizeof (SizeRequest));
 
+  if (priv->parent == NULL)
+    return;
+
+  /* a parent with a fixed size does not change its preferred size when
+   * its children do, so there is no need to go all the way up the
+   * hierarchy: the parent can be re-allocated in place
+   */
+  if (clutter_actor_is_relayout_boundary (priv->parent))
+    {
+      clutter_actor_queue_boundary_relayout (priv->parent);
+      return;
+    }
+
   /* We need to go all the way up the hierarchy */
-  if (priv->parent != NULL)
-    _clutter_actor_queue_only_relayout (priv->parent);
+  _clutter_actor_queue_only_relayout (priv->parent);
 }
 
 /**
@@ -3440,6 +4094,8 @@ _clutter_actor_add_effect_internal (ClutterActor  *self,
     }
 
   _clutter_meta_group_add_meta (priv->effects, CLUTTER_ACTOR_META (effect));
+
+  clutter_actor_invalidate_pick_index (self);
 }
 
 /* This is the same as clutter_actor_remove_effect except that it doesn't
@@ -3457,6 +4113,8 @@ _clutter_actor_remove_effect_internal (ClutterActor  *self,
 
   if (_clutter_meta_group_peek_metas (priv->effects) == NULL)
     g_clear_object (&priv->effects);
+
+  clutter_actor_invalidate_pick_index (self);
 }
 
 static gboolean
@@ -3583,20 +4241,111 @@ clutter_actor_paint_node (ClutterActor     *actor,
   if (CLUTTER_ACTOR_GET_CLASS (actor)->paint_node != NULL)
     CLUTTER_ACTOR_GET_CLASS (actor)->paint_node (actor, root);
 
-  if (clutter_paint_node_get_n_children (root) == 0)
-    return FALSE;
+  return clutter_paint_node_get_n_children (root) != 0;
+}
+
+static void
+clutter_actor_clear_paint_nodes (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+
+  if (priv->paint_nodes != NULL)
+    {
+      clutter_paint_node_unref (priv->paint_nodes);
+      priv->paint_nodes = NULL;
+    }
+
+  priv->paint_nodes_valid = FALSE;
+}
+
+/*< private >
+ * clutter_actor_paint_retained_nodes:
+ * @self: a #ClutterActor
+ *
+ * Paints the tree of #ClutterPaintNode of @self.
+ *
+ * The tree is retained across frames, and it is built again only if a
+ * redraw has been queued on @self since the last paint, or if the paint
+ * opacity or the size of the allocation of @self changed; neither the
+ * background color, the #ClutterContent nor the
+ * #ClutterActorClass.paint_node() virtual function are consulted when
+ * painting a retained tree.
+ */
+static void
+clutter_actor_paint_retained_nodes (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+  guint8 opacity;
+  gfloat width, height;
+
+  CLUTTER_STATIC_COUNTER (paint_nodes_built_counter,
+                          "Paint node trees built",
+                          "Increments each time the paint nodes of an "
+                          "actor are built",
+                          0 /* no application private data */);
+  CLUTTER_STATIC_COUNTER (paint_nodes_reused_counter,
+                          "Paint node trees reused",
+                          "Increments each time the retained paint nodes "
+                          "of an actor are painted again",
+                          0 /* no application private data */);
+
+  opacity = clutter_actor_get_paint_opacity_internal (self);
+  width = clutter_actor_box_get_width (&priv->allocation);
+  height = clutter_actor_box_get_height (&priv->allocation);
+
+  if (!priv->paint_nodes_valid ||
+      priv->paint_nodes_opacity != opacity ||
+      priv->paint_nodes_width != width ||
+      priv->paint_nodes_height != height ||
+      G_UNLIKELY (clutter_paint_debug_flags &
+                  CLUTTER_DEBUG_DISABLE_RETAINED_PAINT_NODES))
+    {
+      ClutterPaintNode *root;
+
+      CLUTTER_COUNTER_INC (_clutter_uprof_context, paint_nodes_built_counter);
+
+      clutter_actor_clear_paint_nodes (self);
+
+      /* XXX - this will go away in 2.0, when we can get rid of this
+       * stuff and switch to a pure retained render tree of PaintNodes
+       * for the entire frame, starting from the Stage; the paint()
+       * virtual function can then be called directly.
+       */
+      root = _clutter_dummy_node_new (self);
+      clutter_paint_node_set_name (root, "Root");
+
+      /* the tree is marked as valid before building it, so that any
+       * redraw queued while building will invalidate it again
+       */
+      priv->paint_nodes_valid = TRUE;
+      priv->paint_nodes_opacity = opacity;
+      priv->paint_nodes_width = width;
+      priv->paint_nodes_height = height;
+
+      /* an empty tree is retained as well, to avoid building it again
+       * on the next frame only to find out that there is nothing to
+       * paint
+       */
+      if (clutter_actor_paint_node (self, root))
+        priv->paint_nodes = root;
+      else
+        clutter_paint_node_unref (root);
+    }
+  else
+    CLUTTER_COUNTER_INC (_clutter_uprof_context, paint_nodes_reused_counter);
+
+  if (priv->paint_nodes == NULL)
+    return;
 
 #ifdef CLUTTER_ENABLE_DEBUG
   if (CLUTTER_HAS_DEBUG (PAINT))
     {
       /* dump the tree only if we have one */
-      _clutter_paint_node_dump_tree (root);
+      _clutter_paint_node_dump_tree (priv->paint_nodes);
     }
 #endif /* CLUTTER_ENABLE_DEBUG */
 
-  _clutter_paint_node_paint (root);
-
-  return TRUE;
+  _clutter_paint_node_paint (priv->paint_nodes);
 }
 
 /**
@@ -3874,21 +4623,7 @@ clutter_actor_continue_paint (ClutterActor *self)
     {
       if (_clutter_context_get_pick_mode () == CLUTTER_PICK_NONE)
         {
-          ClutterPaintNode *dummy;
-
-          /* XXX - this will go away in 2.0, when we can get rid of this
-           * stuff and switch to a pure retained render tree of PaintNodes
-           * for the entire frame, starting from the Stage; the paint()
-           * virtual function can then be called directly.
-           */
-          dummy = _clutter_dummy_node_new (self);
-          clutter_paint_node_set_name (dummy, "Root");
-
-          /* XXX - for 1.12, we use the return value of paint_node() to
-           * decide whether we should emit the ::paint signal.
-           */
-          clutter_actor_paint_node (self, dummy);
-          clutter_paint_node_unref (dummy);
+          clutter_actor_paint_retained_nodes (self);
 
           /* XXX:2.0 - Call the paint() virtual directly */
           g_signal_emit (self, actor_signals[PAINT], 0);
@@ -3991,12 +4726,17 @@ invalidate_queue_redraw_entry (ClutterActor *self,
                                gpointer      user_data)
 {
   ClutterActorPrivate *priv = self->priv;
+  ClutterActor *stage = user_data;
 
-  if (priv->queue_redraw_entry != NULL)
-    {
-      _clutter_stage_queue_redraw_entry_invalidate (priv->queue_redraw_entry);
-      priv->queue_redraw_entry = NULL;
-    }
+  /* the handle does not reference the entries left in the queue being
+   * processed, so the stage is asked even without a handle
+   */
+  if (stage != NULL)
+    _clutter_stage_queue_redraw_entry_invalidate (CLUTTER_STAGE (stage),
+                                                  &priv->queue_redraw_entry,
+                                                  self);
+  else
+    priv->queue_redraw_entry.generation = 0;
 
   return CLUTTER_ACTOR_TRAVERSE_VISIT_CONTINUE;
 }
@@ -4126,7 +4866,7 @@ clutter_actor_remove_child_internal (ClutterActor                 *self,
                                0,
                                invalidate_queue_redraw_entry,
                                NULL,
-                               NULL);
+                               _clutter_actor_get_stage_internal (child));
     }
 
   old_first = self->priv->first_child;
@@ -4138,6 +4878,10 @@ clutter_actor_remove_child_internal (ClutterActor                 *self,
 
   self->priv->age += 1;
 
+  /* the paint order of the children changed */
+  if (CLUTTER_ACTOR_IS_MAPPED (self))
+    clutter_actor_invalidate_pick_index (self);
+
   /* if the child that got removed was visible and set to
    * expand then we want to reset the parent's state in
    * case the child was the only thing that was making it
@@ -4280,7 +5024,7 @@ clutter_actor_set_pivot_point_internal (ClutterActor       *self,
   info = _clutter_actor_get_transform_info (self);
   info->pivot = *pivot;
 
-  self->priv->transform_valid = FALSE;
+  clutter_actor_invalidate_transform (self);
 
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_PIVOT_POINT]);
 
@@ -4296,7 +5040,7 @@ clutter_actor_set_pivot_point_z_internal (ClutterActor *self,
   info = _clutter_actor_get_transform_info (self);
   info->pivot_z = pivot_z;
 
-  self->priv->transform_valid = FALSE;
+  clutter_actor_invalidate_transform (self);
 
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_PIVOT_POINT_Z]);
 
@@ -4330,7 +5074,7 @@ clutter_actor_set_translation_internal (ClutterActor *self,
   else
     g_assert_not_reached ();
 
-  self->priv->transform_valid = FALSE;
+  clutter_actor_invalidate_transform (self);
   clutter_actor_queue_redraw (self);
   g_object_notify_by_pspec (obj, pspec);
 }
@@ -4462,7 +5206,7 @@ clutter_actor_set_rotation_angle_internal (ClutterActor *self,
   else
     g_assert_not_reached ();
 
-  self->priv->transform_valid = FALSE;
+  clutter_actor_invalidate_transform (self);
 
   clutter_actor_queue_redraw (self);
 
@@ -4618,7 +5362,7 @@ clutter_actor_set_rotation_center_internal (ClutterActor        *self,
       break;
     }
 
-  self->priv->transform_valid = FALSE;
+  clutter_actor_invalidate_transform (self);
 
   g_object_thaw_notify (obj);
 
@@ -4644,7 +5388,7 @@ clutter_actor_set_scale_factor_internal (ClutterActor *self,
   else
     g_assert_not_reached ();
 
-  self->priv->transform_valid = FALSE;
+  clutter_actor_invalidate_transform (self);
   clutter_actor_queue_redraw (self);
   g_object_notify_by_pspec (obj, pspec);
 }
@@ -4725,7 +5469,7 @@ clutter_actor_set_scale_center (ClutterActor      *self,
       g_assert_not_reached ();
     }
 
-  self->priv->transform_valid = FALSE;
+  clutter_actor_invalidate_transform (self);
 
   clutter_actor_queue_redraw (self);
 
@@ -4747,7 +5491,7 @@ clutter_actor_set_scale_gravity (ClutterActor   *self,
   else
     clutter_anchor_coord_set_gravity (&info->scale_center, gravity);
 
-  self->priv->transform_valid = FALSE;
+  clutter_actor_invalidate_transform (self);
 
   g_object_notify_by_pspec (obj, obj_props[PROP_SCALE_CENTER_X]);
   g_object_notify_by_pspec (obj, obj_props[PROP_SCALE_CENTER_Y]);
@@ -4800,7 +5544,7 @@ clutter_actor_set_anchor_coord (ClutterActor      *self,
       g_assert_not_reached ();
     }
 
-  self->priv->transform_valid = FALSE;
+  clutter_actor_invalidate_transform (self);
 
   clutter_actor_queue_redraw (self);
 
@@ -4822,6 +5566,7 @@ clutter_actor_set_clip_rect (ClutterActor      *self,
   else
     priv->has_clip = FALSE;
 
+  clutter_actor_invalidate_pick_index (self);
   clutter_actor_queue_redraw (self);
 
   g_object_notify_by_pspec (obj, obj_props[PROP_CLIP]); /* XXX:2.0 - remove */
@@ -5805,6 +6550,8 @@ clutter_actor_dispose (GObject *object)
   g_clear_object (&priv->effects);
   g_clear_object (&priv->flatten_effect);
 
+  clutter_actor_clear_paint_nodes (self);
+
   if (priv->layout_manager != NULL)
     {
       clutter_layout_manager_set_container (priv->layout_manager, NULL);
@@ -6122,6 +6869,7 @@ clutter_actor_class_init (ClutterActorClass *klass)
   quark_actor_layout_info = g_quark_from_static_string ("-clutter-actor-layout-info");
   quark_actor_transform_info = g_quark_from_static_string ("-clutter-actor-transform-info");
   quark_actor_animation_info = g_quark_from_static_string ("-clutter-actor-animation-info");
+  quark_actor_pick_shape = g_quark_from_static_string ("-clutter-actor-pick-shape");
 
   object_class->constructor = clutter_actor_constructor;
   object_class->set_property = clutter_actor_set_property;
@@ -8427,6 +9175,7 @@ _clutter_actor_finish_queue_redraw (ClutterActor *self,
 {
   ClutterActorPrivate *priv = self->priv;
   ClutterPaintVolume *pv;
+  ClutterActor *stage;
   gboolean clipped;
 
   /* Remove queue entry early in the process, otherwise a new
@@ -8435,7 +9184,12 @@ _clutter_actor_finish_queue_redraw (ClutterActor *self,
      soon as we return from this function, causing a segfault
      later)
   */
-  priv->queue_redraw_entry = NULL;
+  stage = _clutter_actor_get_stage_internal (self);
+  if (stage != NULL)
+    _clutter_stage_queue_redraw_entry_finish (CLUTTER_STAGE (stage),
+                                              &priv->queue_redraw_entry);
+  else
+    priv->queue_redraw_entry.generation = 0;
 
   /* If we've been explicitly passed a clip volume then there's
    * nothing more to calculate, but otherwise the only thing we know
@@ -8462,8 +9216,6 @@ _clutter_actor_finish_queue_redraw (ClutterActor *self,
       pv = _clutter_actor_get_paint_volume_mutable (self);
       if (pv)
         {
-          ClutterActor *stage = _clutter_actor_get_stage_internal (self);
-
           /* make sure we redraw the actors old position... */
           _clutter_actor_set_queue_redraw_clip (stage,
                                                 &priv->last_paint_volume);
@@ -8606,6 +9358,11 @@ _clutter_actor_queue_redraw_full (ClutterActor       *self,
    * paint.
    */
 
+  /* the retained paint nodes are not valid any more, regardless of
+   * whether the redraw is going to be queued on the stage
+   */
+  priv->paint_nodes_valid = FALSE;
+
   /* ignore queueing a redraw for actors being destroyed */
   if (CLUTTER_ACTOR_IN_DESTRUCTION (self))
     return;
@@ -8670,11 +9427,10 @@ _clutter_actor_queue_redraw_full (ClutterActor       *self,
       should_free_pv = FALSE;
     }
 
-  self->priv->queue_redraw_entry =
-    _clutter_stage_queue_actor_redraw (CLUTTER_STAGE (stage),
-                                       priv->queue_redraw_entry,
-                                       self,
-                                       pv);
+  _clutter_stage_queue_actor_redraw (CLUTTER_STAGE (stage),
+                                     &priv->queue_redraw_entry,
+                                     self,
+                                     pv);
 
   if (should_free_pv)
     clutter_paint_volume_free (pv);
@@ -8800,6 +9556,131 @@ _clutter_actor_queue_redraw_with_clip (ClutterActor       *self,
                                     NULL /* effect */);
 }
 
+/*< private >
+ * clutter_actor_is_relayout_boundary:
+ * @self: a #ClutterActor
+ *
+ * Checks whether a relayout queued by the children of @self can stop
+ * at @self instead of being propagated to the stage.
+ *
+ * This is the case for mapped actors whose preferred size is fixed,
+ * with no constraints and not already waiting for an allocation from
+ * their parent, as the allocation they receive from their parent does
+ * not depend on their children.
+ *
+ * The relayout must still be propagated if the expand flags of @self
+ * have to be recomputed, as the parent of @self allocates it using
+ * them, or if any actor between @self and the stage relies on the
+ * ::queue-relayout signal: a clone, a class overriding the default
+ * handler, or a signal handler, like the ones of the bind and snap
+ * constraints.
+ */
+static inline gboolean
+clutter_actor_is_relayout_boundary (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+  ClutterActor *iter;
+
+  if (CLUTTER_ACTOR_IS_TOPLEVEL (self) ||
+      !CLUTTER_ACTOR_IS_MAPPED (self) ||
+      CLUTTER_ACTOR_IN_DESTRUCTION (self))
+    return FALSE;
+
+  if (!(priv->min_width_set && priv->natural_width_set &&
+        priv->min_height_set && priv->natural_height_set))
+    return FALSE;
+
+  /* constraints can depend on the allocation of any other actor */
+  if (priv->constraints != NULL)
+    return FALSE;
+
+  /* an actor already waiting for an allocation has either been queued
+   * as a boundary or has queued a relayout on its parent
+   */
+  if (priv->needs_allocation && !priv->relayout_root_queued)
+    return FALSE;
+
+  if (priv->needs_compute_expand)
+    return FALSE;
+
+  for (iter = self; iter != NULL; iter = iter->priv->parent)
+    {
+      if (CLUTTER_ACTOR_IS_TOPLEVEL (iter))
+        break;
+
+      if (iter->priv->clones != NULL)
+        return FALSE;
+
+      if (CLUTTER_ACTOR_GET_CLASS (iter)->queue_relayout !=
+          clutter_actor_real_queue_relayout)
+        return FALSE;
+
+      if (g_signal_has_handler_pending (iter,
+                                        actor_signals[QUEUE_RELAYOUT],
+                                        0,
+                                        TRUE))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static void
+clutter_actor_queue_boundary_relayout (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+  ClutterActor *stage;
+
+  priv->needs_width_request  = TRUE;
+  priv->needs_height_request = TRUE;
+  priv->needs_allocation     = TRUE;
+
+  if (priv->relayout_root_queued)
+    return;
+
+  stage = _clutter_actor_get_stage_internal (self);
+  if (stage == NULL)
+    return;
+
+  CLUTTER_NOTE (LAYOUT, "Queueing relayout boundary '%s'",
+                _clutter_actor_get_debug_name (self));
+
+  priv->relayout_root_queued = TRUE;
+  _clutter_stage_queue_relayout_root (CLUTTER_STAGE (stage), self);
+}
+
+/*< private >
+ * _clutter_actor_relayout_boundary:
+ * @self: a #ClutterActor
+ *
+ * Re-allocates a relayout boundary queued by the stage using its
+ * current allocation, if the relayout of the stage did not already
+ * allocate it.
+ */
+void
+_clutter_actor_relayout_boundary (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+
+  priv->relayout_root_queued = FALSE;
+
+  if (CLUTTER_ACTOR_IN_DESTRUCTION (self) || !priv->needs_allocation)
+    return;
+
+  if (_clutter_actor_get_stage_internal (self) == NULL)
+    return;
+
+  CLUTTER_NOTE (LAYOUT, "Re-allocating relayout boundary '%s'",
+                _clutter_actor_get_debug_name (self));
+
+  /* the stored allocation has already been adjusted for the margins,
+   * alignment and constraints, so we bypass clutter_actor_allocate()
+   */
+  clutter_actor_allocate_internal (self,
+                                   &priv->allocation,
+                                   CLUTTER_ALLOCATION_NONE);
+}
+
 static void
 _clutter_actor_queue_only_relayout (ClutterActor *self)
 {
@@ -11630,7 +12511,7 @@ clutter_actor_set_depth_internal (ClutterActor *self,
       /* Sets Z value - XXX 2.0: should we invert? */
       info->z_position = depth;
 
-      self->priv->transform_valid = FALSE;
+      clutter_actor_invalidate_transform (self);
 
       /* FIXME - remove this crap; sadly, there are still containers
        * in Clutter that depend on this utter brain damage
@@ -11655,7 +12536,7 @@ clutter_actor_set_z_position_internal (ClutterActor *self,
     {
       info->z_position = z_position;
 
-      self->priv->transform_valid = FALSE;
+      clutter_actor_invalidate_transform (self);
 
       clutter_actor_queue_redraw (self);
 
@@ -12084,6 +12965,7 @@ clutter_actor_set_clip (ClutterActor *self,
 
   priv->has_clip = TRUE;
 
+  clutter_actor_invalidate_pick_index (self);
   clutter_actor_queue_redraw (self);
 
   g_object_notify_by_pspec (obj, obj_props[PROP_CLIP]);
@@ -12107,6 +12989,7 @@ clutter_actor_remove_clip (ClutterActor *self)
 
   self->priv->has_clip = FALSE;
 
+  clutter_actor_invalidate_pick_index (self);
   clutter_actor_queue_redraw (self);
 
   g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_HAS_CLIP]);
@@ -12578,6 +13461,9 @@ clutter_actor_add_child_internal (ClutterActor              *self,
 
   self->priv->age += 1;
 
+  if (CLUTTER_ACTOR_IS_MAPPED (self))
+    clutter_actor_invalidate_pick_index (self);
+
   /* if push_internal() has been called then we automatically set
    * the flag on the actor
    */
@@ -13629,6 +14515,8 @@ clutter_actor_set_reactive (ClutterActor *actor,
   else
     CLUTTER_ACTOR_UNSET_FLAGS (actor, CLUTTER_ACTOR_REACTIVE);
 
+  clutter_actor_invalidate_pick_index (actor);
+
   g_object_notify_by_pspec (G_OBJECT (actor), obj_props[PROP_REACTIVE]);
 }
 
@@ -13736,7 +14624,7 @@ clutter_actor_set_anchor_point (ClutterActor *self,
 
   if (changed)
     {
-      priv->transform_valid = FALSE;
+      clutter_actor_invalidate_transform (self);
       clutter_actor_queue_redraw (self);
     }
 
@@ -13902,7 +14790,7 @@ clutter_actor_set_anchor_point_from_gravity (ClutterActor   *self,
       g_object_notify_by_pspec (obj, obj_props[PROP_ANCHOR_X]);
       g_object_notify_by_pspec (obj, obj_props[PROP_ANCHOR_Y]);
 
-      self->priv->transform_valid = FALSE;
+      clutter_actor_invalidate_transform (self);
 
       clutter_actor_queue_redraw (self);
 
@@ -14774,6 +15662,204 @@ clutter_animatable_iface_init (ClutterAnimatableIface *iface)
   iface->set_final_state = clutter_actor_set_final_state;
 }
 
+/*< private >
+ * _clutter_actor_get_animation_lanes:
+ * @self: a #ClutterActor
+ * @pspec: an animatable property of @self
+ * @types: (out caller-allocates): return location for the type of
+ *   each component of the property
+ * @targets: (out caller-allocates): return location for the address
+ *   of each component of the property
+ * @n_lanes: (out): return location for the number of components
+ *
+ * Retrieves the fields of the private state of @self that hold the
+ * value of @pspec, so that the transitions of @pspec can be evaluated
+ * by the animation batch instead of clutter_actor_set_final_state().
+ *
+ * The @types and @targets arrays must be able to hold at least
+ * %CLUTTER_ANIMATION_BATCH_MAX_LANES elements.
+ *
+ * Return value: %TRUE if the transitions of @pspec can be batched
+ */
+gboolean
+_clutter_actor_get_animation_lanes (ClutterActor             *self,
+                                    GParamSpec               *pspec,
+                                    ClutterAnimationLaneType *types,
+                                    gpointer                 *targets,
+                                    guint                    *n_lanes)
+{
+  ClutterActorPrivate *priv = self->priv;
+  ClutterAnimatableIface *iface;
+  ClutterTransformInfo *info;
+
+  /* sub-classes may override the interpolation, or the way the final
+   * state is set, e.g. to track the animated values
+   */
+  iface = CLUTTER_ANIMATABLE_GET_IFACE (self);
+  if (iface->interpolate_value != NULL ||
+      iface->set_final_state != clutter_actor_set_final_state)
+    return FALSE;
+
+  if (pspec == obj_props[PROP_OPACITY])
+    {
+      types[0] = CLUTTER_ANIMATION_LANE_UINT8;
+      targets[0] = &priv->opacity;
+      *n_lanes = 1;
+
+      return TRUE;
+    }
+
+  if (pspec == obj_props[PROP_BACKGROUND_COLOR])
+    {
+      types[0] = types[1] = types[2] = types[3] = CLUTTER_ANIMATION_LANE_UINT8;
+      targets[0] = &priv->bg_color.red;
+      targets[1] = &priv->bg_color.green;
+      targets[2] = &priv->bg_color.blue;
+      targets[3] = &priv->bg_color.alpha;
+      *n_lanes = 4;
+
+      return TRUE;
+    }
+
+  /* the transformation info is allocated once, so the addresses of
+   * its fields stay valid for the lifetime of the actor
+   */
+  if (pspec == obj_props[PROP_TRANSLATION_X] ||
+      pspec == obj_props[PROP_TRANSLATION_Y] ||
+      pspec == obj_props[PROP_TRANSLATION_Z])
+    {
+      info = _clutter_actor_get_transform_info (self);
+
+      types[0] = CLUTTER_ANIMATION_LANE_FLOAT;
+      if (pspec == obj_props[PROP_TRANSLATION_X])
+        targets[0] = &info->translation.x;
+      else if (pspec == obj_props[PROP_TRANSLATION_Y])
+        targets[0] = &info->translation.y;
+      else
+        targets[0] = &info->translation.z;
+      *n_lanes = 1;
+
+      return TRUE;
+    }
+
+  if (pspec == obj_props[PROP_SCALE_X] ||
+      pspec == obj_props[PROP_SCALE_Y] ||
+      pspec == obj_props[PROP_SCALE_Z])
+    {
+      info = _clutter_actor_get_transform_info (self);
+
+      types[0] = CLUTTER_ANIMATION_LANE_DOUBLE;
+      if (pspec == obj_props[PROP_SCALE_X])
+        targets[0] = &info->scale_x;
+      else if (pspec == obj_props[PROP_SCALE_Y])
+        targets[0] = &info->scale_y;
+      else
+        targets[0] = &info->scale_z;
+      *n_lanes = 1;
+
+      return TRUE;
+    }
+
+  if (pspec == obj_props[PROP_ROTATION_ANGLE_X] ||
+      pspec == obj_props[PROP_ROTATION_ANGLE_Y] ||
+      pspec == obj_props[PROP_ROTATION_ANGLE_Z])
+    {
+      info = _clutter_actor_get_transform_info (self);
+
+      types[0] = CLUTTER_ANIMATION_LANE_DOUBLE;
+      if (pspec == obj_props[PROP_ROTATION_ANGLE_X])
+        targets[0] = &info->rx_angle;
+      else if (pspec == obj_props[PROP_ROTATION_ANGLE_Y])
+        targets[0] = &info->ry_angle;
+      else
+        targets[0] = &info->rz_angle;
+      *n_lanes = 1;
+
+      return TRUE;
+    }
+
+  return FALSE;
+}
+
+/*< private >
+ * _clutter_actor_animated_property_changed:
+ * @self: a #ClutterActor
+ * @pspec: a property of @self
+ *
+ * Called by the animation batch after writing the value of @pspec
+ * into the private state of @self.
+ *
+ * The change is notified only if somebody is listening, either a
+ * handler of #GObject::notify or a sub-class overriding the notify()
+ * virtual function, since the notification is the most expensive part
+ * of setting a property; the redraw is deferred until
+ * _clutter_actor_flush_animated_changes().
+ */
+void
+_clutter_actor_animated_property_changed (ClutterActor *self,
+                                          GParamSpec   *pspec)
+{
+  static guint notify_signal_id = 0;
+  ClutterActorPrivate *priv = self->priv;
+
+  if (pspec == obj_props[PROP_OPACITY])
+    priv->animated_opacity_changed = TRUE;
+  else if (pspec == obj_props[PROP_BACKGROUND_COLOR])
+    {
+      priv->animated_paint_changed = TRUE;
+
+      if (!priv->bg_color_set)
+        {
+          priv->bg_color_set = TRUE;
+          g_object_notify_by_pspec (G_OBJECT (self),
+                                    obj_props[PROP_BACKGROUND_COLOR_SET]);
+        }
+    }
+  else
+    priv->animated_transform_changed = TRUE;
+
+  if (G_UNLIKELY (notify_signal_id == 0))
+    notify_signal_id = g_signal_lookup ("notify", G_TYPE_OBJECT);
+
+  if (G_OBJECT_GET_CLASS (self)->notify != NULL ||
+      g_signal_has_handler_pending (self,
+                                    notify_signal_id,
+                                    g_param_spec_get_name_quark (pspec),
+                                    FALSE))
+    g_object_notify_by_pspec (G_OBJECT (self), pspec);
+}
+
+/*< private >
+ * _clutter_actor_flush_animated_changes:
+ * @self: a #ClutterActor
+ *
+ * Invalidates the transformation of @self and queues a redraw, if any
+ * of the properties written by the animation batch require it.
+ */
+void
+_clutter_actor_flush_animated_changes (ClutterActor *self)
+{
+  ClutterActorPrivate *priv = self->priv;
+
+  if (priv->animated_transform_changed)
+    clutter_actor_invalidate_transform (self);
+
+  if (priv->animated_transform_changed || priv->animated_paint_changed)
+    clutter_actor_queue_redraw (self);
+  else if (priv->animated_opacity_changed)
+    {
+      /* see clutter_actor_set_opacity_internal() */
+      _clutter_actor_queue_redraw_full (self,
+                                        0, /* flags */
+                                        NULL, /* clip */
+                                        priv->flatten_effect);
+    }
+
+  priv->animated_transform_changed = FALSE;
+  priv->animated_opacity_changed = FALSE;
+  priv->animated_paint_changed = FALSE;
+}
+
 /**
  * clutter_actor_transform_stage_point:
  * @self: A #ClutterActor
@@ -15763,7 +16849,10 @@ clutter_actor_set_flags (ClutterActor      *self,
   visible_set  = ((self->flags & CLUTTER_ACTOR_VISIBLE)  != 0);
 
   if (reactive_set != was_reactive_set)
-    g_object_notify_by_pspec (obj, obj_props[PROP_REACTIVE]);
+    {
+      clutter_actor_invalidate_pick_index (self);
+      g_object_notify_by_pspec (obj, obj_props[PROP_REACTIVE]);
+    }
 
   if (realized_set != was_realized_set)
     g_object_notify_by_pspec (obj, obj_props[PROP_REALIZED]);
@@ -15823,7 +16912,10 @@ clutter_actor_unset_flags (ClutterActor      *self,
   visible_set  = ((self->flags & CLUTTER_ACTOR_VISIBLE)  != 0);
 
   if (reactive_set != was_reactive_set)
-    g_object_notify_by_pspec (obj, obj_props[PROP_REACTIVE]);
+    {
+      clutter_actor_invalidate_pick_index (self);
+      g_object_notify_by_pspec (obj, obj_props[PROP_REACTIVE]);
+    }
 
   if (realized_set != was_realized_set)
     g_object_notify_by_pspec (obj, obj_props[PROP_REALIZED]);
@@ -15873,7 +16965,7 @@ clutter_actor_set_transform_internal (ClutterActor        *self,
   info->transform = *transform;
   info->transform_set = !cogl_matrix_is_identity (&info->transform);
 
-  self->priv->transform_valid = FALSE;
+  clutter_actor_invalidate_transform (self);
 
   clutter_actor_queue_redraw (self);
 
@@ -16684,6 +17776,7 @@ clutter_actor_set_clip_to_allocation (ClutterActor *self,
     {
       priv->clip_to_allocation = clip_set;
 
+      clutter_actor_invalidate_pick_index (self);
       clutter_actor_queue_redraw (self);
 
       g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_CLIP_TO_ALLOCATION]);
@@ -16897,6 +17990,7 @@ clutter_actor_clear_effects (ClutterActor *self)
 
   _clutter_meta_group_clear_metas_no_internal (self->priv->effects);
 
+  clutter_actor_invalidate_pick_index (self);
   clutter_actor_queue_redraw (self);
 }
 
@@ -20088,7 +21182,7 @@ clutter_actor_set_child_transform_internal (ClutterActor        *self,
   /* we need to reset the transform_valid flag on each child */
   clutter_actor_iter_init (&iter, self);
   while (clutter_actor_iter_next (&iter, &child))
-    child->priv->transform_valid = FALSE;
+    clutter_actor_invalidate_transform (child);
 
   clutter_actor_queue_redraw (self);
 
@@ -92,6 +92,28 @@ typedef void (*ClutterCallback) (ClutterActor *actor,
  */
 #define CLUTTER_CALLBACK(f)        ((ClutterCallback) (f))
 
+#ifdef CLUTTER_ENABLE_EXPERIMENTAL_API
+/**
+ * ClutterActorPickShapeFunc:
+ * @actor: the #ClutterActor being picked
+ * @x: the X coordinate of the pick point, relative to @actor
+ * @y: the Y coordinate of the pick point, relative to @actor
+ * @user_data: (closure): data passed to clutter_actor_set_pick_shape_func()
+ *
+ * A function used to check whether a point inside the allocation
+ * of an actor belongs to its pick shape.
+ *
+ * Return value: %TRUE if the point is inside the pick shape
+ *
+ * Since: 1.14
+ * Stability: unstable
+ */
+typedef gboolean (* ClutterActorPickShapeFunc) (ClutterActor *actor,
+                                                gfloat        x,
+                                                gfloat        y,
+                                                gpointer      user_data);
+#endif
+
 /**
  * ClutterActor:
  * @flags: #ClutterActorFlags
@@ -180,7 +202,8 @@ struct _ClutterActor
  *   to get the correct opacity. See
  *   clutter_actor_set_offscreen_redirect() for details.
  * @paint_node: virtual function for creating paint nodes and attaching
- *   them to the render tree
+ *   them to the render tree; the nodes are retained and painted again
+ *   until the next call to clutter_actor_queue_redraw()
  * @touch_event: signal class closure for #ClutterActor::touch-event
  *
  * Base class for actors.
@@ -730,6 +753,15 @@ void                            clutter_actor_remove_transition
 CLUTTER_AVAILABLE_IN_1_10
 void                            clutter_actor_remove_all_transitions            (ClutterActor               *self);
 
+#ifdef CLUTTER_ENABLE_EXPERIMENTAL_API
+/* Picking */
+CLUTTER_AVAILABLE_IN_1_14
+void                            clutter_actor_set_pick_shape_func               (ClutterActor               *self,
+                                                                                 ClutterActorPickShapeFunc   func,
+                                                                                 gpointer                    user_data,
+                                                                                 GDestroyNotify              notify);
+#endif
+
 G_END_DECLS
 
 #endif /* __CLUTTER_ACTOR_H__ */
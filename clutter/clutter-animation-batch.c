@@ -0,0 +1,507 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2013  Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * ClutterAnimationBatch:
+ *
+ * The animation batch evaluates the transitions of the built-in numeric
+ * properties of #ClutterActor without going through #GValue, the
+ * #ClutterInterval and #ClutterAnimatable virtual functions, and the
+ * GObject property machinery.
+ *
+ * Each transition adds an entry to the batch, made of one lane for each
+ * numeric component of the property: one for a float or a double, four
+ * for a #ClutterColor. The lanes of all the entries are stored as a
+ * structure of arrays — initial value, final value, progress, result and
+ * the address of the field of the actor they are written to — so that
+ * they can all be evaluated in a single loop that the compiler is able
+ * to vectorize.
+ *
+ * While the master clock advances the timelines, between a call to
+ * _clutter_animation_batch_begin() and a call to
+ * _clutter_animation_batch_flush(), the transitions only update the
+ * progress of their entries; the flush evaluates all the lanes, writes
+ * the results to the actors, and queues a single relayout of the
+ * transformation and a single redraw for each actor.
+ *
+ * The lanes are evaluated in single precision, so the last frame of a
+ * transition is not written by the batch: the transition sets the exact
+ * final value through the #ClutterInterval instead. The transitions with
+ * handlers of #ClutterTimeline::new-frame write their values immediately,
+ * so that the handlers see the value of the current frame.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "clutter-animation-batch.h"
+
+#include "clutter-actor-private.h"
+#include "clutter-debug.h"
+#include "clutter-private.h"
+#include "clutter-profile.h"
+
+struct _ClutterAnimationBatchEntry
+{
+  ClutterActor *actor;
+  GParamSpec *pspec;
+
+  guint n_lanes;
+  guint lanes[CLUTTER_ANIMATION_BATCH_MAX_LANES];
+
+  /* the position in the list of dirty entries, plus one; or zero if
+   * the entry has been written since its progress last changed
+   */
+  guint dirty_slot;
+};
+
+typedef struct _ClutterAnimationBatch
+{
+  /* the lanes, as a structure of arrays */
+  gfloat *start;
+  gfloat *end;
+  gfloat *progress;
+  gfloat *value;
+  gpointer *target;
+  guint8 *type;
+  ClutterAnimationBatchEntry **owner;
+
+  guint n_lanes;
+  guint size;
+
+  /* the entries with a pending write, in the order their progress was
+   * set; removed entries leave a NULL behind
+   */
+  GPtrArray *dirty;
+
+  guint batching;
+} ClutterAnimationBatch;
+
+static ClutterAnimationBatch batch = { NULL, };
+
+static void
+clutter_animation_batch_grow (void)
+{
+  guint size = MAX (batch.size * 2, 64);
+
+  batch.start = g_renew (gfloat, batch.start, size);
+  batch.end = g_renew (gfloat, batch.end, size);
+  batch.progress = g_renew (gfloat, batch.progress, size);
+  batch.value = g_renew (gfloat, batch.value, size);
+  batch.target = g_renew (gpointer, batch.target, size);
+  batch.type = g_renew (guint8, batch.type, size);
+  batch.owner = g_renew (ClutterAnimationBatchEntry *, batch.owner, size);
+
+  batch.size = size;
+}
+
+static gfloat
+read_lane (guint i)
+{
+  switch (batch.type[i])
+    {
+    case CLUTTER_ANIMATION_LANE_UINT8:
+      return *(guint8 *) batch.target[i];
+
+    case CLUTTER_ANIMATION_LANE_FLOAT:
+      return *(gfloat *) batch.target[i];
+
+    case CLUTTER_ANIMATION_LANE_DOUBLE:
+      return *(gdouble *) batch.target[i];
+    }
+
+  return 0.f;
+}
+
+/* writes the value of a lane to the actor, and returns whether the
+ * value of the field changed
+ */
+static gboolean
+write_lane (guint i)
+{
+  gfloat value = batch.value[i];
+
+  switch (batch.type[i])
+    {
+    case CLUTTER_ANIMATION_LANE_UINT8:
+      {
+        guint8 *field = batch.target[i];
+        guint8 v;
+
+        /* truncate like the interpolation of integers and colors does */
+        v = (guint8) CLAMP (value, 0.f, 255.f);
+        if (*field == v)
+          return FALSE;
+
+        *field = v;
+      }
+      break;
+
+    case CLUTTER_ANIMATION_LANE_FLOAT:
+      {
+        gfloat *field = batch.target[i];
+
+        if (*field == value)
+          return FALSE;
+
+        *field = value;
+      }
+      break;
+
+    case CLUTTER_ANIMATION_LANE_DOUBLE:
+      {
+        gdouble *field = batch.target[i];
+
+        if (*field == value)
+          return FALSE;
+
+        *field = value;
+      }
+      break;
+    }
+
+  return TRUE;
+}
+
+static void
+clutter_animation_batch_mark_clean (ClutterAnimationBatchEntry *entry)
+{
+  if (entry->dirty_slot == 0)
+    return;
+
+  g_ptr_array_index (batch.dirty, entry->dirty_slot - 1) = NULL;
+  entry->dirty_slot = 0;
+}
+
+/* writes the lanes of @entry to its actor; the lanes must have been
+ * evaluated already. Returns whether the property changed
+ */
+static gboolean
+clutter_animation_batch_write_entry (ClutterAnimationBatchEntry *entry)
+{
+  gboolean changed = FALSE;
+  guint i;
+
+  clutter_animation_batch_mark_clean (entry);
+
+  for (i = 0; i < entry->n_lanes; i++)
+    changed |= write_lane (entry->lanes[i]);
+
+  if (changed)
+    _clutter_actor_animated_property_changed (entry->actor, entry->pspec);
+
+  return changed;
+}
+
+/*
+ * _clutter_animation_batch_add:
+ * @actor: the #ClutterActor being animated
+ * @pspec: the animated property of @actor
+ * @n_lanes: the number of components of the property
+ * @types: (array length=n_lanes): the type of each component
+ * @targets: (array length=n_lanes): the address of each component
+ *
+ * Adds an entry for a transition of @pspec to the batch. The initial and
+ * final values of the lanes are set to the current value of the
+ * property.
+ *
+ * The batch does not hold a reference on @actor: the entry must be
+ * removed before the actor is finalized, or the fields at @targets
+ * are released.
+ *
+ * Return value: the newly added entry
+ */
+ClutterAnimationBatchEntry *
+_clutter_animation_batch_add (ClutterActor                   *actor,
+                              GParamSpec                     *pspec,
+                              guint                           n_lanes,
+                              const ClutterAnimationLaneType *types,
+                              gpointer const                 *targets)
+{
+  ClutterAnimationBatchEntry *entry;
+  guint i;
+
+  g_return_val_if_fail (n_lanes > 0, NULL);
+  g_return_val_if_fail (n_lanes <= CLUTTER_ANIMATION_BATCH_MAX_LANES, NULL);
+
+  if (batch.dirty == NULL)
+    batch.dirty = g_ptr_array_new ();
+
+  entry = g_slice_new0 (ClutterAnimationBatchEntry);
+  entry->actor = actor;
+  entry->pspec = pspec;
+  entry->n_lanes = n_lanes;
+
+  for (i = 0; i < n_lanes; i++)
+    {
+      guint lane;
+
+      if (batch.n_lanes == batch.size)
+        clutter_animation_batch_grow ();
+
+      lane = batch.n_lanes++;
+
+      batch.target[lane] = targets[i];
+      batch.type[lane] = types[i];
+      batch.owner[lane] = entry;
+      batch.start[lane] = batch.end[lane] = read_lane (lane);
+      batch.progress[lane] = 0.f;
+      batch.value[lane] = batch.start[lane];
+
+      entry->lanes[i] = lane;
+    }
+
+  return entry;
+}
+
+/* moves the last lane into the slot of @lane */
+static void
+clutter_animation_batch_remove_lane (guint lane)
+{
+  guint last = batch.n_lanes - 1;
+
+  if (lane != last)
+    {
+      ClutterAnimationBatchEntry *owner = batch.owner[last];
+      guint i;
+
+      batch.start[lane] = batch.start[last];
+      batch.end[lane] = batch.end[last];
+      batch.progress[lane] = batch.progress[last];
+      batch.value[lane] = batch.value[last];
+      batch.target[lane] = batch.target[last];
+      batch.type[lane] = batch.type[last];
+      batch.owner[lane] = owner;
+
+      for (i = 0; i < owner->n_lanes; i++)
+        {
+          if (owner->lanes[i] == last)
+            {
+              owner->lanes[i] = lane;
+              break;
+            }
+        }
+    }
+
+  batch.n_lanes -= 1;
+}
+
+/*
+ * _clutter_animation_batch_remove:
+ * @entry: an entry of the batch
+ *
+ * Removes @entry from the batch. If the entry has a pending write, the
+ * current value of the transition is written to the actor first.
+ */
+void
+_clutter_animation_batch_remove (ClutterAnimationBatchEntry *entry)
+{
+  guint i, j;
+
+  g_return_if_fail (entry != NULL);
+
+  if (entry->dirty_slot != 0)
+    {
+      for (i = 0; i < entry->n_lanes; i++)
+        {
+          guint lane = entry->lanes[i];
+
+          batch.value[lane] = batch.start[lane]
+                            + (batch.end[lane] - batch.start[lane])
+                            * batch.progress[lane];
+        }
+
+      if (clutter_animation_batch_write_entry (entry))
+        _clutter_actor_flush_animated_changes (entry->actor);
+    }
+
+  /* remove the lanes from the highest to the lowest, so that the lane
+   * moved into a removed slot never belongs to @entry
+   */
+  for (i = 0; i < entry->n_lanes; i++)
+    {
+      for (j = i + 1; j < entry->n_lanes; j++)
+        {
+          if (entry->lanes[j] > entry->lanes[i])
+            {
+              guint tmp = entry->lanes[i];
+
+              entry->lanes[i] = entry->lanes[j];
+              entry->lanes[j] = tmp;
+            }
+        }
+
+      clutter_animation_batch_remove_lane (entry->lanes[i]);
+    }
+
+  g_slice_free (ClutterAnimationBatchEntry, entry);
+}
+
+void
+_clutter_animation_batch_set_lane (ClutterAnimationBatchEntry *entry,
+                                   guint                       lane,
+                                   gfloat                      start,
+                                   gfloat                      end)
+{
+  g_return_if_fail (lane < entry->n_lanes);
+
+  batch.start[entry->lanes[lane]] = start;
+  batch.end[entry->lanes[lane]] = end;
+}
+
+/*
+ * _clutter_animation_batch_set_progress:
+ * @entry: an entry of the batch
+ * @progress: the eased progress of the transition
+ * @flush: whether the value should be written immediately
+ *
+ * Sets the progress of the transition of @entry.
+ *
+ * The value of the property is written to the actor when the batch is
+ * flushed; if the master clock is not advancing the timelines, or if
+ * @flush is %TRUE, it is written immediately instead.
+ */
+void
+_clutter_animation_batch_set_progress (ClutterAnimationBatchEntry *entry,
+                                       gfloat                      progress,
+                                       gboolean                    flush)
+{
+  guint i;
+
+  for (i = 0; i < entry->n_lanes; i++)
+    batch.progress[entry->lanes[i]] = progress;
+
+  if (flush || batch.batching == 0)
+    {
+      for (i = 0; i < entry->n_lanes; i++)
+        {
+          guint lane = entry->lanes[i];
+
+          batch.value[lane] = batch.start[lane]
+                            + (batch.end[lane] - batch.start[lane])
+                            * progress;
+        }
+
+      if (clutter_animation_batch_write_entry (entry))
+        _clutter_actor_flush_animated_changes (entry->actor);
+
+      return;
+    }
+
+  if (entry->dirty_slot == 0)
+    {
+      g_ptr_array_add (batch.dirty, entry);
+      entry->dirty_slot = batch.dirty->len;
+    }
+}
+
+/*
+ * _clutter_animation_batch_begin:
+ *
+ * Defers the writes of the transitions until the next call to
+ * _clutter_animation_batch_flush().
+ */
+void
+_clutter_animation_batch_begin (void)
+{
+  batch.batching += 1;
+}
+
+/*
+ * _clutter_animation_batch_flush:
+ *
+ * Evaluates all the lanes of the batch, and writes the entries whose
+ * progress changed since the call to _clutter_animation_batch_begin().
+ */
+void
+_clutter_animation_batch_flush (void)
+{
+  const gfloat *start, *end, *progress;
+  ClutterActor *actor = NULL;
+  gfloat *value;
+  guint i, n_lanes;
+
+  CLUTTER_STATIC_COUNTER (batched_writes_counter,
+                          "Batched animation writes",
+                          "The number of properties written by the animation batch",
+                          0);
+
+  g_return_if_fail (batch.batching > 0);
+
+  batch.batching -= 1;
+  if (batch.batching > 0)
+    return;
+
+  if (batch.dirty == NULL || batch.dirty->len == 0)
+    return;
+
+  /* evaluating every lane is cheaper than skipping the clean ones,
+   * since the loop has no branches and no indirections
+   */
+  start = batch.start;
+  end = batch.end;
+  progress = batch.progress;
+  value = batch.value;
+  n_lanes = batch.n_lanes;
+
+  for (i = 0; i < n_lanes; i++)
+    value[i] = start[i] + (end[i] - start[i]) * progress[i];
+
+  /* the notifications might remove entries, or set the progress of
+   * other entries, which are then written immediately since we are not
+   * batching anymore
+   */
+  for (i = 0; i < batch.dirty->len; i++)
+    {
+      ClutterAnimationBatchEntry *entry = g_ptr_array_index (batch.dirty, i);
+
+      if (entry == NULL)
+        continue;
+
+      /* the transitions of an actor are usually advanced one after the
+       * other, so we queue the relayout of the transformation and the
+       * redraw once for each run of entries of the same actor
+       */
+      if (entry->actor != actor)
+        {
+          if (actor != NULL)
+            {
+              _clutter_actor_flush_animated_changes (actor);
+              g_object_unref (actor);
+            }
+
+          actor = g_object_ref (entry->actor);
+        }
+
+      clutter_animation_batch_write_entry (entry);
+
+      CLUTTER_COUNTER_INC (_clutter_uprof_context, batched_writes_counter);
+    }
+
+  if (actor != NULL)
+    {
+      _clutter_actor_flush_animated_changes (actor);
+      g_object_unref (actor);
+    }
+
+  g_ptr_array_set_size (batch.dirty, 0);
+}
@@ -0,0 +1,63 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2013  Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * ClutterAnimationBatch: batched evaluation of the transitions of the
+ * built-in numeric properties of ClutterActor.
+ */
+
+#ifndef __CLUTTER_ANIMATION_BATCH_H__
+#define __CLUTTER_ANIMATION_BATCH_H__
+
+#include <clutter/clutter-types.h>
+
+G_BEGIN_DECLS
+
+/* the largest number of lanes of an entry, used by ClutterColor */
+#define CLUTTER_ANIMATION_BATCH_MAX_LANES       4
+
+typedef struct _ClutterAnimationBatchEntry      ClutterAnimationBatchEntry;
+
+typedef enum {
+  CLUTTER_ANIMATION_LANE_UINT8,
+  CLUTTER_ANIMATION_LANE_FLOAT,
+  CLUTTER_ANIMATION_LANE_DOUBLE
+} ClutterAnimationLaneType;
+
+ClutterAnimationBatchEntry *    _clutter_animation_batch_add            (ClutterActor                   *actor,
+                                                                         GParamSpec                     *pspec,
+                                                                         guint                           n_lanes,
+                                                                         const ClutterAnimationLaneType *types,
+                                                                         gpointer const                 *targets);
+void                            _clutter_animation_batch_remove         (ClutterAnimationBatchEntry     *entry);
+
+void                            _clutter_animation_batch_set_lane       (ClutterAnimationBatchEntry     *entry,
+                                                                         guint                           lane,
+                                                                         gfloat                          start,
+                                                                         gfloat                          end);
+void                            _clutter_animation_batch_set_progress   (ClutterAnimationBatchEntry     *entry,
+                                                                         gfloat                          progress,
+                                                                         gboolean                        flush);
+
+void                            _clutter_animation_batch_begin          (void);
+void                            _clutter_animation_batch_flush          (void);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_ANIMATION_BATCH_H__ */
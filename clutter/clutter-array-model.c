@@ -0,0 +1,1866 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2013  Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:clutter-array-model
+ * @short_description: Columnar model implementation
+ *
+ * #ClutterArrayModel is a #ClutterModel implementation storing the
+ * values of each column inside a typed array, instead of storing each
+ * row as an array of #GValue<!-- -->s like #ClutterListModel does.
+ *
+ * The columns of a #ClutterArrayModel can only hold integers, unsigned
+ * integers, floating point values, double precision floating point
+ * values, booleans and strings; in exchange, the model uses a fraction
+ * of the memory used by a #ClutterListModel holding the same data, rows
+ * can be appended in bulk from C arrays using
+ * clutter_array_model_append_rows(), and the values can be read without
+ * copying them using the typed getters, like clutter_array_model_get_int()
+ * or clutter_array_model_get_string().
+ *
+ * Sorting a #ClutterArrayModel only reorders an array of row indices,
+ * and the values themselves never move. When a filter is set, the model
+ * keeps the positions of the visible rows, so that looking up a row and
+ * iterating over the model do not call the filter function on every row;
+ * like #ClutterListModel, the filter function is called again on a row
+ * only when the row changes.
+ *
+ * Like the iterators of a #ClutterListModel, a #ClutterModelIter of a
+ * #ClutterArrayModel stays on the same row when other rows are added,
+ * removed or when the model is sorted again, for instance after changing
+ * the value of the sorting column through the iterator itself; its
+ * #ClutterModelIter:row is updated accordingly. An iterator on a row that
+ * has been removed points past the last row.
+ *
+ * #ClutterArrayModel is available since Clutter 1.14
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include <glib-object.h>
+
+#include "clutter-array-model.h"
+
+#include "clutter-debug.h"
+#include "clutter-model-private.h"
+#include "clutter-private.h"
+
+#define CLUTTER_TYPE_ARRAY_MODEL_ITER           (clutter_array_model_iter_get_type ())
+#define CLUTTER_ARRAY_MODEL_ITER(obj)           (G_TYPE_CHECK_INSTANCE_CAST ((obj), CLUTTER_TYPE_ARRAY_MODEL_ITER, ClutterArrayModelIter))
+#define CLUTTER_IS_ARRAY_MODEL_ITER(obj)        (G_TYPE_CHECK_INSTANCE_TYPE ((obj), CLUTTER_TYPE_ARRAY_MODEL_ITER))
+
+typedef struct _ClutterArrayModelIter   ClutterArrayModelIter;
+typedef struct _ClutterModelIterClass   ClutterArrayModelIterClass;
+
+#define CLUTTER_ARRAY_MODEL_GET_PRIVATE(obj)    (G_TYPE_INSTANCE_GET_PRIVATE ((obj), CLUTTER_TYPE_ARRAY_MODEL, ClutterArrayModelPrivate))
+
+typedef struct _ArrayColumn
+{
+  /* the fundamental type of the column */
+  GType type;
+
+  /* the values of the column, indexed by slot */
+  GArray *values;
+} ArrayColumn;
+
+struct _ClutterArrayModelPrivate
+{
+  ArrayColumn *columns;
+  guint n_columns;
+
+  /* the slot of each row, in the order of the model; sorting the
+   * model only sorts this array
+   */
+  GArray *order;
+
+  /* the slots of the removed rows, reused by the new rows, and the
+   * generation of each slot, incremented when its row is removed so
+   * that the iterators on that row don't follow the next one
+   */
+  GArray *free_slots;
+  GArray *slot_generations;
+  guint n_slots;
+
+  ClutterModelIter *temp_iter;
+
+  /* the positions of the rows visible through the filter, in increasing
+   * order, and whether the row in each slot is visible; the positions in
+   * the dirty array have been added or changed, and have to go through
+   * the filter again before the index can be used
+   */
+  GArray *visible_rows;
+  GArray *visible_slots;
+  GArray *dirty_rows;
+
+  /* the filter stamp of the model when the index was built */
+  guint filter_stamp;
+
+  /* incremented each time rows are added, removed or reordered, which
+   * changes the positions of the slots; the position of each slot is
+   * built on demand, when an iterator outlives such a change
+   */
+  guint layout_stamp;
+  GArray *slot_positions;
+  guint slot_positions_stamp;
+
+  guint index_valid : 1;
+};
+
+/* the slot of the end iterators */
+#define END_SLOT        G_MAXUINT
+
+struct _ClutterArrayModelIter
+{
+  ClutterModelIter parent_instance;
+
+  /* the slot of the row, which does not change when rows are added,
+   * removed or reordered, and its generation; END_SLOT past the last
+   * row
+   */
+  guint slot;
+  guint generation;
+
+  /* the position of the row in the unfiltered model, valid as long as
+   * the layout stamp of the model is the same
+   */
+  guint position;
+  guint stamp;
+};
+
+GType clutter_array_model_iter_get_type (void);
+
+G_DEFINE_TYPE (ClutterArrayModelIter,
+               clutter_array_model_iter,
+               CLUTTER_TYPE_MODEL_ITER);
+
+G_DEFINE_TYPE (ClutterArrayModel, clutter_array_model, CLUTTER_TYPE_MODEL);
+
+static void clutter_array_model_iter_set_position (ClutterArrayModelIter *iter,
+                                                   ClutterArrayModel     *model,
+                                                   guint                  position);
+
+static gboolean
+array_column_check_type (GType gtype)
+{
+  switch (G_TYPE_FUNDAMENTAL (gtype))
+    {
+    case G_TYPE_INT:
+    case G_TYPE_UINT:
+    case G_TYPE_FLOAT:
+    case G_TYPE_DOUBLE:
+    case G_TYPE_BOOLEAN:
+    case G_TYPE_STRING:
+      return TRUE;
+
+    default:
+      return FALSE;
+    }
+}
+
+static void
+array_column_init (ArrayColumn *column,
+                   GType        gtype)
+{
+  guint element_size;
+
+  column->type = G_TYPE_FUNDAMENTAL (gtype);
+
+  switch (column->type)
+    {
+    case G_TYPE_INT:
+      element_size = sizeof (gint);
+      break;
+
+    case G_TYPE_UINT:
+      element_size = sizeof (guint);
+      break;
+
+    case G_TYPE_FLOAT:
+      element_size = sizeof (gfloat);
+      break;
+
+    case G_TYPE_DOUBLE:
+      element_size = sizeof (gdouble);
+      break;
+
+    case G_TYPE_BOOLEAN:
+      /* a byte is enough for a boolean */
+      element_size = sizeof (guint8);
+      break;
+
+    case G_TYPE_STRING:
+      element_size = sizeof (gchar *);
+      break;
+
+    default:
+      g_assert_not_reached ();
+      return;
+    }
+
+  column->values = g_array_new (FALSE, TRUE, element_size);
+}
+
+static void
+array_column_clear_slot (ArrayColumn *column,
+                         guint        slot)
+{
+  if (column->type == G_TYPE_STRING)
+    {
+      gchar **str = &g_array_index (column->values, gchar *, slot);
+
+      g_free (*str);
+      *str = NULL;
+    }
+  else
+    memset (column->values->data + slot * g_array_get_element_size (column->values),
+            0,
+            g_array_get_element_size (column->values));
+}
+
+static void
+array_column_free (ArrayColumn *column)
+{
+  guint i;
+
+  if (column->type == G_TYPE_STRING)
+    {
+      for (i = 0; i < column->values->len; i++)
+        g_free (g_array_index (column->values, gchar *, i));
+    }
+
+  g_array_free (column->values, TRUE);
+}
+
+/* @value must be initialized to the type of the column; if @copy is
+ * %FALSE, strings are not copied, and the value is only valid until
+ * the row changes
+ */
+static void
+array_column_get_value (ArrayColumn *column,
+                        guint        slot,
+                        GValue      *value,
+                        gboolean     copy)
+{
+  switch (column->type)
+    {
+    case G_TYPE_INT:
+      g_value_set_int (value, g_array_index (column->values, gint, slot));
+      break;
+
+    case G_TYPE_UINT:
+      g_value_set_uint (value, g_array_index (column->values, guint, slot));
+      break;
+
+    case G_TYPE_FLOAT:
+      g_value_set_float (value, g_array_index (column->values, gfloat, slot));
+      break;
+
+    case G_TYPE_DOUBLE:
+      g_value_set_double (value, g_array_index (column->values, gdouble, slot));
+      break;
+
+    case G_TYPE_BOOLEAN:
+      g_value_set_boolean (value, g_array_index (column->values, guint8, slot));
+      break;
+
+    case G_TYPE_STRING:
+      if (copy)
+        g_value_set_string (value, g_array_index (column->values, gchar *, slot));
+      else
+        g_value_set_static_string (value, g_array_index (column->values, gchar *, slot));
+      break;
+
+    default:
+      g_assert_not_reached ();
+    }
+}
+
+/* @value must hold the type of the column */
+static void
+array_column_set_value (ArrayColumn  *column,
+                        guint         slot,
+                        const GValue *value)
+{
+  switch (column->type)
+    {
+    case G_TYPE_INT:
+      g_array_index (column->values, gint, slot) = g_value_get_int (value);
+      break;
+
+    case G_TYPE_UINT:
+      g_array_index (column->values, guint, slot) = g_value_get_uint (value);
+      break;
+
+    case G_TYPE_FLOAT:
+      g_array_index (column->values, gfloat, slot) = g_value_get_float (value);
+      break;
+
+    case G_TYPE_DOUBLE:
+      g_array_index (column->values, gdouble, slot) = g_value_get_double (value);
+      break;
+
+    case G_TYPE_BOOLEAN:
+      g_array_index (column->values, guint8, slot) = g_value_get_boolean (value) ? 1 : 0;
+      break;
+
+    case G_TYPE_STRING:
+      {
+        gchar **str = &g_array_index (column->values, gchar *, slot);
+
+        g_free (*str);
+        *str = g_value_dup_string (value);
+      }
+      break;
+
+    default:
+      g_assert_not_reached ();
+    }
+}
+
+/* copies @n_values values from the C array @data, holding values of the
+ * type of the column, starting at @slot
+ */
+static void
+array_column_copy_values (ArrayColumn   *column,
+                          guint          slot,
+                          gconstpointer  data,
+                          guint          n_values)
+{
+  guint i;
+
+  switch (column->type)
+    {
+    case G_TYPE_INT:
+    case G_TYPE_UINT:
+    case G_TYPE_FLOAT:
+    case G_TYPE_DOUBLE:
+      memcpy (column->values->data + slot * g_array_get_element_size (column->values),
+              data,
+              n_values * g_array_get_element_size (column->values));
+      break;
+
+    case G_TYPE_BOOLEAN:
+      {
+        const gboolean *booleans = data;
+
+        for (i = 0; i < n_values; i++)
+          g_array_index (column->values, guint8, slot + i) = booleans[i] ? 1 : 0;
+      }
+      break;
+
+    case G_TYPE_STRING:
+      {
+        const gchar * const *strings = data;
+
+        for (i = 0; i < n_values; i++)
+          {
+            gchar **str = &g_array_index (column->values, gchar *, slot + i);
+
+            g_free (*str);
+            *str = g_strdup (strings[i]);
+          }
+      }
+      break;
+
+    default:
+      g_assert_not_reached ();
+    }
+}
+
+/* returns the index of the first visible row at or after @position */
+static guint
+clutter_array_model_lookup_visible (ClutterArrayModel *model,
+                                    guint              position)
+{
+  GArray *visible_rows = model->priv->visible_rows;
+  guint lo = 0, hi = visible_rows->len;
+
+  while (lo < hi)
+    {
+      guint mid = lo + (hi - lo) / 2;
+
+      if (g_array_index (visible_rows, guint, mid) < position)
+        lo = mid + 1;
+      else
+        hi = mid;
+    }
+
+  return lo;
+}
+
+static gboolean
+clutter_array_model_index_is_current (ClutterArrayModel *model)
+{
+  ClutterArrayModelPrivate *priv = model->priv;
+
+  return priv->index_valid &&
+         priv->filter_stamp == _clutter_model_get_filter_stamp (CLUTTER_MODEL (model));
+}
+
+static void
+clutter_array_model_invalidate_index (ClutterArrayModel *model)
+{
+  ClutterArrayModelPrivate *priv = model->priv;
+
+  if (!priv->index_valid)
+    return;
+
+  g_array_set_size (priv->visible_rows, 0);
+  g_array_set_size (priv->visible_slots, 0);
+  g_array_set_size (priv->dirty_rows, 0);
+
+  priv->index_valid = FALSE;
+}
+
+static gboolean
+clutter_array_model_filter_position (ClutterArrayModel *model,
+                                     guint              position)
+{
+  ClutterModelIter *temp_iter = model->priv->temp_iter;
+
+  clutter_array_model_iter_set_position (CLUTTER_ARRAY_MODEL_ITER (temp_iter),
+                                         model,
+                                         position);
+
+  return clutter_model_filter_iter (CLUTTER_MODEL (model), temp_iter);
+}
+
+/* makes sure that the index of the visible rows is up to date; it must
+ * only be called while a filter is set
+ */
+static void
+clutter_array_model_ensure_index (ClutterArrayModel *model)
+{
+  ClutterArrayModelPrivate *priv = model->priv;
+  guint i;
+
+  if (!clutter_array_model_index_is_current (model))
+    {
+      clutter_array_model_invalidate_index (model);
+
+      CLUTTER_NOTE (MISC, "Building the filter index of model %p (%u rows)",
+                    model,
+                    priv->order->len);
+
+      g_array_set_size (priv->visible_slots, priv->n_slots);
+
+      for (i = 0; i < priv->order->len; i++)
+        {
+          if (clutter_array_model_filter_position (model, i))
+            {
+              guint slot = g_array_index (priv->order, guint, i);
+
+              g_array_append_val (priv->visible_rows, i);
+              g_array_index (priv->visible_slots, guint8, slot) = 1;
+            }
+        }
+
+      priv->filter_stamp = _clutter_model_get_filter_stamp (CLUTTER_MODEL (model));
+      priv->index_valid = TRUE;
+
+      return;
+    }
+
+  for (i = 0; i < priv->dirty_rows->len; i++)
+    {
+      guint position = g_array_index (priv->dirty_rows, guint, i);
+      guint slot = g_array_index (priv->order, guint, position);
+      gboolean was_visible, is_visible;
+      guint index_;
+
+      was_visible = g_array_index (priv->visible_slots, guint8, slot);
+      is_visible = clutter_array_model_filter_position (model, position);
+
+      if (was_visible == is_visible)
+        continue;
+
+      index_ = clutter_array_model_lookup_visible (model, position);
+
+      if (is_visible)
+        g_array_insert_val (priv->visible_rows, index_, position);
+      else
+        g_array_remove_index (priv->visible_rows, index_);
+
+      g_array_index (priv->visible_slots, guint8, slot) = is_visible;
+    }
+
+  g_array_set_size (priv->dirty_rows, 0);
+}
+
+/* called when the row at @position has changed */
+static void
+clutter_array_model_queue_row (ClutterArrayModel *model,
+                               guint              position)
+{
+  ClutterArrayModelPrivate *priv = model->priv;
+
+  if (!clutter_array_model_index_is_current (model))
+    {
+      clutter_array_model_invalidate_index (model);
+      return;
+    }
+
+  g_array_append_val (priv->dirty_rows, position);
+}
+
+/* shifts the positions of the index after a row has been inserted at,
+ * or removed from, @position
+ */
+static void
+clutter_array_model_shift_index (ClutterArrayModel *model,
+                                 guint              position,
+                                 gint               shift)
+{
+  ClutterArrayModelPrivate *priv = model->priv;
+  guint i;
+
+  for (i = clutter_array_model_lookup_visible (model, position);
+       i < priv->visible_rows->len;
+       i++)
+    g_array_index (priv->visible_rows, guint, i) += shift;
+
+  for (i = 0; i < priv->dirty_rows->len; i++)
+    {
+      guint *dirty = &g_array_index (priv->dirty_rows, guint, i);
+
+      if (*dirty >= position)
+        *dirty += shift;
+    }
+}
+
+static guint
+clutter_array_model_alloc_slots (ClutterArrayModel *model,
+                                 guint              n_slots)
+{
+  ClutterArrayModelPrivate *priv = model->priv;
+  guint slot, i;
+
+  slot = priv->n_slots;
+  priv->n_slots += n_slots;
+
+  /* the arrays are cleared when they grow */
+  for (i = 0; i < priv->n_columns; i++)
+    g_array_set_size (priv->columns[i].values, priv->n_slots);
+
+  g_array_set_size (priv->slot_generations, priv->n_slots);
+
+  if (priv->index_valid)
+    g_array_set_size (priv->visible_slots, priv->n_slots);
+
+  return slot;
+}
+
+static guint
+clutter_array_model_get_slot (ClutterArrayModel *model,
+                              guint              position)
+{
+  return g_array_index (model->priv->order, guint, position);
+}
+
+static inline guint
+clutter_array_model_get_slot_generation (ClutterArrayModel *model,
+                                         guint              slot)
+{
+  return g_array_index (model->priv->slot_generations, guint, slot);
+}
+
+/* called each time the positions of the rows change */
+static inline void
+clutter_array_model_layout_changed (ClutterArrayModel *model)
+{
+  model->priv->layout_stamp += 1;
+}
+
+/* returns the position of @slot, or the end of the model if the row
+ * in @slot has been removed
+ */
+static guint
+clutter_array_model_get_slot_position (ClutterArrayModel *model,
+                                       guint              slot)
+{
+  ClutterArrayModelPrivate *priv = model->priv;
+  guint position;
+
+  if (priv->slot_positions_stamp != priv->layout_stamp)
+    {
+      guint i;
+
+      g_array_set_size (priv->slot_positions, priv->n_slots);
+      memset (priv->slot_positions->data, 0xff, priv->n_slots * sizeof (guint));
+
+      for (i = 0; i < priv->order->len; i++)
+        g_array_index (priv->slot_positions, guint,
+                       clutter_array_model_get_slot (model, i)) = i;
+
+      priv->slot_positions_stamp = priv->layout_stamp;
+    }
+
+  position = g_array_index (priv->slot_positions, guint, slot);
+
+  return position == G_MAXUINT ? priv->order->len : position;
+}
+
+/*
+ * ClutterArrayModelIter
+ */
+
+static void
+clutter_array_model_iter_set_position (ClutterArrayModelIter *iter,
+                                       ClutterArrayModel     *model,
+                                       guint                  position)
+{
+  ClutterArrayModelPrivate *priv = model->priv;
+
+  if (position < priv->order->len)
+    {
+      iter->slot = clutter_array_model_get_slot (model, position);
+      iter->generation = clutter_array_model_get_slot_generation (model, iter->slot);
+    }
+  else
+    {
+      iter->slot = END_SLOT;
+      position = priv->order->len;
+    }
+
+  iter->position = position;
+  iter->stamp = priv->layout_stamp;
+}
+
+/* returns the current position of the row of @iter, which follows its
+ * row when other rows are added, removed or reordered
+ */
+static guint
+clutter_array_model_iter_get_position (ClutterArrayModelIter *iter,
+                                       ClutterArrayModel     *model)
+{
+  ClutterArrayModelPrivate *priv = model->priv;
+
+  if (iter->stamp == priv->layout_stamp)
+    return iter->position;
+
+  /* the row has been removed, even if its slot has been reused since */
+  if (iter->slot != END_SLOT &&
+      iter->generation != clutter_array_model_get_slot_generation (model, iter->slot))
+    iter->slot = END_SLOT;
+
+  if (iter->slot == END_SLOT)
+    iter->position = priv->order->len;
+  else
+    iter->position = clutter_array_model_get_slot_position (model, iter->slot);
+
+  iter->stamp = priv->layout_stamp;
+
+  /* the row of the iterator is relative to the filter */
+  if (!clutter_model_get_filter_set (CLUTTER_MODEL (model)))
+    _clutter_model_iter_set_row (CLUTTER_MODEL_ITER (iter), iter->position);
+  else
+    {
+      clutter_array_model_ensure_index (model);
+      _clutter_model_iter_set_row (CLUTTER_MODEL_ITER (iter),
+                                   clutter_array_model_lookup_visible (model,
+                                                                       iter->position));
+    }
+
+  return iter->position;
+}
+
+static void
+clutter_array_model_iter_get_value (ClutterModelIter *iter,
+                                    guint             column,
+                                    GValue           *value)
+{
+  ClutterArrayModelIter *iter_array = CLUTTER_ARRAY_MODEL_ITER (iter);
+  ClutterArrayModel *model;
+  ArrayColumn *array_column;
+  GValue real_value = G_VALUE_INIT;
+  guint slot;
+
+  model = CLUTTER_ARRAY_MODEL (clutter_model_iter_get_model (iter));
+
+  /* the row of the iterator might have been removed */
+  clutter_array_model_iter_get_position (iter_array, model);
+  g_assert (iter_array->slot != END_SLOT);
+
+  slot = iter_array->slot;
+  array_column = &model->priv->columns[column];
+
+  if (G_TYPE_FUNDAMENTAL (G_VALUE_TYPE (value)) == array_column->type)
+    {
+      array_column_get_value (array_column, slot, value, TRUE);
+      return;
+    }
+
+  g_value_init (&real_value, array_column->type);
+  array_column_get_value (array_column, slot, &real_value, FALSE);
+
+  if (!g_value_type_transformable (array_column->type, G_VALUE_TYPE (value)) ||
+      !g_value_transform (&real_value, value))
+    {
+      g_warning ("%s: Unable to make conversion from %s to %s",
+                 G_STRLOC,
+                 g_type_name (array_column->type),
+                 g_type_name (G_VALUE_TYPE (value)));
+    }
+
+  g_value_unset (&real_value);
+}
+
+static void
+clutter_array_model_iter_set_value (ClutterModelIter *iter,
+                                    guint             column,
+                                    const GValue     *value)
+{
+  ClutterArrayModelIter *iter_array = CLUTTER_ARRAY_MODEL_ITER (iter);
+  ClutterArrayModel *model;
+  ArrayColumn *array_column;
+  GValue real_value = G_VALUE_INIT;
+  guint slot;
+
+  model = CLUTTER_ARRAY_MODEL (clutter_model_iter_get_model (iter));
+
+  /* the row of the iterator might have been removed */
+  clutter_array_model_iter_get_position (iter_array, model);
+  g_assert (iter_array->slot != END_SLOT);
+
+  slot = iter_array->slot;
+  array_column = &model->priv->columns[column];
+
+  if (G_TYPE_FUNDAMENTAL (G_VALUE_TYPE (value)) == array_column->type)
+    array_column_set_value (array_column, slot, value);
+  else
+    {
+      g_value_init (&real_value, array_column->type);
+
+      if (!g_value_type_transformable (G_VALUE_TYPE (value), array_column->type) ||
+          !g_value_transform (value, &real_value))
+        {
+          g_warning ("%s: Unable to make conversion from %s to %s",
+                     G_STRLOC,
+                     g_type_name (G_VALUE_TYPE (value)),
+                     g_type_name (array_column->type));
+          g_value_unset (&real_value);
+          return;
+        }
+
+      array_column_set_value (array_column, slot, &real_value);
+      g_value_unset (&real_value);
+    }
+
+  /* the row has to go through the filter again */
+  clutter_array_model_queue_row (model,
+                                 clutter_array_model_iter_get_position (iter_array,
+                                                                        model));
+}
+
+static gboolean
+clutter_array_model_iter_is_first (ClutterModelIter *iter)
+{
+  ClutterArrayModelIter *iter_array = CLUTTER_ARRAY_MODEL_ITER (iter);
+  ClutterArrayModel *model;
+  guint position;
+
+  model = CLUTTER_ARRAY_MODEL (clutter_model_iter_get_model (iter));
+  position = clutter_array_model_iter_get_position (iter_array, model);
+
+  if (position == 0)
+    return TRUE;
+
+  if (!clutter_model_get_filter_set (CLUTTER_MODEL (model)))
+    return FALSE;
+
+  /* the iterator is the first one if there is no visible row before it */
+  clutter_array_model_ensure_index (model);
+
+  return clutter_array_model_lookup_visible (model, position) == 0;
+}
+
+static gboolean
+clutter_array_model_iter_is_last (ClutterModelIter *iter)
+{
+  ClutterArrayModelIter *iter_array = CLUTTER_ARRAY_MODEL_ITER (iter);
+  ClutterArrayModel *model;
+  guint position;
+
+  model = CLUTTER_ARRAY_MODEL (clutter_model_iter_get_model (iter));
+  position = clutter_array_model_iter_get_position (iter_array, model);
+
+  if (position >= model->priv->order->len)
+    return TRUE;
+
+  if (!clutter_model_get_filter_set (CLUTTER_MODEL (model)))
+    return FALSE;
+
+  /* the iterator is the last one if there is no visible row at or
+   * after it
+   */
+  clutter_array_model_ensure_index (model);
+
+  return clutter_array_model_lookup_visible (model, position) ==
+         model->priv->visible_rows->len;
+}
+
+static ClutterModelIter *
+clutter_array_model_iter_next (ClutterModelIter *iter)
+{
+  ClutterArrayModelIter *iter_array = CLUTTER_ARRAY_MODEL_ITER (iter);
+  ClutterArrayModelPrivate *priv;
+  ClutterArrayModel *model;
+  guint position, row;
+
+  model = CLUTTER_ARRAY_MODEL (clutter_model_iter_get_model (iter));
+  priv = model->priv;
+  position = clutter_array_model_iter_get_position (iter_array, model);
+  row = clutter_model_iter_get_row (iter);
+
+  if (!clutter_model_get_filter_set (CLUTTER_MODEL (model)))
+    {
+      if (position < priv->order->len)
+        position += 1;
+    }
+  else
+    {
+      guint index_;
+
+      clutter_array_model_ensure_index (model);
+
+      index_ = clutter_array_model_lookup_visible (model, position);
+
+      /* skip the current row, if it is visible */
+      if (index_ < priv->visible_rows->len &&
+          g_array_index (priv->visible_rows, guint, index_) == position)
+        index_ += 1;
+
+      if (index_ < priv->visible_rows->len)
+        position = g_array_index (priv->visible_rows, guint, index_);
+      else
+        position = priv->order->len;
+    }
+
+  clutter_array_model_iter_set_position (iter_array, model, position);
+
+  _clutter_model_iter_set_row (iter, row + 1);
+
+  return iter;
+}
+
+static ClutterModelIter *
+clutter_array_model_iter_prev (ClutterModelIter *iter)
+{
+  ClutterArrayModelIter *iter_array = CLUTTER_ARRAY_MODEL_ITER (iter);
+  ClutterArrayModelPrivate *priv;
+  ClutterArrayModel *model;
+  guint position, row;
+
+  model = CLUTTER_ARRAY_MODEL (clutter_model_iter_get_model (iter));
+  priv = model->priv;
+  position = clutter_array_model_iter_get_position (iter_array, model);
+  row = clutter_model_iter_get_row (iter);
+
+  if (!clutter_model_get_filter_set (CLUTTER_MODEL (model)))
+    {
+      if (position > 0)
+        position -= 1;
+    }
+  else
+    {
+      guint index_;
+
+      clutter_array_model_ensure_index (model);
+
+      index_ = clutter_array_model_lookup_visible (model, position);
+
+      /* like the unfiltered case, moving back from the first row stops
+       * at the beginning of the model
+       */
+      if (index_ == 0)
+        position = 0;
+      else
+        position = g_array_index (priv->visible_rows, guint, index_ - 1);
+    }
+
+  clutter_array_model_iter_set_position (iter_array, model, position);
+
+  _clutter_model_iter_set_row (iter, row - 1);
+
+  return iter;
+}
+
+static guint
+clutter_array_model_iter_get_row (ClutterModelIter *iter)
+{
+  ClutterArrayModelIter *iter_array = CLUTTER_ARRAY_MODEL_ITER (iter);
+  ClutterModelIterClass *parent_class;
+
+  /* updates the row if the rows moved since the last access */
+  clutter_array_model_iter_get_position (iter_array,
+                                         CLUTTER_ARRAY_MODEL (clutter_model_iter_get_model (iter)));
+
+  parent_class = CLUTTER_MODEL_ITER_CLASS (clutter_array_model_iter_parent_class);
+
+  return parent_class->get_row (iter);
+}
+
+static ClutterModelIter *
+clutter_array_model_iter_copy (ClutterModelIter *iter)
+{
+  ClutterArrayModelIter *iter_array = CLUTTER_ARRAY_MODEL_ITER (iter);
+  ClutterArrayModelIter *iter_copy;
+  ClutterArrayModel *model;
+
+  model = CLUTTER_ARRAY_MODEL (clutter_model_iter_get_model (iter));
+
+  /* brings the row of the iterator up to date before copying it */
+  clutter_array_model_iter_get_position (iter_array, model);
+
+  iter_copy = g_object_new (CLUTTER_TYPE_ARRAY_MODEL_ITER,
+                            "model", model,
+                            "row", clutter_model_iter_get_row (iter),
+                            NULL);
+  iter_copy->slot = iter_array->slot;
+  iter_copy->generation = iter_array->generation;
+  iter_copy->position = iter_array->position;
+  iter_copy->stamp = iter_array->stamp;
+
+  return CLUTTER_MODEL_ITER (iter_copy);
+}
+
+static void
+clutter_array_model_iter_class_init (ClutterArrayModelIterClass *klass)
+{
+  ClutterModelIterClass *iter_class = CLUTTER_MODEL_ITER_CLASS (klass);
+
+  iter_class->get_value = clutter_array_model_iter_get_value;
+  iter_class->set_value = clutter_array_model_iter_set_value;
+  iter_class->is_first  = clutter_array_model_iter_is_first;
+  iter_class->is_last   = clutter_array_model_iter_is_last;
+  iter_class->next      = clutter_array_model_iter_next;
+  iter_class->prev      = clutter_array_model_iter_prev;
+  iter_class->get_row   = clutter_array_model_iter_get_row;
+  iter_class->copy      = clutter_array_model_iter_copy;
+}
+
+static void
+clutter_array_model_iter_init (ClutterArrayModelIter *iter)
+{
+  iter->slot = END_SLOT;
+  iter->generation = 0;
+  iter->position = 0;
+  iter->stamp = 0;
+}
+
+/*
+ * ClutterArrayModel
+ */
+
+static ClutterModelIter *
+clutter_array_model_create_iter (ClutterArrayModel *model,
+                                 guint              row,
+                                 guint              position)
+{
+  ClutterArrayModelIter *retval;
+
+  retval = g_object_new (CLUTTER_TYPE_ARRAY_MODEL_ITER,
+                         "model", model,
+                         "row", row,
+                         NULL);
+  clutter_array_model_iter_set_position (retval, model, position);
+
+  return CLUTTER_MODEL_ITER (retval);
+}
+
+/* looks up the position of @row, taking the filter into account */
+static gboolean
+clutter_array_model_lookup_row (ClutterArrayModel *model,
+                                guint              row,
+                                guint             *position)
+{
+  ClutterArrayModelPrivate *priv = model->priv;
+
+  /* short-circuit in case we don't have a filter in place */
+  if (!clutter_model_get_filter_set (CLUTTER_MODEL (model)))
+    {
+      if (row >= priv->order->len)
+        return FALSE;
+
+      *position = row;
+
+      return TRUE;
+    }
+
+  clutter_array_model_ensure_index (model);
+
+  if (row >= priv->visible_rows->len)
+    return FALSE;
+
+  *position = g_array_index (priv->visible_rows, guint, row);
+
+  return TRUE;
+}
+
+static ClutterModelIter *
+clutter_array_model_get_iter_at_row (ClutterModel *model,
+                                     guint         row)
+{
+  ClutterArrayModel *array_model = CLUTTER_ARRAY_MODEL (model);
+  guint position;
+
+  if (!clutter_array_model_lookup_row (array_model, row, &position))
+    return NULL;
+
+  return clutter_array_model_create_iter (array_model, row, position);
+}
+
+static ClutterModelIter *
+clutter_array_model_insert_row (ClutterModel *model,
+                                gint          index_)
+{
+  ClutterArrayModel *array_model = CLUTTER_ARRAY_MODEL (model);
+  ClutterArrayModelPrivate *priv = array_model->priv;
+  guint slot, position;
+
+  if (priv->free_slots->len > 0)
+    {
+      slot = g_array_index (priv->free_slots, guint, priv->free_slots->len - 1);
+      g_array_set_size (priv->free_slots, priv->free_slots->len - 1);
+    }
+  else
+    slot = clutter_array_model_alloc_slots (array_model, 1);
+
+  if (index_ < 0 || (guint) index_ >= priv->order->len)
+    {
+      position = priv->order->len;
+      g_array_append_val (priv->order, slot);
+    }
+  else
+    {
+      position = index_;
+      g_array_insert_val (priv->order, position, slot);
+
+      if (priv->index_valid)
+        clutter_array_model_shift_index (array_model, position, 1);
+    }
+
+  if (priv->index_valid)
+    g_array_index (priv->visible_slots, guint8, slot) = 0;
+
+  clutter_array_model_layout_changed (array_model);
+
+  /* the values of the row are set after it has been inserted, so
+   * the row goes through the filter the next time the index is used
+   */
+  clutter_array_model_queue_row (array_model, position);
+
+  return clutter_array_model_create_iter (array_model, position, position);
+}
+
+static void
+clutter_array_model_remove_row (ClutterModel *model,
+                                guint         row)
+{
+  ClutterModelIter *iter;
+
+  iter = clutter_array_model_get_iter_at_row (model, row);
+  if (iter == NULL)
+    return;
+
+  /* the actual row is removed inside the ::row-removed signal class
+   * handler, so that every handler connected to ::row-removed will
+   * still get a valid iterator
+   */
+  g_signal_emit_by_name (model, "row-removed", iter);
+
+  g_object_unref (iter);
+}
+
+static void
+clutter_array_model_row_removed (ClutterModel     *model,
+                                 ClutterModelIter *iter)
+{
+  ClutterArrayModel *array_model = CLUTTER_ARRAY_MODEL (model);
+  ClutterArrayModelPrivate *priv = array_model->priv;
+  guint position, slot, i;
+
+  position = clutter_array_model_iter_get_position (CLUTTER_ARRAY_MODEL_ITER (iter),
+                                                    array_model);
+  slot = clutter_array_model_get_slot (array_model, position);
+
+  for (i = 0; i < priv->n_columns; i++)
+    array_column_clear_slot (&priv->columns[i], slot);
+
+  g_array_index (priv->slot_generations, guint, slot) += 1;
+  g_array_append_val (priv->free_slots, slot);
+  g_array_remove_index (priv->order, position);
+
+  if (priv->index_valid)
+    {
+      guint index_;
+
+      /* drop the row from the index, and any pending change to it */
+      index_ = clutter_array_model_lookup_visible (array_model, position);
+      if (index_ < priv->visible_rows->len &&
+          g_array_index (priv->visible_rows, guint, index_) == position)
+        g_array_remove_index (priv->visible_rows, index_);
+
+      for (i = priv->dirty_rows->len; i > 0; i--)
+        {
+          if (g_array_index (priv->dirty_rows, guint, i - 1) == position)
+            g_array_remove_index_fast (priv->dirty_rows, i - 1);
+        }
+
+      g_array_index (priv->visible_slots, guint8, slot) = 0;
+
+      clutter_array_model_shift_index (array_model, position, -1);
+    }
+
+  clutter_array_model_layout_changed (array_model);
+
+  clutter_array_model_iter_set_position (CLUTTER_ARRAY_MODEL_ITER (iter),
+                                         array_model,
+                                         priv->order->len);
+}
+
+typedef struct
+{
+  ClutterModel *model;
+  ArrayColumn *column;
+  ClutterModelSortFunc func;
+  gpointer data;
+
+  GValue value_a;
+  GValue value_b;
+} SortClosure;
+
+static gint
+sort_model_default (gconstpointer a,
+                    gconstpointer b,
+                    gpointer      data)
+{
+  SortClosure *clos = data;
+
+  /* the strings are not copied */
+  array_column_get_value (clos->column, *(const guint *) a, &clos->value_a, FALSE);
+  array_column_get_value (clos->column, *(const guint *) b, &clos->value_b, FALSE);
+
+  return clos->func (clos->model, &clos->value_a, &clos->value_b, clos->data);
+}
+
+static void
+clutter_array_model_resort (ClutterModel         *model,
+                            ClutterModelSortFunc  func,
+                            gpointer              data)
+{
+  ClutterArrayModel *array_model = CLUTTER_ARRAY_MODEL (model);
+  ClutterArrayModelPrivate *priv = array_model->priv;
+  SortClosure sort_closure = { NULL, };
+  gint column;
+  guint i;
+
+  column = clutter_model_get_sorting_column (model);
+  if (func == NULL || column < 0)
+    return;
+
+  /* the pending rows have to go through the filter before their
+   * positions change
+   */
+  if (clutter_array_model_index_is_current (array_model))
+    clutter_array_model_ensure_index (array_model);
+  else
+    clutter_array_model_invalidate_index (array_model);
+
+  sort_closure.model  = model;
+  sort_closure.column = &priv->columns[column];
+  sort_closure.func   = func;
+  sort_closure.data   = data;
+
+  g_value_init (&sort_closure.value_a, sort_closure.column->type);
+  g_value_init (&sort_closure.value_b, sort_closure.column->type);
+
+  /* only the slots are sorted; the values never move */
+  g_qsort_with_data (priv->order->data,
+                     priv->order->len,
+                     sizeof (guint),
+                     sort_model_default,
+                     &sort_closure);
+
+  g_value_unset (&sort_closure.value_a);
+  g_value_unset (&sort_closure.value_b);
+
+  clutter_array_model_layout_changed (array_model);
+
+  /* the visible rows are still the same, at new positions */
+  if (priv->index_valid)
+    {
+      g_array_set_size (priv->visible_rows, 0);
+
+      for (i = 0; i < priv->order->len; i++)
+        {
+          guint slot = clutter_array_model_get_slot (array_model, i);
+
+          if (g_array_index (priv->visible_slots, guint8, slot))
+            g_array_append_val (priv->visible_rows, i);
+        }
+    }
+}
+
+static guint
+clutter_array_model_get_n_rows (ClutterModel *model)
+{
+  ClutterArrayModel *array_model = CLUTTER_ARRAY_MODEL (model);
+
+  /* short-circuit in case we don't have a filter in place */
+  if (!clutter_model_get_filter_set (model))
+    return array_model->priv->order->len;
+
+  clutter_array_model_ensure_index (array_model);
+
+  return array_model->priv->visible_rows->len;
+}
+
+static void
+clutter_array_model_finalize (GObject *gobject)
+{
+  ClutterArrayModelPrivate *priv = CLUTTER_ARRAY_MODEL (gobject)->priv;
+  guint i;
+
+  for (i = 0; i < priv->n_columns; i++)
+    array_column_free (&priv->columns[i]);
+
+  g_free (priv->columns);
+
+  g_array_free (priv->order, TRUE);
+  g_array_free (priv->free_slots, TRUE);
+  g_array_free (priv->slot_generations, TRUE);
+  g_array_free (priv->visible_rows, TRUE);
+  g_array_free (priv->visible_slots, TRUE);
+  g_array_free (priv->dirty_rows, TRUE);
+  g_array_free (priv->slot_positions, TRUE);
+
+  G_OBJECT_CLASS (clutter_array_model_parent_class)->finalize (gobject);
+}
+
+static void
+clutter_array_model_dispose (GObject *gobject)
+{
+  ClutterArrayModelPrivate *priv = CLUTTER_ARRAY_MODEL (gobject)->priv;
+
+  if (priv->temp_iter != NULL)
+    {
+      g_object_unref (priv->temp_iter);
+      priv->temp_iter = NULL;
+    }
+
+  G_OBJECT_CLASS (clutter_array_model_parent_class)->dispose (gobject);
+}
+
+static void
+clutter_array_model_class_init (ClutterArrayModelClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  ClutterModelClass *model_class = CLUTTER_MODEL_CLASS (klass);
+
+  g_type_class_add_private (klass, sizeof (ClutterArrayModelPrivate));
+
+  gobject_class->finalize = clutter_array_model_finalize;
+  gobject_class->dispose = clutter_array_model_dispose;
+
+  model_class->get_iter_at_row = clutter_array_model_get_iter_at_row;
+  model_class->insert_row      = clutter_array_model_insert_row;
+  model_class->remove_row      = clutter_array_model_remove_row;
+  model_class->resort          = clutter_array_model_resort;
+  model_class->get_n_rows      = clutter_array_model_get_n_rows;
+
+  model_class->row_removed     = clutter_array_model_row_removed;
+}
+
+static void
+clutter_array_model_init (ClutterArrayModel *self)
+{
+  ClutterArrayModelPrivate *priv;
+
+  self->priv = priv = CLUTTER_ARRAY_MODEL_GET_PRIVATE (self);
+
+  priv->order = g_array_new (FALSE, FALSE, sizeof (guint));
+  priv->free_slots = g_array_new (FALSE, FALSE, sizeof (guint));
+  priv->slot_generations = g_array_new (FALSE, TRUE, sizeof (guint));
+
+  priv->visible_rows = g_array_new (FALSE, FALSE, sizeof (guint));
+  priv->visible_slots = g_array_new (FALSE, TRUE, sizeof (guint8));
+  priv->dirty_rows = g_array_new (FALSE, FALSE, sizeof (guint));
+
+  priv->slot_positions = g_array_new (FALSE, FALSE, sizeof (guint));
+  priv->layout_stamp = 1;
+
+  priv->temp_iter = g_object_new (CLUTTER_TYPE_ARRAY_MODEL_ITER,
+                                  "model", self,
+                                  NULL);
+}
+
+static gboolean
+clutter_array_model_set_columns (ClutterArrayModel   *model,
+                                 guint                n_columns,
+                                 const GType         *types,
+                                 const gchar * const  names[])
+{
+  ClutterArrayModelPrivate *priv = model->priv;
+  guint i;
+
+  for (i = 0; i < n_columns; i++)
+    {
+      if (!array_column_check_type (types[i]))
+        {
+          g_warning ("%s: Invalid type %s for a ClutterArrayModel column",
+                     G_STRLOC,
+                     g_type_name (types[i]));
+          return FALSE;
+        }
+    }
+
+  _clutter_model_set_n_columns (CLUTTER_MODEL (model), n_columns, TRUE, TRUE);
+
+  priv->columns = g_new0 (ArrayColumn, n_columns);
+  priv->n_columns = n_columns;
+
+  for (i = 0; i < n_columns; i++)
+    {
+      array_column_init (&priv->columns[i], types[i]);
+
+      _clutter_model_set_column_type (CLUTTER_MODEL (model), i, types[i]);
+      _clutter_model_set_column_name (CLUTTER_MODEL (model), i, names[i]);
+    }
+
+  return TRUE;
+}
+
+/**
+ * clutter_array_model_new:
+ * @n_columns: number of columns in the model
+ * @...: @n_columns number of #GType and string pairs
+ *
+ * Creates a new #ClutterArrayModel with @n_columns columns with the
+ * types and names passed in.
+ *
+ * The type of each column must be, or derive from, one of %G_TYPE_INT,
+ * %G_TYPE_UINT, %G_TYPE_FLOAT, %G_TYPE_DOUBLE, %G_TYPE_BOOLEAN and
+ * %G_TYPE_STRING.
+ *
+ * For example:
+ *
+ * <informalexample><programlisting>
+ * model = clutter_array_model_new (2,
+ *                                  G_TYPE_INT,    "Score",
+ *                                  G_TYPE_STRING, "Team");
+ * </programlisting></informalexample>
+ *
+ * Return value: a new #ClutterArrayModel, or %NULL if one of the
+ *   types is not supported
+ *
+ * Since: 1.14
+ */
+ClutterModel *
+clutter_array_model_new (guint n_columns,
+                         ...)
+{
+  ClutterModel *model;
+  const gchar **names;
+  GType *types;
+  va_list args;
+  guint i;
+
+  g_return_val_if_fail (n_columns > 0, NULL);
+
+  types = g_new (GType, n_columns);
+  names = g_new (const gchar *, n_columns);
+
+  va_start (args, n_columns);
+
+  for (i = 0; i < n_columns; i++)
+    {
+      types[i] = va_arg (args, GType);
+      names[i] = va_arg (args, gchar *);
+    }
+
+  va_end (args);
+
+  model = clutter_array_model_newv (n_columns, types, names);
+
+  g_free (types);
+  g_free (names);
+
+  return model;
+}
+
+/**
+ * clutter_array_model_newv:
+ * @n_columns: number of columns in the model
+ * @types: (array length=n_columns): an array of #GType types for the columns, from first to last
+ * @names: (array length=n_columns): an array of names for the columns, from first to last
+ *
+ * Non-vararg version of clutter_array_model_new(). This function is
+ * useful for language bindings.
+ *
+ * Return value: (transfer full): a new #ClutterArrayModel, or %NULL if
+ *   one of the types is not supported
+ *
+ * Since: 1.14
+ */
+ClutterModel *
+clutter_array_model_newv (guint                n_columns,
+                          GType               *types,
+                          const gchar * const  names[])
+{
+  ClutterModel *model;
+
+  g_return_val_if_fail (n_columns > 0, NULL);
+
+  model = g_object_new (CLUTTER_TYPE_ARRAY_MODEL, NULL);
+
+  if (!clutter_array_model_set_columns (CLUTTER_ARRAY_MODEL (model),
+                                        n_columns,
+                                        types,
+                                        names))
+    {
+      g_object_unref (model);
+      return NULL;
+    }
+
+  return model;
+}
+
+/**
+ * clutter_array_model_append_rowsv:
+ * @model: a #ClutterArrayModel
+ * @n_rows: the number of rows to append
+ * @n_columns: the number of columns to set
+ * @columns: (array length=n_columns): the columns to set
+ * @arrays: (array length=n_columns): for each column, a C array of
+ *   @n_rows values
+ *
+ * Vector version of clutter_array_model_append_rows(). This function
+ * is useful for language bindings.
+ *
+ * Since: 1.14
+ */
+void
+clutter_array_model_append_rowsv (ClutterArrayModel   *model,
+                                  guint                n_rows,
+                                  guint                n_columns,
+                                  const guint         *columns,
+                                  const gconstpointer *arrays)
+{
+  ClutterArrayModelPrivate *priv;
+  ClutterModelIter *iter;
+  guint first_position, first_slot, n_reused, i, j;
+  gboolean resort = FALSE;
+  gint sort_column;
+
+  g_return_if_fail (CLUTTER_IS_ARRAY_MODEL (model));
+  g_return_if_fail (n_columns == 0 || (columns != NULL && arrays != NULL));
+
+  priv = model->priv;
+
+  for (i = 0; i < n_columns; i++)
+    {
+      if (columns[i] >= priv->n_columns)
+        {
+          g_warning ("%s: Invalid column number %u", G_STRLOC, columns[i]);
+          return;
+        }
+    }
+
+  if (n_rows == 0)
+    return;
+
+  first_position = priv->order->len;
+
+  /* the slots of the removed rows are reused first, one row at a time */
+  n_reused = MIN (n_rows, priv->free_slots->len);
+  for (i = 0; i < n_reused; i++)
+    {
+      guint slot;
+
+      slot = g_array_index (priv->free_slots, guint, priv->free_slots->len - 1);
+      g_array_set_size (priv->free_slots, priv->free_slots->len - 1);
+
+      for (j = 0; j < n_columns; j++)
+        {
+          ArrayColumn *column = &priv->columns[columns[j]];
+          const guint8 *data = arrays[j];
+
+          array_column_copy_values (column, slot,
+                                    data + i * (column->type == G_TYPE_BOOLEAN
+                                                ? sizeof (gboolean)
+                                                : g_array_get_element_size (column->values)),
+                                    1);
+        }
+
+      if (priv->index_valid)
+        g_array_index (priv->visible_slots, guint8, slot) = 0;
+
+      g_array_append_val (priv->order, slot);
+    }
+
+  /* and the rest is copied in one go at the end of each column */
+  if (n_reused < n_rows)
+    {
+      guint n_new = n_rows - n_reused;
+
+      first_slot = clutter_array_model_alloc_slots (model, n_new);
+
+      for (j = 0; j < n_columns; j++)
+        {
+          ArrayColumn *column = &priv->columns[columns[j]];
+          const guint8 *data = arrays[j];
+
+          array_column_copy_values (column, first_slot,
+                                    data + n_reused * (column->type == G_TYPE_BOOLEAN
+                                                       ? sizeof (gboolean)
+                                                       : g_array_get_element_size (column->values)),
+                                    n_new);
+        }
+
+      for (i = 0; i < n_new; i++)
+        {
+          guint slot = first_slot + i;
+
+          g_array_append_val (priv->order, slot);
+        }
+    }
+
+  clutter_array_model_layout_changed (model);
+
+  for (i = first_position; i < priv->order->len; i++)
+    clutter_array_model_queue_row (model, i);
+
+  /* the ::row-added signal is only emitted if somebody is listening,
+   * to avoid creating an iterator for each row
+   */
+  if (g_signal_has_handler_pending (model,
+                                    g_signal_lookup ("row-added", CLUTTER_TYPE_MODEL),
+                                    0,
+                                    TRUE))
+    {
+      iter = clutter_array_model_create_iter (model, first_position, first_position);
+
+      for (i = first_position; i < first_position + n_rows; i++)
+        {
+          clutter_array_model_iter_set_position (CLUTTER_ARRAY_MODEL_ITER (iter),
+                                                 model,
+                                                 i);
+          _clutter_model_iter_set_row (iter, i);
+
+          g_signal_emit_by_name (model, "row-added", iter);
+        }
+
+      g_object_unref (iter);
+    }
+
+  sort_column = clutter_model_get_sorting_column (CLUTTER_MODEL (model));
+  for (i = 0; i < n_columns; i++)
+    {
+      if (sort_column >= 0 && columns[i] == (guint) sort_column)
+        resort = TRUE;
+    }
+
+  if (resort)
+    clutter_model_resort (CLUTTER_MODEL (model));
+}
+
+/**
+ * clutter_array_model_append_rows:
+ * @model: a #ClutterArrayModel
+ * @n_rows: the number of rows to append
+ * @...: pairs of column number and C array of @n_rows values, terminated
+ *   with -1
+ *
+ * Appends @n_rows rows to @model, copying the values of each passed
+ * column from a C array. The arrays must hold values of the type used
+ * to store the column: #gint, #guint, #gfloat, #gdouble, #gboolean or
+ * strings; the strings are copied. The columns that are not passed are
+ * set to zero, or to %NULL.
+ *
+ * This is a lot faster than appending the rows one at a time, since the
+ * values do not go through #GValue<!-- -->s; for instance:
+ *
+ * <informalexample><programlisting>
+ *   static const gint scores[] = { 42, 23, 12 };
+ *   static const gchar *teams[] = { "Team #1", "Team #2", "Team #3" };
+ *
+ *   clutter_array_model_append_rows (model, 3,
+ *                                    0, scores,
+ *                                    1, teams,
+ *                                    -1);
+ * </programlisting></informalexample>
+ *
+ * The #ClutterModel::row-added signal is emitted for each row after all
+ * the rows have been appended.
+ *
+ * Since: 1.14
+ */
+void
+clutter_array_model_append_rows (ClutterArrayModel *model,
+                                 guint              n_rows,
+                                 ...)
+{
+  gconstpointer *arrays;
+  guint *columns;
+  guint n_columns, max_columns;
+  gint column;
+  va_list args;
+
+  g_return_if_fail (CLUTTER_IS_ARRAY_MODEL (model));
+
+  max_columns = model->priv->n_columns;
+  columns = g_newa (guint, max_columns);
+  arrays = g_newa (gconstpointer, max_columns);
+  n_columns = 0;
+
+  va_start (args, n_rows);
+
+  column = va_arg (args, gint);
+  while (column != -1)
+    {
+      if (column < 0 || (guint) column >= max_columns || n_columns == max_columns)
+        {
+          g_warning ("%s: Invalid column number %d added to the model "
+                     "(remember to end you list of columns with a -1)",
+                     G_STRLOC, column);
+          va_end (args);
+          return;
+        }
+
+      columns[n_columns] = column;
+      arrays[n_columns] = va_arg (args, gconstpointer);
+      n_columns += 1;
+
+      column = va_arg (args, gint);
+    }
+
+  va_end (args);
+
+  clutter_array_model_append_rowsv (model, n_rows, n_columns, columns, arrays);
+}
+
+static gboolean
+clutter_array_model_lookup_value (ClutterArrayModel *model,
+                                  guint              row,
+                                  guint              column,
+                                  GType              gtype,
+                                  guint             *slot)
+{
+  ClutterArrayModelPrivate *priv = model->priv;
+  guint position;
+
+  if (column >= priv->n_columns)
+    {
+      g_warning ("%s: Invalid column id value %u", G_STRLOC, column);
+      return FALSE;
+    }
+
+  if (priv->columns[column].type != gtype)
+    {
+      g_warning ("%s: The column %u holds values of type %s, not %s",
+                 G_STRLOC, column,
+                 g_type_name (priv->columns[column].type),
+                 g_type_name (gtype));
+      return FALSE;
+    }
+
+  if (!clutter_array_model_lookup_row (model, row, &position))
+    return FALSE;
+
+  *slot = clutter_array_model_get_slot (model, position);
+
+  return TRUE;
+}
+
+/**
+ * clutter_array_model_get_int:
+ * @model: a #ClutterArrayModel
+ * @row: the row, taking the filter into account
+ * @column: a column holding integers
+ *
+ * Retrieves the value of the cell at @row and @column, without going
+ * through a #ClutterModelIter and a #GValue.
+ *
+ * Return value: the value of the cell, or 0 if @row is out of bounds
+ *
+ * Since: 1.14
+ */
+gint
+clutter_array_model_get_int (ClutterArrayModel *model,
+                             guint              row,
+                             guint              column)
+{
+  guint slot;
+
+  g_return_val_if_fail (CLUTTER_IS_ARRAY_MODEL (model), 0);
+
+  if (!clutter_array_model_lookup_value (model, row, column, G_TYPE_INT, &slot))
+    return 0;
+
+  return g_array_index (model->priv->columns[column].values, gint, slot);
+}
+
+/**
+ * clutter_array_model_get_uint:
+ * @model: a #ClutterArrayModel
+ * @row: the row, taking the filter into account
+ * @column: a column holding unsigned integers
+ *
+ * Retrieves the value of the cell at @row and @column, without going
+ * through a #ClutterModelIter and a #GValue.
+ *
+ * Return value: the value of the cell, or 0 if @row is out of bounds
+ *
+ * Since: 1.14
+ */
+guint
+clutter_array_model_get_uint (ClutterArrayModel *model,
+                              guint              row,
+                              guint              column)
+{
+  guint slot;
+
+  g_return_val_if_fail (CLUTTER_IS_ARRAY_MODEL (model), 0);
+
+  if (!clutter_array_model_lookup_value (model, row, column, G_TYPE_UINT, &slot))
+    return 0;
+
+  return g_array_index (model->priv->columns[column].values, guint, slot);
+}
+
+/**
+ * clutter_array_model_get_float:
+ * @model: a #ClutterArrayModel
+ * @row: the row, taking the filter into account
+ * @column: a column holding floating point values
+ *
+ * Retrieves the value of the cell at @row and @column, without going
+ * through a #ClutterModelIter and a #GValue.
+ *
+ * Return value: the value of the cell, or 0 if @row is out of bounds
+ *
+ * Since: 1.14
+ */
+gfloat
+clutter_array_model_get_float (ClutterArrayModel *model,
+                               guint              row,
+                               guint              column)
+{
+  guint slot;
+
+  g_return_val_if_fail (CLUTTER_IS_ARRAY_MODEL (model), 0.f);
+
+  if (!clutter_array_model_lookup_value (model, row, column, G_TYPE_FLOAT, &slot))
+    return 0.f;
+
+  return g_array_index (model->priv->columns[column].values, gfloat, slot);
+}
+
+/**
+ * clutter_array_model_get_double:
+ * @model: a #ClutterArrayModel
+ * @row: the row, taking the filter into account
+ * @column: a column holding double precision floating point values
+ *
+ * Retrieves the value of the cell at @row and @column, without going
+ * through a #ClutterModelIter and a #GValue.
+ *
+ * Return value: the value of the cell, or 0 if @row is out of bounds
+ *
+ * Since: 1.14
+ */
+gdouble
+clutter_array_model_get_double (ClutterArrayModel *model,
+                                guint              row,
+                                guint              column)
+{
+  guint slot;
+
+  g_return_val_if_fail (CLUTTER_IS_ARRAY_MODEL (model), 0.0);
+
+  if (!clutter_array_model_lookup_value (model, row, column, G_TYPE_DOUBLE, &slot))
+    return 0.0;
+
+  return g_array_index (model->priv->columns[column].values, gdouble, slot);
+}
+
+/**
+ * clutter_array_model_get_boolean:
+ * @model: a #ClutterArrayModel
+ * @row: the row, taking the filter into account
+ * @column: a column holding booleans
+ *
+ * Retrieves the value of the cell at @row and @column, without going
+ * through a #ClutterModelIter and a #GValue.
+ *
+ * Return value: the value of the cell, or %FALSE if @row is out of bounds
+ *
+ * Since: 1.14
+ */
+gboolean
+clutter_array_model_get_boolean (ClutterArrayModel *model,
+                                 guint              row,
+                                 guint              column)
+{
+  guint slot;
+
+  g_return_val_if_fail (CLUTTER_IS_ARRAY_MODEL (model), FALSE);
+
+  if (!clutter_array_model_lookup_value (model, row, column, G_TYPE_BOOLEAN, &slot))
+    return FALSE;
+
+  return g_array_index (model->priv->columns[column].values, guint8, slot) != 0;
+}
+
+/**
+ * clutter_array_model_get_string:
+ * @model: a #ClutterArrayModel
+ * @row: the row, taking the filter into account
+ * @column: a column holding strings
+ *
+ * Retrieves the value of the cell at @row and @column, without going
+ * through a #ClutterModelIter and a #GValue, and without copying it.
+ *
+ * Return value: (transfer none): the value of the cell, or %NULL if @row
+ *   is out of bounds. The string is owned by the model, and it is only
+ *   valid until the cell changes or the row is removed
+ *
+ * Since: 1.14
+ */
+const gchar *
+clutter_array_model_get_string (ClutterArrayModel *model,
+                                guint              row,
+                                guint              column)
+{
+  guint slot;
+
+  g_return_val_if_fail (CLUTTER_IS_ARRAY_MODEL (model), NULL);
+
+  if (!clutter_array_model_lookup_value (model, row, column, G_TYPE_STRING, &slot))
+    return NULL;
+
+  return g_array_index (model->priv->columns[column].values, gchar *, slot);
+}
@@ -0,0 +1,121 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2013  Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined(__CLUTTER_H_INSIDE__) && !defined(CLUTTER_COMPILATION)
+#error "Only <clutter/clutter.h> can be included directly."
+#endif
+
+#ifndef __CLUTTER_ARRAY_MODEL_H__
+#define __CLUTTER_ARRAY_MODEL_H__
+
+#include <clutter/clutter-model.h>
+
+G_BEGIN_DECLS
+
+#define CLUTTER_TYPE_ARRAY_MODEL                (clutter_array_model_get_type ())
+#define CLUTTER_ARRAY_MODEL(obj)                (G_TYPE_CHECK_INSTANCE_CAST ((obj), CLUTTER_TYPE_ARRAY_MODEL, ClutterArrayModel))
+#define CLUTTER_IS_ARRAY_MODEL(obj)             (G_TYPE_CHECK_INSTANCE_TYPE ((obj), CLUTTER_TYPE_ARRAY_MODEL))
+#define CLUTTER_ARRAY_MODEL_CLASS(klass)        (G_TYPE_CHECK_CLASS_CAST ((klass), CLUTTER_TYPE_ARRAY_MODEL, ClutterArrayModelClass))
+#define CLUTTER_IS_ARRAY_MODEL_CLASS(klass)     (G_TYPE_CHECK_CLASS_TYPE ((klass), CLUTTER_TYPE_ARRAY_MODEL))
+#define CLUTTER_ARRAY_MODEL_GET_CLASS(obj)      (G_TYPE_INSTANCE_GET_CLASS ((obj), CLUTTER_TYPE_ARRAY_MODEL, ClutterArrayModelClass))
+
+typedef struct _ClutterArrayModel               ClutterArrayModel;
+typedef struct _ClutterArrayModelPrivate        ClutterArrayModelPrivate;
+typedef struct _ClutterArrayModelClass          ClutterArrayModelClass;
+
+/**
+ * ClutterArrayModel:
+ *
+ * The #ClutterArrayModel struct contains only private data.
+ *
+ * Since: 1.14
+ */
+struct _ClutterArrayModel
+{
+  /*< private >*/
+  ClutterModel parent_instance;
+
+  ClutterArrayModelPrivate *priv;
+};
+
+/**
+ * ClutterArrayModelClass:
+ *
+ * The #ClutterArrayModelClass struct contains only private data.
+ *
+ * Since: 1.14
+ */
+struct _ClutterArrayModelClass
+{
+  /*< private >*/
+  ClutterModelClass parent_class;
+};
+
+CLUTTER_AVAILABLE_IN_1_14
+GType           clutter_array_model_get_type            (void) G_GNUC_CONST;
+
+CLUTTER_AVAILABLE_IN_1_14
+ClutterModel *  clutter_array_model_new                 (guint                n_columns,
+                                                         ...);
+CLUTTER_AVAILABLE_IN_1_14
+ClutterModel *  clutter_array_model_newv                (guint                n_columns,
+                                                         GType               *types,
+                                                         const gchar * const  names[]);
+
+CLUTTER_AVAILABLE_IN_1_14
+void            clutter_array_model_append_rows         (ClutterArrayModel   *model,
+                                                         guint                n_rows,
+                                                         ...);
+CLUTTER_AVAILABLE_IN_1_14
+void            clutter_array_model_append_rowsv        (ClutterArrayModel   *model,
+                                                         guint                n_rows,
+                                                         guint                n_columns,
+                                                         const guint         *columns,
+                                                         const gconstpointer *arrays);
+
+CLUTTER_AVAILABLE_IN_1_14
+gint            clutter_array_model_get_int             (ClutterArrayModel   *model,
+                                                         guint                row,
+                                                         guint                column);
+CLUTTER_AVAILABLE_IN_1_14
+guint           clutter_array_model_get_uint            (ClutterArrayModel   *model,
+                                                         guint                row,
+                                                         guint                column);
+CLUTTER_AVAILABLE_IN_1_14
+gfloat          clutter_array_model_get_float           (ClutterArrayModel   *model,
+                                                         guint                row,
+                                                         guint                column);
+CLUTTER_AVAILABLE_IN_1_14
+gdouble         clutter_array_model_get_double          (ClutterArrayModel   *model,
+                                                         guint                row,
+                                                         guint                column);
+CLUTTER_AVAILABLE_IN_1_14
+gboolean        clutter_array_model_get_boolean         (ClutterArrayModel   *model,
+                                                         guint                row,
+                                                         guint                column);
+CLUTTER_AVAILABLE_IN_1_14
+const gchar *   clutter_array_model_get_string          (ClutterArrayModel   *model,
+                                                         guint                row,
+                                                         guint                column);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_ARRAY_MODEL_H__ */
@@ -0,0 +1,382 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2013  Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/**
+ * SECTION:clutter-bend-effect
+ * @Title: ClutterBendEffect
+ * @Short_Description: A bending effect
+ *
+ * #ClutterBendEffect bends an actor around a cylinder, so that its
+ * edges are rotated by the given angle relative to its center.
+ *
+ * The bend is horizontal or vertical depending on the orientation of
+ * the effect; positive angles push the edges of the actor away from
+ * the viewer, while negative angles pull them closer.
+ *
+ * #ClutterBendEffect is available since Clutter 1.14
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <math.h>
+
+#include "clutter-bend-effect.h"
+
+#include "clutter-debug.h"
+#include "clutter-enum-types.h"
+#include "clutter-private.h"
+
+#define CLUTTER_BEND_EFFECT_CLASS(k)       (G_TYPE_CHECK_CLASS_CAST ((k), CLUTTER_TYPE_BEND_EFFECT, ClutterBendEffectClass))
+#define CLUTTER_IS_BEND_EFFECT_CLASS(k)    (G_TYPE_CHECK_CLASS_TYPE ((k), CLUTTER_TYPE_BEND_EFFECT))
+#define CLUTTER_BEND_EFFECT_GET_CLASS(o)   (G_TYPE_INSTANCE_GET_CLASS ((o), CLUTTER_TYPE_BEND_EFFECT, ClutterBendEffectClass))
+
+struct _ClutterBendEffect
+{
+  ClutterDeformEffect parent_instance;
+
+  gdouble angle;
+
+  ClutterOrientation orientation;
+};
+
+struct _ClutterBendEffectClass
+{
+  ClutterDeformEffectClass parent_class;
+};
+
+enum
+{
+  PROP_0,
+
+  PROP_ANGLE,
+  PROP_ORIENTATION,
+
+  PROP_LAST
+};
+
+static GParamSpec *obj_props[PROP_LAST];
+
+G_DEFINE_TYPE (ClutterBendEffect,
+               clutter_bend_effect,
+               CLUTTER_TYPE_DEFORM_EFFECT);
+
+/* the actor is wrapped around a cylinder so that the arc covering
+ * its whole length spans twice the angle of each edge; returns %FALSE
+ * if the actor is not bent
+ */
+static inline gboolean
+clutter_bend_effect_get_cylinder (ClutterBendEffect *self,
+                                  gfloat             width,
+                                  gfloat             height,
+                                  gfloat            *half_length,
+                                  gfloat            *radius)
+{
+  gfloat radians, length;
+
+  if (self->angle == 0.0)
+    return FALSE;
+
+  length = self->orientation == CLUTTER_ORIENTATION_HORIZONTAL
+         ? width
+         : height;
+
+  radians = self->angle * 2.0 / (180.0 / G_PI);
+
+  *radius = length / radians;
+  *half_length = length / 2.0f;
+
+  return TRUE;
+}
+
+static void
+clutter_bend_effect_deform_vertex (ClutterDeformEffect *effect,
+                                   gfloat               width,
+                                   gfloat               height,
+                                   CoglTextureVertex   *vertex)
+{
+  ClutterBendEffect *self = CLUTTER_BEND_EFFECT (effect);
+  gfloat half_length, radius, theta;
+  gfloat *coord;
+
+  if (!clutter_bend_effect_get_cylinder (self, width, height,
+                                         &half_length,
+                                         &radius))
+    return;
+
+  if (self->orientation == CLUTTER_ORIENTATION_HORIZONTAL)
+    coord = &vertex->x;
+  else
+    coord = &vertex->y;
+
+  theta = (*coord - half_length) / radius;
+
+  *coord = half_length + (radius * sinf (theta));
+  vertex->z = radius * (cosf (theta) - 1.0f);
+}
+
+static void
+clutter_bend_effect_deform_vertices (ClutterDeformEffect   *effect,
+                                     gfloat                 width,
+                                     gfloat                 height,
+                                     ClutterDeformVertices *vertices)
+{
+  ClutterBendEffect *self = CLUTTER_BEND_EFFECT (effect);
+  gfloat half_length, radius;
+  gfloat *coords, *z;
+  guint i;
+
+  /* same as clutter_bend_effect_deform_vertex(), on a whole range */
+  if (!clutter_bend_effect_get_cylinder (self, width, height,
+                                         &half_length,
+                                         &radius))
+    return;
+
+  if (self->orientation == CLUTTER_ORIENTATION_HORIZONTAL)
+    coords = vertices->x;
+  else
+    coords = vertices->y;
+
+  z = vertices->z;
+
+  for (i = 0; i < vertices->n_vertices; i++)
+    {
+      gfloat theta = (coords[i] - half_length) / radius;
+
+      coords[i] = half_length + (radius * sinf (theta));
+      z[i] = radius * (cosf (theta) - 1.0f);
+    }
+}
+
+static void
+clutter_bend_effect_set_property (GObject      *gobject,
+                                  guint         prop_id,
+                                  const GValue *value,
+                                  GParamSpec   *pspec)
+{
+  ClutterBendEffect *effect = CLUTTER_BEND_EFFECT (gobject);
+
+  switch (prop_id)
+    {
+    case PROP_ANGLE:
+      clutter_bend_effect_set_angle (effect, g_value_get_double (value));
+      break;
+
+    case PROP_ORIENTATION:
+      clutter_bend_effect_set_orientation (effect, g_value_get_enum (value));
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+clutter_bend_effect_get_property (GObject    *gobject,
+                                  guint       prop_id,
+                                  GValue     *value,
+                                  GParamSpec *pspec)
+{
+  ClutterBendEffect *effect = CLUTTER_BEND_EFFECT (gobject);
+
+  switch (prop_id)
+    {
+    case PROP_ANGLE:
+      g_value_set_double (value, effect->angle);
+      break;
+
+    case PROP_ORIENTATION:
+      g_value_set_enum (value, effect->orientation);
+      break;
+
+    default:
+      G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
+      break;
+    }
+}
+
+static void
+clutter_bend_effect_class_init (ClutterBendEffectClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+  ClutterDeformEffectClass *deform_class = CLUTTER_DEFORM_EFFECT_CLASS (klass);
+  GParamSpec *pspec;
+
+  gobject_class->set_property = clutter_bend_effect_set_property;
+  gobject_class->get_property = clutter_bend_effect_get_property;
+
+  /**
+   * ClutterBendEffect:angle:
+   *
+   * The angle by which the edges of the actor are rotated, in degrees,
+   * between -180.0 and 180.0
+   *
+   * Since: 1.14
+   */
+  pspec = g_param_spec_double ("angle",
+                               P_("Angle"),
+                               P_("The angle of the bend, in degrees"),
+                               -180.0, 180.0,
+                               0.0,
+                               CLUTTER_PARAM_READWRITE);
+  obj_props[PROP_ANGLE] = pspec;
+  g_object_class_install_property (gobject_class, PROP_ANGLE, pspec);
+
+  /**
+   * ClutterBendEffect:orientation:
+   *
+   * Whether the actor is bent horizontally or vertically
+   *
+   * Since: 1.14
+   */
+  pspec = g_param_spec_enum ("orientation",
+                             P_("Orientation"),
+                             P_("The orientation of the bend"),
+                             CLUTTER_TYPE_ORIENTATION,
+                             CLUTTER_ORIENTATION_HORIZONTAL,
+                             CLUTTER_PARAM_READWRITE);
+  obj_props[PROP_ORIENTATION] = pspec;
+  g_object_class_install_property (gobject_class, PROP_ORIENTATION, pspec);
+
+  deform_class->deform_vertex = clutter_bend_effect_deform_vertex;
+  deform_class->deform_vertices = clutter_bend_effect_deform_vertices;
+}
+
+static void
+clutter_bend_effect_init (ClutterBendEffect *self)
+{
+  self->angle = 0.0;
+  self->orientation = CLUTTER_ORIENTATION_HORIZONTAL;
+}
+
+/**
+ * clutter_bend_effect_new:
+ * @angle: the angle of the bend, between -180.0 and 180.0
+ * @orientation: the orientation of the bend
+ *
+ * Creates a new #ClutterBendEffect instance with the given parameters
+ *
+ * Return value: the newly created #ClutterBendEffect
+ *
+ * Since: 1.14
+ */
+ClutterEffect *
+clutter_bend_effect_new (gdouble            angle,
+                         ClutterOrientation orientation)
+{
+  g_return_val_if_fail (angle >= -180.0 && angle <= 180.0, NULL);
+
+  return g_object_new (CLUTTER_TYPE_BEND_EFFECT,
+                       "angle", angle,
+                       "orientation", orientation,
+                       NULL);
+}
+
+/**
+ * clutter_bend_effect_set_angle:
+ * @effect: a #ClutterBendEffect
+ * @angle: the angle of the bend, in degrees
+ *
+ * Sets the angle by which the edges of the actor are rotated,
+ * between -180.0 and 180.0 degrees
+ *
+ * Since: 1.14
+ */
+void
+clutter_bend_effect_set_angle (ClutterBendEffect *effect,
+                               gdouble            angle)
+{
+  g_return_if_fail (CLUTTER_IS_BEND_EFFECT (effect));
+  g_return_if_fail (angle >= -180.0 && angle <= 180.0);
+
+  if (effect->angle == angle)
+    return;
+
+  effect->angle = angle;
+
+  clutter_deform_effect_invalidate (CLUTTER_DEFORM_EFFECT (effect));
+
+  g_object_notify_by_pspec (G_OBJECT (effect), obj_props[PROP_ANGLE]);
+}
+
+/**
+ * clutter_bend_effect_get_angle:
+ * @effect: a #ClutterBendEffect
+ *
+ * Retrieves the value set using clutter_bend_effect_set_angle()
+ *
+ * Return value: the angle of the bend, in degrees
+ *
+ * Since: 1.14
+ */
+gdouble
+clutter_bend_effect_get_angle (ClutterBendEffect *effect)
+{
+  g_return_val_if_fail (CLUTTER_IS_BEND_EFFECT (effect), 0.0);
+
+  return effect->angle;
+}
+
+/**
+ * clutter_bend_effect_set_orientation:
+ * @effect: a #ClutterBendEffect
+ * @orientation: the orientation of the bend
+ *
+ * Sets whether the actor should be bent horizontally or vertically
+ *
+ * Since: 1.14
+ */
+void
+clutter_bend_effect_set_orientation (ClutterBendEffect  *effect,
+                                     ClutterOrientation  orientation)
+{
+  g_return_if_fail (CLUTTER_IS_BEND_EFFECT (effect));
+
+  if (effect->orientation == orientation)
+    return;
+
+  effect->orientation = orientation;
+
+  clutter_deform_effect_invalidate (CLUTTER_DEFORM_EFFECT (effect));
+
+  g_object_notify_by_pspec (G_OBJECT (effect), obj_props[PROP_ORIENTATION]);
+}
+
+/**
+ * clutter_bend_effect_get_orientation:
+ * @effect: a #ClutterBendEffect
+ *
+ * Retrieves the value set using clutter_bend_effect_set_orientation()
+ *
+ * Return value: the orientation of the bend
+ *
+ * Since: 1.14
+ */
+ClutterOrientation
+clutter_bend_effect_get_orientation (ClutterBendEffect *effect)
+{
+  g_return_val_if_fail (CLUTTER_IS_BEND_EFFECT (effect),
+                        CLUTTER_ORIENTATION_HORIZONTAL);
+
+  return effect->orientation;
+}
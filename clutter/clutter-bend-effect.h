@@ -0,0 +1,68 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2013  Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#if !defined(__CLUTTER_H_INSIDE__) && !defined(CLUTTER_COMPILATION)
+#error "Only <clutter/clutter.h> can be included directly."
+#endif
+
+#ifndef __CLUTTER_BEND_EFFECT_H__
+#define __CLUTTER_BEND_EFFECT_H__
+
+#include <clutter/clutter-deform-effect.h>
+
+G_BEGIN_DECLS
+
+#define CLUTTER_TYPE_BEND_EFFECT        (clutter_bend_effect_get_type ())
+#define CLUTTER_BEND_EFFECT(obj)        (G_TYPE_CHECK_INSTANCE_CAST ((obj), CLUTTER_TYPE_BEND_EFFECT, ClutterBendEffect))
+#define CLUTTER_IS_BEND_EFFECT(obj)     (G_TYPE_CHECK_INSTANCE_TYPE ((obj), CLUTTER_TYPE_BEND_EFFECT))
+
+/**
+ * ClutterBendEffect:
+ *
+ * <structname>ClutterBendEffect</structname> is an opaque structure
+ * whose members can only be accessed using the provided API
+ *
+ * Since: 1.14
+ */
+typedef struct _ClutterBendEffect               ClutterBendEffect;
+typedef struct _ClutterBendEffectClass          ClutterBendEffectClass;
+
+CLUTTER_AVAILABLE_IN_1_14
+GType clutter_bend_effect_get_type (void) G_GNUC_CONST;
+
+CLUTTER_AVAILABLE_IN_1_14
+ClutterEffect *         clutter_bend_effect_new                 (gdouble             angle,
+                                                                 ClutterOrientation  orientation);
+
+CLUTTER_AVAILABLE_IN_1_14
+void                    clutter_bend_effect_set_angle           (ClutterBendEffect  *effect,
+                                                                 gdouble             angle);
+CLUTTER_AVAILABLE_IN_1_14
+gdouble                 clutter_bend_effect_get_angle           (ClutterBendEffect  *effect);
+CLUTTER_AVAILABLE_IN_1_14
+void                    clutter_bend_effect_set_orientation     (ClutterBendEffect  *effect,
+                                                                 ClutterOrientation  orientation);
+CLUTTER_AVAILABLE_IN_1_14
+ClutterOrientation      clutter_bend_effect_get_orientation     (ClutterBendEffect  *effect);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_BEND_EFFECT_H__ */
@@ -48,7 +48,7 @@
 #include "cogl/cogl.h"
 
 #include "clutter-debug.h"
-#include "clutter-offscreen-effect.h"
+#include "clutter-offscreen-effect-private.h"
 #include "clutter-private.h"
 
 #define BLUR_PADDING    2
@@ -259,6 +259,10 @@ clutter_blur_effect_init (ClutterBlurEffect *self)
 
   self->pixel_step_uniform =
     cogl_pipeline_get_uniform_location (self->pipeline, "pixel_step");
+
+  /* the texture is painted at a 1:1 texel:pixel ratio */
+  _clutter_offscreen_effect_set_round_target_size (CLUTTER_OFFSCREEN_EFFECT (self),
+                                                   TRUE);
 }
 
 /**
@@ -51,7 +51,7 @@
 
 #include "clutter-debug.h"
 #include "clutter-enum-types.h"
-#include "clutter-offscreen-effect.h"
+#include "clutter-offscreen-effect-private.h"
 #include "clutter-private.h"
 
 struct _ClutterBrightnessContrastEffect
@@ -456,6 +456,10 @@ clutter_brightness_contrast_effect_init (ClutterBrightnessContrastEffect *self)
     cogl_pipeline_get_uniform_location (self->pipeline, "contrast");
 
   update_uniforms (self);
+
+  /* the texture is painted at a 1:1 texel:pixel ratio */
+  _clutter_offscreen_effect_set_round_target_size (CLUTTER_OFFSCREEN_EFFECT (self),
+                                                   TRUE);
 }
 
 /**
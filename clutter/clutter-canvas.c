@@ -36,6 +36,18 @@
  * that can be used to draw. #ClutterCanvas will emit the #ClutterCanvas::draw
  * signal when invalidated using clutter_content_invalidate().
  *
+ * The contents of a #ClutterCanvas are uploaded into a texture only
+ * after the canvas has been drawn, and the same texture is reused for
+ * every paint until the next invalidation. If only a portion of the
+ * canvas needs to be updated, clutter_canvas_invalidate_rectangle()
+ * can be used to clip the drawing to the damaged area, and to upload
+ * only that area into the texture.
+ *
+ * Canvases that take a long time to draw can use
+ * clutter_canvas_set_draw_async() to emit the #ClutterCanvas::draw
+ * signal in a worker thread; the previous contents of the canvas will
+ * be painted until the new ones are ready.
+ *
  * <informalexample id="canvas-example">
  *   <programlisting>
  * <xi:include xmlns:xi="http://www.w3.org/2001/XInclude" parse="text" href="../../../../examples/canvas.c">
@@ -51,13 +63,14 @@
 #include "config.h"
 #endif
 
+#include <string.h>
+
 #include <cogl/cogl.h>
 #include <cairo-gobject.h>
 
-#include "clutter-canvas.h"
-
 #define CLUTTER_ENABLE_EXPERIMENTAL_API
 
+#include "clutter-canvas.h"
 #include "clutter-backend.h"
 #include "clutter-cairo.h"
 #include "clutter-color.h"
@@ -67,6 +80,28 @@
 #include "clutter-paint-nodes.h"
 #include "clutter-private.h"
 
+#define MAX_DRAW_THREADS        4
+
+typedef struct _DrawJob         DrawJob;
+
+struct _DrawJob
+{
+  ClutterCanvas *canvas;
+
+  int width;
+  int height;
+
+  /* the surface to draw on, and the one holding the previous
+   * contents of the canvas when only the clip is redrawn
+   */
+  cairo_surface_t *surface;
+  cairo_surface_t *source;
+
+  cairo_region_t *clip;
+};
+
+static GThreadPool *draw_thread_pool = NULL;
+
 struct _ClutterCanvasPrivate
 {
   cairo_t *cr;
@@ -75,6 +110,35 @@ struct _ClutterCanvasPrivate
   int height;
 
   CoglBitmap *buffer;
+
+  /* the texture painted by the canvas; it is kept across paints
+   * and only updated where the buffer has been drawn
+   */
+  CoglTexture *texture;
+
+  /* the areas of the buffer that have not been uploaded yet */
+  cairo_region_t *upload_region;
+
+  /* the areas to redraw at the next invalidation; NULL means
+   * the whole canvas
+   */
+  cairo_region_t *redraw_region;
+
+  /* asynchronous drawing: the last completed surface, painted
+   * until the job in flight completes, and a recycled surface
+   */
+  cairo_surface_t *front_surface;
+  cairo_surface_t *back_surface;
+
+  DrawJob *job;
+
+  /* the areas invalidated while a job was in flight; NULL means
+   * the whole canvas
+   */
+  cairo_region_t *queued_region;
+
+  guint draw_async    : 1;
+  guint redraw_queued : 1;
 };
 
 enum
@@ -83,6 +147,7 @@ enum
 
   PROP_WIDTH,
   PROP_HEIGHT,
+  PROP_DRAW_ASYNC,
 
   LAST_PROP
 };
@@ -137,6 +202,18 @@ clutter_canvas_finalize (GObject *gobject)
       priv->buffer = NULL;
     }
 
+  if (priv->texture != NULL)
+    {
+      cogl_object_unref (priv->texture);
+      priv->texture = NULL;
+    }
+
+  g_clear_pointer (&priv->upload_region, cairo_region_destroy);
+  g_clear_pointer (&priv->redraw_region, cairo_region_destroy);
+  g_clear_pointer (&priv->queued_region, cairo_region_destroy);
+  g_clear_pointer (&priv->front_surface, cairo_surface_destroy);
+  g_clear_pointer (&priv->back_surface, cairo_surface_destroy);
+
   G_OBJECT_CLASS (clutter_canvas_parent_class)->finalize (gobject);
 }
 
@@ -166,6 +243,11 @@ clutter_canvas_set_property (GObject      *gobject,
         }
       break;
 
+    case PROP_DRAW_ASYNC:
+      clutter_canvas_set_draw_async (CLUTTER_CANVAS (gobject),
+                                     g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
       break;
@@ -190,6 +272,10 @@ clutter_canvas_get_property (GObject    *gobject,
       g_value_set_int (value, priv->height);
       break;
 
+    case PROP_DRAW_ASYNC:
+      g_value_set_boolean (value, priv->draw_async);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
       break;
@@ -235,6 +321,22 @@ clutter_canvas_class_init (ClutterCanvasClass *klass)
                       G_PARAM_READWRITE |
                       G_PARAM_STATIC_STRINGS);
 
+  /**
+   * ClutterCanvas:draw-async:
+   *
+   * Whether the #ClutterCanvas::draw signal should be emitted in a
+   * worker thread.
+   *
+   * Since: 1.14
+   */
+  obj_props[PROP_DRAW_ASYNC] =
+    g_param_spec_boolean ("draw-async",
+                          P_("Draw Asynchronously"),
+                          P_("Whether the canvas is drawn in a worker thread"),
+                          FALSE,
+                          G_PARAM_READWRITE |
+                          G_PARAM_STATIC_STRINGS);
+
   /**
    * ClutterCanvas::draw:
    * @canvas: the #ClutterCanvas that emitted the signal
@@ -249,6 +351,9 @@ clutter_canvas_class_init (ClutterCanvasClass *klass)
    * handler invocation will be automatically protected by cairo_save()
    * and cairo_restore() pairs.
    *
+   * If #ClutterCanvas:draw-async is set, this signal is emitted in a
+   * worker thread, and its handlers must not use the Clutter API.
+   *
    * Return value: %TRUE if the signal emission should stop, and
    *   %FALSE otherwise
    *
@@ -283,6 +388,175 @@ clutter_canvas_init (ClutterCanvas *self)
   self->priv->height = -1;
 }
 
+static gboolean
+clutter_canvas_upload_region (ClutterCanvas *self,
+                              const guint8  *data,
+                              int            stride)
+{
+  ClutterCanvasPrivate *priv = self->priv;
+  int i, n_rects;
+  gboolean res = TRUE;
+
+  n_rects = cairo_region_num_rectangles (priv->upload_region);
+
+  for (i = 0; i < n_rects && res; i++)
+    {
+      cairo_rectangle_int_t rect;
+
+      cairo_region_get_rectangle (priv->upload_region, i, &rect);
+
+      res = cogl_texture_set_region (priv->texture,
+                                     0, 0,
+                                     rect.x, rect.y,
+                                     rect.width, rect.height,
+                                     rect.width, rect.height,
+                                     CLUTTER_CAIRO_FORMAT_ARGB32,
+                                     stride,
+                                     data + rect.y * stride + rect.x * 4);
+    }
+
+  return res;
+}
+
+static gboolean
+clutter_canvas_upload_buffer (ClutterCanvas *self)
+{
+  ClutterCanvasPrivate *priv = self->priv;
+  CoglBuffer *buffer;
+  guint8 *data;
+  gboolean res;
+
+  buffer = COGL_BUFFER (cogl_bitmap_get_buffer (priv->buffer));
+  if (buffer == NULL)
+    return FALSE;
+
+  data = cogl_buffer_map (buffer, COGL_BUFFER_ACCESS_READ, 0);
+  if (data == NULL)
+    return FALSE;
+
+  res = clutter_canvas_upload_region (self,
+                                      data,
+                                      cogl_bitmap_get_rowstride (priv->buffer));
+
+  cogl_buffer_unmap (buffer);
+
+  return res;
+}
+
+/* copies the contents drawn synchronously into an image surface */
+static cairo_surface_t *
+clutter_canvas_copy_buffer (ClutterCanvas *self)
+{
+  ClutterCanvasPrivate *priv = self->priv;
+  cairo_surface_t *surface;
+  CoglBuffer *buffer;
+  const guint8 *src;
+  guint8 *dst;
+  int width, height, src_stride, dst_stride, y;
+
+  buffer = COGL_BUFFER (cogl_bitmap_get_buffer (priv->buffer));
+  if (buffer == NULL)
+    return NULL;
+
+  src = cogl_buffer_map (buffer, COGL_BUFFER_ACCESS_READ, 0);
+  if (src == NULL)
+    return NULL;
+
+  width = cogl_bitmap_get_width (priv->buffer);
+  height = cogl_bitmap_get_height (priv->buffer);
+  src_stride = cogl_bitmap_get_rowstride (priv->buffer);
+
+  surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32, width, height);
+  cairo_surface_flush (surface);
+
+  dst = cairo_image_surface_get_data (surface);
+  dst_stride = cairo_image_surface_get_stride (surface);
+
+  for (y = 0; y < height; y++)
+    memcpy (dst + y * dst_stride, src + y * src_stride, width * 4);
+
+  cairo_surface_mark_dirty (surface);
+
+  cogl_buffer_unmap (buffer);
+
+  return surface;
+}
+
+static CoglTexture *
+clutter_canvas_get_texture (ClutterCanvas *self)
+{
+  ClutterCanvasPrivate *priv = self->priv;
+  cairo_surface_t *surface = NULL;
+  int width, height;
+
+  if (priv->draw_async)
+    {
+      surface = priv->front_surface;
+      if (surface == NULL)
+        return NULL;
+
+      width = cairo_image_surface_get_width (surface);
+      height = cairo_image_surface_get_height (surface);
+    }
+  else
+    {
+      if (priv->buffer == NULL)
+        return NULL;
+
+      width = cogl_bitmap_get_width (priv->buffer);
+      height = cogl_bitmap_get_height (priv->buffer);
+    }
+
+  if (priv->texture != NULL &&
+      (cogl_texture_get_width (priv->texture) != width ||
+       cogl_texture_get_height (priv->texture) != height))
+    {
+      cogl_object_unref (priv->texture);
+      priv->texture = NULL;
+    }
+
+  /* only the areas that have been drawn since the last paint are
+   * uploaded; if the upload fails, we create a new texture instead
+   */
+  if (priv->texture != NULL && priv->upload_region != NULL)
+    {
+      gboolean res;
+
+      if (surface != NULL)
+        res = clutter_canvas_upload_region (self,
+                                            cairo_image_surface_get_data (surface),
+                                            cairo_image_surface_get_stride (surface));
+      else
+        res = clutter_canvas_upload_buffer (self);
+
+      if (!res)
+        {
+          cogl_object_unref (priv->texture);
+          priv->texture = NULL;
+        }
+    }
+
+  if (priv->texture == NULL)
+    {
+      if (surface != NULL)
+        priv->texture =
+          cogl_texture_new_from_data (width, height,
+                                      COGL_TEXTURE_NO_SLICING,
+                                      CLUTTER_CAIRO_FORMAT_ARGB32,
+                                      COGL_PIXEL_FORMAT_ANY,
+                                      cairo_image_surface_get_stride (surface),
+                                      cairo_image_surface_get_data (surface));
+      else
+        priv->texture = cogl_texture_new_from_bitmap (priv->buffer,
+                                                      COGL_TEXTURE_NO_SLICING,
+                                                      CLUTTER_CAIRO_FORMAT_ARGB32);
+    }
+
+  g_clear_pointer (&priv->upload_region, cairo_region_destroy);
+
+  return priv->texture;
+}
+
 static void
 clutter_canvas_paint_content (ClutterContent   *content,
                               ClutterActor     *actor,
@@ -297,12 +571,7 @@ clutter_canvas_paint_content (ClutterContent   *content,
   ClutterScalingFilter min_f, mag_f;
   ClutterContentRepeat repeat;
 
-  if (self->priv->buffer == NULL)
-    return;
-
-  texture = cogl_texture_new_from_bitmap (self->priv->buffer,
-                                          COGL_TEXTURE_NO_SLICING,
-                                          CLUTTER_CAIRO_FORMAT_ARGB32);
+  texture = clutter_canvas_get_texture (self);
   if (texture == NULL)
     return;
 
@@ -317,7 +586,6 @@ clutter_canvas_paint_content (ClutterContent   *content,
   color.alpha = paint_opacity;
 
   node = clutter_texture_node_new (texture, &color, min_f, mag_f);
-  cogl_object_unref (texture);
 
   clutter_paint_node_set_name (node, "Canvas");
 
@@ -342,8 +610,51 @@ clutter_canvas_paint_content (ClutterContent   *content,
   clutter_paint_node_unref (node);
 }
 
+/* the texture is updated at the next paint */
+static void
+clutter_canvas_add_upload_region (ClutterCanvas        *self,
+                                  const cairo_region_t *clip,
+                                  int                   width,
+                                  int                   height)
+{
+  ClutterCanvasPrivate *priv = self->priv;
+
+  if (clip != NULL)
+    {
+      if (priv->upload_region == NULL)
+        priv->upload_region = cairo_region_copy (clip);
+      else
+        cairo_region_union (priv->upload_region, clip);
+    }
+  else
+    {
+      cairo_rectangle_int_t rect = { 0, 0, width, height };
+
+      g_clear_pointer (&priv->upload_region, cairo_region_destroy);
+      priv->upload_region = cairo_region_create_rectangle (&rect);
+    }
+}
+
+static void
+clutter_canvas_clip (cairo_t              *cr,
+                     const cairo_region_t *clip)
+{
+  int i, n_rects = cairo_region_num_rectangles (clip);
+
+  for (i = 0; i < n_rects; i++)
+    {
+      cairo_rectangle_int_t rect;
+
+      cairo_region_get_rectangle (clip, i, &rect);
+      cairo_rectangle (cr, rect.x, rect.y, rect.width, rect.height);
+    }
+
+  cairo_clip (cr);
+}
+
 static void
-clutter_canvas_emit_draw (ClutterCanvas *self)
+clutter_canvas_emit_draw (ClutterCanvas        *self,
+                          const cairo_region_t *clip)
 {
   ClutterCanvasPrivate *priv = self->priv;
   cairo_surface_t *surface;
@@ -355,6 +666,18 @@ clutter_canvas_emit_draw (ClutterCanvas *self)
 
   g_assert (priv->width > 0 && priv->width > 0);
 
+  if (priv->buffer != NULL &&
+      (cogl_bitmap_get_width (priv->buffer) != priv->width ||
+       cogl_bitmap_get_height (priv->buffer) != priv->height))
+    {
+      cogl_object_unref (priv->buffer);
+      priv->buffer = NULL;
+    }
+
+  /* a new buffer has no contents to preserve */
+  if (priv->buffer == NULL)
+    clip = NULL;
+
   if (priv->buffer == NULL)
     {
       CoglContext *ctx;
@@ -374,7 +697,11 @@ clutter_canvas_emit_draw (ClutterCanvas *self)
 
   data = cogl_buffer_map (buffer,
                           COGL_BUFFER_ACCESS_READ_WRITE,
-                          COGL_BUFFER_MAP_HINT_DISCARD);
+                          clip == NULL ? COGL_BUFFER_MAP_HINT_DISCARD : 0);
+
+  /* without a mapping, the whole buffer is replaced */
+  if (data == NULL)
+    clip = NULL;
 
   if (data != NULL)
     {
@@ -398,6 +725,9 @@ clutter_canvas_emit_draw (ClutterCanvas *self)
 
   self->priv->cr = cr = cairo_create (surface);
 
+  if (clip != NULL)
+    clutter_canvas_clip (cr, clip);
+
   g_signal_emit (self, canvas_signals[DRAW], 0,
                  cr, priv->width, priv->height,
                  &res);
@@ -426,6 +756,187 @@ clutter_canvas_emit_draw (ClutterCanvas *self)
     }
 
   cairo_surface_destroy (surface);
+
+  clutter_canvas_add_upload_region (self, clip, priv->width, priv->height);
+}
+
+static gboolean draw_job_done (gpointer data);
+
+/* runs in a worker thread */
+static void
+draw_job_run (gpointer data,
+              gpointer user_data)
+{
+  DrawJob *job = data;
+  gboolean res;
+  cairo_t *cr;
+
+  if (job->surface != NULL &&
+      (cairo_image_surface_get_width (job->surface) != job->width ||
+       cairo_image_surface_get_height (job->surface) != job->height))
+    g_clear_pointer (&job->surface, cairo_surface_destroy);
+
+  if (job->surface == NULL)
+    job->surface = cairo_image_surface_create (CAIRO_FORMAT_ARGB32,
+                                               job->width,
+                                               job->height);
+
+  cr = cairo_create (job->surface);
+
+  /* the surface holds older contents, so we start from the last
+   * completed ones if only the clip is redrawn
+   */
+  if (job->clip != NULL)
+    {
+      cairo_set_operator (cr, CAIRO_OPERATOR_SOURCE);
+      cairo_set_source_surface (cr, job->source, 0, 0);
+      cairo_paint (cr);
+      cairo_set_operator (cr, CAIRO_OPERATOR_OVER);
+      cairo_set_source_rgba (cr, 0, 0, 0, 1);
+
+      clutter_canvas_clip (cr, job->clip);
+    }
+
+  g_signal_emit (job->canvas, canvas_signals[DRAW], 0,
+                 cr, job->width, job->height,
+                 &res);
+
+#ifdef CLUTTER_ENABLE_DEBUG
+  if (_clutter_diagnostic_enabled () && cairo_status (cr))
+    {
+      g_warning ("Drawing failed for <ClutterCanvas>[%p]: %s",
+                 job->canvas,
+                 cairo_status_to_string (cairo_status (cr)));
+    }
+#endif
+
+  cairo_destroy (cr);
+  cairo_surface_flush (job->surface);
+
+  clutter_threads_add_idle_full (G_PRIORITY_HIGH_IDLE,
+                                 draw_job_done,
+                                 job,
+                                 NULL);
+}
+
+static void
+clutter_canvas_start_draw_job (ClutterCanvas  *self,
+                               cairo_region_t *clip)
+{
+  ClutterCanvasPrivate *priv = self->priv;
+  DrawJob *job;
+
+  g_assert (priv->job == NULL);
+
+  job = g_slice_new0 (DrawJob);
+  job->canvas = g_object_ref (self);
+  job->width = priv->width;
+  job->height = priv->height;
+
+  job->surface = priv->back_surface;
+  priv->back_surface = NULL;
+
+  if (clip != NULL &&
+      priv->front_surface != NULL &&
+      cairo_image_surface_get_width (priv->front_surface) == priv->width &&
+      cairo_image_surface_get_height (priv->front_surface) == priv->height)
+    {
+      job->source = cairo_surface_reference (priv->front_surface);
+      job->clip = clip;
+    }
+  else if (clip != NULL)
+    cairo_region_destroy (clip);
+
+  priv->job = job;
+
+  if (G_UNLIKELY (draw_thread_pool == NULL))
+    draw_thread_pool = g_thread_pool_new (draw_job_run, NULL,
+                                          MAX_DRAW_THREADS,
+                                          FALSE,
+                                          NULL);
+
+  g_thread_pool_push (draw_thread_pool, job, NULL);
+}
+
+static gboolean
+draw_job_done (gpointer data)
+{
+  DrawJob *job = data;
+  ClutterCanvas *self = job->canvas;
+  ClutterCanvasPrivate *priv = self->priv;
+
+  priv->job = NULL;
+
+  /* the results of a job started with a different size, or before
+   * going back to synchronous drawing, are thrown away
+   */
+  if (priv->draw_async &&
+      job->width == priv->width &&
+      job->height == priv->height)
+    {
+      g_clear_pointer (&priv->back_surface, cairo_surface_destroy);
+      priv->back_surface = priv->front_surface;
+      priv->front_surface = job->surface;
+
+      clutter_canvas_add_upload_region (self, job->clip,
+                                        job->width,
+                                        job->height);
+
+      _clutter_content_queue_redraw (CLUTTER_CONTENT (self));
+    }
+  else
+    cairo_surface_destroy (job->surface);
+
+  /* the invalidations received while drawing are coalesced into
+   * a single redraw
+   */
+  if (priv->draw_async && priv->redraw_queued &&
+      priv->width > 0 && priv->height > 0)
+    {
+      cairo_region_t *clip = priv->queued_region;
+
+      priv->queued_region = NULL;
+      priv->redraw_queued = FALSE;
+
+      clutter_canvas_start_draw_job (self, clip);
+    }
+
+  if (job->source != NULL)
+    cairo_surface_destroy (job->source);
+
+  if (job->clip != NULL)
+    cairo_region_destroy (job->clip);
+
+  g_slice_free (DrawJob, job);
+
+  g_object_unref (self);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+clutter_canvas_queue_draw_job (ClutterCanvas  *self,
+                               cairo_region_t *clip)
+{
+  ClutterCanvasPrivate *priv = self->priv;
+
+  if (priv->job == NULL)
+    {
+      clutter_canvas_start_draw_job (self, clip);
+      return;
+    }
+
+  if (clip == NULL)
+    g_clear_pointer (&priv->queued_region, cairo_region_destroy);
+  else if (!priv->redraw_queued)
+    priv->queued_region = cairo_region_copy (clip);
+  else if (priv->queued_region != NULL)
+    cairo_region_union (priv->queued_region, clip);
+
+  priv->redraw_queued = TRUE;
+
+  if (clip != NULL)
+    cairo_region_destroy (clip);
 }
 
 static void
@@ -433,17 +944,47 @@ clutter_canvas_invalidate (ClutterContent *content)
 {
   ClutterCanvas *self = CLUTTER_CANVAS (content);
   ClutterCanvasPrivate *priv = self->priv;
+  cairo_region_t *redraw_region;
 
-  if (priv->buffer != NULL)
+  /* take the damaged areas, so that invalidations coming from the
+   * ::draw handlers are not lost
+   */
+  redraw_region = priv->redraw_region;
+  priv->redraw_region = NULL;
+
+  if (priv->width <= 0 || priv->height <= 0)
     {
-      cogl_object_unref (priv->buffer);
-      priv->buffer = NULL;
+      if (priv->buffer != NULL)
+        {
+          cogl_object_unref (priv->buffer);
+          priv->buffer = NULL;
+        }
+
+      if (priv->texture != NULL)
+        {
+          cogl_object_unref (priv->texture);
+          priv->texture = NULL;
+        }
+
+      g_clear_pointer (&priv->upload_region, cairo_region_destroy);
+      g_clear_pointer (&priv->front_surface, cairo_surface_destroy);
+      g_clear_pointer (&priv->back_surface, cairo_surface_destroy);
+      g_clear_pointer (&priv->queued_region, cairo_region_destroy);
+      g_clear_pointer (&redraw_region, cairo_region_destroy);
+      priv->redraw_queued = FALSE;
+
+      return;
     }
 
-  if (priv->width <= 0 || priv->height <= 0)
-    return;
+  if (priv->draw_async)
+    {
+      clutter_canvas_queue_draw_job (self, redraw_region);
+      return;
+    }
+
+  clutter_canvas_emit_draw (self, redraw_region);
 
-  clutter_canvas_emit_draw (self);
+  g_clear_pointer (&redraw_region, cairo_region_destroy);
 }
 
 static gboolean
@@ -542,3 +1083,137 @@ clutter_canvas_set_size (ClutterCanvas *canvas,
 
   g_object_thaw_notify (obj);
 }
+
+/**
+ * clutter_canvas_invalidate_rectangle:
+ * @canvas: a #ClutterCanvas
+ * @rect: (allow-none): the area of the @canvas to redraw, or %NULL
+ *   to redraw the whole canvas
+ *
+ * Invalidates an area of the @canvas.
+ *
+ * The #ClutterCanvas::draw signal will be emitted with a Cairo context
+ * clipped to the areas invalidated since the last emission; handlers
+ * can use cairo_clip_extents() to skip the drawing outside of them.
+ * Only the invalidated areas will be uploaded to the texture painted
+ * by the @canvas.
+ *
+ * Calling clutter_content_invalidate() or changing the size of the
+ * @canvas causes the whole canvas to be redrawn.
+ *
+ * Since: 1.14
+ * Stability: unstable
+ */
+void
+clutter_canvas_invalidate_rectangle (ClutterCanvas               *canvas,
+                                     const cairo_rectangle_int_t *rect)
+{
+  ClutterCanvasPrivate *priv;
+  cairo_rectangle_int_t area;
+
+  g_return_if_fail (CLUTTER_IS_CANVAS (canvas));
+
+  priv = canvas->priv;
+
+  if (rect == NULL || priv->width <= 0 || priv->height <= 0)
+    {
+      clutter_content_invalidate (CLUTTER_CONTENT (canvas));
+      return;
+    }
+
+  area.x = MAX (rect->x, 0);
+  area.y = MAX (rect->y, 0);
+  area.width = MIN (rect->x + rect->width, priv->width) - area.x;
+  area.height = MIN (rect->y + rect->height, priv->height) - area.y;
+
+  if (area.width <= 0 || area.height <= 0)
+    return;
+
+  if (priv->redraw_region == NULL)
+    priv->redraw_region = cairo_region_create_rectangle (&area);
+  else
+    cairo_region_union_rectangle (priv->redraw_region, &area);
+
+  clutter_content_invalidate (CLUTTER_CONTENT (canvas));
+}
+
+/**
+ * clutter_canvas_set_draw_async:
+ * @canvas: a #ClutterCanvas
+ * @draw_async: whether the @canvas should be drawn in a worker thread
+ *
+ * Sets whether the #ClutterCanvas::draw signal should be emitted in
+ * a worker thread.
+ *
+ * When drawing asynchronously, the @canvas keeps painting its last
+ * completed contents until the drawing in progress is done, including
+ * the contents drawn before switching to asynchronous drawing; the new
+ * contents are then uploaded before the next frame. Invalidations
+ * received while drawing are coalesced into a single redraw.
+ *
+ * The handlers of the #ClutterCanvas::draw signal must not use the
+ * Clutter API, or access data owned by the main thread without
+ * locking, when this property is set.
+ *
+ * Since: 1.14
+ * Stability: unstable
+ */
+void
+clutter_canvas_set_draw_async (ClutterCanvas *canvas,
+                               gboolean       draw_async)
+{
+  ClutterCanvasPrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_CANVAS (canvas));
+
+  priv = canvas->priv;
+
+  draw_async = !!draw_async;
+
+  if (priv->draw_async == draw_async)
+    return;
+
+  priv->draw_async = draw_async;
+
+  /* the contents of the other mode are out of date */
+  g_clear_pointer (&priv->front_surface, cairo_surface_destroy);
+  g_clear_pointer (&priv->back_surface, cairo_surface_destroy);
+  g_clear_pointer (&priv->queued_region, cairo_region_destroy);
+  g_clear_pointer (&priv->redraw_region, cairo_region_destroy);
+  priv->redraw_queued = FALSE;
+
+  if (priv->buffer != NULL)
+    {
+      /* the last contents drawn synchronously are painted until
+       * the first asynchronous drawing completes
+       */
+      if (draw_async)
+        priv->front_surface = clutter_canvas_copy_buffer (canvas);
+
+      cogl_object_unref (priv->buffer);
+      priv->buffer = NULL;
+    }
+
+  clutter_content_invalidate (CLUTTER_CONTENT (canvas));
+
+  g_object_notify_by_pspec (G_OBJECT (canvas), obj_props[PROP_DRAW_ASYNC]);
+}
+
+/**
+ * clutter_canvas_get_draw_async:
+ * @canvas: a #ClutterCanvas
+ *
+ * Retrieves the value set using clutter_canvas_set_draw_async().
+ *
+ * Return value: %TRUE if the @canvas is drawn in a worker thread
+ *
+ * Since: 1.14
+ * Stability: unstable
+ */
+gboolean
+clutter_canvas_get_draw_async (ClutterCanvas *canvas)
+{
+  g_return_val_if_fail (CLUTTER_IS_CANVAS (canvas), FALSE);
+
+  return canvas->priv->draw_async;
+}
@@ -95,6 +95,17 @@ void                    clutter_canvas_set_size         (ClutterCanvas *canvas,
                                                          int            width,
                                                          int            height);
 
+#ifdef CLUTTER_ENABLE_EXPERIMENTAL_API
+CLUTTER_AVAILABLE_IN_1_14
+void                    clutter_canvas_invalidate_rectangle (ClutterCanvas               *canvas,
+                                                             const cairo_rectangle_int_t *rect);
+CLUTTER_AVAILABLE_IN_1_14
+void                    clutter_canvas_set_draw_async   (ClutterCanvas *canvas,
+                                                         gboolean       draw_async);
+CLUTTER_AVAILABLE_IN_1_14
+gboolean                clutter_canvas_get_draw_async   (ClutterCanvas *canvas);
+#endif
+
 G_END_DECLS
 
 #endif /* __CLUTTER_CANVAS_H__ */
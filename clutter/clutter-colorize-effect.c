@@ -49,7 +49,7 @@
 
 #include "clutter-debug.h"
 #include "clutter-enum-types.h"
-#include "clutter-offscreen-effect.h"
+#include "clutter-offscreen-effect-private.h"
 #include "clutter-private.h"
 
 struct _ClutterColorizeEffect
@@ -307,6 +307,10 @@ clutter_colorize_effect_init (ClutterColorizeEffect *self)
   self->tint = default_tint;
 
   update_tint_uniform (self);
+
+  /* the texture is painted at a 1:1 texel:pixel ratio */
+  _clutter_offscreen_effect_set_round_target_size (CLUTTER_OFFSCREEN_EFFECT (self),
+                                                   TRUE);
 }
 
 /**
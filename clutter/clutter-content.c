@@ -33,6 +33,14 @@
  * Multiple actors can use the same #ClutterContent instance, in order
  * to share the resources associated with painting the same content.
  *
+ * The paint nodes created by the #ClutterContentIface.paint_content()
+ * virtual function are retained by the actor and painted again on the
+ * following frames, so the function is not called on every frame: it
+ * is only called again after clutter_content_invalidate(), or after the
+ * actor queued a redraw, changed its size or its paint opacity.
+ * Implementations whose painting depends on any other state must call
+ * clutter_content_invalidate() when that state changes.
+ *
  * #ClutterContent is available since Clutter 1.10.
  */
 
@@ -167,14 +175,30 @@ clutter_content_default_init (ClutterContentInterface *iface)
 void
 clutter_content_invalidate (ClutterContent *content)
 {
-  GHashTable *actors;
-  GHashTableIter iter;
-  gpointer key_p, value_p;
-
   g_return_if_fail (CLUTTER_IS_CONTENT (content));
 
   CLUTTER_CONTENT_GET_IFACE (content)->invalidate (content);
 
+  _clutter_content_queue_redraw (content);
+}
+
+/*< private >
+ * _clutter_content_queue_redraw:
+ * @content: a #ClutterContent
+ *
+ * Queues a redraw of all the actors using @content, without
+ * invalidating it.
+ *
+ * This function should be used by #ClutterContent implementations
+ * that update their state outside of #ClutterContentIface.invalidate.
+ */
+void
+_clutter_content_queue_redraw (ClutterContent *content)
+{
+  GHashTable *actors;
+  GHashTableIter iter;
+  gpointer key_p, value_p;
+
   actors = g_object_get_qdata (G_OBJECT (content), quark_content_actors);
   if (actors == NULL)
     return;
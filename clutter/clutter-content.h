@@ -54,7 +54,9 @@ typedef struct _ClutterContentIface     ClutterContentIface;
  * @get_preferred_size: virtual function; should be overridden by subclasses
  *   of #ClutterContent that have a natural size
  * @paint_content: virtual function; called each time the content needs to
- *   paint itself
+ *   paint itself; the paint nodes it adds are retained until the content
+ *   is invalidated, or the actor is redrawn, resized or changes its paint
+ *   opacity
  * @attached: virtual function; called each time a #ClutterContent is attached
  *   to a #ClutterActor.
  * @detached: virtual function; called each time a #ClutterContent is detached
@@ -39,7 +39,10 @@ typedef enum {
   CLUTTER_DEBUG_DISABLE_CULLING         = 1 << 4,
   CLUTTER_DEBUG_DISABLE_OFFSCREEN_REDIRECT = 1 << 5,
   CLUTTER_DEBUG_CONTINUOUS_REDRAW       = 1 << 6,
-  CLUTTER_DEBUG_PAINT_DEFORM_TILES      = 1 << 7
+  CLUTTER_DEBUG_PAINT_DEFORM_TILES      = 1 << 7,
+  CLUTTER_DEBUG_DISABLE_RETAINED_PAINT_NODES = 1 << 8,
+  CLUTTER_DEBUG_DISABLE_PAINT_NODE_BATCHING = 1 << 9,
+  CLUTTER_DEBUG_DISABLE_OFFSCREEN_POOL  = 1 << 10
 } ClutterDrawDebugFlag;
 
 #ifdef CLUTTER_ENABLE_DEBUG
@@ -47,6 +47,13 @@
  *   Each passed vertex is an in-out parameter that initially contains the
  *   position of the vertex and should be modified according to a specific
  *   deformation algorithm.</para>
+ *   <para>Since Clutter 1.14, sub-classes can override the
+ *   #ClutterDeformEffectClass.deform_vertices() virtual function instead;
+ *   this function is called on ranges of vertices, stored as separate
+ *   arrays of coordinates in a #ClutterDeformVertices, which allows
+ *   deforming the whole grid with tight loops. When the number of tiles
+ *   is large, the ranges are deformed by different threads at the same
+ *   time, so the function should only read the state of the effect.</para>
  * </refsect2>
  *
  * #ClutterDeformEffect is available since Clutter 1.4
@@ -68,6 +75,16 @@
 
 #define DEFAULT_N_TILES         32
 
+/* grids with at least this many vertices are split across threads,
+ * if the sub-class implements ClutterDeformEffectClass.deform_vertices()
+ */
+#define THREADS_MIN_VERTICES    (128 * 128)
+
+/* the number of worker threads; the grid is split in one more range,
+ * which is deformed by the thread painting the effect
+ */
+#define MAX_DEFORM_THREADS      3
+
 struct _ClutterDeformEffectPrivate
 {
   CoglPipeline *back_pipeline;
@@ -75,6 +92,12 @@ struct _ClutterDeformEffectPrivate
   gint x_tiles;
   gint y_tiles;
 
+  /* the grid, with the x, y, z, tx and ty components of each vertex
+   * stored in consecutive arrays
+   */
+  gfloat *coords;
+  guint8 *colors;
+
   CoglAttributeBuffer *buffer;
 
   CoglPrimitive *primitive;
@@ -83,6 +106,12 @@ struct _ClutterDeformEffectPrivate
 
   gint n_vertices;
 
+  /* the part of the texture used by the actor, which can be smaller
+   * than the texture if it comes from the offscreen pool
+   */
+  gfloat s_scale;
+  gfloat t_scale;
+
   gulong allocation_id;
 
   guint is_dirty : 1;
@@ -102,6 +131,32 @@ enum
 
 static GParamSpec *obj_props[PROP_LAST];
 
+typedef struct {
+  GMutex mutex;
+  GCond cond;
+
+  gint n_pending;
+} DeformBatch;
+
+typedef struct {
+  ClutterDeformEffect *effect;
+  DeformBatch *batch;
+
+  gfloat width;
+  gfloat height;
+  guint8 opacity;
+
+  gfloat s_scale;
+  gfloat t_scale;
+
+  gint first_row;
+  gint n_rows;
+
+  CoglVertexP3T2C4 *verts;
+} DeformRange;
+
+static GThreadPool *deform_thread_pool = NULL;
+
 G_DEFINE_ABSTRACT_TYPE (ClutterDeformEffect,
                         clutter_deform_effect,
                         CLUTTER_TYPE_OFFSCREEN_EFFECT);
@@ -120,14 +175,201 @@ clutter_deform_effect_real_deform_vertex (ClutterDeformEffect *effect,
 }
 
 static void
-clutter_deform_effect_deform_vertex (ClutterDeformEffect *effect,
-                                     gfloat               width,
-                                     gfloat               height,
-                                     CoglTextureVertex   *vertex)
+clutter_deform_effect_real_deform_vertices (ClutterDeformEffect   *effect,
+                                            gfloat                 width,
+                                            gfloat                 height,
+                                            ClutterDeformVertices *vertices)
 {
-  CLUTTER_DEFORM_EFFECT_GET_CLASS (effect)->deform_vertex (effect,
-                                                           width, height,
-                                                           vertex);
+  ClutterDeformEffectClass *klass = CLUTTER_DEFORM_EFFECT_GET_CLASS (effect);
+  guint i;
+
+  /* CoglTextureVertex isn't an ideal structure to use for this because
+   * it contains a CoglColor; we let the sub-class modify a dummy vertex
+   * and then copy the details back out to the arrays
+   */
+  for (i = 0; i < vertices->n_vertices; i++)
+    {
+      CoglTextureVertex vertex;
+      guint8 *color = vertices->colors + i * 4;
+
+      vertex.x = vertices->x[i];
+      vertex.y = vertices->y[i];
+      vertex.z = vertices->z[i];
+      vertex.tx = vertices->tx[i];
+      vertex.ty = vertices->ty[i];
+      cogl_color_init_from_4ub (&vertex.color,
+                                color[0],
+                                color[1],
+                                color[2],
+                                color[3]);
+
+      klass->deform_vertex (effect, width, height, &vertex);
+
+      vertices->x[i] = vertex.x;
+      vertices->y[i] = vertex.y;
+      vertices->z[i] = vertex.z;
+      vertices->tx[i] = vertex.tx;
+      vertices->ty[i] = vertex.ty;
+      color[0] = cogl_color_get_red_byte (&vertex.color);
+      color[1] = cogl_color_get_green_byte (&vertex.color);
+      color[2] = cogl_color_get_blue_byte (&vertex.color);
+      color[3] = cogl_color_get_alpha_byte (&vertex.color);
+    }
+}
+
+/* resets, deforms and packs a range of rows of the grid */
+static void
+clutter_deform_effect_deform_range (DeformRange *range)
+{
+  ClutterDeformEffect *self = range->effect;
+  ClutterDeformEffectPrivate *priv = self->priv;
+  ClutterDeformVertices vertices;
+  gint row_length, first, i, j;
+  gfloat *x, *y, *z, *tx, *ty;
+  guint8 *colors;
+
+  row_length = priv->x_tiles + 1;
+  first = range->first_row * row_length;
+
+  vertices.n_vertices = range->n_rows * row_length;
+  vertices.x = x = priv->coords + first;
+  vertices.y = y = priv->coords + priv->n_vertices + first;
+  vertices.z = z = priv->coords + priv->n_vertices * 2 + first;
+  vertices.tx = tx = priv->coords + priv->n_vertices * 3 + first;
+  vertices.ty = ty = priv->coords + priv->n_vertices * 4 + first;
+  vertices.colors = colors = priv->colors + first * 4;
+
+  for (i = 0; i < range->n_rows; i++)
+    {
+      gfloat row_ty = (gfloat) (range->first_row + i) / priv->y_tiles;
+
+      for (j = 0; j < row_length; j++)
+        {
+          gint k = i * row_length + j;
+
+          tx[k] = (gfloat) j / priv->x_tiles;
+          ty[k] = row_ty;
+          x[k] = range->width * tx[k];
+          y[k] = range->height * row_ty;
+          z[k] = 0.0f;
+
+          colors[k * 4 + 0] = 255;
+          colors[k * 4 + 1] = 255;
+          colors[k * 4 + 2] = 255;
+          colors[k * 4 + 3] = range->opacity;
+        }
+    }
+
+  CLUTTER_DEFORM_EFFECT_GET_CLASS (self)->deform_vertices (self,
+                                                           range->width,
+                                                           range->height,
+                                                           &vertices);
+
+  for (i = 0; i < vertices.n_vertices; i++)
+    {
+      CoglVertexP3T2C4 *vertex_out = range->verts + first + i;
+
+      vertex_out->x = x[i];
+      vertex_out->y = y[i];
+      vertex_out->z = z[i];
+      vertex_out->s = tx[i] * range->s_scale;
+      vertex_out->t = ty[i] * range->t_scale;
+      vertex_out->r = colors[i * 4 + 0];
+      vertex_out->g = colors[i * 4 + 1];
+      vertex_out->b = colors[i * 4 + 2];
+      vertex_out->a = colors[i * 4 + 3];
+    }
+}
+
+static void
+deform_range_run (gpointer data,
+                  gpointer user_data G_GNUC_UNUSED)
+{
+  DeformRange *range = data;
+  DeformBatch *batch = range->batch;
+
+  clutter_deform_effect_deform_range (range);
+
+  g_mutex_lock (&batch->mutex);
+  batch->n_pending -= 1;
+  if (batch->n_pending == 0)
+    g_cond_signal (&batch->cond);
+  g_mutex_unlock (&batch->mutex);
+}
+
+/* deforms the whole grid into @verts, splitting it in ranges of rows
+ * deformed by the worker threads if the grid is large enough
+ */
+static void
+clutter_deform_effect_deform_grid (ClutterDeformEffect *self,
+                                   gfloat               width,
+                                   gfloat               height,
+                                   guint8               opacity,
+                                   CoglVertexP3T2C4    *verts)
+{
+  ClutterDeformEffectPrivate *priv = self->priv;
+  ClutterDeformEffectClass *klass = CLUTTER_DEFORM_EFFECT_GET_CLASS (self);
+  DeformRange ranges[MAX_DEFORM_THREADS + 1];
+  DeformBatch batch;
+  gint n_rows, n_ranges, i;
+
+  n_rows = priv->y_tiles + 1;
+
+  /* the default implementation calls deform_vertex(), which was never
+   * required to be thread safe
+   */
+  if (priv->n_vertices >= THREADS_MIN_VERTICES &&
+      klass->deform_vertices != clutter_deform_effect_real_deform_vertices)
+    n_ranges = MIN (MAX_DEFORM_THREADS + 1, n_rows);
+  else
+    n_ranges = 1;
+
+  for (i = 0; i < n_ranges; i++)
+    {
+      ranges[i].effect = self;
+      ranges[i].batch = &batch;
+      ranges[i].width = width;
+      ranges[i].height = height;
+      ranges[i].opacity = opacity;
+      ranges[i].s_scale = priv->s_scale;
+      ranges[i].t_scale = priv->t_scale;
+      /* the rows are split evenly, so that no range is left empty as
+       * long as there are at least as many rows as ranges
+       */
+      ranges[i].first_row = i * n_rows / n_ranges;
+      ranges[i].n_rows = (i + 1) * n_rows / n_ranges - ranges[i].first_row;
+      ranges[i].verts = verts;
+    }
+
+  if (n_ranges == 1)
+    {
+      clutter_deform_effect_deform_range (&ranges[0]);
+      return;
+    }
+
+  if (G_UNLIKELY (deform_thread_pool == NULL))
+    deform_thread_pool = g_thread_pool_new (deform_range_run, NULL,
+                                            MAX_DEFORM_THREADS,
+                                            FALSE,
+                                            NULL);
+
+  g_mutex_init (&batch.mutex);
+  g_cond_init (&batch.cond);
+  batch.n_pending = n_ranges - 1;
+
+  for (i = 1; i < n_ranges; i++)
+    g_thread_pool_push (deform_thread_pool, &ranges[i], NULL);
+
+  /* the first range is deformed while waiting for the other ones */
+  clutter_deform_effect_deform_range (&ranges[0]);
+
+  g_mutex_lock (&batch.mutex);
+  while (batch.n_pending > 0)
+    g_cond_wait (&batch.cond, &batch.mutex);
+  g_mutex_unlock (&batch.mutex);
+
+  g_mutex_clear (&batch.mutex);
+  g_cond_clear (&batch.cond);
 }
 
 static void
@@ -177,25 +419,43 @@ clutter_deform_effect_paint_target (ClutterOffscreenEffect *effect)
   CoglPipeline *pipeline;
   CoglDepthState depth_state;
   CoglFramebuffer *fb = cogl_get_draw_framebuffer ();
+  ClutterActor *actor;
+  gfloat width, height, s_scale, t_scale;
+
+  actor = clutter_actor_meta_get_actor (CLUTTER_ACTOR_META (effect));
+
+  /* if we don't have a target size, fall back to the actor's
+   * allocation, though wrong it might be
+   */
+  if (clutter_offscreen_effect_get_target_size (effect, &width, &height))
+    {
+      CoglHandle texture = clutter_offscreen_effect_get_texture (effect);
+
+      s_scale = width / cogl_texture_get_width (texture);
+      t_scale = height / cogl_texture_get_height (texture);
+    }
+  else
+    {
+      clutter_actor_get_size (actor, &width, &height);
+      s_scale = t_scale = 1.0f;
+    }
+
+  /* the texture coordinates change with the size of the texture */
+  if (s_scale != priv->s_scale || t_scale != priv->t_scale)
+    {
+      priv->s_scale = s_scale;
+      priv->t_scale = t_scale;
+      priv->is_dirty = TRUE;
+    }
 
   if (priv->is_dirty)
     {
       gboolean mapped_buffer;
       CoglVertexP3T2C4 *verts;
-      ClutterActor *actor;
-      gfloat width, height;
       guint opacity;
-      gint i, j;
 
-      actor = clutter_actor_meta_get_actor (CLUTTER_ACTOR_META (effect));
       opacity = clutter_actor_get_paint_opacity (actor);
 
-      /* if we don't have a target size, fall back to the actor's
-       * allocation, though wrong it might be
-       */
-      if (!clutter_offscreen_effect_get_target_size (effect, &width, &height))
-        clutter_actor_get_size (actor, &width, &height);
-
       /* XXX ideally, the sub-classes should tell us what they
        * changed in the texture vertices; we then would be able to
        * avoid resubmitting the same data, if it did not change. for
@@ -215,49 +475,7 @@ clutter_deform_effect_paint_target (ClutterOffscreenEffect *effect)
       else
         mapped_buffer = TRUE;
 
-      for (i = 0; i < priv->y_tiles + 1; i++)
-        {
-          for (j = 0; j < priv->x_tiles + 1; j++)
-            {
-              CoglVertexP3T2C4 *vertex_out;
-              CoglTextureVertex vertex;
-
-              /* CoglTextureVertex isn't an ideal structure to use for
-                 this because it contains a CoglColor. The internal
-                 layout of CoglColor is mean to be private so Clutter
-                 can not pass a pointer to it as a vertex
-                 attribute. Also it contains padding so we end up
-                 storing more data in the vertex buffer than we need
-                 to. Instead we let the application modify a dummy
-                 vertex and then copy the details back out to a more
-                 well-defined struct */
-
-              vertex.tx = (float) j / priv->x_tiles;
-              vertex.ty = (float) i / priv->y_tiles;
-
-              vertex.x = width * vertex.tx;
-              vertex.y = height * vertex.ty;
-              vertex.z = 0.0f;
-
-              cogl_color_init_from_4ub (&vertex.color, 255, 255, 255, opacity);
-
-              clutter_deform_effect_deform_vertex (self,
-                                                   width, height,
-                                                   &vertex);
-
-              vertex_out = verts + i * (priv->x_tiles + 1) + j;
-
-              vertex_out->x = vertex.x;
-              vertex_out->y = vertex.y;
-              vertex_out->z = vertex.z;
-              vertex_out->s = vertex.tx;
-              vertex_out->t = vertex.ty;
-              vertex_out->r = cogl_color_get_red_byte (&vertex.color);
-              vertex_out->g = cogl_color_get_green_byte (&vertex.color);
-              vertex_out->b = cogl_color_get_blue_byte (&vertex.color);
-              vertex_out->a = cogl_color_get_alpha_byte (&vertex.color);
-            }
-        }
+      clutter_deform_effect_deform_grid (self, width, height, opacity, verts);
 
       if (mapped_buffer)
         cogl_buffer_unmap (COGL_BUFFER (priv->buffer));
@@ -341,6 +559,12 @@ clutter_deform_effect_free_arrays (ClutterDeformEffect *self)
       cogl_object_unref (priv->lines_primitive);
       priv->lines_primitive = NULL;
     }
+
+  g_free (priv->coords);
+  priv->coords = NULL;
+
+  g_free (priv->colors);
+  priv->colors = NULL;
 }
 
 static void
@@ -424,6 +648,9 @@ clutter_deform_effect_init_arrays (ClutterDeformEffect *self)
 
   priv->n_vertices = (priv->x_tiles + 1) * (priv->y_tiles + 1);
 
+  priv->coords = g_new (gfloat, priv->n_vertices * 5);
+  priv->colors = g_new (guint8, priv->n_vertices * 4);
+
   priv->buffer =
     cogl_attribute_buffer_new (ctx,
                                sizeof (CoglVertexP3T2C4) *
@@ -574,6 +801,7 @@ clutter_deform_effect_class_init (ClutterDeformEffectClass *klass)
   g_type_class_add_private (klass, sizeof (ClutterDeformEffectPrivate));
 
   klass->deform_vertex = clutter_deform_effect_real_deform_vertex;
+  klass->deform_vertices = clutter_deform_effect_real_deform_vertices;
 
   /**
    * ClutterDeformEffect:x-tiles:
@@ -644,8 +872,13 @@ clutter_deform_effect_init (ClutterDeformEffect *self)
 
   self->priv->x_tiles = self->priv->y_tiles = DEFAULT_N_TILES;
   self->priv->back_pipeline = NULL;
+  self->priv->s_scale = self->priv->t_scale = 1.0f;
 
   clutter_deform_effect_init_arrays (self);
+
+  /* the texture coordinates only cover the area used by the actor */
+  _clutter_offscreen_effect_set_round_target_size (CLUTTER_OFFSCREEN_EFFECT (self),
+                                                   TRUE);
 }
 
 /**
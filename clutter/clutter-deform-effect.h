@@ -44,6 +44,43 @@ G_BEGIN_DECLS
 typedef struct _ClutterDeformEffect             ClutterDeformEffect;
 typedef struct _ClutterDeformEffectPrivate      ClutterDeformEffectPrivate;
 typedef struct _ClutterDeformEffectClass        ClutterDeformEffectClass;
+typedef struct _ClutterDeformVertices           ClutterDeformVertices;
+
+/**
+ * ClutterDeformVertices:
+ * @n_vertices: the number of vertices
+ * @x: (array length=n_vertices): the X coordinates of the vertices
+ * @y: (array length=n_vertices): the Y coordinates of the vertices
+ * @z: (array length=n_vertices): the Z coordinates of the vertices
+ * @tx: (array length=n_vertices): the horizontal texture coordinates
+ *   of the vertices, between 0.0 and 1.0
+ * @ty: (array length=n_vertices): the vertical texture coordinates
+ *   of the vertices, between 0.0 and 1.0
+ * @colors: the colors of the vertices, as four bytes for the red,
+ *   green, blue and alpha components of each vertex
+ *
+ * A range of vertices of the grid of a #ClutterDeformEffect, with each
+ * component stored in its own array.
+ *
+ * All the arrays are in-out parameters, initially containing the
+ * undeformed grid, that should be modified according to a specific
+ * deformation algorithm.
+ *
+ * Since: 1.14
+ */
+struct _ClutterDeformVertices
+{
+  guint n_vertices;
+
+  gfloat *x;
+  gfloat *y;
+  gfloat *z;
+
+  gfloat *tx;
+  gfloat *ty;
+
+  guint8 *colors;
+};
 
 /**
  * ClutterDeformEffect:
@@ -65,6 +102,11 @@ struct _ClutterDeformEffect
  * ClutterDeformEffectClass:
  * @deform_vertex: virtual function; sub-classes should override this
  *   function to compute the deformation of each vertex
+ * @deform_vertices: virtual function; sub-classes can override this
+ *   function to compute the deformation of a range of vertices at once,
+ *   instead of overriding @deform_vertex. When the grid is large, the
+ *   function can be called from different threads at the same time,
+ *   on separate ranges of vertices. Since: 1.14
  *
  * The <structname>ClutterDeformEffectClass</structname> structure contains
  * only private data
@@ -82,8 +124,12 @@ struct _ClutterDeformEffectClass
                           gfloat               height,
                           CoglTextureVertex   *vertex);
 
+  void (* deform_vertices) (ClutterDeformEffect   *effect,
+                            gfloat                 width,
+                            gfloat                 height,
+                            ClutterDeformVertices *vertices);
+
   /*< private >*/
-  void (*_clutter_deform1) (void);
   void (*_clutter_deform2) (void);
   void (*_clutter_deform3) (void);
   void (*_clutter_deform4) (void);
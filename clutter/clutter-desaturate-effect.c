@@ -53,7 +53,7 @@
 
 #include "clutter-debug.h"
 #include "clutter-enum-types.h"
-#include "clutter-offscreen-effect.h"
+#include "clutter-offscreen-effect-private.h"
 #include "clutter-private.h"
 
 struct _ClutterDesaturateEffect
@@ -312,6 +312,10 @@ clutter_desaturate_effect_init (ClutterDesaturateEffect *self)
   self->factor = 1.0;
 
   update_factor_uniform (self);
+
+  /* the texture is painted at a 1:1 texel:pixel ratio */
+  _clutter_offscreen_effect_set_round_target_size (CLUTTER_OFFSCREEN_EFFECT (self),
+                                                   TRUE);
 }
 
 /**
@@ -69,6 +69,44 @@ typedef struct _ClutterTouchInfo
   gint current_y;
 } ClutterTouchInfo;
 
+/* the maximum number of touch points tracked at the same time by the
+ * sequence table, across all the input devices
+ */
+#define CLUTTER_MAX_EVENT_SEQUENCES     (64)
+
+/* Backends able to identify the touch points of a device allocate
+ * their sequences from a static table, so that the state of a touch
+ * point can be accessed directly from its ClutterEventSequence; other
+ * backends use opaque identifiers cast to pointers, and their state is
+ * stored inside hash tables keyed by the sequence
+ */
+struct _ClutterEventSequence
+{
+  /* the device owning the sequence, or NULL if the slot is free */
+  ClutterInputDevice *device;
+
+  /* the next sequence of the same device */
+  ClutterEventSequence *next;
+
+  /* the identifier of the touch point in the backend */
+  gint id;
+
+  /* the state of the touch point */
+  ClutterTouchInfo info;
+
+  ClutterActor *grab_actor;
+  gulong grab_destroy_id;
+
+  ClutterStage *drag_stage;
+  ClutterActor *drag_actor;
+
+  /* whether the backend queued the end of the sequence */
+  guint is_ended : 1;
+
+  /* whether info is tracked by the device */
+  guint has_info : 1;
+};
+
 struct _ClutterInputDevice
 {
   GObject parent_instance;
@@ -112,8 +150,14 @@ struct _ClutterInputDevice
   gint current_button_number;
   ClutterModifierType current_state;
 
-  /* the current touch points states */
+  /* the current touch points states, for the sequences not coming
+   * from the sequence table
+   */
   GHashTable *touch_sequences_info;
+  guint n_touch_sequences;
+
+  /* the sequences of the device allocated from the sequence table */
+  ClutterEventSequence *sequences;
 
   /* the previous state, used for click count generation */
   gint previous_x;
@@ -218,6 +262,14 @@ gboolean        _clutter_input_device_get_scroll_delta          (ClutterInputDev
                                                                  ClutterScrollDirection *direction_p,
                                                                  gdouble                *delta_p);
 
+/* event sequences */
+ClutterEventSequence *  _clutter_event_sequence_begin           (ClutterInputDevice   *device,
+                                                                 gint                  id);
+ClutterEventSequence *  _clutter_event_sequence_lookup          (ClutterInputDevice   *device,
+                                                                 gint                  id);
+void                    _clutter_event_sequence_end             (ClutterEventSequence *sequence);
+gboolean                _clutter_event_sequence_is_static       (const ClutterEventSequence *sequence);
+
 G_END_DECLS
 
 #endif /* __CLUTTER_DEVICE_MANAGER_PRIVATE_H__ */
@@ -8,9 +8,17 @@ G_BEGIN_DECLS
 void            _clutter_event_set_pointer_emulated     (ClutterEvent       *event,
                                                          gboolean            is_emulated);
 
+void            _clutter_event_set_time_usec            (ClutterEvent       *event,
+                                                         gint64              time_usec);
+gint64          _clutter_event_get_time_usec            (const ClutterEvent *event);
+
 /* Reinjecting queued events for processing */
 void            _clutter_process_event                  (ClutterEvent       *event);
 
+/* clutter_do_event(), optionally taking ownership of the event */
+void            _clutter_do_event                       (ClutterEvent       *event,
+                                                         gboolean            copy_event);
+
 /* clears the event queue inside the main context */
 void            _clutter_clear_events_queue             (void);
 void            _clutter_clear_events_queue_for_stage   (ClutterStage       *stage);
@@ -19,6 +27,9 @@ void            _clutter_event_set_platform_data        (ClutterEvent       *eve
                                                          gpointer            data);
 gpointer        _clutter_event_get_platform_data        (const ClutterEvent *event);
 
+void            _clutter_event_merge_coalesced_points   (ClutterEvent       *event,
+                                                         const ClutterEvent *older);
+
 void            _clutter_event_push                     (const ClutterEvent *event,
                                                          gboolean            do_copy);
 
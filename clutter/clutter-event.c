@@ -27,6 +27,8 @@
 #include "config.h"
 #endif
 
+#define CLUTTER_ENABLE_EXPERIMENTAL_API
+
 #include "clutter-backend-private.h"
 #include "clutter-debug.h"
 #include "clutter-event-private.h"
@@ -34,6 +36,7 @@
 #include "clutter-private.h"
 
 #include <math.h>
+#include <string.h>
 
 /**
  * SECTION:clutter-event
@@ -56,22 +59,95 @@ typedef struct _ClutterEventPrivate {
 
   gpointer platform_data;
 
+  /* the time of the event in microseconds, if known */
+  gint64 time_usec;
+
+  /* positions sampled since the previous motion event, oldest first */
+  ClutterEventPoint *coalesced_points;
+  guint n_coalesced_points;
+
+  /* link inside the free list of the event pool */
+  struct _ClutterEventPrivate *next_free;
+
   guint is_pointer_emulated : 1;
 } ClutterEventPrivate;
 
-static GHashTable *all_events = NULL;
+/* Events allocated by Clutter come from a pool of fixed size slabs;
+ * released events are kept in a free list and reused, so that input
+ * at high rates does not churn the allocator. Since the slabs are
+ * never released, we can tell whether an event was allocated by
+ * Clutter, and thus has the private fields, by checking whether it
+ * lives inside one of them.
+ */
+#define EVENT_POOL_SLAB_SIZE    64
+
+static ClutterEventPrivate **event_slabs = NULL;
+static guint n_event_slabs = 0;
+static ClutterEventPrivate *free_events = NULL;
 
 G_DEFINE_BOXED_TYPE (ClutterEvent, clutter_event,
                      clutter_event_copy,
                      clutter_event_free);
 
+static ClutterEventPrivate *
+clutter_event_pool_alloc (void)
+{
+  ClutterEventPrivate *real_event;
+
+  if (G_UNLIKELY (free_events == NULL))
+    {
+      ClutterEventPrivate *slab;
+      gint i;
+
+      slab = g_new (ClutterEventPrivate, EVENT_POOL_SLAB_SIZE);
+
+      for (i = EVENT_POOL_SLAB_SIZE - 1; i >= 0; i--)
+        {
+          slab[i].next_free = free_events;
+          free_events = &slab[i];
+        }
+
+      event_slabs = g_renew (ClutterEventPrivate *,
+                             event_slabs,
+                             n_event_slabs + 1);
+      event_slabs[n_event_slabs++] = slab;
+
+      CLUTTER_NOTE (EVENT, "Event pool grown to %u events",
+                    n_event_slabs * EVENT_POOL_SLAB_SIZE);
+    }
+
+  real_event = free_events;
+  free_events = real_event->next_free;
+
+  memset (real_event, 0, sizeof (ClutterEventPrivate));
+
+  return real_event;
+}
+
+static void
+clutter_event_pool_release (ClutterEventPrivate *real_event)
+{
+  real_event->next_free = free_events;
+  free_events = real_event;
+}
+
 static gboolean
 is_event_allocated (const ClutterEvent *event)
 {
-  if (all_events == NULL)
-    return FALSE;
+  guintptr addr = (guintptr) event;
+  guint i;
+
+  /* the most recent slabs are the most likely to be in use */
+  for (i = n_event_slabs; i > 0; i--)
+    {
+      guintptr start = (guintptr) event_slabs[i - 1];
+      guintptr end = start + sizeof (ClutterEventPrivate) * EVENT_POOL_SLAB_SIZE;
+
+      if (addr >= start && addr < end)
+        return ((addr - start) % sizeof (ClutterEventPrivate)) == 0;
+    }
 
-  return g_hash_table_lookup (all_events, event) != NULL;
+  return FALSE;
 }
 
 /*
@@ -122,6 +198,43 @@ _clutter_event_set_pointer_emulated (ClutterEvent *event,
   ((ClutterEventPrivate *) event)->is_pointer_emulated = !!is_emulated;
 }
 
+/*< private >
+ * _clutter_event_set_time_usec:
+ * @event: a #ClutterEvent
+ * @time_usec: the time of the event, in microseconds
+ *
+ * Sets the time of @event with a higher resolution than
+ * clutter_event_set_time(), for backends that have it.
+ */
+void
+_clutter_event_set_time_usec (ClutterEvent *event,
+                              gint64        time_usec)
+{
+  if (!is_event_allocated (event))
+    return;
+
+  ((ClutterEventPrivate *) event)->time_usec = time_usec;
+}
+
+/*< private >
+ * _clutter_event_get_time_usec:
+ * @event: a #ClutterEvent
+ *
+ * Retrieves the time of @event in microseconds; if the backend did
+ * not set it, the value is derived from clutter_event_get_time().
+ *
+ * Return value: the time of the event, in microseconds
+ */
+gint64
+_clutter_event_get_time_usec (const ClutterEvent *event)
+{
+  if (is_event_allocated (event) &&
+      ((ClutterEventPrivate *) event)->time_usec != 0)
+    return ((ClutterEventPrivate *) event)->time_usec;
+
+  return (gint64) clutter_event_get_time (event) * 1000;
+}
+
 /**
  * clutter_event_type:
  * @event: a #ClutterEvent
@@ -897,6 +1010,139 @@ clutter_event_get_event_sequence (const ClutterEvent *event)
   return NULL;
 }
 
+/**
+ * clutter_event_set_coalesced_points:
+ * @event: a #ClutterEvent of type %CLUTTER_MOTION or %CLUTTER_TOUCH_UPDATE
+ * @points: (array length=n_points) (allow-none): the sampled positions,
+ *   oldest first
+ * @n_points: the number of elements in @points
+ *
+ * Sets the positions sampled by the input device between the previous
+ * motion event and @event, without including the position of @event
+ * itself.
+ *
+ * Backends that receive input at a higher rate than they deliver events
+ * can use this function to avoid emitting a separate event for each
+ * sample. The @points are copied.
+ *
+ * This function only works on events allocated by Clutter.
+ *
+ * Since: 1.14
+ * Stability: unstable
+ */
+void
+clutter_event_set_coalesced_points (ClutterEvent            *event,
+                                    const ClutterEventPoint *points,
+                                    guint                    n_points)
+{
+  ClutterEventPrivate *real_event;
+
+  g_return_if_fail (event != NULL);
+  g_return_if_fail (points != NULL || n_points == 0);
+
+  if (!is_event_allocated (event))
+    return;
+
+  real_event = (ClutterEventPrivate *) event;
+
+  g_free (real_event->coalesced_points);
+
+  if (n_points > 0)
+    real_event->coalesced_points =
+      g_memdup (points, sizeof (ClutterEventPoint) * n_points);
+  else
+    real_event->coalesced_points = NULL;
+
+  real_event->n_coalesced_points = n_points;
+}
+
+/**
+ * clutter_event_get_coalesced_points:
+ * @event: a #ClutterEvent
+ * @n_points: (out): return location for the number of points
+ *
+ * Retrieves the positions sampled by the input device between the
+ * previous motion event and @event, oldest first. The position of
+ * @event itself is not included.
+ *
+ * Gesture recognizers can use the coalesced points to get an accurate
+ * estimate of the velocity of a pointer, even when Clutter compresses
+ * motion events or the windowing system delivers them in batches.
+ *
+ * Return value: (transfer none) (array length=n_points): the coalesced
+ *   points, or %NULL. The returned array is owned by @event
+ *
+ * Since: 1.14
+ * Stability: unstable
+ */
+const ClutterEventPoint *
+clutter_event_get_coalesced_points (const ClutterEvent *event,
+                                    guint              *n_points)
+{
+  ClutterEventPrivate *real_event;
+
+  g_return_val_if_fail (event != NULL, NULL);
+  g_return_val_if_fail (n_points != NULL, NULL);
+
+  if (!is_event_allocated (event))
+    {
+      *n_points = 0;
+      return NULL;
+    }
+
+  real_event = (ClutterEventPrivate *) event;
+
+  *n_points = real_event->n_coalesced_points;
+
+  return real_event->coalesced_points;
+}
+
+/*< private >
+ * _clutter_event_merge_coalesced_points:
+ * @event: a #ClutterEvent
+ * @older: the event that is being dropped in favour of @event
+ *
+ * Prepends the coalesced points of @older, followed by the position
+ * of @older itself, to the coalesced points of @event. This is used
+ * when compressing motion events, so that no sample is lost.
+ */
+void
+_clutter_event_merge_coalesced_points (ClutterEvent       *event,
+                                       const ClutterEvent *older)
+{
+  ClutterEventPrivate *real_event, *real_older;
+  ClutterEventPoint *points;
+  guint n_points;
+
+  if (!is_event_allocated (event) || !is_event_allocated (older))
+    return;
+
+  real_event = (ClutterEventPrivate *) event;
+  real_older = (ClutterEventPrivate *) older;
+
+  n_points = real_older->n_coalesced_points + 1
+           + real_event->n_coalesced_points;
+  points = g_new (ClutterEventPoint, n_points);
+
+  if (real_older->n_coalesced_points > 0)
+    memcpy (points, real_older->coalesced_points,
+            sizeof (ClutterEventPoint) * real_older->n_coalesced_points);
+
+  points[real_older->n_coalesced_points].time = clutter_event_get_time (older);
+  clutter_event_get_coords (older,
+                            &points[real_older->n_coalesced_points].x,
+                            &points[real_older->n_coalesced_points].y);
+
+  if (real_event->n_coalesced_points > 0)
+    memcpy (points + real_older->n_coalesced_points + 1,
+            real_event->coalesced_points,
+            sizeof (ClutterEventPoint) * real_event->n_coalesced_points);
+
+  g_free (real_event->coalesced_points);
+  real_event->coalesced_points = points;
+  real_event->n_coalesced_points = n_points;
+}
+
 /**
  * clutter_event_get_device_id:
  * @event: a clutter event 
@@ -1098,16 +1344,11 @@ clutter_event_new (ClutterEventType type)
   ClutterEvent *new_event;
   ClutterEventPrivate *priv;
 
-  priv = g_slice_new0 (ClutterEventPrivate);
+  priv = clutter_event_pool_alloc ();
 
   new_event = (ClutterEvent *) priv;
   new_event->type = new_event->any.type = type;
 
-  if (G_UNLIKELY (all_events == NULL))
-    all_events = g_hash_table_new (NULL, NULL);
-
-  g_hash_table_replace (all_events, priv, GUINT_TO_POINTER (1));
-
   return new_event;
 }
 
@@ -1143,6 +1384,15 @@ clutter_event_copy (const ClutterEvent *event)
       new_real_event->delta_x = real_event->delta_x;
       new_real_event->delta_y = real_event->delta_y;
       new_real_event->is_pointer_emulated = real_event->is_pointer_emulated;
+      new_real_event->time_usec = real_event->time_usec;
+
+      if (real_event->n_coalesced_points > 0)
+        {
+          new_real_event->coalesced_points =
+            g_memdup (real_event->coalesced_points,
+                      sizeof (ClutterEventPoint) * real_event->n_coalesced_points);
+          new_real_event->n_coalesced_points = real_event->n_coalesced_points;
+        }
     }
 
   device = clutter_event_get_device (event);
@@ -1230,8 +1480,10 @@ clutter_event_free (ClutterEvent *event)
           break;
         }
 
-      g_hash_table_remove (all_events, event);
-      g_slice_free (ClutterEventPrivate, (ClutterEventPrivate *) event);
+      if (is_event_allocated (event))
+        g_free (((ClutterEventPrivate *) event)->coalesced_points);
+
+      clutter_event_pool_release ((ClutterEventPrivate *) event);
     }
 }
 
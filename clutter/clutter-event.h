@@ -399,6 +399,27 @@ union _ClutterEvent
   ClutterTouchEvent touch;
 };
 
+#ifdef CLUTTER_ENABLE_EXPERIMENTAL_API
+/**
+ * ClutterEventPoint:
+ * @time: the time of the sample, in milliseconds
+ * @x: the X coordinate of the sample, relative to the stage
+ * @y: the Y coordinate of the sample, relative to the stage
+ *
+ * A position sampled by an input device between two motion or touch
+ * update events; see clutter_event_get_coalesced_points().
+ *
+ * Since: 1.14
+ * Stability: unstable
+ */
+typedef struct _ClutterEventPoint
+{
+  guint32 time;
+  gfloat x;
+  gfloat y;
+} ClutterEventPoint;
+#endif /* CLUTTER_ENABLE_EXPERIMENTAL_API */
+
 GType clutter_event_get_type (void) G_GNUC_CONST;
 
 gboolean                clutter_events_pending                  (void);
@@ -497,6 +518,16 @@ void                    clutter_event_get_scroll_delta          (const ClutterEv
 CLUTTER_AVAILABLE_IN_1_10
 ClutterEventSequence *  clutter_event_get_event_sequence        (const ClutterEvent     *event);
 
+#ifdef CLUTTER_ENABLE_EXPERIMENTAL_API
+CLUTTER_AVAILABLE_IN_1_14
+void                    clutter_event_set_coalesced_points      (ClutterEvent            *event,
+                                                                 const ClutterEventPoint *points,
+                                                                 guint                    n_points);
+CLUTTER_AVAILABLE_IN_1_14
+const ClutterEventPoint *clutter_event_get_coalesced_points     (const ClutterEvent      *event,
+                                                                 guint                   *n_points);
+#endif /* CLUTTER_ENABLE_EXPERIMENTAL_API */
+
 guint32                 clutter_keysym_to_unicode               (guint                   keyval);
 CLUTTER_AVAILABLE_IN_1_10
 guint                   clutter_unicode_to_keysym               (guint32                 wc);
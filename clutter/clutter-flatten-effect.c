@@ -32,6 +32,7 @@
 #endif
 
 #include "clutter-flatten-effect.h"
+#include "clutter-offscreen-effect-private.h"
 #include "clutter-private.h"
 #include "clutter-actor-private.h"
 
@@ -47,6 +48,9 @@ _clutter_flatten_effect_class_init (ClutterFlattenEffectClass *klass)
 static void
 _clutter_flatten_effect_init (ClutterFlattenEffect *self)
 {
+  /* the default paint_target() only paints the area used by the actor */
+  _clutter_offscreen_effect_set_round_target_size (CLUTTER_OFFSCREEN_EFFECT (self),
+                                                   TRUE);
 }
 
 ClutterEffect *
@@ -0,0 +1,352 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2013  Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * ClutterFrameScheduler:
+ *
+ * The frame scheduler of a stage records the presentation times of the
+ * frames, as reported by the stage window, and the time spent in each
+ * phase of the frames drawn by the master clock: processing events,
+ * advancing the timelines, relayouting and painting.
+ *
+ * From the presentation times and the refresh rate it predicts the time
+ * of the next vertical blank; from the cost of the last frames it predicts
+ * the cost of the next one. The next frame can then be started as late as
+ * possible while still being presented at the next vertical blank, which
+ * reduces the latency between the input events and their presentation.
+ *
+ * Each presented frame is given a deadline, the vertical blank it was
+ * meant for; frames that are presented after their deadline are counted
+ * as missed.
+ *
+ * All the times are in microseconds, in the g_get_monotonic_time() time
+ * base, and are passed explicitly, so that the scheduler can be driven
+ * by synthetic frame events.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include "clutter-frame-scheduler.h"
+
+/* the number of frames used to predict the cost of the next frame */
+#define N_FRAME_COSTS           16
+
+/* the number of presented frames waiting for their presentation time */
+#define MAX_PENDING_FRAMES      4
+
+/* the time to keep between the end of a frame and the vertical blank,
+ * to account for the time the GPU needs to finish rendering the frame
+ */
+#define FRAME_MARGIN            1000
+
+/* we only extrapolate presentation times for 150ms, like the Cogl
+ * stage window; see clutter_stage_cogl_schedule_update()
+ */
+#define MAX_EXTRAPOLATION       150000
+
+#define DEFAULT_REFRESH_INTERVAL        16667   /* 1/60th second */
+
+struct _ClutterFrameScheduler
+{
+  /* the presentation clock */
+  gint64 last_presentation_time;
+  gint64 refresh_interval;
+
+  /* the frame being drawn */
+  gint64 frame_start;
+  gint64 frame_deadline;
+  gint64 frame_phase_costs[CLUTTER_FRAME_N_PHASES];
+
+  /* the cost of the last frames, as a ring buffer */
+  gint64 frame_costs[N_FRAME_COSTS];
+  guint n_frame_costs;
+  guint next_frame_cost;
+
+  /* running average of the cost of each phase */
+  gint64 phase_costs[CLUTTER_FRAME_N_PHASES];
+
+  /* the deadlines of the frames waiting to be presented, oldest first */
+  gint64 pending_deadlines[MAX_PENDING_FRAMES];
+  guint n_pending_deadlines;
+
+  guint n_missed_deadlines;
+};
+
+ClutterFrameScheduler *
+_clutter_frame_scheduler_new (void)
+{
+  ClutterFrameScheduler *scheduler;
+
+  scheduler = g_slice_new0 (ClutterFrameScheduler);
+  scheduler->refresh_interval = DEFAULT_REFRESH_INTERVAL;
+  scheduler->frame_start = -1;
+
+  return scheduler;
+}
+
+void
+_clutter_frame_scheduler_free (ClutterFrameScheduler *scheduler)
+{
+  if (scheduler == NULL)
+    return;
+
+  g_slice_free (ClutterFrameScheduler, scheduler);
+}
+
+/*
+ * _clutter_frame_scheduler_get_next_presentation_time:
+ * @scheduler: a #ClutterFrameScheduler
+ * @time_: a time, in microseconds
+ *
+ * Predicts the first vertical blank after @time_.
+ *
+ * Return value: the predicted presentation time, or -1 if there is no
+ *   recent presentation time to extrapolate from
+ */
+gint64
+_clutter_frame_scheduler_get_next_presentation_time (ClutterFrameScheduler *scheduler,
+                                                     gint64                 time_)
+{
+  gint64 last = scheduler->last_presentation_time;
+  gint64 interval = scheduler->refresh_interval;
+
+  if (last == 0 || last < time_ - MAX_EXTRAPOLATION)
+    return -1;
+
+  if (last > time_)
+    return last;
+
+  return last + ((time_ - last) / interval + 1) * interval;
+}
+
+gint64
+_clutter_frame_scheduler_get_refresh_interval (ClutterFrameScheduler *scheduler)
+{
+  return scheduler->refresh_interval;
+}
+
+/*
+ * _clutter_frame_scheduler_get_predicted_cost:
+ * @scheduler: a #ClutterFrameScheduler
+ *
+ * Predicts the time between the start of the next frame and the time
+ * it is ready to be presented, including a safety margin.
+ *
+ * We use the most expensive of the last frames, since underestimating
+ * the cost of a frame makes it miss the vertical blank, while
+ * overestimating it only adds some latency.
+ *
+ * Return value: the predicted cost of the next frame, in microseconds
+ */
+gint64
+_clutter_frame_scheduler_get_predicted_cost (ClutterFrameScheduler *scheduler)
+{
+  gint64 max_cost = 0;
+  guint i;
+
+  /* without any history, assume the frame takes a full refresh cycle */
+  if (scheduler->n_frame_costs == 0)
+    return scheduler->refresh_interval;
+
+  for (i = 0; i < scheduler->n_frame_costs; i++)
+    max_cost = MAX (max_cost, scheduler->frame_costs[i]);
+
+  return max_cost + FRAME_MARGIN;
+}
+
+gint64
+_clutter_frame_scheduler_get_phase_cost (ClutterFrameScheduler *scheduler,
+                                         ClutterFramePhase      phase)
+{
+  g_return_val_if_fail (phase < CLUTTER_FRAME_N_PHASES, 0);
+
+  return scheduler->phase_costs[phase];
+}
+
+/*
+ * _clutter_frame_scheduler_get_sync_delay:
+ * @scheduler: a #ClutterFrameScheduler
+ * @now: the current time, in microseconds
+ *
+ * Computes the number of milliseconds to wait after a vertical blank
+ * before starting a frame, so that the frame is ready just in time for
+ * the next vertical blank.
+ *
+ * Return value: the delay, in milliseconds, or -1 if the frames should
+ *   be started as soon as possible
+ */
+gint
+_clutter_frame_scheduler_get_sync_delay (ClutterFrameScheduler *scheduler,
+                                         gint64                 now)
+{
+  gint64 delay;
+
+  if (_clutter_frame_scheduler_get_next_presentation_time (scheduler, now) < 0)
+    return -1;
+
+  delay = scheduler->refresh_interval
+        - _clutter_frame_scheduler_get_predicted_cost (scheduler);
+
+  if (delay <= 0)
+    return 0;
+
+  /* round down, to stay on the safe side of the deadline */
+  return (gint) (delay / 1000);
+}
+
+void
+_clutter_frame_scheduler_begin_frame (ClutterFrameScheduler *scheduler,
+                                      gint64                 frame_time)
+{
+  gint64 ready_time;
+
+  scheduler->frame_start = frame_time;
+  memset (scheduler->frame_phase_costs, 0, sizeof (scheduler->frame_phase_costs));
+
+  /* the frame is meant for the first vertical blank after the time it
+   * is predicted to be ready
+   */
+  ready_time = frame_time + _clutter_frame_scheduler_get_predicted_cost (scheduler);
+  scheduler->frame_deadline =
+    _clutter_frame_scheduler_get_next_presentation_time (scheduler, ready_time);
+}
+
+void
+_clutter_frame_scheduler_add_phase_cost (ClutterFrameScheduler *scheduler,
+                                         ClutterFramePhase      phase,
+                                         gint64                 cost)
+{
+  g_return_if_fail (phase < CLUTTER_FRAME_N_PHASES);
+
+  if (scheduler->frame_start < 0)
+    return;
+
+  scheduler->frame_phase_costs[phase] += cost;
+}
+
+/*
+ * _clutter_frame_scheduler_end_frame:
+ * @scheduler: a #ClutterFrameScheduler
+ * @end_time: the time the frame was finished
+ * @presented: whether the frame was submitted for presentation
+ *
+ * Records the cost of the frame started by the last call to
+ * _clutter_frame_scheduler_begin_frame(); if the frame was submitted
+ * for presentation, its deadline is queued until the presentation
+ * time is known.
+ */
+void
+_clutter_frame_scheduler_end_frame (ClutterFrameScheduler *scheduler,
+                                    gint64                 end_time,
+                                    gboolean               presented)
+{
+  guint i;
+
+  if (scheduler->frame_start < 0)
+    return;
+
+  for (i = 0; i < CLUTTER_FRAME_N_PHASES; i++)
+    {
+      scheduler->phase_costs[i] = (scheduler->phase_costs[i] * 7
+                                   + scheduler->frame_phase_costs[i]) / 8;
+    }
+
+  /* frames that did not paint anything are not representative */
+  if (presented)
+    {
+      scheduler->frame_costs[scheduler->next_frame_cost] =
+        MAX (end_time - scheduler->frame_start, 0);
+      scheduler->next_frame_cost = (scheduler->next_frame_cost + 1) % N_FRAME_COSTS;
+      scheduler->n_frame_costs = MIN (scheduler->n_frame_costs + 1, N_FRAME_COSTS);
+
+      /* drop the oldest deadline if the stage window does not report
+       * the presentation times
+       */
+      if (scheduler->n_pending_deadlines == MAX_PENDING_FRAMES)
+        {
+          memmove (scheduler->pending_deadlines,
+                   scheduler->pending_deadlines + 1,
+                   (MAX_PENDING_FRAMES - 1) * sizeof (gint64));
+          scheduler->n_pending_deadlines -= 1;
+        }
+
+      scheduler->pending_deadlines[scheduler->n_pending_deadlines++] =
+        scheduler->frame_deadline;
+    }
+
+  scheduler->frame_start = -1;
+}
+
+/*
+ * _clutter_frame_scheduler_presented:
+ * @scheduler: a #ClutterFrameScheduler
+ * @presentation_time: the time the oldest pending frame was presented
+ * @refresh_rate: the refresh rate of the output, or 0 if unknown
+ *
+ * Records the presentation of a frame.
+ *
+ * Return value: %TRUE if the frame missed its deadline
+ */
+gboolean
+_clutter_frame_scheduler_presented (ClutterFrameScheduler *scheduler,
+                                    gint64                 presentation_time,
+                                    float                  refresh_rate)
+{
+  gboolean missed = FALSE;
+
+  if (refresh_rate > 0.0)
+    scheduler->refresh_interval = (gint64) (0.5 + 1000000 / refresh_rate);
+
+  if (scheduler->refresh_interval <= 0)
+    scheduler->refresh_interval = DEFAULT_REFRESH_INTERVAL;
+
+  if (scheduler->n_pending_deadlines > 0)
+    {
+      gint64 deadline = scheduler->pending_deadlines[0];
+
+      scheduler->n_pending_deadlines -= 1;
+      memmove (scheduler->pending_deadlines,
+               scheduler->pending_deadlines + 1,
+               scheduler->n_pending_deadlines * sizeof (gint64));
+
+      /* allow for some jitter in the presentation times */
+      if (deadline >= 0 &&
+          presentation_time > deadline + scheduler->refresh_interval / 2)
+        {
+          scheduler->n_missed_deadlines += 1;
+          missed = TRUE;
+        }
+    }
+
+  scheduler->last_presentation_time = presentation_time;
+
+  return missed;
+}
+
+guint
+_clutter_frame_scheduler_get_n_missed_deadlines (ClutterFrameScheduler *scheduler)
+{
+  return scheduler->n_missed_deadlines;
+}
@@ -0,0 +1,69 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2013  Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * ClutterFrameScheduler: frame deadline prediction from presentation times.
+ */
+
+#ifndef __CLUTTER_FRAME_SCHEDULER_H__
+#define __CLUTTER_FRAME_SCHEDULER_H__
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+typedef struct _ClutterFrameScheduler   ClutterFrameScheduler;
+
+typedef enum {
+  CLUTTER_FRAME_PHASE_EVENTS,
+  CLUTTER_FRAME_PHASE_TIMELINES,
+  CLUTTER_FRAME_PHASE_LAYOUT,
+  CLUTTER_FRAME_PHASE_PAINT,
+
+  CLUTTER_FRAME_N_PHASES
+} ClutterFramePhase;
+
+ClutterFrameScheduler * _clutter_frame_scheduler_new                            (void);
+void                    _clutter_frame_scheduler_free                           (ClutterFrameScheduler *scheduler);
+
+void                    _clutter_frame_scheduler_begin_frame                    (ClutterFrameScheduler *scheduler,
+                                                                                 gint64                 frame_time);
+void                    _clutter_frame_scheduler_add_phase_cost                 (ClutterFrameScheduler *scheduler,
+                                                                                 ClutterFramePhase      phase,
+                                                                                 gint64                 cost);
+void                    _clutter_frame_scheduler_end_frame                      (ClutterFrameScheduler *scheduler,
+                                                                                 gint64                 end_time,
+                                                                                 gboolean               presented);
+gboolean                _clutter_frame_scheduler_presented                      (ClutterFrameScheduler *scheduler,
+                                                                                 gint64                 presentation_time,
+                                                                                 float                  refresh_rate);
+
+gint64                  _clutter_frame_scheduler_get_refresh_interval           (ClutterFrameScheduler *scheduler);
+gint64                  _clutter_frame_scheduler_get_predicted_cost             (ClutterFrameScheduler *scheduler);
+gint64                  _clutter_frame_scheduler_get_phase_cost                 (ClutterFrameScheduler *scheduler,
+                                                                                 ClutterFramePhase      phase);
+gint64                  _clutter_frame_scheduler_get_next_presentation_time     (ClutterFrameScheduler *scheduler,
+                                                                                 gint64                 time_);
+gint                    _clutter_frame_scheduler_get_sync_delay                 (ClutterFrameScheduler *scheduler,
+                                                                                 gint64                 now);
+guint                   _clutter_frame_scheduler_get_n_missed_deadlines         (ClutterFrameScheduler *scheduler);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_FRAME_SCHEDULER_H__ */
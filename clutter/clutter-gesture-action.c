@@ -87,6 +87,8 @@
 #include "config.h"
 #endif
 
+#define CLUTTER_ENABLE_EXPERIMENTAL_API
+
 #include "clutter-gesture-action-private.h"
 
 #include "clutter-debug.h"
@@ -99,6 +101,18 @@
 #define MAX_GESTURE_POINTS (10)
 #define FLOAT_EPSILON   (1e-15)
 
+/* the number of positions kept to estimate the velocity of a point,
+ * and the time window, in milliseconds, used for the estimate
+ */
+#define N_VELOCITY_SAMPLES      (16)
+#define VELOCITY_WINDOW         (32)
+
+typedef struct
+{
+  gint64 time;
+  gfloat x, y;
+} GestureSample;
+
 typedef struct
 {
   ClutterInputDevice *device;
@@ -108,9 +122,13 @@ typedef struct
   gfloat press_x, press_y;
   gint64 last_motion_time;
   gfloat last_motion_x, last_motion_y;
-  gint64 last_delta_time;
   gfloat last_delta_x, last_delta_y;
   gfloat release_x, release_y;
+
+  /* ring buffer of the latest positions, including the coalesced ones */
+  GestureSample samples[N_VELOCITY_SAMPLES];
+  guint first_sample;
+  guint n_samples;
 } GesturePoint;
 
 struct _ClutterGestureActionPrivate
@@ -142,6 +160,60 @@ static guint gesture_signals[LAST_SIGNAL] = { 0, };
 
 G_DEFINE_TYPE (ClutterGestureAction, clutter_gesture_action, CLUTTER_TYPE_ACTION);
 
+static void
+gesture_point_add_sample (GesturePoint *point,
+                          gint64        time,
+                          gfloat        x,
+                          gfloat        y)
+{
+  GestureSample *sample;
+
+  if (point->n_samples < N_VELOCITY_SAMPLES)
+    {
+      sample = &point->samples[(point->first_sample + point->n_samples)
+                               % N_VELOCITY_SAMPLES];
+      point->n_samples += 1;
+    }
+  else
+    {
+      sample = &point->samples[point->first_sample];
+      point->first_sample = (point->first_sample + 1) % N_VELOCITY_SAMPLES;
+    }
+
+  sample->time = time;
+  sample->x = x;
+  sample->y = y;
+}
+
+/* adds the positions sampled since the previous event, and the
+ * position of @event itself
+ */
+static void
+gesture_point_add_event_samples (GesturePoint       *point,
+                                 const ClutterEvent *event)
+{
+  const ClutterEventPoint *coalesced;
+  guint i, n_coalesced;
+  gfloat x, y;
+
+  coalesced = clutter_event_get_coalesced_points (event, &n_coalesced);
+  for (i = 0; i < n_coalesced; i++)
+    gesture_point_add_sample (point,
+                              coalesced[i].time,
+                              coalesced[i].x,
+                              coalesced[i].y);
+
+  clutter_event_get_coords (event, &x, &y);
+  gesture_point_add_sample (point, clutter_event_get_time (event), x, y);
+}
+
+static inline const GestureSample *
+gesture_point_get_sample (const GesturePoint *point,
+                          guint               index_)
+{
+  return &point->samples[(point->first_sample + index_) % N_VELOCITY_SAMPLES];
+}
+
 static GesturePoint *
 gesture_register_point (ClutterGestureAction *action, ClutterEvent *event)
 {
@@ -163,7 +235,13 @@ gesture_register_point (ClutterGestureAction *action, ClutterEvent *event)
   point->last_motion_time = clutter_event_get_time (event);
 
   point->last_delta_x = point->last_delta_y = 0;
-  point->last_delta_time = 0;
+
+  point->first_sample = 0;
+  point->n_samples = 0;
+  gesture_point_add_sample (point,
+                            point->last_motion_time,
+                            point->press_x,
+                            point->press_y);
 
   if (clutter_event_type (event) != CLUTTER_BUTTON_PRESS)
     point->sequence = clutter_event_get_event_sequence (event);
@@ -291,7 +369,6 @@ stage_captured_event_cb (ClutterActor       *stage,
   gboolean return_value;
   GesturePoint *point;
   gfloat motion_x, motion_y;
-  gint64 time;
 
   if ((point = gesture_find_point (action, event, &position)) == NULL)
     return CLUTTER_EVENT_PROPAGATE;
@@ -347,9 +424,9 @@ stage_captured_event_cb (ClutterActor       *stage,
       point->last_motion_x = motion_x;
       point->last_motion_y = motion_y;
 
-      time = clutter_event_get_time (event);
-      point->last_delta_time = time - point->last_motion_time;
-      point->last_motion_time = time;
+      point->last_motion_time = clutter_event_get_time (event);
+
+      gesture_point_add_event_samples (point, event);
 
       g_signal_emit (action, gesture_signals[GESTURE_PROGRESS], 0, actor,
                      &return_value);
@@ -384,8 +461,7 @@ stage_captured_event_cb (ClutterActor       *stage,
             /* Treat the release event as the continuation of the last motion,
              * in case the user keeps the pointer still for a while before
              * releasing it. */
-            time = clutter_event_get_time (event);
-            point->last_delta_time += time - point->last_motion_time;
+            gesture_point_add_event_samples (point, event);
 
             priv->in_gesture = FALSE;
             g_signal_emit (action, gesture_signals[GESTURE_END], 0, actor);
@@ -815,6 +891,11 @@ clutter_gesture_action_get_release_coords (ClutterGestureAction *action,
  * Retrieves the velocity, in stage pixels per millisecond, of the
  * latest motion event during the dragging.
  *
+ * The velocity is estimated over the positions received during the
+ * last few milliseconds, including the coalesced points of the motion
+ * events (see clutter_event_get_coalesced_points()), so that it is
+ * not affected by the compression of motion events.
+ *
  * Since: 1.12
  */
 gfloat
@@ -823,18 +904,46 @@ clutter_gesture_action_get_velocity (ClutterGestureAction *action,
                                      gfloat               *velocity_x,
                                      gfloat               *velocity_y)
 {
+  const GesturePoint *gesture_point;
+  const GestureSample *first, *last;
   gfloat d_x, d_y, distance, velocity;
   gint64 d_t;
+  guint i;
 
   g_return_val_if_fail (CLUTTER_IS_GESTURE_ACTION (action), 0);
   g_return_val_if_fail (action->priv->points->len > point, 0);
 
-  distance = clutter_gesture_action_get_motion_delta (action, point,
-                                                      &d_x, &d_y);
+  gesture_point = &g_array_index (action->priv->points, GesturePoint, point);
 
-  d_t = g_array_index (action->priv->points,
-                       GesturePoint,
-                       point).last_delta_time;
+  d_x = d_y = 0;
+  d_t = 0;
+
+  if (gesture_point->n_samples > 1)
+    {
+      last = gesture_point_get_sample (gesture_point,
+                                       gesture_point->n_samples - 1);
+
+      /* find the oldest sample inside the window; if the latest
+       * sample is the only one, use the one preceding it, e.g. when
+       * the pointer was kept still before being released
+       */
+      i = gesture_point->n_samples - 1;
+      while (i > 0 &&
+             last->time - gesture_point_get_sample (gesture_point, i - 1)->time
+               <= VELOCITY_WINDOW)
+        i--;
+
+      if (i == gesture_point->n_samples - 1)
+        i--;
+
+      first = gesture_point_get_sample (gesture_point, i);
+
+      d_x = last->x - first->x;
+      d_y = last->y - first->y;
+      d_t = last->time - first->time;
+    }
+
+  distance = sqrtf ((d_x * d_x) + (d_y * d_y));
 
   if (velocity_x)
     *velocity_x = d_t > FLOAT_EPSILON ? d_x / d_t : 0;
@@ -46,6 +46,8 @@
 #include "clutter-private.h"
 #include "clutter-stage-private.h"
 
+#include <string.h>
+
 enum
 {
   PROP_0,
@@ -68,6 +70,13 @@ enum
 };
 
 static void _clutter_input_device_free_touch_info (gpointer data);
+static void _clutter_input_device_remove_touch_info (ClutterInputDevice   *device,
+                                                     ClutterEventSequence *sequence);
+static void clutter_event_sequence_release (ClutterEventSequence *sequence);
+
+/* the sequence table; slots past n_event_sequences have never been used */
+static ClutterEventSequence event_sequences[CLUTTER_MAX_EVENT_SEQUENCES];
+static guint n_event_sequences = 0;
 
 
 static GParamSpec *obj_props[PROP_LAST] = { NULL, };
@@ -105,6 +114,19 @@ clutter_input_device_dispose (GObject *gobject)
 
   if (device->touch_sequences_info)
     {
+      guint i;
+
+      for (i = 0; i < n_event_sequences; i++)
+        {
+          ClutterEventSequence *sequence = &event_sequences[i];
+
+          if (sequence->device != device)
+            continue;
+
+          _clutter_input_device_remove_touch_info (device, sequence);
+          clutter_event_sequence_release (sequence);
+        }
+
       g_hash_table_unref (device->touch_sequences_info);
       device->touch_sequences_info = NULL;
     }
@@ -394,6 +416,16 @@ clutter_input_device_init (ClutterInputDevice *self)
   self->inv_touch_sequence_actors = g_hash_table_new (NULL, NULL);
 }
 
+static inline ClutterTouchInfo *
+_clutter_input_device_lookup_touch_info (ClutterInputDevice   *device,
+                                         ClutterEventSequence *sequence)
+{
+  if (_clutter_event_sequence_is_static (sequence))
+    return sequence->has_info ? &sequence->info : NULL;
+
+  return g_hash_table_lookup (device->touch_sequences_info, sequence);
+}
+
 static ClutterTouchInfo *
 _clutter_input_device_ensure_touch_info (ClutterInputDevice *device,
                                          ClutterEventSequence *sequence,
@@ -401,15 +433,26 @@ _clutter_input_device_ensure_touch_info (ClutterInputDevice *device,
 {
   ClutterTouchInfo *info;
 
-  info = g_hash_table_lookup (device->touch_sequences_info, sequence);
+  info = _clutter_input_device_lookup_touch_info (device, sequence);
 
   if (info == NULL)
     {
-      info = g_slice_new0 (ClutterTouchInfo);
+      if (_clutter_event_sequence_is_static (sequence))
+        {
+          info = &sequence->info;
+          memset (info, 0, sizeof (ClutterTouchInfo));
+          sequence->has_info = TRUE;
+        }
+      else
+        {
+          info = g_slice_new0 (ClutterTouchInfo);
+          g_hash_table_insert (device->touch_sequences_info, sequence, info);
+        }
+
       info->sequence = sequence;
-      g_hash_table_insert (device->touch_sequences_info, sequence, info);
 
-      if (g_hash_table_size (device->touch_sequences_info) == 1)
+      device->n_touch_sequences += 1;
+      if (device->n_touch_sequences == 1)
         _clutter_input_device_set_stage (device, stage);
     }
 
@@ -536,7 +579,9 @@ _clutter_input_device_get_actor (ClutterInputDevice   *device,
   if (sequence == NULL)
     return device->cursor_actor;
 
-  info = g_hash_table_lookup (device->touch_sequences_info, sequence);
+  info = _clutter_input_device_lookup_touch_info (device, sequence);
+  if (info == NULL)
+    return NULL;
 
   return info->actor;
 }
@@ -587,7 +632,7 @@ _clutter_input_device_unassociate_actor (ClutterInputDevice   *device,
       for (l = sequences; l != NULL; l = l->next)
         {
           ClutterTouchInfo *info =
-            g_hash_table_lookup (device->touch_sequences_info, l->data);
+            _clutter_input_device_lookup_touch_info (device, l->data);
 
           if (info)
             info->actor = NULL;
@@ -824,7 +869,7 @@ clutter_input_device_get_coords (ClutterInputDevice   *device,
   else
     {
       ClutterTouchInfo *info =
-        g_hash_table_lookup (device->touch_sequences_info, sequence);
+        _clutter_input_device_lookup_touch_info (device, sequence);
 
       if (info == NULL)
         return FALSE;
@@ -1505,9 +1550,26 @@ _clutter_input_device_remove_event_sequence (ClutterInputDevice *device,
                                              ClutterEvent       *event)
 {
   ClutterEventSequence *sequence = clutter_event_get_event_sequence (event);
-  ClutterTouchInfo *info =
-    g_hash_table_lookup (device->touch_sequences_info, sequence);
 
+  if (sequence == NULL)
+    return;
+
+  _clutter_input_device_remove_touch_info (device, sequence);
+
+  /* the END or CANCEL event of a sequence coming from the sequence
+   * table is the last event referencing it, so its slot can be reused
+   */
+  if (_clutter_event_sequence_is_static (sequence) && sequence->is_ended)
+    clutter_event_sequence_release (sequence);
+}
+
+static void
+_clutter_input_device_remove_touch_info (ClutterInputDevice   *device,
+                                         ClutterEventSequence *sequence)
+{
+  ClutterTouchInfo *info;
+
+  info = _clutter_input_device_lookup_touch_info (device, sequence);
   if (info == NULL)
     return;
 
@@ -1522,12 +1584,175 @@ _clutter_input_device_remove_event_sequence (ClutterInputDevice *device,
                             info->actor, sequences);
     }
 
-  g_hash_table_remove (device->touch_sequences_info, sequence);
+  if (_clutter_event_sequence_is_static (sequence))
+    sequence->has_info = FALSE;
+  else
+    g_hash_table_remove (device->touch_sequences_info, sequence);
 
-  if (g_hash_table_size (device->touch_sequences_info) == 0)
+  device->n_touch_sequences -= 1;
+  if (device->n_touch_sequences == 0)
     _clutter_input_device_set_stage (device, NULL);
 }
 
+/*< private >
+ * _clutter_event_sequence_is_static:
+ * @sequence: a #ClutterEventSequence, or %NULL
+ *
+ * Checks whether @sequence has been allocated from the sequence table
+ * using _clutter_event_sequence_begin(), and can thus be dereferenced.
+ *
+ * Return value: %TRUE if @sequence comes from the sequence table
+ */
+gboolean
+_clutter_event_sequence_is_static (const ClutterEventSequence *sequence)
+{
+  guintptr addr = (guintptr) sequence;
+  guintptr start = (guintptr) event_sequences;
+  guintptr end = (guintptr) (event_sequences + n_event_sequences);
+
+  return addr >= start && addr < end;
+}
+
+static void
+clutter_event_sequence_release (ClutterEventSequence *sequence)
+{
+  if (sequence->device != NULL)
+    {
+      ClutterEventSequence **link_p = &sequence->device->sequences;
+
+      while (*link_p != sequence)
+        link_p = &(*link_p)->next;
+
+      *link_p = sequence->next;
+    }
+
+  if (sequence->grab_actor != NULL)
+    g_signal_handler_disconnect (sequence->grab_actor,
+                                 sequence->grab_destroy_id);
+
+  memset (sequence, 0, sizeof (ClutterEventSequence));
+}
+
+/*< private >
+ * _clutter_event_sequence_begin:
+ * @device: the #ClutterInputDevice of the touch point
+ * @id: the identifier of the touch point in the backend
+ *
+ * Allocates a sequence from the sequence table for a new touch point
+ * of @device. The sequence remains valid until the backend calls
+ * _clutter_event_sequence_end() and the END or CANCEL event of the
+ * sequence has been processed.
+ *
+ * Return value: the new sequence, or %NULL if too many touch points
+ *   are in use
+ */
+ClutterEventSequence *
+_clutter_event_sequence_begin (ClutterInputDevice *device,
+                               gint                id)
+{
+  ClutterEventSequence *sequence = NULL;
+  ClutterEventSequence *ended = NULL;
+  guint i;
+
+  g_return_val_if_fail (CLUTTER_IS_INPUT_DEVICE (device), NULL);
+
+  /* in case we missed the end of the previous touch point */
+  sequence = _clutter_event_sequence_lookup (device, id);
+  if (sequence != NULL)
+    {
+      CLUTTER_NOTE (EVENT, "Restarting touch sequence %d of device '%s'",
+                    id,
+                    device->device_name);
+      return sequence;
+    }
+
+  for (i = 0; i < n_event_sequences; i++)
+    {
+      if (event_sequences[i].device == NULL)
+        {
+          sequence = &event_sequences[i];
+          break;
+        }
+
+      if (ended == NULL && event_sequences[i].is_ended)
+        ended = &event_sequences[i];
+    }
+
+  if (sequence == NULL && n_event_sequences < CLUTTER_MAX_EVENT_SEQUENCES)
+    sequence = &event_sequences[n_event_sequences++];
+
+  /* the END event of an ended sequence has been lost, e.g. because
+   * the event queue of its stage has been cleared
+   */
+  if (sequence == NULL && ended != NULL)
+    {
+      _clutter_input_device_remove_touch_info (ended->device, ended);
+      clutter_event_sequence_release (ended);
+
+      sequence = ended;
+    }
+
+  if (sequence == NULL)
+    {
+      g_warning ("Too many touch points in use, ignoring touch point %d "
+                 "of device '%s'",
+                 id,
+                 device->device_name);
+      return NULL;
+    }
+
+  memset (sequence, 0, sizeof (ClutterEventSequence));
+  sequence->device = device;
+  sequence->id = id;
+
+  sequence->next = device->sequences;
+  device->sequences = sequence;
+
+  return sequence;
+}
+
+/*< private >
+ * _clutter_event_sequence_lookup:
+ * @device: a #ClutterInputDevice
+ * @id: the identifier of the touch point in the backend
+ *
+ * Retrieves the sequence of a touch point of @device that has not
+ * ended yet.
+ *
+ * Return value: the sequence, or %NULL
+ */
+ClutterEventSequence *
+_clutter_event_sequence_lookup (ClutterInputDevice *device,
+                                gint                id)
+{
+  ClutterEventSequence *sequence;
+
+  /* only the few sequences of the device are checked */
+  for (sequence = device->sequences; sequence != NULL; sequence = sequence->next)
+    {
+      if (sequence->id == id && !sequence->is_ended)
+        return sequence;
+    }
+
+  return NULL;
+}
+
+/*< private >
+ * _clutter_event_sequence_end:
+ * @sequence: a #ClutterEventSequence from the sequence table
+ *
+ * Marks the end of a touch point; backends should call this function
+ * when queueing the END or CANCEL event of @sequence. Further lookups
+ * of the touch point will fail.
+ */
+void
+_clutter_event_sequence_end (ClutterEventSequence *sequence)
+{
+  g_return_if_fail (_clutter_event_sequence_is_static (sequence));
+
+  sequence->is_ended = TRUE;
+}
+
 /**
  * clutter_input_device_get_slave_devices:
  * @device: a #ClutterInputDevice
@@ -1767,6 +1992,14 @@ _clutter_input_device_reset_scroll_info (ClutterInputDevice *device)
     }
 }
 
+static void
+on_grab_static_sequence_actor_destroy (ClutterActor         *actor,
+                                       ClutterEventSequence *sequence)
+{
+  sequence->grab_actor = NULL;
+  sequence->grab_destroy_id = 0;
+}
+
 static void
 on_grab_sequence_actor_destroy (ClutterActor       *actor,
                                 ClutterInputDevice *device)
@@ -1810,6 +2043,20 @@ clutter_input_device_sequence_grab (ClutterInputDevice   *device,
   g_return_if_fail (CLUTTER_IS_INPUT_DEVICE (device));
   g_return_if_fail (CLUTTER_IS_ACTOR (actor));
 
+  if (_clutter_event_sequence_is_static (sequence))
+    {
+      if (sequence->grab_actor != NULL)
+        g_signal_handler_disconnect (sequence->grab_actor,
+                                     sequence->grab_destroy_id);
+
+      sequence->grab_actor = actor;
+      sequence->grab_destroy_id =
+        g_signal_connect (actor, "destroy",
+                          G_CALLBACK (on_grab_static_sequence_actor_destroy),
+                          sequence);
+      return;
+    }
+
   if (device->sequence_grab_actors == NULL)
     {
       grab_actor = NULL;
@@ -1856,6 +2103,19 @@ clutter_input_device_sequence_ungrab (ClutterInputDevice   *device,
 
   g_return_if_fail (CLUTTER_IS_INPUT_DEVICE (device));
 
+  if (_clutter_event_sequence_is_static (sequence))
+    {
+      if (sequence->grab_actor != NULL)
+        {
+          g_signal_handler_disconnect (sequence->grab_actor,
+                                       sequence->grab_destroy_id);
+          sequence->grab_actor = NULL;
+          sequence->grab_destroy_id = 0;
+        }
+
+      return;
+    }
+
   if (device->sequence_grab_actors == NULL)
     return;
 
@@ -1897,6 +2157,9 @@ clutter_input_device_sequence_get_grabbed_actor (ClutterInputDevice   *device,
 {
   g_return_val_if_fail (CLUTTER_IS_INPUT_DEVICE (device), NULL);
 
+  if (_clutter_event_sequence_is_static (sequence))
+    return sequence->grab_actor;
+
   if (device->sequence_grab_actors == NULL)
     return NULL;
 
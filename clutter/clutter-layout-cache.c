@@ -0,0 +1,454 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2013  Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * ClutterLayoutCache:
+ *
+ * The layout cache keeps the #PangoLayout<!-- -->s shaped by #ClutterText,
+ * so that actors showing the same text with the same attributes and
+ * size, like the rows of a list being recycled, share a single layout
+ * instead of shaping the same string over and over.
+ *
+ * The cache is bounded by an estimate of the memory used by the layouts;
+ * when it grows over %CLUTTER_LAYOUT_CACHE_MAX_SIZE the least recently
+ * used layouts are dropped. The actors using a layout hold a reference
+ * on it, so evicting a layout never invalidates it.
+ *
+ * The layouts are created from the default Clutter #PangoContext, so
+ * the cache is cleared whenever the resolution or the font options of
+ * the backend change.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include "clutter-layout-cache.h"
+
+#include "clutter-backend.h"
+#include "clutter-debug.h"
+#include "clutter-main.h"
+#include "clutter-private.h"
+#include "clutter-profile.h"
+
+/* the estimated memory used by a layout, besides its glyphs */
+#define LAYOUT_OVERHEAD         512
+
+/* the estimated memory used by each glyph of a layout: the glyph info,
+ * the logical cluster and the log attributes of the character
+ */
+#define GLYPH_SIZE              (sizeof (PangoGlyphInfo) + sizeof (gint) + sizeof (PangoLogAttr))
+
+typedef struct _LayoutCacheEntry        LayoutCacheEntry;
+
+struct _LayoutCacheEntry
+{
+  /* owns copies of the text, attributes and font description */
+  ClutterLayoutCacheKey key;
+  guint hash;
+
+  PangoLayout *layout;
+  gsize size;
+
+  /* the link in the LRU queue, most recently used first */
+  GList link;
+};
+
+static GHashTable *layout_cache = NULL;
+static GQueue layout_cache_lru = G_QUEUE_INIT;
+static gsize layout_cache_size = 0;
+
+static gboolean
+collect_attribute (PangoAttribute *attr,
+                   gpointer        data)
+{
+  GSList **attributes = data;
+
+  *attributes = g_slist_prepend (*attributes, attr);
+
+  /* we don't want to remove anything from the list */
+  return FALSE;
+}
+
+static GSList *
+get_attributes (PangoAttrList *attrs)
+{
+  GSList *attributes = NULL;
+
+  if (attrs != NULL)
+    pango_attr_list_filter (attrs, collect_attribute, &attributes);
+
+  return attributes;
+}
+
+static guint
+attr_list_hash (PangoAttrList *attrs)
+{
+  GSList *attributes, *l;
+  guint hash = 0;
+
+  attributes = get_attributes (attrs);
+
+  for (l = attributes; l != NULL; l = l->next)
+    {
+      PangoAttribute *attr = l->data;
+
+      hash = (hash * 31) + attr->klass->type;
+      hash = (hash * 31) + attr->start_index;
+      hash = (hash * 31) + attr->end_index;
+    }
+
+  g_slist_free (attributes);
+
+  return hash;
+}
+
+static gboolean
+attr_list_equal (PangoAttrList *a,
+                 PangoAttrList *b)
+{
+  GSList *attributes_a, *attributes_b, *l_a, *l_b;
+  gboolean retval = TRUE;
+
+  if (a == b)
+    return TRUE;
+
+  attributes_a = get_attributes (a);
+  attributes_b = get_attributes (b);
+
+  for (l_a = attributes_a, l_b = attributes_b;
+       l_a != NULL && l_b != NULL;
+       l_a = l_a->next, l_b = l_b->next)
+    {
+      PangoAttribute *attr_a = l_a->data;
+      PangoAttribute *attr_b = l_b->data;
+
+      if (attr_a->start_index != attr_b->start_index ||
+          attr_a->end_index != attr_b->end_index ||
+          !pango_attribute_equal (attr_a, attr_b))
+        {
+          retval = FALSE;
+          break;
+        }
+    }
+
+  if (l_a != NULL || l_b != NULL)
+    retval = FALSE;
+
+  g_slist_free (attributes_a);
+  g_slist_free (attributes_b);
+
+  return retval;
+}
+
+static guint
+layout_cache_key_hash (const ClutterLayoutCacheKey *key)
+{
+  guint hash;
+
+  hash = g_str_hash (key->text);
+  hash = (hash * 31) + attr_list_hash (key->attrs);
+  hash = (hash * 31) + pango_font_description_hash (key->font_desc);
+  hash = (hash * 31) + key->width;
+  hash = (hash * 31) + key->height;
+  hash = (hash * 31) + key->ellipsize;
+  hash = (hash * 31) + key->wrap_mode;
+  hash = (hash * 31) + key->alignment;
+  hash = (hash * 31) + key->direction;
+  hash = (hash * 31) + key->justify;
+  hash = (hash * 31) + key->single_paragraph;
+
+  return hash;
+}
+
+static guint
+layout_cache_entry_hash (gconstpointer data)
+{
+  const LayoutCacheEntry *entry = data;
+
+  return entry->hash;
+}
+
+static gboolean
+layout_cache_entry_equal (gconstpointer data_a,
+                          gconstpointer data_b)
+{
+  const LayoutCacheEntry *a = data_a;
+  const LayoutCacheEntry *b = data_b;
+
+  return _clutter_layout_cache_key_equal (&a->key, &b->key);
+}
+
+static void
+layout_cache_entry_free (gpointer data)
+{
+  LayoutCacheEntry *entry = data;
+
+  _clutter_layout_cache_key_clear (&entry->key);
+
+  g_object_unref (entry->layout);
+
+  g_slice_free (LayoutCacheEntry, entry);
+}
+
+static void
+layout_cache_remove_entry (LayoutCacheEntry *entry)
+{
+  g_queue_unlink (&layout_cache_lru, &entry->link);
+  layout_cache_size -= entry->size;
+
+  g_hash_table_remove (layout_cache, entry);
+}
+
+static void
+layout_cache_backend_changed (ClutterBackend *backend)
+{
+  CLUTTER_NOTE (PANGO, "Backend font settings changed, clearing the layout cache");
+
+  _clutter_layout_cache_clear ();
+}
+
+static void
+layout_cache_ensure (void)
+{
+  ClutterBackend *backend;
+
+  if (G_LIKELY (layout_cache != NULL))
+    return;
+
+  layout_cache = g_hash_table_new_full (layout_cache_entry_hash,
+                                        layout_cache_entry_equal,
+                                        layout_cache_entry_free,
+                                        NULL);
+
+  /* the layouts depend on the resolution and font options of the
+   * default PangoContext
+   */
+  backend = clutter_get_default_backend ();
+  g_signal_connect (backend, "resolution-changed",
+                    G_CALLBACK (layout_cache_backend_changed),
+                    NULL);
+  g_signal_connect (backend, "font-changed",
+                    G_CALLBACK (layout_cache_backend_changed),
+                    NULL);
+}
+
+/*
+ * _clutter_layout_cache_key_copy:
+ * @dest: the key to initialize
+ * @src: the key to copy
+ *
+ * Initializes @dest with copies of the fields of @src. The copy must be
+ * released with _clutter_layout_cache_key_clear().
+ */
+void
+_clutter_layout_cache_key_copy (ClutterLayoutCacheKey       *dest,
+                                const ClutterLayoutCacheKey *src)
+{
+  *dest = *src;
+  dest->text = g_strdup (src->text);
+  dest->attrs = src->attrs != NULL ? pango_attr_list_copy (src->attrs) : NULL;
+  dest->font_desc = pango_font_description_copy (src->font_desc);
+}
+
+/*
+ * _clutter_layout_cache_key_clear:
+ * @key: a key initialized with _clutter_layout_cache_key_copy()
+ *
+ * Releases the fields of @key.
+ */
+void
+_clutter_layout_cache_key_clear (ClutterLayoutCacheKey *key)
+{
+  g_free ((gchar *) key->text);
+
+  if (key->attrs != NULL)
+    pango_attr_list_unref (key->attrs);
+
+  pango_font_description_free ((PangoFontDescription *) key->font_desc);
+
+  key->text = NULL;
+  key->attrs = NULL;
+  key->font_desc = NULL;
+}
+
+/*
+ * _clutter_layout_cache_key_equal:
+ * @a: a #ClutterLayoutCacheKey
+ * @b: a #ClutterLayoutCacheKey
+ *
+ * Checks whether the layouts described by @a and @b are shaped the
+ * same way.
+ *
+ * Return value: %TRUE if the keys are equal
+ */
+gboolean
+_clutter_layout_cache_key_equal (const ClutterLayoutCacheKey *a,
+                                 const ClutterLayoutCacheKey *b)
+{
+  /* compare the cheap fields first */
+  return a->width == b->width &&
+         a->height == b->height &&
+         a->ellipsize == b->ellipsize &&
+         a->wrap_mode == b->wrap_mode &&
+         a->alignment == b->alignment &&
+         a->direction == b->direction &&
+         a->justify == b->justify &&
+         a->single_paragraph == b->single_paragraph &&
+         strcmp (a->text, b->text) == 0 &&
+         pango_font_description_equal (a->font_desc, b->font_desc) &&
+         attr_list_equal (a->attrs, b->attrs);
+}
+
+/*
+ * _clutter_layout_cache_lookup:
+ * @key: the properties of the layout
+ *
+ * Looks for a layout shaped with the properties in @key.
+ *
+ * Return value: (transfer full): a reference on the cached layout, or
+ *   %NULL if the cache does not contain a matching layout. The layout
+ *   is shared, and must not be modified
+ */
+PangoLayout *
+_clutter_layout_cache_lookup (const ClutterLayoutCacheKey *key)
+{
+  LayoutCacheEntry *entry, lookup;
+
+  CLUTTER_STATIC_COUNTER (layout_cache_hit_counter,
+                          "Shared text layout cache hit counter",
+                          "Increments for each shared layout cache hit",
+                          0);
+  CLUTTER_STATIC_COUNTER (layout_cache_miss_counter,
+                          "Shared text layout cache miss counter",
+                          "Increments for each shared layout cache miss",
+                          0);
+
+  layout_cache_ensure ();
+
+  lookup.key = *key;
+  lookup.hash = layout_cache_key_hash (key);
+
+  entry = g_hash_table_lookup (layout_cache, &lookup);
+  if (entry == NULL)
+    {
+      CLUTTER_COUNTER_INC (_clutter_uprof_context, layout_cache_miss_counter);
+      return NULL;
+    }
+
+  CLUTTER_COUNTER_INC (_clutter_uprof_context, layout_cache_hit_counter);
+
+  /* move the entry to the head of the LRU queue */
+  g_queue_unlink (&layout_cache_lru, &entry->link);
+  g_queue_push_head_link (&layout_cache_lru, &entry->link);
+
+  return g_object_ref (entry->layout);
+}
+
+/*
+ * _clutter_layout_cache_insert:
+ * @key: the properties of the layout
+ * @layout: a #PangoLayout shaped with the properties in @key
+ *
+ * Adds @layout to the cache; the cache takes a reference on it. If
+ * the cache grows over its size, the least recently used layouts are
+ * evicted.
+ */
+void
+_clutter_layout_cache_insert (const ClutterLayoutCacheKey *key,
+                              PangoLayout                 *layout)
+{
+  LayoutCacheEntry *entry, *old_entry;
+  gsize text_len;
+
+  CLUTTER_STATIC_COUNTER (layout_cache_eviction_counter,
+                          "Shared text layout cache eviction counter",
+                          "Increments for each layout evicted from the shared cache",
+                          0);
+
+  layout_cache_ensure ();
+
+  text_len = strlen (key->text);
+
+  entry = g_slice_new0 (LayoutCacheEntry);
+  _clutter_layout_cache_key_copy (&entry->key, key);
+  entry->hash = layout_cache_key_hash (key);
+  entry->layout = g_object_ref (layout);
+  entry->size = sizeof (LayoutCacheEntry)
+              + LAYOUT_OVERHEAD
+              + text_len * (1 + GLYPH_SIZE);
+  entry->link.data = entry;
+
+  /* replace an existing entry with the same key */
+  old_entry = g_hash_table_lookup (layout_cache, entry);
+  if (old_entry != NULL)
+    layout_cache_remove_entry (old_entry);
+
+  g_hash_table_add (layout_cache, entry);
+  g_queue_push_head_link (&layout_cache_lru, &entry->link);
+  layout_cache_size += entry->size;
+
+  while (layout_cache_size > CLUTTER_LAYOUT_CACHE_MAX_SIZE &&
+         layout_cache_lru.length > 1)
+    {
+      LayoutCacheEntry *oldest = layout_cache_lru.tail->data;
+
+      CLUTTER_COUNTER_INC (_clutter_uprof_context,
+                           layout_cache_eviction_counter);
+
+      layout_cache_remove_entry (oldest);
+    }
+
+  CLUTTER_NOTE (PANGO, "Layout cache: %u layouts, %" G_GSIZE_FORMAT " bytes",
+                layout_cache_lru.length,
+                layout_cache_size);
+}
+
+/*
+ * _clutter_layout_cache_clear:
+ *
+ * Drops all the layouts in the cache.
+ */
+void
+_clutter_layout_cache_clear (void)
+{
+  if (layout_cache == NULL)
+    return;
+
+  g_hash_table_remove_all (layout_cache);
+  g_queue_init (&layout_cache_lru);
+  layout_cache_size = 0;
+}
+
+/*
+ * _clutter_layout_cache_get_size:
+ *
+ * Retrieves the estimated memory used by the layouts in the cache.
+ *
+ * Return value: the size of the cache, in bytes
+ */
+gsize
+_clutter_layout_cache_get_size (void)
+{
+  return layout_cache_size;
+}
@@ -0,0 +1,74 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2013  Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * ClutterLayoutCache: a global cache of shaped PangoLayouts.
+ */
+
+#ifndef __CLUTTER_LAYOUT_CACHE_H__
+#define __CLUTTER_LAYOUT_CACHE_H__
+
+#include <pango/pango.h>
+#include <clutter/clutter-enums.h>
+
+G_BEGIN_DECLS
+
+/* the maximum amount of memory used by the shaped layouts, as estimated
+ * by the cache; the least recently used layouts are evicted first
+ */
+#define CLUTTER_LAYOUT_CACHE_MAX_SIZE   (2 * 1024 * 1024)
+
+typedef struct _ClutterLayoutCacheKey   ClutterLayoutCacheKey;
+
+/* everything that affects the shaping of a layout created from the
+ * default Clutter PangoContext
+ */
+struct _ClutterLayoutCacheKey
+{
+  const gchar *text;
+  PangoAttrList *attrs;
+  const PangoFontDescription *font_desc;
+
+  gint width;
+  gint height;
+
+  PangoEllipsizeMode ellipsize;
+  PangoWrapMode wrap_mode;
+  PangoAlignment alignment;
+  ClutterTextDirection direction;
+
+  guint justify          : 1;
+  guint single_paragraph : 1;
+};
+
+void            _clutter_layout_cache_key_copy  (ClutterLayoutCacheKey       *dest,
+                                                 const ClutterLayoutCacheKey *src);
+void            _clutter_layout_cache_key_clear (ClutterLayoutCacheKey       *key);
+gboolean        _clutter_layout_cache_key_equal (const ClutterLayoutCacheKey *a,
+                                                 const ClutterLayoutCacheKey *b);
+
+PangoLayout *   _clutter_layout_cache_lookup    (const ClutterLayoutCacheKey *key);
+void            _clutter_layout_cache_insert    (const ClutterLayoutCacheKey *key,
+                                                 PangoLayout                 *layout);
+void            _clutter_layout_cache_clear     (void);
+gsize           _clutter_layout_cache_get_size  (void);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_LAYOUT_CACHE_H__ */
@@ -34,6 +34,15 @@
  * values for each row, so it's optimized for insertion and look up
  * in sorted lists.
  *
+ * When a filter is set using clutter_model_set_filter(),
+ * #ClutterListModel keeps an index of the rows visible through the
+ * filter, so that looking up a row by its position, counting the rows
+ * and iterating over them do not need to call the filter function on
+ * every row of the model. The filter function is called again on a row
+ * only when the row changes; if the criteria used by the filter
+ * function change, clutter_model_set_filter() should be called again
+ * to rebuild the index.
+ *
  * #ClutterListModel is available since Clutter 0.6
  */
 
@@ -83,8 +92,37 @@ struct _ClutterListModelPrivate
   GSequence *sequence;
 
   ClutterModelIter *temp_iter;
+
+  /* the index of the rows visible through the filter, in the same
+   * order as the sequence; the rows in the queue of pending rows have
+   * been added or changed, and have to go through the filter again
+   * before the index can be used
+   */
+  GSequence *visible_rows;
+  GQueue pending_rows;
+
+  /* the filter stamp of the model when the index was built */
+  guint filter_stamp;
+
+  guint index_valid : 1;
 };
 
+typedef struct _ListModelRow
+{
+  GValue *values;
+
+  /* the node of the row inside the sequence, and inside the index of
+   * the visible rows, if the row is visible through the filter
+   */
+  GSequenceIter *seq_iter;
+  GSequenceIter *visible_iter;
+
+  /* the link inside the queue of pending rows; its data is set to the
+   * row while the row is in the queue
+   */
+  GList pending_link;
+} ListModelRow;
+
 struct _ClutterListModelIter
 {
   ClutterModelIter parent_instance;
@@ -96,6 +134,202 @@ struct _ClutterListModelIter
 
 GType clutter_list_model_iter_get_type (void);
 
+#define LIST_MODEL_ROW(seq_iter)        ((ListModelRow *) g_sequence_get (seq_iter))
+
+static void
+list_model_row_free (ListModelRow *row,
+                     guint         n_columns)
+{
+  guint i;
+
+  for (i = 0; i < n_columns; i++)
+    g_value_unset (&row->values[i]);
+
+  g_free (row->values);
+
+  g_slice_free (ListModelRow, row);
+}
+
+static gint
+list_model_row_compare_position (gconstpointer a,
+                                 gconstpointer b,
+                                 gpointer      data G_GNUC_UNUSED)
+{
+  const ListModelRow *row_a = a;
+  const ListModelRow *row_b = b;
+
+  return g_sequence_iter_get_position (row_a->seq_iter)
+       - g_sequence_iter_get_position (row_b->seq_iter);
+}
+
+static gboolean
+clutter_list_model_index_is_current (ClutterListModel *model)
+{
+  ClutterListModelPrivate *priv = model->priv;
+
+  return priv->index_valid &&
+         priv->filter_stamp == _clutter_model_get_filter_stamp (CLUTTER_MODEL (model));
+}
+
+static void
+clutter_list_model_invalidate_index (ClutterListModel *model)
+{
+  ClutterListModelPrivate *priv = model->priv;
+
+  if (!priv->index_valid)
+    return;
+
+  /* the rows still point into the index and the queue; they are reset
+   * when the index is rebuilt, and never looked at until then
+   */
+  g_sequence_free (priv->visible_rows);
+  priv->visible_rows = NULL;
+
+  g_queue_init (&priv->pending_rows);
+
+  priv->index_valid = FALSE;
+}
+
+/* called when @row has been added or changed: the row is taken out of
+ * the index until it goes through the filter again
+ */
+static void
+clutter_list_model_queue_row (ClutterListModel *model,
+                              ListModelRow     *row)
+{
+  ClutterListModelPrivate *priv = model->priv;
+
+  if (!clutter_list_model_index_is_current (model))
+    {
+      clutter_list_model_invalidate_index (model);
+      return;
+    }
+
+  if (row->visible_iter != NULL)
+    {
+      g_sequence_remove (row->visible_iter);
+      row->visible_iter = NULL;
+    }
+
+  if (row->pending_link.data == NULL)
+    {
+      row->pending_link.data = row;
+      g_queue_push_tail_link (&priv->pending_rows, &row->pending_link);
+    }
+}
+
+/* called when @row is going to be removed from the sequence */
+static void
+clutter_list_model_forget_row (ClutterListModel *model,
+                               ListModelRow     *row)
+{
+  ClutterListModelPrivate *priv = model->priv;
+
+  if (!priv->index_valid)
+    return;
+
+  if (row->visible_iter != NULL)
+    {
+      g_sequence_remove (row->visible_iter);
+      row->visible_iter = NULL;
+    }
+
+  if (row->pending_link.data != NULL)
+    {
+      g_queue_unlink (&priv->pending_rows, &row->pending_link);
+      row->pending_link.data = NULL;
+    }
+}
+
+static gboolean
+clutter_list_model_filter_list_row (ClutterListModel *model,
+                                    ListModelRow     *row)
+{
+  ClutterModelIter *temp_iter = model->priv->temp_iter;
+
+  CLUTTER_LIST_MODEL_ITER (temp_iter)->seq_iter = row->seq_iter;
+
+  return clutter_model_filter_iter (CLUTTER_MODEL (model), temp_iter);
+}
+
+/* makes sure that the index of the visible rows is up to date; it must
+ * only be called while a filter is set
+ */
+static void
+clutter_list_model_ensure_index (ClutterListModel *model)
+{
+  ClutterListModelPrivate *priv = model->priv;
+  GSequenceIter *seq_iter;
+  GList *link;
+
+  if (!clutter_list_model_index_is_current (model))
+    {
+      clutter_list_model_invalidate_index (model);
+
+      CLUTTER_NOTE (MISC, "Building the filter index of model %p (%d rows)",
+                    model,
+                    g_sequence_get_length (priv->sequence));
+
+      priv->visible_rows = g_sequence_new (NULL);
+      g_queue_init (&priv->pending_rows);
+
+      seq_iter = g_sequence_get_begin_iter (priv->sequence);
+      while (!g_sequence_iter_is_end (seq_iter))
+        {
+          ListModelRow *row = LIST_MODEL_ROW (seq_iter);
+
+          row->visible_iter = NULL;
+          row->pending_link.data = NULL;
+          row->pending_link.prev = row->pending_link.next = NULL;
+
+          if (clutter_list_model_filter_list_row (model, row))
+            row->visible_iter = g_sequence_append (priv->visible_rows, row);
+
+          seq_iter = g_sequence_iter_next (seq_iter);
+        }
+
+      priv->filter_stamp = _clutter_model_get_filter_stamp (CLUTTER_MODEL (model));
+      priv->index_valid = TRUE;
+
+      return;
+    }
+
+  while ((link = g_queue_pop_head_link (&priv->pending_rows)) != NULL)
+    {
+      ListModelRow *row = link->data;
+
+      link->data = NULL;
+
+      if (clutter_list_model_filter_list_row (model, row))
+        row->visible_iter =
+          g_sequence_insert_sorted (priv->visible_rows, row,
+                                    list_model_row_compare_position,
+                                    NULL);
+    }
+}
+
+/* returns the node of the index pointing to the first visible row at
+ * or after @seq_iter, or the end of the index
+ */
+static GSequenceIter *
+clutter_list_model_lookup_visible (ClutterListModel *model,
+                                   GSequenceIter    *seq_iter)
+{
+  ClutterListModelPrivate *priv = model->priv;
+  ListModelRow *row;
+
+  if (g_sequence_iter_is_end (seq_iter))
+    return g_sequence_get_end_iter (priv->visible_rows);
+
+  row = LIST_MODEL_ROW (seq_iter);
+  if (row->visible_iter != NULL)
+    return row->visible_iter;
+
+  return g_sequence_search (priv->visible_rows, row,
+                            list_model_row_compare_position,
+                            NULL);
+}
+
 /*
  * ClutterListModel
  */
@@ -118,7 +352,7 @@ clutter_list_model_iter_get_value (ClutterModelIter *iter,
   iter_default = CLUTTER_LIST_MODEL_ITER (iter);
   g_assert (iter_default->seq_iter != NULL);
 
-  values = g_sequence_get (iter_default->seq_iter);
+  values = LIST_MODEL_ROW (iter_default->seq_iter)->values;
   iter_value = &values[column];
   g_assert (iter_value != NULL);
 
@@ -163,6 +397,7 @@ clutter_list_model_iter_set_value (ClutterModelIter *iter,
                                    const GValue     *value)
 {
   ClutterListModelIter *iter_default;
+  ClutterModel *model;
   GValue *values;
   GValue *iter_value;
   GValue real_value = G_VALUE_INIT;
@@ -171,7 +406,7 @@ clutter_list_model_iter_set_value (ClutterModelIter *iter,
   iter_default = CLUTTER_LIST_MODEL_ITER (iter);
   g_assert (iter_default->seq_iter != NULL);
 
-  values = g_sequence_get (iter_default->seq_iter);
+  values = LIST_MODEL_ROW (iter_default->seq_iter)->values;
   iter_value = &values[column];
   g_assert (iter_value != NULL);
 
@@ -208,58 +443,46 @@ clutter_list_model_iter_set_value (ClutterModelIter *iter,
     }
   else
     g_value_copy (value, iter_value);
+
+  /* the row has to go through the filter again */
+  model = clutter_model_iter_get_model (iter);
+  clutter_list_model_queue_row (CLUTTER_LIST_MODEL (model),
+                                LIST_MODEL_ROW (iter_default->seq_iter));
 }
 
 static gboolean
 clutter_list_model_iter_is_first (ClutterModelIter *iter)
 {
   ClutterListModelIter *iter_default;
-  ClutterModel *model;
-  ClutterModelIter *temp_iter;
-  GSequence *sequence;
-  GSequenceIter *begin, *end;
+  ClutterListModel *model;
+  GSequenceIter *visible_iter;
 
   iter_default = CLUTTER_LIST_MODEL_ITER (iter);
   g_assert (iter_default->seq_iter != NULL);
 
-  model = clutter_model_iter_get_model (iter);
-
-  sequence = CLUTTER_LIST_MODEL (model)->priv->sequence;
-
-  begin = g_sequence_get_begin_iter (sequence);
-  end   = iter_default->seq_iter;
-
-  temp_iter = CLUTTER_LIST_MODEL (model)->priv->temp_iter;
+  if (g_sequence_iter_is_begin (iter_default->seq_iter))
+    return TRUE;
 
-  while (!g_sequence_iter_is_begin (begin))
-    {
-      CLUTTER_LIST_MODEL_ITER (temp_iter)->seq_iter = begin;
+  model = CLUTTER_LIST_MODEL (clutter_model_iter_get_model (iter));
 
-      if (clutter_model_filter_iter (model, temp_iter))
-        {
-          end = begin;
-          break;
-        }
+  if (!clutter_model_get_filter_set (CLUTTER_MODEL (model)))
+    return FALSE;
 
-      begin = g_sequence_iter_next (begin);
-    }
+  /* the iterator is the first one if there is no visible row before it */
+  clutter_list_model_ensure_index (model);
 
-  /* This is because the 'begin_iter' is always *before* the last valid
-   * iter, otherwise we'd have endless loops 
-   */
-  end = g_sequence_iter_prev (end);
+  visible_iter = clutter_list_model_lookup_visible (model,
+                                                    iter_default->seq_iter);
 
-  return iter_default->seq_iter == end;
+  return g_sequence_iter_is_begin (visible_iter);
 }
 
 static gboolean
 clutter_list_model_iter_is_last (ClutterModelIter *iter)
 {
   ClutterListModelIter *iter_default;
-  ClutterModelIter *temp_iter;
-  ClutterModel *model;
-  GSequence *sequence;
-  GSequenceIter *begin, *end;
+  ClutterListModel *model;
+  GSequenceIter *visible_iter;
 
   iter_default = CLUTTER_LIST_MODEL_ITER (iter);
   g_assert (iter_default->seq_iter != NULL);
@@ -267,75 +490,62 @@ clutter_list_model_iter_is_last (ClutterModelIter *iter)
   if (g_sequence_iter_is_end (iter_default->seq_iter))
     return TRUE;
 
-  model = clutter_model_iter_get_model (iter);
-
-  sequence = CLUTTER_LIST_MODEL (model)->priv->sequence;
-
-  begin = g_sequence_get_end_iter (sequence);
-  begin = g_sequence_iter_prev (begin);
-  end   = iter_default->seq_iter;
-
-  temp_iter = CLUTTER_LIST_MODEL (model)->priv->temp_iter;
-
-  while (!g_sequence_iter_is_begin (begin))
-    {
-      CLUTTER_LIST_MODEL_ITER (temp_iter)->seq_iter = begin;
-
-      if (clutter_model_filter_iter (model, temp_iter))
-        {
-          end = begin;
-          break;
-        }
+  model = CLUTTER_LIST_MODEL (clutter_model_iter_get_model (iter));
 
-      begin = g_sequence_iter_prev (begin);
-    }
+  if (!clutter_model_get_filter_set (CLUTTER_MODEL (model)))
+    return FALSE;
 
-  /* This is because the 'end_iter' is always *after* the last valid iter.
-   * Otherwise we'd have endless loops 
+  /* the iterator is the last one if there is no visible row at or
+   * after it
    */
-  end = g_sequence_iter_next (end);
+  clutter_list_model_ensure_index (model);
 
-  return iter_default->seq_iter == end;
+  visible_iter = clutter_list_model_lookup_visible (model,
+                                                    iter_default->seq_iter);
+
+  return g_sequence_iter_is_end (visible_iter);
 }
 
 static ClutterModelIter *
 clutter_list_model_iter_next (ClutterModelIter *iter)
 {
   ClutterListModelIter *iter_default;
-  ClutterModelIter *temp_iter;
-  ClutterModel *model = NULL;
+  ClutterListModel *model;
   GSequenceIter *filter_next;
   guint row;
 
   iter_default = CLUTTER_LIST_MODEL_ITER (iter);
   g_assert (iter_default->seq_iter != NULL);
 
-  model = clutter_model_iter_get_model (iter);
+  model = CLUTTER_LIST_MODEL (clutter_model_iter_get_model (iter));
   row   = clutter_model_iter_get_row (iter);
 
-  filter_next = g_sequence_iter_next (iter_default->seq_iter);
-  g_assert (filter_next != NULL);
+  if (!clutter_model_get_filter_set (CLUTTER_MODEL (model)))
+    filter_next = g_sequence_iter_next (iter_default->seq_iter);
+  else
+    {
+      GSequenceIter *visible_iter;
 
-  temp_iter = CLUTTER_LIST_MODEL (model)->priv->temp_iter;
+      clutter_list_model_ensure_index (model);
 
-  while (!g_sequence_iter_is_end (filter_next))
-    {
-      CLUTTER_LIST_MODEL_ITER (temp_iter)->seq_iter = filter_next;
+      visible_iter = clutter_list_model_lookup_visible (model,
+                                                        iter_default->seq_iter);
 
-      if (clutter_model_filter_iter (model, temp_iter))
-        {
-          row += 1;
-          break;
-        }
+      /* skip the current row, if it is visible */
+      if (!g_sequence_iter_is_end (visible_iter) &&
+          LIST_MODEL_ROW (visible_iter)->seq_iter == iter_default->seq_iter)
+        visible_iter = g_sequence_iter_next (visible_iter);
 
-      filter_next = g_sequence_iter_next (filter_next);
+      if (g_sequence_iter_is_end (visible_iter))
+        filter_next = g_sequence_get_end_iter (model->priv->sequence);
+      else
+        filter_next = LIST_MODEL_ROW (visible_iter)->seq_iter;
     }
 
-  if (g_sequence_iter_is_end (filter_next))
-    row += 1;
+  g_assert (filter_next != NULL);
 
   /* update the iterator and return it */
-  _clutter_model_iter_set_row (CLUTTER_MODEL_ITER (iter_default), row);
+  _clutter_model_iter_set_row (CLUTTER_MODEL_ITER (iter_default), row + 1);
   iter_default->seq_iter = filter_next;
 
   return CLUTTER_MODEL_ITER (iter_default);
@@ -345,40 +555,46 @@ static ClutterModelIter *
 clutter_list_model_iter_prev (ClutterModelIter *iter)
 {
   ClutterListModelIter *iter_default;
-  ClutterModelIter *temp_iter;
-  ClutterModel *model;
+  ClutterListModel *model;
   GSequenceIter *filter_prev;
   guint row;
 
   iter_default = CLUTTER_LIST_MODEL_ITER (iter);
   g_assert (iter_default->seq_iter != NULL);
 
-  model = clutter_model_iter_get_model (iter);
+  model = CLUTTER_LIST_MODEL (clutter_model_iter_get_model (iter));
   row   = clutter_model_iter_get_row (iter);
 
-  filter_prev = g_sequence_iter_prev (iter_default->seq_iter);
-  g_assert (filter_prev != NULL);
-
-  temp_iter = CLUTTER_LIST_MODEL (model)->priv->temp_iter;
-
-  while (!g_sequence_iter_is_begin (filter_prev))
+  if (!clutter_model_get_filter_set (CLUTTER_MODEL (model)))
+    filter_prev = g_sequence_iter_prev (iter_default->seq_iter);
+  else
     {
-      CLUTTER_LIST_MODEL_ITER (temp_iter)->seq_iter = filter_prev;
-
-      if (clutter_model_filter_iter (model, temp_iter))
+      GSequenceIter *visible_iter;
+
+      clutter_list_model_ensure_index (model);
+
+      /* the first visible row at or after the current one; the one
+       * before it in the index is the previous visible row
+       */
+      visible_iter = clutter_list_model_lookup_visible (model,
+                                                        iter_default->seq_iter);
+
+      /* like the unfiltered case, moving back from the first row stops
+       * at the beginning of the model
+       */
+      if (g_sequence_iter_is_begin (visible_iter))
+        filter_prev = g_sequence_get_begin_iter (model->priv->sequence);
+      else
         {
-          row -= 1;
-          break;
+          visible_iter = g_sequence_iter_prev (visible_iter);
+          filter_prev = LIST_MODEL_ROW (visible_iter)->seq_iter;
         }
-
-      filter_prev = g_sequence_iter_prev (filter_prev);
     }
 
-  if (g_sequence_iter_is_begin (filter_prev))
-    row -= 1;
+  g_assert (filter_prev != NULL);
 
   /* update the iterator and return it */
-  _clutter_model_iter_set_row (CLUTTER_MODEL_ITER (iter_default), row);
+  _clutter_model_iter_set_row (CLUTTER_MODEL_ITER (iter_default), row - 1);
   iter_default->seq_iter = filter_prev;
 
   return CLUTTER_MODEL_ITER (iter_default);
@@ -441,51 +657,35 @@ clutter_list_model_get_iter_at_row (ClutterModel *model,
                                     guint         row)
 {
   ClutterListModel *model_default = CLUTTER_LIST_MODEL (model);
-  GSequence *sequence = model_default->priv->sequence;
-  GSequenceIter *filter_next;
-  gint seq_length = g_sequence_get_length (sequence);
+  ClutterListModelPrivate *priv = model_default->priv;
   ClutterListModelIter *retval;
-  gint count = -1;
-
-  if (row >= seq_length)
-    return NULL;
-
-  retval = g_object_new (CLUTTER_TYPE_LIST_MODEL_ITER,
-                         "model", model,
-                         "row", row,
-                         NULL);
+  GSequenceIter *seq_iter;
 
   /* short-circuit in case we don't have a filter in place */
   if (!clutter_model_get_filter_set (model))
     {
-      retval->seq_iter = g_sequence_get_iter_at_pos (sequence, row);
+      if (row >= g_sequence_get_length (priv->sequence))
+        return NULL;
 
-      return CLUTTER_MODEL_ITER (retval);
+      seq_iter = g_sequence_get_iter_at_pos (priv->sequence, row);
     }
-
-  filter_next = g_sequence_get_begin_iter (sequence);
-  g_assert (filter_next != NULL);
-
-  while (!g_sequence_iter_is_end (filter_next))
+  else
     {
-      retval->seq_iter = filter_next;
+      clutter_list_model_ensure_index (model_default);
 
-      if (clutter_model_filter_iter (model, CLUTTER_MODEL_ITER (retval)))
-        {
-          /* We've found a row that is valid under the filter */
-          count++;
-          if (count == row)
-            break;
-        }
+      if (row >= g_sequence_get_length (priv->visible_rows))
+        return NULL;
 
-      filter_next = g_sequence_iter_next (filter_next);
+      seq_iter = g_sequence_get_iter_at_pos (priv->visible_rows, row);
+      seq_iter = LIST_MODEL_ROW (seq_iter)->seq_iter;
     }
 
-  if (count != row)
-    {
-      g_object_unref (retval);
-      return NULL;
-    }
+  retval = g_object_new (CLUTTER_TYPE_LIST_MODEL_ITER,
+                         "model", model,
+                         "row", row,
+                         NULL);
+  retval->seq_iter = seq_iter;
+
   return CLUTTER_MODEL_ITER (retval);
 }
 
@@ -497,32 +697,41 @@ clutter_list_model_insert_row (ClutterModel *model,
   GSequence *sequence = model_default->priv->sequence;
   ClutterListModelIter *retval;
   guint n_columns, i, pos;
-  GValue *values;
+  ListModelRow *row;
   GSequenceIter *seq_iter;
 
   n_columns = clutter_model_get_n_columns (model);
-  values = g_new0 (GValue, n_columns);
+
+  row = g_slice_new0 (ListModelRow);
+  row->values = g_new0 (GValue, n_columns);
 
   for (i = 0; i < n_columns; i++)
-    g_value_init (&values[i], clutter_model_get_column_type (model, i));
+    g_value_init (&row->values[i], clutter_model_get_column_type (model, i));
 
   if (index_ < 0)
     {
-      seq_iter = g_sequence_append (sequence, values);
+      seq_iter = g_sequence_append (sequence, row);
       pos = g_sequence_get_length (sequence) - 1;
     }
   else if (index_ == 0)
     {
-      seq_iter = g_sequence_prepend (sequence, values);
+      seq_iter = g_sequence_prepend (sequence, row);
       pos = 0;
     }
   else
     {
       seq_iter = g_sequence_get_iter_at_pos (sequence, index_);
-      seq_iter = g_sequence_insert_before (seq_iter, values);
+      seq_iter = g_sequence_insert_before (seq_iter, row);
       pos = index_;
     }
 
+  row->seq_iter = seq_iter;
+
+  /* the values of the row are set after it has been inserted, so
+   * the row goes through the filter the next time the index is used
+   */
+  clutter_list_model_queue_row (model_default, row);
+
   retval = g_object_new (CLUTTER_TYPE_LIST_MODEL_ITER,
                          "model", model,
                          "row", pos,
@@ -539,41 +748,38 @@ clutter_list_model_remove_row (ClutterModel *model,
   ClutterListModel *model_default = CLUTTER_LIST_MODEL (model);
   GSequence *sequence = model_default->priv->sequence;
   GSequenceIter *seq_iter;
-  guint pos = 0;
+  ClutterModelIter *iter;
+
+  if (row >= g_sequence_get_length (sequence))
+    return;
+
+  seq_iter = g_sequence_get_iter_at_pos (sequence, row);
 
-  seq_iter = g_sequence_get_begin_iter (sequence);
-  while (!g_sequence_iter_is_end (seq_iter))
+  /* only a row visible through the filter can be removed */
+  if (clutter_model_get_filter_set (model))
     {
-      if (clutter_model_filter_row (model, pos))
-        {
-          if (pos == row)
-            {  
-              ClutterModelIter *iter;
-
-              iter = g_object_new (CLUTTER_TYPE_LIST_MODEL_ITER,
-                                   "model", model,
-                                   "row", pos,
-                                   NULL);
-              CLUTTER_LIST_MODEL_ITER (iter)->seq_iter = seq_iter;
-
-              /* the actual row is removed from the sequence inside
-               * the ::row-removed signal class handler, so that every
-               * handler connected to ::row-removed will still get
-               * a valid iterator, and every signal connected to
-               * ::row-removed with the AFTER flag will get an updated
-               * model
-               */
-              g_signal_emit_by_name (model, "row-removed", iter);
-
-              g_object_unref (iter);
-
-              break;
-            }
-        }
+      clutter_list_model_ensure_index (model_default);
 
-      pos += 1;
-      seq_iter = g_sequence_iter_next (seq_iter);
+      if (LIST_MODEL_ROW (seq_iter)->visible_iter == NULL)
+        return;
     }
+
+  iter = g_object_new (CLUTTER_TYPE_LIST_MODEL_ITER,
+                       "model", model,
+                       "row", row,
+                       NULL);
+  CLUTTER_LIST_MODEL_ITER (iter)->seq_iter = seq_iter;
+
+  /* the actual row is removed from the sequence inside
+   * the ::row-removed signal class handler, so that every
+   * handler connected to ::row-removed will still get
+   * a valid iterator, and every signal connected to
+   * ::row-removed with the AFTER flag will get an updated
+   * model
+   */
+  g_signal_emit_by_name (model, "row-removed", iter);
+
+  g_object_unref (iter);
 }
 
 typedef struct
@@ -589,8 +795,8 @@ sort_model_default (gconstpointer a,
                     gconstpointer b,
                     gpointer      data)
 {
-  const GValue *row_a = a;
-  const GValue *row_b = b;
+  const GValue *row_a = ((const ListModelRow *) a)->values;
+  const GValue *row_b = ((const ListModelRow *) b)->values;
   SortClosure *clos = data;
 
   return clos->func (clos->model,
@@ -604,6 +810,7 @@ clutter_list_model_resort (ClutterModel         *model,
                            ClutterModelSortFunc  func,
                            gpointer              data)
 {
+  ClutterListModelPrivate *priv = CLUTTER_LIST_MODEL (model)->priv;
   SortClosure sort_closure = { NULL, 0, NULL, NULL };
 
   sort_closure.model  = model;
@@ -611,9 +818,35 @@ clutter_list_model_resort (ClutterModel         *model,
   sort_closure.func   = func;
   sort_closure.data   = data;
 
-  g_sequence_sort (CLUTTER_LIST_MODEL (model)->priv->sequence,
+  g_sequence_sort (priv->sequence,
                    sort_model_default,
                    &sort_closure);
+
+  /* the visible rows are still the same, but the index has to follow
+   * the new order of the sequence; the rows that are still pending
+   * are not in the index, so they do not need to be moved
+   */
+  if (clutter_list_model_index_is_current (CLUTTER_LIST_MODEL (model)))
+    {
+      GSequence *visible_rows = g_sequence_new (NULL);
+      GSequenceIter *seq_iter;
+
+      seq_iter = g_sequence_get_begin_iter (priv->sequence);
+      while (!g_sequence_iter_is_end (seq_iter))
+        {
+          ListModelRow *row = LIST_MODEL_ROW (seq_iter);
+
+          if (row->visible_iter != NULL)
+            row->visible_iter = g_sequence_append (visible_rows, row);
+
+          seq_iter = g_sequence_iter_next (seq_iter);
+        }
+
+      g_sequence_free (priv->visible_rows);
+      priv->visible_rows = visible_rows;
+    }
+  else
+    clutter_list_model_invalidate_index (CLUTTER_LIST_MODEL (model));
 }
 
 static guint
@@ -625,7 +858,9 @@ clutter_list_model_get_n_rows (ClutterModel *model)
   if (!clutter_model_get_filter_set (model))
     return g_sequence_get_length (list_model->priv->sequence);
 
-  return CLUTTER_MODEL_CLASS (clutter_list_model_parent_class)->get_n_rows (model);
+  clutter_list_model_ensure_index (list_model);
+
+  return g_sequence_get_length (list_model->priv->visible_rows);
 }
 
 static void
@@ -633,22 +868,18 @@ clutter_list_model_row_removed (ClutterModel     *model,
                                 ClutterModelIter *iter)
 {
   ClutterListModelIter *iter_default;
-  guint i, n_columns;
-  GValue *values;
-
-  n_columns = clutter_model_get_n_columns (model);
+  ListModelRow *row;
 
   iter_default = CLUTTER_LIST_MODEL_ITER (iter);
 
-  values = g_sequence_get (iter_default->seq_iter);
+  row = LIST_MODEL_ROW (iter_default->seq_iter);
 
-  for (i = 0; i < n_columns; i++)
-    g_value_unset (&values[i]);
-
-  g_free (values);
+  clutter_list_model_forget_row (CLUTTER_LIST_MODEL (model), row);
 
   g_sequence_remove (iter_default->seq_iter);
   iter_default->seq_iter = NULL;
+
+  list_model_row_free (row, clutter_model_get_n_columns (model));
 }
 
 static void
@@ -657,19 +888,16 @@ clutter_list_model_finalize (GObject *gobject)
   ClutterListModel *model = CLUTTER_LIST_MODEL (gobject);
   GSequence *sequence = model->priv->sequence;
   GSequenceIter *iter;
-  guint n_columns, i;
+  guint n_columns;
 
   n_columns = clutter_model_get_n_columns (CLUTTER_MODEL (gobject));
 
+  clutter_list_model_invalidate_index (model);
+
   iter = g_sequence_get_begin_iter (sequence);
   while (!g_sequence_iter_is_end (iter))
     {
-      GValue *values = g_sequence_get (iter);
-
-      for (i = 0; i < n_columns; i++)
-        g_value_unset (&values[i]);
-
-      g_free (values);
+      list_model_row_free (LIST_MODEL_ROW (iter), n_columns);
 
       iter = g_sequence_iter_next (iter);
     }
@@ -159,6 +159,7 @@ static gboolean clutter_enable_accessibility = TRUE;
 static gboolean clutter_sync_to_vblank       = TRUE;
 
 static guint clutter_default_fps             = 60;
+static guint clutter_offscreen_budget        = 16;
 
 static ClutterTextDirection clutter_text_direction = CLUTTER_TEXT_DIRECTION_LTR;
 
@@ -211,6 +212,9 @@ static const GDebugKey clutter_paint_debug_keys[] = {
   { "disable-offscreen-redirect", CLUTTER_DEBUG_DISABLE_OFFSCREEN_REDIRECT },
   { "continuous-redraw", CLUTTER_DEBUG_CONTINUOUS_REDRAW },
   { "paint-deform-tiles", CLUTTER_DEBUG_PAINT_DEFORM_TILES },
+  { "disable-retained-paint-nodes", CLUTTER_DEBUG_DISABLE_RETAINED_PAINT_NODES },
+  { "disable-paint-node-batching", CLUTTER_DEBUG_DISABLE_PAINT_NODE_BATCHING },
+  { "disable-offscreen-pool", CLUTTER_DEBUG_DISABLE_OFFSCREEN_POOL },
 };
 
 #ifdef CLUTTER_ENABLE_PROFILE
@@ -1795,6 +1799,14 @@ pre_parse_hook (GOptionContext  *context,
       clutter_default_fps = CLAMP (default_fps, 1, 1000);
     }
 
+  env_string = g_getenv ("CLUTTER_OFFSCREEN_BUDGET");
+  if (env_string)
+    {
+      gint offscreen_budget = g_ascii_strtoll (env_string, NULL, 10);
+
+      clutter_offscreen_budget = CLAMP (offscreen_budget, 0, 1024);
+    }
+
   env_string = g_getenv ("CLUTTER_DISABLE_MIPMAPPED_TEXT");
   if (env_string)
     clutter_disable_mipmap_text = TRUE;
@@ -1839,6 +1851,7 @@ post_parse_hook (GOptionContext  *context,
     }
 
   clutter_context->frame_rate = clutter_default_fps;
+  clutter_context->offscreen_budget = clutter_offscreen_budget * 1024 * 1024;
   clutter_context->show_fps = clutter_show_fps;
   clutter_context->options_parsed = TRUE;
 
@@ -2359,13 +2372,15 @@ static inline void
 emit_touch_event (ClutterEvent       *event,
                   ClutterInputDevice *device)
 {
-  ClutterActor *grab_actor = NULL;
+  ClutterActor *grab_actor;
 
-  if (device->sequence_grab_actors != NULL)
-    {
-      grab_actor = g_hash_table_lookup (device->sequence_grab_actors,
-                                        event->touch.sequence);
-    }
+  /* the grabs of the sequences coming from the sequence table are
+   * stored inside the sequences themselves
+   */
+  grab_actor = device != NULL
+             ? clutter_input_device_sequence_get_grabbed_actor (device,
+                                                                event->touch.sequence)
+             : NULL;
 
   if (grab_actor != NULL)
     {
@@ -2437,17 +2452,37 @@ is_off_stage (ClutterActor *stage,
  */
 void
 clutter_do_event (ClutterEvent *event)
+{
+  _clutter_do_event (event, TRUE);
+}
+
+/*< private >
+ * _clutter_do_event:
+ * @event: a #ClutterEvent
+ * @copy_event: whether @event should be copied
+ *
+ * Processes an event, like clutter_do_event().
+ *
+ * If @copy_event is %FALSE, Clutter takes ownership of @event, which
+ * must have been allocated with clutter_event_new() or copied with
+ * clutter_event_copy(); this allows the backends to hand the events
+ * they pop from the event queue over to the stage without copying
+ * them again.
+ */
+void
+_clutter_do_event (ClutterEvent *event,
+                   gboolean      copy_event)
 {
   /* we need the stage for the event */
   if (event->any.stage == NULL)
     {
       g_warning ("%s: Event does not have a stage: discarding.", G_STRFUNC);
-      return;
+      goto discard;
     }
 
   /* stages in destruction do not process events */
   if (CLUTTER_ACTOR_IN_DESTRUCTION (event->any.stage))
-    return;
+    goto discard;
 
   /* Instead of processing events when received, we queue them up to
    * handle per-frame before animations, layout, and drawing.
@@ -2456,7 +2491,12 @@ clutter_do_event (ClutterEvent *event)
    * because we've "looked ahead" and know all motion events that
    * will occur before drawing the frame.
    */
-  _clutter_stage_queue_event (event->any.stage, event);
+  _clutter_stage_queue_event (event->any.stage, event, copy_event);
+  return;
+
+discard:
+  if (!copy_event)
+    clutter_event_free (event);
 }
 
 static void
@@ -2682,17 +2722,16 @@ _clutter_process_event_details (ClutterActor        *stage,
         if (!clutter_stage_get_motion_events_enabled (CLUTTER_STAGE (stage)) &&
             event->any.source == NULL)
           {
-            ClutterActor *grab_actor = NULL;
+            ClutterActor *grab_actor;
 
             /* Only stage gets motion events */
             event->any.source = stage;
 
             /* global grabs */
-            if (device->sequence_grab_actors != NULL)
-              {
-                grab_actor = g_hash_table_lookup (device->sequence_grab_actors,
-                                                  event->touch.sequence);
-              }
+            grab_actor = device != NULL
+                       ? clutter_input_device_sequence_get_grabbed_actor (device,
+                                                                          event->touch.sequence)
+                       : NULL;
 
             if (grab_actor != NULL)
               {
@@ -2746,7 +2785,8 @@ _clutter_process_event_details (ClutterActor        *stage,
 
                   emit_touch_event (event, device);
 
-                  if (event->type == CLUTTER_TOUCH_END)
+                  if (event->type == CLUTTER_TOUCH_END ||
+                      event->type == CLUTTER_TOUCH_CANCEL)
                     _clutter_input_device_remove_event_sequence (device, event);
 
                   break;
@@ -2781,7 +2821,8 @@ _clutter_process_event_details (ClutterActor        *stage,
 
           emit_touch_event (event, device);
 
-          if (event->type == CLUTTER_TOUCH_END)
+          if (event->type == CLUTTER_TOUCH_END ||
+              event->type == CLUTTER_TOUCH_CANCEL)
             _clutter_input_device_remove_event_sequence (device, event);
 
           break;
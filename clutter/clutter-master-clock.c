@@ -36,6 +36,7 @@
 #endif
 
 #include "clutter-master-clock.h"
+#include "clutter-animation-batch.h"
 #include "clutter-debug.h"
 #include "clutter-private.h"
 #include "clutter-profile.h"
@@ -277,7 +278,10 @@ master_clock_next_frame_delay (ClutterMasterClock *master_clock)
     return -1;
 
   /* If all of the stages are busy waiting for a swap-buffers to complete
-   * then we wait for one to be ready.. */
+   * then we wait for one to be ready.. This also waits for the update
+   * time of stages with a sync delay, which for an adaptive sync delay
+   * is predicted by the frame scheduler of the stage to start the frame
+   * as late as possible before the next vblank. */
   swap_delay = master_clock_get_swap_wait_time (master_clock);
   if (swap_delay != 0)
     return swap_delay;
@@ -363,7 +367,15 @@ master_clock_process_events (ClutterMasterClock *master_clock,
 
   /* Process queued events */
   for (l = stages; l != NULL; l = l->next)
-    _clutter_stage_process_queued_events (l->data);
+    {
+      gint64 stage_start = g_get_monotonic_time ();
+
+      _clutter_stage_process_queued_events (l->data);
+
+      _clutter_stage_add_frame_phase_cost (l->data,
+                                           CLUTTER_FRAME_PHASE_EVENTS,
+                                           g_get_monotonic_time () - stage_start);
+    }
 
   CLUTTER_TIMER_STOP (_clutter_uprof_context, master_event_process);
 
@@ -378,18 +390,19 @@ master_clock_process_events (ClutterMasterClock *master_clock,
 /*
  * master_clock_advance_timelines:
  * @master_clock: a #ClutterMasterClock
+ * @stages: the stages being updated in this frame
  *
  * Advances all the timelines held by the master clock. This function
  * should be called before calling _clutter_stage_do_update() to
  * make sure that all the timelines are advanced and the scene is updated.
  */
 static void
-master_clock_advance_timelines (ClutterMasterClock *master_clock)
+master_clock_advance_timelines (ClutterMasterClock *master_clock,
+                                GSList             *stages)
 {
   GSList *timelines, *l;
-#ifdef CLUTTER_ENABLE_DEBUG
   gint64 start = g_get_monotonic_time ();
-#endif
+  gint64 cost;
 
   CLUTTER_STATIC_TIMER (master_timeline_advance,
                         "Master Clock",
@@ -422,14 +435,28 @@ master_clock_advance_timelines (ClutterMasterClock *master_clock)
 
   CLUTTER_TIMER_START (_clutter_uprof_context, master_timeline_advance);
 
+  /* the transitions of the actor properties are written once all the
+   * timelines have been advanced
+   */
+  _clutter_animation_batch_begin ();
+
   for (l = timelines; l != NULL; l = l->next)
     _clutter_timeline_do_tick (l->data, master_clock->cur_tick / 1000);
 
+  _clutter_animation_batch_flush ();
+
   CLUTTER_TIMER_STOP (_clutter_uprof_context, master_timeline_advance);
 
   g_slist_foreach (timelines, (GFunc) g_object_unref, NULL);
   g_slist_free (timelines);
 
+  /* the timelines are shared by all the stages */
+  cost = g_get_monotonic_time () - start;
+  for (l = stages; l != NULL; l = l->next)
+    _clutter_stage_add_frame_phase_cost (l->data,
+                                         CLUTTER_FRAME_PHASE_TIMELINES,
+                                         cost);
+
 #ifdef CLUTTER_ENABLE_DEBUG
   if (_clutter_diagnostic_enabled ())
     clutter_warn_if_over_budget (master_clock, start, "Animations");
@@ -545,7 +572,7 @@ clutter_clock_dispatch (GSource     *source,
   ClutterClockSource *clock_source = (ClutterClockSource *) source;
   ClutterMasterClock *master_clock = clock_source->master_clock;
   gboolean stages_updated = FALSE;
-  GSList *stages;
+  GSList *stages, *l;
 
   CLUTTER_STATIC_TIMER (master_dispatch_timer,
                         "Mainloop",
@@ -572,6 +599,12 @@ clutter_clock_dispatch (GSource     *source,
    */
   stages = master_clock_list_ready_stages (master_clock);
 
+  /* the stages record the cost of each phase of the frame, and predict
+   * the cost of the next frame from it when scheduling their updates
+   */
+  for (l = stages; l != NULL; l = l->next)
+    _clutter_stage_begin_frame (l->data, master_clock->cur_tick);
+
   master_clock->idle = FALSE;
 
   /* Each frame is split into three separate phases: */
@@ -583,7 +616,7 @@ clutter_clock_dispatch (GSource     *source,
   master_clock_process_events (master_clock, stages);
 
   /* 2. advance the timelines */
-  master_clock_advance_timelines (master_clock);
+  master_clock_advance_timelines (master_clock, stages);
 
   /* 3. relayout and redraw the stages */
   stages_updated = master_clock_update_stages (master_clock, stages);
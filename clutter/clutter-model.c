@@ -220,6 +220,11 @@ struct _ClutterModelPrivate
   gpointer                filter_data;
   GDestroyNotify          filter_notify;
 
+  /* incremented each time the filter is set, so that implementations
+   * caching the result of the filter know when to drop it
+   */
+  guint                   filter_stamp;
+
   gint                    sort_column;
   ClutterModelSortFunc    sort_func;
   gpointer                sort_data;
@@ -479,6 +484,7 @@ clutter_model_init (ClutterModel *self)
   priv->filter_func = NULL;
   priv->filter_data = NULL;
   priv->filter_notify = NULL;
+  priv->filter_stamp = 0;
 
   priv->sort_column = -1;
   priv->sort_func = NULL;
@@ -1689,6 +1695,11 @@ clutter_model_set_sort (ClutterModel         *model,
  *
  * Filters the @model using the given filtering function.
  *
+ * The #ClutterModel implementation might cache the result of @func
+ * for each row, until the row changes; if the criteria used by @func
+ * change, this function should be called again to filter the whole
+ * model again.
+ *
  * Since: 0.6
  */
 void
@@ -1708,11 +1719,29 @@ clutter_model_set_filter (ClutterModel           *model,
   priv->filter_func = func;
   priv->filter_data = user_data;
   priv->filter_notify = notify;
+  priv->filter_stamp += 1;
 
   g_signal_emit (model, model_signals[FILTER_CHANGED], 0);
   g_object_notify (G_OBJECT (model), "filter-set");
 }
 
+/*< private >
+ * _clutter_model_get_filter_stamp:
+ * @model: a #ClutterModel
+ *
+ * Retrieves a value that changes each time a filter is set on @model
+ * using clutter_model_set_filter(), even if it is the same filter
+ * function; implementations caching the rows visible through the
+ * filter use it to know when they have to filter the rows again.
+ *
+ * Return value: the filter stamp of @model
+ */
+guint
+_clutter_model_get_filter_stamp (ClutterModel *model)
+{
+  return model->priv->filter_stamp;
+}
+
 /**
  * clutter_model_get_filter_set:
  * @model: a #ClutterModel
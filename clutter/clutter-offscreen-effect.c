@@ -58,6 +58,16 @@
  *   case.</para>
  * </refsect2>
  *
+ * Since Clutter 1.14, the offscreen buffers are shared between all the
+ * effects painted on the same stage, unless the sub-class overrides the
+ * #ClutterOffscreenEffectClass.create_texture() virtual function: each
+ * effect gives its buffer back once it has painted it, and gets it back
+ * with its contents on the next frame as long as the memory used by the
+ * buffers of the stage stays within its budget. The budget can be set
+ * using the <envar>CLUTTER_OFFSCREEN_BUDGET</envar> environment variable,
+ * in megabytes. An effect can keep its buffer across frames using
+ * clutter_offscreen_effect_set_cache_target().
+ *
  * #ClutterOffscreenEffect is available since Clutter 1.4
  */
 
@@ -73,6 +83,8 @@
 
 #include "clutter-actor-private.h"
 #include "clutter-debug.h"
+#include "clutter-offscreen-effect-private.h"
+#include "clutter-offscreen-pool.h"
 #include "clutter-private.h"
 #include "clutter-stage-private.h"
 
@@ -95,6 +107,19 @@ struct _ClutterOffscreenEffectPrivate
   int fbo_width;
   int fbo_height;
 
+  /* The size of the area of the texture used by the actor; the texture
+     leased from the offscreen pool might be bigger than the fbo */
+  int target_width;
+  int target_height;
+
+  /* The target leased from the offscreen pool of the stage, if any;
+     the pool is only valid while we own the target */
+  ClutterOffscreenPool *pool;
+  ClutterOffscreenTarget *pool_target;
+
+  guint cache_target       : 1;
+  guint round_target_size  : 1;
+
   gint old_opacity_override;
 
   /* The matrix that was current the last time the fbo was updated. We
@@ -112,6 +137,54 @@ G_DEFINE_ABSTRACT_TYPE (ClutterOffscreenEffect,
                         clutter_offscreen_effect,
                         CLUTTER_TYPE_EFFECT);
 
+static void
+clear_fbo (ClutterOffscreenEffect *self)
+{
+  ClutterOffscreenEffectPrivate *priv = self->priv;
+
+  if (priv->pool_target != NULL)
+    {
+      _clutter_offscreen_pool_discard (priv->pool, priv->pool_target);
+      priv->pool_target = NULL;
+      priv->pool = NULL;
+    }
+
+  if (priv->offscreen != NULL)
+    {
+      cogl_handle_unref (priv->offscreen);
+      priv->offscreen = NULL;
+    }
+
+  if (priv->texture != NULL)
+    {
+      cogl_handle_unref (priv->texture);
+      priv->texture = NULL;
+    }
+
+  /* the target material holds a reference on the texture as well */
+  if (priv->target != NULL)
+    {
+      cogl_handle_unref (priv->target);
+      priv->target = NULL;
+    }
+
+  priv->fbo_width = 0;
+  priv->fbo_height = 0;
+}
+
+static void
+clutter_offscreen_effect_revoke_target (ClutterOffscreenTarget *target,
+                                        gpointer                owner)
+{
+  ClutterOffscreenEffect *self = owner;
+
+  /* the pool took the target back, so we must not give it back */
+  self->priv->pool_target = NULL;
+  self->priv->pool = NULL;
+
+  clear_fbo (self);
+}
+
 static void
 clutter_offscreen_effect_set_actor (ClutterActorMeta *meta,
                                     ClutterActor     *actor)
@@ -124,11 +197,7 @@ clutter_offscreen_effect_set_actor (ClutterActorMeta *meta,
   meta_class->set_actor (meta, actor);
 
   /* clear out the previous state */
-  if (priv->offscreen != NULL)
-    {
-      cogl_handle_unref (priv->offscreen);
-      priv->offscreen = NULL;
-    }
+  clear_fbo (self);
 
   /* we keep a back pointer here, to avoid going through the ActorMeta */
   priv->actor = clutter_actor_meta_get_actor (meta);
@@ -144,6 +213,115 @@ clutter_offscreen_effect_real_create_texture (ClutterOffscreenEffect *effect,
                                      COGL_PIXEL_FORMAT_RGBA_8888_PRE);
 }
 
+static void
+ensure_target (ClutterOffscreenEffect *self)
+{
+  ClutterOffscreenEffectPrivate *priv = self->priv;
+
+  if (priv->target == NULL)
+    {
+      CoglContext *ctx =
+        clutter_backend_get_cogl_context (clutter_get_default_backend ());
+
+      priv->target = cogl_pipeline_new (ctx);
+
+      /* We're always going to render the texture at a 1:1 texel:pixel
+         ratio so we can use 'nearest' filtering to decrease the
+         effects of rounding errors in the geometry calculation */
+      cogl_pipeline_set_layer_filters (priv->target,
+                                       0, /* layer_index */
+                                       COGL_PIPELINE_FILTER_NEAREST,
+                                       COGL_PIPELINE_FILTER_NEAREST);
+    }
+}
+
+/* the targets are shared through the pool of the stage, unless the
+ * sub-class creates its own textures
+ */
+static gboolean
+use_offscreen_pool (ClutterOffscreenEffect *self)
+{
+  ClutterOffscreenEffectClass *klass;
+
+  if (G_UNLIKELY (clutter_paint_debug_flags &
+                  CLUTTER_DEBUG_DISABLE_OFFSCREEN_POOL))
+    return FALSE;
+
+  klass = CLUTTER_OFFSCREEN_EFFECT_GET_CLASS (self);
+
+  return klass->create_texture == clutter_offscreen_effect_real_create_texture;
+}
+
+static gboolean
+update_pooled_fbo (ClutterOffscreenEffect *self,
+                   int                     fbo_width,
+                   int                     fbo_height)
+{
+  ClutterOffscreenEffectPrivate *priv = self->priv;
+  ClutterOffscreenPool *pool;
+  ClutterOffscreenTarget *target;
+  int width, height;
+
+  pool = _clutter_stage_get_offscreen_pool (CLUTTER_STAGE (priv->stage));
+
+  /* the actor was moved to another stage */
+  if (priv->pool_target != NULL && priv->pool != pool)
+    clear_fbo (self);
+
+  if (priv->round_target_size)
+    {
+      width = CLUTTER_OFFSCREEN_POOL_ROUND_SIZE (fbo_width);
+      height = CLUTTER_OFFSCREEN_POOL_ROUND_SIZE (fbo_height);
+    }
+  else
+    {
+      width = MAX (fbo_width, 1);
+      height = MAX (fbo_height, 1);
+    }
+
+  /* if we still own the previous target and it has the right size we
+     get it back with its contents, otherwise the pool takes it back */
+  target = _clutter_offscreen_pool_lease (pool, priv->pool_target,
+                                          width, height,
+                                          COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                          self,
+                                          clutter_offscreen_effect_revoke_target);
+  priv->pool_target = target;
+  priv->pool = pool;
+
+  if (target == NULL)
+    {
+      g_warning ("%s: Unable to create an Offscreen buffer", G_STRLOC);
+
+      clear_fbo (self);
+
+      return FALSE;
+    }
+
+  priv->fbo_width = fbo_width;
+  priv->fbo_height = fbo_height;
+  priv->target_width = MAX (fbo_width, 1);
+  priv->target_height = MAX (fbo_height, 1);
+
+  if (priv->offscreen == target->offscreen)
+    return TRUE;
+
+  ensure_target (self);
+
+  if (priv->texture != NULL)
+    cogl_handle_unref (priv->texture);
+
+  priv->texture = cogl_handle_ref (target->texture);
+  cogl_pipeline_set_layer_texture (priv->target, 0, priv->texture);
+
+  if (priv->offscreen != NULL)
+    cogl_handle_unref (priv->offscreen);
+
+  priv->offscreen = cogl_handle_ref (target->offscreen);
+
+  return TRUE;
+}
+
 static gboolean
 update_fbo (ClutterEffect *effect, int fbo_width, int fbo_height)
 {
@@ -160,26 +338,15 @@ update_fbo (ClutterEffect *effect, int fbo_width, int fbo_height)
       return FALSE;
     }
 
+  if (use_offscreen_pool (self))
+    return update_pooled_fbo (self, fbo_width, fbo_height);
+
   if (priv->fbo_width == fbo_width &&
       priv->fbo_height == fbo_height &&
       priv->offscreen != NULL)
     return TRUE;
 
-  if (priv->target == NULL)
-    {
-      CoglContext *ctx =
-        clutter_backend_get_cogl_context (clutter_get_default_backend ());
-
-      priv->target = cogl_pipeline_new (ctx);
-
-      /* We're always going to render the texture at a 1:1 texel:pixel
-         ratio so we can use 'nearest' filtering to decrease the
-         effects of rounding errors in the geometry calculation */
-      cogl_pipeline_set_layer_filters (priv->target,
-                                       0, /* layer_index */
-                                       COGL_PIPELINE_FILTER_NEAREST,
-                                       COGL_PIPELINE_FILTER_NEAREST);
-    }
+  ensure_target (self);
 
   if (priv->texture != NULL)
     {
@@ -196,6 +363,8 @@ update_fbo (ClutterEffect *effect, int fbo_width, int fbo_height)
 
   priv->fbo_width = fbo_width;
   priv->fbo_height = fbo_height;
+  priv->target_width = cogl_texture_get_width (priv->texture);
+  priv->target_height = cogl_texture_get_height (priv->texture);
 
   if (priv->offscreen != NULL)
     cogl_handle_unref (priv->offscreen);
@@ -259,8 +428,8 @@ clutter_offscreen_effect_pre_paint (ClutterEffect *effect)
   if (!update_fbo (effect, fbo_width, fbo_height))
     return FALSE;
 
-  texture_width = cogl_texture_get_width (priv->texture);
-  texture_height = cogl_texture_get_height (priv->texture);
+  texture_width = priv->target_width;
+  texture_height = priv->target_height;
 
   /* get the current modelview matrix so that we can copy it to the
    * framebuffer. We also store the matrix that was last used when we
@@ -344,6 +513,7 @@ clutter_offscreen_effect_real_paint_target (ClutterOffscreenEffect *effect)
 {
   ClutterOffscreenEffectPrivate *priv = effect->priv;
   guint8 paint_opacity;
+  gfloat s, t;
 
   paint_opacity = clutter_actor_get_paint_opacity (priv->actor);
 
@@ -357,13 +527,17 @@ clutter_offscreen_effect_real_paint_target (ClutterOffscreenEffect *effect)
   /* At this point we are in stage coordinates translated so if
    * we draw our texture using a textured quad the size of the paint
    * box then we will overlay where the actor would have drawn if it
-   * hadn't been redirected offscreen.
+   * hadn't been redirected offscreen. The texture might be bigger
+   * than the area used by the actor, if it comes from the pool.
    */
+  s = (gfloat) priv->target_width / cogl_texture_get_width (priv->texture);
+  t = (gfloat) priv->target_height / cogl_texture_get_height (priv->texture);
+
   cogl_rectangle_with_texture_coords (0, 0,
-                                      cogl_texture_get_width (priv->texture),
-                                      cogl_texture_get_height (priv->texture),
+                                      priv->target_width,
+                                      priv->target_height,
                                       0.0, 0.0,
-                                      1.0, 1.0);
+                                      s, t);
 }
 
 static void
@@ -409,6 +583,13 @@ clutter_offscreen_effect_post_paint (ClutterEffect *effect)
   cogl_pop_framebuffer ();
 
   clutter_offscreen_effect_paint_texture (self);
+
+  /* give the target back to the pool; its contents are still ours
+     until the pool needs the target for another effect */
+  if (priv->pool_target != NULL &&
+      priv->pool_target->leased &&
+      !priv->cache_target)
+    _clutter_offscreen_pool_release (priv->pool, priv->pool_target);
 }
 
 static void
@@ -434,23 +615,20 @@ clutter_offscreen_effect_paint (ClutterEffect           *effect,
         paint (effect, flags);
     }
   else
-    clutter_offscreen_effect_paint_texture (self);
+    {
+      if (priv->pool_target != NULL)
+        _clutter_offscreen_pool_touch (priv->pool, priv->pool_target);
+
+      clutter_offscreen_effect_paint_texture (self);
+    }
 }
 
 static void
 clutter_offscreen_effect_finalize (GObject *gobject)
 {
   ClutterOffscreenEffect *self = CLUTTER_OFFSCREEN_EFFECT (gobject);
-  ClutterOffscreenEffectPrivate *priv = self->priv;
-
-  if (priv->offscreen)
-    cogl_handle_unref (priv->offscreen);
 
-  if (priv->target)
-    cogl_handle_unref (priv->target);
-
-  if (priv->texture)
-    cogl_handle_unref (priv->texture);
+  clear_fbo (self);
 
   G_OBJECT_CLASS (clutter_offscreen_effect_parent_class)->finalize (gobject);
 }
@@ -590,6 +768,11 @@ clutter_offscreen_effect_create_texture (ClutterOffscreenEffect *effect,
  * Retrieves the size of the offscreen buffer used by @effect to
  * paint the actor to which it has been applied.
  *
+ * Since Clutter 1.14 the texture returned by
+ * clutter_offscreen_effect_get_texture() might be bigger than the
+ * offscreen buffer, in which case the actor is painted in its top left
+ * corner.
+ *
  * This function should only be called by #ClutterOffscreenEffect
  * implementations, from within the <function>paint_target()</function>
  * virtual function.
@@ -614,10 +797,75 @@ clutter_offscreen_effect_get_target_size (ClutterOffscreenEffect *effect,
     return FALSE;
 
   if (width)
-    *width = cogl_texture_get_width (priv->texture);
+    *width = priv->target_width;
 
   if (height)
-    *height = cogl_texture_get_height (priv->texture);
+    *height = priv->target_height;
 
   return TRUE;
 }
+
+/**
+ * clutter_offscreen_effect_set_cache_target:
+ * @effect: a #ClutterOffscreenEffect
+ * @cache_target: whether @effect should keep its offscreen buffer
+ *
+ * Sets whether @effect should keep its offscreen buffer across frames.
+ *
+ * By default, the offscreen buffers are shared between the effects of a
+ * stage: an effect gives its buffer back once it has painted it, and it
+ * only gets the same buffer, along with its contents, on the next frame
+ * if no other effect needed it in the meantime. Keeping the buffer
+ * guarantees that the actor is not painted again unless it changes, at
+ * the cost of holding on to the buffer even when the actor is not
+ * visible.
+ *
+ * The change is applied the next time @effect is painted.
+ *
+ * Since: 1.14
+ */
+void
+clutter_offscreen_effect_set_cache_target (ClutterOffscreenEffect *effect,
+                                           gboolean                cache_target)
+{
+  g_return_if_fail (CLUTTER_IS_OFFSCREEN_EFFECT (effect));
+
+  effect->priv->cache_target = !!cache_target;
+}
+
+/**
+ * clutter_offscreen_effect_get_cache_target:
+ * @effect: a #ClutterOffscreenEffect
+ *
+ * Retrieves the value set using clutter_offscreen_effect_set_cache_target()
+ *
+ * Return value: %TRUE if @effect keeps its offscreen buffer across frames
+ *
+ * Since: 1.14
+ */
+gboolean
+clutter_offscreen_effect_get_cache_target (ClutterOffscreenEffect *effect)
+{
+  g_return_val_if_fail (CLUTTER_IS_OFFSCREEN_EFFECT (effect), FALSE);
+
+  return effect->priv->cache_target;
+}
+
+/*< private >
+ * _clutter_offscreen_effect_set_round_target_size:
+ * @effect: a #ClutterOffscreenEffect
+ * @round_target_size: whether @effect can paint a part of its texture
+ *
+ * Sets whether the size of the texture used by @effect can be rounded
+ * up, so that it can share the textures of the offscreen pool with the
+ * effects applied to actors of similar sizes. This is only possible if
+ * the sub-class paints the texture using the size returned by
+ * clutter_offscreen_effect_get_target_size(), or at a 1:1 texel:pixel
+ * ratio.
+ */
+void
+_clutter_offscreen_effect_set_round_target_size (ClutterOffscreenEffect *effect,
+                                                 gboolean                round_target_size)
+{
+  effect->priv->round_target_size = !!round_target_size;
+}
@@ -107,6 +107,12 @@ gboolean        clutter_offscreen_effect_get_target_size        (ClutterOffscree
                                                                  gfloat                 *width,
                                                                  gfloat                 *height);
 
+CLUTTER_AVAILABLE_IN_1_14
+void            clutter_offscreen_effect_set_cache_target       (ClutterOffscreenEffect *effect,
+                                                                 gboolean                cache_target);
+CLUTTER_AVAILABLE_IN_1_14
+gboolean        clutter_offscreen_effect_get_cache_target       (ClutterOffscreenEffect *effect);
+
 G_END_DECLS
 
 #endif /* __CLUTTER_OFFSCREEN_EFFECT_H__ */
@@ -0,0 +1,479 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2013  Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * ClutterOffscreenPool:
+ *
+ * The offscreen pool keeps the textures and the framebuffers used by the
+ * #ClutterOffscreenEffect<!-- -->s of a stage, so that effects applied to
+ * actors of similar sizes share the same targets instead of each one of
+ * them allocating its own, and so that resizing an actor does not need
+ * to allocate a new target on every frame.
+ *
+ * The targets are bucketed by their format and by their size; the effects
+ * able to paint a part of a target round the size they need up to a
+ * multiple of %CLUTTER_OFFSCREEN_POOL_GRANULARITY. An effect leases a
+ * target before painting the actor, and releases it once it has painted
+ * the contents of the target, unless it wants to keep the target for
+ * itself across frames.
+ *
+ * A released target keeps its owner, so that the owner can paint the
+ * same contents again, or lease it again, as long as nobody else took
+ * it in the meantime. Free targets are only given to other effects, or
+ * freed, when the memory used by the pool grows over its budget; in that
+ * case the least recently used targets go first, and their owners are
+ * notified through the revoke function they passed when leasing them.
+ * Leased targets are never taken back, even if the pool is over its
+ * budget, and neither is the most recently released one until another
+ * target is leased.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "clutter-offscreen-pool.h"
+
+#include "clutter-debug.h"
+#include "clutter-private.h"
+#include "clutter-profile.h"
+
+struct _ClutterOffscreenPool
+{
+  /* all the targets, leased or free */
+  GList *targets;
+
+  /* the free targets, most recently used first */
+  GQueue free_targets;
+
+  /* the memory used by the targets, in bytes */
+  gsize size;
+  gsize budget;
+};
+
+static void
+clutter_offscreen_pool_account (ClutterOffscreenPool *pool,
+                                gsize                 size,
+                                gboolean              resident)
+{
+  gsize i;
+
+  /* the counter is kept in KiB, since it can only be moved by one unit
+   * at a time; this only happens when allocating or freeing a target
+   */
+  CLUTTER_STATIC_COUNTER (offscreen_pool_resident_counter,
+                          "Offscreen pool resident KiB",
+                          "The memory used by the targets of the offscreen pools, in KiB",
+                          0);
+
+  if (resident)
+    {
+      pool->size += size;
+
+      for (i = 0; i < size / 1024; i++)
+        CLUTTER_COUNTER_INC (_clutter_uprof_context,
+                             offscreen_pool_resident_counter);
+    }
+  else
+    {
+      pool->size -= size;
+
+      for (i = 0; i < size / 1024; i++)
+        CLUTTER_COUNTER_DEC (_clutter_uprof_context,
+                             offscreen_pool_resident_counter);
+    }
+}
+
+static void
+clutter_offscreen_target_revoke (ClutterOffscreenTarget *target)
+{
+  gpointer owner = target->owner;
+  ClutterOffscreenTargetRevoke revoke = target->revoke;
+
+  target->owner = NULL;
+  target->revoke = NULL;
+
+  if (owner != NULL && revoke != NULL)
+    revoke (target, owner);
+}
+
+static ClutterOffscreenTarget *
+clutter_offscreen_pool_create_target (ClutterOffscreenPool *pool,
+                                      gint                  width,
+                                      gint                  height,
+                                      CoglPixelFormat       format)
+{
+  ClutterOffscreenTarget *target;
+  CoglHandle texture, offscreen;
+
+  texture = cogl_texture_new_with_size (width, height,
+                                        COGL_TEXTURE_NO_SLICING,
+                                        format);
+  if (texture == NULL)
+    return NULL;
+
+  offscreen = cogl_offscreen_new_to_texture (texture);
+  if (offscreen == NULL)
+    {
+      cogl_handle_unref (texture);
+      return NULL;
+    }
+
+  target = g_slice_new0 (ClutterOffscreenTarget);
+  target->texture = texture;
+  target->offscreen = offscreen;
+  target->width = width;
+  target->height = height;
+  target->format = format;
+  target->link.data = target;
+
+  /* we only ever allocate 32 bits per pixel targets */
+  target->size = (gsize) width * height * 4;
+
+  pool->targets = g_list_prepend (pool->targets, target);
+  clutter_offscreen_pool_account (pool, target->size, TRUE);
+
+  CLUTTER_NOTE (MISC, "Offscreen pool %p: allocated a %dx%d target, "
+                "%" G_GSIZE_FORMAT " bytes resident",
+                pool, width, height, pool->size);
+
+  return target;
+}
+
+static void
+clutter_offscreen_pool_free_target (ClutterOffscreenPool   *pool,
+                                    ClutterOffscreenTarget *target)
+{
+  CLUTTER_STATIC_COUNTER (offscreen_pool_eviction_counter,
+                          "Offscreen pool eviction counter",
+                          "Increments for each target freed by an offscreen pool",
+                          0);
+
+  CLUTTER_COUNTER_INC (_clutter_uprof_context,
+                       offscreen_pool_eviction_counter);
+
+  clutter_offscreen_target_revoke (target);
+
+  if (!target->leased)
+    g_queue_unlink (&pool->free_targets, &target->link);
+
+  pool->targets = g_list_remove (pool->targets, target);
+  clutter_offscreen_pool_account (pool, target->size, FALSE);
+
+  cogl_handle_unref (target->offscreen);
+  cogl_handle_unref (target->texture);
+
+  g_slice_free (ClutterOffscreenTarget, target);
+}
+
+/* frees the least recently used free targets until @extra_size bytes
+ * more fit in the budget of the pool, or until there are no free
+ * targets left besides @keep
+ */
+static void
+clutter_offscreen_pool_trim (ClutterOffscreenPool   *pool,
+                             gsize                   extra_size,
+                             ClutterOffscreenTarget *keep)
+{
+  while (pool->size + extra_size > pool->budget &&
+         pool->free_targets.tail != NULL &&
+         pool->free_targets.tail->data != keep)
+    {
+      clutter_offscreen_pool_free_target (pool,
+                                          pool->free_targets.tail->data);
+    }
+}
+
+/*
+ * _clutter_offscreen_pool_new:
+ * @budget: the memory budget of the pool, in bytes
+ *
+ * Creates a new, empty offscreen pool.
+ *
+ * Return value: the newly created pool; use _clutter_offscreen_pool_free()
+ *   to free it
+ */
+ClutterOffscreenPool *
+_clutter_offscreen_pool_new (gsize budget)
+{
+  ClutterOffscreenPool *pool;
+
+  pool = g_slice_new0 (ClutterOffscreenPool);
+  g_queue_init (&pool->free_targets);
+  pool->budget = budget;
+
+  return pool;
+}
+
+/*
+ * _clutter_offscreen_pool_free:
+ * @pool: a #ClutterOffscreenPool
+ *
+ * Frees @pool and all its targets, leased or not; the revoke function
+ * of the owner of each target is called before freeing it.
+ */
+void
+_clutter_offscreen_pool_free (ClutterOffscreenPool *pool)
+{
+  if (pool == NULL)
+    return;
+
+  while (pool->targets != NULL)
+    clutter_offscreen_pool_free_target (pool, pool->targets->data);
+
+  g_slice_free (ClutterOffscreenPool, pool);
+}
+
+/*
+ * _clutter_offscreen_pool_set_budget:
+ * @pool: a #ClutterOffscreenPool
+ * @budget: the memory budget of the pool, in bytes
+ *
+ * Sets the amount of memory the targets of @pool can use before the
+ * free targets are reused or freed, and frees the least recently used
+ * free targets over the new budget.
+ */
+void
+_clutter_offscreen_pool_set_budget (ClutterOffscreenPool *pool,
+                                    gsize                 budget)
+{
+  pool->budget = budget;
+
+  clutter_offscreen_pool_trim (pool, 0, NULL);
+}
+
+/*
+ * _clutter_offscreen_pool_get_size:
+ * @pool: a #ClutterOffscreenPool
+ *
+ * Retrieves the memory used by the targets of @pool, leased or not.
+ *
+ * Return value: the size of the pool, in bytes
+ */
+gsize
+_clutter_offscreen_pool_get_size (ClutterOffscreenPool *pool)
+{
+  return pool->size;
+}
+
+/*
+ * _clutter_offscreen_pool_lease:
+ * @pool: a #ClutterOffscreenPool
+ * @previous: (allow-none): the target previously leased by @owner, if
+ *   it still owns it
+ * @width: the width of the target
+ * @height: the height of the target
+ * @format: the pixel format of the target
+ * @owner: the owner of the target
+ * @revoke: the function called when the pool takes the target back
+ *   from @owner
+ *
+ * Leases a target of @width by @height pixels from @pool.
+ *
+ * If @previous has the requested size and format, it is returned with its
+ * contents untouched; otherwise, @previous is given back to the pool, and
+ * the target is picked from the free targets with the same size and
+ * format, or allocated if none is available.
+ *
+ * The target must be given back to the pool using either
+ * _clutter_offscreen_pool_release() or _clutter_offscreen_pool_discard().
+ *
+ * Return value: a leased target, or %NULL if the target could not be
+ *   allocated
+ */
+ClutterOffscreenTarget *
+_clutter_offscreen_pool_lease (ClutterOffscreenPool         *pool,
+                               ClutterOffscreenTarget       *previous,
+                               gint                          width,
+                               gint                          height,
+                               CoglPixelFormat               format,
+                               gpointer                      owner,
+                               ClutterOffscreenTargetRevoke  revoke)
+{
+  ClutterOffscreenTarget *target, *unowned, *owned;
+  gsize size;
+  GList *l;
+
+  CLUTTER_STATIC_COUNTER (offscreen_pool_hit_counter,
+                          "Offscreen pool hit counter",
+                          "Increments for each target leased from an offscreen pool",
+                          0);
+  CLUTTER_STATIC_COUNTER (offscreen_pool_miss_counter,
+                          "Offscreen pool miss counter",
+                          "Increments for each target allocated by an offscreen pool",
+                          0);
+
+  width = MAX (width, 1);
+  height = MAX (height, 1);
+
+  if (previous != NULL)
+    {
+      g_assert (previous->owner == owner);
+
+      if (previous->width == width &&
+          previous->height == height &&
+          previous->format == format)
+        {
+          if (!previous->leased)
+            {
+              g_queue_unlink (&pool->free_targets, &previous->link);
+              previous->leased = TRUE;
+            }
+
+          CLUTTER_COUNTER_INC (_clutter_uprof_context,
+                               offscreen_pool_hit_counter);
+
+          return previous;
+        }
+
+      _clutter_offscreen_pool_discard (pool, previous);
+    }
+
+  size = (gsize) width * height * 4;
+
+  /* look for a free target of the same size, preferring the ones that
+   * nobody owns, and then the least recently used ones
+   */
+  unowned = owned = NULL;
+  for (l = pool->free_targets.tail; l != NULL; l = l->prev)
+    {
+      ClutterOffscreenTarget *candidate = l->data;
+
+      if (candidate->width != width ||
+          candidate->height != height ||
+          candidate->format != format)
+        continue;
+
+      if (candidate->owner == NULL)
+        {
+          unowned = candidate;
+          break;
+        }
+
+      if (owned == NULL)
+        owned = candidate;
+    }
+
+  /* we only take a target away from its owner if we cannot allocate a
+   * new one without going over the budget
+   */
+  target = unowned;
+  if (target == NULL && owned != NULL && pool->size + size > pool->budget)
+    {
+      clutter_offscreen_target_revoke (owned);
+      target = owned;
+    }
+
+  if (target != NULL)
+    {
+      g_queue_unlink (&pool->free_targets, &target->link);
+
+      CLUTTER_COUNTER_INC (_clutter_uprof_context, offscreen_pool_hit_counter);
+    }
+  else
+    {
+      clutter_offscreen_pool_trim (pool, size, NULL);
+
+      target = clutter_offscreen_pool_create_target (pool,
+                                                     width, height,
+                                                     format);
+      if (target == NULL)
+        return NULL;
+
+      CLUTTER_COUNTER_INC (_clutter_uprof_context, offscreen_pool_miss_counter);
+    }
+
+  target->leased = TRUE;
+  target->owner = owner;
+  target->revoke = revoke;
+
+  return target;
+}
+
+/*
+ * _clutter_offscreen_pool_release:
+ * @pool: a #ClutterOffscreenPool
+ * @target: a leased target of @pool
+ *
+ * Gives @target back to @pool, while keeping its owner; the owner can
+ * paint the contents of @target, or lease it again, until the revoke
+ * function it passed to _clutter_offscreen_pool_lease() is called.
+ *
+ * The other free targets over the budget of the pool are freed, but
+ * @target itself is kept even if it does not fit in the budget, so that
+ * a target bigger than the budget is not allocated again on every frame.
+ */
+void
+_clutter_offscreen_pool_release (ClutterOffscreenPool   *pool,
+                                 ClutterOffscreenTarget *target)
+{
+  g_assert (target->leased);
+
+  target->leased = FALSE;
+  g_queue_push_head_link (&pool->free_targets, &target->link);
+
+  clutter_offscreen_pool_trim (pool, 0, target);
+}
+
+/*
+ * _clutter_offscreen_pool_touch:
+ * @pool: a #ClutterOffscreenPool
+ * @target: a target of @pool
+ *
+ * Marks @target as the most recently used free target, after its owner
+ * painted its contents without leasing it again.
+ */
+void
+_clutter_offscreen_pool_touch (ClutterOffscreenPool   *pool,
+                               ClutterOffscreenTarget *target)
+{
+  if (target->leased)
+    return;
+
+  g_queue_unlink (&pool->free_targets, &target->link);
+  g_queue_push_head_link (&pool->free_targets, &target->link);
+}
+
+/*
+ * _clutter_offscreen_pool_discard:
+ * @pool: a #ClutterOffscreenPool
+ * @target: a target of @pool
+ *
+ * Gives @target back to @pool, along with its contents; the revoke
+ * function of the owner is not called. The target will be the first
+ * one to be reused or freed.
+ */
+void
+_clutter_offscreen_pool_discard (ClutterOffscreenPool   *pool,
+                                 ClutterOffscreenTarget *target)
+{
+  target->owner = NULL;
+  target->revoke = NULL;
+
+  if (target->leased)
+    target->leased = FALSE;
+  else
+    g_queue_unlink (&pool->free_targets, &target->link);
+
+  g_queue_push_tail_link (&pool->free_targets, &target->link);
+
+  clutter_offscreen_pool_trim (pool, 0, NULL);
+}
@@ -0,0 +1,101 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2013  Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * ClutterOffscreenPool: offscreen framebuffers shared by the effects
+ * of a stage.
+ */
+
+#ifndef __CLUTTER_OFFSCREEN_POOL_H__
+#define __CLUTTER_OFFSCREEN_POOL_H__
+
+#include <glib.h>
+#include <cogl/cogl.h>
+
+G_BEGIN_DECLS
+
+/* the users of the pool able to paint a part of a target round the size
+ * they need up to a multiple of this value, so that actors of similar
+ * sizes, and actors being resized by a few pixels on every frame, share
+ * the same targets
+ */
+#define CLUTTER_OFFSCREEN_POOL_GRANULARITY      32
+
+#define CLUTTER_OFFSCREEN_POOL_ROUND_SIZE(s) \
+  ((MAX ((s), 1) + CLUTTER_OFFSCREEN_POOL_GRANULARITY - 1) \
+   / CLUTTER_OFFSCREEN_POOL_GRANULARITY \
+   * CLUTTER_OFFSCREEN_POOL_GRANULARITY)
+
+typedef struct _ClutterOffscreenPool    ClutterOffscreenPool;
+typedef struct _ClutterOffscreenTarget  ClutterOffscreenTarget;
+
+/* called when the pool takes back the target of @owner while it is not
+ * leased, either to give it to another owner or to free it; the owner
+ * must drop any reference it holds on the texture and the framebuffer of
+ * the target, and it must not call into the pool
+ */
+typedef void (* ClutterOffscreenTargetRevoke) (ClutterOffscreenTarget *target,
+                                               gpointer                owner);
+
+struct _ClutterOffscreenTarget
+{
+  CoglHandle texture;
+  CoglHandle offscreen;
+
+  /* the size of the texture */
+  gint width;
+  gint height;
+  CoglPixelFormat format;
+
+  gsize size;
+
+  /* the last owner of the target, whose contents are still in it */
+  gpointer owner;
+  ClutterOffscreenTargetRevoke revoke;
+
+  guint leased : 1;
+
+  /* the link in the queue of the free targets, most recently used first */
+  GList link;
+};
+
+ClutterOffscreenPool *  _clutter_offscreen_pool_new             (gsize                         budget);
+void                    _clutter_offscreen_pool_free            (ClutterOffscreenPool         *pool);
+
+void                    _clutter_offscreen_pool_set_budget      (ClutterOffscreenPool         *pool,
+                                                                 gsize                         budget);
+gsize                   _clutter_offscreen_pool_get_size        (ClutterOffscreenPool         *pool);
+
+ClutterOffscreenTarget *_clutter_offscreen_pool_lease           (ClutterOffscreenPool         *pool,
+                                                                 ClutterOffscreenTarget       *previous,
+                                                                 gint                          width,
+                                                                 gint                          height,
+                                                                 CoglPixelFormat               format,
+                                                                 gpointer                      owner,
+                                                                 ClutterOffscreenTargetRevoke  revoke);
+void                    _clutter_offscreen_pool_release         (ClutterOffscreenPool         *pool,
+                                                                 ClutterOffscreenTarget       *target);
+void                    _clutter_offscreen_pool_touch           (ClutterOffscreenPool         *pool,
+                                                                 ClutterOffscreenTarget       *target);
+void                    _clutter_offscreen_pool_discard         (ClutterOffscreenPool         *pool,
+                                                                 ClutterOffscreenTarget       *target);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_OFFSCREEN_POOL_H__ */
@@ -147,6 +147,73 @@ clutter_page_turn_effect_deform_vertex (ClutterDeformEffect *effect,
     }
 }
 
+static void
+clutter_page_turn_effect_deform_vertices (ClutterDeformEffect   *effect,
+                                          gfloat                 width,
+                                          gfloat                 height,
+                                          ClutterDeformVertices *vertices)
+{
+  ClutterPageTurnEffect *self = CLUTTER_PAGE_TURN_EFFECT (effect);
+  gfloat *x = vertices->x;
+  gfloat *y = vertices->y;
+  gfloat *z = vertices->z;
+  guint8 *colors = vertices->colors;
+  gfloat radians, cos_angle, sin_angle;
+  gfloat cx, cy, radius;
+  guint i;
+
+  if (self->period == 0.0)
+    return;
+
+  /* same as clutter_page_turn_effect_deform_vertex(), with everything
+   * that does not depend on the vertex computed once, and only single
+   * precision math inside the loop
+   */
+  radians = self->angle / (180.0f / G_PI);
+  cos_angle = cosf (radians);
+  sin_angle = sinf (radians);
+
+  radius = self->radius;
+
+  cx = (1.f - self->period) * width;
+  cy = (1.f - self->period) * height;
+
+  for (i = 0; i < vertices->n_vertices; i++)
+    {
+      gfloat rx, ry, turn_angle, small_radius;
+      guint8 shade;
+
+      /* rotate the point around the centre of the page-curl ray */
+      rx = ((x[i] - cx) * cos_angle)
+         + ((y[i] - cy) * sin_angle)
+         - radius;
+      ry = ((y[i] - cy) * cos_angle)
+         - ((x[i] - cx) * sin_angle);
+
+      if (rx <= radius * -2.0f)
+        continue;
+
+      turn_angle = (rx / radius * (gfloat) G_PI_2) - (gfloat) G_PI_2;
+      shade = (sinf (turn_angle) * 96.0f) + 159.0f;
+
+      colors[i * 4 + 0] = shade;
+      colors[i * 4 + 1] = shade;
+      colors[i * 4 + 2] = shade;
+      colors[i * 4 + 3] = 0xff;
+
+      if (rx <= 0)
+        continue;
+
+      small_radius = radius - MIN (radius, (turn_angle * 10) / (gfloat) G_PI);
+
+      rx = (small_radius * cosf (turn_angle)) + radius;
+
+      x[i] = (rx * cos_angle) - (ry * sin_angle) + cx;
+      y[i] = (rx * sin_angle) + (ry * cos_angle) + cy;
+      z[i] = (small_radius * sinf (turn_angle)) + radius;
+    }
+}
+
 static void
 clutter_page_turn_effect_set_property (GObject      *gobject,
                                        guint         prop_id,
@@ -263,6 +330,7 @@ clutter_page_turn_effect_class_init (ClutterPageTurnEffectClass *klass)
   g_object_class_install_property (gobject_class, PROP_RADIUS, pspec);
 
   deform_class->deform_vertex = clutter_page_turn_effect_deform_vertex;
+  deform_class->deform_vertices = clutter_page_turn_effect_deform_vertices;
 }
 
 static void
@@ -55,6 +55,9 @@ struct _ClutterPaintNode
   gchar *name;
 
   volatile int ref_count;
+
+  /* whether the batches cached by the children can be painted again */
+  guint batches_valid : 1;
 };
 
 struct _ClutterPaintNodeClass
@@ -113,6 +116,9 @@ ClutterPaintNode *      _clutter_transform_node_new                     (const C
 ClutterPaintNode *      _clutter_dummy_node_new                         (ClutterActor                *actor);
 
 void                    _clutter_paint_node_paint                       (ClutterPaintNode            *root);
+
+guint                   _clutter_pipeline_node_paint_batch              (ClutterPaintNode            *node,
+                                                                         gboolean                     rebuild);
 void                    _clutter_paint_node_dump_tree                   (ClutterPaintNode            *root);
 
 G_GNUC_INTERNAL
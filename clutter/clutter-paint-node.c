@@ -78,6 +78,7 @@
 
 #include "clutter-debug.h"
 #include "clutter-private.h"
+#include "clutter-profile.h"
 
 #include <gobject/gvaluecollector.h>
 
@@ -240,6 +241,19 @@ clutter_paint_node_init (ClutterPaintNode *self)
   self->ref_count = 1;
 }
 
+/* the batches of sibling nodes painted with a single draw call depend
+ * on the operations of each node and on the list of children of their
+ * parent, see _clutter_pipeline_node_paint_batch()
+ */
+static inline void
+clutter_paint_node_invalidate_batches (ClutterPaintNode *node)
+{
+  node->batches_valid = FALSE;
+
+  if (node->parent != NULL)
+    node->parent->batches_valid = FALSE;
+}
+
 GType
 clutter_paint_node_get_type (void)
 {
@@ -382,6 +396,8 @@ clutter_paint_node_add_child (ClutterPaintNode *node,
 
   node->n_children += 1;
 
+  clutter_paint_node_invalidate_batches (node);
+
   child->prev_sibling = node->last_child;
 
   if (node->last_child != NULL)
@@ -423,6 +439,8 @@ clutter_paint_node_remove_child (ClutterPaintNode *node,
 
   node->n_children -= 1;
 
+  clutter_paint_node_invalidate_batches (node);
+
   prev = child->prev_sibling;
   next = child->next_sibling;
 
@@ -472,6 +490,8 @@ clutter_paint_node_replace_child (ClutterPaintNode *node,
   g_return_if_fail (CLUTTER_IS_PAINT_NODE (new_child));
   g_return_if_fail (new_child->parent == NULL);
 
+  clutter_paint_node_invalidate_batches (node);
+
   prev = old_child->prev_sibling;
   next = old_child->next_sibling;
 
@@ -825,6 +845,8 @@ clutter_paint_op_init_primitive (ClutterPaintOperation *op,
 static inline void
 clutter_paint_node_maybe_init_operations (ClutterPaintNode *node)
 {
+  clutter_paint_node_invalidate_batches (node);
+
   if (node->operations != NULL)
     return;
 
@@ -956,7 +978,15 @@ _clutter_paint_node_paint (ClutterPaintNode *node)
 {
   ClutterPaintNodeClass *klass = CLUTTER_PAINT_NODE_GET_CLASS (node);
   ClutterPaintNode *iter;
-  gboolean res;
+  gboolean res, batching;
+
+  CLUTTER_STATIC_COUNTER (paint_node_paint_counter,
+                          "Paint nodes painted",
+                          "Increments each time a paint node is painted "
+                          "on its own, outside of a batch",
+                          0 /* no application private data */);
+
+  CLUTTER_COUNTER_INC (_clutter_uprof_context, paint_node_paint_counter);
 
   res = klass->pre_draw (node);
 
@@ -965,13 +995,36 @@ _clutter_paint_node_paint (ClutterPaintNode *node)
       klass->draw (node);
     }
 
-  for (iter = node->first_child;
-       iter != NULL;
-       iter = iter->next_sibling)
+  batching = (clutter_paint_debug_flags &
+              CLUTTER_DEBUG_DISABLE_PAINT_NODE_BATCHING) == 0;
+
+  iter = node->first_child;
+  while (iter != NULL)
     {
-      _clutter_paint_node_paint (iter);
+      guint n_batched = 0;
+
+      /* runs of equivalent sibling nodes are painted at once; the
+       * siblings share the state set up by their parent, so they
+       * can be merged without changing the result
+       */
+      if (batching)
+        n_batched = _clutter_pipeline_node_paint_batch (iter,
+                                                        !node->batches_valid);
+
+      if (n_batched == 0)
+        {
+          _clutter_paint_node_paint (iter);
+          iter = iter->next_sibling;
+        }
+      else
+        {
+          while (n_batched-- > 0)
+            iter = iter->next_sibling;
+        }
     }
 
+  node->batches_valid = batching;
+
   if (res)
     {
       klass->post_draw (node);
@@ -1117,8 +1170,15 @@ _clutter_paint_node_dump_tree (ClutterPaintNode *node)
 gpointer
 _clutter_paint_node_create (GType gtype)
 {
+  CLUTTER_STATIC_COUNTER (paint_node_create_counter,
+                          "Paint nodes created",
+                          "Increments each time a paint node is created",
+                          0 /* no application private data */);
+
   g_return_val_if_fail (g_type_is_a (gtype, CLUTTER_TYPE_PAINT_NODE), NULL);
 
+  CLUTTER_COUNTER_INC (_clutter_uprof_context, paint_node_create_counter);
+
   _clutter_paint_node_init_types ();
 
   return (gpointer) g_type_create_instance (gtype);
@@ -39,6 +39,8 @@
 
 #include "clutter-paint-node-private.h"
 
+#include <string.h>
+
 #include <pango/pango.h>
 #include <cogl/cogl.h>
 
@@ -46,6 +48,7 @@
 #include "clutter-color.h"
 #include "clutter-debug.h"
 #include "clutter-private.h"
+#include "clutter-profile.h"
 
 #include "clutter-paint-nodes.h"
 
@@ -337,6 +340,13 @@ struct _ClutterPipelineNode
   ClutterPaintNode parent_instance;
 
   CoglPipeline *pipeline;
+
+  /* the number of siblings, starting from this node, that are painted
+   * in a single batch, and the geometry of the batch if it's made of
+   * color nodes; see _clutter_pipeline_node_paint_batch()
+   */
+  guint batch_length;
+  CoglPrimitive *batch_primitive;
 };
 
 /**
@@ -362,6 +372,9 @@ clutter_pipeline_node_finalize (ClutterPaintNode *node)
   if (pnode->pipeline != NULL)
     cogl_object_unref (pnode->pipeline);
 
+  if (pnode->batch_primitive != NULL)
+    cogl_object_unref (pnode->batch_primitive);
+
   CLUTTER_PAINT_NODE_CLASS (clutter_pipeline_node_parent_class)->finalize (node);
 }
 
@@ -606,6 +619,12 @@ clutter_color_node_new (const ClutterColor *color)
 struct _ClutterTextureNode
 {
   ClutterPipelineNode parent_instance;
+
+  /* the state of the pipeline, used to batch texture nodes */
+  CoglTexture *texture;
+  CoglPipelineFilter min_filter;
+  CoglPipelineFilter mag_filter;
+  CoglColor color;
 };
 
 /**
@@ -679,6 +698,7 @@ clutter_texture_node_new (CoglTexture          *texture,
                           ClutterScalingFilter  mag_filter)
 {
   ClutterPipelineNode *tnode;
+  ClutterTextureNode *self;
   CoglColor cogl_color;
   CoglPipelineFilter min_f, mag_f;
 
@@ -700,9 +720,296 @@ clutter_texture_node_new (CoglTexture          *texture,
   cogl_color_premultiply (&cogl_color);
   cogl_pipeline_set_color (tnode->pipeline, &cogl_color);
 
+  /* the pipeline holds a reference on the texture */
+  self = (ClutterTextureNode *) tnode;
+  self->texture = texture;
+  self->min_filter = min_f;
+  self->mag_filter = mag_f;
+  self->color = cogl_color;
+
   return (ClutterPaintNode *) tnode;
 }
 
+/*
+ * Batching
+ */
+
+/* only the nodes without children, whose operations are all rectangles,
+ * and whose type does not override the way they are painted, can be
+ * part of a batch
+ */
+static gboolean
+clutter_pipeline_node_is_batchable (ClutterPaintNode *node)
+{
+  GType gtype = G_TYPE_FROM_INSTANCE (node);
+  guint i;
+
+  if (gtype != CLUTTER_TYPE_COLOR_NODE &&
+      gtype != CLUTTER_TYPE_TEXTURE_NODE &&
+      gtype != CLUTTER_TYPE_PIPELINE_NODE)
+    return FALSE;
+
+  if (node->first_child != NULL || node->operations == NULL)
+    return FALSE;
+
+  if (CLUTTER_PIPELINE_NODE (node)->pipeline == NULL)
+    return FALSE;
+
+  for (i = 0; i < node->operations->len; i++)
+    {
+      const ClutterPaintOperation *op;
+
+      op = &g_array_index (node->operations, ClutterPaintOperation, i);
+      if (op->opcode != PAINT_OP_TEX_RECT)
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static gboolean
+clutter_pipeline_node_batch_equal (ClutterPaintNode *a,
+                                   ClutterPaintNode *b)
+{
+  GType gtype = G_TYPE_FROM_INSTANCE (a);
+
+  if (gtype != G_TYPE_FROM_INSTANCE (b))
+    return FALSE;
+
+  /* color nodes only differ by the color of their pipeline, which is
+   * moved into the vertices of the batch
+   */
+  if (gtype == CLUTTER_TYPE_COLOR_NODE)
+    return TRUE;
+
+  if (gtype == CLUTTER_TYPE_TEXTURE_NODE)
+    {
+      ClutterTextureNode *ta = (ClutterTextureNode *) a;
+      ClutterTextureNode *tb = (ClutterTextureNode *) b;
+
+      return ta->texture == tb->texture &&
+             ta->min_filter == tb->min_filter &&
+             ta->mag_filter == tb->mag_filter &&
+             cogl_color_equal (&ta->color, &tb->color);
+    }
+
+  /* arbitrary pipelines cannot be compared, so we only batch the nodes
+   * that share the same one
+   */
+  return CLUTTER_PIPELINE_NODE (a)->pipeline == CLUTTER_PIPELINE_NODE (b)->pipeline;
+}
+
+static void
+clutter_pipeline_node_clear_batch (ClutterPipelineNode *pnode)
+{
+  if (pnode->batch_primitive != NULL)
+    {
+      cogl_object_unref (pnode->batch_primitive);
+      pnode->batch_primitive = NULL;
+    }
+
+  pnode->batch_length = 0;
+}
+
+static inline void
+clutter_color_node_set_vertex (CoglVertexP2C4  *vertex,
+                               float            x,
+                               float            y,
+                               const CoglColor *color)
+{
+  vertex->x = x;
+  vertex->y = y;
+  vertex->r = cogl_color_get_red_byte (color);
+  vertex->g = cogl_color_get_green_byte (color);
+  vertex->b = cogl_color_get_blue_byte (color);
+  vertex->a = cogl_color_get_alpha_byte (color);
+}
+
+/* creates the geometry for a run of @n_nodes color nodes starting from
+ * @node, using per-vertex colors so that a single pipeline can be used
+ */
+static CoglPrimitive *
+clutter_color_node_create_batch (ClutterPaintNode *node,
+                                 guint             n_nodes)
+{
+  CoglContext *ctx;
+  CoglPrimitive *res;
+  CoglVertexP2C4 *vertices, *v;
+  ClutterPaintNode *iter;
+  guint n_rects, i, j;
+
+  n_rects = 0;
+  for (iter = node, i = 0; i < n_nodes; iter = iter->next_sibling, i++)
+    n_rects += iter->operations->len;
+
+  v = vertices = g_new (CoglVertexP2C4, n_rects * 6);
+
+  for (iter = node, i = 0; i < n_nodes; iter = iter->next_sibling, i++)
+    {
+      CoglColor color;
+
+      cogl_pipeline_get_color (CLUTTER_PIPELINE_NODE (iter)->pipeline, &color);
+
+      for (j = 0; j < iter->operations->len; j++)
+        {
+          const ClutterPaintOperation *op;
+          float x_1, y_1, x_2, y_2;
+
+          op = &g_array_index (iter->operations, ClutterPaintOperation, j);
+
+          x_1 = op->op.texrect[0];
+          y_1 = op->op.texrect[1];
+          x_2 = op->op.texrect[2];
+          y_2 = op->op.texrect[3];
+
+          clutter_color_node_set_vertex (v++, x_1, y_1, &color);
+          clutter_color_node_set_vertex (v++, x_1, y_2, &color);
+          clutter_color_node_set_vertex (v++, x_2, y_2, &color);
+
+          clutter_color_node_set_vertex (v++, x_1, y_1, &color);
+          clutter_color_node_set_vertex (v++, x_2, y_2, &color);
+          clutter_color_node_set_vertex (v++, x_2, y_1, &color);
+        }
+    }
+
+  ctx = clutter_backend_get_cogl_context (clutter_get_default_backend ());
+  res = cogl_primitive_new_p2c4 (ctx, COGL_VERTICES_MODE_TRIANGLES,
+                                 n_rects * 6,
+                                 vertices);
+
+  g_free (vertices);
+
+  return res;
+}
+
+/* paints a run of @n_nodes textured nodes sharing the same pipeline
+ * with a single call, which also takes care of sliced textures
+ */
+static void
+clutter_pipeline_node_draw_batch (ClutterPaintNode *node,
+                                  guint             n_nodes)
+{
+  static GArray *coords = NULL;
+  ClutterPaintNode *iter;
+  guint n_rects, i, j;
+
+  if (G_UNLIKELY (coords == NULL))
+    coords = g_array_new (FALSE, FALSE, sizeof (float) * 8);
+
+  n_rects = 0;
+  for (iter = node, i = 0; i < n_nodes; iter = iter->next_sibling, i++)
+    {
+      for (j = 0; j < iter->operations->len; j++)
+        {
+          const ClutterPaintOperation *op;
+
+          op = &g_array_index (iter->operations, ClutterPaintOperation, j);
+
+          if (n_rects >= coords->len)
+            g_array_set_size (coords, n_rects + 1);
+
+          memcpy (&g_array_index (coords, float, n_rects * 8),
+                  op->op.texrect,
+                  sizeof (float) * 8);
+          n_rects += 1;
+        }
+    }
+
+  cogl_push_source (CLUTTER_PIPELINE_NODE (node)->pipeline);
+  cogl_rectangles_with_texture_coords ((const float *) coords->data, n_rects);
+  cogl_pop_source ();
+}
+
+/*< private >
+ * _clutter_pipeline_node_paint_batch:
+ * @node: a #ClutterPaintNode
+ * @rebuild: whether the batches cached by @node and its siblings
+ *   cannot be reused, because they changed since the last paint
+ *
+ * Paints the longest run of sibling nodes, starting from @node, that
+ * can be merged into a single draw call: color nodes are merged into a
+ * primitive with per-vertex colors, while texture and pipeline nodes
+ * using an equivalent pipeline are painted as a list of rectangles.
+ *
+ * The batch is cached by @node, so that it can be painted again as
+ * long as neither the nodes nor their parent change.
+ *
+ * Return value: the number of nodes that have been painted, or 0 if
+ *   @node cannot be batched with its next sibling
+ */
+guint
+_clutter_pipeline_node_paint_batch (ClutterPaintNode *node,
+                                    gboolean          rebuild)
+{
+  ClutterPipelineNode *pnode;
+  guint i;
+
+  CLUTTER_STATIC_COUNTER (paint_node_batch_counter,
+                          "Paint node batches",
+                          "Increments each time a run of sibling paint "
+                          "nodes is painted with a single draw call",
+                          0 /* no application private data */);
+  CLUTTER_STATIC_COUNTER (paint_node_batched_counter,
+                          "Paint nodes batched",
+                          "Increments for each paint node painted as "
+                          "part of a batch",
+                          0 /* no application private data */);
+
+  if (!CLUTTER_IS_PIPELINE_NODE (node))
+    return 0;
+
+  pnode = CLUTTER_PIPELINE_NODE (node);
+
+  if (rebuild)
+    {
+      ClutterPaintNode *iter;
+
+      clutter_pipeline_node_clear_batch (pnode);
+
+      if (!clutter_pipeline_node_is_batchable (node))
+        return 0;
+
+      pnode->batch_length = 1;
+
+      for (iter = node->next_sibling;
+           iter != NULL;
+           iter = iter->next_sibling)
+        {
+          if (!clutter_pipeline_node_is_batchable (iter) ||
+              !clutter_pipeline_node_batch_equal (node, iter))
+            break;
+
+          /* the nodes inside a run do not start a batch of their own */
+          clutter_pipeline_node_clear_batch (CLUTTER_PIPELINE_NODE (iter));
+
+          pnode->batch_length += 1;
+        }
+    }
+
+  /* there's nothing to gain from batching a single node */
+  if (pnode->batch_length < 2)
+    return 0;
+
+  if (G_TYPE_FROM_INSTANCE (node) == CLUTTER_TYPE_COLOR_NODE)
+    {
+      if (pnode->batch_primitive == NULL)
+        pnode->batch_primitive =
+          clutter_color_node_create_batch (node, pnode->batch_length);
+
+      cogl_framebuffer_draw_primitive (cogl_get_draw_framebuffer (),
+                                       default_color_pipeline,
+                                       pnode->batch_primitive);
+    }
+  else
+    clutter_pipeline_node_draw_batch (node, pnode->batch_length);
+
+  CLUTTER_COUNTER_INC (_clutter_uprof_context, paint_node_batch_counter);
+  for (i = 0; i < pnode->batch_length; i++)
+    CLUTTER_COUNTER_INC (_clutter_uprof_context, paint_node_batched_counter);
+
+  return pnode->batch_length;
+}
+
 /*
  * Text node
  */
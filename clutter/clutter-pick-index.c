@@ -0,0 +1,696 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2013  Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * ClutterPickIndex:
+ *
+ * The pick index is a uniform grid laid over the stage viewport; each
+ * cell of the grid holds the reactive actors whose projected allocation
+ * overlaps it, sorted by paint order. Picking in reactive mode only has
+ * to test the actors of a single cell, starting from the one painted
+ * last, instead of walking the whole scene graph.
+ *
+ * Entries are stored by pick id, which is a small integer unique to each
+ * mapped actor of a stage. Besides the reactive actors, actors with a clip
+ * have an entry as well, so that the clip of the ancestors of an actor can
+ * be checked without walking the scene graph.
+ *
+ * Changes in the structure of the scene graph (mapping, reordering, the
+ * reactive flag or the clip of an actor) invalidate the whole index, which
+ * is rebuilt on the next pick; changes in the allocation or transformation
+ * of an actor only update the entries of the actor and its descendants,
+ * which are re-inserted in the grid without changing their paint order.
+ * The stale items left in the cells are discarded the next time a cell is
+ * queried.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <math.h>
+#include <string.h>
+
+#include "clutter-pick-index.h"
+
+#include "clutter-actor-private.h"
+#include "clutter-debug.h"
+#include "clutter-private.h"
+#include "clutter-stage-private.h"
+
+/* the size of a cell of the grid, in pixels */
+#define PICK_INDEX_CELL_SIZE    64
+
+/* the number of queued updates after which we just rebuild the index */
+#define PICK_INDEX_MAX_UPDATES  256
+
+typedef struct _PickEntry
+{
+  /* NULL if the entry is unused */
+  ClutterActor *actor;
+
+  /* the projected allocation of the actor */
+  ClutterVertex verts[4];
+
+  /* the projected clip of the actor, if has_clip is set */
+  ClutterVertex clip_verts[4];
+
+  /* the bounding box of the region in which the actor can be
+   * picked, i.e. the intersection of its projected allocation
+   * with the clip of all its ancestors
+   */
+  float x1, y1, x2, y2;
+
+  /* the pick id of the closest ancestor with a clip, or -1 */
+  gint parent_clip;
+
+  /* paint order of the actor; actors painted later have a
+   * greater value
+   */
+  guint order;
+
+  /* incremented each time the entry is updated, to detect
+   * stale items inside the grid cells
+   */
+  guint generation;
+
+  /* the range of cells in which the entry was inserted */
+  gint cell_x1, cell_y1, cell_x2, cell_y2;
+
+  guint has_clip    : 1;
+  guint is_reactive : 1;
+} PickEntry;
+
+typedef struct _PickCellItem
+{
+  guint32 id;
+  guint32 generation;
+} PickCellItem;
+
+typedef struct _PickCell
+{
+  GArray *items;
+
+  guint needs_sort : 1;
+} PickCell;
+
+struct _ClutterPickIndex
+{
+  ClutterStage *stage;
+
+  CoglMatrix projection;
+  float viewport[4];
+
+  /* PickEntry, indexed by pick id */
+  GArray *entries;
+
+  PickCell *cells;
+  gint n_columns;
+  gint n_rows;
+
+  /* actors whose subtree needs to be updated */
+  GPtrArray *queued_updates;
+
+  guint next_order;
+
+  /* bookkeeping of the items stored inside the cells; once the
+   * stale items outnumber the live ones we rebuild the grid
+   */
+  guint n_live_items;
+  guint n_stale_items;
+
+  guint needs_rebuild : 1;
+  guint in_rebuild    : 1;
+  guint is_supported  : 1;
+};
+
+static guint pick_index_users = 0;
+
+ClutterPickIndex *
+_clutter_pick_index_new (ClutterStage *stage)
+{
+  ClutterPickIndex *index;
+
+  index = g_slice_new0 (ClutterPickIndex);
+  index->stage = stage;
+  index->entries = g_array_sized_new (FALSE, TRUE, sizeof (PickEntry), 256);
+  index->queued_updates = g_ptr_array_new ();
+  index->needs_rebuild = TRUE;
+
+  pick_index_users += 1;
+
+  return index;
+}
+
+static void
+clutter_pick_index_free_cells (ClutterPickIndex *index)
+{
+  gint i;
+
+  for (i = 0; i < index->n_columns * index->n_rows; i++)
+    g_array_free (index->cells[i].items, TRUE);
+
+  g_free (index->cells);
+
+  index->cells = NULL;
+  index->n_columns = 0;
+  index->n_rows = 0;
+}
+
+void
+_clutter_pick_index_free (ClutterPickIndex *index)
+{
+  if (index == NULL)
+    return;
+
+  clutter_pick_index_free_cells (index);
+
+  g_array_free (index->entries, TRUE);
+  g_ptr_array_free (index->queued_updates, TRUE);
+
+  g_slice_free (ClutterPickIndex, index);
+
+  pick_index_users -= 1;
+}
+
+/*< private >
+ * _clutter_pick_index_in_use:
+ *
+ * Checks whether any stage is using a pick index, so that actors
+ * can avoid looking up their stage when their geometry changes.
+ */
+gboolean
+_clutter_pick_index_in_use (void)
+{
+  return pick_index_users != 0;
+}
+
+void
+_clutter_pick_index_invalidate (ClutterPickIndex *index)
+{
+  index->needs_rebuild = TRUE;
+
+  /* the queued actors might go away before the rebuild */
+  g_ptr_array_set_size (index->queued_updates, 0);
+}
+
+void
+_clutter_pick_index_queue_update (ClutterPickIndex *index,
+                                  ClutterActor     *actor)
+{
+  if (index->needs_rebuild)
+    return;
+
+  if ((ClutterActor *) index->stage == actor ||
+      index->queued_updates->len >= PICK_INDEX_MAX_UPDATES)
+    {
+      _clutter_pick_index_invalidate (index);
+      return;
+    }
+
+  g_ptr_array_add (index->queued_updates, actor);
+}
+
+void
+_clutter_pick_index_get_projection (ClutterPickIndex *index,
+                                    CoglMatrix       *projection,
+                                    float            *viewport)
+{
+  *projection = index->projection;
+  memcpy (viewport, index->viewport, sizeof (float) * 4);
+}
+
+static inline PickEntry *
+clutter_pick_index_lookup (ClutterPickIndex *index,
+                           gint              id_)
+{
+  PickEntry *entry;
+
+  if (id_ < 0 || (guint) id_ >= index->entries->len)
+    return NULL;
+
+  entry = &g_array_index (index->entries, PickEntry, id_);
+  if (entry->actor == NULL)
+    return NULL;
+
+  return entry;
+}
+
+static void
+clutter_pick_index_insert_entry (ClutterPickIndex *index,
+                                 PickEntry        *entry,
+                                 guint32           id_)
+{
+  PickCellItem item;
+  gint x, y;
+
+  /* skip empty entries, as well as the ones outside of the grid */
+  if (entry->x2 <= entry->x1 || entry->y2 <= entry->y1 ||
+      entry->x2 < 0.f || entry->y2 < 0.f ||
+      entry->x1 >= index->n_columns * PICK_INDEX_CELL_SIZE ||
+      entry->y1 >= index->n_rows * PICK_INDEX_CELL_SIZE)
+    {
+      entry->cell_x1 = entry->cell_y1 = 0;
+      entry->cell_x2 = entry->cell_y2 = -1;
+      return;
+    }
+
+  entry->cell_x1 = CLAMP (floorf (entry->x1 / PICK_INDEX_CELL_SIZE),
+                          0, index->n_columns - 1);
+  entry->cell_y1 = CLAMP (floorf (entry->y1 / PICK_INDEX_CELL_SIZE),
+                          0, index->n_rows - 1);
+  entry->cell_x2 = CLAMP (floorf (entry->x2 / PICK_INDEX_CELL_SIZE),
+                          0, index->n_columns - 1);
+  entry->cell_y2 = CLAMP (floorf (entry->y2 / PICK_INDEX_CELL_SIZE),
+                          0, index->n_rows - 1);
+
+  item.id = id_;
+  item.generation = entry->generation;
+
+  for (y = entry->cell_y1; y <= entry->cell_y2; y++)
+    {
+      for (x = entry->cell_x1; x <= entry->cell_x2; x++)
+        {
+          PickCell *cell = &index->cells[y * index->n_columns + x];
+
+          g_array_append_val (cell->items, item);
+          cell->needs_sort = TRUE;
+
+          index->n_live_items += 1;
+        }
+    }
+}
+
+static inline guint
+pick_entry_get_n_cells (const PickEntry *entry)
+{
+  if (entry->cell_x2 < entry->cell_x1 || entry->cell_y2 < entry->cell_y1)
+    return 0;
+
+  return (entry->cell_x2 - entry->cell_x1 + 1)
+       * (entry->cell_y2 - entry->cell_y1 + 1);
+}
+
+static inline void
+pick_entry_get_bounds (const ClutterVertex *verts,
+                       float               *x1,
+                       float               *y1,
+                       float               *x2,
+                       float               *y2)
+{
+  int i;
+
+  *x1 = *x2 = verts[0].x;
+  *y1 = *y2 = verts[0].y;
+
+  for (i = 1; i < 4; i++)
+    {
+      *x1 = MIN (*x1, verts[i].x);
+      *y1 = MIN (*y1, verts[i].y);
+      *x2 = MAX (*x2, verts[i].x);
+      *y2 = MAX (*y2, verts[i].y);
+    }
+}
+
+/*< private >
+ * _clutter_pick_index_set_entry:
+ * @index: a #ClutterPickIndex
+ * @actor: a mapped #ClutterActor
+ * @verts: the projected allocation of @actor
+ * @clip_verts: (allow-none): the projected clip of @actor, or %NULL
+ * @parent_clip: the pick id of the closest ancestor of @actor with
+ *   a clip, or -1
+ * @is_reactive: whether @actor is reactive
+ *
+ * Stores the pick geometry of @actor. This function must be called
+ * in paint order, as the parents of @actor must be up to date.
+ */
+void
+_clutter_pick_index_set_entry (ClutterPickIndex    *index,
+                               ClutterActor        *actor,
+                               const ClutterVertex *verts,
+                               const ClutterVertex *clip_verts,
+                               gint                 parent_clip,
+                               gboolean             is_reactive)
+{
+  guint32 id_ = _clutter_actor_get_pick_id (actor);
+  PickEntry *entry, *parent;
+  float x1, y1, x2, y2;
+
+  if (id_ >= index->entries->len)
+    g_array_set_size (index->entries, id_ + 1);
+
+  entry = &g_array_index (index->entries, PickEntry, id_);
+
+  if (index->in_rebuild)
+    {
+      entry->order = index->next_order++;
+      entry->generation = 0;
+    }
+  else
+    {
+      /* the structure of the scene graph changed without
+       * invalidating the index; this should not happen
+       */
+      if (entry->actor != actor)
+        {
+          CLUTTER_NOTE (PICK, "Unexpected pick index update for actor '%s'",
+                        _clutter_actor_get_debug_name (actor));
+          _clutter_pick_index_invalidate (index);
+          return;
+        }
+
+      entry->generation += 1;
+
+      index->n_stale_items += pick_entry_get_n_cells (entry);
+      index->n_live_items -= pick_entry_get_n_cells (entry);
+    }
+
+  entry->actor = actor;
+  memcpy (entry->verts, verts, sizeof (ClutterVertex) * 4);
+  entry->parent_clip = parent_clip;
+  entry->is_reactive = !!is_reactive;
+  entry->has_clip = clip_verts != NULL;
+
+  if (is_reactive)
+    pick_entry_get_bounds (verts,
+                           &entry->x1, &entry->y1,
+                           &entry->x2, &entry->y2);
+  else
+    {
+      entry->x1 = entry->y1 = -G_MAXFLOAT;
+      entry->x2 = entry->y2 = G_MAXFLOAT;
+    }
+
+  if (clip_verts != NULL)
+    {
+      memcpy (entry->clip_verts, clip_verts, sizeof (ClutterVertex) * 4);
+
+      pick_entry_get_bounds (clip_verts, &x1, &y1, &x2, &y2);
+      entry->x1 = MAX (entry->x1, x1);
+      entry->y1 = MAX (entry->y1, y1);
+      entry->x2 = MIN (entry->x2, x2);
+      entry->y2 = MIN (entry->y2, y2);
+    }
+
+  /* the bounds of the clipping ancestors already account for
+   * their own ancestors
+   */
+  parent = clutter_pick_index_lookup (index, parent_clip);
+  if (parent != NULL)
+    {
+      entry->x1 = MAX (entry->x1, parent->x1);
+      entry->y1 = MAX (entry->y1, parent->y1);
+      entry->x2 = MIN (entry->x2, parent->x2);
+      entry->y2 = MIN (entry->y2, parent->y2);
+    }
+
+  if (is_reactive)
+    clutter_pick_index_insert_entry (index, entry, id_);
+  else
+    {
+      entry->cell_x1 = entry->cell_y1 = 0;
+      entry->cell_x2 = entry->cell_y2 = -1;
+    }
+}
+
+static void
+clutter_pick_index_rebuild (ClutterPickIndex *index)
+{
+  ClutterStage *stage = index->stage;
+  gint n_columns, n_rows, i;
+
+  CLUTTER_STATIC_TIMER (pick_index_rebuild,
+                        "Picking", /* parent */
+                        "Pick index rebuild",
+                        "The time spent rebuilding the pick index",
+                        0 /* no application private data */);
+
+  CLUTTER_TIMER_START (_clutter_uprof_context, pick_index_rebuild);
+
+  _clutter_stage_get_projection_matrix (stage, &index->projection);
+  _clutter_stage_get_viewport (stage,
+                               &index->viewport[0],
+                               &index->viewport[1],
+                               &index->viewport[2],
+                               &index->viewport[3]);
+
+  n_columns = MAX (1, ceilf (index->viewport[2] / PICK_INDEX_CELL_SIZE));
+  n_rows = MAX (1, ceilf (index->viewport[3] / PICK_INDEX_CELL_SIZE));
+
+  if (n_columns != index->n_columns || n_rows != index->n_rows)
+    {
+      clutter_pick_index_free_cells (index);
+
+      index->n_columns = n_columns;
+      index->n_rows = n_rows;
+      index->cells = g_new0 (PickCell, n_columns * n_rows);
+
+      for (i = 0; i < n_columns * n_rows; i++)
+        index->cells[i].items = g_array_new (FALSE, FALSE,
+                                             sizeof (PickCellItem));
+    }
+  else
+    {
+      for (i = 0; i < n_columns * n_rows; i++)
+        {
+          g_array_set_size (index->cells[i].items, 0);
+          index->cells[i].needs_sort = FALSE;
+        }
+    }
+
+  /* the array was created with clear_ set, so this will reset
+   * all the entries when we grow it again
+   */
+  g_array_set_size (index->entries, 0);
+  g_ptr_array_set_size (index->queued_updates, 0);
+
+  index->next_order = 0;
+  index->n_live_items = 0;
+  index->n_stale_items = 0;
+
+  index->in_rebuild = TRUE;
+  index->is_supported = _clutter_actor_build_pick_index (CLUTTER_ACTOR (stage),
+                                                         index);
+  index->in_rebuild = FALSE;
+  index->needs_rebuild = FALSE;
+
+  CLUTTER_NOTE (PICK, "Rebuilt the pick index (%d entries, %u items, %s)",
+                index->entries->len,
+                index->n_live_items,
+                index->is_supported ? "supported" : "not supported");
+
+  CLUTTER_TIMER_STOP (_clutter_uprof_context, pick_index_rebuild);
+}
+
+static void
+clutter_pick_index_flush_updates (ClutterPickIndex *index)
+{
+  guint i;
+
+  for (i = 0; i < index->queued_updates->len; i++)
+    {
+      ClutterActor *actor = g_ptr_array_index (index->queued_updates, i);
+
+      if (!_clutter_actor_update_pick_index (actor, index))
+        index->is_supported = FALSE;
+
+      if (index->needs_rebuild)
+        return;
+    }
+
+  g_ptr_array_set_size (index->queued_updates, 0);
+
+  if (index->n_stale_items > index->n_live_items)
+    index->needs_rebuild = TRUE;
+}
+
+static gint
+sort_cell_items (gconstpointer a,
+                 gconstpointer b,
+                 gpointer      user_data)
+{
+  const PickCellItem *item_a = a;
+  const PickCellItem *item_b = b;
+  GArray *entries = user_data;
+  guint order_a, order_b;
+
+  order_a = g_array_index (entries, PickEntry, item_a->id).order;
+  order_b = g_array_index (entries, PickEntry, item_b->id).order;
+
+  /* the actors painted last come first */
+  if (order_a > order_b)
+    return -1;
+
+  if (order_a < order_b)
+    return 1;
+
+  return 0;
+}
+
+static void
+clutter_pick_index_sort_cell (ClutterPickIndex *index,
+                              PickCell         *cell)
+{
+  guint i, j;
+
+  /* drop the stale items */
+  for (i = 0, j = 0; i < cell->items->len; i++)
+    {
+      PickCellItem *item = &g_array_index (cell->items, PickCellItem, i);
+      PickEntry *entry = clutter_pick_index_lookup (index, item->id);
+
+      if (entry == NULL || entry->generation != item->generation)
+        {
+          index->n_stale_items -= 1;
+          continue;
+        }
+
+      if (i != j)
+        g_array_index (cell->items, PickCellItem, j) = *item;
+
+      j += 1;
+    }
+
+  g_array_set_size (cell->items, j);
+
+  g_array_sort_with_data (cell->items, sort_cell_items, index->entries);
+
+  cell->needs_sort = FALSE;
+}
+
+static gboolean
+clutter_pick_index_entry_contains (ClutterPickIndex *index,
+                                   PickEntry        *entry,
+                                   float             x,
+                                   float             y)
+{
+  PickEntry *clip;
+
+  if (x < entry->x1 || x > entry->x2 || y < entry->y1 || y > entry->y2)
+    return FALSE;
+
+  if (!_clutter_util_quad_contains_point (entry->verts, x, y))
+    return FALSE;
+
+  /* the clip of an actor applies to the actor itself, and to
+   * all its descendants
+   */
+  clip = entry->has_clip
+       ? entry
+       : clutter_pick_index_lookup (index, entry->parent_clip);
+
+  while (clip != NULL)
+    {
+      if (!_clutter_util_quad_contains_point (clip->clip_verts, x, y))
+        return FALSE;
+
+      clip = clutter_pick_index_lookup (index, clip->parent_clip);
+    }
+
+  return _clutter_actor_pick_shape_contains (entry->actor, x, y);
+}
+
+/*< private >
+ * _clutter_pick_index_pick:
+ * @index: a #ClutterPickIndex
+ * @x: X coordinate of the pick point, in window coordinates
+ * @y: Y coordinate of the pick point, in window coordinates
+ * @actor_p: (out): return location for the picked actor
+ *
+ * Picks the reactive actor at the given coordinates, updating the
+ * index if needed.
+ *
+ * Return value: %TRUE if the pick was performed, and %FALSE if the
+ *   scene graph contains actors that need to be picked by painting,
+ *   including the picked actor or one of its ancestors
+ */
+gboolean
+_clutter_pick_index_pick (ClutterPickIndex  *index,
+                          gfloat             x,
+                          gfloat             y,
+                          ClutterActor     **actor_p)
+{
+  PickCell *cell;
+  float px, py;
+  gint cell_x, cell_y;
+  guint i;
+
+  if (!index->needs_rebuild && index->queued_updates->len > 0)
+    clutter_pick_index_flush_updates (index);
+
+  if (index->needs_rebuild)
+    clutter_pick_index_rebuild (index);
+
+  if (!index->is_supported)
+    return FALSE;
+
+  *actor_p = CLUTTER_ACTOR (index->stage);
+
+  /* we test the center of the pixel, like the rasterizer does */
+  px = x + 0.5f;
+  py = y + 0.5f;
+
+  cell_x = floorf (px / PICK_INDEX_CELL_SIZE);
+  cell_y = floorf (py / PICK_INDEX_CELL_SIZE);
+
+  if (cell_x < 0 || cell_x >= index->n_columns ||
+      cell_y < 0 || cell_y >= index->n_rows)
+    return TRUE;
+
+  cell = &index->cells[cell_y * index->n_columns + cell_x];
+  if (cell->needs_sort)
+    clutter_pick_index_sort_cell (index, cell);
+
+  for (i = 0; i < cell->items->len; i++)
+    {
+      PickCellItem *item = &g_array_index (cell->items, PickCellItem, i);
+      PickEntry *entry = &g_array_index (index->entries, PickEntry, item->id);
+
+      /* cells are only compacted when items are added to them, so
+       * we can still find the items of entries that moved away
+       */
+      if (entry->actor == NULL || entry->generation != item->generation)
+        continue;
+
+      if (clutter_pick_index_entry_contains (index, entry, px, py))
+        {
+          *actor_p = entry->actor;
+          break;
+        }
+    }
+
+  /* the ::pick handlers and the effects added since the index was
+   * built are not tracked, so we check them on the picked branch
+   */
+  if (*actor_p != CLUTTER_ACTOR (index->stage) &&
+      !_clutter_actor_can_geometric_pick_branch (*actor_p))
+    {
+      CLUTTER_NOTE (PICK, "Actor '%s' cannot be picked geometrically anymore",
+                    _clutter_actor_get_debug_name (*actor_p));
+
+      _clutter_pick_index_invalidate (index);
+
+      return FALSE;
+    }
+
+  return TRUE;
+}
@@ -0,0 +1,61 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2013  Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * ClutterPickIndex: spatial index of the reactive actors of a stage.
+ */
+
+#ifndef __CLUTTER_PICK_INDEX_H__
+#define __CLUTTER_PICK_INDEX_H__
+
+#include <clutter/clutter-types.h>
+#include <cogl/cogl.h>
+
+G_BEGIN_DECLS
+
+typedef struct _ClutterPickIndex        ClutterPickIndex;
+
+ClutterPickIndex *      _clutter_pick_index_new                 (ClutterStage           *stage);
+void                    _clutter_pick_index_free                (ClutterPickIndex       *index);
+
+gboolean                _clutter_pick_index_in_use              (void);
+
+void                    _clutter_pick_index_invalidate          (ClutterPickIndex       *index);
+void                    _clutter_pick_index_queue_update        (ClutterPickIndex       *index,
+                                                                 ClutterActor           *actor);
+
+gboolean                _clutter_pick_index_pick                (ClutterPickIndex       *index,
+                                                                 gfloat                  x,
+                                                                 gfloat                  y,
+                                                                 ClutterActor          **actor_p);
+
+/* used by ClutterActor while walking the scene graph */
+void                    _clutter_pick_index_get_projection      (ClutterPickIndex       *index,
+                                                                 CoglMatrix             *projection,
+                                                                 float                  *viewport);
+void                    _clutter_pick_index_set_entry           (ClutterPickIndex       *index,
+                                                                 ClutterActor           *actor,
+                                                                 const ClutterVertex    *verts,
+                                                                 const ClutterVertex    *clip_verts,
+                                                                 gint                    parent_clip,
+                                                                 gboolean                is_reactive);
+
+G_END_DECLS
+
+#endif /* __CLUTTER_PICK_INDEX_H__ */
@@ -145,6 +145,9 @@ struct _ClutterMainContext
   /* default FPS; this is only used if we cannot sync to vblank */
   guint frame_rate;
 
+  /* memory budget of the offscreen pool of each stage, in bytes */
+  gsize offscreen_budget;
+
   /* actors with a grab on all devices */
   ClutterActor *pointer_grab_actor;
   ClutterActor *keyboard_grab_actor;
@@ -262,10 +265,18 @@ void  _clutter_util_fully_transform_vertices (const CoglMatrix    *modelview,
                                               ClutterVertex       *vertices_out,
                                               int                  n_vertices);
 
+gboolean _clutter_util_quad_contains_point (const ClutterVertex verts[],
+                                            float               x,
+                                            float               y);
+
 void _clutter_util_rectangle_union (const cairo_rectangle_int_t *src1,
                                     const cairo_rectangle_int_t *src2,
                                     cairo_rectangle_int_t       *dest);
 
+gboolean _clutter_util_rectangle_intersection (const cairo_rectangle_int_t *src1,
+                                               const cairo_rectangle_int_t *src2,
+                                               cairo_rectangle_int_t       *dest);
+
 
 struct _ClutterVertex4
 {
@@ -36,7 +36,10 @@
 
 #include "clutter-property-transition.h"
 
+#include "clutter-actor-private.h"
 #include "clutter-animatable.h"
+#include "clutter-animation-batch.h"
+#include "clutter-color.h"
 #include "clutter-debug.h"
 #include "clutter-interval.h"
 #include "clutter-private.h"
@@ -47,6 +50,12 @@ struct _ClutterPropertyTransitionPrivate
   char *property_name;
 
   GParamSpec *pspec;
+
+  /* the entry in the animation batch, for the transitions of the
+   * built-in properties of ClutterActor
+   */
+  ClutterAnimationBatchEntry *batch_entry;
+  guint batch_unsupported : 1;
 };
 
 enum
@@ -94,6 +103,164 @@ clutter_property_transition_ensure_interval (ClutterPropertyTransition *transiti
     }
 }
 
+static void
+clutter_property_transition_clear_batch_entry (ClutterPropertyTransition *transition)
+{
+  ClutterPropertyTransitionPrivate *priv = transition->priv;
+
+  if (priv->batch_entry != NULL)
+    {
+      _clutter_animation_batch_remove (priv->batch_entry);
+      priv->batch_entry = NULL;
+    }
+
+  priv->batch_unsupported = FALSE;
+}
+
+/* whether the values of @interval can be interpolated by the animation
+ * batch with the same results as clutter_interval_compute_value()
+ */
+static gboolean
+clutter_property_transition_interval_is_batchable (ClutterPropertyTransition *transition,
+                                                   ClutterInterval           *interval)
+{
+  GType value_type;
+
+  /* sub-classes of ClutterInterval may override compute_value() */
+  if (G_OBJECT_TYPE (interval) != CLUTTER_TYPE_INTERVAL)
+    return FALSE;
+
+  value_type = clutter_interval_get_value_type (interval);
+  if (value_type != G_PARAM_SPEC_VALUE_TYPE (transition->priv->pspec))
+    return FALSE;
+
+  /* ClutterColor comes with its own progress function, which is
+   * equivalent to the lanes of the batch; the fundamental types can
+   * have one registered by the application
+   */
+  if (value_type != CLUTTER_TYPE_COLOR &&
+      _clutter_has_progress_function (value_type))
+    return FALSE;
+
+  return TRUE;
+}
+
+static gboolean
+clutter_property_transition_ensure_batch_entry (ClutterPropertyTransition *transition,
+                                                ClutterAnimatable         *animatable,
+                                                ClutterInterval           *interval)
+{
+  ClutterPropertyTransitionPrivate *priv = transition->priv;
+  ClutterAnimationLaneType types[CLUTTER_ANIMATION_BATCH_MAX_LANES];
+  gpointer targets[CLUTTER_ANIMATION_BATCH_MAX_LANES];
+  guint n_lanes;
+
+  if (priv->batch_entry != NULL)
+    return TRUE;
+
+  if (priv->batch_unsupported)
+    return FALSE;
+
+  if (!CLUTTER_IS_ACTOR (animatable) ||
+      !clutter_property_transition_interval_is_batchable (transition, interval) ||
+      !_clutter_actor_get_animation_lanes (CLUTTER_ACTOR (animatable),
+                                           priv->pspec,
+                                           types, targets,
+                                           &n_lanes))
+    {
+      priv->batch_unsupported = TRUE;
+      return FALSE;
+    }
+
+  priv->batch_entry = _clutter_animation_batch_add (CLUTTER_ACTOR (animatable),
+                                                    priv->pspec,
+                                                    n_lanes,
+                                                    types,
+                                                    targets);
+
+  return priv->batch_entry != NULL;
+}
+
+/* the interval can be changed at any time, e.g. by an implicit
+ * transition being retargeted, so we copy its values on every frame
+ */
+static void
+clutter_property_transition_update_lanes (ClutterPropertyTransition *transition,
+                                          ClutterInterval           *interval)
+{
+  ClutterAnimationBatchEntry *entry = transition->priv->batch_entry;
+  const GValue *initial, *final;
+
+  initial = clutter_interval_peek_initial_value (interval);
+  final = clutter_interval_peek_final_value (interval);
+
+  switch (G_TYPE_FUNDAMENTAL (G_VALUE_TYPE (initial)))
+    {
+    case G_TYPE_UINT:
+      _clutter_animation_batch_set_lane (entry, 0,
+                                         g_value_get_uint (initial),
+                                         g_value_get_uint (final));
+      break;
+
+    case G_TYPE_FLOAT:
+      _clutter_animation_batch_set_lane (entry, 0,
+                                         g_value_get_float (initial),
+                                         g_value_get_float (final));
+      break;
+
+    case G_TYPE_DOUBLE:
+      _clutter_animation_batch_set_lane (entry, 0,
+                                         g_value_get_double (initial),
+                                         g_value_get_double (final));
+      break;
+
+    default:
+      {
+        const ClutterColor *a = clutter_value_get_color (initial);
+        const ClutterColor *b = clutter_value_get_color (final);
+
+        _clutter_animation_batch_set_lane (entry, 0, a->red, b->red);
+        _clutter_animation_batch_set_lane (entry, 1, a->green, b->green);
+        _clutter_animation_batch_set_lane (entry, 2, a->blue, b->blue);
+        _clutter_animation_batch_set_lane (entry, 3, a->alpha, b->alpha);
+      }
+      break;
+    }
+}
+
+/* the handlers of ::new-frame expect the value of the frame to be set
+ * on the animatable, so it cannot be deferred
+ */
+static gboolean
+clutter_property_transition_has_frame_handlers (ClutterPropertyTransition *transition)
+{
+  static guint new_frame_signal_id = 0;
+
+  if (G_UNLIKELY (new_frame_signal_id == 0))
+    new_frame_signal_id = g_signal_lookup ("new-frame", CLUTTER_TYPE_TIMELINE);
+
+  return g_signal_has_handler_pending (transition,
+                                       new_frame_signal_id,
+                                       0,
+                                       FALSE);
+}
+
+/* the value of the last frame is set through the interval, so that it
+ * is exact, and visible to the handlers of the ::completed and ::stopped
+ * signals
+ */
+static gboolean
+clutter_property_transition_is_last_frame (ClutterPropertyTransition *transition)
+{
+  ClutterTimeline *timeline = CLUTTER_TIMELINE (transition);
+  guint elapsed = clutter_timeline_get_elapsed_time (timeline);
+
+  if (clutter_timeline_get_direction (timeline) == CLUTTER_TIMELINE_BACKWARD)
+    return elapsed == 0;
+
+  return elapsed >= clutter_timeline_get_duration (timeline);
+}
+
 static void
 clutter_property_transition_attached (ClutterTransition *transition,
                                       ClutterAnimatable *animatable)
@@ -105,6 +272,8 @@ clutter_property_transition_attached (ClutterTransition *transition,
   if (priv->property_name == NULL)
     return;
 
+  clutter_property_transition_clear_batch_entry (self);
+
   priv->pspec =
     clutter_animatable_find_property (animatable, priv->property_name);
 
@@ -125,7 +294,9 @@ clutter_property_transition_detached (ClutterTransition *transition,
   ClutterPropertyTransition *self = CLUTTER_PROPERTY_TRANSITION (transition);
   ClutterPropertyTransitionPrivate *priv = self->priv;
 
-  priv->pspec = NULL; 
+  clutter_property_transition_clear_batch_entry (self);
+
+  priv->pspec = NULL;
 }
 
 static void
@@ -146,6 +317,31 @@ clutter_property_transition_compute_value (ClutterTransition *transition,
 
   clutter_property_transition_ensure_interval (self, animatable, interval);
 
+  /* the built-in properties of ClutterActor bypass the interval, the
+   * GValues and ClutterAnimatable, and are written by the animation
+   * batch; see clutter-animation-batch.c
+   *
+   * the lanes are interpolated in single precision, so the last frame
+   * goes through the interval, to set the exact final value
+   */
+  if (clutter_property_transition_ensure_batch_entry (self, animatable, interval))
+    {
+      if (!clutter_property_transition_interval_is_batchable (self, interval))
+        {
+          /* the interval was replaced by one we cannot batch */
+          clutter_property_transition_clear_batch_entry (self);
+          priv->batch_unsupported = TRUE;
+        }
+      else if (!clutter_property_transition_is_last_frame (self))
+        {
+          clutter_property_transition_update_lanes (self, interval);
+          _clutter_animation_batch_set_progress (priv->batch_entry,
+                                                 progress,
+                                                 clutter_property_transition_has_frame_handlers (self));
+          return;
+        }
+    }
+
   p_type = G_PARAM_SPEC_VALUE_TYPE (priv->pspec);
   i_type = clutter_interval_get_value_type (interval);
 
@@ -330,6 +526,8 @@ clutter_property_transition_set_property_name (ClutterPropertyTransition *transi
   priv->property_name = g_strdup (property_name);
   priv->pspec = NULL;
 
+  clutter_property_transition_clear_batch_entry (transition);
+
   animatable =
     clutter_transition_get_animatable (CLUTTER_TRANSITION (transition));
   if (animatable != NULL)
@@ -0,0 +1,968 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2013  Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* Compiled UI definitions
+ *
+ * A compiled UI definition is the serialization of the ObjectInfo,
+ * PropertyInfo and SignalInfo structures built by the ClutterScript
+ * parser, laid out so that it can be used directly from a mapped file:
+ *
+ *   header
+ *   objects     BinaryObject[n_objects]
+ *   properties  BinaryProperty[n_properties]
+ *   children    guint32[n_children], offsets of the ids in the strings
+ *   signals     BinarySignal[n_signals]
+ *   strings     NUL-terminated strings, strings_size bytes
+ *
+ * Every string is stored once, and referenced by its offset inside the
+ * strings block; the offset 0 is used for NULL. The scalar JSON values
+ * of the properties are stored already converted, while the objects and
+ * arrays are stored as JSON fragments, and parsed when the object is
+ * built.
+ *
+ * Loading a compiled UI definition only creates the ObjectInfo of each
+ * object; its properties and children are expanded the first time the
+ * object is built, by _clutter_script_binary_inflate().
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <string.h>
+
+#include <glib.h>
+#include <json-glib/json-glib.h>
+
+#include "clutter-script-private.h"
+
+#include "clutter-debug.h"
+#include "clutter-private.h"
+
+#define BINARY_MAGIC            "CLTSCRPT"
+#define BINARY_MAGIC_LEN        8
+#define BINARY_BYTE_ORDER       0x01020304
+#define BINARY_VERSION          1
+
+#define BINARY_NO_STRING        0
+
+#define BINARY_STRING(binary,offset) \
+  ((offset) == BINARY_NO_STRING ? NULL : (binary)->strings + (offset))
+
+enum
+{
+  BINARY_OBJECT_IS_STAGE         = 1 << 0,
+  BINARY_OBJECT_IS_STAGE_DEFAULT = 1 << 1
+};
+
+typedef enum
+{
+  BINARY_VALUE_NULL,
+  BINARY_VALUE_BOOLEAN,
+  BINARY_VALUE_INT,
+  BINARY_VALUE_DOUBLE,
+  BINARY_VALUE_STRING,
+  BINARY_VALUE_JSON
+} BinaryValueType;
+
+enum
+{
+  BINARY_SIGNAL_AFTER      = 1 << 0,
+  BINARY_SIGNAL_SWAPPED    = 1 << 1,
+  BINARY_SIGNAL_IS_HANDLER = 1 << 2,
+  BINARY_SIGNAL_WARP_TO    = 1 << 3
+};
+
+typedef struct
+{
+  gchar magic[BINARY_MAGIC_LEN];
+  guint32 byte_order;
+  guint32 version;
+  guint32 n_objects;
+  guint32 n_properties;
+  guint32 n_children;
+  guint32 n_signals;
+  guint32 strings_size;
+  guint32 reserved;
+} BinaryHeader;
+
+typedef struct
+{
+  guint32 id;
+  guint32 class_name;
+  guint32 type_func;
+  guint32 type_symbol;
+  guint32 flags;
+  guint32 first_property;
+  guint32 n_properties;
+  guint32 first_child;
+  guint32 n_children;
+  guint32 first_signal;
+  guint32 n_signals;
+} BinaryObject;
+
+typedef struct
+{
+  guint32 name;
+  guint32 type;
+
+  /* a string offset, a boolean, or the bytes of a gint64 or a gdouble,
+   * which might not be aligned
+   */
+  guint32 value[2];
+} BinaryProperty;
+
+typedef struct
+{
+  guint32 name;
+  guint32 handler;
+  guint32 object;
+  guint32 state;
+  guint32 target;
+  guint32 flags;
+} BinarySignal;
+
+G_STATIC_ASSERT (sizeof (BinaryHeader) == 40);
+G_STATIC_ASSERT (sizeof (BinaryObject) == 11 * sizeof (guint32));
+G_STATIC_ASSERT (sizeof (BinaryProperty) == 4 * sizeof (guint32));
+G_STATIC_ASSERT (sizeof (BinarySignal) == 6 * sizeof (guint32));
+
+struct _ClutterScriptBinary
+{
+  volatile gint ref_count;
+
+  GBytes *bytes;
+
+  const BinaryObject *objects;
+  const BinaryProperty *properties;
+  const guint32 *children;
+  const BinarySignal *signals;
+  const gchar *strings;
+
+  /* the merge id of the definitions, used to make the fake ids unique */
+  guint merge_id;
+};
+
+gboolean
+_clutter_script_binary_check (const guint8 *data,
+                              gsize         length)
+{
+  return data != NULL &&
+         length >= sizeof (BinaryHeader) &&
+         memcmp (data, BINARY_MAGIC, BINARY_MAGIC_LEN) == 0;
+}
+
+ClutterScriptBinary *
+_clutter_script_binary_ref (ClutterScriptBinary *binary)
+{
+  g_atomic_int_inc (&binary->ref_count);
+
+  return binary;
+}
+
+void
+_clutter_script_binary_unref (ClutterScriptBinary *binary)
+{
+  if (g_atomic_int_dec_and_test (&binary->ref_count))
+    {
+      g_bytes_unref (binary->bytes);
+      g_slice_free (ClutterScriptBinary, binary);
+    }
+}
+
+/*
+ * Compilation
+ */
+
+typedef struct
+{
+  GArray *objects;
+  GArray *properties;
+  GArray *children;
+  GArray *signals;
+
+  GString *strings;
+  GHashTable *string_offsets;
+
+  JsonGenerator *generator;
+} BinaryWriter;
+
+static guint32
+binary_writer_add_string (BinaryWriter *writer,
+                          const gchar  *str)
+{
+  gpointer offset;
+  guint32 retval;
+
+  if (str == NULL)
+    return BINARY_NO_STRING;
+
+  if (g_hash_table_lookup_extended (writer->string_offsets, str, NULL, &offset))
+    return GPOINTER_TO_UINT (offset);
+
+  retval = writer->strings->len;
+
+  /* keep the terminating NUL */
+  g_string_append_len (writer->strings, str, strlen (str) + 1);
+
+  g_hash_table_insert (writer->string_offsets,
+                       g_strdup (str),
+                       GUINT_TO_POINTER (retval));
+
+  return retval;
+}
+
+static void
+binary_writer_add_property (BinaryWriter *writer,
+                            PropertyInfo *pinfo)
+{
+  BinaryProperty property = { 0, };
+  JsonNode *node = pinfo->node;
+
+  property.name = binary_writer_add_string (writer, pinfo->name);
+
+  switch (JSON_NODE_TYPE (node))
+    {
+    case JSON_NODE_NULL:
+      property.type = BINARY_VALUE_NULL;
+      break;
+
+    case JSON_NODE_VALUE:
+      if (json_node_get_value_type (node) == G_TYPE_INT64)
+        {
+          gint64 v_int = json_node_get_int (node);
+
+          property.type = BINARY_VALUE_INT;
+          memcpy (property.value, &v_int, sizeof (v_int));
+        }
+      else if (json_node_get_value_type (node) == G_TYPE_DOUBLE)
+        {
+          gdouble v_double = json_node_get_double (node);
+
+          property.type = BINARY_VALUE_DOUBLE;
+          memcpy (property.value, &v_double, sizeof (v_double));
+        }
+      else if (json_node_get_value_type (node) == G_TYPE_BOOLEAN)
+        {
+          property.type = BINARY_VALUE_BOOLEAN;
+          property.value[0] = json_node_get_boolean (node) ? 1 : 0;
+        }
+      else
+        {
+          property.type = BINARY_VALUE_STRING;
+          property.value[0] =
+            binary_writer_add_string (writer, json_node_get_string (node));
+        }
+      break;
+
+    case JSON_NODE_OBJECT:
+    case JSON_NODE_ARRAY:
+      {
+        gchar *json;
+
+        /* the nested objects with a type have been given an id by
+         * the parser, and are stored as separate objects as well
+         */
+        json_generator_set_root (writer->generator, node);
+        json = json_generator_to_data (writer->generator, NULL);
+
+        property.type = BINARY_VALUE_JSON;
+        property.value[0] = binary_writer_add_string (writer, json);
+
+        g_free (json);
+      }
+      break;
+    }
+
+  g_array_append_val (writer->properties, property);
+}
+
+static void
+binary_writer_add_signal (BinaryWriter *writer,
+                          SignalInfo   *sinfo)
+{
+  BinarySignal signal = { 0, };
+
+  signal.name = binary_writer_add_string (writer, sinfo->name);
+  signal.handler = binary_writer_add_string (writer, sinfo->handler);
+  signal.object = binary_writer_add_string (writer, sinfo->object);
+  signal.state = binary_writer_add_string (writer, sinfo->state);
+  signal.target = binary_writer_add_string (writer, sinfo->target);
+
+  if (sinfo->flags & G_CONNECT_AFTER)
+    signal.flags |= BINARY_SIGNAL_AFTER;
+
+  if (sinfo->flags & G_CONNECT_SWAPPED)
+    signal.flags |= BINARY_SIGNAL_SWAPPED;
+
+  if (sinfo->is_handler)
+    signal.flags |= BINARY_SIGNAL_IS_HANDLER;
+
+  if (sinfo->warp_to)
+    signal.flags |= BINARY_SIGNAL_WARP_TO;
+
+  g_array_append_val (writer->signals, signal);
+}
+
+static void
+binary_writer_add_object (BinaryWriter *writer,
+                          ObjectInfo   *oinfo)
+{
+  BinaryObject object = { 0, };
+  GList *l;
+
+  object.id = binary_writer_add_string (writer, oinfo->id);
+  object.class_name = binary_writer_add_string (writer, oinfo->class_name);
+  object.type_func = binary_writer_add_string (writer, oinfo->type_func);
+
+  /* building the name of the type function is done only once, here */
+  if (oinfo->type_func == NULL)
+    {
+      gchar *type_symbol;
+
+      type_symbol = _clutter_script_get_type_function_name (oinfo->class_name);
+      object.type_symbol = binary_writer_add_string (writer, type_symbol);
+      g_free (type_symbol);
+    }
+
+  if (oinfo->is_stage)
+    object.flags |= BINARY_OBJECT_IS_STAGE;
+
+  if (oinfo->is_stage_default)
+    object.flags |= BINARY_OBJECT_IS_STAGE_DEFAULT;
+
+  object.first_property = writer->properties->len;
+  for (l = oinfo->properties; l != NULL; l = l->next)
+    binary_writer_add_property (writer, l->data);
+  object.n_properties = writer->properties->len - object.first_property;
+
+  object.first_child = writer->children->len;
+  for (l = oinfo->children; l != NULL; l = l->next)
+    {
+      guint32 child = binary_writer_add_string (writer, l->data);
+
+      g_array_append_val (writer->children, child);
+    }
+  object.n_children = writer->children->len - object.first_child;
+
+  object.first_signal = writer->signals->len;
+  for (l = oinfo->signals; l != NULL; l = l->next)
+    binary_writer_add_signal (writer, l->data);
+  object.n_signals = writer->signals->len - object.first_signal;
+
+  g_array_append_val (writer->objects, object);
+}
+
+static gint
+sort_object_info_by_id (gconstpointer a,
+                        gconstpointer b)
+{
+  const ObjectInfo *oinfo_a = a;
+  const ObjectInfo *oinfo_b = b;
+
+  return strcmp (oinfo_a->id, oinfo_b->id);
+}
+
+/*
+ * _clutter_script_binary_compile:
+ * @object_infos: (element-type ObjectInfo): the definitions to compile
+ *
+ * Serializes the object definitions in @object_infos, which have not
+ * been built
+ *
+ * Return value: the compiled definitions
+ */
+GBytes *
+_clutter_script_binary_compile (GList *object_infos)
+{
+  BinaryHeader header = { { 0, }, };
+  BinaryWriter writer;
+  GByteArray *data;
+  GList *sorted, *l;
+
+  writer.objects = g_array_new (FALSE, FALSE, sizeof (BinaryObject));
+  writer.properties = g_array_new (FALSE, FALSE, sizeof (BinaryProperty));
+  writer.children = g_array_new (FALSE, FALSE, sizeof (guint32));
+  writer.signals = g_array_new (FALSE, FALSE, sizeof (BinarySignal));
+
+  /* the offset 0 is reserved for NULL */
+  writer.strings = g_string_new_len ("", 1);
+  writer.string_offsets = g_hash_table_new_full (g_str_hash, g_str_equal,
+                                                 g_free,
+                                                 NULL);
+
+  writer.generator = json_generator_new ();
+
+  /* the same definitions are always compiled to the same data */
+  sorted = g_list_sort (g_list_copy (object_infos), sort_object_info_by_id);
+
+  for (l = sorted; l != NULL; l = l->next)
+    binary_writer_add_object (&writer, l->data);
+
+  g_list_free (sorted);
+
+  memcpy (header.magic, BINARY_MAGIC, BINARY_MAGIC_LEN);
+  header.byte_order = BINARY_BYTE_ORDER;
+  header.version = BINARY_VERSION;
+  header.n_objects = writer.objects->len;
+  header.n_properties = writer.properties->len;
+  header.n_children = writer.children->len;
+  header.n_signals = writer.signals->len;
+  header.strings_size = writer.strings->len;
+
+  CLUTTER_NOTE (SCRIPT,
+                "Compiled %u objects (properties:%u, children:%u, "
+                "signals:%u, strings:%u bytes)",
+                header.n_objects,
+                header.n_properties,
+                header.n_children,
+                header.n_signals,
+                header.strings_size);
+
+  data = g_byte_array_new ();
+  g_byte_array_append (data, (const guint8 *) &header, sizeof (header));
+  g_byte_array_append (data,
+                       (const guint8 *) writer.objects->data,
+                       writer.objects->len * sizeof (BinaryObject));
+  g_byte_array_append (data,
+                       (const guint8 *) writer.properties->data,
+                       writer.properties->len * sizeof (BinaryProperty));
+  g_byte_array_append (data,
+                       (const guint8 *) writer.children->data,
+                       writer.children->len * sizeof (guint32));
+  g_byte_array_append (data,
+                       (const guint8 *) writer.signals->data,
+                       writer.signals->len * sizeof (BinarySignal));
+  g_byte_array_append (data,
+                       (const guint8 *) writer.strings->str,
+                       writer.strings->len);
+
+  g_array_free (writer.objects, TRUE);
+  g_array_free (writer.properties, TRUE);
+  g_array_free (writer.children, TRUE);
+  g_array_free (writer.signals, TRUE);
+  g_string_free (writer.strings, TRUE);
+  g_hash_table_destroy (writer.string_offsets);
+  g_object_unref (writer.generator);
+
+  return g_byte_array_free_to_bytes (data);
+}
+
+/*
+ * Loading
+ */
+
+static gboolean
+binary_check_string (const BinaryHeader *header,
+                     guint32             offset,
+                     gboolean            allow_null)
+{
+  if (offset == BINARY_NO_STRING)
+    return allow_null;
+
+  return offset < header->strings_size;
+}
+
+static gboolean
+binary_check_range (guint32 first,
+                    guint32 n_items,
+                    guint32 total)
+{
+  return (guint64) first + n_items <= total;
+}
+
+static gboolean
+binary_validate (const BinaryHeader   *header,
+                 const BinaryObject   *objects,
+                 const BinaryProperty *properties,
+                 const guint32        *children,
+                 const BinarySignal   *signals,
+                 const gchar          *strings)
+{
+  guint i;
+
+  /* the strings have to be terminated, including the last one */
+  if (header->strings_size == 0 ||
+      strings[0] != '\0' ||
+      strings[header->strings_size - 1] != '\0')
+    return FALSE;
+
+  for (i = 0; i < header->n_objects; i++)
+    {
+      const BinaryObject *object = &objects[i];
+
+      if (!binary_check_string (header, object->id, FALSE) ||
+          !binary_check_string (header, object->class_name, FALSE) ||
+          !binary_check_string (header, object->type_func, TRUE) ||
+          !binary_check_string (header, object->type_symbol, TRUE))
+        return FALSE;
+
+      if (!binary_check_range (object->first_property,
+                               object->n_properties,
+                               header->n_properties) ||
+          !binary_check_range (object->first_child,
+                               object->n_children,
+                               header->n_children) ||
+          !binary_check_range (object->first_signal,
+                               object->n_signals,
+                               header->n_signals))
+        return FALSE;
+    }
+
+  for (i = 0; i < header->n_properties; i++)
+    {
+      const BinaryProperty *property = &properties[i];
+
+      if (!binary_check_string (header, property->name, FALSE))
+        return FALSE;
+
+      switch (property->type)
+        {
+        case BINARY_VALUE_NULL:
+        case BINARY_VALUE_BOOLEAN:
+        case BINARY_VALUE_INT:
+        case BINARY_VALUE_DOUBLE:
+          break;
+
+        case BINARY_VALUE_STRING:
+        case BINARY_VALUE_JSON:
+          if (!binary_check_string (header, property->value[0], FALSE))
+            return FALSE;
+          break;
+
+        default:
+          return FALSE;
+        }
+    }
+
+  for (i = 0; i < header->n_children; i++)
+    {
+      if (!binary_check_string (header, children[i], FALSE))
+        return FALSE;
+    }
+
+  for (i = 0; i < header->n_signals; i++)
+    {
+      const BinarySignal *signal = &signals[i];
+
+      if (!binary_check_string (header, signal->name, FALSE) ||
+          !binary_check_string (header, signal->handler, TRUE) ||
+          !binary_check_string (header, signal->object, TRUE) ||
+          !binary_check_string (header, signal->state, TRUE) ||
+          !binary_check_string (header, signal->target, TRUE))
+        return FALSE;
+    }
+
+  return TRUE;
+}
+
+static gchar *
+binary_dup_id (ClutterScriptBinary *binary,
+               const gchar         *id_)
+{
+  /* the fake ids generated while compiling have to be unique among
+   * the definitions loaded by the ClutterScript
+   */
+  if (g_str_has_prefix (id_, CLUTTER_SCRIPT_COMPILED_ID_PREFIX))
+    return g_strdup_printf ("script-%u-compiled-%s",
+                            binary->merge_id,
+                            id_ + strlen (CLUTTER_SCRIPT_COMPILED_ID_PREFIX));
+
+  return g_strdup (id_);
+}
+
+static void
+binary_fixup_ids (ClutterScriptBinary *binary,
+                  JsonNode            *node)
+{
+  GList *values, *l;
+
+  switch (JSON_NODE_TYPE (node))
+    {
+    case JSON_NODE_OBJECT:
+      {
+        JsonObject *object = json_node_get_object (node);
+        JsonNode *id_node = json_object_get_member (object, "id");
+
+        if (id_node != NULL &&
+            JSON_NODE_TYPE (id_node) == JSON_NODE_VALUE &&
+            json_node_get_value_type (id_node) == G_TYPE_STRING &&
+            g_str_has_prefix (json_node_get_string (id_node),
+                              CLUTTER_SCRIPT_COMPILED_ID_PREFIX))
+          {
+            gchar *id_ = binary_dup_id (binary, json_node_get_string (id_node));
+
+            json_object_set_string_member (object, "id", id_);
+            g_free (id_);
+          }
+
+        values = json_object_get_values (object);
+      }
+      break;
+
+    case JSON_NODE_ARRAY:
+      values = json_array_get_elements (json_node_get_array (node));
+      break;
+
+    default:
+      return;
+    }
+
+  for (l = values; l != NULL; l = l->next)
+    binary_fixup_ids (binary, l->data);
+
+  g_list_free (values);
+}
+
+static JsonNode *
+binary_property_get_node (ClutterScriptBinary  *binary,
+                          const BinaryProperty *property)
+{
+  JsonNode *retval = NULL;
+
+  switch (property->type)
+    {
+    case BINARY_VALUE_NULL:
+      retval = json_node_new (JSON_NODE_NULL);
+      break;
+
+    case BINARY_VALUE_BOOLEAN:
+      retval = json_node_new (JSON_NODE_VALUE);
+      json_node_set_boolean (retval, property->value[0] != 0);
+      break;
+
+    case BINARY_VALUE_INT:
+      {
+        gint64 v_int;
+
+        memcpy (&v_int, property->value, sizeof (v_int));
+
+        retval = json_node_new (JSON_NODE_VALUE);
+        json_node_set_int (retval, v_int);
+      }
+      break;
+
+    case BINARY_VALUE_DOUBLE:
+      {
+        gdouble v_double;
+
+        memcpy (&v_double, property->value, sizeof (v_double));
+
+        retval = json_node_new (JSON_NODE_VALUE);
+        json_node_set_double (retval, v_double);
+      }
+      break;
+
+    case BINARY_VALUE_STRING:
+      retval = json_node_new (JSON_NODE_VALUE);
+      json_node_set_string (retval, BINARY_STRING (binary, property->value[0]));
+      break;
+
+    case BINARY_VALUE_JSON:
+      {
+        JsonParser *parser = json_parser_new ();
+        GError *error = NULL;
+
+        if (json_parser_load_from_data (parser,
+                                        BINARY_STRING (binary, property->value[0]),
+                                        -1,
+                                        &error))
+          {
+            retval = json_node_copy (json_parser_get_root (parser));
+            binary_fixup_ids (binary, retval);
+          }
+        else
+          {
+            g_warning ("Unable to parse the value of the property '%s': %s",
+                       BINARY_STRING (binary, property->name),
+                       error->message);
+            g_error_free (error);
+          }
+
+        g_object_unref (parser);
+      }
+      break;
+    }
+
+  return retval;
+}
+
+static void
+binary_inflate_signals (ClutterScriptBinary *binary,
+                        const BinaryObject  *object,
+                        ObjectInfo          *oinfo)
+{
+  GList *signals = NULL;
+  guint i;
+
+  for (i = object->n_signals; i > 0; i--)
+    {
+      const BinarySignal *signal = &binary->signals[object->first_signal + i - 1];
+      SignalInfo *sinfo = g_slice_new0 (SignalInfo);
+
+      sinfo->name = g_strdup (BINARY_STRING (binary, signal->name));
+      sinfo->handler = g_strdup (BINARY_STRING (binary, signal->handler));
+      sinfo->object = g_strdup (BINARY_STRING (binary, signal->object));
+      sinfo->state = g_strdup (BINARY_STRING (binary, signal->state));
+      sinfo->target = g_strdup (BINARY_STRING (binary, signal->target));
+
+      if (signal->flags & BINARY_SIGNAL_AFTER)
+        sinfo->flags |= G_CONNECT_AFTER;
+
+      if (signal->flags & BINARY_SIGNAL_SWAPPED)
+        sinfo->flags |= G_CONNECT_SWAPPED;
+
+      sinfo->is_handler = (signal->flags & BINARY_SIGNAL_IS_HANDLER) != 0;
+      sinfo->warp_to = (signal->flags & BINARY_SIGNAL_WARP_TO) != 0;
+
+      signals = g_list_prepend (signals, sinfo);
+    }
+
+  /* like the parser does, the new signals go first */
+  oinfo->signals = g_list_concat (signals, oinfo->signals);
+}
+
+static void
+binary_inflate_object (ClutterScriptBinary *binary,
+                       const BinaryObject  *object,
+                       ObjectInfo          *oinfo)
+{
+  GList *properties = NULL, *children = NULL;
+  guint i;
+
+  for (i = object->n_properties; i > 0; i--)
+    {
+      const BinaryProperty *property;
+      PropertyInfo *pinfo;
+      JsonNode *node;
+
+      property = &binary->properties[object->first_property + i - 1];
+
+      node = binary_property_get_node (binary, property);
+      if (node == NULL)
+        continue;
+
+      pinfo = g_slice_new0 (PropertyInfo);
+      pinfo->name = g_strdup (BINARY_STRING (binary, property->name));
+      pinfo->node = node;
+      pinfo->is_child = g_str_has_prefix (pinfo->name, "child::") ? TRUE : FALSE;
+      pinfo->is_layout = g_str_has_prefix (pinfo->name, "layout::") ? TRUE : FALSE;
+
+      properties = g_list_prepend (properties, pinfo);
+    }
+
+  oinfo->properties = g_list_concat (properties, oinfo->properties);
+
+  for (i = object->n_children; i > 0; i--)
+    {
+      guint32 child = binary->children[object->first_child + i - 1];
+
+      children = g_list_prepend (children,
+                                 binary_dup_id (binary, BINARY_STRING (binary, child)));
+    }
+
+  oinfo->children = g_list_concat (oinfo->children, children);
+}
+
+/*
+ * _clutter_script_binary_inflate:
+ * @script: a #ClutterScript
+ * @oinfo: a #ObjectInfo loaded from a compiled UI definition
+ *
+ * Expands the properties and the children of the compiled definition
+ * of @oinfo, before building the object
+ */
+void
+_clutter_script_binary_inflate (ClutterScript *script,
+                                ObjectInfo    *oinfo)
+{
+  ClutterScriptBinary *binary = oinfo->binary;
+
+  g_assert (binary != NULL);
+
+  CLUTTER_NOTE (SCRIPT, "Expanding the compiled definition of '%s'",
+                oinfo->id);
+
+  oinfo->binary = NULL;
+
+  binary_inflate_object (binary, &binary->objects[oinfo->binary_index], oinfo);
+
+  _clutter_script_binary_unref (binary);
+}
+
+/*
+ * _clutter_script_binary_load:
+ * @script: a #ClutterScript
+ * @bytes: the compiled UI definition
+ * @error: return location for a #GError, or %NULL
+ *
+ * Adds the objects defined inside @bytes to @script, without building
+ * them. The merge id of @script must have been updated already
+ *
+ * Return value: %TRUE if the UI definition is valid
+ */
+gboolean
+_clutter_script_binary_load (ClutterScript  *script,
+                             GBytes         *bytes,
+                             GError        **error)
+{
+  ClutterScriptBinary *binary;
+  const BinaryHeader *header;
+  const guint8 *data;
+  guint64 size;
+  gsize length;
+  guint i;
+
+  data = g_bytes_get_data (bytes, &length);
+
+  g_assert (_clutter_script_binary_check (data, length));
+
+  /* the data is used in place, so it has to be aligned; this is always
+   * the case for mapped files and for allocated buffers
+   */
+  if ((GPOINTER_TO_SIZE (data) % sizeof (guint32)) != 0)
+    {
+      bytes = g_bytes_new (data, length);
+      data = g_bytes_get_data (bytes, &length);
+    }
+  else
+    g_bytes_ref (bytes);
+
+  header = (const BinaryHeader *) data;
+
+  if (header->byte_order != BINARY_BYTE_ORDER ||
+      header->version != BINARY_VERSION)
+    {
+      g_set_error (error, CLUTTER_SCRIPT_ERROR,
+                   CLUTTER_SCRIPT_ERROR_INVALID_COMPILED_DATA,
+                   "The UI definition was compiled for a different "
+                   "version of Clutter, or a different platform");
+      g_bytes_unref (bytes);
+      return FALSE;
+    }
+
+  size = sizeof (BinaryHeader)
+       + (guint64) header->n_objects * sizeof (BinaryObject)
+       + (guint64) header->n_properties * sizeof (BinaryProperty)
+       + (guint64) header->n_children * sizeof (guint32)
+       + (guint64) header->n_signals * sizeof (BinarySignal)
+       + (guint64) header->strings_size;
+
+  if (size != length)
+    {
+      g_set_error (error, CLUTTER_SCRIPT_ERROR,
+                   CLUTTER_SCRIPT_ERROR_INVALID_COMPILED_DATA,
+                   "The compiled UI definition has an invalid size");
+      g_bytes_unref (bytes);
+      return FALSE;
+    }
+
+  binary = g_slice_new0 (ClutterScriptBinary);
+  binary->ref_count = 1;
+  binary->bytes = bytes;
+  binary->merge_id = _clutter_script_get_last_merge_id (script);
+
+  binary->objects = (const BinaryObject *) (header + 1);
+  binary->properties = (const BinaryProperty *) (binary->objects + header->n_objects);
+  binary->children = (const guint32 *) (binary->properties + header->n_properties);
+  binary->signals = (const BinarySignal *) (binary->children + header->n_children);
+  binary->strings = (const gchar *) (binary->signals + header->n_signals);
+
+  /* the definitions are expanded later on, so everything is checked
+   * before adding any object
+   */
+  if (!binary_validate (header,
+                        binary->objects,
+                        binary->properties,
+                        binary->children,
+                        binary->signals,
+                        binary->strings))
+    {
+      g_set_error (error, CLUTTER_SCRIPT_ERROR,
+                   CLUTTER_SCRIPT_ERROR_INVALID_COMPILED_DATA,
+                   "The compiled UI definition is corrupted");
+      _clutter_script_binary_unref (binary);
+      return FALSE;
+    }
+
+  CLUTTER_NOTE (SCRIPT, "Loading %u compiled objects (merge-id:%u)",
+                header->n_objects,
+                binary->merge_id);
+
+  for (i = 0; i < header->n_objects; i++)
+    {
+      const BinaryObject *object = &binary->objects[i];
+      ObjectInfo *oinfo;
+      gchar *id_;
+
+      id_ = binary_dup_id (binary, BINARY_STRING (binary, object->id));
+
+      oinfo = _clutter_script_get_object_info (script, id_);
+      if (oinfo != NULL)
+        {
+          /* like the parser does, a definition using an existing id
+           * is merged into the existing one
+           */
+          if (oinfo->binary != NULL)
+            _clutter_script_binary_inflate (script, oinfo);
+
+          binary_inflate_object (binary, object, oinfo);
+          binary_inflate_signals (binary, object, oinfo);
+
+          oinfo->has_unresolved = TRUE;
+
+          g_free (id_);
+          continue;
+        }
+
+      oinfo = g_slice_new0 (ObjectInfo);
+      oinfo->merge_id = binary->merge_id;
+      oinfo->id = id_;
+      oinfo->class_name = g_strdup (BINARY_STRING (binary, object->class_name));
+      oinfo->type_func = g_strdup (BINARY_STRING (binary, object->type_func));
+      oinfo->type_symbol = g_strdup (BINARY_STRING (binary, object->type_symbol));
+
+      if (object->flags & BINARY_OBJECT_IS_STAGE)
+        {
+          oinfo->is_actor = TRUE;
+          oinfo->is_stage = TRUE;
+          oinfo->is_stage_default =
+            (object->flags & BINARY_OBJECT_IS_STAGE_DEFAULT) != 0;
+        }
+
+      /* the signals are needed to know which objects have to be built
+       * by clutter_script_connect_signals()
+       */
+      binary_inflate_signals (binary, object, oinfo);
+
+      oinfo->binary = _clutter_script_binary_ref (binary);
+      oinfo->binary_index = i;
+
+      oinfo->has_unresolved = TRUE;
+      oinfo->is_lazy = TRUE;
+
+      _clutter_script_add_object_info (script, oinfo);
+    }
+
+  _clutter_script_binary_unref (binary);
+
+  return TRUE;
+}
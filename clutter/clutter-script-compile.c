@@ -0,0 +1,141 @@
+/*
+ * Clutter.
+ *
+ * An OpenGL based 'interactive canvas' library.
+ *
+ * Copyright (C) 2013  Intel Corporation.
+ *
+ * This library is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this library. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/* clutter-script-compile: compiles a ClutterScript UI definition
+ *
+ *   clutter-script-compile [--output FILE] DEFINITION.json
+ *
+ * The output can be loaded using clutter_script_load_from_file(),
+ * clutter_script_load_from_data() or clutter_script_load_from_resource()
+ * in place of the JSON file.
+ */
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <clutter/clutter.h>
+
+static gchar *output = NULL;
+static gchar **input = NULL;
+
+static GOptionEntry entries[] = {
+  {
+    "output", 'o',
+    0,
+    G_OPTION_ARG_FILENAME, &output,
+    "Write the compiled definition to FILE", "FILE"
+  },
+  {
+    G_OPTION_REMAINING, 0,
+    0,
+    G_OPTION_ARG_FILENAME_ARRAY, &input,
+    NULL, "DEFINITION"
+  },
+  { NULL }
+};
+
+int
+main (int argc, char *argv[])
+{
+  GOptionContext *context;
+  GError *error = NULL;
+  gchar *contents = NULL;
+  gsize length = 0;
+  GBytes *compiled;
+  gboolean res;
+
+#if !GLIB_CHECK_VERSION (2, 35, 1)
+  g_type_init ();
+#endif
+
+  context = g_option_context_new ("- compile a ClutterScript UI definition");
+  g_option_context_add_main_entries (context, entries, NULL);
+
+  if (!g_option_context_parse (context, &argc, &argv, &error))
+    {
+      g_printerr ("%s: %s\n", g_get_prgname (), error->message);
+      g_error_free (error);
+      return EXIT_FAILURE;
+    }
+
+  g_option_context_free (context);
+
+  if (input == NULL || input[0] == NULL || input[1] != NULL)
+    {
+      g_printerr ("%s: a single UI definition is required\n",
+                  g_get_prgname ());
+      return EXIT_FAILURE;
+    }
+
+  if (!g_file_get_contents (input[0], &contents, &length, &error))
+    {
+      g_printerr ("%s: %s\n", g_get_prgname (), error->message);
+      g_error_free (error);
+      return EXIT_FAILURE;
+    }
+
+  /* no object is built while compiling, so there is no need to
+   * initialize Clutter
+   */
+  compiled = clutter_script_compile_data (contents, length, &error);
+  g_free (contents);
+
+  if (compiled == NULL)
+    {
+      g_printerr ("%s: %s: %s\n", g_get_prgname (), input[0], error->message);
+      g_error_free (error);
+      return EXIT_FAILURE;
+    }
+
+  if (output == NULL)
+    {
+      const gchar *suffix = g_str_has_suffix (input[0], ".json") ? ".json" : NULL;
+      gchar *base;
+
+      base = suffix != NULL
+           ? g_strndup (input[0], strlen (input[0]) - strlen (suffix))
+           : g_strdup (input[0]);
+      output = g_strconcat (base, ".cscript", NULL);
+      g_free (base);
+    }
+
+  res = g_file_set_contents (output,
+                             g_bytes_get_data (compiled, NULL),
+                             g_bytes_get_size (compiled),
+                             &error);
+  g_bytes_unref (compiled);
+
+  if (!res)
+    {
+      g_printerr ("%s: %s\n", g_get_prgname (), error->message);
+      g_error_free (error);
+      return EXIT_FAILURE;
+    }
+
+  g_free (output);
+  g_strfreev (input);
+
+  return EXIT_SUCCESS;
+}
@@ -88,19 +88,12 @@ _clutter_script_get_type_from_symbol (const gchar *symbol)
   return gtype;
 }
 
-GType
-_clutter_script_get_type_from_class (const gchar *name)
+gchar *
+_clutter_script_get_type_function_name (const gchar *name)
 {
-  static GModule *module = NULL;
   GString *symbol_name = g_string_sized_new (64);
-  GType gtype = G_TYPE_INVALID;
-  GTypeGetFunc func;
-  gchar *symbol;
   gint i;
 
-  if (G_UNLIKELY (!module))
-    module = g_module_open (NULL, 0);
-  
   for (i = 0; name[i] != '\0'; i++)
     {
       gchar c = name[i];
@@ -138,8 +131,22 @@ _clutter_script_get_type_from_class (const gchar *name)
     }
 
   g_string_append (symbol_name, "_get_type");
-  
-  symbol = g_string_free (symbol_name, FALSE);
+
+  return g_string_free (symbol_name, FALSE);
+}
+
+GType
+_clutter_script_get_type_from_class (const gchar *name)
+{
+  static GModule *module = NULL;
+  GType gtype = G_TYPE_INVALID;
+  GTypeGetFunc func;
+  gchar *symbol;
+
+  if (G_UNLIKELY (!module))
+    module = g_module_open (NULL, 0);
+
+  symbol = _clutter_script_get_type_function_name (name);
 
   if (g_module_symbol (module, symbol, (gpointer)&func))
     {
@@ -1188,13 +1195,24 @@ clutter_script_parser_object_end (JsonParser *json_parser,
                 g_list_length (oinfo->signals));
 
   _clutter_script_add_object_info (script, oinfo);
-  _clutter_script_construct_object (script, oinfo);
+
+  /* the objects of a definition being compiled are never built */
+  if (!_clutter_script_is_compiling (script))
+    _clutter_script_construct_object (script, oinfo);
 }
 
 static void
 clutter_script_parser_parse_end (JsonParser *parser)
 {
-  clutter_script_ensure_objects (CLUTTER_SCRIPT_PARSER (parser)->script);
+  ClutterScript *script = CLUTTER_SCRIPT_PARSER (parser)->script;
+
+  /* building the objects would consume their definitions, which have
+   * to be serialized intact
+   */
+  if (_clutter_script_is_compiling (script))
+    return;
+
+  clutter_script_ensure_objects (script);
 }
 
 gboolean
@@ -2020,6 +2038,12 @@ add_children (ClutterScript *script,
                     g_type_name (G_OBJECT_TYPE (container)));
 
       clutter_container_add_actor (container, CLUTTER_ACTOR (object));
+
+      /* the child and layout properties of the child can be applied
+       * now that it has a parent
+       */
+      if (child_info->has_unresolved)
+        _clutter_script_queue_object (script, child_info);
     }
 
   g_list_foreach (oinfo->children, (GFunc) g_free, NULL);
@@ -2160,10 +2184,29 @@ _clutter_script_construct_object (ClutterScript *script,
       return;
     }
 
+  /* the definitions loaded from a compiled UI definition are only
+   * expanded the first time the object is needed
+   */
+  if (oinfo->binary != NULL)
+    _clutter_script_binary_inflate (script, oinfo);
+
   if (oinfo->gtype == G_TYPE_INVALID)
     {
       if (G_UNLIKELY (oinfo->type_func))
         oinfo->gtype = _clutter_script_get_type_from_symbol (oinfo->type_func);
+      else if (oinfo->type_symbol != NULL)
+        {
+          /* skip building the name of the type function if the
+           * type has already been registered
+           */
+          oinfo->gtype = g_type_from_name (oinfo->class_name);
+
+          if (oinfo->gtype == G_TYPE_INVALID)
+            oinfo->gtype = _clutter_script_get_type_from_symbol (oinfo->type_symbol);
+
+          if (oinfo->gtype == G_TYPE_INVALID)
+            oinfo->gtype = clutter_script_get_type_from_name (script, oinfo->class_name);
+        }
       else
         oinfo->gtype = clutter_script_get_type_from_name (script, oinfo->class_name);
 
@@ -2252,4 +2295,15 @@ _clutter_script_construct_object (ClutterScript *script,
                             g_free);
 
   _clutter_script_check_unresolved (script, oinfo);
+
+  /* nobody else is going to apply the properties of an object built
+   * on demand, since the parser is not running
+   */
+  if (oinfo->is_lazy)
+    {
+      oinfo->is_lazy = FALSE;
+
+      if (oinfo->has_unresolved)
+        _clutter_script_queue_object (script, oinfo);
+    }
 }
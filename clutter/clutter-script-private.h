@@ -52,11 +52,21 @@ struct _ClutterScriptParser
 
 typedef GType (* GTypeGetFunc) (void);
 
+typedef struct _ClutterScriptBinary     ClutterScriptBinary;
+
+/* the prefix of the fake ids generated while compiling a UI definition;
+ * they are made unique when the compiled definition is loaded
+ */
+#define CLUTTER_SCRIPT_COMPILED_ID_PREFIX       "script-compiled-"
+
 typedef struct {
   gchar *id;
   gchar *class_name;
   gchar *type_func;
 
+  /* the name of the type function, computed when compiling */
+  gchar *type_symbol;
+
   GList *properties;
   GList *children;
   GList *signals;
@@ -66,11 +76,16 @@ typedef struct {
 
   guint merge_id;
 
+  /* the compiled definition of the object, until it is constructed */
+  ClutterScriptBinary *binary;
+  guint binary_index;
+
   guint is_actor         : 1;
   guint is_stage         : 1;
   guint is_stage_default : 1;
   guint has_unresolved   : 1;
   guint is_unmerged      : 1;
+  guint is_lazy          : 1;
 } ObjectInfo;
 
 void object_info_free (gpointer data);
@@ -109,6 +124,7 @@ gboolean _clutter_script_parse_node        (ClutterScript *script,
 
 GType    _clutter_script_get_type_from_symbol (const gchar *symbol);
 GType    _clutter_script_get_type_from_class  (const gchar *name);
+gchar *  _clutter_script_get_type_function_name (const gchar *name);
 
 gulong   _clutter_script_resolve_animation_mode (JsonNode *node);
 
@@ -167,6 +183,23 @@ void _clutter_script_add_object_info (ClutterScript *script,
 
 const gchar *_clutter_script_get_id_from_node (JsonNode *node);
 
+gboolean _clutter_script_is_compiling (ClutterScript *script);
+void     _clutter_script_resolve_objects (ClutterScript *script);
+void     _clutter_script_queue_object (ClutterScript *script,
+                                       ObjectInfo    *oinfo);
+
+/* compiled UI definitions */
+gboolean             _clutter_script_binary_check   (const guint8  *data,
+                                                     gsize          length);
+GBytes *             _clutter_script_binary_compile (GList         *object_infos);
+gboolean             _clutter_script_binary_load    (ClutterScript *script,
+                                                     GBytes        *bytes,
+                                                     GError       **error);
+void                 _clutter_script_binary_inflate (ClutterScript *script,
+                                                     ObjectInfo    *oinfo);
+ClutterScriptBinary *_clutter_script_binary_ref     (ClutterScriptBinary *binary);
+void                 _clutter_script_binary_unref   (ClutterScriptBinary *binary);
+
 G_END_DECLS
 
 #endif /* __CLUTTER_SCRIPT_PRIVATE_H__ */
@@ -218,6 +218,24 @@
  *                   of creating a new #ClutterStage instance
  * ]]></programlisting>
  *
+ * <refsect2 id="ClutterScript-compiled">
+ *   <title>Compiled UI definitions</title>
+ *   <para>UI definitions can be compiled ahead of time into a binary
+ *   form using clutter_script_compile_data(), or the
+ *   <command>clutter-script-compile</command> tool. A compiled UI
+ *   definition is loaded by the same functions loading JSON data, and
+ *   it is used in place when loaded from a file or a resource, without
+ *   copying it.</para>
+ *   <para>The objects defined inside a compiled UI definition are not
+ *   built when it is loaded, but the first time they are retrieved
+ *   using clutter_script_get_object(), or when they are needed by
+ *   another object, for instance as one of its children. Building a
+ *   container will build its children as well.</para>
+ *   <para>The binary format depends on the byte order of the platform,
+ *   and on the version of Clutter; the UI definitions should be compiled
+ *   as part of the build of the application using them.</para>
+ * </refsect2>
+ *
  * #ClutterScript is available since Clutter 0.6
  */
 
@@ -284,7 +302,12 @@ struct _ClutterScriptPrivate
   gchar *translation_domain;
 
   gchar *filename;
+
+  /* the ids of the objects whose properties have to be applied again */
+  GQueue pending;
+
   guint is_filename : 1;
+  guint is_compiling : 1;
 };
 
 G_DEFINE_TYPE (ClutterScript, clutter_script, G_TYPE_OBJECT);
@@ -348,6 +371,10 @@ object_info_free (gpointer data)
       g_free (oinfo->id);
       g_free (oinfo->class_name);
       g_free (oinfo->type_func);
+      g_free (oinfo->type_symbol);
+
+      if (oinfo->binary != NULL)
+        _clutter_script_binary_unref (oinfo->binary);
 
       g_list_foreach (oinfo->properties, (GFunc) property_info_free, NULL);
       g_list_free (oinfo->properties);
@@ -392,6 +419,9 @@ clutter_script_finalize (GObject *gobject)
   g_hash_table_destroy (priv->states);
   g_free (priv->translation_domain);
 
+  g_queue_foreach (&priv->pending, (GFunc) g_free, NULL);
+  g_queue_clear (&priv->pending);
+
   G_OBJECT_CLASS (clutter_script_parent_class)->finalize (gobject);
 }
 
@@ -529,6 +559,8 @@ clutter_script_init (ClutterScript *script)
   priv->states = g_hash_table_new_full (g_str_hash, g_str_equal,
                                         g_free,
                                         (GDestroyNotify) g_object_unref);
+
+  g_queue_init (&priv->pending);
 }
 
 /**
@@ -551,6 +583,58 @@ clutter_script_new (void)
   return g_object_new (CLUTTER_TYPE_SCRIPT, NULL);
 }
 
+static void
+clutter_script_apply_pending (ClutterScript *script)
+{
+  ClutterScriptPrivate *priv = script->priv;
+  gchar *id_;
+
+  /* applying the properties of an object can build more objects,
+   * which will be added to the queue
+   */
+  while ((id_ = g_queue_pop_head (&priv->pending)) != NULL)
+    {
+      ObjectInfo *oinfo = g_hash_table_lookup (priv->objects, id_);
+
+      if (oinfo != NULL && oinfo->object != NULL)
+        _clutter_script_apply_properties (script, oinfo);
+
+      g_free (id_);
+    }
+}
+
+static guint
+clutter_script_load_from_bytes (ClutterScript  *script,
+                                GBytes         *bytes,
+                                GError        **error)
+{
+  ClutterScriptPrivate *priv = script->priv;
+
+  if (priv->is_compiling)
+    {
+      g_set_error_literal (error, CLUTTER_SCRIPT_ERROR,
+                           CLUTTER_SCRIPT_ERROR_INVALID_COMPILED_DATA,
+                           "The UI definition is already compiled");
+      return 0;
+    }
+
+  priv->last_merge_id += 1;
+
+  if (!_clutter_script_binary_load (script, bytes, error))
+    {
+      priv->last_merge_id -= 1;
+      return 0;
+    }
+
+  /* the objects are built when they are first needed; we only have
+   * to update the objects that were already built, in case the
+   * definitions have been merged into them
+   */
+  _clutter_script_resolve_objects (script);
+
+  return priv->last_merge_id;
+}
+
 /**
  * clutter_script_load_from_file:
  * @script: a #ClutterScript
@@ -573,6 +657,7 @@ clutter_script_load_from_file (ClutterScript  *script,
 {
   ClutterScriptPrivate *priv;
   GError *internal_error;
+  GMappedFile *mapped_file;
 
   g_return_val_if_fail (CLUTTER_IS_SCRIPT (script), 0);
   g_return_val_if_fail (filename != NULL, 0);
@@ -582,6 +667,31 @@ clutter_script_load_from_file (ClutterScript  *script,
   g_free (priv->filename);
   priv->filename = g_strdup (filename);
   priv->is_filename = TRUE;
+
+  /* compiled UI definitions are used straight from the mapped file */
+  mapped_file = g_mapped_file_new (filename, FALSE, NULL);
+  if (mapped_file != NULL)
+    {
+      const gchar *contents = g_mapped_file_get_contents (mapped_file);
+      gsize length = g_mapped_file_get_length (mapped_file);
+
+      if (_clutter_script_binary_check ((const guint8 *) contents, length))
+        {
+          GBytes *bytes;
+          guint res;
+
+          bytes = g_bytes_new_with_free_func (contents, length,
+                                              (GDestroyNotify) g_mapped_file_unref,
+                                              mapped_file);
+          res = clutter_script_load_from_bytes (script, bytes, error);
+          g_bytes_unref (bytes);
+
+          return res;
+        }
+
+      g_mapped_file_unref (mapped_file);
+    }
+
   priv->last_merge_id += 1;
 
   internal_error = NULL;
@@ -635,6 +745,22 @@ clutter_script_load_from_data (ClutterScript  *script,
   g_free (priv->filename);
   priv->filename = NULL;
   priv->is_filename = FALSE;
+
+  if (_clutter_script_binary_check ((const guint8 *) data, length))
+    {
+      GBytes *bytes;
+      guint res;
+
+      /* the objects are built after this function returns, so we
+       * need to keep a copy of the data around
+       */
+      bytes = g_bytes_new (data, length);
+      res = clutter_script_load_from_bytes (script, bytes, error);
+      g_bytes_unref (bytes);
+
+      return res;
+    }
+
   priv->last_merge_id += 1;
 
   internal_error = NULL;
@@ -680,6 +806,20 @@ clutter_script_load_from_resource (ClutterScript  *script,
   if (data == NULL)
     return 0;
 
+  /* compiled UI definitions are used straight from the resource */
+  if (_clutter_script_binary_check (g_bytes_get_data (data, NULL),
+                                    g_bytes_get_size (data)))
+    {
+      g_free (script->priv->filename);
+      script->priv->filename = NULL;
+      script->priv->is_filename = FALSE;
+
+      res = clutter_script_load_from_bytes (script, data, error);
+      g_bytes_unref (data);
+
+      return res;
+    }
+
   res = clutter_script_load_from_data (script,
                                        g_bytes_get_data (data, NULL),
                                        g_bytes_get_size (data),
@@ -690,6 +830,52 @@ clutter_script_load_from_resource (ClutterScript  *script,
   return res;
 }
 
+/**
+ * clutter_script_compile_data:
+ * @data: a buffer containing the definitions
+ * @length: the length of the buffer, or -1 if @data is a NUL-terminated
+ *   buffer
+ * @error: return location for a #GError, or %NULL
+ *
+ * Compiles the JSON definitions inside @data into a binary form that
+ * can be loaded by clutter_script_load_from_file(),
+ * clutter_script_load_from_data() and clutter_script_load_from_resource()
+ * without parsing the JSON data again.
+ *
+ * No object is built while compiling the definitions, so the types
+ * of the objects do not need to be available.
+ *
+ * Return value: (transfer full): the compiled definitions, or %NULL
+ *   on error. Use g_bytes_unref() when done
+ *
+ * Since: 1.14
+ */
+GBytes *
+clutter_script_compile_data (const gchar  *data,
+                             gssize        length,
+                             GError      **error)
+{
+  ClutterScript *script;
+  GBytes *retval = NULL;
+
+  g_return_val_if_fail (data != NULL, NULL);
+
+  script = g_object_new (CLUTTER_TYPE_SCRIPT, NULL);
+  script->priv->is_compiling = TRUE;
+
+  if (clutter_script_load_from_data (script, data, length, error) != 0)
+    {
+      GList *object_infos = g_hash_table_get_values (script->priv->objects);
+
+      retval = _clutter_script_binary_compile (object_infos);
+      g_list_free (object_infos);
+    }
+
+  g_object_unref (script);
+
+  return retval;
+}
+
 /**
  * clutter_script_get_object:
  * @script: a #ClutterScript
@@ -719,6 +905,11 @@ clutter_script_get_object (ClutterScript *script,
   _clutter_script_construct_object (script, oinfo);
   _clutter_script_apply_properties (script, oinfo);
 
+  /* the objects built on demand along with this one, like its
+   * children, are ready as well
+   */
+  clutter_script_apply_pending (script);
+
   return oinfo->object;
 }
 
@@ -854,17 +1045,29 @@ clutter_script_unmerge_objects (ClutterScript *script,
   g_slist_foreach (data.ids, (GFunc) g_free, NULL);
   g_slist_free (data.ids);
 
-  clutter_script_ensure_objects (script);
+  _clutter_script_resolve_objects (script);
 }
 
+typedef struct {
+  ClutterScript *script;
+  gboolean build_lazy;
+} ConstructData;
+
 static void
 construct_each_objects (gpointer key,
                         gpointer value,
                         gpointer user_data)
 {
-  ClutterScript *script = user_data;
+  ConstructData *construct_data = user_data;
+  ClutterScript *script = construct_data->script;
   ObjectInfo *oinfo = value;
 
+  /* the objects loaded from a compiled UI definition are only built
+   * on demand
+   */
+  if (oinfo->is_lazy && !construct_data->build_lazy)
+    return;
+
   /* we have unfinished business */
   if (oinfo->has_unresolved)
     {
@@ -881,6 +1084,28 @@ construct_each_objects (gpointer key,
     }
 }
 
+/*
+ * _clutter_script_resolve_objects:
+ * @script: a #ClutterScript
+ *
+ * Completes the objects that have already been built, without
+ * building the objects loaded from a compiled UI definition
+ */
+void
+_clutter_script_resolve_objects (ClutterScript *script)
+{
+  ConstructData data;
+
+  if (script->priv->is_compiling)
+    return;
+
+  data.script = script;
+  data.build_lazy = FALSE;
+  g_hash_table_foreach (script->priv->objects, construct_each_objects, &data);
+
+  clutter_script_apply_pending (script);
+}
+
 /**
  * clutter_script_ensure_objects:
  * @script: a #ClutterScript
@@ -888,17 +1113,28 @@ construct_each_objects (gpointer key,
  * Ensure that every object defined inside @script is correctly
  * constructed. You should rarely need to use this function.
  *
+ * The objects loaded from a compiled UI definition, which are
+ * otherwise built the first time they are needed, are built as
+ * well.
+ *
  * Since: 0.6
  */
 void
 clutter_script_ensure_objects (ClutterScript *script)
 {
-  ClutterScriptPrivate *priv;
+  ConstructData data;
 
   g_return_if_fail (CLUTTER_IS_SCRIPT (script));
 
-  priv = script->priv;
-  g_hash_table_foreach (priv->objects, construct_each_objects, script);
+  /* the objects of a definition being compiled are never built */
+  if (script->priv->is_compiling)
+    return;
+
+  data.script = script;
+  data.build_lazy = TRUE;
+  g_hash_table_foreach (script->priv->objects, construct_each_objects, &data);
+
+  clutter_script_apply_pending (script);
 }
 
 /**
@@ -1115,10 +1351,22 @@ connect_each_object (gpointer key,
   SignalConnectData *connect_data = data;
   ClutterScript *script = connect_data->script;
   ObjectInfo *oinfo = value;
-  GObject *object = oinfo->object;
+  GObject *object;
   GList *unresolved, *l;
 
+  /* there is no reason to build an object on demand if it has
+   * no signals to connect
+   */
+  if (oinfo->signals == NULL)
+    return;
+
   _clutter_script_construct_object (script, oinfo);
+  _clutter_script_apply_properties (script, oinfo);
+  clutter_script_apply_pending (script);
+
+  object = oinfo->object;
+  if (object == NULL)
+    return;
 
   unresolved = NULL;
   for (l = oinfo->signals; l != NULL; l = l->next)
@@ -1555,6 +1803,13 @@ _clutter_script_generate_fake_id (ClutterScript *script)
 {
   ClutterScriptPrivate *priv = script->priv;
 
+  /* the merge id is not known until the compiled definition is
+   * loaded, so we use a placeholder that is replaced at that time
+   */
+  if (priv->is_compiling)
+    return g_strdup_printf (CLUTTER_SCRIPT_COMPILED_ID_PREFIX "%d",
+                            priv->last_unknown++);
+
   return g_strdup_printf ("script-%d-%d",
                           priv->last_merge_id,
                           priv->last_unknown++);
@@ -1690,3 +1945,33 @@ _clutter_script_add_object_info (ClutterScript *script,
   g_hash_table_steal (priv->objects, oinfo->id);
   g_hash_table_insert (priv->objects, oinfo->id, oinfo);
 }
+
+/*
+ * _clutter_script_is_compiling:
+ * @script: a #ClutterScript
+ *
+ * Checks whether @script is only parsing a UI definition to compile
+ * it, in which case no object should be built
+ *
+ * Return value: %TRUE if the UI definition is being compiled
+ */
+gboolean
+_clutter_script_is_compiling (ClutterScript *script)
+{
+  return script->priv->is_compiling;
+}
+
+/*
+ * _clutter_script_queue_object:
+ * @script: a #ClutterScript
+ * @oinfo: a #ObjectInfo
+ *
+ * Queues the properties of the object in @oinfo to be applied again
+ * once the object currently being built is complete
+ */
+void
+_clutter_script_queue_object (ClutterScript *script,
+                              ObjectInfo    *oinfo)
+{
+  g_queue_push_tail (&script->priv->pending, g_strdup (oinfo->id));
+}
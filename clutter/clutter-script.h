@@ -74,6 +74,8 @@ typedef void (* ClutterScriptConnectFunc) (ClutterScript *script,
  *   or invalid
  * @CLUTTER_SCRIPT_ERROR_INVALID_PROPERTY: Property not found or invalid
  * @CLUTTER_SCRIPT_ERROR_INVALID_VALUE: Invalid value
+ * @CLUTTER_SCRIPT_ERROR_INVALID_COMPILED_DATA: Invalid or incompatible
+ *   compiled UI definition; since 1.14
  *
  * #ClutterScript error enumeration.
  *
@@ -82,7 +84,8 @@ typedef void (* ClutterScriptConnectFunc) (ClutterScript *script,
 typedef enum {
   CLUTTER_SCRIPT_ERROR_INVALID_TYPE_FUNCTION,
   CLUTTER_SCRIPT_ERROR_INVALID_PROPERTY,
-  CLUTTER_SCRIPT_ERROR_INVALID_VALUE
+  CLUTTER_SCRIPT_ERROR_INVALID_VALUE,
+  CLUTTER_SCRIPT_ERROR_INVALID_COMPILED_DATA
 } ClutterScriptError;
 
 /**
@@ -158,6 +161,11 @@ guint           clutter_script_load_from_resource       (ClutterScript
                                                          const gchar               *resource_path,
                                                          GError                   **error);
 
+CLUTTER_AVAILABLE_IN_1_14
+GBytes *        clutter_script_compile_data             (const gchar               *data,
+                                                         gssize                     length,
+                                                         GError                   **error);
+
 GObject *       clutter_script_get_object               (ClutterScript             *script,
                                                          const gchar               *name);
 gint            clutter_script_get_objects              (ClutterScript             *script,
@@ -22,6 +22,8 @@
 #ifndef __CLUTTER_STAGE_PRIVATE_H__
 #define __CLUTTER_STAGE_PRIVATE_H__
 
+#include <clutter/clutter-frame-scheduler.h>
+#include <clutter/clutter-offscreen-pool.h>
 #include <clutter/clutter-stage-window.h>
 #include <clutter/clutter-stage.h>
 #include <clutter/clutter-input-device.h>
@@ -33,6 +35,16 @@ G_BEGIN_DECLS
 
 typedef struct _ClutterStageQueueRedrawEntry ClutterStageQueueRedrawEntry;
 
+/* a reference to the entry of an actor inside the redraw queue of
+ * the stage; the entry is only valid if the generation matches the
+ * one of the queue, and a generation of 0 means no entry
+ */
+typedef struct _ClutterStageQueueRedrawHandle
+{
+  guint generation;
+  guint index;
+} ClutterStageQueueRedrawHandle;
+
 /* stage */
 ClutterStageWindow *_clutter_stage_get_default_window    (void);
 
@@ -58,16 +70,27 @@ void                _clutter_stage_get_viewport          (ClutterStage
 void                _clutter_stage_dirty_viewport        (ClutterStage          *stage);
 void                _clutter_stage_maybe_setup_viewport  (ClutterStage          *stage);
 void                _clutter_stage_maybe_relayout        (ClutterActor          *stage);
+void                _clutter_stage_queue_relayout_root   (ClutterStage          *stage,
+                                                          ClutterActor          *actor);
 gboolean            _clutter_stage_needs_update          (ClutterStage          *stage);
 gboolean            _clutter_stage_do_update             (ClutterStage          *stage);
 
 void     _clutter_stage_queue_event                       (ClutterStage *stage,
-					                   ClutterEvent *event);
+					                   ClutterEvent *event,
+                                                           gboolean      copy_event);
 gboolean _clutter_stage_has_queued_events                 (ClutterStage *stage);
 void     _clutter_stage_process_queued_events             (ClutterStage *stage);
 void     _clutter_stage_update_input_devices              (ClutterStage *stage);
 void     _clutter_stage_schedule_update                   (ClutterStage *stage);
 gint64    _clutter_stage_get_update_time                  (ClutterStage *stage);
+void     _clutter_stage_begin_frame                       (ClutterStage *stage,
+                                                           gint64        frame_time);
+void     _clutter_stage_add_frame_phase_cost              (ClutterStage     *stage,
+                                                           ClutterFramePhase phase,
+                                                           gint64            cost);
+void     _clutter_stage_presented                         (ClutterStage *stage,
+                                                           gint64        presentation_time,
+                                                           float         refresh_rate);
 void     _clutter_stage_clear_update_time                 (ClutterStage *stage);
 gboolean _clutter_stage_has_full_redraw_queued            (ClutterStage *stage);
 
@@ -81,11 +104,15 @@ void                _clutter_stage_paint_volume_stack_free_all (ClutterStage *st
 
 const ClutterPlane *_clutter_stage_get_clip (ClutterStage *stage);
 
-ClutterStageQueueRedrawEntry *_clutter_stage_queue_actor_redraw            (ClutterStage                 *stage,
-                                                                            ClutterStageQueueRedrawEntry *entry,
-                                                                            ClutterActor                 *actor,
-                                                                            ClutterPaintVolume           *clip);
-void                          _clutter_stage_queue_redraw_entry_invalidate (ClutterStageQueueRedrawEntry *entry);
+void            _clutter_stage_queue_actor_redraw            (ClutterStage                  *stage,
+                                                              ClutterStageQueueRedrawHandle *handle,
+                                                              ClutterActor                  *actor,
+                                                              ClutterPaintVolume            *clip);
+void            _clutter_stage_queue_redraw_entry_finish     (ClutterStage                  *stage,
+                                                              ClutterStageQueueRedrawHandle *handle);
+void            _clutter_stage_queue_redraw_entry_invalidate (ClutterStage                  *stage,
+                                                              ClutterStageQueueRedrawHandle *handle,
+                                                              ClutterActor                  *actor);
 
 CoglFramebuffer *_clutter_stage_get_active_framebuffer (ClutterStage *stage);
 
@@ -96,6 +123,12 @@ void            _clutter_stage_release_pick_id          (ClutterStage *stage,
 ClutterActor *  _clutter_stage_get_actor_by_pick_id     (ClutterStage *stage,
                                                          gint32        pick_id);
 
+void            _clutter_stage_invalidate_pick_index    (ClutterStage *stage);
+void            _clutter_stage_queue_pick_index_update  (ClutterStage *stage,
+                                                         ClutterActor *actor);
+
+ClutterOffscreenPool *_clutter_stage_get_offscreen_pool (ClutterStage *stage);
+
 void            _clutter_stage_add_pointer_drag_actor    (ClutterStage       *stage,
                                                           ClutterInputDevice *device,
                                                           ClutterActor       *actor);
@@ -65,11 +65,14 @@
 #include "clutter-device-manager-private.h"
 #include "clutter-enum-types.h"
 #include "clutter-event-private.h"
+#include "clutter-frame-scheduler.h"
 #include "clutter-id-pool.h"
 #include "clutter-main.h"
 #include "clutter-marshal.h"
 #include "clutter-master-clock.h"
+#include "clutter-offscreen-pool.h"
 #include "clutter-paint-volume-private.h"
+#include "clutter-pick-index.h"
 #include "clutter-private.h"
 #include "clutter-profile.h"
 #include "clutter-stage-manager-private.h"
@@ -107,6 +110,10 @@ typedef enum { /*< prefix=CLUTTER_STAGE >*/
 
 #define STAGE_NO_CLEAR_ON_PAINT(s)      ((((ClutterStage *) (s))->priv->stage_hints & CLUTTER_STAGE_NO_CLEAR_ON_PAINT) != 0)
 
+/* the entries are stored by value inside the redraw queue of the
+ * stage, and do not hold a reference on the actor: an actor that gets
+ * removed from the stage invalidates its entry instead
+ */
 struct _ClutterStageQueueRedrawEntry
 {
   ClutterActor *actor;
@@ -140,7 +147,16 @@ struct _ClutterStagePrivate
 
   ClutterPlane current_clip_planes[4];
 
-  GList *pending_queue_redraws;
+  /* the redraw queue, an array of ClutterStageQueueRedrawEntry with
+   * at most one entry per actor; each time the queue is processed its
+   * generation is increased, and the array being processed is swapped
+   * with a spare one so that actors can queue redraws meanwhile
+   */
+  GArray *pending_queue_redraws;
+  GArray *processing_queue_redraws;
+  GArray *spare_queue_redraws;
+  guint queue_redraws_generation;
+  guint processing_queue_redraws_generation;
 
   ClutterPickMode pick_buffer_mode;
 
@@ -148,11 +164,23 @@ struct _ClutterStagePrivate
 
   gint sync_delay;
 
+  /* predicts the frame deadlines when the sync delay is adaptive */
+  ClutterFrameScheduler *frame_scheduler;
+
   GTimer *fps_timer;
   gint32 timer_n_frames;
 
   ClutterIDPool *pick_id_pool;
 
+  /* spatial index of the reactive actors, used by geometric picking */
+  ClutterPickIndex *pick_index;
+
+  ClutterOffscreenPool *offscreen_pool;
+
+  /* the relayout boundaries that need to be re-allocated in place,
+   * see _clutter_stage_queue_relayout_root() */
+  GPtrArray *relayout_roots;
+
 #ifdef CLUTTER_ENABLE_DEBUG
   gulong redraw_count;
 #endif /* CLUTTER_ENABLE_DEBUG */
@@ -174,6 +202,8 @@ struct _ClutterStagePrivate
   guint accept_focus           : 1;
   guint motion_events_enabled  : 1;
   guint has_custom_perspective : 1;
+  guint use_geometric_picking  : 1;
+  guint adaptive_sync_delay    : 1;
 };
 
 enum
@@ -212,7 +242,7 @@ static guint stage_signals[LAST_SIGNAL] = { 0, };
 static const ClutterColor default_stage_color = { 255, 255, 255, 255 };
 
 static void _clutter_stage_maybe_finish_queue_redraws (ClutterStage *stage);
-static void free_queue_redraw_entry (ClutterStageQueueRedrawEntry *entry);
+static void clear_queue_redraw_entries (GArray *entries);
 
 static void
 clutter_stage_real_add (ClutterContainer *container,
@@ -915,7 +945,8 @@ clutter_stage_real_fullscreen (ClutterStage *stage)
 
 void
 _clutter_stage_queue_event (ClutterStage *stage,
-			    ClutterEvent *event)
+			    ClutterEvent *event,
+                            gboolean      copy_event)
 {
   ClutterStagePrivate *priv;
   gboolean first_event;
@@ -927,7 +958,10 @@ _clutter_stage_queue_event (ClutterStage *stage,
 
   first_event = priv->event_queue->length == 0;
 
-  g_queue_push_tail (priv->event_queue, clutter_event_copy (event));
+  if (copy_event)
+    event = clutter_event_copy (event);
+
+  g_queue_push_tail (priv->event_queue, event);
 
   if (first_event)
     {
@@ -968,6 +1002,90 @@ _clutter_stage_has_queued_events (ClutterStage *stage)
   return priv->event_queue->length > 0;
 }
 
+/* the maximum number of touch sequences tracked while compressing
+ * the touch update events; additional sequences are not compressed
+ */
+#define MAX_COMPRESSED_SEQUENCES 16
+
+typedef struct {
+  ClutterInputDevice *device;
+  ClutterEventSequence *sequence;
+  ClutterEvent *event;
+} PendingTouchUpdate;
+
+/* removes the touch update events followed by another update of the
+ * same touch sequence, with no other event of that sequence in between.
+ * Unlike motion events, the updates of different sequences are usually
+ * interleaved, so we cannot just look at the next event. The position
+ * of each removed event is kept in the coalesced points of the update
+ * replacing it
+ */
+static GList *
+clutter_stage_compress_touch_updates (GList *events)
+{
+  PendingTouchUpdate pending[MAX_COMPRESSED_SEQUENCES];
+  gint n_pending = 0;
+  GList *l, *prev;
+
+  for (l = g_list_last (events); l != NULL; l = prev)
+    {
+      ClutterEvent *event = l->data;
+      ClutterInputDevice *device;
+      ClutterEventSequence *sequence;
+      gint i;
+
+      prev = l->prev;
+
+      if (event->type != CLUTTER_TOUCH_BEGIN &&
+          event->type != CLUTTER_TOUCH_UPDATE &&
+          event->type != CLUTTER_TOUCH_END &&
+          event->type != CLUTTER_TOUCH_CANCEL)
+        continue;
+
+      device = clutter_event_get_device (event);
+      sequence = clutter_event_get_event_sequence (event);
+
+      for (i = 0; i < n_pending; i++)
+        {
+          if (pending[i].device == device && pending[i].sequence == sequence)
+            break;
+        }
+
+      if (event->type != CLUTTER_TOUCH_UPDATE)
+        {
+          /* the sequence begins or ends here, so the updates coming
+           * before this event must be kept
+           */
+          if (i < n_pending)
+            pending[i] = pending[--n_pending];
+
+          continue;
+        }
+
+      if (i < n_pending)
+        {
+          CLUTTER_NOTE (EVENT,
+                        "Omitting touch update event at %d, %d",
+                        (int) event->touch.x,
+                        (int) event->touch.y);
+
+          _clutter_event_merge_coalesced_points (pending[i].event, event);
+
+          clutter_event_free (event);
+          events = g_list_delete_link (events, l);
+        }
+      else if (n_pending < MAX_COMPRESSED_SEQUENCES)
+        {
+          pending[n_pending].device = device;
+          pending[n_pending].sequence = sequence;
+          pending[n_pending].event = event;
+          n_pending += 1;
+        }
+    }
+
+  return events;
+}
+
 void
 _clutter_stage_process_queued_events (ClutterStage *stage)
 {
@@ -991,6 +1109,9 @@ _clutter_stage_process_queued_events (ClutterStage *stage)
   priv->event_queue->tail = NULL;
   priv->event_queue->length = 0;
 
+  if (priv->throttle_motion_events)
+    events = clutter_stage_compress_touch_updates (events);
+
   for (l = events; l != NULL; l = l->next)
     {
       ClutterEvent *event;
@@ -1024,6 +1145,10 @@ _clutter_stage_process_queued_events (ClutterStage *stage)
                         "Omitting motion event at %d, %d",
                         (int) event->motion.x,
                         (int) event->motion.y);
+
+          if (next_event->type == CLUTTER_MOTION)
+            _clutter_event_merge_coalesced_points (next_event, event);
+
           goto next_event;
 	}
 
@@ -1055,7 +1180,9 @@ _clutter_stage_needs_update (ClutterStage *stage)
 
   priv = stage->priv;
 
-  return priv->relayout_pending || priv->redraw_pending;
+  return priv->relayout_pending ||
+         priv->redraw_pending ||
+         priv->relayout_roots->len > 0;
 }
 
 void
@@ -1070,20 +1197,28 @@ _clutter_stage_maybe_relayout (ClutterActor *actor)
                         "Layouting",
                         "The time spent reallocating the stage",
                         0 /* no application private data */);
+  CLUTTER_STATIC_COUNTER (relayout_root_counter,
+                          "Relayout boundaries",
+                          "Increments for each relayout boundary re-allocated "
+                          "without relayouting the stage",
+                          0 /* no application private data */);
 
-  if (!priv->relayout_pending)
+  if (!priv->relayout_pending && priv->relayout_roots->len == 0)
     return;
 
   /* avoid reentrancy */
-  if (!CLUTTER_ACTOR_IN_RELAYOUT (stage))
+  if (CLUTTER_ACTOR_IN_RELAYOUT (stage))
+    return;
+
+  CLUTTER_TIMER_START (_clutter_uprof_context, relayout_timer);
+  CLUTTER_SET_PRIVATE_FLAGS (stage, CLUTTER_IN_RELAYOUT);
+
+  if (priv->relayout_pending)
     {
       priv->relayout_pending = FALSE;
 
-      CLUTTER_TIMER_START (_clutter_uprof_context, relayout_timer);
       CLUTTER_NOTE (ACTOR, "Recomputing layout");
 
-      CLUTTER_SET_PRIVATE_FLAGS (stage, CLUTTER_IN_RELAYOUT);
-
       natural_width = natural_height = 0;
       clutter_actor_get_preferred_size (CLUTTER_ACTOR (stage),
                                         NULL, NULL,
@@ -1100,10 +1235,51 @@ _clutter_stage_maybe_relayout (ClutterActor *actor)
 
       clutter_actor_allocate (CLUTTER_ACTOR (stage),
                               &box, CLUTTER_ALLOCATION_NONE);
+    }
+
+  /* the relayout boundaries are not reached by allocating the stage,
+   * since their ancestors did not change
+   */
+  if (priv->relayout_roots->len > 0)
+    {
+      GPtrArray *roots = priv->relayout_roots;
+      guint i;
+
+      priv->relayout_roots = g_ptr_array_new_with_free_func (g_object_unref);
 
-      CLUTTER_UNSET_PRIVATE_FLAGS (stage, CLUTTER_IN_RELAYOUT);
-      CLUTTER_TIMER_STOP (_clutter_uprof_context, relayout_timer);
+      CLUTTER_NOTE (ACTOR, "Re-allocating %u relayout boundaries", roots->len);
+
+      for (i = 0; i < roots->len; i++)
+        {
+          _clutter_actor_relayout_boundary (g_ptr_array_index (roots, i));
+          CLUTTER_COUNTER_INC (_clutter_uprof_context, relayout_root_counter);
+        }
+
+      g_ptr_array_unref (roots);
     }
+
+  CLUTTER_UNSET_PRIVATE_FLAGS (stage, CLUTTER_IN_RELAYOUT);
+  CLUTTER_TIMER_STOP (_clutter_uprof_context, relayout_timer);
+}
+
+/*< private >
+ * _clutter_stage_queue_relayout_root:
+ * @stage: a #ClutterStage
+ * @actor: a relayout boundary inside @stage
+ *
+ * Queues @actor to be re-allocated in place at the next relayout of
+ * the @stage, without re-allocating its ancestors.
+ */
+void
+_clutter_stage_queue_relayout_root (ClutterStage *stage,
+                                    ClutterActor *actor)
+{
+  ClutterStagePrivate *priv = stage->priv;
+
+  if (priv->relayout_roots->len == 0 && !priv->relayout_pending)
+    _clutter_stage_schedule_update (stage);
+
+  g_ptr_array_add (priv->relayout_roots, g_object_ref (actor));
 }
 
 static gboolean
@@ -1208,6 +1384,7 @@ gboolean
 _clutter_stage_do_update (ClutterStage *stage)
 {
   ClutterStagePrivate *priv = stage->priv;
+  gint64 start, end;
 
   /* if the stage is being destroyed, or if the destruction already
    * happened and we don't have an StageWindow any more, then we
@@ -1223,10 +1400,19 @@ _clutter_stage_do_update (ClutterStage *stage)
    * check or clear the pending redraws flag since a relayout may
    * queue a redraw.
    */
+  start = g_get_monotonic_time ();
   _clutter_stage_maybe_relayout (CLUTTER_ACTOR (stage));
+  end = g_get_monotonic_time ();
+
+  _clutter_frame_scheduler_add_phase_cost (priv->frame_scheduler,
+                                           CLUTTER_FRAME_PHASE_LAYOUT,
+                                           end - start);
 
   if (!priv->redraw_pending)
-    return FALSE;
+    {
+      _clutter_frame_scheduler_end_frame (priv->frame_scheduler, end, FALSE);
+      return FALSE;
+    }
 
   _clutter_stage_maybe_finish_queue_redraws (stage);
 
@@ -1235,6 +1421,14 @@ _clutter_stage_do_update (ClutterStage *stage)
   /* reset the guard, so that new redraws are possible */
   priv->redraw_pending = FALSE;
 
+  start = end;
+  end = g_get_monotonic_time ();
+
+  _clutter_frame_scheduler_add_phase_cost (priv->frame_scheduler,
+                                           CLUTTER_FRAME_PHASE_PAINT,
+                                           end - start);
+  _clutter_frame_scheduler_end_frame (priv->frame_scheduler, end, TRUE);
+
 #ifdef CLUTTER_ENABLE_DEBUG
   if (priv->redraw_count > 0)
     {
@@ -1426,6 +1620,7 @@ _clutter_stage_do_pick (ClutterStage   *stage,
   CoglFramebuffer *fb;
   ClutterActor *actor;
   gboolean is_clipped;
+  gboolean is_geometric;
   gint read_x;
   gint read_y;
 
@@ -1433,11 +1628,20 @@ _clutter_stage_do_pick (ClutterStage   *stage,
                           "_clutter_stage_do_pick counter",
                           "Increments for each full pick run",
                           0 /* no application private data */);
+  CLUTTER_STATIC_COUNTER (geometric_pick_counter,
+                          "Geometric pick counter",
+                          "Increments for each pick run without painting",
+                          0 /* no application private data */);
   CLUTTER_STATIC_TIMER (pick_timer,
                         "Mainloop", /* parent */
                         "Picking",
                         "The time spent picking",
                         0 /* no application private data */);
+  CLUTTER_STATIC_TIMER (pick_geometric,
+                        "Picking", /* parent */
+                        "Geometric pick",
+                        "The time spent picking without painting",
+                        0 /* no application private data */);
   CLUTTER_STATIC_TIMER (pick_clear,
                         "Picking", /* parent */
                         "Stage clear (pick)",
@@ -1469,6 +1673,41 @@ _clutter_stage_do_pick (ClutterStage   *stage,
   CLUTTER_COUNTER_INC (_clutter_uprof_context, do_pick_counter);
   CLUTTER_TIMER_START (_clutter_uprof_context, pick_timer);
 
+  /* The geometric pick does not touch the GPU at all, so we try it
+   * first; if the scene contains actors that can only be picked by
+   * painting them then we fall back to the pick buffer. We also need
+   * the view matrix to be up to date, which only happens when setting
+   * up the viewport before painting */
+  if (priv->use_geometric_picking && !priv->dirty_viewport)
+    {
+      CLUTTER_TIMER_START (_clutter_uprof_context, pick_geometric);
+
+      /* the pick index only contains reactive actors */
+      if (mode == CLUTTER_PICK_REACTIVE && priv->pick_index != NULL)
+        is_geometric = _clutter_pick_index_pick (priv->pick_index,
+                                                 x, y,
+                                                 &actor);
+      else
+        is_geometric = FALSE;
+
+      if (!is_geometric)
+        is_geometric = _clutter_actor_geometric_pick (CLUTTER_ACTOR (stage),
+                                                      mode, x, y,
+                                                      &actor);
+
+      CLUTTER_TIMER_STOP (_clutter_uprof_context, pick_geometric);
+
+      if (is_geometric)
+        {
+          CLUTTER_NOTE (PICK, "Performed geometric pick at %i,%i", x, y);
+          CLUTTER_COUNTER_INC (_clutter_uprof_context, geometric_pick_counter);
+          goto out;
+        }
+
+      CLUTTER_NOTE (PICK, "Unable to perform a geometric pick at %i,%i; "
+                    "falling back to the pick buffer", x, y);
+    }
+
   context = _clutter_context_get_default ();
   clutter_stage_ensure_current (stage);
 
@@ -1611,6 +1850,7 @@ check_pixel:
       actor = _clutter_get_actor_by_id (stage, id_);
     }
 
+out:
   CLUTTER_TIMER_STOP (_clutter_uprof_context, pick_timer);
 
 #ifdef CLUTTER_ENABLE_PROFILE
@@ -1865,9 +2105,14 @@ clutter_stage_dispose (GObject *object)
 
   clutter_actor_remove_all_children (CLUTTER_ACTOR (object));
 
-  g_list_free_full (priv->pending_queue_redraws,
-                    (GDestroyNotify) free_queue_redraw_entry);
-  priv->pending_queue_redraws = NULL;
+  clear_queue_redraw_entries (priv->pending_queue_redraws);
+  priv->queue_redraws_generation += 1;
+
+  g_ptr_array_set_size (priv->relayout_roots, 0);
+
+  /* the effects still holding targets from the pool are notified */
+  _clutter_offscreen_pool_free (priv->offscreen_pool);
+  priv->offscreen_pool = NULL;
 
   /* this will release the reference on the stage */
   stage_manager = clutter_stage_manager_get_default ();
@@ -1890,6 +2135,15 @@ clutter_stage_finalize (GObject *object)
   g_array_free (priv->paint_volume_stack, TRUE);
 
   _clutter_id_pool_free (priv->pick_id_pool);
+  _clutter_pick_index_free (priv->pick_index);
+
+  g_ptr_array_unref (priv->relayout_roots);
+
+  _clutter_frame_scheduler_free (priv->frame_scheduler);
+
+  g_array_free (priv->pending_queue_redraws, TRUE);
+  if (priv->spare_queue_redraws != NULL)
+    g_array_free (priv->spare_queue_redraws, TRUE);
 
   if (priv->fps_timer != NULL)
     g_timer_destroy (priv->fps_timer);
@@ -2369,6 +2623,16 @@ clutter_stage_init (ClutterStage *self)
     g_array_new (FALSE, FALSE, sizeof (ClutterPaintVolume));
 
   priv->pick_id_pool = _clutter_id_pool_new (256);
+
+  priv->relayout_roots = g_ptr_array_new_with_free_func (g_object_unref);
+
+  priv->pending_queue_redraws =
+    g_array_sized_new (FALSE, FALSE, sizeof (ClutterStageQueueRedrawEntry), 64);
+  priv->spare_queue_redraws =
+    g_array_sized_new (FALSE, FALSE, sizeof (ClutterStageQueueRedrawEntry), 64);
+  priv->queue_redraws_generation = 1;
+
+  priv->frame_scheduler = _clutter_frame_scheduler_new ();
 }
 
 /**
@@ -3590,6 +3854,8 @@ _clutter_stage_maybe_setup_viewport (ClutterStage *stage)
                                           priv->viewport[3]);
 
       priv->dirty_viewport = FALSE;
+
+      _clutter_stage_invalidate_pick_index (stage);
     }
 
   if (priv->dirty_projection)
@@ -3597,6 +3863,8 @@ _clutter_stage_maybe_setup_viewport (ClutterStage *stage)
       cogl_set_projection_matrix (&priv->projection);
 
       priv->dirty_projection = FALSE;
+
+      _clutter_stage_invalidate_pick_index (stage);
     }
 }
 
@@ -3719,7 +3987,8 @@ _clutter_stage_get_default_window (void)
  * be throttled or not. If motion events are throttled, those
  * events received by the windowing system between redraws will
  * be compressed so that only the last event will be propagated
- * to the @stage and its actors.
+ * to the @stage and its actors. The same applies to the touch
+ * update events of each touch sequence.
  *
  * This function should only be used if you want to have all
  * the motion events delivered to your application code.
@@ -3904,10 +4173,87 @@ _clutter_stage_schedule_update (ClutterStage *stage)
   if (stage_window == NULL)
     return;
 
+  if (stage->priv->adaptive_sync_delay)
+    {
+      ClutterFrameScheduler *scheduler = stage->priv->frame_scheduler;
+      gint sync_delay;
+
+      sync_delay = _clutter_frame_scheduler_get_sync_delay (scheduler,
+                                                            g_get_monotonic_time ());
+
+      CLUTTER_NOTE (SCHEDULER, "Adaptive sync delay: %d msecs", sync_delay);
+
+      _clutter_stage_window_schedule_update (stage_window, sync_delay);
+      return;
+    }
+
   return _clutter_stage_window_schedule_update (stage_window,
                                                 stage->priv->sync_delay);
 }
 
+/*< private >
+ * _clutter_stage_begin_frame:
+ * @stage: a #ClutterStage
+ * @frame_time: the time the frame was started, in microseconds
+ *
+ * Notifies the @stage that the master clock started a new frame; the
+ * time spent in each phase of the frame is recorded by the frame
+ * scheduler of the @stage until the end of _clutter_stage_do_update().
+ */
+void
+_clutter_stage_begin_frame (ClutterStage *stage,
+                            gint64        frame_time)
+{
+  _clutter_frame_scheduler_begin_frame (stage->priv->frame_scheduler,
+                                        frame_time);
+}
+
+void
+_clutter_stage_add_frame_phase_cost (ClutterStage     *stage,
+                                     ClutterFramePhase phase,
+                                     gint64            cost)
+{
+  _clutter_frame_scheduler_add_phase_cost (stage->priv->frame_scheduler,
+                                           phase,
+                                           cost);
+}
+
+/*< private >
+ * _clutter_stage_presented:
+ * @stage: a #ClutterStage
+ * @presentation_time: the time the oldest pending frame was presented,
+ *   in the g_get_monotonic_time() time base
+ * @refresh_rate: the refresh rate of the output, or 0 if unknown
+ *
+ * Called by the stage window when it knows the presentation time of
+ * a frame.
+ */
+void
+_clutter_stage_presented (ClutterStage *stage,
+                          gint64        presentation_time,
+                          float         refresh_rate)
+{
+  ClutterFrameScheduler *scheduler = stage->priv->frame_scheduler;
+  CLUTTER_STATIC_COUNTER (missed_deadline_counter,
+                          "Missed frame deadlines",
+                          "Increments for each frame presented after the "
+                          "vertical blank it was scheduled for",
+                          0 /* no application private data */);
+
+  if (_clutter_frame_scheduler_presented (scheduler,
+                                          presentation_time,
+                                          refresh_rate))
+    {
+      CLUTTER_COUNTER_INC (_clutter_uprof_context, missed_deadline_counter);
+
+      CLUTTER_NOTE (SCHEDULER,
+                    "Missed frame deadline (%u so far, predicted cost: "
+                    "%" G_GINT64_FORMAT " usecs)",
+                    _clutter_frame_scheduler_get_n_missed_deadlines (scheduler),
+                    _clutter_frame_scheduler_get_predicted_cost (scheduler));
+    }
+}
+
 /* Returns the earliest time the stage is ready to update */
 gint64
 _clutter_stage_get_update_time (ClutterStage *stage)
@@ -4048,13 +4394,70 @@ _clutter_stage_get_clip (ClutterStage *stage)
  * paint volume so we can clip the redraw request even if the user
  * didn't explicitly do so.
  */
-ClutterStageQueueRedrawEntry *
-_clutter_stage_queue_actor_redraw (ClutterStage *stage,
-                                   ClutterStageQueueRedrawEntry *entry,
-                                   ClutterActor *actor,
-                                   ClutterPaintVolume *clip)
+/* Looks up the entry referenced by @handle in the queue being filled
+ * or, while the redraw queue is being processed, in the queue being
+ * processed; returns %NULL if the handle is stale
+ */
+static ClutterStageQueueRedrawEntry *
+lookup_queue_redraw_entry (ClutterStage                  *stage,
+                           ClutterStageQueueRedrawHandle *handle,
+                           ClutterActor                  *actor)
 {
   ClutterStagePrivate *priv = stage->priv;
+  ClutterStageQueueRedrawEntry *entry;
+  GArray *entries;
+
+  if (handle->generation == 0)
+    return NULL;
+
+  if (handle->generation == priv->queue_redraws_generation)
+    entries = priv->pending_queue_redraws;
+  else if (handle->generation == priv->processing_queue_redraws_generation)
+    entries = priv->processing_queue_redraws;
+  else
+    entries = NULL;
+
+  if (entries == NULL || handle->index >= entries->len)
+    return NULL;
+
+  entry = &g_array_index (entries, ClutterStageQueueRedrawEntry, handle->index);
+  if (entry->actor != actor)
+    return NULL;
+
+  return entry;
+}
+
+/* When an actor queues a redraw we add it to a list on the stage that
+ * gets processed once all updates to the stage have been finished.
+ *
+ * This deferred approach to processing queue_redraw requests means
+ * that we can avoid redundant transformations of clip volumes if
+ * something later triggers a full stage redraw anyway. It also means
+ * we can be more sure that all the referenced actors will have valid
+ * allocations improving the chance that we can determine the actors
+ * paint volume so we can clip the redraw request even if the user
+ * didn't explicitly do so.
+ *
+ * The @handle is owned by the actor, and it is used to merge all the
+ * requests of an actor into a single entry.
+ */
+void
+_clutter_stage_queue_actor_redraw (ClutterStage                  *stage,
+                                   ClutterStageQueueRedrawHandle *handle,
+                                   ClutterActor                  *actor,
+                                   ClutterPaintVolume            *clip)
+{
+  ClutterStagePrivate *priv = stage->priv;
+  ClutterStageQueueRedrawEntry *entry;
+  CLUTTER_STATIC_COUNTER (queue_redraw_entry_counter,
+                          "Redraw queue entries",
+                          "Increments for each actor added to the redraw queue",
+                          0 /* no application private data */);
+  CLUTTER_STATIC_COUNTER (merged_clip_counter,
+                          "Merged redraw clips",
+                          "Increments for each redraw request merged into "
+                          "an existing redraw queue entry",
+                          0 /* no application private data */);
 
   CLUTTER_NOTE (CLIPPING, "stage_queue_actor_redraw (actor=%s, clip=%p): ",
                 _clutter_actor_get_debug_name (actor), clip);
@@ -4091,7 +4494,13 @@ _clutter_stage_queue_actor_redraw (ClutterStage *stage,
    */
   _clutter_stage_set_pick_buffer_valid (stage, FALSE, -1);
 
-  if (entry)
+  /* only the entries of the queue being filled can be merged into */
+  if (handle->generation == priv->queue_redraws_generation)
+    entry = lookup_queue_redraw_entry (stage, handle, actor);
+  else
+    entry = NULL;
+
+  if (entry != NULL)
     {
       /* Ignore all requests to queue a redraw for an actor if a full
        * (non-clipped) redraw of the actor has already been queued. */
@@ -4100,9 +4509,11 @@ _clutter_stage_queue_actor_redraw (ClutterStage *stage,
           CLUTTER_NOTE (CLIPPING, "Bail from stage_queue_actor_redraw (%s): "
                         "Unclipped redraw of actor already queued",
                         _clutter_actor_get_debug_name (actor));
-          return entry;
+          return;
         }
 
+      CLUTTER_COUNTER_INC (_clutter_uprof_context, merged_clip_counter);
+
       /* If queuing a clipped redraw and a clipped redraw has
        * previously been queued for this actor then combine the latest
        * clip together with the existing clip */
@@ -4113,12 +4524,19 @@ _clutter_stage_queue_actor_redraw (ClutterStage *stage,
           clutter_paint_volume_free (&entry->clip);
           entry->has_clip = FALSE;
         }
-      return entry;
     }
   else
     {
-      entry = g_slice_new (ClutterStageQueueRedrawEntry);
-      entry->actor = g_object_ref (actor);
+      GArray *entries = priv->pending_queue_redraws;
+
+      handle->generation = priv->queue_redraws_generation;
+      handle->index = entries->len;
+
+      g_array_set_size (entries, entries->len + 1);
+      entry = &g_array_index (entries, ClutterStageQueueRedrawEntry,
+                              handle->index);
+
+      entry->actor = actor;
 
       if (clip)
         {
@@ -4129,77 +4547,157 @@ _clutter_stage_queue_actor_redraw (ClutterStage *stage,
       else
         entry->has_clip = FALSE;
 
-      stage->priv->pending_queue_redraws =
-        g_list_prepend (stage->priv->pending_queue_redraws, entry);
-
-      return entry;
+      CLUTTER_COUNTER_INC (_clutter_uprof_context, queue_redraw_entry_counter);
     }
 }
 
 static void
-free_queue_redraw_entry (ClutterStageQueueRedrawEntry *entry)
+clear_queue_redraw_entries (GArray *entries)
 {
-  if (entry->actor)
-    g_object_unref (entry->actor);
+  guint i;
+
+  for (i = 0; i < entries->len; i++)
+    {
+      ClutterStageQueueRedrawEntry *entry =
+        &g_array_index (entries, ClutterStageQueueRedrawEntry, i);
+
+      if (entry->has_clip)
+        clutter_paint_volume_free (&entry->clip);
+    }
+
+  g_array_set_size (entries, 0);
+}
+
+static inline void
+invalidate_queue_redraw_entry (ClutterStageQueueRedrawEntry *entry)
+{
+  entry->actor = NULL;
+
   if (entry->has_clip)
-    clutter_paint_volume_free (&entry->clip);
-  g_slice_free (ClutterStageQueueRedrawEntry, entry);
+    {
+      clutter_paint_volume_free (&entry->clip);
+      entry->has_clip = FALSE;
+    }
+}
+
+/*< private >
+ * _clutter_stage_queue_redraw_entry_finish:
+ * @stage: a #ClutterStage
+ * @handle: the handle of the actor whose entry is being processed
+ *
+ * Releases @handle once the entry of the queue being processed has been
+ * handled; if the actor queued another redraw before its entry was
+ * reached, @handle references the new entry in the pending queue, and
+ * it is left untouched.
+ */
+void
+_clutter_stage_queue_redraw_entry_finish (ClutterStage                  *stage,
+                                          ClutterStageQueueRedrawHandle *handle)
+{
+  if (handle->generation == stage->priv->processing_queue_redraws_generation)
+    handle->generation = 0;
 }
 
 void
-_clutter_stage_queue_redraw_entry_invalidate (ClutterStageQueueRedrawEntry *entry)
+_clutter_stage_queue_redraw_entry_invalidate (ClutterStage                  *stage,
+                                              ClutterStageQueueRedrawHandle *handle,
+                                              ClutterActor                  *actor)
 {
-  if (entry == NULL)
+  ClutterStagePrivate *priv = stage->priv;
+  ClutterStageQueueRedrawEntry *entry;
+
+  if (handle->generation == 0 && priv->processing_queue_redraws == NULL)
     return;
 
-  if (entry->actor != NULL)
-    {
-      g_object_unref (entry->actor);
-      entry->actor = NULL;
-    }
+  entry = lookup_queue_redraw_entry (stage, handle, actor);
 
-  if (entry->has_clip)
+  handle->generation = 0;
+
+  if (entry != NULL)
+    invalidate_queue_redraw_entry (entry);
+
+  /* an actor queueing a redraw while the queue is processed gets a new
+   * entry in the pending queue, and its handle does not reference its
+   * entry in the queue being processed anymore; since the entries do
+   * not hold a reference on the actor, that entry has to be found and
+   * invalidated as well
+   */
+  if (priv->processing_queue_redraws != NULL)
     {
-      clutter_paint_volume_free (&entry->clip);
-      entry->has_clip = FALSE;
+      GArray *entries = priv->processing_queue_redraws;
+      guint i;
+
+      for (i = 0; i < entries->len; i++)
+        {
+          entry = &g_array_index (entries, ClutterStageQueueRedrawEntry, i);
+
+          if (entry->actor == actor)
+            invalidate_queue_redraw_entry (entry);
+        }
     }
 }
 
 static void
 _clutter_stage_maybe_finish_queue_redraws (ClutterStage *stage)
 {
-  /* Note: we have to repeat until the pending_queue_redraws list is
-   * empty because actors are allowed to queue redraws in response to
-   * the queue-redraw signal. For example Clone actors or
+  ClutterStagePrivate *priv = stage->priv;
+
+  /* Note: we have to repeat until the redraw queue is empty because
+   * actors are allowed to queue redraws in response to the
+   * queue-redraw signal. For example Clone actors or
    * texture_new_from_actor actors will have to queue a redraw if
    * their source queues a redraw.
    */
-  while (stage->priv->pending_queue_redraws)
+  if (priv->processing_queue_redraws != NULL)
+    return;
+
+  while (priv->pending_queue_redraws->len > 0)
     {
-      GList *l;
-      /* XXX: we need to allow stage->priv->pending_queue_redraws to
-       * be updated while we process the current entries in the list
-       * so we steal the list pointer and then reset it to an empty
-       * list before processing... */
-      GList *stolen_list = stage->priv->pending_queue_redraws;
-      stage->priv->pending_queue_redraws = NULL;
-
-      for (l = stolen_list; l; l = l->next)
+      GArray *entries;
+      guint i;
+
+      /* the entries being processed keep the previous generation, so
+       * new requests go into a new entry in the spare array, and the
+       * entries of actors removed meanwhile can still be invalidated
+       */
+      entries = priv->pending_queue_redraws;
+      priv->pending_queue_redraws = priv->spare_queue_redraws;
+      priv->spare_queue_redraws = NULL;
+      priv->processing_queue_redraws = entries;
+      priv->processing_queue_redraws_generation = priv->queue_redraws_generation;
+      priv->queue_redraws_generation += 1;
+
+      /* 0 is reserved for handles without an entry */
+      if (G_UNLIKELY (priv->queue_redraws_generation == 0))
+        priv->queue_redraws_generation = 1;
+
+      for (i = 0; i < entries->len; i++)
         {
-          ClutterStageQueueRedrawEntry *entry = l->data;
+          ClutterStageQueueRedrawEntry *entry =
+            &g_array_index (entries, ClutterStageQueueRedrawEntry, i);
           ClutterPaintVolume *clip;
 
           /* NB: Entries may be invalidated if the actor gets destroyed */
           if (G_LIKELY (entry->actor != NULL))
-	    {
-	      clip = entry->has_clip ? &entry->clip : NULL;
+            {
+              ClutterActor *actor = g_object_ref (entry->actor);
+
+              /* the handlers of the queue-redraw signal are allowed to
+               * destroy the actor, so we keep it alive meanwhile
+               */
+              clip = entry->has_clip ? &entry->clip : NULL;
 
-	      _clutter_actor_finish_queue_redraw (entry->actor, clip);
-	    }
+              _clutter_actor_finish_queue_redraw (actor, clip);
 
-          free_queue_redraw_entry (entry);
+              g_object_unref (actor);
+            }
         }
-      g_list_free (stolen_list);
+
+      priv->processing_queue_redraws = NULL;
+      priv->processing_queue_redraws_generation = 0;
+
+      clear_queue_redraw_entries (entries);
+      priv->spare_queue_redraws = entries;
     }
 }
 
@@ -4364,6 +4862,65 @@ _clutter_stage_get_actor_by_pick_id (ClutterStage *stage,
   return _clutter_id_pool_lookup (priv->pick_id_pool, pick_id);
 }
 
+/*< private >
+ * _clutter_stage_invalidate_pick_index:
+ * @stage: a #ClutterStage
+ *
+ * Queues a rebuild of the pick index of @stage, if any, after a change
+ * in the structure of the scene graph.
+ */
+void
+_clutter_stage_invalidate_pick_index (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv = stage->priv;
+
+  if (priv->pick_index != NULL)
+    _clutter_pick_index_invalidate (priv->pick_index);
+}
+
+/*< private >
+ * _clutter_stage_queue_pick_index_update:
+ * @stage: a #ClutterStage
+ * @actor: a mapped #ClutterActor of @stage
+ *
+ * Queues an update of the pick geometry of @actor and its descendants
+ * inside the pick index of @stage, if any.
+ */
+void
+_clutter_stage_queue_pick_index_update (ClutterStage *stage,
+                                        ClutterActor *actor)
+{
+  ClutterStagePrivate *priv = stage->priv;
+
+  if (priv->pick_index != NULL)
+    _clutter_pick_index_queue_update (priv->pick_index, actor);
+}
+
+/*< private >
+ * _clutter_stage_get_offscreen_pool:
+ * @stage: a #ClutterStage
+ *
+ * Retrieves the pool of offscreen targets shared by the offscreen
+ * effects painted on @stage, creating it if needed.
+ *
+ * Return value: (transfer none): the offscreen pool of @stage
+ */
+ClutterOffscreenPool *
+_clutter_stage_get_offscreen_pool (ClutterStage *stage)
+{
+  ClutterStagePrivate *priv = stage->priv;
+
+  if (priv->offscreen_pool == NULL)
+    {
+      ClutterMainContext *context = _clutter_context_get_default ();
+
+      priv->offscreen_pool =
+        _clutter_offscreen_pool_new (context->offscreen_budget);
+    }
+
+  return priv->offscreen_pool;
+}
+
 void
 _clutter_stage_add_pointer_drag_actor (ClutterStage       *stage,
                                        ClutterInputDevice *device,
@@ -4425,6 +4982,13 @@ _clutter_stage_add_touch_drag_actor (ClutterStage         *stage,
 {
   GHashTable *drag_actors;
 
+  if (_clutter_event_sequence_is_static (sequence))
+    {
+      sequence->drag_stage = stage;
+      sequence->drag_actor = actor;
+      return;
+    }
+
   drag_actors = g_object_get_data (G_OBJECT (stage),
                                    "__clutter_stage_touch_drag_actors");
   if (drag_actors == NULL)
@@ -4445,6 +5009,9 @@ _clutter_stage_get_touch_drag_actor (ClutterStage         *stage,
 {
   GHashTable *drag_actors;
 
+  if (_clutter_event_sequence_is_static (sequence))
+    return sequence->drag_stage == stage ? sequence->drag_actor : NULL;
+
   drag_actors = g_object_get_data (G_OBJECT (stage),
                                    "__clutter_stage_touch_drag_actors");
   if (drag_actors == NULL)
@@ -4459,6 +5026,17 @@ _clutter_stage_remove_touch_drag_actor (ClutterStage         *stage,
 {
   GHashTable *drag_actors;
 
+  if (_clutter_event_sequence_is_static (sequence))
+    {
+      if (sequence->drag_stage == stage)
+        {
+          sequence->drag_stage = NULL;
+          sequence->drag_actor = NULL;
+        }
+
+      return;
+    }
+
   drag_actors = g_object_get_data (G_OBJECT (stage),
                                    "__clutter_stage_touch_drag_actors");
   if (drag_actors == NULL)
@@ -4610,3 +5188,125 @@ clutter_stage_skip_sync_delay (ClutterStage *stage)
   if (stage_window)
     _clutter_stage_window_schedule_update (stage_window, -1);
 }
+
+/**
+ * clutter_stage_set_adaptive_sync_delay:
+ * @stage: a #ClutterStage
+ * @adaptive: whether the sync delay should be adaptive
+ *
+ * Sets whether the delay between the frame presentation and the time
+ * the next frame is started should be computed by Clutter, instead of
+ * being set with clutter_stage_set_sync_delay().
+ *
+ * When the sync delay is adaptive, Clutter predicts the time of the
+ * next frame presentation from the previous ones, and the time needed
+ * to draw the next frame from the time spent processing events,
+ * advancing animations, relayouting and painting the last frames. The
+ * next frame is then started as late as possible while still being
+ * ready to be presented in time, which reduces the latency between
+ * input events and their presentation.
+ *
+ * This requires the backend to report the presentation time of the
+ * frames; otherwise, the frames are started as soon as possible.
+ *
+ * Since: 1.14
+ * Stability: unstable
+ */
+void
+clutter_stage_set_adaptive_sync_delay (ClutterStage *stage,
+                                       gboolean      adaptive)
+{
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+
+  stage->priv->adaptive_sync_delay = !!adaptive;
+}
+
+/**
+ * clutter_stage_get_adaptive_sync_delay:
+ * @stage: a #ClutterStage
+ *
+ * Retrieves the value set with clutter_stage_set_adaptive_sync_delay().
+ *
+ * Return value: %TRUE if the sync delay of the @stage is adaptive
+ *
+ * Since: 1.14
+ * Stability: unstable
+ */
+gboolean
+clutter_stage_get_adaptive_sync_delay (ClutterStage *stage)
+{
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
+
+  return stage->priv->adaptive_sync_delay;
+}
+
+/**
+ * clutter_stage_set_geometric_picking:
+ * @stage: a #ClutterStage
+ * @enabled: whether to enable geometric picking
+ *
+ * Sets whether @stage should pick actors by hit testing their
+ * transformed allocation on the CPU, instead of painting the scene
+ * in pick mode and reading back the color of a pixel.
+ *
+ * Geometric picking avoids a render and a synchronous read from the
+ * GPU for each pick; it respects the #ClutterActor:reactive,
+ * #ClutterActor:clip and #ClutterActor:clip-to-allocation properties
+ * of each actor.
+ *
+ * Actors that override the #ClutterActorClass.pick virtual function
+ * to paint a custom shape should provide the same shape through
+ * clutter_actor_set_pick_shape_func(); if the scene contains actors
+ * that can only be picked by painting them, the stage will fall back
+ * to painting the scene in pick mode.
+ *
+ * Since: 1.14
+ * Stability: unstable
+ */
+void
+clutter_stage_set_geometric_picking (ClutterStage *stage,
+                                     gboolean      enabled)
+{
+  ClutterStagePrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_STAGE (stage));
+
+  priv = stage->priv;
+
+  enabled = !!enabled;
+
+  if (priv->use_geometric_picking == enabled)
+    return;
+
+  priv->use_geometric_picking = enabled;
+
+  if (enabled)
+    priv->pick_index = _clutter_pick_index_new (stage);
+  else
+    {
+      _clutter_pick_index_free (priv->pick_index);
+      priv->pick_index = NULL;
+    }
+
+  /* the pick buffer might be stale by the time we fall back to it */
+  _clutter_stage_set_pick_buffer_valid (stage, FALSE, -1);
+}
+
+/**
+ * clutter_stage_get_geometric_picking:
+ * @stage: a #ClutterStage
+ *
+ * Retrieves the value set with clutter_stage_set_geometric_picking().
+ *
+ * Return value: %TRUE if the stage uses geometric picking
+ *
+ * Since: 1.14
+ * Stability: unstable
+ */
+gboolean
+clutter_stage_get_geometric_picking (ClutterStage *stage)
+{
+  g_return_val_if_fail (CLUTTER_IS_STAGE (stage), FALSE);
+
+  return stage->priv->use_geometric_picking;
+}
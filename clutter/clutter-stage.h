@@ -208,6 +208,16 @@ void            clutter_stage_set_sync_delay                    (ClutterStage
                                                                  gint                   sync_delay);
 CLUTTER_AVAILABLE_IN_1_14
 void            clutter_stage_skip_sync_delay                   (ClutterStage          *stage);
+CLUTTER_AVAILABLE_IN_1_14
+void            clutter_stage_set_adaptive_sync_delay           (ClutterStage          *stage,
+                                                                 gboolean               adaptive);
+CLUTTER_AVAILABLE_IN_1_14
+gboolean        clutter_stage_get_adaptive_sync_delay           (ClutterStage          *stage);
+CLUTTER_AVAILABLE_IN_1_14
+void            clutter_stage_set_geometric_picking             (ClutterStage          *stage,
+                                                                 gboolean               enabled);
+CLUTTER_AVAILABLE_IN_1_14
+gboolean        clutter_stage_get_geometric_picking             (ClutterStage          *stage);
 #endif
 
 G_END_DECLS
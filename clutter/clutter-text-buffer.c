@@ -24,6 +24,7 @@
 #endif
 
 #include "clutter-text-buffer.h"
+#include "clutter-text-buffer-private.h"
 #include "clutter-marshal.h"
 #include "clutter-private.h"
 
@@ -49,9 +50,12 @@
  * Since: 1.10
  */
 
-/* Initial size of buffer, in bytes */
+/* Minimum size of the allocations holding the text, in bytes */
 #define MIN_SIZE 16
 
+/* Maximum size of a chunk of text, in bytes */
+#define CHUNK_SIZE 4096
+
 enum {
   PROP_0,
   PROP_TEXT,
@@ -70,15 +74,43 @@ enum {
 
 static guint signals[LAST_SIGNAL] = { 0 };
 
+typedef struct _TextChunk       TextChunk;
+
+struct _TextChunk
+{
+  /* at most CHUNK_SIZE bytes, starting at a character boundary, and
+   * nul-terminated; the allocation grows with the contents
+   */
+  gchar *data;
+  gsize  size;
+  gsize  n_bytes;
+  guint  n_chars;
+
+  /* the offsets of the first character of the chunk in the text; only
+   * valid for the first normal_n_valid_offsets chunks of the buffer
+   */
+  gsize  byte_offset;
+  guint  char_offset;
+};
+
 struct _ClutterTextBufferPrivate
 {
   gint  max_length;
 
   /* Only valid if this class is not derived */
-  gchar *normal_text;
-  gsize  normal_text_size;
+  GArray *normal_chunks;
+  guint   normal_n_valid_offsets;
+
   gsize  normal_text_bytes;
   guint  normal_text_chars;
+
+  /* the contiguous copy of the text returned by get_text() when the
+   * text spans more than one chunk; it is assembled from the chunks
+   * when requested after an edit, and is stale until then
+   */
+  gchar *normal_text;
+  gsize  normal_text_size;
+  guint  normal_text_valid : 1;
 };
 
 G_DEFINE_TYPE (ClutterTextBuffer, clutter_text_buffer, G_TYPE_OBJECT);
@@ -89,6 +121,18 @@ G_DEFINE_TYPE (ClutterTextBuffer, clutter_text_buffer, G_TYPE_OBJECT);
  * These may be overridden by a derived class, behavior may be changed etc...
  * The normal_text and normal_text_xxxx fields may not be valid when
  * this class is derived from.
+ *
+ * The text is stored as a sequence of chunks of at most CHUNK_SIZE bytes,
+ * so that inserting or deleting text only moves the bytes of the chunks
+ * involved, instead of the whole tail of the text. The offsets of the
+ * chunks are cached and updated lazily from the first modified chunk,
+ * so that mapping a character position to a byte offset is a binary
+ * search followed by the scan of a single chunk.
+ *
+ * A text fitting in a single chunk, like most labels, is returned by
+ * get_text() directly from the chunk. Longer texts are copied into a
+ * contiguous allocation when get_text() is called after an edit, so
+ * that a sequence of edits doesn't move the whole text each time.
  */
 
 /* Overwrite a memory that might contain sensitive information. */
@@ -101,15 +145,246 @@ trash_area (gchar *area,
     *varea++ = 0;
 }
 
+/* the size of an allocation able to hold @n_bytes bytes */
+static gsize
+text_alloc_size (gsize current,
+                 gsize n_bytes)
+{
+  gsize size = MAX (current, MIN_SIZE);
+
+  while (size < n_bytes)
+    size *= 2;
+
+  return size;
+}
+
+/* moves the @n_bytes first bytes of @area into an allocation of @size
+ * bytes; the previous allocation is trashed, since it might contain a
+ * password, so g_realloc() cannot be used
+ */
+static gchar *
+text_area_resize (gchar *area,
+                  gsize  old_size,
+                  gsize  n_bytes,
+                  gsize  size)
+{
+  gchar *res = g_malloc (size);
+
+  if (area != NULL)
+    {
+      memcpy (res, area, n_bytes);
+      trash_area (area, old_size);
+      g_free (area);
+    }
+
+  return res;
+}
+
+#define chunk_at(pv,i)  (&g_array_index ((pv)->normal_chunks, TextChunk, (i)))
+
+static void
+text_chunk_init (TextChunk   *chunk,
+                 const gchar *str,
+                 gsize        n_bytes)
+{
+  chunk->size = text_alloc_size (0, n_bytes + 1);
+  chunk->data = g_malloc (chunk->size);
+  chunk->n_bytes = n_bytes;
+  chunk->n_chars = g_utf8_strlen (str, n_bytes);
+  chunk->byte_offset = 0;
+  chunk->char_offset = 0;
+
+  memcpy (chunk->data, str, n_bytes);
+  chunk->data[n_bytes] = '\0';
+}
+
+/* makes room for @n_bytes bytes in @chunk, and the terminator */
+static void
+text_chunk_reserve (TextChunk *chunk,
+                    gsize      n_bytes)
+{
+  gsize size;
+
+  if (n_bytes + 1 <= chunk->size)
+    return;
+
+  size = MIN (text_alloc_size (chunk->size, n_bytes + 1), CHUNK_SIZE + 1);
+  chunk->data = text_area_resize (chunk->data, chunk->size,
+                                  chunk->n_bytes + 1,
+                                  size);
+  chunk->size = size;
+}
+
+static void
+text_chunk_clear (TextChunk *chunk)
+{
+  /* Could be a password, so can't leave stuff in memory. */
+  trash_area (chunk->data, chunk->size);
+  g_free (chunk->data);
+}
+
+/* marks the offsets of the chunks after @index as stale */
+static inline void
+clutter_text_buffer_normal_invalidate (ClutterTextBufferPrivate *pv,
+                                       guint                     index_)
+{
+  pv->normal_n_valid_offsets = MIN (pv->normal_n_valid_offsets, index_);
+}
+
+static void
+clutter_text_buffer_normal_ensure_offsets (ClutterTextBufferPrivate *pv)
+{
+  guint i = pv->normal_n_valid_offsets;
+
+  for (; i < pv->normal_chunks->len; i++)
+    {
+      TextChunk *chunk = chunk_at (pv, i);
+
+      if (i == 0)
+        {
+          chunk->byte_offset = 0;
+          chunk->char_offset = 0;
+        }
+      else
+        {
+          TextChunk *prev = chunk_at (pv, i - 1);
+
+          chunk->byte_offset = prev->byte_offset + prev->n_bytes;
+          chunk->char_offset = prev->char_offset + prev->n_chars;
+        }
+    }
+
+  pv->normal_n_valid_offsets = pv->normal_chunks->len;
+}
+
+/* finds the chunk containing the character at @position, and the byte
+ * offset of the character inside the chunk; a position at the boundary
+ * of two chunks is at the start of the second one, and the end of the
+ * text is at the end of the last chunk
+ */
+static guint
+clutter_text_buffer_normal_find_position (ClutterTextBufferPrivate *pv,
+                                          guint                     position,
+                                          gsize                    *byte_in_chunk)
+{
+  TextChunk *chunk;
+  guint lo, hi;
+
+  g_assert (pv->normal_chunks->len > 0);
+
+  clutter_text_buffer_normal_ensure_offsets (pv);
+
+  lo = 0;
+  hi = pv->normal_chunks->len - 1;
+  while (lo < hi)
+    {
+      guint mid = (lo + hi + 1) / 2;
+
+      if (chunk_at (pv, mid)->char_offset <= position)
+        lo = mid;
+      else
+        hi = mid - 1;
+    }
+
+  chunk = chunk_at (pv, lo);
+  *byte_in_chunk = g_utf8_offset_to_pointer (chunk->data,
+                                             position - chunk->char_offset)
+                 - chunk->data;
+
+  return lo;
+}
+
+/* inserts @str as new chunks, starting at @index; returns the index
+ * following the last inserted chunk
+ */
+static guint
+clutter_text_buffer_normal_insert_chunks (ClutterTextBufferPrivate *pv,
+                                          guint                     index_,
+                                          const gchar              *str,
+                                          gsize                     len)
+{
+  while (len > 0)
+    {
+      TextChunk chunk;
+      gsize n = MIN (len, CHUNK_SIZE);
+
+      /* never split a character */
+      if (n < len)
+        {
+          while (n > 0 && (str[n] & 0xc0) == 0x80)
+            n -= 1;
+        }
+
+      text_chunk_init (&chunk, str, n);
+      g_array_insert_val (pv->normal_chunks, index_, chunk);
+
+      index_ += 1;
+      str += n;
+      len -= n;
+    }
+
+  return index_;
+}
+
+static void
+clutter_text_buffer_normal_remove_chunk (ClutterTextBufferPrivate *pv,
+                                         guint                     index_)
+{
+  text_chunk_clear (chunk_at (pv, index_));
+  g_array_remove_index (pv->normal_chunks, index_);
+}
+
 static const gchar*
 clutter_text_buffer_normal_get_text (ClutterTextBuffer *buffer,
                                   gsize          *n_bytes)
 {
+  ClutterTextBufferPrivate *pv = buffer->priv;
+
   if (n_bytes)
-    *n_bytes = buffer->priv->normal_text_bytes;
-  if (!buffer->priv->normal_text)
-      return "";
-  return buffer->priv->normal_text;
+    *n_bytes = pv->normal_text_bytes;
+
+  if (pv->normal_chunks->len == 0)
+    return "";
+
+  if (pv->normal_chunks->len == 1)
+    return chunk_at (pv, 0)->data;
+
+  if (!pv->normal_text_valid)
+    {
+      gchar *p;
+      guint i;
+
+      if (pv->normal_text_bytes + 1 > pv->normal_text_size)
+        {
+          gsize size = text_alloc_size (pv->normal_text_size,
+                                        pv->normal_text_bytes + 1);
+
+          /* the previous contents are stale */
+          pv->normal_text = text_area_resize (pv->normal_text,
+                                              pv->normal_text_size,
+                                              0,
+                                              size);
+          pv->normal_text_size = size;
+        }
+
+      p = pv->normal_text;
+      for (i = 0; i < pv->normal_chunks->len; i++)
+        {
+          TextChunk *chunk = chunk_at (pv, i);
+
+          memcpy (p, chunk->data, chunk->n_bytes);
+          p += chunk->n_bytes;
+        }
+
+      *p = '\0';
+
+      /* trash what is left of a longer text */
+      trash_area (p + 1, pv->normal_text_size - pv->normal_text_bytes - 1);
+
+      pv->normal_text_valid = TRUE;
+    }
+
+  return pv->normal_text;
 }
 
 static guint
@@ -125,59 +400,89 @@ clutter_text_buffer_normal_insert_text (ClutterTextBuffer *buffer,
                                      guint           n_chars)
 {
   ClutterTextBufferPrivate *pv = buffer->priv;
-  gsize prev_size;
+  TextChunk *chunk;
   gsize n_bytes;
   gsize at;
+  guint index_;
 
   n_bytes = g_utf8_offset_to_pointer (chars, n_chars) - chars;
 
-  /* Need more memory */
-  if (n_bytes + pv->normal_text_bytes + 1 > pv->normal_text_size)
+  /* Don't grow over the maximum size, so that the lengths fit in the
+   * integers used by the API */
+  if (n_bytes + pv->normal_text_bytes + 1 > CLUTTER_TEXT_BUFFER_MAX_SIZE)
+    {
+      n_bytes = CLUTTER_TEXT_BUFFER_MAX_SIZE - pv->normal_text_bytes - 1;
+      n_bytes = g_utf8_find_prev_char (chars, chars + n_bytes + 1) - chars;
+      n_chars = g_utf8_strlen (chars, n_bytes);
+    }
+
+  if (n_bytes == 0)
+    return 0;
+
+  if (pv->normal_chunks->len == 0)
     {
-      gchar *et_new;
+      clutter_text_buffer_normal_insert_chunks (pv, 0, chars, n_bytes);
+      clutter_text_buffer_normal_invalidate (pv, 0);
+      goto out;
+    }
+
+  /* Actual text insertion */
+  index_ = clutter_text_buffer_normal_find_position (pv, position, &at);
+  chunk = chunk_at (pv, index_);
 
-      prev_size = pv->normal_text_size;
+  if (chunk->n_bytes + n_bytes <= CHUNK_SIZE)
+    {
+      text_chunk_reserve (chunk, chunk->n_bytes + n_bytes);
 
-      /* Calculate our new buffer size */
-      while (n_bytes + pv->normal_text_bytes + 1 > pv->normal_text_size)
+      /* this moves the terminator as well */
+      g_memmove (chunk->data + at + n_bytes, chunk->data + at, chunk->n_bytes - at + 1);
+      memcpy (chunk->data + at, chars, n_bytes);
+
+      chunk->n_bytes += n_bytes;
+      chunk->n_chars += n_chars;
+    }
+  else
+    {
+      gsize tail_bytes = chunk->n_bytes - at;
+      gchar *tail = NULL;
+      guint next;
+
+      /* split the chunk at the insertion point, and add the inserted
+       * text and the tail of the chunk as new chunks
+       */
+      if (tail_bytes > 0)
         {
-          if (pv->normal_text_size == 0)
-            pv->normal_text_size = MIN_SIZE;
-          else
-            {
-              if (2 * pv->normal_text_size < CLUTTER_TEXT_BUFFER_MAX_SIZE)
-                pv->normal_text_size *= 2;
-              else
-                {
-                  pv->normal_text_size = CLUTTER_TEXT_BUFFER_MAX_SIZE;
-                  if (n_bytes > pv->normal_text_size - pv->normal_text_bytes - 1)
-                    {
-                      n_bytes = pv->normal_text_size - pv->normal_text_bytes - 1;
-                      n_bytes = g_utf8_find_prev_char (chars, chars + n_bytes + 1) - chars;
-                      n_chars = g_utf8_strlen (chars, n_bytes);
-                    }
-                  break;
-                }
-            }
+          tail = g_malloc (tail_bytes);
+          memcpy (tail, chunk->data + at, tail_bytes);
+          trash_area (chunk->data + at, tail_bytes);
         }
 
-      /* Could be a password, so can't leave stuff in memory. */
-      et_new = g_malloc (pv->normal_text_size);
-      memcpy (et_new, pv->normal_text, MIN (prev_size, pv->normal_text_size));
-      trash_area (pv->normal_text, prev_size);
-      g_free (pv->normal_text);
-      pv->normal_text = et_new;
+      chunk->data[at] = '\0';
+      chunk->n_bytes = at;
+      chunk->n_chars = g_utf8_strlen (chunk->data, at);
+
+      next = clutter_text_buffer_normal_insert_chunks (pv, index_ + 1,
+                                                       chars, n_bytes);
+
+      if (tail != NULL)
+        {
+          clutter_text_buffer_normal_insert_chunks (pv, next, tail, tail_bytes);
+          trash_area (tail, tail_bytes);
+          g_free (tail);
+        }
+
+      /* the array might have been reallocated */
+      if (chunk_at (pv, index_)->n_bytes == 0)
+        clutter_text_buffer_normal_remove_chunk (pv, index_);
     }
 
-  /* Actual text insertion */
-  at = g_utf8_offset_to_pointer (pv->normal_text, position) - pv->normal_text;
-  g_memmove (pv->normal_text + at + n_bytes, pv->normal_text + at, pv->normal_text_bytes - at);
-  memcpy (pv->normal_text + at, chars, n_bytes);
+  clutter_text_buffer_normal_invalidate (pv, index_);
 
+out:
   /* Book keeping */
+  pv->normal_text_valid = FALSE;
   pv->normal_text_bytes += n_bytes;
   pv->normal_text_chars += n_chars;
-  pv->normal_text[pv->normal_text_bytes] = '\0';
 
   clutter_text_buffer_emit_inserted_text (buffer, position, chars, n_chars);
   return n_chars;
@@ -189,7 +494,10 @@ clutter_text_buffer_normal_delete_text (ClutterTextBuffer *buffer,
                                      guint           n_chars)
 {
   ClutterTextBufferPrivate *pv = buffer->priv;
+  TextChunk *first, *last;
+  guint first_index, last_index;
   gsize start, end;
+  gsize start_byte, n_bytes;
 
   if (position > pv->normal_text_chars)
     position = pv->normal_text_chars;
@@ -198,19 +506,76 @@ clutter_text_buffer_normal_delete_text (ClutterTextBuffer *buffer,
 
   if (n_chars > 0)
     {
-      start = g_utf8_offset_to_pointer (pv->normal_text, position) - pv->normal_text;
-      end = g_utf8_offset_to_pointer (pv->normal_text, position + n_chars) - pv->normal_text;
+      first_index = clutter_text_buffer_normal_find_position (pv, position, &start);
+      last_index = clutter_text_buffer_normal_find_position (pv, position + n_chars, &end);
 
-      g_memmove (pv->normal_text + start, pv->normal_text + end, pv->normal_text_bytes + 1 - end);
-      pv->normal_text_chars -= n_chars;
-      pv->normal_text_bytes -= (end - start);
+      first = chunk_at (pv, first_index);
+      last = chunk_at (pv, last_index);
 
-      /*
-       * Could be a password, make sure we don't leave anything sensitive after
-       * the terminating zero.  Note, that the terminating zero already trashed
-       * one byte.
-       */
-      trash_area (pv->normal_text + pv->normal_text_bytes + 1, end - start - 1);
+      start_byte = first->byte_offset + start;
+      n_bytes = (last->byte_offset + end) - start_byte;
+
+      if (first_index == last_index)
+        {
+          /* this moves the terminator as well */
+          g_memmove (first->data + start, first->data + end, first->n_bytes - end + 1);
+          trash_area (first->data + first->n_bytes - n_bytes + 1, n_bytes);
+
+          first->n_bytes -= n_bytes;
+          first->n_chars -= n_chars;
+        }
+      else
+        {
+          guint last_chars = position + n_chars - last->char_offset;
+
+          /* the removed text spans the end of the first chunk, the whole
+           * chunks in between, and the start of the last chunk
+           */
+          trash_area (first->data + start, first->n_bytes - start);
+          first->n_chars = position - first->char_offset;
+          first->n_bytes = start;
+
+          g_memmove (last->data, last->data + end, last->n_bytes - end + 1);
+          trash_area (last->data + last->n_bytes - end + 1, end);
+          last->n_bytes -= end;
+          last->n_chars -= last_chars;
+
+          if (last_index > first_index + 1)
+            {
+              guint i;
+
+              for (i = first_index + 1; i < last_index; i++)
+                text_chunk_clear (chunk_at (pv, i));
+
+              g_array_remove_range (pv->normal_chunks,
+                                    first_index + 1,
+                                    last_index - first_index - 1);
+            }
+
+          /* merge the first and the last chunk, if they fit */
+          first = chunk_at (pv, first_index);
+          last = chunk_at (pv, first_index + 1);
+          if (first->n_bytes + last->n_bytes <= CHUNK_SIZE)
+            {
+              text_chunk_reserve (first, first->n_bytes + last->n_bytes);
+              memcpy (first->data + first->n_bytes, last->data, last->n_bytes + 1);
+              first->n_bytes += last->n_bytes;
+              first->n_chars += last->n_chars;
+
+              clutter_text_buffer_normal_remove_chunk (pv, first_index + 1);
+            }
+          else if (last->n_bytes == 0)
+            clutter_text_buffer_normal_remove_chunk (pv, first_index + 1);
+        }
+
+      if (chunk_at (pv, first_index)->n_bytes == 0)
+        clutter_text_buffer_normal_remove_chunk (pv, first_index);
+
+      clutter_text_buffer_normal_invalidate (pv, first_index);
+      pv->normal_text_valid = FALSE;
+
+      pv->normal_text_bytes -= n_bytes;
+      pv->normal_text_chars -= n_chars;
 
       clutter_text_buffer_emit_deleted_text (buffer, position, n_chars);
     }
@@ -218,6 +583,107 @@ clutter_text_buffer_normal_delete_text (ClutterTextBuffer *buffer,
   return n_chars;
 }
 
+/* whether @buffer uses the default storage of the text */
+static inline gboolean
+clutter_text_buffer_is_normal (ClutterTextBuffer *buffer)
+{
+  ClutterTextBufferClass *klass = CLUTTER_TEXT_BUFFER_GET_CLASS (buffer);
+
+  return klass->get_text == clutter_text_buffer_normal_get_text &&
+         klass->insert_text == clutter_text_buffer_normal_insert_text &&
+         klass->delete_text == clutter_text_buffer_normal_delete_text;
+}
+
+/*< private >
+ * _clutter_text_buffer_get_byte_offset:
+ * @buffer: a #ClutterTextBuffer
+ * @position: a position in the text of @buffer, in characters
+ *
+ * Retrieves the offset in bytes of the character at @position, without
+ * scanning the whole text of @buffer.
+ *
+ * Return value: the byte offset of @position, or the size of the text
+ *   in bytes if @position is after the end of the text
+ */
+gsize
+_clutter_text_buffer_get_byte_offset (ClutterTextBuffer *buffer,
+                                      guint              position)
+{
+  ClutterTextBufferPrivate *pv = buffer->priv;
+  TextChunk *chunk;
+  gsize at;
+  guint index_;
+
+  if (!clutter_text_buffer_is_normal (buffer))
+    {
+      const gchar *text = clutter_text_buffer_get_text (buffer);
+      guint length = clutter_text_buffer_get_length (buffer);
+
+      return g_utf8_offset_to_pointer (text, MIN (position, length)) - text;
+    }
+
+  if (position >= pv->normal_text_chars)
+    return pv->normal_text_bytes;
+
+  index_ = clutter_text_buffer_normal_find_position (pv, position, &at);
+  chunk = chunk_at (pv, index_);
+
+  return chunk->byte_offset + at;
+}
+
+/*< private >
+ * _clutter_text_buffer_get_char_offset:
+ * @buffer: a #ClutterTextBuffer
+ * @byte_offset: an offset in the text of @buffer, in bytes
+ *
+ * Retrieves the position of the character at @byte_offset, without
+ * scanning the whole text of @buffer.
+ *
+ * Return value: the position of the character, or the length of the
+ *   text if @byte_offset is after the end of the text
+ */
+guint
+_clutter_text_buffer_get_char_offset (ClutterTextBuffer *buffer,
+                                      gsize              byte_offset)
+{
+  ClutterTextBufferPrivate *pv = buffer->priv;
+  TextChunk *chunk;
+  guint lo, hi;
+
+  if (!clutter_text_buffer_is_normal (buffer))
+    {
+      gsize n_bytes = 0;
+      const gchar *text;
+
+      text = CLUTTER_TEXT_BUFFER_GET_CLASS (buffer)->get_text (buffer, &n_bytes);
+
+      return g_utf8_pointer_to_offset (text, text + MIN (byte_offset, n_bytes));
+    }
+
+  if (byte_offset >= pv->normal_text_bytes)
+    return pv->normal_text_chars;
+
+  clutter_text_buffer_normal_ensure_offsets (pv);
+
+  lo = 0;
+  hi = pv->normal_chunks->len - 1;
+  while (lo < hi)
+    {
+      guint mid = (lo + hi + 1) / 2;
+
+      if (chunk_at (pv, mid)->byte_offset <= byte_offset)
+        lo = mid;
+      else
+        hi = mid - 1;
+    }
+
+  chunk = chunk_at (pv, lo);
+
+  return chunk->char_offset
+       + g_utf8_pointer_to_offset (chunk->data,
+                                   chunk->data + (byte_offset - chunk->byte_offset));
+}
+
 /* --------------------------------------------------------------------------------
  *
  */
@@ -252,10 +718,14 @@ clutter_text_buffer_init (ClutterTextBuffer *buffer)
 
   pv = buffer->priv = G_TYPE_INSTANCE_GET_PRIVATE (buffer, CLUTTER_TYPE_TEXT_BUFFER, ClutterTextBufferPrivate);
 
+  pv->normal_chunks = g_array_new (FALSE, FALSE, sizeof (TextChunk));
+  pv->normal_n_valid_offsets = 0;
+
   pv->normal_text = NULL;
   pv->normal_text_chars = 0;
   pv->normal_text_bytes = 0;
   pv->normal_text_size = 0;
+  pv->normal_text_valid = FALSE;
 }
 
 static void
@@ -263,6 +733,13 @@ clutter_text_buffer_finalize (GObject *obj)
 {
   ClutterTextBuffer *buffer = CLUTTER_TEXT_BUFFER (obj);
   ClutterTextBufferPrivate *pv = buffer->priv;
+  guint i;
+
+  for (i = 0; i < pv->normal_chunks->len; i++)
+    text_chunk_clear (chunk_at (pv, i));
+
+  g_array_free (pv->normal_chunks, TRUE);
+  pv->normal_chunks = NULL;
 
   if (pv->normal_text)
     {
@@ -515,6 +992,10 @@ clutter_text_buffer_get_bytes (ClutterTextBuffer *buffer)
   klass = CLUTTER_TEXT_BUFFER_GET_CLASS (buffer);
   g_return_val_if_fail (klass->get_text != NULL, 0);
 
+  /* avoid assembling the text of the default storage */
+  if (klass->get_text == clutter_text_buffer_normal_get_text)
+    return buffer->priv->normal_text_bytes;
+
   (*klass->get_text) (buffer, &bytes);
   return bytes;
 }
@@ -44,7 +44,7 @@ G_BEGIN_DECLS
  *
  * Since: 1.10
  */
-#define CLUTTER_TEXT_BUFFER_MAX_SIZE        G_MAXUSHORT
+#define CLUTTER_TEXT_BUFFER_MAX_SIZE        G_MAXINT
 
 typedef struct _ClutterTextBuffer            ClutterTextBuffer;
 typedef struct _ClutterTextBufferClass       ClutterTextBufferClass;
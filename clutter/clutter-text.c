@@ -54,12 +54,13 @@
 #include "clutter-debug.h"
 #include "clutter-enum-types.h"
 #include "clutter-keysyms.h"
+#include "clutter-layout-cache.h"
 #include "clutter-main.h"
 #include "clutter-marshal.h"
 #include "clutter-private.h"    /* includes <cogl-pango/cogl-pango.h> */
 #include "clutter-profile.h"
 #include "clutter-property-transition.h"
-#include "clutter-text-buffer.h"
+#include "clutter-text-buffer-private.h"
 #include "clutter-units.h"
 #include "clutter-paint-volume-private.h"
 #include "clutter-scriptable.h"
@@ -79,9 +80,24 @@
  */
 #define N_CACHED_LAYOUTS        6
 
+/* the number of threads shaping text when ClutterText:shape-async is
+ * set, and the number of font maps they can use; a font map is used by
+ * a single thread at a time, and is checked out until the main thread
+ * has cached the glyphs of the layout shaped with it
+ */
+#define MAX_SHAPE_THREADS       2
+#define N_SHAPE_FONT_MAPS       (MAX_SHAPE_THREADS * 4)
+
+/* texts shorter than this, in bytes, are shaped synchronously even
+ * when ClutterText:shape-async is set, as shaping them costs less than
+ * waiting for a worker thread
+ */
+#define SHAPE_ASYNC_MIN_BYTES   256
+
 #define CLUTTER_TEXT_GET_PRIVATE(obj)   (G_TYPE_INSTANCE_GET_PRIVATE ((obj), CLUTTER_TYPE_TEXT, ClutterTextPrivate))
 
 typedef struct _LayoutCache     LayoutCache;
+typedef struct _ShapeJob        ShapeJob;
 
 static const ClutterColor default_cursor_color    = {   0,   0,   0, 255 };
 static const ClutterColor default_selection_color = {   0,   0,   0, 255 };
@@ -116,6 +132,39 @@ struct _LayoutCache
   guint age;
 };
 
+struct _ShapeJob
+{
+  ClutterText *text;
+
+  /* owns copies of the text, attributes and font description */
+  ClutterLayoutCacheKey key;
+
+  /* the settings of the PangoContext of the actor */
+  PangoFontDescription *context_font_desc;
+  cairo_font_options_t *font_options;
+  PangoLanguage *language;
+  PangoDirection base_dir;
+  gdouble resolution;
+
+  /* the result, and the font map it was shaped with, set by the
+   * worker thread
+   */
+  PangoLayout *layout;
+  CoglPangoFontMap *font_map;
+
+  /* set from the main thread when the job is not needed anymore */
+  volatile gint cancelled;
+};
+
+/* the pool shaping the text of the actors with ClutterText:shape-async
+ * set, and the font maps used by its threads
+ */
+static GThreadPool *shape_thread_pool = NULL;
+static GAsyncQueue *shape_font_maps = NULL;
+
+/* the estimated extents of the layouts used while shaping */
+static GQuark quark_estimated_extents = 0;
+
 struct _ClutterTextPrivate
 {
   PangoFontDescription *font_desc;
@@ -132,6 +181,21 @@ struct _ClutterTextPrivate
   LayoutCache cached_layouts[N_CACHED_LAYOUTS];
   guint cache_age;
 
+  /* the layout displayed while shaping for the size it was requested
+   * for; it is not stored in the cache above, as its size does not
+   * match its contents
+   */
+  PangoLayout *placeholder_layout;
+  gint placeholder_width;
+  gint placeholder_height;
+  PangoEllipsizeMode placeholder_ellipsize;
+
+  /* asynchronous shaping: the jobs in flight, and the last layout
+   * completely shaped, displayed while the text is being shaped
+   */
+  GSList *shape_jobs;
+  PangoLayout *shaped_layout;
+
   /* These are the attributes set by the attributes property */
   PangoAttrList *attrs;
   /* These are the attributes derived from the text when the
@@ -218,6 +282,7 @@ struct _ClutterTextPrivate
   guint paint_volume_valid      : 1;
   guint show_password_hint      : 1;
   guint password_hint_visible   : 1;
+  guint shape_async             : 1;
 };
 
 enum
@@ -253,6 +318,7 @@ enum
   PROP_SINGLE_LINE_MODE,
   PROP_SELECTED_TEXT_COLOR,
   PROP_SELECTED_TEXT_COLOR_SET,
+  PROP_SHAPE_ASYNC,
 
   PROP_LAST
 };
@@ -276,6 +342,7 @@ static void clutter_text_settings_changed_cb (ClutterText *text);
 static void buffer_connect_signals (ClutterText *self);
 static void buffer_disconnect_signals (ClutterText *self);
 static ClutterTextBuffer *get_buffer (ClutterText *self);
+static void clutter_text_dirty_layouts (ClutterText *text);
 
 static inline void
 clutter_text_dirty_paint_volume (ClutterText *text)
@@ -328,6 +395,21 @@ offset_to_bytes (const gchar *text,
 
 #define bytes_to_offset(t,p)    (g_utf8_pointer_to_offset ((t), (t) + (p)))
 
+/* like offset_to_bytes() and bytes_to_offset(), but using the offsets
+ * cached by the buffer instead of scanning its contents
+ */
+static inline gint
+buffer_offset_to_bytes (ClutterText *self,
+                        gint         pos)
+{
+  if (pos < 0)
+    return clutter_text_buffer_get_bytes (get_buffer (self));
+
+  return _clutter_text_buffer_get_byte_offset (get_buffer (self), pos);
+}
+
+#define buffer_bytes_to_offset(s,p)     (_clutter_text_buffer_get_char_offset (get_buffer ((s)), (p)))
+
 static inline void
 clutter_text_clear_selection (ClutterText *self)
 {
@@ -531,8 +613,449 @@ clutter_text_create_layout_no_cache (ClutterText       *text,
   return layout;
 }
 
+static gboolean shape_job_done (gpointer data);
+
+/* runs in a worker thread */
 static void
-clutter_text_dirty_cache (ClutterText *text)
+shape_job_run (gpointer data,
+               gpointer user_data)
+{
+  ShapeJob *job = data;
+  CoglPangoFontMap *font_map;
+  PangoContext *context;
+  PangoLayout *layout;
+  PangoRectangle ink_rect;
+
+  if (g_atomic_int_get (&job->cancelled))
+    goto out;
+
+  /* each font map is used by a single thread at a time; the main thread
+   * hands them back as soon as it is done with the previous jobs
+   */
+  font_map = g_async_queue_pop (shape_font_maps);
+
+  context = cogl_pango_font_map_create_context (font_map);
+  pango_context_set_font_description (context, job->context_font_desc);
+  pango_context_set_language (context, job->language);
+  pango_context_set_base_dir (context, job->base_dir);
+  pango_cairo_context_set_font_options (context, job->font_options);
+  pango_cairo_context_set_resolution (context, job->resolution);
+
+  layout = pango_layout_new (context);
+  pango_layout_set_font_description (layout, job->key.font_desc);
+  pango_layout_set_text (layout, job->key.text, -1);
+
+  if (job->key.attrs != NULL)
+    pango_layout_set_attributes (layout, job->key.attrs);
+
+  pango_layout_set_alignment (layout, job->key.alignment);
+  pango_layout_set_single_paragraph_mode (layout, job->key.single_paragraph);
+  pango_layout_set_justify (layout, job->key.justify);
+  pango_layout_set_wrap (layout, job->key.wrap_mode);
+
+  pango_layout_set_ellipsize (layout, job->key.ellipsize);
+  pango_layout_set_width (layout, job->key.width);
+  pango_layout_set_height (layout, job->key.height);
+
+  /* this shapes the whole text, and caches the extents of its lines,
+   * so that querying them later doesn't use the fonts again
+   */
+  pango_layout_get_extents (layout, &ink_rect, NULL);
+
+  /* the layout keeps a reference on the context */
+  g_object_unref (context);
+
+  job->layout = layout;
+  job->font_map = font_map;
+
+out:
+  clutter_threads_add_idle_full (G_PRIORITY_DEFAULT,
+                                 shape_job_done,
+                                 job,
+                                 NULL);
+}
+
+static void
+shape_job_free (ShapeJob *job)
+{
+  _clutter_layout_cache_key_clear (&job->key);
+
+  pango_font_description_free (job->context_font_desc);
+
+  if (job->font_options != NULL)
+    cairo_font_options_destroy (job->font_options);
+
+  /* the layout is released in the main thread, as it might hold
+   * resources of the renderer of the font map
+   */
+  if (job->layout != NULL)
+    g_object_unref (job->layout);
+
+  if (job->font_map != NULL)
+    g_async_queue_push (shape_font_maps, job->font_map);
+
+  g_slice_free (ShapeJob, job);
+}
+
+static gboolean
+shape_job_done (gpointer data)
+{
+  ShapeJob *job = data;
+  ClutterText *self = job->text;
+  ClutterTextPrivate *priv;
+
+  /* the text changed, or the actor was disposed, while shaping */
+  if (g_atomic_int_get (&job->cancelled))
+    goto out;
+
+  priv = self->priv;
+  priv->shape_jobs = g_slist_remove (priv->shape_jobs, job);
+
+  CLUTTER_NOTE (ACTOR, "ClutterText: %p: shaped %" G_GSIZE_FORMAT " bytes "
+                "asynchronously for width %d",
+                self,
+                strlen (job->key.text),
+                job->key.width);
+
+  /* the glyphs are rasterized while the font map is still checked
+   * out; once they are in the glyph cache of the font map, and the
+   * extents of the lines are cached, displaying the layout doesn't use
+   * the font map anymore, and shape_job_free() hands it back to the
+   * worker threads
+   */
+  cogl_pango_ensure_glyph_cache_for_layout (job->layout);
+  _clutter_layout_cache_insert (&job->key, job->layout);
+
+  /* drop the layouts displayed while shaping; the next relayout will
+   * pick the new one from the shared cache
+   */
+  clutter_text_dirty_layouts (self);
+  clutter_actor_queue_relayout (CLUTTER_ACTOR (self));
+
+out:
+  shape_job_free (job);
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+clutter_text_cancel_shape_jobs (ClutterText *self)
+{
+  ClutterTextPrivate *priv = self->priv;
+  GSList *l;
+
+  for (l = priv->shape_jobs; l != NULL; l = l->next)
+    {
+      ShapeJob *job = l->data;
+
+      g_atomic_int_set (&job->cancelled, TRUE);
+    }
+
+  g_slist_free (priv->shape_jobs);
+  priv->shape_jobs = NULL;
+}
+
+static void
+clutter_text_start_shape_job (ClutterText                 *self,
+                              const ClutterLayoutCacheKey *key)
+{
+  ClutterTextPrivate *priv = self->priv;
+  const cairo_font_options_t *font_options;
+  PangoContext *context;
+  ShapeJob *job;
+
+  if (G_UNLIKELY (shape_thread_pool == NULL))
+    {
+      PangoFontMap *default_font_map = clutter_get_font_map ();
+      gboolean use_mipmapping;
+      gint i;
+
+      use_mipmapping =
+        cogl_pango_font_map_get_use_mipmapping (COGL_PANGO_FONT_MAP (default_font_map));
+
+      /* the font maps are not thread safe, so each thread checks one
+       * out; they are created here, as they hold Cogl resources
+       */
+      shape_font_maps = g_async_queue_new ();
+      for (i = 0; i < N_SHAPE_FONT_MAPS; i++)
+        {
+          CoglPangoFontMap *font_map;
+
+          font_map = COGL_PANGO_FONT_MAP (cogl_pango_font_map_new ());
+          cogl_pango_font_map_set_use_mipmapping (font_map, use_mipmapping);
+
+          g_async_queue_push (shape_font_maps, font_map);
+        }
+
+      shape_thread_pool = g_thread_pool_new (shape_job_run, NULL,
+                                             MAX_SHAPE_THREADS,
+                                             FALSE,
+                                             NULL);
+    }
+
+  context = clutter_actor_get_pango_context (CLUTTER_ACTOR (self));
+  font_options = pango_cairo_context_get_font_options (context);
+
+  job = g_slice_new0 (ShapeJob);
+  job->text = self;
+  _clutter_layout_cache_key_copy (&job->key, key);
+
+  job->context_font_desc =
+    pango_font_description_copy (pango_context_get_font_description (context));
+  job->font_options = font_options != NULL
+                    ? cairo_font_options_copy (font_options)
+                    : NULL;
+  job->language = pango_context_get_language (context);
+  job->base_dir = pango_context_get_base_dir (context);
+  job->resolution = pango_cairo_context_get_resolution (context);
+
+  priv->shape_jobs = g_slist_prepend (priv->shape_jobs, job);
+
+  g_thread_pool_push (shape_thread_pool, job, NULL);
+}
+
+/*
+ * clutter_text_create_estimated_layout:
+ * @text: a #ClutterText
+ * @key: the properties of the layout being shaped
+ *
+ * Creates an empty layout to be used while the contents of @text are
+ * being shaped, if no previous layout is available. The extents of the
+ * text are estimated from the metrics of the font, and are retrieved
+ * using clutter_text_get_layout_extents().
+ *
+ * Return value: (transfer full): a #PangoLayout
+ */
+static PangoLayout *
+clutter_text_create_estimated_layout (ClutterText                 *text,
+                                      const ClutterLayoutCacheKey *key)
+{
+  ClutterTextPrivate *priv = text->priv;
+  PangoRectangle *extents;
+  PangoFontMetrics *metrics;
+  PangoLayout *layout;
+  const gchar *p;
+  gint char_width, line_height;
+  gint paragraph_width, max_width;
+  gint n_lines;
+
+  layout = clutter_actor_create_pango_layout (CLUTTER_ACTOR (text), NULL);
+  pango_layout_set_font_description (layout, priv->font_desc);
+  pango_layout_set_ellipsize (layout, key->ellipsize);
+  pango_layout_set_width (layout, key->width);
+  pango_layout_set_height (layout, key->height);
+
+  metrics = pango_context_get_metrics (pango_layout_get_context (layout),
+                                       priv->font_desc,
+                                       NULL);
+  char_width = pango_font_metrics_get_approximate_char_width (metrics);
+  line_height = pango_font_metrics_get_ascent (metrics)
+              + pango_font_metrics_get_descent (metrics);
+  pango_font_metrics_unref (metrics);
+
+  /* count the lines of each paragraph, assuming that all the
+   * characters have the same width
+   */
+  n_lines = 0;
+  max_width = 0;
+  paragraph_width = 0;
+  for (p = key->text; ; p = g_utf8_next_char (p))
+    {
+      if (*p == '\0' || (*p == '\n' && !key->single_paragraph))
+        {
+          if (key->width > 0 && paragraph_width > key->width && priv->wrap)
+            {
+              n_lines += (paragraph_width + key->width - 1) / key->width;
+              paragraph_width = key->width;
+            }
+          else
+            n_lines += 1;
+
+          max_width = MAX (max_width, paragraph_width);
+          paragraph_width = 0;
+
+          if (*p == '\0')
+            break;
+        }
+      else
+        paragraph_width += char_width;
+    }
+
+  extents = g_new0 (PangoRectangle, 1);
+  extents->width = key->width > 0 ? MIN (max_width, key->width) : max_width;
+  extents->height = n_lines * line_height;
+
+  if (key->height > 0 && key->ellipsize != PANGO_ELLIPSIZE_NONE)
+    extents->height = MIN (extents->height, key->height);
+
+  g_object_set_qdata_full (G_OBJECT (layout), quark_estimated_extents,
+                           extents,
+                           g_free);
+
+  return layout;
+}
+
+/*
+ * clutter_text_get_layout_extents:
+ * @layout: a #PangoLayout created by clutter_text_create_layout()
+ * @logical_rect: (out): return location for the logical extents
+ *
+ * Retrieves the logical extents of @layout, or the estimated extents
+ * of the text if @layout is being shaped in a worker thread.
+ */
+static void
+clutter_text_get_layout_extents (PangoLayout    *layout,
+                                 PangoRectangle *logical_rect)
+{
+  PangoRectangle *extents;
+
+  extents = g_object_get_qdata (G_OBJECT (layout), quark_estimated_extents);
+  if (extents != NULL)
+    *logical_rect = *extents;
+  else
+    pango_layout_get_extents (layout, NULL, logical_rect);
+}
+
+/*
+ * clutter_text_create_async_layout:
+ * @text: a #ClutterText
+ * @key: the properties of the layout
+ *
+ * Starts shaping the layout described by @key in a worker thread, unless
+ * it is already being shaped, and returns the layout to use until it is
+ * done: the last completely shaped layout, if any, or an empty layout
+ * with estimated extents.
+ *
+ * Return value: (transfer full): a #PangoLayout
+ */
+static PangoLayout *
+clutter_text_create_async_layout (ClutterText                 *text,
+                                  const ClutterLayoutCacheKey *key)
+{
+  ClutterTextPrivate *priv = text->priv;
+  gboolean in_flight = FALSE;
+  GSList *l;
+
+  for (l = priv->shape_jobs; l != NULL; l = l->next)
+    {
+      ShapeJob *job = l->data;
+
+      if (_clutter_layout_cache_key_equal (&job->key, key))
+        {
+          in_flight = TRUE;
+          break;
+        }
+    }
+
+  if (!in_flight)
+    {
+      CLUTTER_NOTE (ACTOR, "ClutterText: %p: shaping asynchronously for width %d",
+                    text,
+                    key->width);
+
+      clutter_text_start_shape_job (text, key);
+    }
+
+  if (priv->shaped_layout != NULL)
+    return g_object_ref (priv->shaped_layout);
+
+  return clutter_text_create_estimated_layout (text, key);
+}
+
+/*
+ * clutter_text_create_shared_layout:
+ * @text: a #ClutterText
+ * @width: the width of the layout, in Pango units, or -1
+ * @height: the height of the layout, in Pango units, or -1
+ * @ellipsize: the ellipsization mode of the layout
+ * @is_placeholder: (out): return location for whether the layout is
+ *   only displayed while the text is being shaped
+ *
+ * Like clutter_text_create_layout_no_cache(), but looks up the layout in
+ * the global layout cache first, and ensures the glyph cache.
+ *
+ * The layouts of editable actors depend on their cursor and pre-edit
+ * state, and change too often to be shared.
+ *
+ * Return value: (transfer full): a #PangoLayout
+ */
+static PangoLayout *
+clutter_text_create_shared_layout (ClutterText       *text,
+                                   gint               width,
+                                   gint               height,
+                                   PangoEllipsizeMode ellipsize,
+                                   gboolean          *is_placeholder)
+{
+  ClutterTextPrivate *priv = text->priv;
+  ClutterLayoutCacheKey key;
+  PangoLayout *layout;
+  gchar *contents;
+
+  *is_placeholder = FALSE;
+
+  if (priv->editable)
+    {
+      layout = clutter_text_create_layout_no_cache (text, width, height, ellipsize);
+      cogl_pango_ensure_glyph_cache_for_layout (layout);
+
+      return layout;
+    }
+
+  contents = clutter_text_get_display_text (text);
+  clutter_text_ensure_effective_attributes (text);
+
+  key.text = contents;
+  key.attrs = priv->effective_attrs;
+  key.font_desc = priv->font_desc;
+  key.width = width;
+  key.height = height;
+  key.ellipsize = ellipsize;
+  key.wrap_mode = priv->wrap_mode;
+  key.alignment = priv->alignment;
+  key.direction = clutter_actor_get_text_direction (CLUTTER_ACTOR (text));
+  key.justify = priv->justify;
+  key.single_paragraph = priv->single_line_mode;
+
+  layout = _clutter_layout_cache_lookup (&key);
+  if (layout != NULL)
+    {
+      CLUTTER_NOTE (ACTOR, "ClutterText: %p: shared cache hit for '%s'",
+                    text,
+                    contents);
+    }
+  else if (priv->shape_async && strlen (contents) >= SHAPE_ASYNC_MIN_BYTES)
+    {
+      layout = clutter_text_create_async_layout (text, &key);
+      g_free (contents);
+
+      *is_placeholder = TRUE;
+
+      return layout;
+    }
+  else
+    {
+      layout = clutter_text_create_layout_no_cache (text, width, height, ellipsize);
+      cogl_pango_ensure_glyph_cache_for_layout (layout);
+
+      _clutter_layout_cache_insert (&key, layout);
+    }
+
+  /* keep the layout around, to display it while the next contents
+   * are being shaped
+   */
+  if (priv->shape_async && priv->shaped_layout != layout)
+    {
+      g_clear_object (&priv->shaped_layout);
+      priv->shaped_layout = g_object_ref (layout);
+    }
+
+  g_free (contents);
+
+  return layout;
+}
+
+static void
+clutter_text_dirty_layouts (ClutterText *text)
 {
   ClutterTextPrivate *priv = text->priv;
   int i;
@@ -546,9 +1069,20 @@ clutter_text_dirty_cache (ClutterText *text)
 	priv->cached_layouts[i].layout = NULL;
       }
 
+  g_clear_object (&priv->placeholder_layout);
+
   clutter_text_dirty_paint_volume (text);
 }
 
+static void
+clutter_text_dirty_cache (ClutterText *text)
+{
+  /* the layouts being shaped are out of date */
+  clutter_text_cancel_shape_jobs (text);
+
+  clutter_text_dirty_layouts (text);
+}
+
 /*
  * clutter_text_set_font_description_internal:
  * @self: a #ClutterText
@@ -656,6 +1190,8 @@ clutter_text_create_layout (ClutterText *text,
   gint width = -1;
   gint height = -1;
   PangoEllipsizeMode ellipsize = PANGO_ELLIPSIZE_NONE;
+  PangoLayout *layout;
+  gboolean is_placeholder;
   int i;
 
   CLUTTER_STATIC_COUNTER (text_cache_hit_counter,
@@ -730,6 +1266,13 @@ clutter_text_create_layout (ClutterText *text,
       height = allocation_height * 1024 + 0.5f;
     }
 
+  /* the text is still being shaped for this size */
+  if (priv->placeholder_layout != NULL &&
+      priv->placeholder_width == width &&
+      priv->placeholder_height == height &&
+      priv->placeholder_ellipsize == ellipsize)
+    return priv->placeholder_layout;
+
   /* Search for a cached layout with the same width and keep
    * track of the oldest one
    */
@@ -818,14 +1361,30 @@ clutter_text_create_layout (ClutterText *text,
   CLUTTER_COUNTER_INC (_clutter_uprof_context, text_cache_miss_counter);
 
   /* If we make it here then we didn't have a cached version so we
-     need to recreate the layout */
+     need to recreate the layout, unless another actor has an identical
+     one in the shared cache */
+  layout = clutter_text_create_shared_layout (text, width, height, ellipsize,
+                                              &is_placeholder);
+
+  /* the size of a placeholder does not match its contents, so it must
+   * not be found by the searches above; it is replaced when the text
+   * is shaped
+   */
+  if (is_placeholder)
+    {
+      g_clear_object (&priv->placeholder_layout);
+      priv->placeholder_layout = layout;
+      priv->placeholder_width = width;
+      priv->placeholder_height = height;
+      priv->placeholder_ellipsize = ellipsize;
+
+      return layout;
+    }
+
   if (oldest_cache->layout)
     g_object_unref (oldest_cache->layout);
 
-  oldest_cache->layout =
-    clutter_text_create_layout_no_cache (text, width, height, ellipsize);
-
-  cogl_pango_ensure_glyph_cache_for_layout (oldest_cache->layout);
+  oldest_cache->layout = layout;
 
   /* Mark the 'time' this cache was created and advance the time */
   oldest_cache->age = priv->cache_age++;
@@ -1269,6 +1828,10 @@ clutter_text_set_property (GObject      *gobject,
       clutter_text_set_selected_text_color (self, clutter_value_get_color (value));
       break;
 
+    case PROP_SHAPE_ASYNC:
+      clutter_text_set_shape_async (self, g_value_get_boolean (value));
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
     }
@@ -1398,6 +1961,10 @@ clutter_text_get_property (GObject    *gobject,
       g_value_set_boolean (value, priv->selected_text_color_set);
       break;
 
+    case PROP_SHAPE_ASYNC:
+      g_value_set_boolean (value, priv->shape_async);
+      break;
+
     default:
       G_OBJECT_WARN_INVALID_PROPERTY_ID (gobject, prop_id, pspec);
     }
@@ -1412,6 +1979,8 @@ clutter_text_dispose (GObject *gobject)
   /* get rid of the entire cache */
   clutter_text_dirty_cache (self);
 
+  g_clear_object (&priv->shaped_layout);
+
   if (priv->direction_changed_id)
     {
       g_signal_handler_disconnect (self, priv->direction_changed_id);
@@ -1707,15 +2276,13 @@ clutter_text_move_line_start (ClutterText *self,
   gint line_no;
   gint index_;
   gint position;
-  const gchar *text;
 
   layout = clutter_text_get_layout (self);
-  text = clutter_text_buffer_get_text (get_buffer (self));
 
   if (start == 0)
     index_ = 0;
   else
-    index_ = offset_to_bytes (text, start);
+    index_ = buffer_offset_to_bytes (self, start);
 
   pango_layout_index_to_line_x (layout, index_,
                                 0,
@@ -1727,7 +2294,7 @@ clutter_text_move_line_start (ClutterText *self,
 
   pango_layout_line_x_to_index (layout_line, 0, &index_, NULL);
 
-  position = bytes_to_offset (text, index_);
+  position = buffer_bytes_to_offset (self, index_);
 
   return position;
 }
@@ -1743,15 +2310,13 @@ clutter_text_move_line_end (ClutterText *self,
   gint index_;
   gint trailing;
   gint position;
-  const gchar *text;
 
   layout = clutter_text_get_layout (self);
-  text = clutter_text_buffer_get_text (get_buffer (self));
 
   if (start == 0)
     index_ = 0;
   else
-    index_ = offset_to_bytes (text, priv->position);
+    index_ = buffer_offset_to_bytes (self, priv->position);
 
   pango_layout_index_to_line_x (layout, index_,
                                 0,
@@ -1764,7 +2329,7 @@ clutter_text_move_line_end (ClutterText *self,
   pango_layout_line_x_to_index (layout_line, G_MAXINT, &index_, &trailing);
   index_ += trailing;
 
-  position = bytes_to_offset (text, index_);
+  position = buffer_bytes_to_offset (self, index_);
 
   return position;
 }
@@ -2486,7 +3051,7 @@ clutter_text_get_preferred_width (ClutterActor *self,
 
   layout = clutter_text_create_layout (text, -1, -1);
 
-  pango_layout_get_extents (layout, NULL, &logical_rect);
+  clutter_text_get_layout_extents (layout, &logical_rect);
 
   /* the X coordinate of the logical rectangle might be non-zero
    * according to the Pango documentation; hence, we need to offset
@@ -2544,7 +3109,7 @@ clutter_text_get_preferred_height (ClutterActor *self,
       layout = clutter_text_create_layout (CLUTTER_TEXT (self),
                                            for_width, -1);
 
-      pango_layout_get_extents (layout, NULL, &logical_rect);
+      clutter_text_get_layout_extents (layout, &logical_rect);
 
       /* the Y coordinate of the logical rectangle might be non-zero
        * according to the Pango documentation; hence, we need to offset
@@ -2729,15 +3294,13 @@ clutter_text_real_move_up (ClutterText         *self,
   gint index_, trailing;
   gint pos;
   gint x;
-  const gchar *text;
 
   layout = clutter_text_get_layout (self);
-  text = clutter_text_buffer_get_text (get_buffer (self));
 
   if (priv->position == 0)
     index_ = 0;
   else
-    index_ = offset_to_bytes (text, priv->position);
+    index_ = buffer_offset_to_bytes (self, priv->position);
 
   pango_layout_index_to_line_x (layout, index_,
                                 0,
@@ -2758,7 +3321,7 @@ clutter_text_real_move_up (ClutterText         *self,
 
   g_object_freeze_notify (G_OBJECT (self));
 
-  pos = bytes_to_offset (text, index_);
+  pos = buffer_bytes_to_offset (self, index_);
   clutter_text_set_cursor_position (self, pos + trailing);
 
   /* Store the target x position to avoid drifting left and right when
@@ -2786,15 +3349,13 @@ clutter_text_real_move_down (ClutterText         *self,
   gint index_, trailing;
   gint x;
   gint pos;
-  const gchar *text;
 
   layout = clutter_text_get_layout (self);
-  text = clutter_text_buffer_get_text (get_buffer (self));
 
   if (priv->position == 0)
     index_ = 0;
   else
-    index_ = offset_to_bytes (text, priv->position);
+    index_ = buffer_offset_to_bytes (self, priv->position);
 
   pango_layout_index_to_line_x (layout, index_,
                                 0,
@@ -2811,7 +3372,7 @@ clutter_text_real_move_down (ClutterText         *self,
 
   g_object_freeze_notify (G_OBJECT (self));
 
-  pos = bytes_to_offset (text, index_);
+  pos = buffer_bytes_to_offset (self, index_);
   clutter_text_set_cursor_position (self, pos + trailing);
 
   /* Store the target x position to avoid drifting left and right when
@@ -3317,6 +3878,9 @@ clutter_text_class_init (ClutterTextClass *klass)
 
   g_type_class_add_private (klass, sizeof (ClutterTextPrivate));
 
+  quark_estimated_extents =
+    g_quark_from_static_string ("-clutter-text-estimated-extents");
+
   gobject_class->set_property = clutter_text_set_property;
   gobject_class->get_property = clutter_text_get_property;
   gobject_class->dispose = clutter_text_dispose;
@@ -3823,6 +4387,21 @@ clutter_text_class_init (ClutterTextClass *klass)
   obj_props[PROP_SELECTED_TEXT_COLOR_SET] = pspec;
   g_object_class_install_property (gobject_class, PROP_SELECTED_TEXT_COLOR_SET, pspec);
 
+  /**
+   * ClutterText:shape-async:
+   *
+   * Whether the text should be shaped in a worker thread.
+   *
+   * Since: 1.14
+   */
+  pspec = g_param_spec_boolean ("shape-async",
+                                P_("Shape Asynchronously"),
+                                P_("Whether the text is shaped in a worker thread"),
+                                FALSE,
+                                CLUTTER_PARAM_READWRITE);
+  obj_props[PROP_SHAPE_ASYNC] = pspec;
+  g_object_class_install_property (gobject_class, PROP_SHAPE_ASYNC, pspec);
+
   /**
    * ClutterText::text-changed:
    * @self: the #ClutterText that emitted the signal
@@ -4743,8 +5322,8 @@ clutter_text_get_selection (ClutterText *self)
     }
 
   text = clutter_text_buffer_get_text (get_buffer (self));
-  start_offset = offset_to_bytes (text, start_index);
-  end_offset = offset_to_bytes (text, end_index);
+  start_offset = buffer_offset_to_bytes (self, start_index);
+  end_offset = buffer_offset_to_bytes (self, end_index);
   len = end_offset - start_offset;
 
   str = g_malloc (len + 1);
@@ -5173,8 +5752,15 @@ clutter_text_set_markup (ClutterText *self,
  *
  * Retrieves the current #PangoLayout used by a #ClutterText actor.
  *
+ * Unless @self is editable, the returned layout can be shared with
+ * other #ClutterText actors displaying the same contents with the same
+ * font and size, so it must be treated as read-only: changing its text,
+ * attributes or any of its properties would also change what those
+ * actors display. Use pango_layout_copy() to get a layout that can be
+ * modified.
+ *
  * Return value: (transfer none): a #PangoLayout. The returned object is owned by
- *   the #ClutterText actor and should not be modified or freed
+ *   the #ClutterText actor and must not be modified or freed
  *
  * Since: 1.0
  */
@@ -5983,8 +6569,8 @@ clutter_text_get_chars (ClutterText *self,
   start_pos = MIN (n_chars, start_pos);
   end_pos = MIN (n_chars, end_pos);
 
-  start_index = g_utf8_offset_to_pointer (text, start_pos) - text;
-  end_index   = g_utf8_offset_to_pointer (text, end_pos) - text;
+  start_index = _clutter_text_buffer_get_byte_offset (get_buffer (self), start_pos);
+  end_index   = _clutter_text_buffer_get_byte_offset (get_buffer (self), end_pos);
 
   return g_strndup (text + start_index, end_index - start_index);
 }
@@ -6156,3 +6742,68 @@ clutter_text_get_layout_offsets (ClutterText *self,
   if (y != NULL)
     *y = priv->text_y;
 }
+
+/**
+ * clutter_text_set_shape_async:
+ * @self: a #ClutterText
+ * @shape_async: whether the text should be shaped in a worker thread
+ *
+ * Sets whether the contents of a #ClutterText should be shaped in a
+ * worker thread, instead of blocking the main loop while computing the
+ * preferred size and the allocation of the actor.
+ *
+ * While the text is being shaped, the @self actor keeps displaying,
+ * and using the size of, its previous layout; if there is none, it
+ * uses a size estimated from the metrics of the font, and paints
+ * nothing. Once the text is shaped, a relayout is queued. Changing the
+ * contents of @self again cancels the shaping in progress.
+ *
+ * Editable actors, and short texts, are always shaped synchronously.
+ *
+ * Since: 1.14
+ * Stability: unstable
+ */
+void
+clutter_text_set_shape_async (ClutterText *self,
+                              gboolean     shape_async)
+{
+  ClutterTextPrivate *priv;
+
+  g_return_if_fail (CLUTTER_IS_TEXT (self));
+
+  priv = self->priv;
+
+  shape_async = !!shape_async;
+
+  if (priv->shape_async == shape_async)
+    return;
+
+  priv->shape_async = shape_async;
+
+  /* drop the layouts displayed while shaping, if any */
+  clutter_text_dirty_cache (self);
+  g_clear_object (&priv->shaped_layout);
+
+  clutter_actor_queue_relayout (CLUTTER_ACTOR (self));
+
+  g_object_notify_by_pspec (G_OBJECT (self), obj_props[PROP_SHAPE_ASYNC]);
+}
+
+/**
+ * clutter_text_get_shape_async:
+ * @self: a #ClutterText
+ *
+ * Retrieves the value set using clutter_text_set_shape_async().
+ *
+ * Return value: %TRUE if the text is shaped in a worker thread
+ *
+ * Since: 1.14
+ * Stability: unstable
+ */
+gboolean
+clutter_text_get_shape_async (ClutterText *self)
+{
+  g_return_val_if_fail (CLUTTER_IS_TEXT (self), FALSE);
+
+  return self->priv->shape_async;
+}
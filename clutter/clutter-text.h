@@ -232,6 +232,14 @@ void                  clutter_text_get_layout_offsets   (ClutterText           *
                                                          gint                  *x,
                                                          gint                  *y);
 
+#ifdef CLUTTER_ENABLE_EXPERIMENTAL_API
+CLUTTER_AVAILABLE_IN_1_14
+void                  clutter_text_set_shape_async      (ClutterText          *self,
+                                                         gboolean              shape_async);
+CLUTTER_AVAILABLE_IN_1_14
+gboolean              clutter_text_get_shape_async      (ClutterText          *self);
+#endif
+
 G_END_DECLS
 
 #endif /* __CLUTTER_TEXT_H__ */
@@ -146,6 +146,53 @@ _clutter_util_fully_transform_vertices (const CoglMatrix *modelview,
     }
 }
 
+/*< private >
+ * _clutter_util_quad_contains_point:
+ * @verts: the four vertices of a quad, in the same order used by
+ *   clutter_actor_get_abs_allocation_vertices()
+ * @x: the X coordinate of the point
+ * @y: the Y coordinate of the point
+ *
+ * Checks whether the point is inside the convex quad defined by
+ * @verts; only the x and y components of the vertices are used.
+ *
+ * Points on the edges of the quad are considered to be inside it,
+ * while degenerate quads do not contain any point.
+ *
+ * Return value: %TRUE if the point is inside the quad
+ */
+gboolean
+_clutter_util_quad_contains_point (const ClutterVertex verts[],
+                                   float               x,
+                                   float               y)
+{
+  /* the vertices are in the (x1, y1), (x2, y1), (x1, y2), (x2, y2)
+   * order, so we need to walk them as 0, 1, 3, 2 to follow the
+   * outline of the quad
+   */
+  static const int outline[] = { 0, 1, 3, 2 };
+  int i, sign = 0;
+
+  for (i = 0; i < 4; i++)
+    {
+      const ClutterVertex *a = &verts[outline[i]];
+      const ClutterVertex *b = &verts[outline[(i + 1) % 4]];
+      float cross;
+
+      cross = (b->x - a->x) * (y - a->y) - (b->y - a->y) * (x - a->x);
+
+      if (cross == 0.f)
+        continue;
+
+      if (sign == 0)
+        sign = cross > 0.f ? 1 : -1;
+      else if ((cross > 0.f) != (sign > 0))
+        return FALSE;
+    }
+
+  return sign != 0;
+}
+
 /*< private >
  * _clutter_util_rectangle_union:
  * @src1: first rectangle to union
@@ -177,6 +224,44 @@ _clutter_util_rectangle_union (const cairo_rectangle_int_t *src1,
   dest->y = dest_y;
 }
 
+/*< private >
+ * _clutter_util_rectangle_intersection:
+ * @src1: first rectangle to intersect
+ * @src2: second rectangle to intersect
+ * @dest: (out) (allow-none): return location for the intersection
+ *
+ * Calculates the intersection of two rectangles.
+ *
+ * It is allowed for @dest to be the same as either @src1 or @src2.
+ *
+ * Return value: %TRUE if the rectangles intersect
+ */
+gboolean
+_clutter_util_rectangle_intersection (const cairo_rectangle_int_t *src1,
+                                      const cairo_rectangle_int_t *src2,
+                                      cairo_rectangle_int_t       *dest)
+{
+  int x1, y1, x2, y2;
+
+  x1 = MAX (src1->x, src2->x);
+  y1 = MAX (src1->y, src2->y);
+  x2 = MIN (src1->x + src1->width, src2->x + src2->width);
+  y2 = MIN (src1->y + src1->height, src2->y + src2->height);
+
+  if (x1 >= x2 || y1 >= y2)
+    return FALSE;
+
+  if (dest != NULL)
+    {
+      dest->x = x1;
+      dest->y = y1;
+      dest->width = x2 - x1;
+      dest->height = y2 - y1;
+    }
+
+  return TRUE;
+}
+
 float
 _clutter_util_matrix_determinant (const ClutterMatrix *matrix)
 {
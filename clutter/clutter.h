@@ -36,9 +36,11 @@
 #include "clutter-actor-meta.h"
 #include "clutter-align-constraint.h"
 #include "clutter-animatable.h"
+#include "clutter-array-model.h"
 #include "clutter-backend.h"
 #include "clutter-bind-constraint.h"
 #include "clutter-binding-pool.h"
+#include "clutter-bend-effect.h"
 #include "clutter-bin-layout.h"
 #include "clutter-blur-effect.h"
 #include "clutter-box-layout.h"
@@ -62,6 +62,14 @@ enum {
   PROP_LAST
 };
 
+static void
+clutter_stage_cogl_free_damage_history (ClutterStageCogl *stage_cogl)
+{
+  g_slist_free_full (stage_cogl->damage_history,
+                     (GDestroyNotify) cairo_region_destroy);
+  stage_cogl->damage_history = NULL;
+}
+
 static void
 clutter_stage_cogl_unrealize (ClutterStageWindow *stage_window)
 {
@@ -78,6 +86,8 @@ clutter_stage_cogl_unrealize (ClutterStageWindow *stage_window)
       cogl_object_unref (stage_cogl->onscreen);
       stage_cogl->onscreen = NULL;
     }
+
+  clutter_stage_cogl_free_damage_history (stage_cogl);
 }
 
 static void
@@ -117,6 +127,11 @@ frame_cb (CoglOnscreen  *onscreen,
         }
 
       stage_cogl->refresh_rate = cogl_frame_info_get_refresh_rate (info);
+
+      if (presentation_time_cogl != 0 && stage_cogl->wrapper != NULL)
+        _clutter_stage_presented (stage_cogl->wrapper,
+                                  stage_cogl->last_presentation_time,
+                                  stage_cogl->refresh_rate);
     }
 }
 
@@ -322,6 +337,101 @@ clutter_stage_cogl_ignoring_redraw_clips (ClutterStageWindow *stage_window)
     return FALSE;
 }
 
+static inline gint64
+rectangle_area (const cairo_rectangle_int_t *rect)
+{
+  return (gint64) rect->width * rect->height;
+}
+
+/* Returns the number of pixels that would be painted needlessly if
+ * @a and @b were replaced by their union */
+static gint64
+rectangle_union_waste (const cairo_rectangle_int_t *a,
+                       const cairo_rectangle_int_t *b,
+                       cairo_rectangle_int_t       *union_out)
+{
+  cairo_rectangle_int_t intersection;
+  gint64 covered;
+
+  covered = rectangle_area (a) + rectangle_area (b);
+  if (_clutter_util_rectangle_intersection (a, b, &intersection))
+    covered -= rectangle_area (&intersection);
+
+  _clutter_util_rectangle_union (a, b, union_out);
+
+  return rectangle_area (union_out) - covered;
+}
+
+/* Adds @clip to a set of at most CLUTTER_STAGE_COGL_MAX_REDRAW_CLIPS
+ * disjoint rectangles.
+ *
+ * Overlapping rectangles are always merged, so that no pixel is
+ * painted twice; other rectangles are merged when their union wastes
+ * less than a quarter of its area. When the set is full, the new
+ * rectangle is merged with the one wasting the fewest pixels.
+ */
+static void
+add_clip_rectangle (cairo_rectangle_int_t       *rects,
+                    gint                        *n_rects,
+                    const cairo_rectangle_int_t *clip)
+{
+  cairo_rectangle_int_t rect = *clip;
+  gboolean merged;
+  gint i;
+
+  do
+    {
+      merged = FALSE;
+
+      for (i = 0; i < *n_rects; i++)
+        {
+          cairo_rectangle_int_t united;
+          gint64 waste;
+
+          waste = rectangle_union_waste (&rect, &rects[i], &united);
+
+          if (_clutter_util_rectangle_intersection (&rect, &rects[i], NULL) ||
+              waste * 4 <= rectangle_area (&united))
+            {
+              rect = united;
+              rects[i] = rects[--(*n_rects)];
+              merged = TRUE;
+              break;
+            }
+        }
+    }
+  while (merged);
+
+  if (*n_rects == CLUTTER_STAGE_COGL_MAX_REDRAW_CLIPS)
+    {
+      cairo_rectangle_int_t best_union;
+      gint64 best_waste = G_MAXINT64;
+      gint best = 0;
+
+      for (i = 0; i < *n_rects; i++)
+        {
+          cairo_rectangle_int_t united;
+          gint64 waste;
+
+          waste = rectangle_union_waste (&rect, &rects[i], &united);
+          if (waste < best_waste)
+            {
+              best_waste = waste;
+              best_union = united;
+              best = i;
+            }
+        }
+
+      rects[best] = rects[--(*n_rects)];
+
+      /* the union may now overlap other rectangles */
+      add_clip_rectangle (rects, n_rects, &best_union);
+      return;
+    }
+
+  rects[(*n_rects)++] = rect;
+}
+
 /* A redraw clip represents (in stage coordinates) the bounding box of
  * something that needs to be redraw. Typically they are added to the
  * StageWindow as a result of clutter_actor_queue_clipped_redraw() by
@@ -331,10 +441,11 @@ clutter_stage_cogl_ignoring_redraw_clips (ClutterStageWindow *stage_window)
  * A NULL stage_clip means the whole stage needs to be redrawn.
  *
  * What we do with this information:
- * - we keep track of the bounding box for all redraw clips
- * - when we come to redraw; we scissor the redraw to that box and use
- *   glBlitFramebuffer to present the redraw to the front
- *   buffer.
+ * - we keep track of the bounding box for all redraw clips, and of a
+ *   small set of disjoint rectangles covering them
+ * - when we come to redraw; we paint the stage once for each of the
+ *   rectangles, scissored to it, and use glBlitFramebuffer to present
+ *   the rectangles to the front buffer.
  */
 static void
 clutter_stage_cogl_add_redraw_clip (ClutterStageWindow    *stage_window,
@@ -352,6 +463,7 @@ clutter_stage_cogl_add_redraw_clip (ClutterStageWindow    *stage_window,
   if (stage_clip == NULL)
     {
       stage_cogl->bounding_redraw_clip.width = 0;
+      stage_cogl->n_redraw_clips = 0;
       stage_cogl->initialized_redraw_clip = TRUE;
       return;
     }
@@ -363,12 +475,17 @@ clutter_stage_cogl_add_redraw_clip (ClutterStageWindow    *stage_window,
   if (!stage_cogl->initialized_redraw_clip)
     {
       stage_cogl->bounding_redraw_clip = *stage_clip;
+      stage_cogl->redraw_clips[0] = *stage_clip;
+      stage_cogl->n_redraw_clips = 1;
     }
   else if (stage_cogl->bounding_redraw_clip.width > 0)
     {
       _clutter_util_rectangle_union (&stage_cogl->bounding_redraw_clip,
                                      stage_clip,
                                      &stage_cogl->bounding_redraw_clip);
+      add_clip_rectangle (stage_cogl->redraw_clips,
+                          &stage_cogl->n_redraw_clips,
+                          stage_clip);
     }
 
   stage_cogl->initialized_redraw_clip = TRUE;
@@ -382,7 +499,7 @@ clutter_stage_cogl_get_redraw_clip_bounds (ClutterStageWindow    *stage_window,
 
   if (stage_cogl->using_clipped_redraw)
     {
-      *stage_clip = stage_cogl->bounding_redraw_clip;
+      *stage_clip = *stage_cogl->current_redraw_clip;
 
       return TRUE;
     }
@@ -400,8 +517,10 @@ clutter_stage_cogl_redraw (ClutterStageWindow *stage_window)
   gboolean can_blit_sub_buffer;
   gboolean has_buffer_age;
   ClutterActor *wrapper;
-  cairo_rectangle_int_t *clip_region;
+  cairo_rectangle_int_t clip_rects[CLUTTER_STAGE_COGL_MAX_REDRAW_CLIPS];
+  gint n_clip_rects = 0;
   gboolean force_swap;
+  gint i;
 
   CLUTTER_STATIC_TIMER (painting_timer,
                         "Redrawing", /* parent */
@@ -418,6 +537,10 @@ clutter_stage_cogl_redraw (ClutterStageWindow *stage_window)
                         "blit_sub_buffer",
                         "The time spent in blit_sub_buffer",
                         0 /* no application private data */);
+  CLUTTER_STATIC_COUNTER (clipped_redraw_rects_counter,
+                          "Clipped redraw rectangles",
+                          "The number of rectangles painted by clipped redraws",
+                          0 /* no application private data */);
 
   wrapper = CLUTTER_ACTOR (stage_cogl->wrapper);
 
@@ -440,8 +563,25 @@ clutter_stage_cogl_redraw (ClutterStageWindow *stage_window)
        * frames when starting up... */
       stage_cogl->frame_count > 3)
     {
+      gint64 area = 0;
+
       may_use_clipped_redraw = TRUE;
-      clip_region = &stage_cogl->bounding_redraw_clip;
+
+      for (i = 0; i < stage_cogl->n_redraw_clips; i++)
+        {
+          clip_rects[i] = stage_cogl->redraw_clips[i];
+          area += rectangle_area (&clip_rects[i]);
+        }
+
+      n_clip_rects = stage_cogl->n_redraw_clips;
+
+      /* painting the stage once per rectangle is only worth it if
+       * it saves a significant part of the bounding box */
+      if (area * 4 >= rectangle_area (&stage_cogl->bounding_redraw_clip) * 3)
+        {
+          clip_rects[0] = stage_cogl->bounding_redraw_clip;
+          n_clip_rects = 1;
+        }
     }
 
   if (may_use_clipped_redraw &&
@@ -458,45 +598,52 @@ clutter_stage_cogl_redraw (ClutterStageWindow *stage_window)
       if (has_buffer_age)
       {
         int age = cogl_onscreen_get_buffer_age (stage_cogl->onscreen);
-        cairo_rectangle_int_t *current_damage;
+        cairo_region_t *current_damage;
 
-        current_damage = g_new0 (cairo_rectangle_int_t, 1);
-        current_damage->x = clip_region->x;
-        current_damage->y = clip_region->y;
-        current_damage->width = clip_region->width;
-        current_damage->height = clip_region->height;
+        current_damage = cairo_region_create_rectangles (clip_rects, n_clip_rects);
 
         stage_cogl->damage_history = g_slist_prepend (stage_cogl->damage_history, current_damage);
 
         if (age != 0 && !stage_cogl->dirty_backbuffer && g_slist_length (stage_cogl->damage_history) >= age)
           {
-            int i = 0;
+            cairo_region_t *repair;
+            int j = 0;
             GSList *tmp = NULL;
+
+            /* the back buffer misses the damage of the last frames */
+            repair = cairo_region_create ();
             for (tmp = stage_cogl->damage_history; tmp; tmp = tmp->next)
               {
-                _clutter_util_rectangle_union (clip_region, tmp->data, clip_region);
-                i++;
-                if (i == age)
+                cairo_region_union (repair, tmp->data);
+                j++;
+                if (j == age)
                   {
-                    g_slist_free_full (tmp->next, g_free);
+                    g_slist_free_full (tmp->next,
+                                       (GDestroyNotify) cairo_region_destroy);
                     tmp->next = NULL;
                   }
               }
 
-            force_swap = TRUE;
+            n_clip_rects = 0;
+            for (i = 0; i < cairo_region_num_rectangles (repair); i++)
+              {
+                cairo_rectangle_int_t rect;
 
-            CLUTTER_NOTE (CLIPPING, "Reusing back buffer - repairing region: x=%d, y=%d, width=%d, height=%d\n",
-                    clip_region->x,
-                    clip_region->y,
-                    clip_region->width,
-                    clip_region->height);
+                cairo_region_get_rectangle (repair, i, &rect);
+                add_clip_rectangle (clip_rects, &n_clip_rects, &rect);
+              }
 
+            cairo_region_destroy (repair);
+
+            force_swap = TRUE;
+
+            CLUTTER_NOTE (CLIPPING, "Reusing back buffer - repairing %d rectangles\n",
+                          n_clip_rects);
           }
         else if (age == 0 || stage_cogl->dirty_backbuffer)
           {
             CLUTTER_NOTE (CLIPPING, "Invalid back buffer: Resetting damage history list.\n");
-            g_slist_free_full (stage_cogl->damage_history, g_free);
-            stage_cogl->damage_history = NULL;
+            clutter_stage_cogl_free_damage_history (stage_cogl);
           }
 
       }
@@ -504,8 +651,7 @@ clutter_stage_cogl_redraw (ClutterStageWindow *stage_window)
   else
     {
       CLUTTER_NOTE (CLIPPING, "Unclipped redraw: Resetting damage history list.\n");
-      g_slist_free_full (stage_cogl->damage_history, g_free);
-      stage_cogl->damage_history = NULL;
+      clutter_stage_cogl_free_damage_history (stage_cogl);
     }
 
   if (has_buffer_age && !force_swap)
@@ -513,23 +659,33 @@ clutter_stage_cogl_redraw (ClutterStageWindow *stage_window)
 
   if (use_clipped_redraw)
     {
-      CLUTTER_NOTE (CLIPPING,
-                    "Stage clip pushed: x=%d, y=%d, width=%d, height=%d\n",
-                    clip_region->x,
-                    clip_region->y,
-                    clip_region->width,
-                    clip_region->height);
-
       stage_cogl->using_clipped_redraw = TRUE;
 
-      cogl_clip_push_window_rectangle (clip_region->x,
-                                       clip_region->y,
-                                       clip_region->width,
-                                       clip_region->height);
-      _clutter_stage_do_paint (CLUTTER_STAGE (wrapper),
-                               clip_region);
-      cogl_clip_pop ();
+      for (i = 0; i < n_clip_rects; i++)
+        {
+          const cairo_rectangle_int_t *clip = &clip_rects[i];
+
+          CLUTTER_NOTE (CLIPPING,
+                        "Stage clip pushed: x=%d, y=%d, width=%d, height=%d\n",
+                        clip->x,
+                        clip->y,
+                        clip->width,
+                        clip->height);
+
+          stage_cogl->current_redraw_clip = clip;
+
+          cogl_clip_push_window_rectangle (clip->x,
+                                           clip->y,
+                                           clip->width,
+                                           clip->height);
+          _clutter_stage_do_paint (CLUTTER_STAGE (wrapper), clip);
+          cogl_clip_pop ();
+
+          CLUTTER_COUNTER_INC (_clutter_uprof_context,
+                               clipped_redraw_rects_counter);
+        }
 
+      stage_cogl->current_redraw_clip = NULL;
       stage_cogl->using_clipped_redraw = FALSE;
     }
   else
@@ -543,7 +699,7 @@ clutter_stage_cogl_redraw (ClutterStageWindow *stage_window)
           may_use_clipped_redraw)
         {
           _clutter_stage_do_paint (CLUTTER_STAGE (wrapper),
-                                   clip_region);
+                                   &stage_cogl->bounding_redraw_clip);
         }
       else
         _clutter_stage_do_paint (CLUTTER_STAGE (wrapper), NULL);
@@ -555,19 +711,7 @@ clutter_stage_cogl_redraw (ClutterStageWindow *stage_window)
       CoglFramebuffer *fb = COGL_FRAMEBUFFER (stage_cogl->onscreen);
       CoglContext *ctx = cogl_framebuffer_get_context (fb);
       static CoglPipeline *outline = NULL;
-      cairo_rectangle_int_t *clip = &stage_cogl->bounding_redraw_clip;
       ClutterActor *actor = CLUTTER_ACTOR (wrapper);
-      float x_1 = clip->x;
-      float x_2 = clip->x + clip->width;
-      float y_1 = clip->y;
-      float y_2 = clip->y + clip->height;
-      CoglVertexP2 quad[4] = {
-        { x_1, y_1 },
-        { x_2, y_1 },
-        { x_2, y_2 },
-        { x_1, y_2 }
-      };
-      CoglPrimitive *prim;
       CoglMatrix modelview;
 
       if (outline == NULL)
@@ -576,20 +720,38 @@ clutter_stage_cogl_redraw (ClutterStageWindow *stage_window)
           cogl_pipeline_set_color4ub (outline, 0xff, 0x00, 0x00, 0xff);
         }
 
-      prim = cogl_primitive_new_p2 (ctx,
-                                    COGL_VERTICES_MODE_LINE_LOOP,
-                                    4, /* n_vertices */
-                                    quad);
-
       cogl_framebuffer_push_matrix (fb);
       cogl_matrix_init_identity (&modelview);
       _clutter_actor_apply_modelview_transform (actor, &modelview);
       cogl_framebuffer_set_modelview_matrix (fb, &modelview);
-      cogl_framebuffer_draw_primitive (COGL_FRAMEBUFFER (stage_cogl->onscreen),
-                                       outline,
-                                       prim);
+
+      for (i = 0; i < n_clip_rects; i++)
+        {
+          cairo_rectangle_int_t *clip = &clip_rects[i];
+          float x_1 = clip->x;
+          float x_2 = clip->x + clip->width;
+          float y_1 = clip->y;
+          float y_2 = clip->y + clip->height;
+          CoglVertexP2 quad[4] = {
+            { x_1, y_1 },
+            { x_2, y_1 },
+            { x_2, y_2 },
+            { x_1, y_2 }
+          };
+          CoglPrimitive *prim;
+
+          prim = cogl_primitive_new_p2 (ctx,
+                                        COGL_VERTICES_MODE_LINE_LOOP,
+                                        4, /* n_vertices */
+                                        quad);
+
+          cogl_framebuffer_draw_primitive (COGL_FRAMEBUFFER (stage_cogl->onscreen),
+                                           outline,
+                                           prim);
+          cogl_object_unref (prim);
+        }
+
       cogl_framebuffer_pop_matrix (fb);
-      cogl_object_unref (prim);
     }
 
   CLUTTER_TIMER_STOP (_clutter_uprof_context, painting_timer);
@@ -597,8 +759,7 @@ clutter_stage_cogl_redraw (ClutterStageWindow *stage_window)
   /* push on the screen */
   if (use_clipped_redraw && !force_swap)
     {
-      cairo_rectangle_int_t *clip = clip_region;
-      int copy_area[4];
+      int copy_area[CLUTTER_STAGE_COGL_MAX_REDRAW_CLIPS * 4];
 
       /* XXX: It seems there will be a race here in that the stage
        * window may be resized before the cogl_onscreen_swap_region
@@ -608,23 +769,25 @@ clutter_stage_cogl_redraw (ClutterStageWindow *stage_window)
        * the resize anyway so it should only exhibit temporary
        * artefacts.
        */
-
-      copy_area[0] = clip->x;
-      copy_area[1] = clip->y;
-      copy_area[2] = clip->width;
-      copy_area[3] = clip->height;
-
-      CLUTTER_NOTE (BACKEND,
-                    "cogl_onscreen_swap_region (onscreen: %p, "
-                                                "x: %d, y: %d, "
-                                                "width: %d, height: %d)",
-                    stage_cogl->onscreen,
-                    copy_area[0], copy_area[1], copy_area[2], copy_area[3]);
-
+      for (i = 0; i < n_clip_rects; i++)
+        {
+          copy_area[i * 4 + 0] = clip_rects[i].x;
+          copy_area[i * 4 + 1] = clip_rects[i].y;
+          copy_area[i * 4 + 2] = clip_rects[i].width;
+          copy_area[i * 4 + 3] = clip_rects[i].height;
+
+          CLUTTER_NOTE (BACKEND,
+                        "cogl_onscreen_swap_region (onscreen: %p, "
+                                                    "x: %d, y: %d, "
+                                                    "width: %d, height: %d)",
+                        stage_cogl->onscreen,
+                        copy_area[i * 4 + 0], copy_area[i * 4 + 1],
+                        copy_area[i * 4 + 2], copy_area[i * 4 + 3]);
+        }
 
       CLUTTER_TIMER_START (_clutter_uprof_context, blit_sub_buffer_timer);
 
-      cogl_onscreen_swap_region (stage_cogl->onscreen, copy_area, 1);
+      cogl_onscreen_swap_region (stage_cogl->onscreen, copy_area, n_clip_rects);
 
       CLUTTER_TIMER_STOP (_clutter_uprof_context, blit_sub_buffer_timer);
     }
@@ -646,6 +809,7 @@ clutter_stage_cogl_redraw (ClutterStageWindow *stage_window)
 
   /* reset the redraw clipping for the next paint... */
   stage_cogl->initialized_redraw_clip = FALSE;
+  stage_cogl->n_redraw_clips = 0;
 
   /* We have repaired the backbuffer */
   stage_cogl->dirty_backbuffer = FALSE;
@@ -682,10 +846,10 @@ clutter_stage_cogl_get_dirty_pixel (ClutterStageWindow *stage_window,
       }
     else
      {
-        cairo_rectangle_int_t *rect;
-        rect = (cairo_rectangle_int_t *) (stage_cogl->damage_history->data);
-        *x = rect->x;
-        *y = rect->y;
+        cairo_rectangle_int_t rect;
+        cairo_region_get_extents (stage_cogl->damage_history->data, &rect);
+        *x = rect.x;
+        *y = rect.y;
      }
 }
 
@@ -20,6 +20,8 @@ G_BEGIN_DECLS
 #define CLUTTER_IS_STAGE_COGL_CLASS(klass)       (G_TYPE_CHECK_CLASS_TYPE ((klass), CLUTTER_TYPE_STAGE_COGL))
 #define CLUTTER_STAGE_COGL_GET_CLASS(obj)        (G_TYPE_INSTANCE_GET_CLASS ((obj), CLUTTER_TYPE_STAGE_COGL, ClutterStageCoglClass))
 
+#define CLUTTER_STAGE_COGL_MAX_REDRAW_CLIPS      8
+
 typedef struct _ClutterStageCogl         ClutterStageCogl;
 typedef struct _ClutterStageCoglClass    ClutterStageCoglClass;
 
@@ -49,15 +51,23 @@ struct _ClutterStageCogl
 
   cairo_rectangle_int_t bounding_redraw_clip;
 
+  /* The disjoint rectangles covering the queued redraw clips; see
+   * clutter_stage_cogl_add_redraw_clip() */
+  cairo_rectangle_int_t redraw_clips[CLUTTER_STAGE_COGL_MAX_REDRAW_CLIPS];
+  gint n_redraw_clips;
+
+  /* The rectangle being painted during a clipped redraw */
+  const cairo_rectangle_int_t *current_redraw_clip;
+
   guint initialized_redraw_clip : 1;
 
   /* TRUE if the current paint cycle has a clipped redraw. In that
-     case bounding_redraw_clip specifies the the bounds. */
+     case current_redraw_clip specifies the the bounds. */
   guint using_clipped_redraw : 1;
 
   guint dirty_backbuffer     : 1;
 
-  /* Stores a list of previous damaged areas */
+  /* Stores a list of previous damaged regions */
   GSList *damage_history;
 };
 
@@ -26,11 +26,13 @@
 #endif
 
 #include <linux/input.h>
+#include <sys/ioctl.h>
 #include <sys/stat.h>
 #include <sys/types.h>
 #include <errno.h>
 #include <fcntl.h>
 #include <string.h>
+#include <time.h>
 #include <unistd.h>
 
 #include <glib.h>
@@ -73,6 +75,8 @@ struct _ClutterDeviceManagerEvdevPrivate
   ClutterInputDevice *core_pointer;
   ClutterInputDevice *core_keyboard;
 
+  gint device_id_next;      /* the id of the next device added */
+
   ClutterStageManager *stage_manager;
   guint stage_added_handler;
   guint stage_removed_handler;
@@ -102,6 +106,29 @@ static const char *option_xkb_options = "";
  */
 
 typedef struct _ClutterEventSource  ClutterEventSource;
+typedef struct _ClutterTouchSlot    ClutterTouchSlot;
+
+/* the number of events read from the device at once */
+#define N_EVENTS_PER_READ       64
+
+/* the pending changes of a multi-touch slot */
+enum
+{
+  SLOT_BEGIN  = 1 << 0,
+  SLOT_MOTION = 1 << 1,
+  SLOT_END    = 1 << 2
+};
+
+struct _ClutterTouchSlot
+{
+  gint tracking_id;
+  gint x, y;
+
+  /* the sequence of the current touch point, or NULL */
+  ClutterEventSequence *sequence;
+
+  guint changes;
+};
 
 struct _ClutterEventSource
 {
@@ -112,8 +139,45 @@ struct _ClutterEventSource
   struct xkb_state *xkb;              /* XKB state object */
   gint x, y;                          /* last x, y position for pointers */
   guint32 modifier_state;             /* key modifiers */
+
+  /* the state accumulated until the next SYN_REPORT */
+  gint dx, dy;                        /* relative motion */
+  gint abs_x, abs_y;                  /* absolute position */
+  guint has_abs_motion : 1;
+  guint is_dropping : 1;              /* discarding events after SYN_DROPPED */
+
+  /* the ranges of the absolute axes, if the device reports them */
+  struct input_absinfo abs_info_x, abs_info_y;
+  struct input_absinfo mt_info_x, mt_info_y;
+
+  /* multi-touch state, for devices using the protocol B */
+  guint is_multitouch : 1;
+  ClutterTouchSlot *slots;
+  gint n_slots;
+  gint current_slot;
 };
 
+static ClutterStage *
+get_source_stage (ClutterEventSource *source)
+{
+  ClutterInputDevice *input_device = (ClutterInputDevice *) source->device;
+  ClutterDeviceManager *manager;
+  ClutterStage *stage;
+
+  stage = _clutter_input_device_get_stage (input_device);
+  if (stage != NULL)
+    return stage;
+
+  /* the stage of a touch screen is unset when its last touch point
+   * ends, so fall back to the stage associated with all the devices
+   */
+  manager = clutter_device_manager_get_default ();
+  if (CLUTTER_IS_DEVICE_MANAGER_EVDEV (manager))
+    return CLUTTER_DEVICE_MANAGER_EVDEV (manager)->priv->stage;
+
+  return NULL;
+}
+
 static gboolean
 clutter_event_prepare (GSource *source,
                        gint    *timeout)
@@ -138,7 +202,7 @@ clutter_event_check (GSource *source)
 
   _clutter_threads_acquire_lock ();
 
-  retval = ((event_source->event_poll_fd.revents & G_IO_IN) ||
+  retval = ((event_source->event_poll_fd.revents & (G_IO_IN | G_IO_HUP)) ||
             clutter_events_pending ());
 
   _clutter_threads_release_lock ();
@@ -147,17 +211,41 @@ clutter_event_check (GSource *source)
 }
 
 static void
-queue_event (ClutterEvent *event)
+queue_event (ClutterEvent *event,
+             guint64       time_us)
 {
   if (event == NULL)
     return;
 
+  _clutter_event_set_time_usec (event, time_us);
   _clutter_event_push (event, FALSE);
 }
 
+static inline guint32
+us_to_ms (guint64 time_us)
+{
+  return (guint32) (time_us / 1000);
+}
+
+/* maps the value of an absolute axis to the [0, size) interval; if
+ * the range of the axis is unknown, e.g. when replaying a recording,
+ * the value is used as is
+ */
+static gfloat
+scale_abs_value (const struct input_absinfo *info,
+                 gint                        value,
+                 gfloat                      size)
+{
+  if (info->maximum <= info->minimum)
+    return value;
+
+  return (gfloat) (value - info->minimum) * size
+       / (gfloat) (info->maximum - info->minimum + 1);
+}
+
 static void
 notify_key (ClutterEventSource *source,
-            guint32             time_,
+            guint64             time_us,
             guint32             key,
             guint32             state)
 {
@@ -178,17 +266,17 @@ notify_key (ClutterEventSource *source,
       _clutter_key_event_new_from_evdev (input_device,
                                          stage,
                                          source->xkb,
-                                         time_, key, state);
+                                         us_to_ms (time_us), key, state);
     xkb_state_update_key (source->xkb, key, state ? XKB_KEY_DOWN : XKB_KEY_UP);
   }
 
-  queue_event (event);
+  queue_event (event, time_us);
 }
 
 
 static void
 notify_motion (ClutterEventSource *source,
-               guint32             time_,
+               guint64             time_us,
                gint                x,
                gint                y)
 {
@@ -225,19 +313,19 @@ notify_motion (ClutterEventSource *source,
   source->x = new_x;
   source->y = new_y;
 
-  event->motion.time = time_;
+  event->motion.time = us_to_ms (time_us);
   event->motion.stage = stage;
   event->motion.device = input_device;
   event->motion.modifier_state = source->modifier_state;
   event->motion.x = new_x;
   event->motion.y = new_y;
 
-  queue_event (event);
+  queue_event (event, time_us);
 }
 
 static void
 notify_button (ClutterEventSource *source,
-               guint32             time_,
+               guint64             time_us,
                guint32             button,
                guint32             state)
 {
@@ -247,7 +335,7 @@ notify_button (ClutterEventSource *source,
   gint button_nr;
   static gint maskmap[8] =
     {
-      CLUTTER_BUTTON1_MASK, CLUTTER_BUTTON3_MASK, CLUTTER_BUTTON2_MASK,
+      CLUTTER_BUTTON1_MASK, CLUTTER_BUTTON2_MASK, CLUTTER_BUTTON3_MASK,
       CLUTTER_BUTTON4_MASK, CLUTTER_BUTTON5_MASK, 0, 0, 0
     };
 
@@ -263,6 +351,7 @@ notify_button (ClutterEventSource *source,
   switch (button)
     {
     case BTN_LEFT:
+    case BTN_TOUCH:
       button_nr = CLUTTER_BUTTON_PRIMARY;
       break;
 
@@ -292,11 +381,11 @@ notify_button (ClutterEventSource *source,
 
   /* Update the modifiers */
   if (state)
-    source->modifier_state |= maskmap[button - BTN_LEFT];
+    source->modifier_state |= maskmap[button_nr - 1];
   else
-    source->modifier_state &= ~maskmap[button - BTN_LEFT];
+    source->modifier_state &= ~maskmap[button_nr - 1];
 
-  event->button.time = time_;
+  event->button.time = us_to_ms (time_us);
   event->button.stage = CLUTTER_STAGE (stage);
   event->button.device = (ClutterInputDevice *) source->device;
   event->button.modifier_state = source->modifier_state;
@@ -304,7 +393,387 @@ notify_button (ClutterEventSource *source,
   event->button.x = source->x;
   event->button.y = source->y;
 
-  queue_event (event);
+  queue_event (event, time_us);
+}
+
+static void
+notify_touch (ClutterEventSource   *source,
+              guint64               time_us,
+              ClutterEventType      type,
+              ClutterTouchSlot     *slot)
+{
+  ClutterInputDevice *input_device = (ClutterInputDevice *) source->device;
+  gfloat stage_width, stage_height;
+  ClutterEvent *event;
+  ClutterStage *stage;
+
+  stage = get_source_stage (source);
+  if (!stage)
+    return;
+
+  stage_width = clutter_actor_get_width (CLUTTER_ACTOR (stage));
+  stage_height = clutter_actor_get_height (CLUTTER_ACTOR (stage));
+
+  event = clutter_event_new (type);
+
+  event->touch.time = us_to_ms (time_us);
+  event->touch.stage = stage;
+  event->touch.device = input_device;
+  event->touch.modifier_state = source->modifier_state;
+  event->touch.sequence = slot->sequence;
+  event->touch.x = CLAMP (scale_abs_value (&source->mt_info_x,
+                                           slot->x,
+                                           stage_width),
+                          0.f, stage_width - 1);
+  event->touch.y = CLAMP (scale_abs_value (&source->mt_info_y,
+                                           slot->y,
+                                           stage_height),
+                          0.f, stage_height - 1);
+
+  queue_event (event, time_us);
+}
+
+static ClutterTouchSlot *
+get_current_slot (ClutterEventSource *source)
+{
+  source->is_multitouch = TRUE;
+
+  if (source->current_slot < 0 ||
+      source->current_slot >= CLUTTER_MAX_EVENT_SEQUENCES)
+    return NULL;
+
+  /* the slots of a recorded stream are only known as they are used */
+  if (source->current_slot >= source->n_slots)
+    {
+      gint i;
+
+      source->slots = g_renew (ClutterTouchSlot,
+                               source->slots,
+                               source->current_slot + 1);
+
+      for (i = source->n_slots; i <= source->current_slot; i++)
+        {
+          memset (&source->slots[i], 0, sizeof (ClutterTouchSlot));
+          source->slots[i].tracking_id = -1;
+        }
+
+      source->n_slots = source->current_slot + 1;
+    }
+
+  return &source->slots[source->current_slot];
+}
+
+static void
+flush_motion (ClutterEventSource *source,
+              guint64             time_us)
+{
+  if (source->dx != 0 || source->dy != 0)
+    {
+      notify_motion (source, time_us,
+                     source->x + source->dx,
+                     source->y + source->dy);
+      source->dx = source->dy = 0;
+    }
+
+  if (source->has_abs_motion)
+    {
+      ClutterStage *stage = get_source_stage (source);
+
+      if (stage != NULL)
+        {
+          gfloat width = clutter_actor_get_width (CLUTTER_ACTOR (stage));
+          gfloat height = clutter_actor_get_height (CLUTTER_ACTOR (stage));
+
+          notify_motion (source, time_us,
+                         scale_abs_value (&source->abs_info_x,
+                                          source->abs_x,
+                                          width),
+                         scale_abs_value (&source->abs_info_y,
+                                          source->abs_y,
+                                          height));
+        }
+
+      source->has_abs_motion = FALSE;
+    }
+}
+
+static void
+flush_touch_slots (ClutterEventSource *source,
+                   guint64             time_us)
+{
+  ClutterInputDevice *input_device = (ClutterInputDevice *) source->device;
+  gint i;
+
+  for (i = 0; i < source->n_slots; i++)
+    {
+      ClutterTouchSlot *slot = &source->slots[i];
+
+      if (slot->changes == 0)
+        continue;
+
+      if ((slot->changes & SLOT_BEGIN) && slot->sequence != NULL)
+        {
+          /* the slot has been reassigned without ending its touch point */
+          notify_touch (source, time_us, CLUTTER_TOUCH_END, slot);
+          _clutter_event_sequence_end (slot->sequence);
+          slot->sequence = NULL;
+        }
+
+      if (slot->changes & SLOT_BEGIN)
+        {
+          slot->sequence = _clutter_event_sequence_begin (input_device,
+                                                          slot->tracking_id);
+          if (slot->sequence != NULL)
+            notify_touch (source, time_us, CLUTTER_TOUCH_BEGIN, slot);
+        }
+      else if ((slot->changes & SLOT_MOTION) && slot->sequence != NULL)
+        notify_touch (source, time_us, CLUTTER_TOUCH_UPDATE, slot);
+
+      if ((slot->changes & SLOT_END) && slot->sequence != NULL)
+        {
+          notify_touch (source, time_us, CLUTTER_TOUCH_END, slot);
+          _clutter_event_sequence_end (slot->sequence);
+          slot->sequence = NULL;
+        }
+
+      slot->changes = 0;
+    }
+}
+
+/* some events have been lost by the kernel; the state of the touch
+ * points cannot be trusted anymore, so we cancel them
+ */
+static void
+cancel_touch_slots (ClutterEventSource *source,
+                    guint64             time_us)
+{
+  gint i;
+
+  for (i = 0; i < source->n_slots; i++)
+    {
+      ClutterTouchSlot *slot = &source->slots[i];
+
+      if (slot->sequence != NULL)
+        {
+          notify_touch (source, time_us, CLUTTER_TOUCH_CANCEL, slot);
+          _clutter_event_sequence_end (slot->sequence);
+        }
+
+      slot->sequence = NULL;
+      slot->tracking_id = -1;
+      slot->changes = 0;
+    }
+}
+
+static void
+process_abs_event (ClutterEventSource       *source,
+                   const struct input_event *e)
+{
+  ClutterTouchSlot *slot;
+
+  switch (e->code)
+    {
+    case ABS_MT_SLOT:
+      source->current_slot = e->value;
+      break;
+
+    case ABS_MT_TRACKING_ID:
+      if ((slot = get_current_slot (source)) == NULL)
+        break;
+
+      if (e->value >= 0)
+        {
+          slot->tracking_id = e->value;
+          slot->changes |= SLOT_BEGIN;
+        }
+      else
+        slot->changes |= SLOT_END;
+      break;
+
+    case ABS_MT_POSITION_X:
+      if ((slot = get_current_slot (source)) == NULL)
+        break;
+
+      slot->x = e->value;
+      slot->changes |= SLOT_MOTION;
+      break;
+
+    case ABS_MT_POSITION_Y:
+      if ((slot = get_current_slot (source)) == NULL)
+        break;
+
+      slot->y = e->value;
+      slot->changes |= SLOT_MOTION;
+      break;
+
+    /* multi-touch devices also emulate a single touch device, which
+     * we ignore in favour of the touch points
+     */
+    case ABS_X:
+      if (!source->is_multitouch)
+        {
+          source->abs_x = e->value;
+          source->has_abs_motion = TRUE;
+        }
+      break;
+
+    case ABS_Y:
+      if (!source->is_multitouch)
+        {
+          source->abs_y = e->value;
+          source->has_abs_motion = TRUE;
+        }
+      break;
+
+    default:
+      break;
+    }
+}
+
+static void
+process_events (ClutterEventSource       *source,
+                const struct input_event *ev,
+                gint                      n_events)
+{
+  gint i;
+
+  for (i = 0; i < n_events; i++)
+    {
+      const struct input_event *e = &ev[i];
+      guint64 time_us;
+
+      time_us = (guint64) e->time.tv_sec * G_USEC_PER_SEC + e->time.tv_usec;
+
+      /* after SYN_DROPPED, wait for the next frame */
+      if (source->is_dropping)
+        {
+          if (e->type == EV_SYN && e->code == SYN_REPORT)
+            source->is_dropping = FALSE;
+
+          continue;
+        }
+
+      switch (e->type)
+        {
+        case EV_KEY:
+
+          /* don't repeat mouse buttons */
+          if (e->code >= BTN_MOUSE && e->code < KEY_OK)
+            if (e->value == 2)
+              continue;
+
+          switch (e->code)
+            {
+            case BTN_TOOL_PEN:
+            case BTN_TOOL_RUBBER:
+            case BTN_TOOL_BRUSH:
+            case BTN_TOOL_PENCIL:
+            case BTN_TOOL_AIRBRUSH:
+            case BTN_TOOL_FINGER:
+            case BTN_TOOL_MOUSE:
+            case BTN_TOOL_LENS:
+            case BTN_TOOL_DOUBLETAP:
+            case BTN_TOOL_TRIPLETAP:
+              break;
+
+            case BTN_TOUCH:
+              /* single touch devices are handled like a pointer */
+              if (source->is_multitouch)
+                break;
+
+              /* fall through */
+            case BTN_LEFT:
+            case BTN_RIGHT:
+            case BTN_MIDDLE:
+            case BTN_SIDE:
+            case BTN_EXTRA:
+            case BTN_FORWARD:
+            case BTN_BACK:
+            case BTN_TASK:
+              /* the button event happens at the position reached
+               * in the current frame */
+              flush_motion (source, time_us);
+              notify_button (source, time_us, e->code, e->value);
+              break;
+
+            default:
+              notify_key (source, time_us, e->code, e->value);
+              break;
+            }
+          break;
+
+        case EV_SYN:
+          switch (e->code)
+            {
+            case SYN_REPORT:
+              flush_motion (source, time_us);
+              flush_touch_slots (source, time_us);
+              break;
+
+            case SYN_DROPPED:
+              CLUTTER_NOTE (EVENT, "Events dropped by the kernel");
+              source->dx = source->dy = 0;
+              source->has_abs_motion = FALSE;
+              cancel_touch_slots (source, time_us);
+              source->is_dropping = TRUE;
+              break;
+
+            default:
+              break;
+            }
+          break;
+
+        case EV_MSC:
+          /* Nothing to do here? */
+          break;
+
+        case EV_REL:
+          /* compress the EV_REL events in dx/dy */
+          switch (e->code)
+            {
+            case REL_X:
+              source->dx += e->value;
+              break;
+            case REL_Y:
+              source->dy += e->value;
+              break;
+            }
+          break;
+
+        case EV_ABS:
+          process_abs_event (source, e);
+          break;
+
+        default:
+          g_warning ("Unhandled event of type %d", e->type);
+          break;
+        }
+    }
+}
+
+static void
+remove_source_device (ClutterEventSource *source)
+{
+  ClutterDeviceManager *manager;
+  ClutterInputDevice *device;
+
+  device = CLUTTER_INPUT_DEVICE (source->device);
+
+  manager = clutter_device_manager_get_default ();
+  _clutter_device_manager_remove_device (manager, device);
+}
+
+/* must be called with the Clutter lock held */
+static void
+dispatch_queued_events (void)
+{
+  ClutterEvent *event;
+
+  while ((event = clutter_event_get ()) != NULL)
+    {
+      /* forward the event into clutter for emission etc. */
+      _clutter_do_event (event, FALSE);
+    }
 }
 
 static gboolean
@@ -313,144 +782,63 @@ clutter_event_dispatch (GSource     *g_source,
                         gpointer     user_data)
 {
   ClutterEventSource *source = (ClutterEventSource *) g_source;
-  ClutterInputDevice *input_device = (ClutterInputDevice *) source->device;
-  struct input_event ev[8];
-  ClutterEvent *event;
-  gint len, i, dx = 0, dy = 0;
-  uint32_t _time;
+  struct input_event ev[N_EVENTS_PER_READ];
   ClutterStage *stage;
+  gssize len;
 
   _clutter_threads_acquire_lock ();
 
-  stage = _clutter_input_device_get_stage (input_device);
+  stage = get_source_stage (source);
 
-  /* Don't queue more events if we haven't finished handling the previous batch
+  /* Read everything available, even if some events are still waiting
+   * to be processed, so that the events are queued as soon as possible
+   * and the device buffer does not overflow
    */
-  if (!clutter_events_pending ())
+  while (TRUE)
     {
-       len = read (source->event_poll_fd.fd, &ev, sizeof (ev));
-       if (len < 0 || len % sizeof (ev[0]) != 0)
-       {
-         if (errno != EAGAIN)
-           {
-             ClutterDeviceManager *manager;
-             ClutterInputDevice *device;
-             const gchar *device_path;
-
-             device = CLUTTER_INPUT_DEVICE (source->device);
-
-             if (CLUTTER_HAS_DEBUG (EVENT))
-               {
-                 device_path =
-                   _clutter_input_device_evdev_get_device_path (source->device);
-
-                 CLUTTER_NOTE (EVENT, "Could not read device (%s), removing.",
-                               device_path);
-               }
-
-             /* remove the faulty device */
-             manager = clutter_device_manager_get_default ();
-             _clutter_device_manager_remove_device (manager, device);
-
-           }
-         goto out;
-       }
-
-       /* Drop events if we don't have any stage to forward them to */
-       if (!stage)
-         goto out;
-
-       for (i = 0; i < len / sizeof (ev[0]); i++)
-         {
-           struct input_event *e = &ev[i];
-
-           _time = e->time.tv_sec * 1000 + e->time.tv_usec / 1000;
-           event = NULL;
-
-           switch (e->type)
-             {
-             case EV_KEY:
-
-               /* don't repeat mouse buttons */
-               if (e->code >= BTN_MOUSE && e->code < KEY_OK)
-                 if (e->value == 2)
-                   continue;
-
-               switch (e->code)
-                 {
-                 case BTN_TOUCH:
-                 case BTN_TOOL_PEN:
-                 case BTN_TOOL_RUBBER:
-                 case BTN_TOOL_BRUSH:
-                 case BTN_TOOL_PENCIL:
-                 case BTN_TOOL_AIRBRUSH:
-                 case BTN_TOOL_FINGER:
-                 case BTN_TOOL_MOUSE:
-                 case BTN_TOOL_LENS:
-                   break;
-
-                 case BTN_LEFT:
-                 case BTN_RIGHT:
-                 case BTN_MIDDLE:
-                 case BTN_SIDE:
-                 case BTN_EXTRA:
-                 case BTN_FORWARD:
-                 case BTN_BACK:
-                 case BTN_TASK:
-                   notify_button(source, _time, e->code, e->value);
-                   break;
-
-                 default:
-                   notify_key (source, _time, e->code, e->value);
-                 break;
-                 }
-               break;
-
-             case EV_SYN:
-               /* Nothing to do here? */
-               break;
-
-             case EV_MSC:
-               /* Nothing to do here? */
-               break;
-
-             case EV_REL:
-               /* compress the EV_REL events in dx/dy */
-               switch (e->code)
-                 {
-                 case REL_X:
-                   dx += e->value;
-                   break;
-                 case REL_Y:
-                   dy += e->value;
-                   break;
-                 }
-               break;
-
-             case EV_ABS:
-             default:
-               g_warning ("Unhandled event of type %d", e->type);
-               break;
-             }
-
-           queue_event (event);
-         }
-
-       if (dx != 0 || dy != 0)
-         notify_motion (source, _time, source->x + dx, source->y + dy);
-    }
+      len = read (source->event_poll_fd.fd, &ev, sizeof (ev));
 
-  /* Pop an event off the queue if any */
-  event = clutter_event_get ();
+      if (len < 0 && errno == EINTR)
+        continue;
 
-  if (event)
-    {
-      /* forward the event into clutter for emission etc. */
-      clutter_do_event (event);
-      clutter_event_free (event);
+      if (len < 0 && errno == EAGAIN)
+        break;
+
+      if (len <= 0 || len % sizeof (ev[0]) != 0)
+        {
+          if (CLUTTER_HAS_DEBUG (EVENT))
+            {
+              const gchar *device_path =
+                _clutter_input_device_evdev_get_device_path (source->device);
+
+              if (len == 0)
+                CLUTTER_NOTE (EVENT, "End of the stream (%s), removing.",
+                              device_path);
+              else
+                CLUTTER_NOTE (EVENT, "Could not read device (%s), removing.",
+                              device_path);
+            }
+
+          /* remove the faulty device, or the finished replay; this
+           * queues the cancellation of its touch points, which are
+           * processed below with the events read before
+           */
+          remove_source_device (source);
+          break;
+        }
+
+      /* Drop events if we don't have any stage to forward them to */
+      if (stage != NULL)
+        process_events (source, ev, len / sizeof (ev[0]));
+
+      /* a short read means that we drained the device */
+      if ((gsize) len < sizeof (ev))
+        break;
     }
 
-out:
+  /* Process the queued events */
+  dispatch_queued_events ();
+
   _clutter_threads_release_lock ();
 
   return TRUE;
@@ -462,27 +850,69 @@ static GSourceFuncs event_funcs = {
   NULL
 };
 
+static void
+query_abs_info (gint                  fd,
+                gint                  axis,
+                struct input_absinfo *info)
+{
+  /* leave the range unset for file descriptors that are not
+   * evdev device nodes, e.g. pipes used to replay events
+   */
+  if (ioctl (fd, EVIOCGABS (axis), info) < 0)
+    memset (info, 0, sizeof (struct input_absinfo));
+}
+
+static gboolean
+has_abs_axis (gint fd,
+              gint axis)
+{
+  guint8 bits[ABS_MAX / 8 + 1];
+
+  memset (bits, 0, sizeof (bits));
+
+  if (ioctl (fd, EVIOCGBIT (EV_ABS, sizeof (bits)), bits) < 0)
+    return FALSE;
+
+  return (bits[axis / 8] & (1 << (axis % 8))) != 0;
+}
+
 static GSource *
-clutter_event_source_new (ClutterInputDeviceEvdev *input_device)
+clutter_event_source_new (ClutterInputDeviceEvdev *input_device,
+                          gint                     fd)
 {
-  GSource *source = g_source_new (&event_funcs, sizeof (ClutterEventSource));
-  ClutterEventSource *event_source = (ClutterEventSource *) source;
+  GSource *source;
+  ClutterEventSource *event_source;
   ClutterInputDeviceType type;
+  struct input_absinfo slot_info;
   const gchar *node_path;
-  gint fd;
 
-  /* grab the udev input device node and open it */
   node_path = _clutter_input_device_evdev_get_device_path (input_device);
 
-  CLUTTER_NOTE (EVENT, "Creating GSource for device %s", node_path);
-
-  fd = open (node_path, O_RDONLY | O_NONBLOCK);
   if (fd < 0)
     {
-      g_warning ("Could not open device %s: %s", node_path, strerror (errno));
-      return NULL;
+      /* grab the udev input device node and open it */
+      CLUTTER_NOTE (EVENT, "Creating GSource for device %s", node_path);
+
+      fd = open (node_path, O_RDONLY | O_NONBLOCK);
+      if (fd < 0)
+        {
+          g_warning ("Could not open device %s: %s", node_path, strerror (errno));
+          return NULL;
+        }
     }
 
+#ifdef EVIOCSCLOCKID
+  {
+    /* use the same clock as the frame clock for the event times */
+    gint clock_id = CLOCK_MONOTONIC;
+
+    ioctl (fd, EVIOCSCLOCKID, &clock_id);
+  }
+#endif
+
+  source = g_source_new (&event_funcs, sizeof (ClutterEventSource));
+  event_source = (ClutterEventSource *) source;
+
   /* setup the source */
   event_source->device = input_device;
   event_source->event_poll_fd.fd = fd;
@@ -513,6 +943,24 @@ clutter_event_source_new (ClutterInputDeviceEvdev *input_device)
       event_source->y = 0;
     }
 
+  query_abs_info (fd, ABS_X, &event_source->abs_info_x);
+  query_abs_info (fd, ABS_Y, &event_source->abs_info_y);
+  query_abs_info (fd, ABS_MT_POSITION_X, &event_source->mt_info_x);
+  query_abs_info (fd, ABS_MT_POSITION_Y, &event_source->mt_info_y);
+
+  /* devices using the multi-touch protocol B report their slots */
+  if (has_abs_axis (fd, ABS_MT_SLOT))
+    {
+      query_abs_info (fd, ABS_MT_SLOT, &slot_info);
+
+      /* allocate all the slots, and the current one */
+      event_source->current_slot = CLAMP (slot_info.maximum,
+                                          0,
+                                          CLUTTER_MAX_EVENT_SEQUENCES - 1);
+      get_current_slot (event_source);
+      event_source->current_slot = slot_info.value;
+    }
+
   /* and finally configure and attach the GSource */
   g_source_set_priority (source, CLUTTER_PRIORITY_EVENTS);
   g_source_add_poll (source, &event_source->event_poll_fd);
@@ -536,6 +984,11 @@ clutter_event_source_free (ClutterEventSource *source)
    * about it */
   close (source->event_poll_fd.fd);
 
+  /* the touch points still active will never end */
+  cancel_touch_slots (source, g_get_monotonic_time ());
+
+  g_free (source->slots);
+
   g_source_destroy (g_source);
   g_source_unref (g_source);
 }
@@ -612,7 +1065,7 @@ evdev_add_device (ClutterDeviceManagerEvdev *manager_evdev,
     type = CLUTTER_TOUCHSCREEN_DEVICE;
 
   device = g_object_new (CLUTTER_TYPE_INPUT_DEVICE_EVDEV,
-                         "id", 0,
+                         "id", manager_evdev->priv->device_id_next++,
                          "name", device_name,
                          "device-type", type,
                          "sysfs-path", sysfs_path,
@@ -688,7 +1141,17 @@ on_uevent (GUdevClient *client,
   if (g_strcmp0 (action, "add") == 0)
     evdev_add_device (manager, device);
   else if (g_strcmp0 (action, "remove") == 0)
-    evdev_remove_device (manager, device);
+    {
+      _clutter_threads_acquire_lock ();
+
+      /* the source of the device is gone, so the cancellation of its
+       * touch points is processed here
+       */
+      evdev_remove_device (manager, device);
+      dispatch_queued_events ();
+
+      _clutter_threads_release_lock ();
+    }
 }
 
 /*
@@ -723,8 +1186,12 @@ clutter_device_manager_evdev_add_device (ClutterDeviceManager *manager,
   if (is_keyboard && priv->core_keyboard == NULL)
     priv->core_keyboard = device;
 
+  /* devices reading from a file descriptor already have a source */
+  if (find_source_by_device (manager_evdev, device) != NULL)
+    return;
+
   /* Install the GSource for this device */
-  source = clutter_event_source_new (device_evdev);
+  source = clutter_event_source_new (device_evdev, -1);
   if (G_LIKELY (source))
     priv->event_sources = g_slist_prepend (priv->event_sources, source);
 }
@@ -892,14 +1359,9 @@ clutter_device_manager_evdev_finalize (GObject *object)
 
   g_object_unref (priv->udev_client);
 
-  for (l = priv->devices; l; l = g_slist_next (l))
-    {
-      ClutterInputDevice *device = l->data;
-
-      g_object_unref (device);
-    }
-  g_slist_free (priv->devices);
-
+  /* the sources are freed first, as they cancel the touch points of
+   * their devices
+   */
   for (l = priv->event_sources; l; l = g_slist_next (l))
     {
       ClutterEventSource *source = l->data;
@@ -908,6 +1370,14 @@ clutter_device_manager_evdev_finalize (GObject *object)
     }
   g_slist_free (priv->event_sources);
 
+  for (l = priv->devices; l; l = g_slist_next (l))
+    {
+      ClutterInputDevice *device = l->data;
+
+      g_object_unref (device);
+    }
+  g_slist_free (priv->devices);
+
   G_OBJECT_CLASS (clutter_device_manager_evdev_parent_class)->finalize (object);
 }
 
@@ -982,6 +1452,22 @@ clutter_device_manager_evdev_stage_removed_cb (ClutterStageManager *manager,
       if (_clutter_input_device_get_stage (device) == stage)
         _clutter_input_device_set_stage (device, NULL);
     }
+
+  /* the devices added later, and the touch screens between two touch
+   * points, would use the removed stage; associate them with the next
+   * stage created instead
+   */
+  if (priv->stage == stage)
+    {
+      priv->stage = NULL;
+
+      if (priv->stage_added_handler == 0)
+        priv->stage_added_handler =
+          g_signal_connect (priv->stage_manager,
+                            "stage-added",
+                            G_CALLBACK (clutter_device_manager_evdev_stage_added_cb),
+                            self);
+    }
 }
 
 static void
@@ -1126,3 +1612,90 @@ clutter_evdev_reclaim_devices (void)
   priv->released = FALSE;
   clutter_device_manager_evdev_probe_devices (evdev_manager);
 }
+
+/**
+ * clutter_evdev_add_device_for_fd:
+ * @fd: a file descriptor returning <structname>input_event</structname>
+ *   structures
+ * @device_type: the type of the device
+ * @name: the name of the device
+ *
+ * Adds an input device reading its events from @fd, which can be the
+ * file descriptor of an evdev device node opened by the application,
+ * or the reading end of a pipe used to replay a recording of the
+ * events of a device. When the axis ranges of the device cannot be
+ * queried, as is the case with pipes, absolute coordinates are used
+ * as stage coordinates.
+ *
+ * The events must be written in whole <structname>input_event</structname>
+ * structures, and framed by %SYN_REPORT events like the kernel does.
+ *
+ * Clutter takes ownership of @fd, which will be closed when the device
+ * is removed, or when the end of the stream has been reached.
+ *
+ * This function should only be called after clutter has been initialized.
+ *
+ * Return value: (transfer none): the new #ClutterInputDevice, or %NULL
+ *
+ * Since: 1.14
+ * Stability: unstable
+ */
+ClutterInputDevice *
+clutter_evdev_add_device_for_fd (gint                    fd,
+                                 ClutterInputDeviceType  device_type,
+                                 const gchar            *name)
+{
+  ClutterDeviceManager *manager = clutter_device_manager_get_default ();
+  ClutterDeviceManagerEvdev *evdev_manager;
+  ClutterDeviceManagerEvdevPrivate *priv;
+  ClutterInputDevice *device;
+  GSource *source;
+  gint flags;
+
+  if (!manager)
+    {
+      g_warning ("clutter_evdev_add_device_for_fd shouldn't be called "
+                 "before clutter_init()");
+      return NULL;
+    }
+
+  g_return_val_if_fail (CLUTTER_IS_DEVICE_MANAGER_EVDEV (manager), NULL);
+  g_return_val_if_fail (fd >= 0, NULL);
+
+  evdev_manager = CLUTTER_DEVICE_MANAGER_EVDEV (manager);
+  priv = evdev_manager->priv;
+
+  flags = fcntl (fd, F_GETFL);
+  if (flags < 0 || fcntl (fd, F_SETFL, flags | O_NONBLOCK) < 0)
+    {
+      g_warning ("Could not set the file descriptor %d as non blocking: %s",
+                 fd, strerror (errno));
+      close (fd);
+      return NULL;
+    }
+
+  device = g_object_new (CLUTTER_TYPE_INPUT_DEVICE_EVDEV,
+                         "id", priv->device_id_next++,
+                         "name", name,
+                         "device-type", device_type,
+                         "enabled", TRUE,
+                         NULL);
+
+  source = clutter_event_source_new (CLUTTER_INPUT_DEVICE_EVDEV (device), fd);
+  if (source == NULL)
+    {
+      g_object_unref (device);
+      return NULL;
+    }
+
+  priv->event_sources = g_slist_prepend (priv->event_sources, source);
+
+  _clutter_input_device_set_stage (device, priv->stage);
+
+  _clutter_device_manager_add_device (manager, device);
+
+  CLUTTER_NOTE (EVENT, "Added device '%s' for fd %d, type %d",
+                name, fd, device_type);
+
+  return device;
+}
@@ -33,6 +33,10 @@ G_BEGIN_DECLS
 void  clutter_evdev_release_devices (void);
 void  clutter_evdev_reclaim_devices (void);
 
+ClutterInputDevice *clutter_evdev_add_device_for_fd (gint                    fd,
+                                                     ClutterInputDeviceType  device_type,
+                                                     const gchar            *name);
+
 G_END_DECLS
 
 #endif /* __CLUTTER_EVDEV_H__ */
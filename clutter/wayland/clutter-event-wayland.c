@@ -33,6 +33,7 @@
 #include <wayland-client.h>
 
 #include "clutter-event.h"
+#include "clutter-event-private.h"
 #include "clutter-main.h"
 #include "clutter-private.h"
 
@@ -103,8 +104,7 @@ clutter_event_source_wayland_dispatch (GSource *base,
   if (event)
     {
       /* forward the event into clutter for emission etc. */
-      clutter_do_event (event);
-      clutter_event_free (event);
+      _clutter_do_event (event, FALSE);
     }
 
   _clutter_threads_release_lock ();
@@ -180,3 +180,146 @@ actor_destruction (void)
   clutter_actor_destroy (test);
   g_assert (destroy_called);
 }
+
+typedef struct {
+  ClutterActor *victim;
+  gboolean destroyed;
+} RedrawDestroyData;
+
+static void
+on_queue_redraw_destroy (ClutterActor      *actor,
+                         ClutterActor      *origin,
+                         RedrawDestroyData *data)
+{
+  if (data->destroyed || origin != actor)
+    return;
+
+  /* the victim has an entry in the redraw queue being processed; the
+   * new request gives it a second entry in the pending queue, and both
+   * have to be invalidated when it is destroyed
+   */
+  clutter_actor_queue_redraw (data->victim);
+  clutter_actor_destroy (data->victim);
+  data->victim = NULL;
+  data->destroyed = TRUE;
+}
+
+static gboolean
+quit_after_paint (gpointer data G_GNUC_UNUSED)
+{
+  clutter_main_quit ();
+
+  return G_SOURCE_REMOVE;
+}
+
+void
+actor_destroy_queued_redraw (void)
+{
+  ClutterActor *stage = clutter_stage_new ();
+  ClutterActor *first = clutter_actor_new ();
+  RedrawDestroyData data = { NULL, FALSE };
+
+  clutter_actor_set_size (first, 10, 10);
+  clutter_actor_add_child (stage, first);
+
+  data.victim = clutter_actor_new ();
+  clutter_actor_set_size (data.victim, 10, 10);
+  clutter_actor_add_child (stage, data.victim);
+
+  g_signal_connect (first, "queue-redraw",
+                    G_CALLBACK (on_queue_redraw_destroy),
+                    &data);
+
+  clutter_actor_show (stage);
+
+  /* the entries are processed in order, so the victim is destroyed
+   * before its entry is reached
+   */
+  clutter_actor_queue_redraw (first);
+  clutter_actor_queue_redraw (data.victim);
+
+  clutter_threads_add_repaint_func_full (CLUTTER_REPAINT_FLAGS_POST_PAINT,
+                                         quit_after_paint,
+                                         NULL, NULL);
+  clutter_main ();
+
+  g_assert (data.destroyed);
+
+  clutter_actor_destroy (stage);
+}
+
+typedef struct {
+  ClutterActor *requeuer;
+  ClutterActor *victim;
+  gboolean requeued;
+  gboolean destroyed;
+} RedrawRequeueData;
+
+static void
+on_queue_redraw_requeue (ClutterActor      *actor,
+                         ClutterActor      *origin,
+                         RedrawRequeueData *data)
+{
+  if (data->requeued || origin != actor)
+    return;
+
+  /* the victim has not been reached yet in the redraw queue being
+   * processed, so the new request gives it a second entry in the
+   * pending queue
+   */
+  clutter_actor_queue_redraw (data->victim);
+  data->requeued = TRUE;
+}
+
+static void
+on_queue_redraw_destroy_self (ClutterActor      *actor,
+                              ClutterActor      *origin,
+                              RedrawRequeueData *data)
+{
+  if (data->destroyed || origin != actor)
+    return;
+
+  /* the entry in the pending queue is still referenced by the victim,
+   * and it has to be invalidated as well
+   */
+  clutter_actor_destroy (actor);
+  data->victim = NULL;
+  data->destroyed = TRUE;
+}
+
+void
+actor_destroy_requeued_redraw (void)
+{
+  ClutterActor *stage = clutter_stage_new ();
+  RedrawRequeueData data = { NULL, NULL, FALSE, FALSE };
+
+  data.requeuer = clutter_actor_new ();
+  clutter_actor_set_size (data.requeuer, 10, 10);
+  clutter_actor_add_child (stage, data.requeuer);
+
+  data.victim = clutter_actor_new ();
+  clutter_actor_set_size (data.victim, 10, 10);
+  clutter_actor_add_child (stage, data.victim);
+
+  g_signal_connect (data.requeuer, "queue-redraw",
+                    G_CALLBACK (on_queue_redraw_requeue),
+                    &data);
+  g_signal_connect (data.victim, "queue-redraw",
+                    G_CALLBACK (on_queue_redraw_destroy_self),
+                    &data);
+
+  clutter_actor_show (stage);
+
+  clutter_actor_queue_redraw (data.requeuer);
+  clutter_actor_queue_redraw (data.victim);
+
+  clutter_threads_add_repaint_func_full (CLUTTER_REPAINT_FLAGS_POST_PAINT,
+                                         quit_after_paint,
+                                         NULL, NULL);
+  clutter_main ();
+
+  g_assert (data.requeued);
+  g_assert (data.destroyed);
+
+  clutter_actor_destroy (stage);
+}
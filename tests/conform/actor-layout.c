@@ -294,3 +294,74 @@ actor_margin_layout (TestConformSimpleFixture *fixture,
 
   test_state_free (state);
 }
+
+static gboolean
+quit_after_paint (gpointer data)
+{
+  clutter_main_quit ();
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+run_one_frame (ClutterActor *stage)
+{
+  clutter_threads_add_repaint_func_full (CLUTTER_REPAINT_FLAGS_POST_PAINT,
+                                         quit_after_paint,
+                                         NULL, NULL);
+  clutter_actor_queue_redraw (stage);
+  clutter_main ();
+}
+
+void
+actor_boundary_expand (TestConformSimpleFixture *fixture,
+                       gconstpointer data)
+{
+  ClutterActor *stage = clutter_stage_new ();
+  ClutterActor *vase, *pot, *flower, *leaf;
+
+  /* both the vase and the pot have a fixed size, so a relayout queued
+   * by their children can stop at them
+   */
+  vase = clutter_actor_new ();
+  clutter_actor_set_layout_manager (vase, clutter_box_layout_new ());
+  clutter_actor_set_size (vase, 400, 100);
+  clutter_actor_add_child (stage, vase);
+
+  pot = clutter_actor_new ();
+  clutter_actor_set_size (pot, 100, 100);
+  clutter_actor_set_name (pot, "Pot");
+  clutter_actor_add_child (vase, pot);
+
+  flower = clutter_actor_new ();
+  clutter_actor_set_size (flower, 100, 100);
+  clutter_actor_set_name (flower, "Flower");
+  clutter_actor_add_child (vase, flower);
+
+  leaf = clutter_actor_new ();
+  clutter_actor_set_size (leaf, 50, 50);
+  clutter_actor_add_child (pot, leaf);
+
+  clutter_actor_show (stage);
+  run_one_frame (stage);
+
+  g_assert_cmpfloat (clutter_actor_get_width (pot), ==, 100);
+  g_assert_cmpfloat (clutter_actor_get_x (flower), ==, 100);
+
+  /* the pot expands because of its child, so the vase has to give it
+   * the extra space
+   */
+  clutter_actor_set_x_expand (leaf, TRUE);
+  run_one_frame (stage);
+
+  if (g_test_verbose ())
+    g_print ("pot: %.2f, flower: %.2f\n",
+             clutter_actor_get_width (pot),
+             clutter_actor_get_x (flower));
+
+  g_assert (clutter_actor_needs_expand (pot, CLUTTER_ORIENTATION_HORIZONTAL));
+  g_assert_cmpfloat (clutter_actor_get_width (pot), ==, 300);
+  g_assert_cmpfloat (clutter_actor_get_x (flower), ==, 300);
+
+  clutter_actor_destroy (stage);
+}
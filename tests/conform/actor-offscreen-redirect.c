@@ -346,3 +346,269 @@ actor_offscreen_redirect (TestConformSimpleFixture *fixture,
     g_print ("Skipping\n");
 }
 
+
+typedef struct
+{
+  ClutterActor *stage;
+  FooActor *actors[2];
+  ClutterEffect *effects[2];
+} PoolData;
+
+static void
+paint_pool_stage (PoolData *data)
+{
+  /* reading the pixels causes a redraw */
+  g_free (clutter_stage_read_pixels (CLUTTER_STAGE (data->stage),
+                                     0, 0, /* x/y */
+                                     1, 1 /* width/height */));
+}
+
+static gboolean
+pool_timeout_cb (gpointer user_data)
+{
+  PoolData *data = user_data;
+  ClutterOffscreenEffect *effect;
+  CoglHandle texture, other_texture;
+  gfloat width, height, new_width, new_height;
+
+  effect = CLUTTER_OFFSCREEN_EFFECT (data->effects[0]);
+
+  /* Within the budget of the pool both effects keep their own buffers,
+     so painting the stage again should not cause the actors to be
+     painted */
+  data->actors[0]->paint_count = 0;
+  data->actors[1]->paint_count = 0;
+  paint_pool_stage (data);
+  g_assert_cmpint (data->actors[0]->paint_count, ==, 0);
+  g_assert_cmpint (data->actors[1]->paint_count, ==, 0);
+
+  texture = clutter_offscreen_effect_get_texture (effect);
+  other_texture =
+    clutter_offscreen_effect_get_texture (CLUTTER_OFFSCREEN_EFFECT (data->effects[1]));
+  g_assert (texture != NULL);
+  g_assert (other_texture != NULL);
+  g_assert (texture != other_texture);
+
+  /* The size of the texture is rounded up */
+  g_assert (clutter_offscreen_effect_get_target_size (effect, &width, &height));
+  g_assert_cmpint (cogl_texture_get_width (texture) % 32, ==, 0);
+  g_assert_cmpint (cogl_texture_get_height (texture) % 32, ==, 0);
+  g_assert_cmpfloat (width, <=, cogl_texture_get_width (texture));
+  g_assert_cmpfloat (height, <=, cogl_texture_get_height (texture));
+
+  /* Growing the actor by a few pixels should not change the texture */
+  clutter_actor_set_size (CLUTTER_ACTOR (data->actors[0]), 54, 54);
+  paint_pool_stage (data);
+  g_assert_cmpint (data->actors[0]->paint_count, ==, 1);
+  g_assert (clutter_offscreen_effect_get_texture (effect) == texture);
+
+  g_assert (clutter_offscreen_effect_get_target_size (effect,
+                                                      &new_width,
+                                                      &new_height));
+  g_assert_cmpfloat (new_width, >, width);
+  g_assert_cmpfloat (new_height, >, height);
+
+  g_assert (!clutter_offscreen_effect_get_cache_target (effect));
+  clutter_offscreen_effect_set_cache_target (effect, TRUE);
+  g_assert (clutter_offscreen_effect_get_cache_target (effect));
+
+  /* A kept buffer is still reused */
+  data->actors[0]->paint_count = 0;
+  paint_pool_stage (data);
+  paint_pool_stage (data);
+  g_assert_cmpint (data->actors[0]->paint_count, ==, 0);
+  g_assert (clutter_offscreen_effect_get_texture (effect) == texture);
+
+  clutter_main_quit ();
+
+  return G_SOURCE_REMOVE;
+}
+
+void
+actor_offscreen_pool (TestConformSimpleFixture *fixture,
+                      gconstpointer test_data)
+{
+  static const ClutterColor tint = { 0x80, 0x80, 0xff, 0xff };
+  PoolData data;
+  int i;
+
+  if (!cogl_features_available (COGL_FEATURE_OFFSCREEN) ||
+      !clutter_feature_available (CLUTTER_FEATURE_SHADERS_GLSL))
+    {
+      if (g_test_verbose ())
+        g_print ("Skipping\n");
+
+      return;
+    }
+
+  data.stage = clutter_stage_new ();
+
+  for (i = 0; i < 2; i++)
+    {
+      data.actors[i] = g_object_new (foo_actor_get_type (), NULL);
+      clutter_actor_set_size (CLUTTER_ACTOR (data.actors[i]), 50, 50);
+      clutter_actor_set_position (CLUTTER_ACTOR (data.actors[i]),
+                                  i * 100, 0);
+
+      data.effects[i] = clutter_colorize_effect_new (&tint);
+      clutter_actor_add_effect (CLUTTER_ACTOR (data.actors[i]),
+                                data.effects[i]);
+
+      clutter_actor_add_child (data.stage, CLUTTER_ACTOR (data.actors[i]));
+    }
+
+  clutter_actor_show (data.stage);
+
+  /* Start the test after a short delay to allow the stage to
+     render its initial frames without affecting the results */
+  g_timeout_add_full (G_PRIORITY_LOW, 250, pool_timeout_cb, &data, NULL);
+
+  clutter_main ();
+
+  clutter_actor_destroy (data.stage);
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+}
+
+/* the default budget of the offscreen pool of a stage, in bytes */
+#define POOL_BUDGET     (16 * 1024 * 1024)
+
+static gboolean
+pool_budget_timeout_cb (gpointer user_data)
+{
+  PoolData *data = user_data;
+  ClutterOffscreenEffect *effects[2];
+  CoglHandle texture;
+  int i;
+
+  effects[0] = CLUTTER_OFFSCREEN_EFFECT (data->effects[0]);
+  effects[1] = CLUTTER_OFFSCREEN_EFFECT (data->effects[1]);
+
+  /* A single target bigger than the budget is kept by its owner
+     across frames, instead of being allocated again every time */
+  clutter_actor_hide (CLUTTER_ACTOR (data->actors[1]));
+  paint_pool_stage (data);
+
+  texture = clutter_offscreen_effect_get_texture (effects[0]);
+  g_assert (texture != NULL);
+  g_assert_cmpint ((gsize) cogl_texture_get_width (texture) *
+                   cogl_texture_get_height (texture) * 4,
+                   >,
+                   POOL_BUDGET);
+
+  data->actors[0]->paint_count = 0;
+  paint_pool_stage (data);
+  paint_pool_stage (data);
+  g_assert_cmpint (data->actors[0]->paint_count, ==, 0);
+  g_assert (clutter_offscreen_effect_get_texture (effects[0]) == texture);
+
+  /* Two targets that do not fit in the budget together cannot both be
+     kept: leasing the second one evicts the first one, and its effect
+     loses its texture, so the actor has to be painted again */
+  clutter_actor_set_size (CLUTTER_ACTOR (data->actors[0]), 1500, 1500);
+  clutter_actor_show (CLUTTER_ACTOR (data->actors[1]));
+
+  for (i = 0; i < 3; i++)
+    {
+      data->actors[0]->paint_count = 0;
+      data->actors[1]->paint_count = 0;
+      paint_pool_stage (data);
+
+      if (g_test_verbose ())
+        g_print ("frame %d: paints %d/%d, textures %p/%p\n",
+                 i,
+                 data->actors[0]->paint_count,
+                 data->actors[1]->paint_count,
+                 clutter_offscreen_effect_get_texture (effects[0]),
+                 clutter_offscreen_effect_get_texture (effects[1]));
+
+      g_assert_cmpint (data->actors[0]->paint_count, ==, 1);
+      g_assert_cmpint (data->actors[1]->paint_count, ==, 1);
+
+      /* the first target was revoked when the second one was leased */
+      g_assert (clutter_offscreen_effect_get_texture (effects[0]) == NULL);
+      g_assert (clutter_offscreen_effect_get_texture (effects[1]) != NULL);
+    }
+
+  /* Once the actors fit in the budget again, they keep their own
+     targets */
+  clutter_actor_set_size (CLUTTER_ACTOR (data->actors[0]), 50, 50);
+  clutter_actor_set_size (CLUTTER_ACTOR (data->actors[1]), 50, 50);
+  paint_pool_stage (data);
+
+  data->actors[0]->paint_count = 0;
+  data->actors[1]->paint_count = 0;
+  paint_pool_stage (data);
+  g_assert_cmpint (data->actors[0]->paint_count, ==, 0);
+  g_assert_cmpint (data->actors[1]->paint_count, ==, 0);
+  g_assert (clutter_offscreen_effect_get_texture (effects[0]) != NULL);
+  g_assert (clutter_offscreen_effect_get_texture (effects[1]) != NULL);
+
+  clutter_main_quit ();
+
+  return G_SOURCE_REMOVE;
+}
+
+void
+actor_offscreen_pool_budget (TestConformSimpleFixture *fixture,
+                             gconstpointer test_data)
+{
+  static const ClutterColor tint = { 0x80, 0x80, 0xff, 0xff };
+  CoglHandle probe;
+  PoolData data;
+  int i;
+
+  if (!cogl_features_available (COGL_FEATURE_OFFSCREEN) ||
+      !clutter_feature_available (CLUTTER_FEATURE_SHADERS_GLSL) ||
+      g_getenv ("CLUTTER_OFFSCREEN_BUDGET") != NULL)
+    {
+      if (g_test_verbose ())
+        g_print ("Skipping\n");
+
+      return;
+    }
+
+  /* the first target is bigger than the budget */
+  probe = cogl_texture_new_with_size (2080, 2080,
+                                      COGL_TEXTURE_NO_SLICING,
+                                      COGL_PIXEL_FORMAT_RGBA_8888_PRE);
+  if (probe == NULL)
+    {
+      if (g_test_verbose ())
+        g_print ("Skipping: the textures cannot be big enough\n");
+
+      return;
+    }
+
+  cogl_handle_unref (probe);
+
+  data.stage = clutter_stage_new ();
+
+  for (i = 0; i < 2; i++)
+    {
+      data.actors[i] = g_object_new (foo_actor_get_type (), NULL);
+      clutter_actor_set_size (CLUTTER_ACTOR (data.actors[i]), 1500, 1500);
+      clutter_actor_set_position (CLUTTER_ACTOR (data.actors[i]),
+                                  i * 100, 0);
+
+      data.effects[i] = clutter_colorize_effect_new (&tint);
+      clutter_actor_add_effect (CLUTTER_ACTOR (data.actors[i]),
+                                data.effects[i]);
+
+      clutter_actor_add_child (data.stage, CLUTTER_ACTOR (data.actors[i]));
+    }
+
+  clutter_actor_set_size (CLUTTER_ACTOR (data.actors[0]), 2070, 2070);
+
+  clutter_actor_show (data.stage);
+
+  g_timeout_add_full (G_PRIORITY_LOW, 250, pool_budget_timeout_cb, &data, NULL);
+
+  clutter_main ();
+
+  clutter_actor_destroy (data.stage);
+
+  if (g_test_verbose ())
+    g_print ("OK\n");
+}
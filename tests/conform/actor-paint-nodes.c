@@ -0,0 +1,429 @@
+#include <stdlib.h>
+#include <string.h>
+#include <clutter/clutter.h>
+
+#include "test-conform-common.h"
+
+/* a content painting the left half of the content box with its color,
+ * and counting how many times it has been asked to paint
+ */
+typedef struct _TestContent             TestContent;
+typedef struct _GObjectClass            TestContentClass;
+
+struct _TestContent
+{
+  GObject parent_instance;
+
+  ClutterColor color;
+
+  guint n_paints;
+};
+
+GType test_content_get_type (void);
+
+static void test_content_iface_init (ClutterContentIface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (TestContent, test_content, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (CLUTTER_TYPE_CONTENT,
+                                                test_content_iface_init));
+
+static void
+test_content_paint_content (ClutterContent   *content,
+                            ClutterActor     *actor,
+                            ClutterPaintNode *root)
+{
+  TestContent *self = (TestContent *) content;
+  ClutterPaintNode *node;
+  ClutterActorBox box;
+  ClutterColor color;
+
+  self->n_paints += 1;
+
+  color = self->color;
+  color.alpha = clutter_actor_get_paint_opacity (actor) * color.alpha / 255;
+
+  clutter_actor_get_content_box (actor, &box);
+  box.x2 = box.x1 + (box.x2 - box.x1) / 2;
+
+  node = clutter_color_node_new (&color);
+  clutter_paint_node_add_rectangle (node, &box);
+  clutter_paint_node_add_child (root, node);
+  clutter_paint_node_unref (node);
+}
+
+static void
+test_content_iface_init (ClutterContentIface *iface)
+{
+  iface->paint_content = test_content_paint_content;
+}
+
+static void
+test_content_class_init (TestContentClass *klass)
+{
+}
+
+static void
+test_content_init (TestContent *self)
+{
+}
+
+static gboolean
+quit_after_paint (gpointer data)
+{
+  clutter_main_quit ();
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+run_one_frame (ClutterActor *stage)
+{
+  clutter_threads_add_repaint_func_full (CLUTTER_REPAINT_FLAGS_POST_PAINT,
+                                         quit_after_paint,
+                                         NULL, NULL);
+  clutter_actor_queue_redraw (stage);
+  clutter_main ();
+}
+
+static void
+check_pixel (ClutterActor *stage,
+             gint          x,
+             gint          y,
+             guint8        red,
+             guint8        green,
+             guint8        blue)
+{
+  guchar *pixel;
+
+  pixel = clutter_stage_read_pixels (CLUTTER_STAGE (stage), x, y, 1, 1);
+
+  if (g_test_verbose ())
+    g_print ("pixel %d,%d: #%02x%02x%02x (expected: #%02x%02x%02x)\n",
+             x, y,
+             pixel[0], pixel[1], pixel[2],
+             red, green, blue);
+
+  g_assert_cmpint (abs (pixel[0] - red), <=, 2);
+  g_assert_cmpint (abs (pixel[1] - green), <=, 2);
+  g_assert_cmpint (abs (pixel[2] - blue), <=, 2);
+
+  g_free (pixel);
+}
+
+/* checks that the paint nodes of an actor are retained while nothing
+ * changes, and built again when something they depend on changes
+ */
+void
+actor_paint_nodes_retained (TestConformSimpleFixture *fixture,
+                            gconstpointer             data)
+{
+  ClutterActor *stage, *parent, *actor;
+  TestContent *content;
+  const gchar *paint_debug;
+  guint n_paints;
+
+  stage = clutter_stage_new ();
+  clutter_stage_set_color (CLUTTER_STAGE (stage), CLUTTER_COLOR_Black);
+
+  /* the parent is never redirected offscreen, so its opacity changes
+   * the paint opacity of the actor
+   */
+  parent = clutter_actor_new ();
+  clutter_actor_set_size (parent, 100, 100);
+  clutter_actor_set_offscreen_redirect (parent, 0);
+  clutter_actor_add_child (stage, parent);
+
+  content = g_object_new (test_content_get_type (), NULL);
+  content->color = *CLUTTER_COLOR_Red;
+
+  actor = clutter_actor_new ();
+  clutter_actor_set_position (actor, 10, 10);
+  clutter_actor_set_size (actor, 50, 50);
+  clutter_actor_set_content (actor, CLUTTER_CONTENT (content));
+  clutter_actor_add_child (parent, actor);
+
+  clutter_actor_show (stage);
+
+  run_one_frame (stage);
+  check_pixel (stage, 20, 30, 0xff, 0x00, 0x00);
+  g_assert_cmpuint (content->n_paints, >, 0);
+
+  /* the retained nodes are reused while nothing changes */
+  paint_debug = g_getenv ("CLUTTER_PAINT");
+  if (paint_debug == NULL ||
+      strstr (paint_debug, "disable-retained-paint-nodes") == NULL)
+    {
+      n_paints = content->n_paints;
+      run_one_frame (stage);
+      g_assert_cmpuint (content->n_paints, ==, n_paints);
+      check_pixel (stage, 20, 30, 0xff, 0x00, 0x00);
+    }
+
+  /* content change */
+  n_paints = content->n_paints;
+  content->color = *CLUTTER_COLOR_Green;
+  clutter_content_invalidate (CLUTTER_CONTENT (content));
+  run_one_frame (stage);
+  g_assert_cmpuint (content->n_paints, >, n_paints);
+  check_pixel (stage, 20, 30, 0x00, 0xff, 0x00);
+
+  /* background color change; the background is only visible on the
+   * right half of the actor
+   */
+  check_pixel (stage, 50, 30, 0x00, 0x00, 0x00);
+  n_paints = content->n_paints;
+  clutter_actor_set_background_color (actor, CLUTTER_COLOR_Blue);
+  run_one_frame (stage);
+  g_assert_cmpuint (content->n_paints, >, n_paints);
+  check_pixel (stage, 50, 30, 0x00, 0x00, 0xff);
+  check_pixel (stage, 20, 30, 0x00, 0xff, 0x00);
+
+  /* parent opacity change, which is not queueing a redraw on the actor */
+  n_paints = content->n_paints;
+  clutter_actor_set_opacity (parent, 0x80);
+  run_one_frame (stage);
+  g_assert_cmpuint (content->n_paints, >, n_paints);
+  check_pixel (stage, 20, 30, 0x00, 0x80, 0x00);
+
+  clutter_actor_set_opacity (parent, 0xff);
+  run_one_frame (stage);
+  check_pixel (stage, 20, 30, 0x00, 0xff, 0x00);
+
+  /* resize; the left half of the actor now covers the previous right half */
+  n_paints = content->n_paints;
+  clutter_actor_set_size (actor, 100, 50);
+  run_one_frame (stage);
+  g_assert_cmpuint (content->n_paints, >, n_paints);
+  check_pixel (stage, 50, 30, 0x00, 0xff, 0x00);
+  check_pixel (stage, 90, 30, 0x00, 0x00, 0xff);
+
+  clutter_actor_destroy (stage);
+  g_object_unref (content);
+}
+
+#define GRID_SIZE       8
+#define CELL_SIZE       20
+#define GRID_WIDTH      (GRID_SIZE * CELL_SIZE + 5)
+
+/* a content painting a grid of color, texture and pipeline nodes, either
+ * as siblings, which are painted in batches, or each wrapped in its own
+ * clip node, which are painted one by one
+ */
+typedef struct _TestGridContent         TestGridContent;
+typedef struct _GObjectClass            TestGridContentClass;
+
+struct _TestGridContent
+{
+  GObject parent_instance;
+
+  CoglTexture *texture;
+  CoglPipeline *pipeline;
+
+  gboolean wrap_nodes;
+};
+
+GType test_grid_content_get_type (void);
+
+static void test_grid_content_iface_init (ClutterContentIface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (TestGridContent, test_grid_content, G_TYPE_OBJECT,
+                         G_IMPLEMENT_INTERFACE (CLUTTER_TYPE_CONTENT,
+                                                test_grid_content_iface_init));
+
+static void
+add_node (TestGridContent  *self,
+          ClutterPaintNode *root,
+          ClutterPaintNode *node)
+{
+  if (self->wrap_nodes)
+    {
+      ClutterPaintNode *wrapper = clutter_clip_node_new ();
+
+      clutter_paint_node_add_child (wrapper, node);
+      clutter_paint_node_add_child (root, wrapper);
+      clutter_paint_node_unref (wrapper);
+    }
+  else
+    clutter_paint_node_add_child (root, node);
+
+  clutter_paint_node_unref (node);
+}
+
+static void
+test_grid_content_paint_content (ClutterContent   *content,
+                                 ClutterActor     *actor,
+                                 ClutterPaintNode *root)
+{
+  TestGridContent *self = (TestGridContent *) content;
+  static const ClutterColor tint = { 0xff, 0xff, 0xff, 0x80 };
+  gint x, y;
+
+  for (y = 0; y < GRID_SIZE; y++)
+    for (x = 0; x < GRID_SIZE; x++)
+      {
+        ClutterPaintNode *node;
+        ClutterActorBox box;
+
+        /* the cells overlap, so the order of the nodes matters */
+        box.x1 = x * CELL_SIZE;
+        box.y1 = y * CELL_SIZE;
+        box.x2 = box.x1 + CELL_SIZE + 5;
+        box.y2 = box.y1 + CELL_SIZE + 5;
+
+        if (y < 4)
+          {
+            ClutterColor color;
+
+            color.red = x * 255 / (GRID_SIZE - 1);
+            color.green = y * 255 / 3;
+            color.blue = 0x80;
+            color.alpha = (x + y) % 2 == 0 ? 0xff : 0x80;
+
+            node = clutter_color_node_new (&color);
+            clutter_paint_node_add_rectangle (node, &box);
+          }
+        else if (y < 7)
+          {
+            node = clutter_texture_node_new (self->texture,
+                                             y == 6 ? &tint : CLUTTER_COLOR_White,
+                                             CLUTTER_SCALING_FILTER_NEAREST,
+                                             CLUTTER_SCALING_FILTER_NEAREST);
+            clutter_paint_node_add_texture_rectangle (node, &box,
+                                                      0.f, 0.f,
+                                                      1.f, 1.f);
+          }
+        else
+          {
+            CoglPipeline *pipeline;
+
+            /* the run of shared pipelines is broken in the middle */
+            if (x == GRID_SIZE / 2)
+              {
+                pipeline = cogl_pipeline_copy (self->pipeline);
+                cogl_pipeline_set_color4ub (pipeline, 0x00, 0x00, 0x80, 0x80);
+              }
+            else
+              pipeline = cogl_object_ref (self->pipeline);
+
+            node = clutter_pipeline_node_new (pipeline);
+            clutter_paint_node_add_rectangle (node, &box);
+            cogl_object_unref (pipeline);
+          }
+
+        add_node (self, root, node);
+      }
+}
+
+static void
+test_grid_content_iface_init (ClutterContentIface *iface)
+{
+  iface->paint_content = test_grid_content_paint_content;
+}
+
+static void
+test_grid_content_finalize (GObject *gobject)
+{
+  TestGridContent *self = (TestGridContent *) gobject;
+
+  cogl_object_unref (self->texture);
+  cogl_object_unref (self->pipeline);
+
+  G_OBJECT_CLASS (test_grid_content_parent_class)->finalize (gobject);
+}
+
+static void
+test_grid_content_class_init (TestGridContentClass *klass)
+{
+  klass->finalize = test_grid_content_finalize;
+}
+
+static void
+test_grid_content_init (TestGridContent *self)
+{
+  static const guint8 checker[] = {
+    0xff, 0x00, 0x00, 0xff,   0x00, 0xff, 0x00, 0xff,
+    0x00, 0x00, 0xff, 0xff,   0x80, 0x80, 0x80, 0x80,
+  };
+  CoglContext *ctx;
+
+  self->texture = cogl_texture_new_from_data (2, 2,
+                                              COGL_TEXTURE_NO_SLICING,
+                                              COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                                              COGL_PIXEL_FORMAT_ANY,
+                                              8,
+                                              checker);
+
+  ctx = clutter_backend_get_cogl_context (clutter_get_default_backend ());
+  self->pipeline = cogl_pipeline_new (ctx);
+  cogl_pipeline_set_color4ub (self->pipeline, 0x40, 0x00, 0x00, 0x80);
+}
+
+/* checks that painting runs of sibling nodes in batches gives the same
+ * result as painting them one by one
+ */
+void
+actor_paint_nodes_batched (TestConformSimpleFixture *fixture,
+                           gconstpointer             data)
+{
+  ClutterActor *stage, *batched, *unbatched;
+  TestGridContent *content;
+  guchar *pixels;
+  gint x, y, n_different;
+
+  stage = clutter_stage_new ();
+  clutter_stage_set_color (CLUTTER_STAGE (stage), CLUTTER_COLOR_Black);
+
+  content = g_object_new (test_grid_content_get_type (), NULL);
+  batched = clutter_actor_new ();
+  clutter_actor_set_size (batched, GRID_WIDTH, GRID_WIDTH);
+  clutter_actor_set_content (batched, CLUTTER_CONTENT (content));
+  clutter_actor_add_child (stage, batched);
+  g_object_unref (content);
+
+  content = g_object_new (test_grid_content_get_type (), NULL);
+  content->wrap_nodes = TRUE;
+  unbatched = clutter_actor_new ();
+  clutter_actor_set_position (unbatched, 200, 0);
+  clutter_actor_set_size (unbatched, GRID_WIDTH, GRID_WIDTH);
+  clutter_actor_set_content (unbatched, CLUTTER_CONTENT (content));
+  clutter_actor_add_child (stage, unbatched);
+  g_object_unref (content);
+
+  clutter_actor_show (stage);
+  run_one_frame (stage);
+
+  /* reading the pixels paints the stage again, using the batches
+   * retained from the previous frame
+   */
+  pixels = clutter_stage_read_pixels (CLUTTER_STAGE (stage),
+                                      0, 0,
+                                      200 + GRID_WIDTH, GRID_WIDTH);
+
+  n_different = 0;
+  for (y = 0; y < GRID_WIDTH; y++)
+    for (x = 0; x < GRID_WIDTH; x++)
+      {
+        const guchar *a = pixels + (y * (200 + GRID_WIDTH) + x) * 4;
+        const guchar *b = a + 200 * 4;
+
+        if (abs (a[0] - b[0]) > 1 ||
+            abs (a[1] - b[1]) > 1 ||
+            abs (a[2] - b[2]) > 1)
+          {
+            if (g_test_verbose () && n_different < 10)
+              g_print ("pixel %d,%d: batched #%02x%02x%02x, "
+                       "unbatched #%02x%02x%02x\n",
+                       x, y,
+                       a[0], a[1], a[2],
+                       b[0], b[1], b[2]);
+
+            n_different += 1;
+          }
+      }
+
+  g_free (pixels);
+
+  g_assert_cmpint (n_different, ==, 0);
+
+  clutter_actor_destroy (stage);
+}
@@ -1,3 +1,4 @@
+#define CLUTTER_ENABLE_EXPERIMENTAL_API
 #include <clutter/clutter.h>
 
 #include "test-conform-common.h"
@@ -239,8 +240,8 @@ on_timeout (gpointer data)
   return G_SOURCE_REMOVE;
 }
 
-void
-actor_pick (void)
+static void
+run_pick_test (gboolean use_geometric_picking)
 {
   int y, x;
   State state;
@@ -248,6 +249,8 @@ actor_pick (void)
   state.pass = TRUE;
 
   state.stage = clutter_stage_new ();
+  clutter_stage_set_geometric_picking (CLUTTER_STAGE (state.stage),
+                                       use_geometric_picking);
 
   state.actor_width = STAGE_WIDTH / ACTORS_X;
   state.actor_height = STAGE_HEIGHT / ACTORS_Y;
@@ -285,3 +288,309 @@ actor_pick (void)
 
   clutter_actor_destroy (state.stage);
 }
+
+void
+actor_pick (void)
+{
+  run_pick_test (FALSE);
+}
+
+static gboolean
+quit_after_paint (gpointer data)
+{
+  clutter_main_quit ();
+
+  return G_SOURCE_REMOVE;
+}
+
+/* lets the changes to the scene graph be allocated and painted */
+static void
+run_one_frame (ClutterActor *stage)
+{
+  clutter_threads_add_repaint_func_full (CLUTTER_REPAINT_FLAGS_POST_PAINT,
+                                         quit_after_paint,
+                                         NULL, NULL);
+  clutter_actor_queue_redraw (stage);
+  clutter_main ();
+}
+
+static void
+check_pick (ClutterActor *stage,
+            gint          x,
+            gint          y,
+            ClutterActor *expected)
+{
+  ClutterActor *actor;
+
+  actor = clutter_stage_get_actor_at_pos (CLUTTER_STAGE (stage),
+                                          CLUTTER_PICK_REACTIVE,
+                                          x, y);
+
+  if (g_test_verbose ())
+    g_print ("%3d,%3d: %s (expected: %s)\n",
+             x, y,
+             actor != NULL ? clutter_actor_get_name (actor) : "NULL",
+             clutter_actor_get_name (expected));
+
+  g_assert (actor == expected);
+}
+
+static ClutterActor *
+add_reactive_actor (ClutterActor *parent,
+                    const gchar  *name,
+                    gfloat        x,
+                    gfloat        y,
+                    gfloat        size)
+{
+  ClutterActor *actor = clutter_actor_new ();
+
+  clutter_actor_set_name (actor, name);
+  clutter_actor_set_background_color (actor, CLUTTER_COLOR_LightSkyBlue);
+  clutter_actor_set_position (actor, x, y);
+  clutter_actor_set_size (actor, size, size);
+  clutter_actor_set_reactive (actor, TRUE);
+  clutter_actor_add_child (parent, actor);
+
+  return actor;
+}
+
+/* checks that the index used by geometric picking in reactive mode
+ * follows the changes of the scene graph
+ */
+void
+actor_pick_index (void)
+{
+  ClutterActor *stage, *actors[6];
+  ClutterActor *clipper, *clipped, *new_parent;
+  gint x, y;
+
+  stage = clutter_stage_new ();
+  clutter_actor_set_name (stage, "stage");
+  clutter_actor_set_size (stage, STAGE_WIDTH, STAGE_HEIGHT);
+  clutter_stage_set_geometric_picking (CLUTTER_STAGE (stage), TRUE);
+
+  /* a grid of 3x2 actors of 100x100, with gaps between them */
+  for (y = 0; y < 2; y++)
+    for (x = 0; x < 3; x++)
+      {
+        gchar *name = g_strdup_printf ("actor-%d", y * 3 + x);
+
+        actors[y * 3 + x] = add_reactive_actor (stage, name,
+                                                20 + x * 150,
+                                                20 + y * 150,
+                                                100);
+        g_free (name);
+      }
+
+  /* a reactive child extending outside of the clip of its parent */
+  clipper = clutter_actor_new ();
+  clutter_actor_set_name (clipper, "clipper");
+  clutter_actor_set_position (clipper, 20, 300);
+  clutter_actor_set_size (clipper, 100, 100);
+  clutter_actor_set_clip_to_allocation (clipper, TRUE);
+  clutter_actor_add_child (stage, clipper);
+
+  clipped = add_reactive_actor (clipper, "clipped", 50, 50, 200);
+
+  new_parent = clutter_actor_new ();
+  clutter_actor_set_name (new_parent, "new-parent");
+  clutter_actor_set_position (new_parent, 450, 300);
+  clutter_actor_set_size (new_parent, 150, 150);
+  clutter_actor_add_child (stage, new_parent);
+
+  clutter_actor_show (stage);
+  run_one_frame (stage);
+
+  for (y = 0; y < 2; y++)
+    for (x = 0; x < 3; x++)
+      check_pick (stage, 70 + x * 150, 70 + y * 150, actors[y * 3 + x]);
+
+  check_pick (stage, 145, 145, stage);
+
+  /* clipped actors can only be picked inside the clip */
+  check_pick (stage, 90, 370, clipped);
+  check_pick (stage, 200, 370, stage);
+  check_pick (stage, 90, 450, stage);
+
+  clutter_actor_set_clip_to_allocation (clipper, FALSE);
+  run_one_frame (stage);
+  check_pick (stage, 200, 370, clipped);
+  check_pick (stage, 90, 450, clipped);
+
+  /* transformation changes */
+  clutter_actor_set_translation (actors[0], 10, 10, 0);
+  run_one_frame (stage);
+  check_pick (stage, 25, 25, stage);
+  check_pick (stage, 125, 125, actors[0]);
+
+  clutter_actor_set_pivot_point (actors[4], 0.5, 0.5);
+  clutter_actor_set_rotation_angle (actors[4], CLUTTER_Z_AXIS, 45.0);
+  run_one_frame (stage);
+  check_pick (stage, 175, 175, stage);
+  check_pick (stage, 220, 155, actors[4]);
+
+  /* allocation changes */
+  clutter_actor_set_position (actors[1], 520, 20);
+  run_one_frame (stage);
+  check_pick (stage, 220, 70, stage);
+  check_pick (stage, 570, 70, actors[1]);
+
+  /* the items of the previous position of an actor are stale after
+   * it has been reparented, or destroyed
+   */
+  g_object_ref (actors[2]);
+  clutter_actor_remove_child (stage, actors[2]);
+  clutter_actor_set_position (actors[2], 10, 10);
+  clutter_actor_add_child (new_parent, actors[2]);
+  g_object_unref (actors[2]);
+  run_one_frame (stage);
+  check_pick (stage, 370, 70, stage);
+  check_pick (stage, 500, 350, actors[2]);
+
+  clutter_actor_destroy (actors[3]);
+  run_one_frame (stage);
+  check_pick (stage, 70, 220, stage);
+
+  clutter_actor_destroy (actors[2]);
+  run_one_frame (stage);
+  check_pick (stage, 500, 350, stage);
+
+  clutter_actor_destroy (stage);
+}
+
+/* paints nothing in pick mode, so that the actor cannot be picked */
+static void
+on_pick_hide (ClutterActor       *actor,
+              const ClutterColor *color)
+{
+  g_signal_stop_emission_by_name (actor, "pick");
+}
+
+/* checks that connecting to the ::pick signal after the index has been
+ * built makes the stage fall back to painting in pick mode
+ */
+void
+actor_pick_index_late_handler (void)
+{
+  ClutterActor *stage, *actor;
+
+  stage = clutter_stage_new ();
+  clutter_actor_set_name (stage, "stage");
+  clutter_actor_set_size (stage, STAGE_WIDTH, STAGE_HEIGHT);
+  clutter_stage_set_geometric_picking (CLUTTER_STAGE (stage), TRUE);
+
+  actor = add_reactive_actor (stage, "actor", 20, 20, 100);
+
+  clutter_actor_show (stage);
+  run_one_frame (stage);
+
+  /* the first pick builds the index */
+  check_pick (stage, 70, 70, actor);
+
+  g_signal_connect (actor, "pick", G_CALLBACK (on_pick_hide), NULL);
+  check_pick (stage, 70, 70, stage);
+
+  clutter_actor_destroy (stage);
+}
+
+/* an actor overriding pick(), which cannot be picked geometrically
+ * unless it has a shape function
+ */
+typedef struct _TestPickActor           TestPickActor;
+typedef struct _ClutterActorClass       TestPickActorClass;
+
+struct _TestPickActor
+{
+  ClutterActor parent_instance;
+};
+
+GType test_pick_actor_get_type (void);
+
+G_DEFINE_TYPE (TestPickActor, test_pick_actor, CLUTTER_TYPE_ACTOR);
+
+static void
+test_pick_actor_pick (ClutterActor       *actor,
+                      const ClutterColor *color)
+{
+  CLUTTER_ACTOR_CLASS (test_pick_actor_parent_class)->pick (actor, color);
+}
+
+static void
+test_pick_actor_class_init (TestPickActorClass *klass)
+{
+  klass->pick = test_pick_actor_pick;
+}
+
+static void
+test_pick_actor_init (TestPickActor *self)
+{
+}
+
+/* the shape of the actor is the left half of its allocation */
+static gboolean
+left_half_shape (ClutterActor *actor,
+                 gfloat        x,
+                 gfloat        y,
+                 gpointer      user_data)
+{
+  return x < clutter_actor_get_width (actor) / 2;
+}
+
+static gboolean
+whole_shape (ClutterActor *actor,
+             gfloat        x,
+             gfloat        y,
+             gpointer      user_data)
+{
+  return TRUE;
+}
+
+void
+actor_pick_geometric (void)
+{
+  ClutterActor *stage, *shaped, *custom;
+
+  run_pick_test (TRUE);
+
+  /* the shape functions are only used by the geometric pick, while
+   * painting in pick mode covers the whole allocation, so the right
+   * half of the shaped actor tells which of the two has been used
+   */
+  stage = clutter_stage_new ();
+  clutter_actor_set_name (stage, "stage");
+  clutter_actor_set_size (stage, STAGE_WIDTH, STAGE_HEIGHT);
+
+  shaped = add_reactive_actor (stage, "shaped", 20, 20, 200);
+  clutter_actor_set_pick_shape_func (shaped, left_half_shape, NULL, NULL);
+
+  clutter_actor_show (stage);
+
+  clutter_stage_set_geometric_picking (CLUTTER_STAGE (stage), FALSE);
+  run_one_frame (stage);
+  check_pick (stage, 70, 120, shaped);
+  check_pick (stage, 170, 120, shaped);
+
+  clutter_stage_set_geometric_picking (CLUTTER_STAGE (stage), TRUE);
+  run_one_frame (stage);
+  check_pick (stage, 70, 120, shaped);
+  check_pick (stage, 170, 120, stage);
+
+  /* an actor overriding pick() forces the stage to paint in pick mode */
+  custom = g_object_new (test_pick_actor_get_type (), NULL);
+  clutter_actor_set_name (custom, "custom");
+  clutter_actor_set_position (custom, 300, 20);
+  clutter_actor_set_size (custom, 100, 100);
+  clutter_actor_set_reactive (custom, TRUE);
+  clutter_actor_add_child (stage, custom);
+  run_one_frame (stage);
+  check_pick (stage, 350, 70, custom);
+  check_pick (stage, 170, 120, shaped);
+
+  /* unless it provides a shape function */
+  clutter_actor_set_pick_shape_func (custom, whole_shape, NULL, NULL);
+  run_one_frame (stage);
+  check_pick (stage, 350, 70, custom);
+  check_pick (stage, 170, 120, stage);
+
+  clutter_actor_destroy (stage);
+}
@@ -0,0 +1,244 @@
+#include <math.h>
+#include <string.h>
+#include <clutter/clutter.h>
+
+#include "test-conform-common.h"
+
+/* an actor overriding the way its final state is set */
+typedef struct _TestStateActor          TestStateActor;
+typedef struct _ClutterActorClass       TestStateActorClass;
+
+struct _TestStateActor
+{
+  ClutterActor parent_instance;
+
+  guint n_final_states;
+};
+
+GType test_state_actor_get_type (void);
+
+static void test_state_actor_animatable_init (ClutterAnimatableIface *iface);
+
+G_DEFINE_TYPE_WITH_CODE (TestStateActor, test_state_actor, CLUTTER_TYPE_ACTOR,
+                         G_IMPLEMENT_INTERFACE (CLUTTER_TYPE_ANIMATABLE,
+                                                test_state_actor_animatable_init));
+
+static ClutterAnimatableIface *parent_animatable_iface = NULL;
+
+static void
+test_state_actor_set_final_state (ClutterAnimatable *animatable,
+                                  const gchar       *property_name,
+                                  const GValue      *value)
+{
+  TestStateActor *self = (TestStateActor *) animatable;
+
+  self->n_final_states += 1;
+
+  parent_animatable_iface->set_final_state (animatable, property_name, value);
+}
+
+static void
+test_state_actor_animatable_init (ClutterAnimatableIface *iface)
+{
+  parent_animatable_iface = g_type_interface_peek_parent (iface);
+
+  iface->find_property = parent_animatable_iface->find_property;
+  iface->get_initial_state = parent_animatable_iface->get_initial_state;
+  iface->set_final_state = test_state_actor_set_final_state;
+}
+
+static void
+test_state_actor_class_init (TestStateActorClass *klass)
+{
+}
+
+static void
+test_state_actor_init (TestStateActor *self)
+{
+}
+
+/* an actor overriding the notification of its properties */
+typedef struct _TestNotifyActor         TestNotifyActor;
+typedef struct _ClutterActorClass       TestNotifyActorClass;
+
+struct _TestNotifyActor
+{
+  ClutterActor parent_instance;
+
+  guint n_opacity_notifies;
+};
+
+GType test_notify_actor_get_type (void);
+
+G_DEFINE_TYPE (TestNotifyActor, test_notify_actor, CLUTTER_TYPE_ACTOR);
+
+static void
+test_notify_actor_notify (GObject    *gobject,
+                          GParamSpec *pspec)
+{
+  TestNotifyActor *self = (TestNotifyActor *) gobject;
+
+  if (strcmp (pspec->name, "opacity") == 0)
+    self->n_opacity_notifies += 1;
+}
+
+static void
+test_notify_actor_class_init (TestNotifyActorClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->notify = test_notify_actor_notify;
+}
+
+static void
+test_notify_actor_init (TestNotifyActor *self)
+{
+}
+
+#define FINAL_SCALE     (1.0 / 3.0)
+#define FINAL_ANGLE     (100.0 / 3.0)
+
+typedef struct _TransitionState TransitionState;
+
+struct _TransitionState
+{
+  ClutterActor *actor;
+
+  guint n_frames;
+  guint n_completed;
+};
+
+static void
+on_new_frame (ClutterTimeline *timeline,
+              gint             elapsed,
+              TransitionState *state)
+{
+  gdouble progress = clutter_timeline_get_progress (timeline);
+  gdouble scale_x;
+
+  clutter_actor_get_scale (state->actor, &scale_x, NULL);
+
+  if (g_test_verbose ())
+    g_print ("frame %u: progress %.3f, scale %.6f\n",
+             state->n_frames,
+             progress,
+             scale_x);
+
+  /* the value of the frame is set when the handlers run */
+  g_assert_cmpfloat (fabs (scale_x - (1.0 + (FINAL_SCALE - 1.0) * progress)),
+                     <,
+                     0.0001);
+
+  state->n_frames += 1;
+}
+
+static void
+on_completed (ClutterTimeline *timeline,
+              TransitionState *state)
+{
+  state->n_completed += 1;
+
+  if (state->n_completed == 4)
+    clutter_main_quit ();
+}
+
+static ClutterTransition *
+add_transition (ClutterActor    *actor,
+                const gchar     *property_name,
+                ClutterInterval *interval,
+                TransitionState *state)
+{
+  ClutterTransition *transition;
+
+  transition = clutter_property_transition_new (property_name);
+  clutter_transition_set_interval (transition, interval);
+  clutter_timeline_set_duration (CLUTTER_TIMELINE (transition), 250);
+  clutter_timeline_set_progress_mode (CLUTTER_TIMELINE (transition),
+                                      CLUTTER_LINEAR);
+  g_signal_connect (transition, "completed",
+                    G_CALLBACK (on_completed),
+                    state);
+  clutter_actor_add_transition (actor, property_name, transition);
+
+  return transition;
+}
+
+void
+actor_transition_batch (TestConformSimpleFixture *fixture,
+                        gconstpointer             data)
+{
+  ClutterActor *stage, *actor;
+  TestStateActor *state_actor;
+  TestNotifyActor *notify_actor;
+  ClutterTransition *transitions[4];
+  TransitionState state;
+  gdouble scale_x;
+  guint i;
+
+  memset (&state, 0, sizeof (TransitionState));
+
+  stage = clutter_stage_new ();
+
+  actor = clutter_actor_new ();
+  clutter_actor_set_size (actor, 100, 100);
+  clutter_actor_add_child (stage, actor);
+  state.actor = actor;
+
+  state_actor = g_object_new (test_state_actor_get_type (), NULL);
+  clutter_actor_add_child (stage, CLUTTER_ACTOR (state_actor));
+
+  notify_actor = g_object_new (test_notify_actor_get_type (), NULL);
+  clutter_actor_add_child (stage, CLUTTER_ACTOR (notify_actor));
+
+  clutter_actor_show (stage);
+
+  transitions[0] =
+    add_transition (actor, "scale-x",
+                    clutter_interval_new (G_TYPE_DOUBLE, 1.0, FINAL_SCALE),
+                    &state);
+  g_signal_connect_after (transitions[0], "new-frame",
+                          G_CALLBACK (on_new_frame),
+                          &state);
+
+  transitions[1] =
+    add_transition (actor, "rotation-angle-z",
+                    clutter_interval_new (G_TYPE_DOUBLE, 0.0, FINAL_ANGLE),
+                    &state);
+
+  /* the sub-classes see every frame of their transitions */
+  transitions[2] =
+    add_transition (CLUTTER_ACTOR (state_actor), "opacity",
+                    clutter_interval_new (G_TYPE_UINT, 255, 10),
+                    &state);
+  transitions[3] =
+    add_transition (CLUTTER_ACTOR (notify_actor), "opacity",
+                    clutter_interval_new (G_TYPE_UINT, 255, 10),
+                    &state);
+
+  clutter_main ();
+
+  g_assert_cmpuint (state.n_frames, >, 1);
+
+  /* the last frame sets the exact final values */
+  clutter_actor_get_scale (actor, &scale_x, NULL);
+  g_assert_cmpfloat (scale_x, ==, FINAL_SCALE);
+  g_assert_cmpfloat (clutter_actor_get_rotation_angle (actor, CLUTTER_Z_AXIS),
+                     ==,
+                     FINAL_ANGLE);
+
+  if (g_test_verbose ())
+    g_print ("final states: %u, opacity notifications: %u\n",
+             state_actor->n_final_states,
+             notify_actor->n_opacity_notifies);
+
+  g_assert_cmpint (clutter_actor_get_opacity (CLUTTER_ACTOR (state_actor)), ==, 10);
+  g_assert_cmpuint (state_actor->n_final_states, >, 1);
+
+  g_assert_cmpint (clutter_actor_get_opacity (CLUTTER_ACTOR (notify_actor)), ==, 10);
+  g_assert_cmpuint (notify_actor->n_opacity_notifies, >, 1);
+
+  for (i = 0; i < G_N_ELEMENTS (transitions); i++)
+    g_object_unref (transitions[i]);
+
+  clutter_actor_destroy (stage);
+}
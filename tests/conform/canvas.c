@@ -0,0 +1,156 @@
+#define CLUTTER_ENABLE_EXPERIMENTAL_API
+#include <stdlib.h>
+#include <string.h>
+#include <clutter/clutter.h>
+
+#include "test-conform-common.h"
+
+typedef struct _State   State;
+
+struct _State
+{
+  ClutterActor *stage;
+
+  /* held by the main thread to keep the worker thread from drawing */
+  GMutex lock;
+
+  double red, green, blue;
+
+  volatile gint n_draws;
+};
+
+/* called in a worker thread when drawing asynchronously */
+static gboolean
+draw_cb (ClutterCanvas *canvas,
+         cairo_t       *cr,
+         int            width,
+         int            height,
+         State         *state)
+{
+  g_mutex_lock (&state->lock);
+
+  cairo_set_operator (cr, CAIRO_OPERATOR_SOURCE);
+  cairo_set_source_rgb (cr, state->red, state->green, state->blue);
+  cairo_paint (cr);
+
+  g_mutex_unlock (&state->lock);
+
+  g_atomic_int_inc (&state->n_draws);
+
+  return TRUE;
+}
+
+static gboolean
+quit_after_paint (gpointer data)
+{
+  clutter_main_quit ();
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+run_one_frame (ClutterActor *stage)
+{
+  clutter_threads_add_repaint_func_full (CLUTTER_REPAINT_FLAGS_POST_PAINT,
+                                         quit_after_paint,
+                                         NULL, NULL);
+  clutter_actor_queue_redraw (stage);
+  clutter_main ();
+}
+
+static gboolean
+has_pixel (ClutterActor *stage,
+           guint8        red,
+           guint8        green,
+           guint8        blue)
+{
+  gboolean res;
+  guchar *pixel;
+
+  pixel = clutter_stage_read_pixels (CLUTTER_STAGE (stage), 50, 50, 1, 1);
+
+  if (g_test_verbose ())
+    g_print ("pixel: #%02x%02x%02x (expected: #%02x%02x%02x)\n",
+             pixel[0], pixel[1], pixel[2],
+             red, green, blue);
+
+  res = abs (pixel[0] - red) <= 2 &&
+        abs (pixel[1] - green) <= 2 &&
+        abs (pixel[2] - blue) <= 2;
+
+  g_free (pixel);
+
+  return res;
+}
+
+void
+canvas_draw_async_switch (TestConformSimpleFixture *fixture,
+                          gconstpointer             data)
+{
+  ClutterContent *canvas;
+  ClutterActor *actor;
+  State state;
+  gint i;
+
+  memset (&state, 0, sizeof (State));
+  g_mutex_init (&state.lock);
+
+  state.stage = clutter_stage_new ();
+  clutter_stage_set_color (CLUTTER_STAGE (state.stage), CLUTTER_COLOR_Black);
+
+  canvas = clutter_canvas_new ();
+  g_signal_connect (canvas, "draw", G_CALLBACK (draw_cb), &state);
+
+  state.red = 1.0;
+  clutter_canvas_set_size (CLUTTER_CANVAS (canvas), 100, 100);
+  g_assert_cmpint (state.n_draws, ==, 1);
+
+  actor = clutter_actor_new ();
+  clutter_actor_set_size (actor, 100, 100);
+  clutter_actor_set_content (actor, canvas);
+  clutter_actor_add_child (state.stage, actor);
+
+  clutter_actor_show (state.stage);
+
+  run_one_frame (state.stage);
+  g_assert (has_pixel (state.stage, 0xff, 0x00, 0x00));
+
+  /* the worker thread cannot complete the first asynchronous drawing
+   * while the lock is held, so the contents drawn synchronously are
+   * still painted
+   */
+  g_mutex_lock (&state.lock);
+
+  clutter_canvas_set_draw_async (CLUTTER_CANVAS (canvas), TRUE);
+  g_assert (has_pixel (state.stage, 0xff, 0x00, 0x00));
+
+  state.red = 0.0;
+  state.green = 1.0;
+  g_mutex_unlock (&state.lock);
+
+  while (g_atomic_int_get (&state.n_draws) < 2)
+    g_usleep (1000);
+
+  /* the new contents are swapped in by an idle on the main thread */
+  for (i = 0; i < 10; i++)
+    {
+      run_one_frame (state.stage);
+
+      if (has_pixel (state.stage, 0x00, 0xff, 0x00))
+        break;
+    }
+
+  g_assert_cmpint (i, <, 10);
+
+  /* switching back draws synchronously */
+  state.green = 0.0;
+  state.blue = 1.0;
+  clutter_canvas_set_draw_async (CLUTTER_CANVAS (canvas), FALSE);
+  g_assert_cmpint (state.n_draws, ==, 3);
+  g_assert (has_pixel (state.stage, 0x00, 0x00, 0xff));
+
+  clutter_actor_destroy (state.stage);
+  g_object_unref (canvas);
+
+  g_mutex_clear (&state.lock);
+}
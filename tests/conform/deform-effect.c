@@ -0,0 +1,246 @@
+#include <math.h>
+#include <string.h>
+#include <clutter/clutter.h>
+
+#include "test-conform-common.h"
+
+#define GRID_COLUMNS    17
+#define GRID_ROWS       9
+#define GRID_VERTICES   (GRID_COLUMNS * GRID_ROWS)
+
+#define EFFECT_WIDTH    200.f
+#define EFFECT_HEIGHT   100.f
+
+/* deforms the same grid with deform_vertices() and with deform_vertex(),
+ * and checks that both give the same vertices
+ */
+static void
+compare_deformations (ClutterDeformEffect *effect)
+{
+  ClutterDeformEffectClass *klass = CLUTTER_DEFORM_EFFECT_GET_CLASS (effect);
+  gfloat x[GRID_VERTICES], y[GRID_VERTICES], z[GRID_VERTICES];
+  gfloat tx[GRID_VERTICES], ty[GRID_VERTICES];
+  guint8 colors[GRID_VERTICES * 4];
+  ClutterDeformVertices vertices;
+  gint i, j;
+
+  g_assert (klass->deform_vertex != NULL);
+  g_assert (klass->deform_vertices != NULL);
+
+  for (i = 0; i < GRID_ROWS; i++)
+    {
+      for (j = 0; j < GRID_COLUMNS; j++)
+        {
+          gint k = i * GRID_COLUMNS + j;
+
+          tx[k] = (gfloat) j / (GRID_COLUMNS - 1);
+          ty[k] = (gfloat) i / (GRID_ROWS - 1);
+          x[k] = EFFECT_WIDTH * tx[k];
+          y[k] = EFFECT_HEIGHT * ty[k];
+          z[k] = 0.f;
+
+          colors[k * 4 + 0] = 255;
+          colors[k * 4 + 1] = 255;
+          colors[k * 4 + 2] = 255;
+          colors[k * 4 + 3] = 255;
+        }
+    }
+
+  vertices.n_vertices = GRID_VERTICES;
+  vertices.x = x;
+  vertices.y = y;
+  vertices.z = z;
+  vertices.tx = tx;
+  vertices.ty = ty;
+  vertices.colors = colors;
+
+  klass->deform_vertices (effect, EFFECT_WIDTH, EFFECT_HEIGHT, &vertices);
+
+  for (i = 0; i < GRID_ROWS; i++)
+    {
+      for (j = 0; j < GRID_COLUMNS; j++)
+        {
+          gint k = i * GRID_COLUMNS + j;
+          CoglTextureVertex vertex;
+
+          vertex.tx = (gfloat) j / (GRID_COLUMNS - 1);
+          vertex.ty = (gfloat) i / (GRID_ROWS - 1);
+          vertex.x = EFFECT_WIDTH * vertex.tx;
+          vertex.y = EFFECT_HEIGHT * vertex.ty;
+          vertex.z = 0.f;
+          cogl_color_init_from_4ub (&vertex.color, 255, 255, 255, 255);
+
+          klass->deform_vertex (effect, EFFECT_WIDTH, EFFECT_HEIGHT, &vertex);
+
+          g_assert_cmpfloat (fabsf (vertex.x - x[k]), <, 0.001f);
+          g_assert_cmpfloat (fabsf (vertex.y - y[k]), <, 0.001f);
+          g_assert_cmpfloat (fabsf (vertex.z - z[k]), <, 0.001f);
+          g_assert_cmpfloat (fabsf (vertex.tx - tx[k]), <, 0.001f);
+          g_assert_cmpfloat (fabsf (vertex.ty - ty[k]), <, 0.001f);
+
+          g_assert_cmpint (cogl_color_get_red_byte (&vertex.color), ==, colors[k * 4 + 0]);
+          g_assert_cmpint (cogl_color_get_green_byte (&vertex.color), ==, colors[k * 4 + 1]);
+          g_assert_cmpint (cogl_color_get_blue_byte (&vertex.color), ==, colors[k * 4 + 2]);
+          g_assert_cmpint (cogl_color_get_alpha_byte (&vertex.color), ==, colors[k * 4 + 3]);
+        }
+    }
+}
+
+void
+deform_effect_batched (TestConformSimpleFixture *fixture,
+                       gconstpointer             data)
+{
+  ClutterEffect *effect;
+
+  effect = clutter_page_turn_effect_new (0.5, 45.0, 24.0);
+  g_object_ref_sink (effect);
+  compare_deformations (CLUTTER_DEFORM_EFFECT (effect));
+  g_object_unref (effect);
+
+  effect = clutter_bend_effect_new (60.0, CLUTTER_ORIENTATION_HORIZONTAL);
+  g_object_ref_sink (effect);
+  compare_deformations (CLUTTER_DEFORM_EFFECT (effect));
+
+  clutter_bend_effect_set_orientation (CLUTTER_BEND_EFFECT (effect),
+                                       CLUTTER_ORIENTATION_VERTICAL);
+  clutter_bend_effect_set_angle (CLUTTER_BEND_EFFECT (effect), -120.0);
+  compare_deformations (CLUTTER_DEFORM_EFFECT (effect));
+
+  /* not bent at all */
+  clutter_bend_effect_set_angle (CLUTTER_BEND_EFFECT (effect), 0.0);
+  compare_deformations (CLUTTER_DEFORM_EFFECT (effect));
+  g_object_unref (effect);
+}
+
+/* a deformation recording the vertices it has been given, to check
+ * how the grid is split between the worker threads
+ */
+typedef struct _TestCountEffect         TestCountEffect;
+typedef struct _ClutterDeformEffectClass TestCountEffectClass;
+
+struct _TestCountEffect
+{
+  ClutterDeformEffect parent_instance;
+
+  guint x_tiles;
+  guint y_tiles;
+
+  volatile gint *marks;
+  volatile gint n_calls;
+};
+
+GType test_count_effect_get_type (void);
+
+G_DEFINE_TYPE (TestCountEffect, test_count_effect, CLUTTER_TYPE_DEFORM_EFFECT);
+
+static void
+test_count_effect_deform_vertices (ClutterDeformEffect   *effect,
+                                   gfloat                 width,
+                                   gfloat                 height,
+                                   ClutterDeformVertices *vertices)
+{
+  TestCountEffect *self = (TestCountEffect *) effect;
+  guint i;
+
+  g_atomic_int_inc (&self->n_calls);
+
+  g_assert_cmpuint (vertices->n_vertices, >, 0);
+  g_assert_cmpuint (vertices->n_vertices,
+                    <=,
+                    (self->x_tiles + 1) * (self->y_tiles + 1));
+
+  for (i = 0; i < vertices->n_vertices; i++)
+    {
+      guint column = (guint) floorf (vertices->tx[i] * self->x_tiles + 0.5f);
+      guint row = (guint) floorf (vertices->ty[i] * self->y_tiles + 0.5f);
+
+      g_assert_cmpuint (column, <=, self->x_tiles);
+      g_assert_cmpuint (row, <=, self->y_tiles);
+
+      g_atomic_int_inc (&self->marks[row * (self->x_tiles + 1) + column]);
+    }
+}
+
+static void
+test_count_effect_class_init (TestCountEffectClass *klass)
+{
+  klass->deform_vertices = test_count_effect_deform_vertices;
+}
+
+static void
+test_count_effect_init (TestCountEffect *self)
+{
+}
+
+static gboolean
+quit_after_paint (gpointer data)
+{
+  clutter_main_quit ();
+
+  return G_SOURCE_REMOVE;
+}
+
+void
+deform_effect_ranges (TestConformSimpleFixture *fixture,
+                      gconstpointer             data)
+{
+  /* more rows than worker threads, but not a multiple of the number
+   * of ranges; the grid is large enough to be split
+   */
+  static const guint y_tiles[] = { 4, 5, 7, 64 };
+  guint i, j;
+
+  if (!clutter_feature_available (CLUTTER_FEATURE_OFFSCREEN))
+    {
+      if (g_test_verbose ())
+        g_print ("Offscreen buffers are not available, skipping\n");
+
+      return;
+    }
+
+  for (i = 0; i < G_N_ELEMENTS (y_tiles); i++)
+    {
+      ClutterActor *stage, *actor;
+      TestCountEffect *effect;
+      guint n_vertices;
+
+      effect = g_object_new (test_count_effect_get_type (), NULL);
+      effect->y_tiles = y_tiles[i];
+      effect->x_tiles = 20000 / y_tiles[i];
+      clutter_deform_effect_set_n_tiles (CLUTTER_DEFORM_EFFECT (effect),
+                                         effect->x_tiles,
+                                         effect->y_tiles);
+
+      n_vertices = (effect->x_tiles + 1) * (effect->y_tiles + 1);
+      effect->marks = g_new0 (gint, n_vertices);
+
+      stage = clutter_stage_new ();
+      actor = clutter_actor_new ();
+      clutter_actor_set_background_color (actor, CLUTTER_COLOR_Red);
+      clutter_actor_set_size (actor, 100, 100);
+      clutter_actor_add_effect (actor, CLUTTER_EFFECT (effect));
+      clutter_actor_add_child (stage, actor);
+      clutter_actor_show (stage);
+
+      clutter_threads_add_repaint_func_full (CLUTTER_REPAINT_FLAGS_POST_PAINT,
+                                             quit_after_paint,
+                                             NULL, NULL);
+      clutter_main ();
+
+      if (g_test_verbose ())
+        g_print ("%u x %u tiles: %d ranges\n",
+                 effect->x_tiles, effect->y_tiles,
+                 effect->n_calls);
+
+      /* every vertex is deformed exactly once each time the grid is
+       * deformed
+       */
+      g_assert_cmpint (effect->n_calls, >, 0);
+      g_assert_cmpint (effect->marks[0], >, 0);
+      for (j = 0; j < n_vertices; j++)
+        g_assert_cmpint (effect->marks[j], ==, effect->marks[0]);
+
+      g_free ((gpointer) effect->marks);
+      clutter_actor_destroy (stage);
+    }
+}
@@ -0,0 +1,172 @@
+#define CLUTTER_ENABLE_EXPERIMENTAL_API
+#include <string.h>
+#include <clutter/clutter.h>
+
+#include "test-conform-common.h"
+
+#define N_UPDATES 5
+
+typedef struct _State State;
+
+struct _State
+{
+  ClutterActor *stage;
+  ClutterInputDevice *device;
+
+  gint n_updates[2];
+  gfloat last_x[2];
+  guint n_coalesced[2];
+  gfloat first_coalesced_x[2];
+};
+
+static ClutterEventSequence *
+sequence_for_index (gint index_)
+{
+  return GINT_TO_POINTER (index_ + 1);
+}
+
+static void
+push_touch_event (State            *state,
+                  ClutterEventType  type,
+                  gint              index_,
+                  gfloat            x)
+{
+  ClutterEvent *event;
+
+  event = clutter_event_new (type);
+  event->touch.stage = CLUTTER_STAGE (state->stage);
+  event->touch.source = state->stage;
+  event->touch.x = x;
+  event->touch.y = 10.f;
+  event->touch.sequence = sequence_for_index (index_);
+  clutter_event_set_device (event, state->device);
+
+  clutter_do_event (event);
+  clutter_event_free (event);
+}
+
+static gboolean
+touch_event_cb (ClutterActor *stage,
+                ClutterEvent *event,
+                State        *state)
+{
+  const ClutterEventPoint *points;
+  guint n_points;
+  gint index_;
+
+  if (event->type != CLUTTER_TOUCH_UPDATE)
+    return CLUTTER_EVENT_STOP;
+
+  index_ = GPOINTER_TO_INT (clutter_event_get_event_sequence (event)) - 1;
+  g_assert (index_ == 0 || index_ == 1);
+
+  state->n_updates[index_] += 1;
+  state->last_x[index_] = event->touch.x;
+
+  points = clutter_event_get_coalesced_points (event, &n_points);
+  state->n_coalesced[index_] = n_points;
+  if (n_points > 0)
+    state->first_coalesced_x[index_] = points[0].x;
+
+  return CLUTTER_EVENT_STOP;
+}
+
+static gboolean
+quit_cb (gpointer data)
+{
+  clutter_main_quit ();
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+run_compression_test (gboolean throttle)
+{
+  ClutterDeviceManager *manager;
+  State state;
+  gint i;
+
+  memset (&state, 0, sizeof (State));
+
+  manager = clutter_device_manager_get_default ();
+  state.device = clutter_device_manager_get_core_device (manager,
+                                                         CLUTTER_POINTER_DEVICE);
+  if (state.device == NULL)
+    {
+      if (g_test_verbose ())
+        g_print ("No core pointer device, skipping\n");
+
+      return;
+    }
+
+  state.stage = clutter_stage_new ();
+  clutter_stage_set_throttle_motion_events (CLUTTER_STAGE (state.stage),
+                                            throttle);
+  g_signal_connect (state.stage, "touch-event",
+                    G_CALLBACK (touch_event_cb),
+                    &state);
+  clutter_actor_show (state.stage);
+
+  /* two interleaved sequences; the first one ends before the
+   * last update of the second one
+   */
+  push_touch_event (&state, CLUTTER_TOUCH_BEGIN, 0, 0.f);
+  push_touch_event (&state, CLUTTER_TOUCH_BEGIN, 1, 0.f);
+
+  for (i = 1; i <= N_UPDATES; i++)
+    {
+      push_touch_event (&state, CLUTTER_TOUCH_UPDATE, 0, i);
+      push_touch_event (&state, CLUTTER_TOUCH_UPDATE, 1, i * 10.f);
+    }
+
+  push_touch_event (&state, CLUTTER_TOUCH_END, 0, N_UPDATES);
+  push_touch_event (&state, CLUTTER_TOUCH_UPDATE, 1, 100.f);
+  push_touch_event (&state, CLUTTER_TOUCH_END, 1, 100.f);
+
+  /* the queued events are processed before the next frame is painted */
+  clutter_threads_add_repaint_func_full (CLUTTER_REPAINT_FLAGS_POST_PAINT,
+                                         quit_cb,
+                                         NULL, NULL);
+  clutter_actor_queue_redraw (state.stage);
+
+  clutter_main ();
+
+  if (g_test_verbose ())
+    g_print ("throttle: %s, updates: %d, %d\n",
+             throttle ? "yes" : "no",
+             state.n_updates[0],
+             state.n_updates[1]);
+
+  if (throttle)
+    {
+      g_assert_cmpint (state.n_updates[0], ==, 1);
+      g_assert_cmpint (state.n_updates[1], ==, 1);
+
+      /* the positions of the omitted updates are not lost */
+      g_assert_cmpuint (state.n_coalesced[0], ==, N_UPDATES - 1);
+      g_assert_cmpuint (state.n_coalesced[1], ==, N_UPDATES);
+      g_assert_cmpfloat (state.first_coalesced_x[0], ==, 1.f);
+      g_assert_cmpfloat (state.first_coalesced_x[1], ==, 10.f);
+    }
+  else
+    {
+      g_assert_cmpint (state.n_updates[0], ==, N_UPDATES);
+      g_assert_cmpint (state.n_updates[1], ==, N_UPDATES + 1);
+
+      g_assert_cmpuint (state.n_coalesced[0], ==, 0);
+      g_assert_cmpuint (state.n_coalesced[1], ==, 0);
+    }
+
+  /* the last position of each sequence is always delivered */
+  g_assert_cmpfloat (state.last_x[0], ==, N_UPDATES);
+  g_assert_cmpfloat (state.last_x[1], ==, 100.f);
+
+  clutter_actor_destroy (state.stage);
+}
+
+void
+events_touch_compression (void)
+{
+  run_compression_test (TRUE);
+  run_compression_test (FALSE);
+}
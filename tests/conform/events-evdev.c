@@ -0,0 +1,133 @@
+#include "config.h"
+#include <clutter/clutter.h>
+
+#if defined CLUTTER_INPUT_EVDEV && OS_LINUX
+
+#include <string.h>
+#include <unistd.h>
+#include <linux/input.h>
+
+#include <clutter/evdev/clutter-evdev.h>
+
+#include "test-conform-common.h"
+
+typedef struct _State State;
+
+struct _State
+{
+  ClutterInputDevice *device;
+
+  gint n_begins;
+  gint n_cancels;
+  gboolean foreign_device;
+};
+
+static gboolean
+captured_event_cb (ClutterActor *stage,
+                   ClutterEvent *event,
+                   State        *state)
+{
+  switch (clutter_event_type (event))
+    {
+    case CLUTTER_TOUCH_BEGIN:
+      state->n_begins += 1;
+      break;
+
+    case CLUTTER_TOUCH_CANCEL:
+      state->n_cancels += 1;
+      break;
+
+    default:
+      return CLUTTER_EVENT_PROPAGATE;
+    }
+
+  if (clutter_event_get_device (event) != state->device)
+    state->foreign_device = TRUE;
+
+  return CLUTTER_EVENT_PROPAGATE;
+}
+
+static void
+write_event (gint   fd,
+             guint  type,
+             guint  code,
+             gint   value)
+{
+  struct input_event e;
+
+  memset (&e, 0, sizeof (e));
+  e.type = type;
+  e.code = code;
+  e.value = value;
+
+  g_assert_cmpint (write (fd, &e, sizeof (e)), ==, sizeof (e));
+}
+
+#endif /* defined CLUTTER_INPUT_EVDEV && OS_LINUX */
+
+/* replays a touch point that never ends, and checks that it is cancelled
+ * when the end of the recording removes the device
+ */
+void
+events_evdev_replay_eof (void)
+{
+#if defined CLUTTER_INPUT_EVDEV && OS_LINUX
+  ClutterDeviceManager *manager;
+  ClutterActor *stage;
+  GSList *devices;
+  State state;
+  gint fds[2];
+  gint i;
+
+  /* bail out if the evdev backend is not in use */
+  manager = clutter_device_manager_get_default ();
+  if (strcmp (G_OBJECT_TYPE_NAME (manager), "ClutterDeviceManagerEvdev") != 0)
+    return;
+
+  memset (&state, 0, sizeof (State));
+
+  stage = clutter_stage_new ();
+  g_signal_connect (stage, "captured-event",
+                    G_CALLBACK (captured_event_cb),
+                    &state);
+  clutter_actor_show (stage);
+
+  g_assert (pipe (fds) == 0);
+
+  state.device = clutter_evdev_add_device_for_fd (fds[0],
+                                                  CLUTTER_TOUCHSCREEN_DEVICE,
+                                                  "replay");
+  g_assert (state.device != NULL);
+
+  write_event (fds[1], EV_ABS, ABS_MT_SLOT, 0);
+  write_event (fds[1], EV_ABS, ABS_MT_TRACKING_ID, 1);
+  write_event (fds[1], EV_ABS, ABS_MT_POSITION_X, 10);
+  write_event (fds[1], EV_ABS, ABS_MT_POSITION_Y, 10);
+  write_event (fds[1], EV_SYN, SYN_REPORT, 0);
+
+  /* the end of the stream */
+  close (fds[1]);
+
+  for (i = 0; i < 5000 && state.n_cancels == 0; i++)
+    {
+      while (g_main_context_pending (NULL))
+        g_main_context_iteration (NULL, FALSE);
+
+      if (state.n_cancels == 0)
+        g_usleep (1000);
+    }
+
+  if (g_test_verbose ())
+    g_print ("begins: %d, cancels: %d\n", state.n_begins, state.n_cancels);
+
+  g_assert_cmpint (state.n_begins, ==, 1);
+  g_assert_cmpint (state.n_cancels, ==, 1);
+  g_assert (!state.foreign_device);
+
+  devices = clutter_device_manager_list_devices (manager);
+  g_assert (g_slist_find (devices, state.device) == NULL);
+  g_slist_free (devices);
+
+  clutter_actor_destroy (stage);
+#endif /* defined CLUTTER_INPUT_EVDEV && OS_LINUX */
+}
@@ -0,0 +1,214 @@
+#include "config.h"
+#include <clutter/clutter.h>
+
+#if defined CLUTTER_INPUT_EVDEV && OS_LINUX
+
+#include <string.h>
+#include <unistd.h>
+#include <linux/input.h>
+
+#include <clutter/evdev/clutter-evdev.h>
+
+#include "test-conform-common.h"
+
+#define N_UPDATES 3
+
+typedef struct _State State;
+
+struct _State
+{
+  ClutterActor *stage;
+  ClutterActor *target;
+  ClutterActor *grabber;
+  ClutterInputDevice *device;
+
+  /* the sequence of the touch point, allocated by the backend */
+  ClutterEventSequence *sequence;
+
+  gint n_target_events;
+  gint n_grabber_events;
+  gint n_grabber_updates;
+  gboolean grabber_ended;
+};
+
+static gboolean
+target_touch_cb (ClutterActor *actor,
+                 ClutterEvent *event,
+                 State        *state)
+{
+  state->n_target_events += 1;
+
+  /* the touch point is grabbed as soon as it starts, like a gesture
+   * recognizer would do
+   */
+  if (clutter_event_type (event) == CLUTTER_TOUCH_BEGIN)
+    {
+      ClutterInputDevice *device = clutter_event_get_device (event);
+
+      g_assert (device == state->device);
+
+      state->sequence = clutter_event_get_event_sequence (event);
+      g_assert (state->sequence != NULL);
+
+      clutter_input_device_sequence_grab (device,
+                                          state->sequence,
+                                          state->grabber);
+      g_assert (clutter_input_device_sequence_get_grabbed_actor (device,
+                                                                 state->sequence) == state->grabber);
+    }
+
+  return CLUTTER_EVENT_STOP;
+}
+
+static gboolean
+grabber_touch_cb (ClutterActor *actor,
+                  ClutterEvent *event,
+                  State        *state)
+{
+  g_assert (clutter_event_get_event_sequence (event) == state->sequence);
+
+  state->n_grabber_events += 1;
+
+  switch (clutter_event_type (event))
+    {
+    case CLUTTER_TOUCH_UPDATE:
+      state->n_grabber_updates += 1;
+      break;
+
+    case CLUTTER_TOUCH_END:
+      state->grabber_ended = TRUE;
+      break;
+
+    default:
+      break;
+    }
+
+  return CLUTTER_EVENT_STOP;
+}
+
+static void
+write_event (gint   fd,
+             guint  type,
+             guint  code,
+             gint   value)
+{
+  struct input_event e;
+
+  memset (&e, 0, sizeof (e));
+  e.type = type;
+  e.code = code;
+  e.value = value;
+
+  g_assert_cmpint (write (fd, &e, sizeof (e)), ==, sizeof (e));
+}
+
+static void
+run_grab_test (gboolean motion_events)
+{
+  State state;
+  gint fds[2];
+  gint i;
+
+  memset (&state, 0, sizeof (State));
+
+  state.stage = clutter_stage_new ();
+  clutter_stage_set_motion_events_enabled (CLUTTER_STAGE (state.stage),
+                                           motion_events);
+  clutter_stage_set_throttle_motion_events (CLUTTER_STAGE (state.stage),
+                                            FALSE);
+
+  /* the touch points are all inside the target */
+  state.target = clutter_actor_new ();
+  clutter_actor_set_size (state.target, 100, 100);
+  clutter_actor_set_reactive (state.target, TRUE);
+  clutter_actor_add_child (state.stage, state.target);
+  g_signal_connect (state.target, "touch-event",
+                    G_CALLBACK (target_touch_cb),
+                    &state);
+
+  state.grabber = clutter_actor_new ();
+  clutter_actor_set_position (state.grabber, 200, 0);
+  clutter_actor_set_size (state.grabber, 100, 100);
+  clutter_actor_set_reactive (state.grabber, TRUE);
+  clutter_actor_add_child (state.stage, state.grabber);
+  g_signal_connect (state.grabber, "touch-event",
+                    G_CALLBACK (grabber_touch_cb),
+                    &state);
+
+  clutter_actor_show (state.stage);
+
+  /* the events are replayed through the backend, so the sequence of
+   * the touch point comes from the sequence table
+   */
+  g_assert (pipe (fds) == 0);
+
+  state.device = clutter_evdev_add_device_for_fd (fds[0],
+                                                  CLUTTER_TOUCHSCREEN_DEVICE,
+                                                  "touch-grab");
+  g_assert (state.device != NULL);
+
+  write_event (fds[1], EV_ABS, ABS_MT_SLOT, 0);
+  write_event (fds[1], EV_ABS, ABS_MT_TRACKING_ID, 1);
+  write_event (fds[1], EV_ABS, ABS_MT_POSITION_X, 10);
+  write_event (fds[1], EV_ABS, ABS_MT_POSITION_Y, 10);
+  write_event (fds[1], EV_SYN, SYN_REPORT, 0);
+
+  for (i = 1; i <= N_UPDATES; i++)
+    {
+      write_event (fds[1], EV_ABS, ABS_MT_POSITION_X, 10 + i);
+      write_event (fds[1], EV_SYN, SYN_REPORT, 0);
+    }
+
+  write_event (fds[1], EV_ABS, ABS_MT_TRACKING_ID, -1);
+  write_event (fds[1], EV_SYN, SYN_REPORT, 0);
+
+  for (i = 0; i < 5000 && !state.grabber_ended; i++)
+    {
+      while (g_main_context_pending (NULL))
+        g_main_context_iteration (NULL, FALSE);
+
+      if (!state.grabber_ended)
+        g_usleep (1000);
+    }
+
+  if (g_test_verbose ())
+    g_print ("motion events: %s, target: %d, grabber: %d (updates: %d)\n",
+             motion_events ? "yes" : "no",
+             state.n_target_events,
+             state.n_grabber_events,
+             state.n_grabber_updates);
+
+  /* only the beginning of the touch point is delivered by picking */
+  g_assert_cmpint (state.n_target_events, ==, 1);
+  g_assert_cmpint (state.n_grabber_events, ==, N_UPDATES + 1);
+  g_assert_cmpint (state.n_grabber_updates, ==, N_UPDATES);
+  g_assert (state.grabber_ended);
+
+  /* the end of the stream removes the device */
+  close (fds[1]);
+
+  clutter_actor_destroy (state.stage);
+}
+
+#endif /* defined CLUTTER_INPUT_EVDEV && OS_LINUX */
+
+void
+events_touch_grab (void)
+{
+#if defined CLUTTER_INPUT_EVDEV && OS_LINUX
+  ClutterDeviceManager *manager;
+
+  /* the touch points are replayed through the evdev backend */
+  manager = clutter_device_manager_get_default ();
+  if (strcmp (G_OBJECT_TYPE_NAME (manager), "ClutterDeviceManagerEvdev") != 0)
+    {
+      if (g_test_verbose ())
+        g_print ("The evdev backend is not in use, skipping\n");
+
+      return;
+    }
+
+  run_grab_test (TRUE);
+  run_grab_test (FALSE);
+#endif /* defined CLUTTER_INPUT_EVDEV && OS_LINUX */
+}
@@ -376,6 +376,8 @@ events_touch (void)
   state.gesture_points = 0;
 
   stage = clutter_stage_new ();
+  /* we check every point of the gesture, so they must not be compressed */
+  clutter_stage_set_throttle_motion_events (CLUTTER_STAGE (stage), FALSE);
   g_signal_connect (stage, "event", G_CALLBACK (event_cb), &state);
   clutter_stage_set_fullscreen (CLUTTER_STAGE (stage), TRUE);
   clutter_actor_show (stage);
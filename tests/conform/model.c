@@ -524,3 +524,372 @@ list_model_row_changed (TestConformSimpleFixture *fixture,
   g_object_unref (test_data.iter);
   g_object_unref (test_data.model);
 }
+
+static void
+check_filtered_rows (ClutterModel *model,
+                     const gint   *expected_bar,
+                     gint          n_expected)
+{
+  ClutterModelIter *iter;
+  gint i;
+
+  g_assert_cmpint (clutter_model_get_n_rows (model), ==, n_expected);
+
+  iter = clutter_model_get_first_iter (model);
+  g_assert (iter != NULL);
+  g_assert (clutter_model_iter_is_first (iter));
+
+  i = 0;
+  while (!clutter_model_iter_is_last (iter))
+    {
+      gint bar = 0;
+
+      clutter_model_iter_get (iter, COLUMN_BAR, &bar, -1);
+
+      if (g_test_verbose ())
+        g_print ("Row %d: got %d, expected %d\n", i, bar, expected_bar[i]);
+
+      g_assert_cmpint (i, <, n_expected);
+      g_assert_cmpint (clutter_model_iter_get_row (iter), ==, i);
+      g_assert_cmpint (bar, ==, expected_bar[i]);
+
+      iter = clutter_model_iter_next (iter);
+      i += 1;
+    }
+
+  g_assert_cmpint (i, ==, n_expected);
+
+  g_object_unref (iter);
+
+  /* the rows looked up by position follow the same order */
+  for (i = 0; i < n_expected; i++)
+    {
+      gint bar = 0;
+
+      iter = clutter_model_get_iter_at_row (model, i);
+      clutter_model_iter_get (iter, COLUMN_BAR, &bar, -1);
+      g_assert_cmpint (bar, ==, expected_bar[i]);
+      g_object_unref (iter);
+    }
+
+  g_assert (clutter_model_get_iter_at_row (model, n_expected) == NULL);
+}
+
+static gint
+sort_bar_descending (ClutterModel *model,
+                     const GValue *a,
+                     const GValue *b,
+                     gpointer      dummy G_GNUC_UNUSED)
+{
+  return g_value_get_int (b) - g_value_get_int (a);
+}
+
+void
+list_model_filter_index (TestConformSimpleFixture *fixture,
+                         gconstpointer             data)
+{
+  static const gint odd_rows[] = { 1, 3, 5, 7, 9 };
+  static const gint changed_rows[] = { 3, 5, 7, 9 };
+  static const gint added_rows[] = { 13, 3, 5, 7, 9, 11 };
+  static const gint removed_rows[] = { 3, 5, 7, 9, 11 };
+  static const gint sorted_rows[] = { 11, 9, 7, 5, 3 };
+  static const gint even_rows[] = { 12, 10, 8, 6, 4, 2 };
+  ClutterModel *model;
+  ClutterModelIter *iter;
+  gint i;
+
+  model = clutter_list_model_new (N_COLUMNS,
+                                  G_TYPE_STRING, "Foo",
+                                  G_TYPE_INT,    "Bar");
+
+  for (i = 1; i < 10; i++)
+    clutter_model_append (model, COLUMN_FOO, "foo", COLUMN_BAR, i, -1);
+
+  clutter_model_set_filter (model, filter_odd_rows, NULL, NULL);
+  check_filtered_rows (model, odd_rows, G_N_ELEMENTS (odd_rows));
+
+  if (g_test_verbose ())
+    g_print ("Changing a visible row...\n");
+
+  /* the first row is not visible through the filter anymore */
+  iter = clutter_model_get_first_iter (model);
+  clutter_model_iter_set (iter, COLUMN_BAR, 2, -1);
+  g_object_unref (iter);
+
+  check_filtered_rows (model, changed_rows, G_N_ELEMENTS (changed_rows));
+
+  if (g_test_verbose ())
+    g_print ("Adding rows...\n");
+
+  /* one visible and one filtered row at each end of the model */
+  clutter_model_append (model, COLUMN_FOO, "foo", COLUMN_BAR, 10, -1);
+  clutter_model_append (model, COLUMN_FOO, "foo", COLUMN_BAR, 11, -1);
+  clutter_model_prepend (model, COLUMN_FOO, "foo", COLUMN_BAR, 12, -1);
+  clutter_model_prepend (model, COLUMN_FOO, "foo", COLUMN_BAR, 13, -1);
+
+  check_filtered_rows (model, added_rows, G_N_ELEMENTS (added_rows));
+
+  if (g_test_verbose ())
+    g_print ("Removing rows...\n");
+
+  /* the position is the one of the row in the whole model */
+  clutter_model_remove (model, 0);
+
+  check_filtered_rows (model, removed_rows, G_N_ELEMENTS (removed_rows));
+
+  /* and a row hidden by the filter is not removed */
+  clutter_model_remove (model, 0);
+
+  check_filtered_rows (model, removed_rows, G_N_ELEMENTS (removed_rows));
+
+  if (g_test_verbose ())
+    g_print ("Sorting...\n");
+
+  clutter_model_set_sort (model, COLUMN_BAR, sort_bar_descending, NULL, NULL);
+
+  check_filtered_rows (model, sorted_rows, G_N_ELEMENTS (sorted_rows));
+
+  if (g_test_verbose ())
+    g_print ("Changing the filter...\n");
+
+  clutter_model_set_filter (model, filter_even_rows, NULL, NULL);
+
+  check_filtered_rows (model, even_rows, G_N_ELEMENTS (even_rows));
+
+  /* moving back from the first visible row stops at the first row */
+  iter = clutter_model_get_last_iter (model);
+  while (!clutter_model_iter_is_first (iter))
+    iter = clutter_model_iter_prev (iter);
+  g_object_unref (iter);
+
+  g_object_unref (model);
+}
+
+void
+array_model_populate (TestConformSimpleFixture *fixture,
+                      gconstpointer             data)
+{
+  static const gchar *foo[] = { "String 1", "String 2", "String 3" };
+  static const gint bar[] = { 1, 2, 3 };
+  static const gint odd_rows[] = { 1, 3, 5, 7, 9 };
+  static const gint changed_rows[] = { 3, 5, 7, 9 };
+  static const gint added_rows[] = { 13, 3, 5, 7, 9, 11 };
+  static const gint removed_rows[] = { 3, 5, 7, 9, 11 };
+  static const gint sorted_rows[] = { 11, 9, 7, 5, 3 };
+  static const gint even_rows[] = { 12, 10, 8, 6, 4, 2 };
+  ClutterModel *model;
+  ClutterModelIter *iter;
+  gint values[9];
+  gint i;
+
+  model = clutter_array_model_new (N_COLUMNS,
+                                   G_TYPE_STRING, "Foo",
+                                   G_TYPE_INT,    "Bar");
+  g_assert (CLUTTER_IS_ARRAY_MODEL (model));
+
+  clutter_array_model_append_rows (CLUTTER_ARRAY_MODEL (model),
+                                   G_N_ELEMENTS (bar),
+                                   COLUMN_FOO, foo,
+                                   COLUMN_BAR, bar,
+                                   -1);
+
+  g_assert_cmpint (clutter_model_get_n_rows (model), ==, G_N_ELEMENTS (bar));
+
+  for (i = 0; i < G_N_ELEMENTS (bar); i++)
+    {
+      gchar *str = NULL;
+      gint value = 0;
+
+      g_assert_cmpstr (clutter_array_model_get_string (CLUTTER_ARRAY_MODEL (model), i, COLUMN_FOO),
+                       ==,
+                       foo[i]);
+      g_assert_cmpint (clutter_array_model_get_int (CLUTTER_ARRAY_MODEL (model), i, COLUMN_BAR),
+                       ==,
+                       bar[i]);
+
+      /* the values read through the iterators are the same */
+      iter = clutter_model_get_iter_at_row (model, i);
+      clutter_model_iter_get (iter, COLUMN_FOO, &str, COLUMN_BAR, &value, -1);
+      g_assert_cmpstr (str, ==, foo[i]);
+      g_assert_cmpint (value, ==, bar[i]);
+      g_free (str);
+      g_object_unref (iter);
+    }
+
+  g_object_unref (model);
+
+  /* the filter index behaves like the one of ClutterListModel */
+  model = clutter_array_model_new (N_COLUMNS,
+                                   G_TYPE_STRING, "Foo",
+                                   G_TYPE_INT,    "Bar");
+
+  for (i = 0; i < G_N_ELEMENTS (values); i++)
+    values[i] = i + 1;
+
+  clutter_array_model_append_rows (CLUTTER_ARRAY_MODEL (model),
+                                   G_N_ELEMENTS (values),
+                                   COLUMN_BAR, values,
+                                   -1);
+
+  clutter_model_set_filter (model, filter_odd_rows, NULL, NULL);
+  check_filtered_rows (model, odd_rows, G_N_ELEMENTS (odd_rows));
+
+  iter = clutter_model_get_first_iter (model);
+  clutter_model_iter_set (iter, COLUMN_BAR, 2, -1);
+  g_object_unref (iter);
+
+  check_filtered_rows (model, changed_rows, G_N_ELEMENTS (changed_rows));
+
+  clutter_model_append (model, COLUMN_FOO, "foo", COLUMN_BAR, 10, -1);
+  clutter_model_append (model, COLUMN_FOO, "foo", COLUMN_BAR, 11, -1);
+  clutter_model_prepend (model, COLUMN_FOO, "foo", COLUMN_BAR, 12, -1);
+  clutter_model_prepend (model, COLUMN_FOO, "foo", COLUMN_BAR, 13, -1);
+
+  check_filtered_rows (model, added_rows, G_N_ELEMENTS (added_rows));
+
+  clutter_model_remove (model, 0);
+
+  check_filtered_rows (model, removed_rows, G_N_ELEMENTS (removed_rows));
+
+  clutter_model_set_sort (model, COLUMN_BAR, sort_bar_descending, NULL, NULL);
+
+  check_filtered_rows (model, sorted_rows, G_N_ELEMENTS (sorted_rows));
+  g_assert_cmpint (clutter_array_model_get_int (CLUTTER_ARRAY_MODEL (model), 0, COLUMN_BAR),
+                   ==,
+                   11);
+
+  clutter_model_set_filter (model, filter_even_rows, NULL, NULL);
+
+  check_filtered_rows (model, even_rows, G_N_ELEMENTS (even_rows));
+
+  g_object_unref (model);
+}
+
+static gint
+sort_bar_ascending (ClutterModel *model,
+                    const GValue *a,
+                    const GValue *b,
+                    gpointer      dummy G_GNUC_UNUSED)
+{
+  return g_value_get_int (a) - g_value_get_int (b);
+}
+
+static void
+check_bar_column (ClutterModel *model,
+                  const gint   *expected,
+                  guint         n_expected)
+{
+  guint i;
+
+  g_assert_cmpint (clutter_model_get_n_rows (model), ==, n_expected);
+
+  for (i = 0; i < n_expected; i++)
+    {
+      gint value = clutter_array_model_get_int (CLUTTER_ARRAY_MODEL (model),
+                                                i,
+                                                COLUMN_BAR);
+
+      if (g_test_verbose ())
+        g_print ("row %u: %d (expected: %d)\n", i, value, expected[i]);
+
+      g_assert_cmpint (value, ==, expected[i]);
+    }
+}
+
+static gint
+iter_get_bar (ClutterModelIter *iter)
+{
+  gint value = 0;
+
+  clutter_model_iter_get (iter, COLUMN_BAR, &value, -1);
+
+  return value;
+}
+
+void
+array_model_sort (TestConformSimpleFixture *fixture,
+                  gconstpointer             data)
+{
+  static const gint bar[] = { 5, 3, 8, 1, 9, 2 };
+  static const gint sorted_rows[] = { 1, 2, 3, 5, 8, 9 };
+  static const gint changed_rows[] = { 2, 3, 5, 7, 8, 9 };
+  static const gint prepended_rows[] = { 0, 2, 3, 5, 7, 8, 9 };
+  static const gint removed_rows[] = { 2, 3, 5, 7, 8, 9 };
+  static const gint inserted_rows[] = { 2, 3, 5, 7, 4, 8, 9 };
+  ClutterModel *model;
+  ClutterModelIter *iter, *other;
+
+  model = clutter_array_model_new (N_COLUMNS,
+                                   G_TYPE_STRING, "Foo",
+                                   G_TYPE_INT,    "Bar");
+
+  clutter_array_model_append_rows (CLUTTER_ARRAY_MODEL (model),
+                                   G_N_ELEMENTS (bar),
+                                   COLUMN_BAR, bar,
+                                   -1);
+
+  /* sorting without a filter */
+  clutter_model_set_sort (model, COLUMN_BAR, sort_bar_ascending, NULL, NULL);
+  check_bar_column (model, sorted_rows, G_N_ELEMENTS (sorted_rows));
+
+  /* an iterator stays on its row when changing the sorting column
+   * through it moves the row
+   */
+  iter = clutter_model_get_iter_at_row (model, 0);
+  other = clutter_model_get_iter_at_row (model, 4);
+  g_assert_cmpint (iter_get_bar (other), ==, 8);
+
+  clutter_model_iter_set (iter, COLUMN_BAR, 7, -1);
+  check_bar_column (model, changed_rows, G_N_ELEMENTS (changed_rows));
+
+  g_assert_cmpint (iter_get_bar (iter), ==, 7);
+  g_assert_cmpint (clutter_model_iter_get_row (iter), ==, 3);
+  g_assert_cmpint (iter_get_bar (other), ==, 8);
+  g_assert_cmpint (clutter_model_iter_get_row (other), ==, 4);
+
+  /* and when rows are added or removed before it */
+  clutter_model_prepend (model, COLUMN_BAR, 0, -1);
+  check_bar_column (model, prepended_rows, G_N_ELEMENTS (prepended_rows));
+
+  g_assert_cmpint (iter_get_bar (iter), ==, 7);
+  g_assert_cmpint (clutter_model_iter_get_row (iter), ==, 4);
+
+  clutter_model_remove (model, 0);
+  check_bar_column (model, removed_rows, G_N_ELEMENTS (removed_rows));
+
+  g_assert_cmpint (iter_get_bar (iter), ==, 7);
+  g_assert_cmpint (clutter_model_iter_get_row (iter), ==, 3);
+
+  /* moving the iterator starts from its current row */
+  clutter_model_iter_next (iter);
+  g_assert_cmpint (iter_get_bar (iter), ==, 8);
+  clutter_model_iter_prev (iter);
+  g_assert_cmpint (iter_get_bar (iter), ==, 7);
+
+  /* without sorting, the new rows stay where they are inserted */
+  clutter_model_set_sort (model, -1, NULL, NULL, NULL);
+  clutter_model_insert (model, 4, COLUMN_BAR, 4, -1);
+  check_bar_column (model, inserted_rows, G_N_ELEMENTS (inserted_rows));
+
+  g_assert_cmpint (iter_get_bar (iter), ==, 7);
+  g_assert_cmpint (clutter_model_iter_get_row (iter), ==, 3);
+  g_assert_cmpint (iter_get_bar (other), ==, 8);
+  g_assert_cmpint (clutter_model_iter_get_row (other), ==, 5);
+
+  /* an iterator on a removed row is past the last row */
+  clutter_model_remove (model, 5);
+  g_assert (clutter_model_iter_is_last (other));
+
+  /* even after the storage of the removed row is reused by a new one */
+  clutter_model_append (model, COLUMN_BAR, 6, -1);
+  g_assert (clutter_model_iter_is_last (other));
+  g_assert_cmpint (clutter_model_iter_get_row (other), ==,
+                   clutter_model_get_n_rows (model));
+
+  g_assert_cmpint (iter_get_bar (iter), ==, 7);
+  g_assert_cmpint (clutter_model_iter_get_row (iter), ==, 3);
+
+  g_object_unref (other);
+  g_object_unref (iter);
+  g_object_unref (model);
+}
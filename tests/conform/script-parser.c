@@ -442,3 +442,133 @@ script_margin (TestConformSimpleFixture *fixture,
   g_object_unref (script);
   g_free (test_file);
 }
+
+void
+script_compiled (TestConformSimpleFixture *fixture,
+                 gconstpointer dummy)
+{
+  ClutterScript *script = clutter_script_new ();
+  GObject *container, *actor;
+  ClutterColor color = { 0, };
+  GError *error = NULL;
+  gboolean focus_ret;
+  gchar *test_file;
+  gchar *contents;
+  gsize length;
+  GBytes *compiled;
+
+  test_file = clutter_test_get_data_file ("test-script-child.json");
+  g_file_get_contents (test_file, &contents, &length, &error);
+  g_assert_no_error (error);
+
+  compiled = clutter_script_compile_data (contents, length, &error);
+  g_assert_no_error (error);
+  g_assert (compiled != NULL);
+
+  clutter_script_load_from_data (script,
+                                 g_bytes_get_data (compiled, NULL),
+                                 g_bytes_get_size (compiled),
+                                 &error);
+  if (g_test_verbose () && error)
+    g_print ("Error: %s", error->message);
+
+  g_assert_no_error (error);
+
+  /* the children are built on demand, before their parent */
+  actor = clutter_script_get_object (script, "test-rect-1");
+  g_assert (CLUTTER_IS_RECTANGLE (actor));
+  g_assert (clutter_actor_get_parent (CLUTTER_ACTOR (actor)) == NULL);
+  g_assert_cmpfloat (clutter_actor_get_width (CLUTTER_ACTOR (actor)), ==, 100.0f);
+
+  container = clutter_script_get_object (script, "test-group");
+  g_assert (TEST_IS_GROUP (container));
+  g_assert (clutter_actor_get_parent (CLUTTER_ACTOR (actor)) == CLUTTER_ACTOR (container));
+
+  focus_ret = FALSE;
+  clutter_container_child_get (CLUTTER_CONTAINER (container),
+                               CLUTTER_ACTOR (actor),
+                               "focus", &focus_ret,
+                               NULL);
+  g_assert (focus_ret);
+
+  actor = clutter_script_get_object (script, "test-rect-2");
+  g_assert (CLUTTER_IS_RECTANGLE (actor));
+  g_assert (clutter_actor_get_parent (CLUTTER_ACTOR (actor)) == CLUTTER_ACTOR (container));
+
+  clutter_rectangle_get_color (CLUTTER_RECTANGLE (actor), &color);
+  g_assert_cmpint (color.red, ==, 0);
+  g_assert_cmpint (color.green, ==, 255);
+  g_assert_cmpint (color.alpha, ==, 255);
+
+  /* corrupted data is rejected */
+  g_assert_cmpuint (clutter_script_load_from_data (script,
+                                                   g_bytes_get_data (compiled, NULL),
+                                                   g_bytes_get_size (compiled) - 1,
+                                                   &error), ==, 0);
+  g_assert_error (error, CLUTTER_SCRIPT_ERROR,
+                  CLUTTER_SCRIPT_ERROR_INVALID_COMPILED_DATA);
+  g_clear_error (&error);
+
+  g_bytes_unref (compiled);
+  g_object_unref (script);
+  g_free (contents);
+  g_free (test_file);
+}
+
+/* the layout of the header of a compiled UI definition */
+typedef struct {
+  gchar magic[8];
+  guint32 byte_order;
+  guint32 version;
+  guint32 n_objects;
+  guint32 n_properties;
+  guint32 n_children;
+  guint32 n_signals;
+  guint32 strings_size;
+  guint32 reserved;
+} TestCompiledHeader;
+
+void
+script_compile_unbuilt (TestConformSimpleFixture *fixture,
+                        gconstpointer dummy)
+{
+  /* none of these types exist, so building any of the objects while
+   * compiling would fail
+   */
+  static const gchar definition[] =
+    "{"
+    "  \"type\" : \"TestCompiledMissingType\","
+    "  \"id\" : \"root\","
+    "  \"width\" : 100.0,"
+    "  \"opacity\" : 128,"
+    "  \"children\" : ["
+    "    {"
+    "      \"type\" : \"TestCompiledMissingType\","
+    "      \"id\" : \"child-1\","
+    "      \"child::focus\" : true"
+    "    },"
+    "    {"
+    "      \"type\" : \"TestCompiledMissingType\","
+    "      \"x\" : 10.0"
+    "    }"
+    "  ]"
+    "}";
+  TestCompiledHeader header;
+  GError *error = NULL;
+  GBytes *compiled;
+
+  compiled = clutter_script_compile_data (definition, -1, &error);
+  g_assert_no_error (error);
+  g_assert (compiled != NULL);
+  g_assert_cmpuint (g_bytes_get_size (compiled), >, sizeof (header));
+
+  memcpy (&header, g_bytes_get_data (compiled, NULL), sizeof (header));
+
+  /* every definition has been serialized intact */
+  g_assert_cmpuint (header.n_objects, ==, 3);
+  g_assert_cmpuint (header.n_properties, ==, 4);
+  g_assert_cmpuint (header.n_children, ==, 2);
+  g_assert_cmpuint (header.n_signals, ==, 0);
+
+  g_bytes_unref (compiled);
+}
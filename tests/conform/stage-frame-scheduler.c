@@ -0,0 +1,154 @@
+#include <string.h>
+#include <clutter/clutter.h>
+
+#include "test-conform-common.h"
+
+typedef struct _State   State;
+
+struct _State
+{
+  ClutterActor *stage;
+  ClutterActor *actor;
+
+  guint n_new_frames;
+  guint n_paints;
+
+  gboolean completed;
+  gboolean timed_out;
+};
+
+static void
+on_new_frame (ClutterTimeline *timeline,
+              gint             elapsed,
+              State           *state)
+{
+  /* every frame of the animation changes the scene */
+  clutter_actor_set_x (state->actor,
+                       200.f * clutter_timeline_get_progress (timeline));
+
+  state->n_new_frames += 1;
+}
+
+static void
+on_completed (ClutterTimeline *timeline,
+              State           *state)
+{
+  state->completed = TRUE;
+
+  clutter_main_quit ();
+}
+
+static gboolean
+on_timeout (gpointer data)
+{
+  State *state = data;
+
+  state->timed_out = TRUE;
+
+  clutter_main_quit ();
+
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean
+count_paints (gpointer data)
+{
+  State *state = data;
+
+  state->n_paints += 1;
+
+  return G_SOURCE_CONTINUE;
+}
+
+/* runs an animation on the stage, until it completes */
+static void
+run_animation (State *state)
+{
+  ClutterTimeline *timeline;
+  guint timeout_id;
+
+  state->n_new_frames = 0;
+  state->n_paints = 0;
+  state->completed = FALSE;
+  state->timed_out = FALSE;
+
+  timeline = clutter_timeline_new (250);
+  g_signal_connect (timeline, "new-frame", G_CALLBACK (on_new_frame), state);
+  g_signal_connect (timeline, "completed", G_CALLBACK (on_completed), state);
+
+  /* a stalled master clock would never complete the animation */
+  timeout_id = clutter_threads_add_timeout (5000, on_timeout, state);
+
+  clutter_timeline_start (timeline);
+  clutter_main ();
+
+  if (!state->timed_out)
+    g_source_remove (timeout_id);
+
+  g_object_unref (timeline);
+
+  if (g_test_verbose ())
+    g_print ("adaptive sync delay: %s, frames: %u, paints: %u\n",
+             clutter_stage_get_adaptive_sync_delay (CLUTTER_STAGE (state->stage))
+               ? "yes"
+               : "no",
+             state->n_new_frames,
+             state->n_paints);
+
+  g_assert (!state->timed_out);
+  g_assert (state->completed);
+  g_assert_cmpuint (state->n_new_frames, >, 1);
+  g_assert_cmpuint (state->n_paints, >, 1);
+}
+
+/* checks that the master clock keeps updating a stage whose sync delay
+ * is predicted by its frame scheduler, whether the backend reports the
+ * presentation times of the frames or not
+ */
+void
+stage_frame_scheduler (TestConformSimpleFixture *fixture,
+                       gconstpointer             data)
+{
+  State state;
+  guint repaint_id;
+
+  memset (&state, 0, sizeof (State));
+
+  state.stage = clutter_stage_new ();
+  g_assert (!clutter_stage_get_adaptive_sync_delay (CLUTTER_STAGE (state.stage)));
+
+  state.actor = clutter_actor_new ();
+  clutter_actor_set_background_color (state.actor, CLUTTER_COLOR_Red);
+  clutter_actor_set_size (state.actor, 100, 100);
+  clutter_actor_add_child (state.stage, state.actor);
+
+  clutter_actor_show (state.stage);
+
+  repaint_id =
+    clutter_threads_add_repaint_func_full (CLUTTER_REPAINT_FLAGS_POST_PAINT,
+                                           count_paints,
+                                           &state, NULL);
+
+  /* the costs of the first frames are recorded with a fixed delay */
+  run_animation (&state);
+
+  clutter_stage_set_adaptive_sync_delay (CLUTTER_STAGE (state.stage), TRUE);
+  g_assert (clutter_stage_get_adaptive_sync_delay (CLUTTER_STAGE (state.stage)));
+
+  /* the first animation with the adaptive delay starts from the
+   * predictions made during the previous one, and the second one
+   * from its own
+   */
+  run_animation (&state);
+  run_animation (&state);
+
+  /* a fixed delay is used again */
+  clutter_stage_set_adaptive_sync_delay (CLUTTER_STAGE (state.stage), FALSE);
+  g_assert (!clutter_stage_get_adaptive_sync_delay (CLUTTER_STAGE (state.stage)));
+
+  run_animation (&state);
+
+  clutter_threads_remove_repaint_func (repaint_id);
+
+  clutter_actor_destroy (state.stage);
+}
@@ -0,0 +1,147 @@
+#include <string.h>
+#include <clutter/clutter.h>
+
+#include "test-conform-common.h"
+
+#define STAGE_SIZE      400
+#define ACTOR_SIZE      10
+
+typedef struct _State State;
+
+struct _State
+{
+  ClutterActor *stage;
+  ClutterActor *corners[2];
+
+  gboolean recording;
+  GArray *clips;
+};
+
+static void
+stage_paint_cb (ClutterActor *stage,
+                State        *state)
+{
+  cairo_rectangle_int_t clip;
+
+  if (!state->recording)
+    return;
+
+  clutter_stage_get_redraw_clip_bounds (CLUTTER_STAGE (stage), &clip);
+  g_array_append_val (state->clips, clip);
+}
+
+static gboolean
+quit_cb (gpointer data)
+{
+  clutter_main_quit ();
+
+  return G_SOURCE_REMOVE;
+}
+
+static void
+run_frame (void)
+{
+  clutter_threads_add_repaint_func_full (CLUTTER_REPAINT_FLAGS_POST_PAINT,
+                                         quit_cb,
+                                         NULL, NULL);
+  clutter_main ();
+}
+
+static gboolean
+rectangles_intersect (const cairo_rectangle_int_t *a,
+                      const cairo_rectangle_int_t *b)
+{
+  return a->x < b->x + b->width && b->x < a->x + a->width &&
+         a->y < b->y + b->height && b->y < a->y + a->height;
+}
+
+void
+stage_redraw_clips (TestConformSimpleFixture *fixture,
+                    gconstpointer             data)
+{
+  State state;
+  guint i, j;
+
+  memset (&state, 0, sizeof (State));
+  state.clips = g_array_new (FALSE, FALSE, sizeof (cairo_rectangle_int_t));
+
+  state.stage = clutter_stage_new ();
+  clutter_actor_set_size (state.stage, STAGE_SIZE, STAGE_SIZE);
+  g_signal_connect (state.stage, "paint", G_CALLBACK (stage_paint_cb), &state);
+
+  /* two small actors in opposite corners of the stage */
+  for (i = 0; i < 2; i++)
+    {
+      state.corners[i] = clutter_actor_new ();
+      clutter_actor_set_background_color (state.corners[i], CLUTTER_COLOR_Red);
+      clutter_actor_set_size (state.corners[i], ACTOR_SIZE, ACTOR_SIZE);
+      clutter_actor_set_position (state.corners[i],
+                                  i * (STAGE_SIZE - 2 * ACTOR_SIZE) + ACTOR_SIZE,
+                                  i * (STAGE_SIZE - 2 * ACTOR_SIZE) + ACTOR_SIZE);
+      clutter_actor_add_child (state.stage, state.corners[i]);
+    }
+
+  clutter_actor_show (state.stage);
+
+  /* clipped redraws are only used after the first frames */
+  for (i = 0; i < 5; i++)
+    {
+      clutter_actor_queue_redraw (state.stage);
+      run_frame ();
+    }
+
+  clutter_actor_queue_redraw (state.corners[0]);
+  clutter_actor_queue_redraw (state.corners[1]);
+
+  state.recording = TRUE;
+  run_frame ();
+  state.recording = FALSE;
+
+  g_assert_cmpuint (state.clips->len, >, 0);
+
+  if (state.clips->len == 1)
+    {
+      cairo_rectangle_int_t *clip =
+        &g_array_index (state.clips, cairo_rectangle_int_t, 0);
+
+      /* the backend does not support clipped redraws */
+      if (clip->width >= STAGE_SIZE && clip->height >= STAGE_SIZE)
+        {
+          if (g_test_verbose ())
+            g_print ("Clipped redraws not available, skipping\n");
+
+          goto out;
+        }
+    }
+
+  if (g_test_verbose ())
+    g_print ("%u clipped paints\n", state.clips->len);
+
+  /* each corner is painted with its own clip, instead of a clip
+   * covering the whole stage
+   */
+  g_assert_cmpuint (state.clips->len, ==, 2);
+
+  for (i = 0; i < state.clips->len; i++)
+    {
+      cairo_rectangle_int_t *clip =
+        &g_array_index (state.clips, cairo_rectangle_int_t, i);
+
+      if (g_test_verbose ())
+        g_print ("clip %u: %d, %d, %d x %d\n",
+                 i, clip->x, clip->y, clip->width, clip->height);
+
+      g_assert_cmpint (clip->width, <, STAGE_SIZE / 2);
+      g_assert_cmpint (clip->height, <, STAGE_SIZE / 2);
+
+      for (j = 0; j < i; j++)
+        g_assert (!rectangles_intersect (clip,
+                                         &g_array_index (state.clips,
+                                                         cairo_rectangle_int_t,
+                                                         j)));
+    }
+
+out:
+  g_array_free (state.clips, TRUE);
+  clutter_actor_destroy (state.stage);
+}
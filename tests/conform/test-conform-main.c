@@ -138,14 +138,27 @@ main (int argc, char **argv)
   TEST_CONFORM_SIMPLE ("/actor", actor_remove_all);
   TEST_CONFORM_SIMPLE ("/actor", actor_container_signals);
   TEST_CONFORM_SIMPLE ("/actor", actor_destruction);
+  TEST_CONFORM_SIMPLE ("/actor", actor_destroy_queued_redraw);
+  TEST_CONFORM_SIMPLE ("/actor", actor_destroy_requeued_redraw);
   TEST_CONFORM_SIMPLE ("/actor", actor_anchors);
   TEST_CONFORM_SIMPLE ("/actor", actor_pick);
+  TEST_CONFORM_SIMPLE ("/actor", actor_pick_geometric);
+  TEST_CONFORM_SIMPLE ("/actor", actor_pick_index);
+  TEST_CONFORM_SIMPLE ("/actor", actor_pick_index_late_handler);
   TEST_CONFORM_SIMPLE ("/actor", actor_fixed_size);
   TEST_CONFORM_SIMPLE ("/actor", actor_preferred_size);
   TEST_CONFORM_SIMPLE ("/actor", actor_basic_layout);
   TEST_CONFORM_SIMPLE ("/actor", actor_margin_layout);
+  TEST_CONFORM_SIMPLE ("/actor", actor_boundary_expand);
   TEST_CONFORM_SIMPLE ("/actor", actor_offscreen_redirect);
+  TEST_CONFORM_SIMPLE ("/actor", actor_offscreen_pool);
+  TEST_CONFORM_SIMPLE ("/actor", actor_offscreen_pool_budget);
+  TEST_CONFORM_SIMPLE ("/actor", actor_paint_nodes_retained);
+  TEST_CONFORM_SIMPLE ("/actor", actor_paint_nodes_batched);
   TEST_CONFORM_SIMPLE ("/actor", actor_shader_effect);
+  TEST_CONFORM_SIMPLE ("/actor", actor_transition_batch);
+  TEST_CONFORM_SIMPLE ("/actor", deform_effect_batched);
+  TEST_CONFORM_SIMPLE ("/actor", deform_effect_ranges);
 
   TEST_CONFORM_SIMPLE ("/actor/iter", actor_iter_traverse_children);
   TEST_CONFORM_SIMPLE ("/actor/iter", actor_iter_traverse_remove);
@@ -179,7 +192,11 @@ main (int argc, char **argv)
   TEST_CONFORM_SIMPLE ("/text", text_cursor);
   TEST_CONFORM_SIMPLE ("/text", text_event);
   TEST_CONFORM_SIMPLE ("/text", text_get_chars);
+  TEST_CONFORM_SIMPLE ("/text", text_buffer_chunks);
   TEST_CONFORM_SIMPLE ("/text", text_cache);
+  TEST_CONFORM_SIMPLE ("/text", text_shared_cache);
+  TEST_CONFORM_SIMPLE ("/text", text_shape_async);
+  TEST_CONFORM_SIMPLE ("/text", text_shape_async_many);
   TEST_CONFORM_SIMPLE ("/text", text_password_char);
   TEST_CONFORM_SIMPLE ("/text", text_idempotent_use_markup);
 
@@ -190,18 +207,26 @@ main (int argc, char **argv)
   TEST_CONFORM_SIMPLE ("/texture", texture_fbo);
   TEST_CONFORM_SIMPLE ("/texture/cairo", texture_cairo);
 
+  TEST_CONFORM_SIMPLE ("/canvas", canvas_draw_async_switch);
+
   TEST_CONFORM_SIMPLE ("/interval", interval_initial_state);
   TEST_CONFORM_SIMPLE ("/interval", interval_transform);
 
   TEST_CONFORM_SIMPLE ("/path", path_base);
 
+  TEST_CONFORM_SIMPLE ("/stage", stage_redraw_clips);
+  TEST_CONFORM_SIMPLE ("/stage", stage_frame_scheduler);
+
   TEST_CONFORM_SIMPLE ("/binding-pool", binding_pool);
 
   TEST_CONFORM_SIMPLE ("/model", list_model_populate);
   TEST_CONFORM_SIMPLE ("/model", list_model_iterate);
   TEST_CONFORM_SIMPLE ("/model", list_model_filter);
+  TEST_CONFORM_SIMPLE ("/model", list_model_filter_index);
   TEST_CONFORM_SIMPLE ("/model", list_model_from_script);
   TEST_CONFORM_SIMPLE ("/model", list_model_row_changed);
+  TEST_CONFORM_SIMPLE ("/model", array_model_populate);
+  TEST_CONFORM_SIMPLE ("/model", array_model_sort);
 
   TEST_CONFORM_SIMPLE ("/color", color_from_string_valid);
   TEST_CONFORM_SIMPLE ("/color", color_from_string_invalid);
@@ -227,6 +252,8 @@ main (int argc, char **argv)
   TEST_CONFORM_SIMPLE ("/script", animator_multi_properties);
   TEST_CONFORM_SIMPLE ("/script", state_base);
   TEST_CONFORM_SIMPLE ("/script", script_margin);
+  TEST_CONFORM_SIMPLE ("/script", script_compiled);
+  TEST_CONFORM_SIMPLE ("/script", script_compile_unbuilt);
 
   TEST_CONFORM_SIMPLE ("/timeline", timeline_base);
   TEST_CONFORM_SIMPLE ("/timeline", timeline_markers_from_script);
@@ -240,6 +267,9 @@ main (int argc, char **argv)
   TEST_CONFORM_SIMPLE ("/behaviours", behaviours_base);
 
   TEST_CONFORM_SIMPLE ("/events", events_touch);
+  TEST_CONFORM_SIMPLE ("/events", events_touch_compression);
+  TEST_CONFORM_SIMPLE ("/events", events_touch_grab);
+  TEST_CONFORM_SIMPLE ("/events", events_evdev_replay_eof);
 
   /* FIXME - see bug https://bugzilla.gnome.org/show_bug.cgi?id=655588 */
   TEST_CONFORM_TODO ("/cally", cally_text);
@@ -1,3 +1,4 @@
+#define CLUTTER_ENABLE_EXPERIMENTAL_API
 #include <clutter/clutter.h>
 #include <string.h>
 #include <stdlib.h>
@@ -295,3 +296,232 @@ text_cache (void)
     g_assert (data.test_failed != TRUE);
 }
 
+
+void
+text_shared_cache (void)
+{
+  ClutterActor *stage, *a, *b, *c;
+  PangoLayout *layout_a, *layout_b, *layout_c;
+
+  stage = clutter_stage_new ();
+
+  /* two labels with the same contents share the same layout */
+  a = clutter_text_new_with_text (TEST_FONT, "Shared label");
+  b = clutter_text_new_with_text (TEST_FONT, "Shared label");
+  c = clutter_text_new_with_text ("Serif 15", "Shared label");
+
+  clutter_actor_add_child (stage, a);
+  clutter_actor_add_child (stage, b);
+  clutter_actor_add_child (stage, c);
+
+  layout_a = clutter_text_get_layout (CLUTTER_TEXT (a));
+  layout_b = clutter_text_get_layout (CLUTTER_TEXT (b));
+  layout_c = clutter_text_get_layout (CLUTTER_TEXT (c));
+
+  g_assert (layout_a == layout_b);
+
+  /* a different font yields a different layout */
+  g_assert (layout_a != layout_c);
+
+  /* changing one label does not affect the other */
+  clutter_text_set_text (CLUTTER_TEXT (b), "Another label");
+  layout_b = clutter_text_get_layout (CLUTTER_TEXT (b));
+  g_assert (layout_a != layout_b);
+  g_assert_cmpstr (pango_layout_get_text (layout_a), ==, "Shared label");
+  g_assert_cmpstr (pango_layout_get_text (layout_b), ==, "Another label");
+
+  /* markup is compared through the attributes it generates */
+  clutter_text_set_markup (CLUTTER_TEXT (a), "<b>Bold</b> label");
+  clutter_text_set_markup (CLUTTER_TEXT (b), "<b>Bold</b> label");
+  g_assert (clutter_text_get_layout (CLUTTER_TEXT (a)) ==
+            clutter_text_get_layout (CLUTTER_TEXT (b)));
+
+  clutter_text_set_markup (CLUTTER_TEXT (b), "<i>Bold</i> label");
+  g_assert (clutter_text_get_layout (CLUTTER_TEXT (a)) !=
+            clutter_text_get_layout (CLUTTER_TEXT (b)));
+
+  /* editable actors do not share their layouts */
+  clutter_text_set_text (CLUTTER_TEXT (a), "Editable");
+  clutter_text_set_text (CLUTTER_TEXT (b), "Editable");
+  clutter_text_set_editable (CLUTTER_TEXT (a), TRUE);
+  clutter_text_set_editable (CLUTTER_TEXT (b), TRUE);
+  g_assert (clutter_text_get_layout (CLUTTER_TEXT (a)) !=
+            clutter_text_get_layout (CLUTTER_TEXT (b)));
+
+  clutter_actor_destroy (stage);
+}
+
+static gboolean
+text_layout_has_text (ClutterActor *actor,
+                      const gchar  *text)
+{
+  PangoLayout *layout = clutter_text_get_layout (CLUTTER_TEXT (actor));
+
+  return strcmp (pango_layout_get_text (layout), text) == 0;
+}
+
+void
+text_shape_async (void)
+{
+  ClutterActor *stage, *label, *estimated, *reference, *destroyed;
+  GString *first, *second;
+  gfloat width, reference_width;
+  gint i;
+
+  first = g_string_new (NULL);
+  second = g_string_new (NULL);
+  for (i = 0; i < 32; i++)
+    {
+      g_string_append (first, "Shaped, and then cancelled. ");
+      g_string_append (second, "Shaped in a worker thread. ");
+    }
+
+  stage = clutter_stage_new ();
+
+  label = clutter_text_new_with_text (TEST_FONT, "Old label");
+  clutter_text_set_shape_async (CLUTTER_TEXT (label), TRUE);
+  clutter_actor_add_child (stage, label);
+
+  /* short texts are shaped synchronously */
+  g_assert (text_layout_has_text (label, "Old label"));
+
+  /* replacing the text while it is being shaped cancels the job */
+  clutter_text_set_text (CLUTTER_TEXT (label), first->str);
+  clutter_actor_get_preferred_width (label, -1, NULL, &width);
+  clutter_text_set_text (CLUTTER_TEXT (label), second->str);
+  clutter_actor_get_preferred_width (label, -1, NULL, &width);
+
+  /* the previous layout is used until the new one is shaped */
+  g_assert (text_layout_has_text (label, "Old label"));
+
+  /* without a previous layout, the size is estimated */
+  estimated = clutter_text_new ();
+  clutter_text_set_font_name (CLUTTER_TEXT (estimated), TEST_FONT);
+  clutter_text_set_shape_async (CLUTTER_TEXT (estimated), TRUE);
+  clutter_text_set_text (CLUTTER_TEXT (estimated), first->str);
+  clutter_actor_add_child (stage, estimated);
+
+  clutter_actor_get_preferred_width (estimated, -1, NULL, &width);
+  g_assert_cmpfloat (width, >, 0);
+  g_assert (text_layout_has_text (estimated, ""));
+
+  /* destroying an actor cancels its jobs */
+  destroyed = clutter_text_new_with_text (TEST_FONT, second->str);
+  clutter_text_set_shape_async (CLUTTER_TEXT (destroyed), TRUE);
+  clutter_actor_add_child (stage, destroyed);
+  clutter_actor_get_preferred_width (destroyed, -1, NULL, &width);
+  clutter_actor_destroy (destroyed);
+
+  for (i = 0;
+       i < 5000 && (!text_layout_has_text (label, second->str) ||
+                    !text_layout_has_text (estimated, first->str));
+       i++)
+    {
+      while (g_main_context_pending (NULL))
+        g_main_context_iteration (NULL, FALSE);
+
+      /* the result of the cancelled job is never displayed */
+      g_assert (!text_layout_has_text (label, first->str));
+
+      g_usleep (1000);
+    }
+
+  g_assert (text_layout_has_text (label, second->str));
+
+  /* the placeholders are not cached for the size they were requested
+   * for, so the shaped text replaces the estimated one
+   */
+  g_assert (text_layout_has_text (estimated, first->str));
+  reference = clutter_text_new_with_text (TEST_FONT, first->str);
+  clutter_actor_add_child (stage, reference);
+
+  clutter_actor_get_preferred_width (estimated, -1, NULL, &width);
+  clutter_actor_get_preferred_width (reference, -1, NULL, &reference_width);
+  g_assert_cmpfloat (width, ==, reference_width);
+  clutter_actor_destroy (reference);
+
+  /* editable actors are shaped synchronously, and don't share the
+   * layout shaped in the worker thread
+   */
+  reference = clutter_text_new_with_text (TEST_FONT, second->str);
+  clutter_text_set_editable (CLUTTER_TEXT (reference), TRUE);
+  clutter_actor_add_child (stage, reference);
+
+  clutter_actor_get_preferred_width (label, -1, NULL, &width);
+  clutter_actor_get_preferred_width (reference, -1, NULL, &reference_width);
+  g_assert_cmpfloat (width, ==, reference_width);
+
+  clutter_actor_destroy (stage);
+
+  g_string_free (first, TRUE);
+  g_string_free (second, TRUE);
+}
+
+#define N_ASYNC_LABELS  12
+
+void
+text_shape_async_many (void)
+{
+  ClutterActor *stage, *labels[N_ASYNC_LABELS];
+  GString *texts[N_ASYNC_LABELS];
+  gboolean all_shaped;
+  gfloat width;
+  gint i, j;
+
+  stage = clutter_stage_new ();
+
+  /* more labels than the font maps of the worker threads, all of them
+   * displaying their layouts at the same time
+   */
+  for (i = 0; i < N_ASYNC_LABELS; i++)
+    {
+      texts[i] = g_string_new (NULL);
+      for (j = 0; j < 16; j++)
+        g_string_append_printf (texts[i], "Label %d, shaped in a worker. ", i);
+
+      labels[i] = clutter_text_new_with_text (TEST_FONT, texts[i]->str);
+      clutter_text_set_shape_async (CLUTTER_TEXT (labels[i]), TRUE);
+      clutter_actor_add_child (stage, labels[i]);
+
+      clutter_actor_get_preferred_width (labels[i], -1, NULL, &width);
+    }
+
+  all_shaped = FALSE;
+  for (j = 0; j < 5000 && !all_shaped; j++)
+    {
+      while (g_main_context_pending (NULL))
+        g_main_context_iteration (NULL, FALSE);
+
+      all_shaped = TRUE;
+      for (i = 0; i < N_ASYNC_LABELS; i++)
+        {
+          clutter_actor_get_preferred_width (labels[i], -1, NULL, &width);
+
+          if (!text_layout_has_text (labels[i], texts[i]->str))
+            all_shaped = FALSE;
+        }
+
+      if (!all_shaped)
+        g_usleep (1000);
+    }
+
+  g_assert (all_shaped);
+
+  /* the layouts shaped by the main thread use the default font map */
+  for (i = 0; i < N_ASYNC_LABELS; i++)
+    {
+      PangoLayout *layout = clutter_text_get_layout (CLUTTER_TEXT (labels[i]));
+      PangoContext *context = pango_layout_get_context (layout);
+
+      if (g_test_verbose ())
+        g_print ("label %d: font map %p\n",
+                 i, pango_context_get_font_map (context));
+
+      g_assert (pango_context_get_font_map (context) != clutter_get_font_map ());
+    }
+
+  clutter_actor_destroy (stage);
+
+  for (i = 0; i < N_ASYNC_LABELS; i++)
+    g_string_free (texts[i], TRUE);
+}
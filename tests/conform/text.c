@@ -502,3 +502,138 @@ text_idempotent_use_markup (void)
 
   clutter_actor_destroy (CLUTTER_ACTOR (text));
 }
+
+/* a character of one, two and three bytes, so that the chunks of the
+ * buffer never end on a character boundary by chance
+ */
+static const gchar chunk_filler[] = "a\xc3\xa4\xe2\x99\xa5";
+
+static void
+model_insert (GString     *model,
+              guint        position,
+              const gchar *chars,
+              guint        n_chars)
+{
+  gsize offset = g_utf8_offset_to_pointer (model->str, position) - model->str;
+  gsize n_bytes = g_utf8_offset_to_pointer (chars, n_chars) - chars;
+
+  g_string_insert_len (model, offset, chars, n_bytes);
+}
+
+static void
+model_delete (GString *model,
+              guint    position,
+              guint    n_chars)
+{
+  const gchar *start = g_utf8_offset_to_pointer (model->str, position);
+  const gchar *end = g_utf8_offset_to_pointer (start, n_chars);
+
+  g_string_erase (model, start - model->str, end - start);
+}
+
+static void
+check_buffer (ClutterTextBuffer *buffer,
+              ClutterText       *text,
+              GString           *model,
+              gboolean           check_text)
+{
+  guint length = g_utf8_strlen (model->str, model->len);
+  gchar *chars;
+
+  g_assert_cmpuint (clutter_text_buffer_get_length (buffer), ==, length);
+  g_assert_cmpuint (clutter_text_buffer_get_bytes (buffer), ==, model->len);
+
+  if (check_text)
+    g_assert_cmpstr (clutter_text_buffer_get_text (buffer), ==, model->str);
+
+  /* the characters around the middle of the text are looked up
+   * through the offsets of the chunks
+   */
+  if (length > 10)
+    {
+      const gchar *start = g_utf8_offset_to_pointer (model->str, length / 2);
+      const gchar *end = g_utf8_offset_to_pointer (start, 5);
+
+      chars = clutter_text_get_chars (text, length / 2, length / 2 + 5);
+      g_assert_cmpint (strlen (chars), ==, end - start);
+      g_assert (strncmp (chars, start, end - start) == 0);
+      g_free (chars);
+    }
+}
+
+void
+text_buffer_chunks (void)
+{
+  ClutterTextBuffer *buffer;
+  ClutterActor *text;
+  GString *source, *model;
+  guint source_chars;
+  guint i;
+
+  /* 3000 characters, 6000 bytes: more than a chunk */
+  source = g_string_new (NULL);
+  for (i = 0; i < 1000; i++)
+    g_string_append (source, chunk_filler);
+  source_chars = g_utf8_strlen (source->str, -1);
+
+  buffer = clutter_text_buffer_new ();
+  text = clutter_text_new_with_buffer (buffer);
+  model = g_string_new (NULL);
+
+  /* a text larger than a chunk, inserted at once */
+  clutter_text_buffer_insert_text (buffer, 0, source->str, source_chars);
+  model_insert (model, 0, source->str, source_chars);
+  check_buffer (buffer, CLUTTER_TEXT (text), model, TRUE);
+
+  /* splits the first chunk */
+  clutter_text_buffer_insert_text (buffer, 1001, source->str, 1500);
+  model_insert (model, 1001, source->str, 1500);
+  check_buffer (buffer, CLUTTER_TEXT (text), model, TRUE);
+
+  /* spans several chunks */
+  clutter_text_buffer_delete_text (buffer, 500, 3000);
+  model_delete (model, 500, 3000);
+  check_buffer (buffer, CLUTTER_TEXT (text), model, TRUE);
+
+  /* edits at pseudo-random positions, with the contiguous copy of the
+   * text either kept up to date or rebuilt
+   */
+  for (i = 0; i < 200; i++)
+    {
+      guint length = g_utf8_strlen (model->str, model->len);
+      guint position = (i * 7919) % (length + 1);
+      guint n_chars = 1 + (i * 631) % source_chars;
+
+      clutter_text_buffer_insert_text (buffer, position,
+                                       source->str + (i % 3),
+                                       MIN (n_chars, source_chars - 1));
+      model_insert (model, position,
+                    source->str + (i % 3),
+                    MIN (n_chars, source_chars - 1));
+      check_buffer (buffer, CLUTTER_TEXT (text), model, i % 2 == 0);
+
+      length = g_utf8_strlen (model->str, model->len);
+      position = (i * 104729) % length;
+      /* deletes more than it inserts, to stay well below the maximum
+       * size of the buffer
+       */
+      n_chars = MIN (1 + (i * 659) % (2 * source_chars), length - position);
+
+      clutter_text_buffer_delete_text (buffer, position, n_chars);
+      model_delete (model, position, n_chars);
+      check_buffer (buffer, CLUTTER_TEXT (text), model, i % 3 == 0);
+    }
+
+  if (g_test_verbose ())
+    g_print ("final text: %" G_GSIZE_FORMAT " bytes\n", model->len);
+
+  /* removes everything */
+  clutter_text_buffer_delete_text (buffer, 0, -1);
+  g_string_truncate (model, 0);
+  check_buffer (buffer, CLUTTER_TEXT (text), model, TRUE);
+
+  clutter_actor_destroy (text);
+  g_object_unref (buffer);
+  g_string_free (model, TRUE);
+  g_string_free (source, TRUE);
+}
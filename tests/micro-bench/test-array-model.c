@@ -0,0 +1,210 @@
+#include <stdlib.h>
+#include <string.h>
+#include <clutter/clutter.h>
+
+/* Compares the memory used by a ClutterListModel and a ClutterArrayModel
+ * holding the same integers and strings, and the cost of filling them,
+ * reading them and sorting them
+ */
+
+static const guint sizes[] = {
+  10000,
+  100000,
+  1000000,
+};
+
+enum
+{
+  COLUMN_VALUE,
+  COLUMN_LABEL,
+
+  N_COLUMNS
+};
+
+/* the resident set size of the process, in kilobytes, or 0 if it is
+ * not available
+ */
+static gulong
+get_resident_size (void)
+{
+  gchar *contents = NULL;
+  gulong retval = 0;
+  gchar *line;
+
+  if (!g_file_get_contents ("/proc/self/status", &contents, NULL, NULL))
+    return 0;
+
+  line = strstr (contents, "VmRSS:");
+  if (line != NULL)
+    retval = strtoul (line + strlen ("VmRSS:"), NULL, 10);
+
+  g_free (contents);
+
+  return retval;
+}
+
+static gint
+sort_value_ascending (ClutterModel *model,
+                      const GValue *a,
+                      const GValue *b,
+                      gpointer      dummy G_GNUC_UNUSED)
+{
+  gint value_a = g_value_get_int (a);
+  gint value_b = g_value_get_int (b);
+
+  return (value_a > value_b) - (value_a < value_b);
+}
+
+static void
+report (const gchar *model_name,
+        const gchar *operation,
+        guint        size,
+        guint        n_operations,
+        GTimer      *timer)
+{
+  g_print ("%-6s %-8s %8u rows: %10.3f us/op\n",
+           model_name,
+           operation,
+           size,
+           g_timer_elapsed (timer, NULL) * 1000000.0 / n_operations);
+}
+
+static void
+report_memory (const gchar *model_name,
+               guint        size,
+               gulong       before,
+               gulong       after)
+{
+  gulong used = after > before ? after - before : 0;
+
+  g_print ("%-6s %-8s %8u rows: %10lu kB (%.1f bytes/row)\n",
+           model_name,
+           "memory",
+           size,
+           used,
+           used * 1024.0 / size);
+}
+
+static void
+run_benchmark (gboolean     array,
+               guint        size,
+               const gint  *values,
+               const gchar *const *labels)
+{
+  const gchar *model_name = array ? "array" : "list";
+  ClutterModel *model;
+  ClutterModelIter *iter;
+  GTimer *timer;
+  gulong rss;
+  gint64 sum;
+  guint i;
+
+  timer = g_timer_new ();
+  rss = get_resident_size ();
+
+  g_timer_start (timer);
+
+  if (array)
+    {
+      model = clutter_array_model_new (N_COLUMNS,
+                                       G_TYPE_INT, "Value",
+                                       G_TYPE_STRING, "Label");
+
+      clutter_array_model_append_rows (CLUTTER_ARRAY_MODEL (model), size,
+                                       COLUMN_VALUE, values,
+                                       COLUMN_LABEL, labels,
+                                       -1);
+    }
+  else
+    {
+      model = clutter_list_model_new (N_COLUMNS,
+                                      G_TYPE_INT, "Value",
+                                      G_TYPE_STRING, "Label");
+
+      for (i = 0; i < size; i++)
+        clutter_model_append (model,
+                              COLUMN_VALUE, values[i],
+                              COLUMN_LABEL, labels[i],
+                              -1);
+    }
+
+  g_timer_stop (timer);
+  report (model_name, "append", size, size, timer);
+  report_memory (model_name, size, rss, get_resident_size ());
+
+  /* going through the iterators works the same on both models */
+  sum = 0;
+  g_timer_start (timer);
+  iter = clutter_model_get_first_iter (model);
+  while (!clutter_model_iter_is_last (iter))
+    {
+      gint value;
+
+      clutter_model_iter_get (iter, COLUMN_VALUE, &value, -1);
+      sum += value;
+
+      iter = clutter_model_iter_next (iter);
+    }
+  g_object_unref (iter);
+  g_timer_stop (timer);
+  report (model_name, "iterate", size, size, timer);
+
+  if (array)
+    {
+      ClutterArrayModel *array_model = CLUTTER_ARRAY_MODEL (model);
+      gint64 array_sum = 0;
+      gsize length = 0;
+
+      g_timer_start (timer);
+      for (i = 0; i < size; i++)
+        {
+          array_sum += clutter_array_model_get_int (array_model, i, COLUMN_VALUE);
+          length += strlen (clutter_array_model_get_string (array_model, i, COLUMN_LABEL));
+        }
+      g_timer_stop (timer);
+      report (model_name, "get", size, size, timer);
+
+      g_assert_cmpint (array_sum, ==, sum);
+      g_assert_cmpuint (length, >, 0);
+    }
+
+  g_timer_start (timer);
+  clutter_model_set_sort (model, COLUMN_VALUE, sort_value_ascending, NULL, NULL);
+  g_timer_stop (timer);
+  report (model_name, "sort", size, 1, timer);
+
+  g_timer_destroy (timer);
+  g_object_unref (model);
+}
+
+int
+main (int argc, char *argv[])
+{
+  guint i, j;
+
+  if (clutter_init (&argc, &argv) != CLUTTER_INIT_SUCCESS)
+    return EXIT_FAILURE;
+
+  for (i = 0; i < G_N_ELEMENTS (sizes); i++)
+    {
+      gint *values = g_new (gint, sizes[i]);
+      gchar **labels = g_new0 (gchar *, sizes[i] + 1);
+
+      for (j = 0; j < sizes[i]; j++)
+        {
+          values[j] = g_random_int_range (0, G_MAXINT);
+          labels[j] = g_strdup_printf ("Row %u", j);
+        }
+
+      /* the list model can reuse the memory freed by the array model,
+       * so the comparison of the memory used is on the safe side
+       */
+      run_benchmark (TRUE, sizes[i], values, (const gchar * const *) labels);
+      run_benchmark (FALSE, sizes[i], values, (const gchar * const *) labels);
+
+      g_strfreev (labels);
+      g_free (values);
+    }
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,216 @@
+#define CLUTTER_ENABLE_EXPERIMENTAL_API
+#include <stdlib.h>
+#include <clutter/clutter.h>
+
+#define CANVAS_SIZE     512
+#define CELL_SIZE       16
+#define DAMAGE_SIZE     32
+
+typedef enum {
+  MODE_STATIC,
+  MODE_FULL,
+  MODE_PARTIAL,
+
+  N_MODES
+} Mode;
+
+static const gchar *mode_names[N_MODES] = {
+  "static",
+  "fully invalidated",
+  "partially invalidated"
+};
+
+static gdouble duration = 3.0;
+static gboolean draw_async = FALSE;
+
+static GOptionEntry entries[] = {
+  {
+    "duration", 'd',
+    0,
+    G_OPTION_ARG_DOUBLE, &duration,
+    "Duration of each test, in seconds", "SECONDS"
+  },
+  {
+    "async", 'a',
+    0,
+    G_OPTION_ARG_NONE, &draw_async,
+    "Draw the canvas in a worker thread", NULL
+  },
+  { NULL }
+};
+
+static Mode mode = MODE_STATIC;
+static GTimer *timer = NULL;
+static gulong n_frames = 0;
+static volatile gint n_draws = 0;
+static gint damage_pos = 0;
+
+static gboolean
+draw_cb (ClutterCanvas *canvas,
+         cairo_t       *cr,
+         int            width,
+         int            height)
+{
+  double x1, y1, x2, y2;
+  int x, y;
+
+  g_atomic_int_inc (&n_draws);
+
+  cairo_save (cr);
+  cairo_set_operator (cr, CAIRO_OPERATOR_CLEAR);
+  cairo_paint (cr);
+  cairo_restore (cr);
+
+  /* only draw the cells inside the invalidated area */
+  cairo_clip_extents (cr, &x1, &y1, &x2, &y2);
+
+  for (y = 0; y < height; y += CELL_SIZE)
+    {
+      if (y + CELL_SIZE < y1 || y > y2)
+        continue;
+
+      for (x = 0; x < width; x += CELL_SIZE)
+        {
+          if (x + CELL_SIZE < x1 || x > x2)
+            continue;
+
+          cairo_set_source_rgba (cr,
+                                 (double) x / width,
+                                 (double) y / height,
+                                 (double) (g_atomic_int_get (&n_draws) % 256) / 255.0,
+                                 1.0);
+          cairo_arc (cr,
+                     x + CELL_SIZE / 2, y + CELL_SIZE / 2,
+                     CELL_SIZE / 2 - 1,
+                     0, G_PI * 2);
+          cairo_fill (cr);
+        }
+    }
+
+  return TRUE;
+}
+
+static void
+on_paint (ClutterActor *stage,
+          gpointer      data)
+{
+  ClutterContent *canvas = data;
+  gdouble elapsed;
+
+  n_frames += 1;
+
+  elapsed = g_timer_elapsed (timer, NULL);
+  if (elapsed >= duration)
+    {
+      printf ("%-22s: %8.2f frames/sec, %8.2f draws/sec\n",
+              mode_names[mode],
+              n_frames / elapsed,
+              g_atomic_int_get (&n_draws) / elapsed);
+
+      mode += 1;
+      if (mode == N_MODES)
+        {
+          clutter_main_quit ();
+          return;
+        }
+
+      g_timer_start (timer);
+      n_frames = 0;
+      g_atomic_int_set (&n_draws, 0);
+    }
+
+  /* invalidate the canvas for the next frame */
+  switch (mode)
+    {
+    case MODE_STATIC:
+      break;
+
+    case MODE_FULL:
+      clutter_content_invalidate (canvas);
+      break;
+
+    case MODE_PARTIAL:
+      {
+        cairo_rectangle_int_t rect;
+        gint n_cols = CANVAS_SIZE / DAMAGE_SIZE;
+
+        rect.x = (damage_pos % n_cols) * DAMAGE_SIZE;
+        rect.y = ((damage_pos / n_cols) % n_cols) * DAMAGE_SIZE;
+        rect.width = DAMAGE_SIZE;
+        rect.height = DAMAGE_SIZE;
+
+        clutter_canvas_invalidate_rectangle (CLUTTER_CANVAS (canvas), &rect);
+
+        damage_pos += 1;
+      }
+      break;
+
+    default:
+      g_assert_not_reached ();
+    }
+}
+
+static gboolean
+queue_redraw (gpointer stage)
+{
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
+
+  return TRUE;
+}
+
+int
+main (int argc, char **argv)
+{
+  ClutterActor *stage, *actor;
+  ClutterContent *canvas;
+  GError *error = NULL;
+
+  g_setenv ("CLUTTER_VBLANK", "none", FALSE);
+  g_setenv ("CLUTTER_DEFAULT_FPS", "1000", FALSE);
+
+  if (clutter_init_with_args (&argc, &argv,
+                              NULL,
+                              entries,
+                              NULL,
+                              &error) != CLUTTER_INIT_SUCCESS)
+    return 1;
+
+  stage = clutter_stage_new ();
+  clutter_actor_set_size (stage, CANVAS_SIZE, CANVAS_SIZE);
+  clutter_stage_set_title (CLUTTER_STAGE (stage), "Canvas");
+
+  canvas = clutter_canvas_new ();
+  clutter_canvas_set_size (CLUTTER_CANVAS (canvas), CANVAS_SIZE, CANVAS_SIZE);
+  clutter_canvas_set_draw_async (CLUTTER_CANVAS (canvas), draw_async);
+  g_signal_connect (canvas, "draw", G_CALLBACK (draw_cb), NULL);
+
+  actor = clutter_actor_new ();
+  clutter_actor_set_size (actor, CANVAS_SIZE, CANVAS_SIZE);
+  clutter_actor_set_content (actor, canvas);
+  clutter_actor_add_child (stage, actor);
+
+  /* the initial draw */
+  clutter_content_invalidate (canvas);
+
+  printf ("Canvas test with a %dx%d canvas, %dx%d damaged area (%s)\n",
+          CANVAS_SIZE, CANVAS_SIZE,
+          DAMAGE_SIZE, DAMAGE_SIZE,
+          draw_async ? "asynchronous" : "synchronous");
+
+  g_signal_connect_after (stage, "paint", G_CALLBACK (on_paint), canvas);
+
+  clutter_actor_show (stage);
+
+  timer = g_timer_new ();
+
+  clutter_threads_add_idle (queue_redraw, stage);
+
+  clutter_main ();
+
+  clutter_actor_destroy (stage);
+  g_object_unref (canvas);
+
+  g_timer_destroy (timer);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,263 @@
+#include <stdlib.h>
+#include <string.h>
+#include <clutter/clutter.h>
+
+/* Measures the throughput of the deformation of the grid of vertices of
+ * the deform effects, in vertices per second: first by calling the
+ * per-vertex and the batched virtual functions directly, then by painting
+ * an actor with the effect and invalidating it on every frame, which also
+ * includes splitting large grids across threads and submitting them.
+ */
+
+#define WIDTH           512
+#define HEIGHT          512
+
+#define N_ITERATIONS    50
+#define N_FRAMES        100
+
+static const guint tiles[] = { 32, 128, 255 };
+
+typedef struct {
+  guint n_vertices;
+
+  gfloat *pristine;
+  gfloat *coords;
+  guint8 *colors;
+
+  ClutterDeformVertices vertices;
+} Grid;
+
+static void
+grid_init (Grid  *grid,
+           guint  n_tiles)
+{
+  guint i, j, n;
+
+  n = grid->n_vertices = (n_tiles + 1) * (n_tiles + 1);
+
+  grid->pristine = g_new (gfloat, n * 5);
+  grid->coords = g_new (gfloat, n * 5);
+  grid->colors = g_new (guint8, n * 4);
+
+  for (i = 0; i < n_tiles + 1; i++)
+    {
+      for (j = 0; j < n_tiles + 1; j++)
+        {
+          guint k = i * (n_tiles + 1) + j;
+          gfloat tx = (gfloat) j / n_tiles;
+          gfloat ty = (gfloat) i / n_tiles;
+
+          grid->pristine[k] = WIDTH * tx;
+          grid->pristine[n + k] = HEIGHT * ty;
+          grid->pristine[n * 2 + k] = 0.0f;
+          grid->pristine[n * 3 + k] = tx;
+          grid->pristine[n * 4 + k] = ty;
+        }
+    }
+
+  grid->vertices.n_vertices = n;
+  grid->vertices.x = grid->coords;
+  grid->vertices.y = grid->coords + n;
+  grid->vertices.z = grid->coords + n * 2;
+  grid->vertices.tx = grid->coords + n * 3;
+  grid->vertices.ty = grid->coords + n * 4;
+  grid->vertices.colors = grid->colors;
+}
+
+static void
+grid_reset (Grid *grid)
+{
+  memcpy (grid->coords, grid->pristine, sizeof (gfloat) * grid->n_vertices * 5);
+  memset (grid->colors, 0xff, grid->n_vertices * 4);
+}
+
+static void
+grid_clear (Grid *grid)
+{
+  g_free (grid->pristine);
+  g_free (grid->coords);
+  g_free (grid->colors);
+}
+
+static void
+report (const gchar *effect,
+        const gchar *method,
+        guint        n_tiles,
+        gdouble      n_vertices,
+        gdouble      elapsed)
+{
+  g_print ("%-10s %-10s %3ux%-3u: %8.2f Mvertices/s\n",
+           effect,
+           method,
+           n_tiles, n_tiles,
+           n_vertices / elapsed / 1000000.0);
+}
+
+static void
+run_vfuncs (const gchar   *name,
+            ClutterEffect *effect,
+            gboolean       per_vertex)
+{
+  ClutterDeformEffect *deform = CLUTTER_DEFORM_EFFECT (effect);
+  ClutterDeformEffectClass *klass = CLUTTER_DEFORM_EFFECT_GET_CLASS (deform);
+  GTimer *timer = g_timer_new ();
+  guint t;
+
+  for (t = 0; t < G_N_ELEMENTS (tiles); t++)
+    {
+      Grid grid;
+      gint i;
+
+      grid_init (&grid, tiles[t]);
+
+      /* only for the effects that also implement the per-vertex function */
+      if (per_vertex)
+        {
+          g_timer_start (timer);
+          for (i = 0; i < N_ITERATIONS; i++)
+            {
+              CoglTextureVertex vertex;
+              guint k, n = grid.n_vertices;
+
+              grid_reset (&grid);
+
+              for (k = 0; k < n; k++)
+                {
+                  vertex.x = grid.coords[k];
+                  vertex.y = grid.coords[n + k];
+                  vertex.z = grid.coords[n * 2 + k];
+                  vertex.tx = grid.coords[n * 3 + k];
+                  vertex.ty = grid.coords[n * 4 + k];
+                  cogl_color_init_from_4ub (&vertex.color,
+                                            255, 255, 255, 255);
+
+                  klass->deform_vertex (deform, WIDTH, HEIGHT, &vertex);
+
+                  grid.coords[k] = vertex.x;
+                  grid.coords[n + k] = vertex.y;
+                  grid.coords[n * 2 + k] = vertex.z;
+                }
+            }
+          g_timer_stop (timer);
+
+          report (name, "vertex", tiles[t],
+                  (gdouble) grid.n_vertices * N_ITERATIONS,
+                  g_timer_elapsed (timer, NULL));
+        }
+
+      g_timer_start (timer);
+      for (i = 0; i < N_ITERATIONS; i++)
+        {
+          grid_reset (&grid);
+
+          klass->deform_vertices (deform, WIDTH, HEIGHT, &grid.vertices);
+        }
+      g_timer_stop (timer);
+
+      report (name, "vertices", tiles[t],
+              (gdouble) grid.n_vertices * N_ITERATIONS,
+              g_timer_elapsed (timer, NULL));
+
+      grid_clear (&grid);
+    }
+
+  g_timer_destroy (timer);
+}
+
+static ClutterActor *paint_actor = NULL;
+static ClutterEffect *paint_effect = NULL;
+static GTimer *paint_timer = NULL;
+static gint paint_frames = 0;
+
+static void
+on_paint (ClutterActor *stage)
+{
+  if (paint_frames == 0)
+    g_timer_start (paint_timer);
+
+  paint_frames += 1;
+
+  if (paint_frames > N_FRAMES)
+    {
+      g_timer_stop (paint_timer);
+      clutter_main_quit ();
+      return;
+    }
+
+  /* the whole grid is deformed again on the next frame */
+  clutter_deform_effect_invalidate (CLUTTER_DEFORM_EFFECT (paint_effect));
+}
+
+static void
+run_paint (const gchar   *name,
+           ClutterEffect *effect)
+{
+  guint t;
+
+  for (t = 0; t < G_N_ELEMENTS (tiles); t++)
+    {
+      clutter_deform_effect_set_n_tiles (CLUTTER_DEFORM_EFFECT (effect),
+                                         tiles[t], tiles[t]);
+
+      paint_effect = effect;
+      paint_frames = 0;
+
+      clutter_actor_add_effect (paint_actor, effect);
+      clutter_main ();
+      clutter_actor_remove_effect (paint_actor, effect);
+
+      report (name, "paint", tiles[t],
+              (gdouble) (tiles[t] + 1) * (tiles[t] + 1) * N_FRAMES,
+              g_timer_elapsed (paint_timer, NULL));
+    }
+}
+
+int
+main (int argc, char *argv[])
+{
+  ClutterEffect *page_turn, *bend;
+  ClutterActor *stage;
+  gulong paint_id;
+
+  g_setenv ("CLUTTER_VBLANK", "none", FALSE);
+  g_setenv ("CLUTTER_DEFAULT_FPS", "1000", FALSE);
+
+  if (clutter_init (&argc, &argv) != CLUTTER_INIT_SUCCESS)
+    return EXIT_FAILURE;
+
+  page_turn = clutter_page_turn_effect_new (0.5, 30.0, 24.0f);
+  g_object_ref_sink (page_turn);
+
+  bend = clutter_bend_effect_new (60.0, CLUTTER_ORIENTATION_HORIZONTAL);
+  g_object_ref_sink (bend);
+
+  run_vfuncs ("page-turn", page_turn, TRUE);
+  run_vfuncs ("bend", bend, FALSE);
+
+  stage = clutter_stage_new ();
+  clutter_actor_set_size (stage, WIDTH, HEIGHT);
+
+  paint_actor = clutter_actor_new ();
+  clutter_actor_set_background_color (paint_actor, CLUTTER_COLOR_Orange);
+  clutter_actor_set_size (paint_actor, WIDTH, HEIGHT);
+  clutter_actor_add_child (stage, paint_actor);
+
+  paint_timer = g_timer_new ();
+  paint_id = g_signal_connect_after (stage, "paint",
+                                     G_CALLBACK (on_paint),
+                                     NULL);
+
+  clutter_actor_show (stage);
+
+  run_paint ("page-turn", page_turn);
+  run_paint ("bend", bend);
+
+  g_signal_handler_disconnect (stage, paint_id);
+  g_timer_destroy (paint_timer);
+  clutter_actor_destroy (stage);
+
+  g_object_unref (page_turn);
+  g_object_unref (bend);
+
+  return EXIT_SUCCESS;
+}
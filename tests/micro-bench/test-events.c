@@ -0,0 +1,181 @@
+#include <stdlib.h>
+#include <clutter/clutter.h>
+
+#define N_EVENTS 1000
+
+static gint n_events = N_EVENTS;
+static gint n_sequences = 1;
+static gboolean use_put = FALSE;
+static gboolean throttle = FALSE;
+
+static GOptionEntry entries[] = {
+  {
+    "num-events", 'e',
+    0,
+    G_OPTION_ARG_INT, &n_events,
+    "Number of events per frame", "EVENTS"
+  },
+  {
+    "put", 'p',
+    0,
+    G_OPTION_ARG_NONE, &use_put,
+    "Use clutter_event_put() instead of clutter_do_event()", NULL
+  },
+  {
+    "num-sequences", 's',
+    0,
+    G_OPTION_ARG_INT, &n_sequences,
+    "Number of interleaved touch sequences", "SEQUENCES"
+  },
+  {
+    "throttle", 't',
+    0,
+    G_OPTION_ARG_NONE, &throttle,
+    "Compress the touch updates of each sequence", NULL
+  },
+  { NULL }
+};
+
+static GTimer *timer = NULL;
+static gulong n_pushed = 0;
+static gulong n_handled = 0;
+
+static ClutterInputDevice *device = NULL;
+
+static gboolean
+touch_event_cb (ClutterActor *stage,
+                ClutterEvent *event,
+                gpointer      user_data)
+{
+  n_handled += 1;
+
+  return CLUTTER_EVENT_STOP;
+}
+
+static void
+push_events (ClutterActor *stage)
+{
+  static gfloat x = 0;
+  gint i;
+
+  /* unless --throttle is used, touch updates are not compressed,
+   * so each one of them will go through the whole event processing
+   */
+  for (i = 0; i < n_events; i++)
+    {
+      ClutterEvent *event;
+
+      if (i % n_sequences == 0)
+        x += 1.0f;
+
+      if (x >= 512.0f)
+        x = 0.0f;
+
+      event = clutter_event_new (CLUTTER_TOUCH_UPDATE);
+      event->touch.stage = CLUTTER_STAGE (stage);
+      event->touch.source = stage;
+      event->touch.time = i;
+      event->touch.x = x;
+      event->touch.y = 256.0f;
+      event->touch.sequence = GINT_TO_POINTER ((i % n_sequences) + 1);
+      clutter_event_set_device (event, device);
+
+      if (use_put)
+        clutter_event_put (event);
+      else
+        clutter_do_event (event);
+
+      clutter_event_free (event);
+    }
+
+  n_pushed += n_events;
+}
+
+static void
+on_paint (ClutterActor *stage, gconstpointer *data)
+{
+  gdouble elapsed;
+
+  /* the events pushed during the previous frame have been
+   * processed before painting this one
+   */
+  elapsed = g_timer_elapsed (timer, NULL);
+  if (elapsed >= 1.0)
+    {
+      printf ("%.2f events/sec pushed, %.2f events/sec delivered\n",
+              n_pushed / elapsed,
+              n_handled / elapsed);
+
+      g_timer_start (timer);
+      n_pushed = 0;
+      n_handled = 0;
+    }
+
+  push_events (stage);
+}
+
+static gboolean
+queue_redraw (gpointer stage)
+{
+  clutter_actor_queue_redraw (CLUTTER_ACTOR (stage));
+
+  return TRUE;
+}
+
+int
+main (int argc, char **argv)
+{
+  ClutterActor *stage;
+  ClutterDeviceManager *manager;
+  GError *error = NULL;
+
+  g_setenv ("CLUTTER_VBLANK", "none", FALSE);
+  g_setenv ("CLUTTER_DEFAULT_FPS", "1000", FALSE);
+
+  if (clutter_init_with_args (&argc, &argv,
+                              NULL,
+                              entries,
+                              NULL,
+                              &error) != CLUTTER_INIT_SUCCESS)
+    return 1;
+
+  manager = clutter_device_manager_get_default ();
+  device = clutter_device_manager_get_core_device (manager,
+                                                   CLUTTER_POINTER_DEVICE);
+  if (device == NULL)
+    {
+      g_printerr ("No core pointer device available\n");
+      return EXIT_FAILURE;
+    }
+
+  stage = clutter_stage_new ();
+  clutter_actor_set_size (stage, 512, 512);
+  clutter_stage_set_title (CLUTTER_STAGE (stage), "Events");
+  clutter_stage_set_motion_events_enabled (CLUTTER_STAGE (stage), FALSE);
+  clutter_stage_set_throttle_motion_events (CLUTTER_STAGE (stage), throttle);
+
+  n_sequences = MAX (n_sequences, 1);
+
+  printf ("Event throughput test with %d events per frame "
+          "from %d touch sequences (%s)\n",
+          n_events,
+          n_sequences,
+          use_put ? "clutter_event_put" : "clutter_do_event");
+
+  g_signal_connect (stage, "touch-event", G_CALLBACK (touch_event_cb), NULL);
+  g_signal_connect (stage, "paint", G_CALLBACK (on_paint), NULL);
+
+  clutter_actor_show (stage);
+
+  timer = g_timer_new ();
+
+  clutter_threads_add_idle (queue_redraw, stage);
+
+  clutter_main ();
+
+  clutter_actor_destroy (stage);
+
+  g_timer_destroy (timer);
+
+  return EXIT_SUCCESS;
+}
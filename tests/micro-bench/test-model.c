@@ -0,0 +1,146 @@
+#include <stdlib.h>
+#include <string.h>
+#include <clutter/clutter.h>
+
+/* Measures the cost of looking up, counting and iterating the rows of
+ * a filtered ClutterListModel, and of changing the rows while the
+ * filter is in place, at various sizes of the model
+ */
+
+#define N_OPERATIONS    10000
+
+static const guint sizes[] = {
+  10000,
+  100000,
+  1000000,
+};
+
+enum
+{
+  COLUMN_VALUE,
+  COLUMN_LABEL,
+
+  N_COLUMNS
+};
+
+static gboolean
+filter_odd_rows (ClutterModel     *model,
+                 ClutterModelIter *iter,
+                 gpointer          dummy G_GNUC_UNUSED)
+{
+  gint value;
+
+  clutter_model_iter_get (iter, COLUMN_VALUE, &value, -1);
+
+  return (value % 2) != 0;
+}
+
+static void
+report (const gchar *operation,
+        guint        size,
+        guint        n_operations,
+        GTimer      *timer)
+{
+  g_print ("%-12s %8u rows: %10.3f us/op\n",
+           operation,
+           size,
+           g_timer_elapsed (timer, NULL) * 1000000.0 / n_operations);
+}
+
+static void
+run_benchmark (guint size)
+{
+  ClutterModel *model;
+  ClutterModelIter *iter;
+  GTimer *timer;
+  guint n_rows, i;
+
+  model = clutter_list_model_new (N_COLUMNS,
+                                  G_TYPE_INT, "Value",
+                                  G_TYPE_STRING, "Label");
+
+  timer = g_timer_new ();
+
+  g_timer_start (timer);
+  for (i = 0; i < size; i++)
+    clutter_model_append (model,
+                          COLUMN_VALUE, i,
+                          COLUMN_LABEL, "row",
+                          -1);
+  g_timer_stop (timer);
+  report ("append", size, size, timer);
+
+  /* the first look up after setting the filter goes through every row */
+  g_timer_start (timer);
+  clutter_model_set_filter (model, filter_odd_rows, NULL, NULL);
+  n_rows = clutter_model_get_n_rows (model);
+  g_timer_stop (timer);
+  report ("set-filter", size, 1, timer);
+
+  g_assert_cmpuint (n_rows, ==, size / 2);
+
+  g_timer_start (timer);
+  for (i = 0; i < N_OPERATIONS; i++)
+    clutter_model_get_n_rows (model);
+  g_timer_stop (timer);
+  report ("n-rows", size, N_OPERATIONS, timer);
+
+  g_timer_start (timer);
+  for (i = 0; i < N_OPERATIONS; i++)
+    {
+      iter = clutter_model_get_iter_at_row (model,
+                                            g_random_int_range (0, n_rows));
+      g_object_unref (iter);
+    }
+  g_timer_stop (timer);
+  report ("iter-at-row", size, N_OPERATIONS, timer);
+
+  g_timer_start (timer);
+  iter = clutter_model_get_first_iter (model);
+  while (!clutter_model_iter_is_last (iter))
+    iter = clutter_model_iter_next (iter);
+  g_object_unref (iter);
+  g_timer_stop (timer);
+  report ("iterate", size, n_rows, timer);
+
+  /* every change hides or shows a row, and is followed by a look up */
+  g_timer_start (timer);
+  for (i = 0; i < N_OPERATIONS; i++)
+    {
+      iter = clutter_model_get_iter_at_row (model,
+                                            g_random_int_range (0, n_rows));
+      clutter_model_iter_set (iter, COLUMN_VALUE, g_random_int (), -1);
+      g_object_unref (iter);
+
+      n_rows = clutter_model_get_n_rows (model);
+    }
+  g_timer_stop (timer);
+  report ("change", size, N_OPERATIONS, timer);
+
+  g_timer_start (timer);
+  for (i = 0; i < N_OPERATIONS && n_rows > 0; i++)
+    {
+      clutter_model_remove (model, g_random_int_range (0, n_rows));
+
+      n_rows = clutter_model_get_n_rows (model);
+    }
+  g_timer_stop (timer);
+  report ("remove", size, i, timer);
+
+  g_timer_destroy (timer);
+  g_object_unref (model);
+}
+
+int
+main (int argc, char *argv[])
+{
+  guint i;
+
+  if (clutter_init (&argc, &argv) != CLUTTER_INIT_SUCCESS)
+    return EXIT_FAILURE;
+
+  for (i = 0; i < G_N_ELEMENTS (sizes); i++)
+    run_benchmark (sizes[i]);
+
+  return EXIT_SUCCESS;
+}
@@ -1,13 +1,27 @@
 
 #include <math.h>
 #include <stdlib.h>
+
+#define CLUTTER_ENABLE_EXPERIMENTAL_API
 #include <clutter/clutter.h>
 
-#define N_ACTORS 100
 #define N_EVENTS 5
+#define N_FRAMES 100
+
+/* the numbers of actors used when --num-actors is not given */
+static const gint sizes[] = {
+  1000,
+  10000,
+  100000,
+};
 
-static gint n_actors = N_ACTORS;
+static gint n_actors = 0;
 static gint n_events = N_EVENTS;
+static gboolean use_geometric = FALSE;
+
+static GTimer *pick_timer = NULL;
+static gulong n_picks = 0;
+static gint n_frames = 0;
 
 static GOptionEntry entries[] = {
   {
@@ -22,6 +36,12 @@ static GOptionEntry entries[] = {
     G_OPTION_ARG_INT, &n_events,
     "Number of events", "EVENTS"
   },
+  {
+    "geometric", 'g',
+    0,
+    G_OPTION_ARG_NONE, &use_geometric,
+    "Use geometric picking", NULL
+  },
   { NULL }
 };
 
@@ -32,14 +52,17 @@ motion_event_cb (ClutterActor *actor, ClutterEvent *event, gpointer user_data)
 }
 
 static void
-do_events (ClutterActor *stage)
+do_events (ClutterActor *stage,
+           gint          n_stage_actors)
 {
   glong i;
   static gdouble angle = 0;
 
+  g_timer_continue (pick_timer);
+
   for (i = 0; i < n_events; i++)
     {
-      angle += (2.0 * G_PI) / (gdouble)n_actors;
+      angle += (2.0 * G_PI) / (gdouble)n_stage_actors;
       while (angle > G_PI * 2.0)
         angle -= G_PI * 2.0;
 
@@ -51,12 +74,29 @@ do_events (ClutterActor *stage)
 				      256.0 + 206.0 * cos (angle),
 				      256.0 + 206.0 * sin (angle));
     }
+
+  g_timer_stop (pick_timer);
+
+  n_picks += n_events;
 }
 
 static void
-on_paint (ClutterActor *stage, gconstpointer *data)
+on_paint (ClutterActor *stage, gpointer data)
 {
-  do_events (stage);
+  gint n_stage_actors = GPOINTER_TO_INT (data);
+
+  do_events (stage, n_stage_actors);
+
+  /* report the pick rate once enough frames have been picked */
+  n_frames += 1;
+  if (n_frames == N_FRAMES)
+    {
+      printf ("%6d actors: %.2f picks/sec\n",
+              n_stage_actors,
+              n_picks / g_timer_elapsed (pick_timer, NULL));
+
+      clutter_main_quit ();
+    }
 }
 
 static gboolean
@@ -67,48 +107,38 @@ queue_redraw (gpointer stage)
   return TRUE;
 }
 
-int
-main (int argc, char **argv)
+static void
+run_benchmark (gint n_stage_actors)
 {
   glong i;
   gdouble angle;
   ClutterColor color = { 0x00, 0x00, 0x00, 0xff };
   ClutterActor *stage, *rect;
-  GError *error = NULL;
-
-  g_setenv ("CLUTTER_VBLANK", "none", FALSE);
-  g_setenv ("CLUTTER_DEFAULT_FPS", "1000", FALSE);
-  g_setenv ("CLUTTER_SHOW_FPS", "1", FALSE);
-
-  if (clutter_init_with_args (&argc, &argv,
-                              NULL,
-                              entries,
-                              NULL,
-                              &error) != CLUTTER_INIT_SUCCESS)
-    return 1;
+  guint repaint_id;
 
   stage = clutter_stage_new ();
   clutter_actor_set_size (stage, 512, 512);
   clutter_stage_set_color (CLUTTER_STAGE (stage), CLUTTER_COLOR_Black);
   clutter_stage_set_title (CLUTTER_STAGE (stage), "Picking");
+  clutter_stage_set_geometric_picking (CLUTTER_STAGE (stage), use_geometric);
 
-  printf ("Picking performance test with "
-          "%d actors and %d events per frame\n",
-          n_actors,
-          n_events);
+  g_timer_start (pick_timer);
+  g_timer_stop (pick_timer);
+  n_picks = 0;
+  n_frames = 0;
 
-  for (i = n_actors - 1; i >= 0; i--)
+  for (i = n_stage_actors - 1; i >= 0; i--)
     {
-      angle = ((2.0 * G_PI) / (gdouble) n_actors) * i;
+      angle = ((2.0 * G_PI) / (gdouble) n_stage_actors) * i;
 
-      color.red = (1.0 - ABS ((MAX (0, MIN (n_actors/2.0 + 0, i))) /
-                  (gdouble)(n_actors/4.0) - 1.0)) * 255.0;
-      color.green = (1.0 - ABS ((MAX (0, MIN (n_actors/2.0 + 0,
-                    fmod (i + (n_actors/3.0)*2, n_actors)))) /
-                    (gdouble)(n_actors/4) - 1.0)) * 255.0;
-      color.blue = (1.0 - ABS ((MAX (0, MIN (n_actors/2.0 + 0,
-                   fmod ((i + (n_actors/3.0)), n_actors)))) /
-                   (gdouble)(n_actors/4.0) - 1.0)) * 255.0;
+      color.red = (1.0 - ABS ((MAX (0, MIN (n_stage_actors/2.0 + 0, i))) /
+                  (gdouble)(n_stage_actors/4.0) - 1.0)) * 255.0;
+      color.green = (1.0 - ABS ((MAX (0, MIN (n_stage_actors/2.0 + 0,
+                    fmod (i + (n_stage_actors/3.0)*2, n_stage_actors)))) /
+                    (gdouble)(n_stage_actors/4) - 1.0)) * 255.0;
+      color.blue = (1.0 - ABS ((MAX (0, MIN (n_stage_actors/2.0 + 0,
+                   fmod ((i + (n_stage_actors/3.0)), n_stage_actors)))) /
+                   (gdouble)(n_stage_actors/4.0) - 1.0)) * 255.0;
 
       rect = clutter_rectangle_new_with_color (&color);
       clutter_actor_set_size (rect, 100, 100);
@@ -126,15 +156,53 @@ main (int argc, char **argv)
 
   clutter_actor_show (stage);
 
-  clutter_threads_add_idle (queue_redraw, stage);
+  repaint_id = clutter_threads_add_idle (queue_redraw, stage);
 
-  g_signal_connect (stage, "paint", G_CALLBACK (on_paint), NULL);
+  g_signal_connect (stage, "paint",
+                    G_CALLBACK (on_paint),
+                    GINT_TO_POINTER (n_stage_actors));
 
   clutter_main ();
 
+  g_source_remove (repaint_id);
   clutter_actor_destroy (stage);
-
-  return 0;
 }
 
+int
+main (int argc, char **argv)
+{
+  GError *error = NULL;
+  guint i;
+
+  g_setenv ("CLUTTER_VBLANK", "none", FALSE);
+  g_setenv ("CLUTTER_DEFAULT_FPS", "1000", FALSE);
+  g_setenv ("CLUTTER_SHOW_FPS", "1", FALSE);
+
+  if (clutter_init_with_args (&argc, &argv,
+                              NULL,
+                              entries,
+                              NULL,
+                              &error) != CLUTTER_INIT_SUCCESS)
+    return 1;
+
+  printf ("Picking performance test with "
+          "%d events per frame over %d frames (%s picking)\n",
+          n_events,
+          N_FRAMES,
+          use_geometric ? "geometric" : "GL");
+
+  pick_timer = g_timer_new ();
+  g_timer_stop (pick_timer);
+
+  if (n_actors > 0)
+    run_benchmark (n_actors);
+  else
+    {
+      for (i = 0; i < G_N_ELEMENTS (sizes); i++)
+        run_benchmark (sizes[i]);
+    }
 
+  g_timer_destroy (pick_timer);
+
+  return 0;
+}
@@ -0,0 +1,166 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <glib/gstdio.h>
+#include <clutter/clutter.h>
+
+/* Compares the cost of loading a large UI definition from its JSON form
+ * and from its compiled form, and the cost of building its objects
+ */
+
+static const guint sizes[] = {
+  100,
+  1000,
+  10000,
+};
+
+static gchar *
+generate_definition (guint n_actors)
+{
+  GString *json = g_string_new (NULL);
+  guint i;
+
+  g_string_append (json,
+                   "{\n"
+                   "  \"type\" : \"ClutterActor\",\n"
+                   "  \"id\" : \"root\",\n"
+                   "  \"children\" : [\n");
+
+  for (i = 0; i < n_actors; i++)
+    {
+      g_string_append_printf (json,
+                              "    {\n"
+                              "      \"type\" : \"ClutterText\",\n"
+                              "      \"id\" : \"label-%u\",\n"
+                              "      \"x\" : %u.0,\n"
+                              "      \"y\" : %u.0,\n"
+                              "      \"width\" : 200.0,\n"
+                              "      \"height\" : 20.0,\n"
+                              "      \"text\" : \"Label %u\",\n"
+                              "      \"color\" : \"#ff0000\",\n"
+                              "      \"reactive\" : true\n"
+                              "    }%s\n",
+                              i,
+                              (i % 10) * 200,
+                              (i / 10) * 20,
+                              i,
+                              i == n_actors - 1 ? "" : ",");
+    }
+
+  g_string_append (json, "  ]\n}\n");
+
+  return g_string_free (json, FALSE);
+}
+
+static void
+report (const gchar *operation,
+        guint        size,
+        GTimer      *timer)
+{
+  g_print ("%-16s %6u actors: %10.3f ms\n",
+           operation,
+           size,
+           g_timer_elapsed (timer, NULL) * 1000.0);
+}
+
+static void
+run_benchmark (guint n_actors)
+{
+  ClutterScript *script;
+  GError *error = NULL;
+  GBytes *compiled;
+  GTimer *timer;
+  gchar *json, *filename;
+  gchar *id_;
+  gint fd;
+
+  json = generate_definition (n_actors);
+  timer = g_timer_new ();
+
+  /* the JSON definition is parsed and every object is built */
+  script = clutter_script_new ();
+  g_timer_start (timer);
+  clutter_script_load_from_data (script, json, -1, &error);
+  g_timer_stop (timer);
+  g_assert_no_error (error);
+  report ("json load", n_actors, timer);
+  g_object_unref (script);
+
+  g_timer_start (timer);
+  compiled = clutter_script_compile_data (json, -1, &error);
+  g_timer_stop (timer);
+  g_assert_no_error (error);
+  report ("compile", n_actors, timer);
+
+  g_print ("%-16s %6u actors: %10" G_GSIZE_FORMAT " bytes (json: %"
+           G_GSIZE_FORMAT " bytes)\n",
+           "compiled size",
+           n_actors,
+           g_bytes_get_size (compiled),
+           strlen (json));
+
+  /* loading the compiled definition does not build any object */
+  script = clutter_script_new ();
+  g_timer_start (timer);
+  clutter_script_load_from_data (script,
+                                 g_bytes_get_data (compiled, NULL),
+                                 g_bytes_get_size (compiled),
+                                 &error);
+  g_timer_stop (timer);
+  g_assert_no_error (error);
+  report ("compiled load", n_actors, timer);
+
+  /* the first object is built on demand, alone */
+  id_ = g_strdup_printf ("label-%u", n_actors / 2);
+  g_timer_start (timer);
+  g_assert (CLUTTER_IS_TEXT (clutter_script_get_object (script, id_)));
+  g_timer_stop (timer);
+  report ("get_object", n_actors, timer);
+  g_free (id_);
+
+  g_timer_start (timer);
+  clutter_script_ensure_objects (script);
+  g_timer_stop (timer);
+  report ("ensure_objects", n_actors, timer);
+  g_object_unref (script);
+
+  /* the compiled definition is used directly from the mapped file */
+  fd = g_file_open_tmp ("test-script-load-XXXXXX", &filename, &error);
+  g_assert_no_error (error);
+  close (fd);
+
+  g_file_set_contents (filename,
+                       g_bytes_get_data (compiled, NULL),
+                       g_bytes_get_size (compiled),
+                       &error);
+  g_assert_no_error (error);
+
+  script = clutter_script_new ();
+  g_timer_start (timer);
+  clutter_script_load_from_file (script, filename, &error);
+  g_timer_stop (timer);
+  g_assert_no_error (error);
+  report ("mapped load", n_actors, timer);
+  g_object_unref (script);
+
+  g_unlink (filename);
+  g_free (filename);
+
+  g_bytes_unref (compiled);
+  g_timer_destroy (timer);
+  g_free (json);
+}
+
+int
+main (int argc, char *argv[])
+{
+  guint i;
+
+  if (clutter_init (&argc, &argv) != CLUTTER_INIT_SUCCESS)
+    return EXIT_FAILURE;
+
+  for (i = 0; i < G_N_ELEMENTS (sizes); i++)
+    run_benchmark (sizes[i]);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,121 @@
+#include <stdlib.h>
+#include <string.h>
+#include <clutter/clutter.h>
+
+/* Measures the cost of editing a ClutterTextBuffer, and of moving the
+ * cursor of a ClutterText using it, at various sizes of the text
+ */
+
+#define N_OPERATIONS    10000
+
+/* mixes characters of one, two and three bytes */
+static const gchar filler[] = "Lorem ipsum \xc3\xa9t\xc3\xa9 \xe2\x82\xac dolor sit amet\n";
+
+static const gsize sizes[] = {
+  1024,                 /* 1 KB */
+  100 * 1024,           /* 100 KB */
+  10 * 1024 * 1024,     /* 10 MB */
+};
+
+static ClutterTextBuffer *
+create_buffer (gsize size)
+{
+  ClutterTextBuffer *buffer;
+  GString *text;
+
+  text = g_string_sized_new (size + sizeof (filler));
+  while (text->len < size)
+    g_string_append (text, filler);
+
+  buffer = clutter_text_buffer_new ();
+  clutter_text_buffer_insert_text (buffer, 0, text->str, -1);
+
+  g_string_free (text, TRUE);
+
+  return buffer;
+}
+
+static void
+report (const gchar *operation,
+        gsize        size,
+        GTimer      *timer)
+{
+  g_print ("%-12s %8" G_GSIZE_FORMAT " KB: %8.3f us/op\n",
+           operation,
+           size / 1024,
+           g_timer_elapsed (timer, NULL) * 1000000.0 / N_OPERATIONS);
+}
+
+static void
+run_benchmark (gsize size)
+{
+  ClutterTextBuffer *buffer;
+  ClutterActor *text;
+  GTimer *timer;
+  guint length;
+  gint i;
+
+  buffer = create_buffer (size);
+  length = clutter_text_buffer_get_length (buffer);
+  timer = g_timer_new ();
+
+  g_timer_start (timer);
+  for (i = 0; i < N_OPERATIONS; i++)
+    {
+      guint position = g_random_int_range (0, length + 1);
+
+      clutter_text_buffer_insert_text (buffer, position, "\xc3\xa9", 1);
+      length += 1;
+    }
+  g_timer_stop (timer);
+  report ("insert", size, timer);
+
+  g_timer_start (timer);
+  for (i = 0; i < N_OPERATIONS; i++)
+    {
+      guint position = g_random_int_range (0, length);
+
+      clutter_text_buffer_delete_text (buffer, position, 1);
+      length -= 1;
+    }
+  g_timer_stop (timer);
+  report ("delete", size, timer);
+
+  /* reading the characters around the cursor, as an input method would
+   * do after each cursor movement
+   */
+  text = clutter_text_new_with_buffer (buffer);
+
+  g_timer_start (timer);
+  for (i = 0; i < N_OPERATIONS; i++)
+    {
+      gint position = g_random_int_range (0, length);
+      gchar *chars;
+
+      clutter_text_set_cursor_position (CLUTTER_TEXT (text), position);
+      chars = clutter_text_get_chars (CLUTTER_TEXT (text),
+                                      position,
+                                      position + 1);
+      g_free (chars);
+    }
+  g_timer_stop (timer);
+  report ("cursor move", size, timer);
+
+  clutter_actor_destroy (text);
+  g_object_unref (buffer);
+  g_timer_destroy (timer);
+}
+
+int
+main (int argc, char *argv[])
+{
+  guint i;
+
+  if (clutter_init (&argc, &argv) != CLUTTER_INIT_SUCCESS)
+    return 1;
+
+  for (i = 0; i < G_N_ELEMENTS (sizes); i++)
+    run_benchmark (sizes[i]);
+
+  return 0;
+}
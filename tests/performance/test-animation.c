@@ -0,0 +1,141 @@
+#include <stdlib.h>
+#include <clutter/clutter.h>
+#include "test-common.h"
+
+/* A few thousand actors continuously animating their opacity, their
+ * translation and their scale with implicit transitions; the time spent
+ * advancing the timelines is measured from a timeline that is started
+ * before all the transitions, and thus is advanced first, to the
+ * pre-paint repaint function.
+ */
+
+#define STAGE_WIDTH     800
+#define STAGE_HEIGHT    600
+
+#define DEFAULT_N_ACTORS        2000
+
+#define ACTOR_SIZE      16
+
+static GTimer *advance_timer = NULL;
+static gdouble advance_time = 0.0;
+static gint n_advances = 0;
+static gboolean advancing = FALSE;
+
+static void
+animate_actor (ClutterActor *actor)
+{
+  clutter_actor_save_easing_state (actor);
+  clutter_actor_set_easing_mode (actor, CLUTTER_EASE_IN_OUT_QUAD);
+  clutter_actor_set_easing_duration (actor, g_random_int_range (500, 1500));
+
+  clutter_actor_set_opacity (actor, g_random_int_range (64, 256));
+  clutter_actor_set_translation (actor,
+                                 g_random_double_range (-50.0, 50.0),
+                                 g_random_double_range (-50.0, 50.0),
+                                 0.0);
+  clutter_actor_set_scale (actor,
+                           g_random_double_range (0.5, 2.0),
+                           g_random_double_range (0.5, 2.0));
+
+  clutter_actor_restore_easing_state (actor);
+}
+
+static void
+on_transitions_completed (ClutterActor *actor)
+{
+  animate_actor (actor);
+}
+
+static void
+on_new_frame (ClutterTimeline *timeline,
+              gint             msecs)
+{
+  g_timer_start (advance_timer);
+  advancing = TRUE;
+}
+
+static gboolean
+pre_paint_cb (gpointer data)
+{
+  if (advancing)
+    {
+      advance_time += g_timer_elapsed (advance_timer, NULL);
+      n_advances += 1;
+      advancing = FALSE;
+    }
+
+  return G_SOURCE_CONTINUE;
+}
+
+gint
+main (gint    argc,
+      gchar **argv)
+{
+  ClutterTimeline *clock;
+  ClutterActor *stage;
+  gint i, n_actors;
+
+  clutter_perf_fps_init ();
+  if (CLUTTER_INIT_SUCCESS != clutter_init (&argc, &argv))
+    g_error ("Failed to initialize Clutter");
+
+  n_actors = argc > 1 ? atoi (argv[1]) : DEFAULT_N_ACTORS;
+  if (n_actors <= 0)
+    n_actors = DEFAULT_N_ACTORS;
+
+  stage = clutter_stage_new ();
+  clutter_stage_set_color (CLUTTER_STAGE (stage), CLUTTER_COLOR_Black);
+  clutter_stage_set_title (CLUTTER_STAGE (stage), "Animation Performance");
+  clutter_actor_set_size (stage, STAGE_WIDTH, STAGE_HEIGHT);
+
+  advance_timer = g_timer_new ();
+
+  /* the timelines are advanced in the order they were started */
+  clock = clutter_timeline_new (1000);
+  clutter_timeline_set_repeat_count (clock, -1);
+  g_signal_connect (clock, "new-frame", G_CALLBACK (on_new_frame), NULL);
+  clutter_timeline_start (clock);
+
+  clutter_threads_add_repaint_func_full (CLUTTER_REPAINT_FLAGS_PRE_PAINT,
+                                         pre_paint_cb,
+                                         NULL, NULL);
+
+  for (i = 0; i < n_actors; i++)
+    {
+      ClutterActor *actor = clutter_actor_new ();
+      ClutterColor color = { 0, 0, 0, 0xff };
+
+      color.red = g_random_int_range (0, 256);
+      color.green = g_random_int_range (0, 256);
+      color.blue = g_random_int_range (0, 256);
+
+      clutter_actor_set_background_color (actor, &color);
+      clutter_actor_set_size (actor, ACTOR_SIZE, ACTOR_SIZE);
+      clutter_actor_set_pivot_point (actor, 0.5, 0.5);
+      clutter_actor_set_position (actor,
+                                  g_random_int_range (0, STAGE_WIDTH - ACTOR_SIZE),
+                                  g_random_int_range (0, STAGE_HEIGHT - ACTOR_SIZE));
+      clutter_actor_add_child (stage, actor);
+
+      g_signal_connect (actor, "transitions-completed",
+                        G_CALLBACK (on_transitions_completed),
+                        NULL);
+
+      animate_actor (actor);
+    }
+
+  clutter_actor_show (stage);
+
+  clutter_perf_fps_start (CLUTTER_STAGE (stage));
+  clutter_main ();
+  clutter_perf_fps_report ("animation");
+
+  g_print ("@ timeline advance time: %.2f us\n",
+           n_advances > 0 ? 1000000.0 * advance_time / n_advances : 0.0);
+
+  g_object_unref (clock);
+  g_timer_destroy (advance_timer);
+  clutter_actor_destroy (stage);
+
+  return 0;
+}
@@ -1,4 +1,5 @@
 #include <stdlib.h>
+#include <string.h>
 #include <glib.h>
 #include <clutter/clutter.h>
 
@@ -43,6 +44,52 @@ void clutter_perf_fps_report (const gchar *id)
        id, testframes / g_timer_elapsed (testtimer, NULL));
 }
 
+/* run the test again, passing --baseline and setting CLUTTER_PAINT to
+ * paint_flags, and retrieve the values of the "@ id: value" lines it
+ * prints for each id in the NULL-terminated ids list
+ */
+gboolean clutter_perf_run_baseline (const gchar        *argv0,
+                                    const gchar        *paint_flags,
+                                    const gchar *const *ids,
+                                    gdouble            *values)
+{
+  gchar *argv[] = { (gchar *) argv0, "--baseline", NULL };
+  gchar **envp, *output = NULL;
+  gboolean res = FALSE;
+  gint i, status;
+
+  envp = g_get_environ ();
+  envp = g_environ_setenv (envp, "CLUTTER_PAINT", paint_flags, TRUE);
+
+  if (!g_spawn_sync (NULL, argv, envp, 0, NULL, NULL,
+                     &output, NULL,
+                     &status,
+                     NULL))
+    goto out;
+
+  for (i = 0; ids[i] != NULL; i++)
+    {
+      gchar *prefix = g_strdup_printf ("@ %s: ", ids[i]);
+      gchar *line = strstr (output, prefix);
+
+      if (line != NULL)
+        values[i] = g_ascii_strtod (line + strlen (prefix), NULL);
+
+      g_free (prefix);
+
+      if (line == NULL)
+        goto out;
+    }
+
+  res = TRUE;
+
+out:
+  g_strfreev (envp);
+  g_free (output);
+
+  return res;
+}
+
 static void perf_stage_paint_cb (ClutterStage *stage, gpointer *data)
 {
   if (!testtimer)
@@ -0,0 +1,503 @@
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <glib.h>
+#include <clutter/clutter.h>
+
+#ifdef CLUTTER_INPUT_EVDEV
+#include <linux/input.h>
+#include <clutter/evdev/clutter-evdev.h>
+#endif
+
+/* Replays a trace of pointer positions with its original timing, and
+ * measures the time between the injection of each position and the
+ * moment it is handled by an actor, and the end of the first frame
+ * painted after it has been handled.
+ *
+ * The trace is either generated, with a sample every 8ms like most
+ * touch screens, or loaded from a text file with one sample per line:
+ *
+ *   <time in microseconds> <x> <y>
+ *
+ * The positions are injected with clutter_event_put(), or, when using
+ * the evdev input backend and --evdev is passed, written to a pipe
+ * read by a replay device as ABS_X/ABS_Y events.
+ */
+
+#define STAGE_WIDTH     520
+#define STAGE_HEIGHT    520
+
+/* the samples are identified by their position */
+#define PATH_ORIGIN     10
+#define PATH_WIDTH      500
+
+#define N_BUCKETS       50
+
+typedef struct {
+  gint64 time;
+
+  gfloat x, y;
+
+  gint64 injected;
+  gint64 handled;
+  gint64 framed;
+} Sample;
+
+static gint n_samples = 2000;
+static gint interval = 8000;
+static gchar *trace_file = NULL;
+static gboolean use_evdev = FALSE;
+static gdouble max_p95 = 0;
+
+static GOptionEntry entries[] = {
+  {
+    "num-samples", 'n',
+    0,
+    G_OPTION_ARG_INT, &n_samples,
+    "Number of generated samples", "SAMPLES"
+  },
+  {
+    "interval", 'i',
+    0,
+    G_OPTION_ARG_INT, &interval,
+    "Interval between generated samples, in microseconds", "USEC"
+  },
+  {
+    "trace", 't',
+    0,
+    G_OPTION_ARG_FILENAME, &trace_file,
+    "Replay the samples of a trace file", "FILE"
+  },
+  {
+    "evdev", 'e',
+    0,
+    G_OPTION_ARG_NONE, &use_evdev,
+    "Inject the samples through an evdev replay device", NULL
+  },
+  {
+    "max-p95", 'm',
+    0,
+    G_OPTION_ARG_DOUBLE, &max_p95,
+    "Fail if the 95th percentile of the latency exceeds MS", "MS"
+  },
+  { NULL }
+};
+
+static Sample *samples = NULL;
+static gint next_sample = 0;
+static gint last_handled = -1;
+static gint last_framed = -1;
+static gint64 replay_start = 0;
+
+static ClutterActor *stage = NULL;
+static ClutterActor *cursor = NULL;
+static ClutterInputDevice *device = NULL;
+static gint replay_fd = -1;
+
+static void
+sample_set_index (Sample *sample,
+                  gint    index_)
+{
+  sample->x = PATH_ORIGIN + (index_ % PATH_WIDTH);
+  sample->y = PATH_ORIGIN + (index_ / PATH_WIDTH) % PATH_WIDTH;
+}
+
+static gint
+sample_get_index (gfloat x,
+                  gfloat y)
+{
+  gint col = (gint) x - PATH_ORIGIN;
+  gint row = (gint) y - PATH_ORIGIN;
+  gint index_, base;
+
+  if (col < 0 || col >= PATH_WIDTH || row < 0 || row >= PATH_WIDTH)
+    return -1;
+
+  /* find the first sample not handled yet with this position */
+  index_ = row * PATH_WIDTH + col;
+  base = MAX (last_handled + 1, 0) / (PATH_WIDTH * PATH_WIDTH);
+  index_ += base * PATH_WIDTH * PATH_WIDTH;
+
+  return index_ < n_samples ? index_ : -1;
+}
+
+static void
+generate_samples (void)
+{
+  gint i;
+
+  samples = g_new0 (Sample, n_samples);
+
+  for (i = 0; i < n_samples; i++)
+    {
+      samples[i].time = (gint64) i * interval;
+      sample_set_index (&samples[i], i);
+    }
+}
+
+/* the positions of a trace file are replaced by the identifiers of
+ * the samples; only the timing of the trace matters
+ */
+static gboolean
+load_samples (const gchar *filename)
+{
+  GError *error = NULL;
+  gchar *contents;
+  gchar **lines;
+  gint i, n_lines;
+
+  if (!g_file_get_contents (filename, &contents, NULL, &error))
+    {
+      g_printerr ("Could not load the trace: %s\n", error->message);
+      g_error_free (error);
+      return FALSE;
+    }
+
+  lines = g_strsplit (contents, "\n", -1);
+  n_lines = g_strv_length (lines);
+  samples = g_new0 (Sample, n_lines);
+  n_samples = 0;
+
+  for (i = 0; i < n_lines; i++)
+    {
+      gint64 time_;
+      gfloat x, y;
+
+      if (sscanf (lines[i], "%" G_GINT64_FORMAT " %f %f", &time_, &x, &y) != 3)
+        continue;
+
+      samples[n_samples].time = time_;
+      sample_set_index (&samples[n_samples], n_samples);
+      n_samples += 1;
+    }
+
+  /* the trace starts with its first sample */
+  for (i = n_samples - 1; i >= 0; i--)
+    samples[i].time -= samples[0].time;
+
+  g_strfreev (lines);
+  g_free (contents);
+
+  return n_samples > 0;
+}
+
+static void
+inject_sample (Sample *sample)
+{
+  sample->injected = g_get_monotonic_time ();
+
+#ifdef CLUTTER_INPUT_EVDEV
+  if (replay_fd >= 0)
+    {
+      struct input_event ev[3];
+      gint i;
+
+      memset (ev, 0, sizeof (ev));
+
+      ev[0].type = EV_ABS;
+      ev[0].code = ABS_X;
+      ev[0].value = sample->x;
+      ev[1].type = EV_ABS;
+      ev[1].code = ABS_Y;
+      ev[1].value = sample->y;
+      ev[2].type = EV_SYN;
+      ev[2].code = SYN_REPORT;
+
+      for (i = 0; i < (gint) G_N_ELEMENTS (ev); i++)
+        {
+          ev[i].time.tv_sec = sample->injected / G_USEC_PER_SEC;
+          ev[i].time.tv_usec = sample->injected % G_USEC_PER_SEC;
+        }
+
+      if (write (replay_fd, ev, sizeof (ev)) != sizeof (ev))
+        g_error ("Could not write to the replay device");
+
+      return;
+    }
+#endif
+
+  {
+    ClutterEvent *event = clutter_event_new (CLUTTER_MOTION);
+
+    event->motion.stage = CLUTTER_STAGE (stage);
+    event->motion.device = device;
+    event->motion.time = sample->injected / 1000;
+    event->motion.x = sample->x;
+    event->motion.y = sample->y;
+
+    clutter_event_put (event);
+    clutter_event_free (event);
+  }
+}
+
+static gboolean
+replay_cb (gpointer data)
+{
+  gint64 now = g_get_monotonic_time () - replay_start;
+
+  while (next_sample < n_samples && samples[next_sample].time <= now)
+    inject_sample (&samples[next_sample++]);
+
+  if (next_sample == n_samples)
+    return G_SOURCE_REMOVE;
+
+  return G_SOURCE_CONTINUE;
+}
+
+static gboolean
+motion_event_cb (ClutterActor *actor,
+                 ClutterEvent *event,
+                 gpointer      data)
+{
+  gint64 now = g_get_monotonic_time ();
+  gfloat x, y;
+  gint index_, i;
+
+  clutter_event_get_coords (event, &x, &y);
+
+  index_ = sample_get_index (x, y);
+  if (index_ < 0 || index_ <= last_handled)
+    return CLUTTER_EVENT_STOP;
+
+  /* the samples before this one have been coalesced into it */
+  for (i = last_handled + 1; i <= index_; i++)
+    samples[i].handled = now;
+
+  last_handled = index_;
+
+  clutter_actor_set_position (cursor, x, y);
+
+  return CLUTTER_EVENT_STOP;
+}
+
+static gboolean
+frame_cb (gpointer data)
+{
+  gint64 now = g_get_monotonic_time ();
+  gint i;
+
+  for (i = last_framed + 1; i <= last_handled; i++)
+    samples[i].framed = now;
+
+  last_framed = last_handled;
+
+  if (last_framed == n_samples - 1)
+    clutter_main_quit ();
+
+  return G_SOURCE_CONTINUE;
+}
+
+static gboolean
+timeout_cb (gpointer data)
+{
+  g_printerr ("Timed out waiting for the samples\n");
+  clutter_main_quit ();
+
+  return G_SOURCE_REMOVE;
+}
+
+static int
+compare_latency (gconstpointer a,
+                 gconstpointer b)
+{
+  gint64 la = *(const gint64 *) a;
+  gint64 lb = *(const gint64 *) b;
+
+  return la < lb ? -1 : (la > lb ? 1 : 0);
+}
+
+static gdouble
+percentile (const gint64 *latencies,
+            gint          n_latencies,
+            gdouble       p)
+{
+  gint i = MIN (n_latencies - 1, (gint) (p * n_latencies));
+
+  return latencies[i] / 1000.0;
+}
+
+static gdouble
+report (const gchar *id,
+        gboolean     to_frame)
+{
+  gint64 *latencies;
+  guint buckets[N_BUCKETS + 1];
+  gint i, n_latencies = 0;
+  gdouble p95;
+
+  latencies = g_new (gint64, n_samples);
+  memset (buckets, 0, sizeof (buckets));
+
+  for (i = 0; i < n_samples; i++)
+    {
+      gint64 end = to_frame ? samples[i].framed : samples[i].handled;
+      gint64 latency;
+
+      if (end == 0)
+        continue;
+
+      latency = end - samples[i].injected;
+      latencies[n_latencies++] = latency;
+      buckets[MIN (latency / 1000, N_BUCKETS)] += 1;
+    }
+
+  if (n_latencies == 0)
+    {
+      g_free (latencies);
+      return 0;
+    }
+
+  qsort (latencies, n_latencies, sizeof (gint64), compare_latency);
+
+  g_print ("\n%s latency histogram (%d samples):\n", id, n_latencies);
+  for (i = 0; i <= N_BUCKETS; i++)
+    {
+      if (buckets[i] == 0)
+        continue;
+
+      g_print ("  %s%2d ms: %6u\n", i == N_BUCKETS ? ">=" : "  ", i, buckets[i]);
+    }
+
+  p95 = percentile (latencies, n_latencies, 0.95);
+
+  g_print ("@ %s latency p50: %.2f\n", id, percentile (latencies, n_latencies, 0.50));
+  g_print ("@ %s latency p95: %.2f\n", id, p95);
+  g_print ("@ %s latency p99: %.2f\n", id, percentile (latencies, n_latencies, 0.99));
+
+  g_free (latencies);
+
+  return p95;
+}
+
+gint
+main (gint    argc,
+      gchar **argv)
+{
+  ClutterDeviceManager *manager;
+  GError *error = NULL;
+  gdouble p95;
+  gint i, n_framed;
+
+  /* the latency depends on the frame clock, so unlike the other
+   * performance tests this one does not disable the sync to vblank
+   */
+  if (clutter_init_with_args (&argc, &argv,
+                              NULL,
+                              entries,
+                              NULL,
+                              &error) != CLUTTER_INIT_SUCCESS)
+    {
+      g_printerr ("Failed to initialize Clutter: %s\n",
+                  error != NULL ? error->message : "unknown error");
+      return EXIT_FAILURE;
+    }
+
+  if (trace_file != NULL)
+    {
+      if (!load_samples (trace_file))
+        return EXIT_FAILURE;
+    }
+  else
+    {
+      n_samples = MAX (n_samples, 1);
+      generate_samples ();
+    }
+
+  stage = clutter_stage_new ();
+  clutter_stage_set_title (CLUTTER_STAGE (stage), "Input Latency");
+  clutter_actor_set_size (stage, STAGE_WIDTH, STAGE_HEIGHT);
+  g_signal_connect (stage, "motion-event", G_CALLBACK (motion_event_cb), NULL);
+
+  cursor = clutter_actor_new ();
+  clutter_actor_set_background_color (cursor, CLUTTER_COLOR_Red);
+  clutter_actor_set_size (cursor, 8, 8);
+  clutter_actor_add_child (stage, cursor);
+
+  manager = clutter_device_manager_get_default ();
+
+  if (use_evdev)
+    {
+#ifdef CLUTTER_INPUT_EVDEV
+      gint fds[2];
+
+      if (strcmp (G_OBJECT_TYPE_NAME (manager), "ClutterDeviceManagerEvdev") != 0)
+        {
+          g_printerr ("The evdev input backend is not in use\n");
+          return EXIT_FAILURE;
+        }
+
+      if (pipe (fds) < 0)
+        g_error ("Could not create the replay pipe");
+
+      device = clutter_evdev_add_device_for_fd (fds[0],
+                                                CLUTTER_POINTER_DEVICE,
+                                                "Replay device");
+      replay_fd = fds[1];
+#else
+      g_printerr ("Clutter was built without the evdev input backend\n");
+      return EXIT_FAILURE;
+#endif
+    }
+  else
+    {
+      ClutterEvent *event;
+
+      device = clutter_device_manager_get_core_device (manager,
+                                                       CLUTTER_POINTER_DEVICE);
+
+      /* make the device enter the stage, see clutter_perf_fake_mouse() */
+      event = clutter_event_new (CLUTTER_ENTER);
+      event->crossing.stage = CLUTTER_STAGE (stage);
+      event->crossing.source = stage;
+      event->crossing.device = device;
+      clutter_input_device_update_from_event (device, event, TRUE);
+      clutter_event_free (event);
+    }
+
+  if (device == NULL)
+    {
+      g_printerr ("No input device available\n");
+      return EXIT_FAILURE;
+    }
+
+  clutter_threads_add_repaint_func_full (CLUTTER_REPAINT_FLAGS_POST_PAINT,
+                                         frame_cb,
+                                         NULL, NULL);
+
+  clutter_actor_show (stage);
+
+  replay_start = g_get_monotonic_time ();
+  clutter_threads_add_timeout_full (G_PRIORITY_HIGH, 1, replay_cb, NULL, NULL);
+  clutter_threads_add_timeout ((samples[n_samples - 1].time / 1000) + 5000,
+                               timeout_cb,
+                               NULL);
+
+  clutter_main ();
+
+  n_framed = 0;
+  for (i = 0; i < n_samples; i++)
+    if (samples[i].framed != 0)
+      n_framed += 1;
+
+  g_print ("Replayed %d samples, %d of them reached a frame\n",
+           n_samples, n_framed);
+
+  report ("input-to-handler", FALSE);
+  p95 = report ("input-to-frame", TRUE);
+
+  if (replay_fd >= 0)
+    close (replay_fd);
+
+  clutter_actor_destroy (stage);
+  g_free (samples);
+
+  if (max_p95 > 0 && (n_framed < n_samples || p95 > max_p95))
+    {
+      g_printerr ("The input-to-frame latency target (p95 <= %.2f ms) "
+                  "has not been met\n",
+                  max_p95);
+      return EXIT_FAILURE;
+    }
+
+  return EXIT_SUCCESS;
+}
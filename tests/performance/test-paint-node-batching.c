@@ -0,0 +1,240 @@
+#include <stdlib.h>
+#include <clutter/clutter.h>
+#include <cogl/cogl.h>
+#include "test-common.h"
+
+/* A single actor painting a grid of cells, each made of a color node
+ * and of a texture node using a shared texture; the color nodes and the
+ * texture nodes are added in two runs of siblings, so that each run can
+ * be merged into a single draw call. The stage is redrawn on every frame
+ * and the time spent painting a frame is measured between the pre-paint
+ * and the post-paint repaint functions.
+ *
+ * The test uses software GL unless LIBGL_ALWAYS_SOFTWARE is already set,
+ * so that the cost of the draw calls dominates over the GPU.
+ *
+ * Unless --baseline is passed, the test runs itself again with the
+ * batching disabled through CLUTTER_PAINT, and reports the difference
+ * between the two runs.
+ */
+
+#define STAGE_WIDTH     800
+#define STAGE_HEIGHT    600
+
+#define CELL_SIZE       20
+
+#define COLS            (STAGE_WIDTH / CELL_SIZE)
+#define ROWS            (STAGE_HEIGHT / CELL_SIZE)
+
+#define TEXTURE_SIZE    8
+
+typedef struct _TestGrid        TestGrid;
+typedef struct _ClutterActorClass TestGridClass;
+
+struct _TestGrid
+{
+  ClutterActor parent_instance;
+
+  ClutterColor colors[ROWS * COLS];
+
+  CoglTexture *texture;
+};
+
+static GType test_grid_get_type (void);
+
+G_DEFINE_TYPE (TestGrid, test_grid, CLUTTER_TYPE_ACTOR)
+
+static gboolean baseline = FALSE;
+
+static GOptionEntry entries[] = {
+  {
+    "baseline", 'b',
+    0,
+    G_OPTION_ARG_NONE, &baseline,
+    "Do not run the baseline and do not report the differences", NULL
+  },
+  { NULL }
+};
+
+static GTimer *frame_timer = NULL;
+static gdouble frame_time = 0.0;
+static gint n_frames = 0;
+
+static void
+test_grid_paint_node (ClutterActor     *actor,
+                      ClutterPaintNode *root)
+{
+  TestGrid *self = (TestGrid *) actor;
+  ClutterActorBox box;
+  gint x, y;
+
+  for (y = 0; y < ROWS; y++)
+    {
+      for (x = 0; x < COLS; x++)
+        {
+          ClutterPaintNode *node;
+
+          box.x1 = x * CELL_SIZE;
+          box.y1 = y * CELL_SIZE;
+          box.x2 = box.x1 + CELL_SIZE;
+          box.y2 = box.y1 + CELL_SIZE;
+
+          node = clutter_color_node_new (&self->colors[y * COLS + x]);
+          clutter_paint_node_add_rectangle (node, &box);
+          clutter_paint_node_add_child (root, node);
+          clutter_paint_node_unref (node);
+        }
+    }
+
+  for (y = 0; y < ROWS; y++)
+    {
+      for (x = 0; x < COLS; x++)
+        {
+          ClutterPaintNode *node;
+
+          box.x1 = x * CELL_SIZE + CELL_SIZE / 4;
+          box.y1 = y * CELL_SIZE + CELL_SIZE / 4;
+          box.x2 = box.x1 + CELL_SIZE / 2;
+          box.y2 = box.y1 + CELL_SIZE / 2;
+
+          node = clutter_texture_node_new (self->texture,
+                                           CLUTTER_COLOR_White,
+                                           CLUTTER_SCALING_FILTER_NEAREST,
+                                           CLUTTER_SCALING_FILTER_NEAREST);
+          clutter_paint_node_add_rectangle (node, &box);
+          clutter_paint_node_add_child (root, node);
+          clutter_paint_node_unref (node);
+        }
+    }
+}
+
+static void
+test_grid_finalize (GObject *gobject)
+{
+  TestGrid *self = (TestGrid *) gobject;
+
+  cogl_object_unref (self->texture);
+
+  G_OBJECT_CLASS (test_grid_parent_class)->finalize (gobject);
+}
+
+static void
+test_grid_class_init (TestGridClass *klass)
+{
+  GObjectClass *gobject_class = G_OBJECT_CLASS (klass);
+
+  gobject_class->finalize = test_grid_finalize;
+  klass->paint_node = test_grid_paint_node;
+}
+
+static void
+test_grid_init (TestGrid *self)
+{
+  guint8 data[TEXTURE_SIZE * TEXTURE_SIZE * 4];
+  gint i;
+
+  for (i = 0; i < ROWS * COLS; i++)
+    {
+      self->colors[i].red = g_random_int_range (0, 256);
+      self->colors[i].green = g_random_int_range (0, 256);
+      self->colors[i].blue = g_random_int_range (0, 256);
+      self->colors[i].alpha = 0xff;
+    }
+
+  for (i = 0; i < TEXTURE_SIZE * TEXTURE_SIZE * 4; i++)
+    data[i] = g_random_int_range (0, 256) | 0x80;
+
+  self->texture = cogl_texture_new_from_data (TEXTURE_SIZE, TEXTURE_SIZE,
+                                              COGL_TEXTURE_NO_SLICING,
+                                              COGL_PIXEL_FORMAT_RGBA_8888,
+                                              COGL_PIXEL_FORMAT_ANY,
+                                              TEXTURE_SIZE * 4,
+                                              data);
+}
+
+static gboolean
+pre_paint_cb (gpointer data)
+{
+  g_timer_start (frame_timer);
+
+  return G_SOURCE_CONTINUE;
+}
+
+static gboolean
+post_paint_cb (gpointer data)
+{
+  ClutterActor *stage = data;
+
+  frame_time += g_timer_elapsed (frame_timer, NULL);
+  n_frames += 1;
+
+  /* the paint nodes of the grid are retained, and so are the batches */
+  clutter_actor_queue_redraw (stage);
+
+  return G_SOURCE_CONTINUE;
+}
+
+gint
+main (gint    argc,
+      gchar **argv)
+{
+  const gchar *ids[] = { "frame time", NULL };
+  ClutterActor *stage, *grid;
+  gdouble avg_frame_time, base[1];
+
+  g_setenv ("LIBGL_ALWAYS_SOFTWARE", "1", FALSE);
+
+  clutter_perf_fps_init ();
+  if (CLUTTER_INIT_SUCCESS != clutter_init_with_args (&argc, &argv,
+                                                      NULL,
+                                                      entries,
+                                                      NULL,
+                                                      NULL))
+    g_error ("Failed to initialize Clutter");
+
+  stage = clutter_stage_new ();
+  clutter_stage_set_color (CLUTTER_STAGE (stage), CLUTTER_COLOR_Black);
+  clutter_stage_set_title (CLUTTER_STAGE (stage), "Paint Node Batching Performance");
+  clutter_actor_set_size (stage, STAGE_WIDTH, STAGE_HEIGHT);
+
+  frame_timer = g_timer_new ();
+
+  clutter_threads_add_repaint_func_full (CLUTTER_REPAINT_FLAGS_PRE_PAINT,
+                                         pre_paint_cb,
+                                         stage, NULL);
+  clutter_threads_add_repaint_func_full (CLUTTER_REPAINT_FLAGS_POST_PAINT,
+                                         post_paint_cb,
+                                         stage, NULL);
+
+  grid = g_object_new (test_grid_get_type (), NULL);
+  clutter_actor_set_size (grid, STAGE_WIDTH, STAGE_HEIGHT);
+  clutter_actor_add_child (stage, grid);
+
+  clutter_actor_show (stage);
+
+  clutter_perf_fps_start (CLUTTER_STAGE (stage));
+  clutter_main ();
+  clutter_perf_fps_report ("paint node batching");
+
+  avg_frame_time = n_frames > 0 ? 1000000.0 * frame_time / n_frames : 0.0;
+
+  g_print ("@ frame time: %.2f us\n", avg_frame_time);
+  g_print ("@ paint nodes per frame: %d\n", ROWS * COLS * 2);
+
+  clutter_actor_destroy (stage);
+  g_timer_destroy (frame_timer);
+
+  if (baseline)
+    return EXIT_SUCCESS;
+
+  if (!clutter_perf_run_baseline (argv[0], "disable-paint-node-batching",
+                                  ids, base))
+    {
+      g_printerr ("Unable to run the baseline\n");
+      return EXIT_FAILURE;
+    }
+
+  g_print ("@ frame time delta: %.2f us\n", avg_frame_time - base[0]);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,226 @@
+#include <stdlib.h>
+#include <clutter/clutter.h>
+#include <cogl/cogl.h>
+#include "test-common.h"
+
+/* A grid of static actors, painted with a background color and with
+ * an image content, and a stage that is redrawn on every frame; since
+ * none of the actors change, their paint nodes can be retained across
+ * frames. The time spent painting a frame and the number of memory
+ * allocations performed while painting it are measured between the
+ * pre-paint and the post-paint repaint functions.
+ *
+ * Unless --baseline is passed, the test runs itself again with the
+ * retained paint nodes disabled through CLUTTER_PAINT, and reports the
+ * difference between the two runs.
+ */
+
+#define STAGE_WIDTH     800
+#define STAGE_HEIGHT    600
+
+#define ACTOR_SIZE      16
+
+static gboolean baseline = FALSE;
+
+static GOptionEntry entries[] = {
+  {
+    "baseline", 'b',
+    0,
+    G_OPTION_ARG_NONE, &baseline,
+    "Do not run the baseline and do not report the differences", NULL
+  },
+  { NULL }
+};
+
+static GTimer *frame_timer = NULL;
+static gdouble frame_time = 0.0;
+static gint n_frames = 0;
+
+static volatile gint n_allocations = 0;
+static gint frame_allocations = 0;
+static gint64 total_allocations = 0;
+
+static gpointer
+counting_malloc (gsize n_bytes)
+{
+  g_atomic_int_inc (&n_allocations);
+
+  return malloc (n_bytes);
+}
+
+static gpointer
+counting_realloc (gpointer mem,
+                  gsize    n_bytes)
+{
+  g_atomic_int_inc (&n_allocations);
+
+  return realloc (mem, n_bytes);
+}
+
+static gpointer
+counting_calloc (gsize n_blocks,
+                 gsize n_block_bytes)
+{
+  g_atomic_int_inc (&n_allocations);
+
+  return calloc (n_blocks, n_block_bytes);
+}
+
+static GMemVTable counting_vtable = {
+  counting_malloc,
+  counting_realloc,
+  free,
+  counting_calloc,
+  NULL, /* try_malloc */
+  NULL, /* try_realloc */
+};
+
+static gboolean
+pre_paint_cb (gpointer data)
+{
+  frame_allocations = g_atomic_int_get (&n_allocations);
+  g_timer_start (frame_timer);
+
+  return G_SOURCE_CONTINUE;
+}
+
+static gboolean
+post_paint_cb (gpointer data)
+{
+  ClutterActor *stage = data;
+
+  frame_time += g_timer_elapsed (frame_timer, NULL);
+  total_allocations += g_atomic_int_get (&n_allocations) - frame_allocations;
+  n_frames += 1;
+
+  /* the stage is redrawn on every frame without any of its children
+   * queueing a redraw on their own
+   */
+  clutter_actor_queue_redraw (stage);
+
+  return G_SOURCE_CONTINUE;
+}
+
+static ClutterContent *
+create_image (void)
+{
+  ClutterContent *image;
+  guint8 data[ACTOR_SIZE * ACTOR_SIZE * 4];
+  gint i;
+
+  for (i = 0; i < ACTOR_SIZE * ACTOR_SIZE; i++)
+    {
+      data[i * 4 + 0] = g_random_int_range (0, 256);
+      data[i * 4 + 1] = g_random_int_range (0, 256);
+      data[i * 4 + 2] = g_random_int_range (0, 256);
+      data[i * 4 + 3] = 0xff;
+    }
+
+  image = clutter_image_new ();
+  clutter_image_set_data (CLUTTER_IMAGE (image), data,
+                          COGL_PIXEL_FORMAT_RGBA_8888_PRE,
+                          ACTOR_SIZE, ACTOR_SIZE,
+                          ACTOR_SIZE * 4,
+                          NULL);
+
+  return image;
+}
+
+gint
+main (gint    argc,
+      gchar **argv)
+{
+  ClutterContent *image;
+  ClutterActor *stage;
+  const gchar *ids[] = { "frame time", "allocations per frame", NULL };
+  gdouble avg_frame_time, avg_allocations;
+  gdouble base[2];
+  gint x, y;
+
+  /* must happen before anything else allocates memory through GLib;
+   * the slice allocator is bypassed so that every allocation goes
+   * through the vtable
+   */
+  g_mem_set_vtable (&counting_vtable);
+  g_setenv ("G_SLICE", "always-malloc", TRUE);
+
+  clutter_perf_fps_init ();
+  if (CLUTTER_INIT_SUCCESS != clutter_init_with_args (&argc, &argv,
+                                                      NULL,
+                                                      entries,
+                                                      NULL,
+                                                      NULL))
+    g_error ("Failed to initialize Clutter");
+
+  stage = clutter_stage_new ();
+  clutter_stage_set_color (CLUTTER_STAGE (stage), CLUTTER_COLOR_Black);
+  clutter_stage_set_title (CLUTTER_STAGE (stage), "Paint Nodes Performance");
+  clutter_actor_set_size (stage, STAGE_WIDTH, STAGE_HEIGHT);
+
+  frame_timer = g_timer_new ();
+
+  clutter_threads_add_repaint_func_full (CLUTTER_REPAINT_FLAGS_PRE_PAINT,
+                                         pre_paint_cb,
+                                         stage, NULL);
+  clutter_threads_add_repaint_func_full (CLUTTER_REPAINT_FLAGS_POST_PAINT,
+                                         post_paint_cb,
+                                         stage, NULL);
+
+  image = create_image ();
+
+  for (y = 0; y < STAGE_HEIGHT / ACTOR_SIZE; y++)
+    {
+      for (x = 0; x < STAGE_WIDTH / ACTOR_SIZE; x++)
+        {
+          ClutterActor *actor = clutter_actor_new ();
+
+          if ((x + y) % 2 == 0)
+            {
+              ClutterColor color = { 0, 0, 0, 0xff };
+
+              color.red = g_random_int_range (0, 256);
+              color.green = g_random_int_range (0, 256);
+              color.blue = g_random_int_range (0, 256);
+
+              clutter_actor_set_background_color (actor, &color);
+            }
+          else
+            clutter_actor_set_content (actor, image);
+
+          clutter_actor_set_size (actor, ACTOR_SIZE, ACTOR_SIZE);
+          clutter_actor_set_position (actor, x * ACTOR_SIZE, y * ACTOR_SIZE);
+          clutter_actor_add_child (stage, actor);
+        }
+    }
+
+  clutter_actor_show (stage);
+
+  clutter_perf_fps_start (CLUTTER_STAGE (stage));
+  clutter_main ();
+  clutter_perf_fps_report ("paint nodes");
+
+  avg_frame_time = n_frames > 0 ? 1000000.0 * frame_time / n_frames : 0.0;
+  avg_allocations = n_frames > 0 ? (gdouble) total_allocations / n_frames : 0.0;
+
+  g_print ("@ frame time: %.2f us\n", avg_frame_time);
+  g_print ("@ allocations per frame: %.2f\n", avg_allocations);
+
+  clutter_actor_destroy (stage);
+  g_object_unref (image);
+  g_timer_destroy (frame_timer);
+
+  if (baseline)
+    return EXIT_SUCCESS;
+
+  if (!clutter_perf_run_baseline (argv[0], "disable-retained-paint-nodes",
+                                  ids, base))
+    {
+      g_printerr ("Unable to run the baseline\n");
+      return EXIT_FAILURE;
+    }
+
+  g_print ("@ frame time delta: %.2f us\n", avg_frame_time - base[0]);
+  g_print ("@ allocations per frame delta: %.2f\n", avg_allocations - base[1]);
+
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,106 @@
+#include <stdlib.h>
+#include <clutter/clutter.h>
+#include "test-common.h"
+
+/* Small actors scattered over the stage, a few of which change each
+ * frame, like a clock and status icons; reports the number of pixels
+ * painted per frame, which depends on how well the redraw clips of
+ * the updated actors are preserved.
+ */
+
+#define STAGE_WIDTH    800
+#define STAGE_HEIGHT   600
+
+#define ACTOR_SIZE     16
+
+#define N_ACTORS       32
+#define N_UPDATES      3
+
+static ClutterActor *actors[N_ACTORS];
+
+static gint64 n_pixels = 0;
+static gint n_frames = 0;
+
+static void
+stage_paint_cb (ClutterActor *stage,
+                gpointer      data)
+{
+  cairo_rectangle_int_t clip;
+
+  /* with clipped redraws, the stage is painted once per clip */
+  clutter_stage_get_redraw_clip_bounds (CLUTTER_STAGE (stage), &clip);
+  n_pixels += (gint64) clip.width * clip.height;
+}
+
+static gboolean
+frame_cb (gpointer data)
+{
+  ClutterColor color = { 0, 0, 0, 0xff };
+  gint i;
+
+  n_frames += 1;
+
+  /* update a few actors for the next frame */
+  for (i = 0; i < N_UPDATES; i++)
+    {
+      ClutterActor *actor = actors[g_random_int_range (0, N_ACTORS)];
+
+      color.red = g_random_int_range (0, 256);
+      color.green = g_random_int_range (0, 256);
+      color.blue = g_random_int_range (0, 256);
+
+      clutter_actor_set_background_color (actor, &color);
+    }
+
+  return G_SOURCE_CONTINUE;
+}
+
+gint
+main (gint    argc,
+      gchar **argv)
+{
+  ClutterActor *stage;
+  gint i;
+
+  clutter_perf_fps_init ();
+  if (CLUTTER_INIT_SUCCESS != clutter_init (&argc, &argv))
+    g_error ("Failed to initialize Clutter");
+
+  stage = clutter_stage_new ();
+  clutter_stage_set_color (CLUTTER_STAGE (stage), CLUTTER_COLOR_Black);
+  clutter_stage_set_title (CLUTTER_STAGE (stage), "Redraw Clips Performance");
+  clutter_actor_set_size (stage, STAGE_WIDTH, STAGE_HEIGHT);
+
+  for (i = 0; i < N_ACTORS; i++)
+    {
+      actors[i] = clutter_actor_new ();
+      clutter_actor_set_background_color (actors[i], CLUTTER_COLOR_White);
+      clutter_actor_set_size (actors[i], ACTOR_SIZE, ACTOR_SIZE);
+      clutter_actor_set_position (actors[i],
+                                  g_random_int_range (0, STAGE_WIDTH - ACTOR_SIZE),
+                                  g_random_int_range (0, STAGE_HEIGHT - ACTOR_SIZE));
+      clutter_actor_add_child (stage, actors[i]);
+    }
+
+  g_signal_connect (stage, "paint", G_CALLBACK (stage_paint_cb), NULL);
+  clutter_threads_add_repaint_func_full (CLUTTER_REPAINT_FLAGS_POST_PAINT,
+                                         frame_cb,
+                                         NULL, NULL);
+
+  clutter_actor_show (stage);
+
+  clutter_perf_fps_start (CLUTTER_STAGE (stage));
+  clutter_main ();
+  clutter_perf_fps_report ("redraw-clips");
+
+  g_print ("@ redraw-clips pixels per frame: %.0f\n",
+           n_frames > 0 ? (double) n_pixels / n_frames : 0.0);
+  g_print ("@ redraw-clips stage coverage: %.2f %%\n",
+           n_frames > 0
+             ? 100.0 * n_pixels / ((double) n_frames * STAGE_WIDTH * STAGE_HEIGHT)
+             : 0.0);
+
+  clutter_actor_destroy (stage);
+
+  return 0;
+}
@@ -0,0 +1,120 @@
+#include <stdlib.h>
+#include <clutter/clutter.h>
+#include "test-common.h"
+
+/* A grid of fixed-size panels, each laying out a hundred small leaves
+ * with a flow layout, for a total of ten thousand actors; a random leaf
+ * changes its size each frame, and the time spent relayouting is
+ * measured by forcing the relayout with clutter_actor_get_allocation_box().
+ */
+
+#define STAGE_WIDTH     800
+#define STAGE_HEIGHT    600
+
+#define N_COLUMNS       10
+#define N_ROWS          10
+#define N_LEAVES        100
+
+#define PANEL_WIDTH     (STAGE_WIDTH / N_COLUMNS)
+#define PANEL_HEIGHT    (STAGE_HEIGHT / N_ROWS)
+
+#define LEAF_SIZE       4
+
+static ClutterActor *leaves[N_COLUMNS * N_ROWS * N_LEAVES];
+
+static GTimer *relayout_timer = NULL;
+static gdouble relayout_time = 0.0;
+static gint n_relayouts = 0;
+
+static gboolean
+frame_cb (gpointer data)
+{
+  ClutterActor *leaf;
+  ClutterActorBox box;
+  gfloat size;
+
+  leaf = leaves[g_random_int_range (0, G_N_ELEMENTS (leaves))];
+  size = g_random_int_range (LEAF_SIZE / 2, LEAF_SIZE * 2);
+
+  clutter_actor_set_size (leaf, size, size);
+
+  /* getting the allocation of a leaf that needs one forces a relayout */
+  g_timer_start (relayout_timer);
+  clutter_actor_get_allocation_box (leaf, &box);
+  relayout_time += g_timer_elapsed (relayout_timer, NULL);
+  n_relayouts += 1;
+
+  return G_SOURCE_CONTINUE;
+}
+
+gint
+main (gint    argc,
+      gchar **argv)
+{
+  ClutterActor *stage;
+  gint i, j, k;
+
+  clutter_perf_fps_init ();
+  if (CLUTTER_INIT_SUCCESS != clutter_init (&argc, &argv))
+    g_error ("Failed to initialize Clutter");
+
+  stage = clutter_stage_new ();
+  clutter_stage_set_color (CLUTTER_STAGE (stage), CLUTTER_COLOR_Black);
+  clutter_stage_set_title (CLUTTER_STAGE (stage), "Relayout Performance");
+  clutter_actor_set_size (stage, STAGE_WIDTH, STAGE_HEIGHT);
+
+  for (i = 0; i < N_ROWS; i++)
+    {
+      for (j = 0; j < N_COLUMNS; j++)
+        {
+          ClutterLayoutManager *layout;
+          ClutterActor *panel;
+
+          layout = clutter_flow_layout_new (CLUTTER_FLOW_HORIZONTAL);
+
+          /* the fixed size makes the panel a relayout boundary */
+          panel = clutter_actor_new ();
+          clutter_actor_set_layout_manager (panel, layout);
+          clutter_actor_set_clip_to_allocation (panel, TRUE);
+          clutter_actor_set_position (panel, j * PANEL_WIDTH, i * PANEL_HEIGHT);
+          clutter_actor_set_size (panel, PANEL_WIDTH, PANEL_HEIGHT);
+          clutter_actor_add_child (stage, panel);
+
+          for (k = 0; k < N_LEAVES; k++)
+            {
+              ClutterActor *leaf = clutter_actor_new ();
+              ClutterColor color = { 0, 0, 0, 0xff };
+
+              color.red = g_random_int_range (0, 256);
+              color.green = g_random_int_range (0, 256);
+              color.blue = g_random_int_range (0, 256);
+
+              clutter_actor_set_background_color (leaf, &color);
+              clutter_actor_set_size (leaf, LEAF_SIZE, LEAF_SIZE);
+              clutter_actor_add_child (panel, leaf);
+
+              leaves[(i * N_COLUMNS + j) * N_LEAVES + k] = leaf;
+            }
+        }
+    }
+
+  relayout_timer = g_timer_new ();
+
+  clutter_threads_add_repaint_func_full (CLUTTER_REPAINT_FLAGS_POST_PAINT,
+                                         frame_cb,
+                                         NULL, NULL);
+
+  clutter_actor_show (stage);
+
+  clutter_perf_fps_start (CLUTTER_STAGE (stage));
+  clutter_main ();
+  clutter_perf_fps_report ("relayout");
+
+  g_print ("@ relayout time: %.2f us\n",
+           n_relayouts > 0 ? 1000000.0 * relayout_time / n_relayouts : 0.0);
+
+  g_timer_destroy (relayout_timer);
+  clutter_actor_destroy (stage);
+
+  return 0;
+}